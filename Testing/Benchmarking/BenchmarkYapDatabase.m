@@ -1,5 +1,11 @@
 #import "BenchmarkYapDatabase.h"
 #import "YapDatabase.h"
+#import "YapDatabaseAutoView.h"
+#import "YapDatabaseFilteredView.h"
+#import "YapDatabaseFullTextSearch.h"
+#import "YapDatabaseSecondaryIndex.h"
+#import "YapDatabaseRTreeIndex.h"
+#import "YapDatabaseRelationship.h"
 
 #import <stdlib.h>
 
@@ -221,6 +227,1709 @@ static NSMutableArray *keys;
 	NSLog(@"ReadWrite transaction overhead: %.8f", (elapsed / loopCount));
 }
 
++ (void)enumerateViewGroup:(NSUInteger)count
+{
+	NSString *const viewCollection = @"viewBenchmark";
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)i];
+			
+			[transaction setObject:key forKey:key inCollection:viewCollection withMetadata:@(i)];
+		}
+	}];
+	
+	YapDatabaseViewGrouping *grouping = [YapDatabaseViewGrouping withKeyBlock:
+	    ^NSString *(YapDatabaseReadTransaction __unused *transaction, NSString *collection, NSString __unused *key)
+	{
+		return collection;
+	}];
+	
+	YapDatabaseViewSorting *sorting = [YapDatabaseViewSorting withKeyBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSString __unused *group,
+	      NSString __unused *collection1, NSString *key1,
+	      NSString __unused *collection2, NSString *key2)
+	{
+		return [key1 compare:key2];
+	}];
+	
+	YapWhitelistBlacklist *whitelist = [[YapWhitelistBlacklist alloc] initWithWhitelist:[NSSet setWithObject:viewCollection]];
+	
+	YapDatabaseViewOptions *options = [[YapDatabaseViewOptions alloc] init];
+	options.allowedCollections = whitelist;
+	
+	YapDatabaseAutoView *view =
+	  [[YapDatabaseAutoView alloc] initWithGrouping:grouping sorting:sorting versionTag:@"1" options:options];
+	
+	NSDate *start = [NSDate date];
+	
+	[database registerExtension:view withName:@"viewBenchmark"];
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Populate view: total time: %.6f, group count: %lu", elapsed, (unsigned long)count);
+	
+	// Cold enumeration: use a fresh connection each time, so nothing is in the cache.
+	
+	YapDatabaseConnection *coldConnection = [database newConnection];
+	__block NSUInteger enumCount = 0;
+	
+	start = [NSDate date];
+	
+	[coldConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		YapDatabaseViewTransaction *viewTransaction = [transaction ext:@"viewBenchmark"];
+		
+		[viewTransaction enumerateKeysInGroup:viewCollection
+		                           usingBlock:^(NSString *collection, NSString *key, NSUInteger __unused index, BOOL __unused *stop)
+		{
+			if ([transaction objectForKey:key inCollection:collection])
+				enumCount++;
+		}];
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Enumerate view keys, then fetch objects: total time: %.6f, count: %lu", elapsed, (unsigned long)enumCount);
+	
+	coldConnection = [database newConnection];
+	enumCount = 0;
+	
+	start = [NSDate date];
+	
+	[coldConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		YapDatabaseViewTransaction *viewTransaction = [transaction ext:@"viewBenchmark"];
+		
+		[viewTransaction enumerateKeysAndObjectsInGroup:viewCollection
+		                                     usingBlock:
+		    ^(NSString __unused *collection, NSString __unused *key, id object, NSUInteger __unused index, BOOL __unused *stop)
+		{
+			if (object)
+				enumCount++;
+		}];
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Enumerate view keys & objects: total time: %.6f, count: %lu", elapsed, (unsigned long)enumCount);
+	
+	coldConnection = [database newConnection];
+	enumCount = 0;
+	
+	start = [NSDate date];
+	
+	[coldConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		YapDatabaseViewTransaction *viewTransaction = [transaction ext:@"viewBenchmark"];
+		
+		[viewTransaction enumerateRowsInGroup:viewCollection
+		                           usingBlock:
+		    ^(NSString __unused *collection, NSString __unused *key, id object, id metadata,
+		      NSUInteger __unused index, BOOL __unused *stop)
+		{
+			if (object && metadata)
+				enumCount++;
+		}];
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Enumerate view rows: total time: %.6f, count: %lu", elapsed, (unsigned long)enumCount);
+	
+	[database unregisterExtensionWithName:@"viewBenchmark"];
+}
+
++ (void)viewChangesetWithCount:(NSUInteger)count
+{
+	NSString *const viewCollection = @"changesetBenchmark";
+	
+	YapDatabaseViewGrouping *grouping = [YapDatabaseViewGrouping withKeyBlock:
+	    ^NSString *(YapDatabaseReadTransaction __unused *transaction, NSString *collection, NSString __unused *key)
+	{
+		return collection;
+	}];
+	
+	YapDatabaseViewSorting *sorting = [YapDatabaseViewSorting withMetadataBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSString __unused *group,
+	      NSString __unused *collection1, NSString __unused *key1, NSNumber *metadata1,
+	      NSString __unused *collection2, NSString __unused *key2, NSNumber *metadata2)
+	{
+		return [metadata1 compare:metadata2];
+	}];
+	
+	YapWhitelistBlacklist *whitelist = [[YapWhitelistBlacklist alloc] initWithWhitelist:[NSSet setWithObject:viewCollection]];
+	
+	YapDatabaseViewOptions *options = [[YapDatabaseViewOptions alloc] init];
+	options.isPersistent = NO;
+	options.allowedCollections = whitelist;
+	
+	YapDatabaseAutoView *view =
+	  [[YapDatabaseAutoView alloc] initWithGrouping:grouping sorting:sorting versionTag:@"1" options:options];
+	
+	[database registerExtension:view withName:@"changesetBenchmark"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)i];
+			
+			[transaction setObject:key forKey:key inCollection:viewCollection withMetadata:@(i)];
+		}
+	}];
+	
+	YapDatabaseConnection *uiConnection = [database newConnection];
+	[uiConnection beginLongLivedReadTransaction];
+	
+	YapDatabaseViewMappings *mappings =
+	  [[YapDatabaseViewMappings alloc] initWithGroups:@[ viewCollection ] view:@"changesetBenchmark"];
+	
+	[uiConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		[mappings updateWithTransaction:transaction];
+	}];
+	
+	// Shuffle every item in the view (a move for each row)
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)i];
+			
+			[transaction replaceMetadata:@(arc4random_uniform((uint32_t)count)) forKey:key inCollection:viewCollection];
+		}
+	}];
+	
+	NSArray *notifications = [uiConnection beginLongLivedReadTransaction];
+	
+	NSArray *sectionChanges = nil;
+	NSArray *rowChanges = nil;
+	
+	NSDate *start = [NSDate date];
+	
+	[[uiConnection ext:@"changesetBenchmark"] getSectionChanges:&sectionChanges
+	                                                 rowChanges:&rowChanges
+	                                           forNotifications:notifications
+	                                               withMappings:mappings];
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"View changeset: total time: %.6f, count: %lu, rowChanges: %lu",
+	      elapsed, (unsigned long)count, (unsigned long)[rowChanges count]);
+	
+	[uiConnection endLongLivedReadTransaction];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:viewCollection];
+	}];
+	
+	[database unregisterExtensionWithName:@"changesetBenchmark"];
+}
+
++ (void)refilterWithConcurrency:(NSUInteger)concurrency count:(NSUInteger)count
+{
+	NSString *const viewCollection = @"refilterBenchmark";
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)i];
+			
+			[transaction setObject:@(i) forKey:key inCollection:viewCollection];
+		}
+	}];
+	
+	YapDatabaseViewGrouping *grouping = [YapDatabaseViewGrouping withKeyBlock:
+	    ^NSString *(YapDatabaseReadTransaction __unused *transaction, NSString *collection, NSString __unused *key)
+	{
+		return collection;
+	}];
+	
+	YapDatabaseViewSorting *sorting = [YapDatabaseViewSorting withKeyBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSString __unused *group,
+	      NSString __unused *collection1, NSString *key1,
+	      NSString __unused *collection2, NSString *key2)
+	{
+		return [key1 compare:key2];
+	}];
+	
+	YapWhitelistBlacklist *whitelist = [[YapWhitelistBlacklist alloc] initWithWhitelist:[NSSet setWithObject:viewCollection]];
+	
+	YapDatabaseViewOptions *viewOptions = [[YapDatabaseViewOptions alloc] init];
+	viewOptions.allowedCollections = whitelist;
+	
+	YapDatabaseAutoView *view =
+	  [[YapDatabaseAutoView alloc] initWithGrouping:grouping sorting:sorting versionTag:@"1" options:viewOptions];
+	
+	[database registerExtension:view withName:@"refilterBenchmarkParent"];
+	
+	YapDatabaseViewFiltering *filtering = [YapDatabaseViewFiltering withObjectBlock:
+	    ^BOOL (YapDatabaseReadTransaction __unused *transaction, NSString __unused *group,
+	           NSString __unused *collection, NSString __unused *key, NSNumber *object)
+	{
+		return ([object unsignedIntegerValue] % 2 == 0);
+	}];
+	
+	YapDatabaseFilteredViewOptions *filterOptions = [[YapDatabaseFilteredViewOptions alloc] init];
+	filterOptions.filteringConcurrency = concurrency;
+	
+	YapDatabaseFilteredView *filteredView =
+	  [[YapDatabaseFilteredView alloc] initWithParentViewName:@"refilterBenchmarkParent"
+	                                                filtering:filtering
+	                                               versionTag:@"even"
+	                                                  options:filterOptions];
+	
+	[database registerExtension:filteredView withName:@"refilterBenchmark"];
+	
+	// Use a fresh connection, so the objects aren't in the cache.
+	
+	YapDatabaseConnection *coldConnection = [database newConnection];
+	
+	YapDatabaseViewFiltering *newFiltering = [YapDatabaseViewFiltering withObjectBlock:
+	    ^BOOL (YapDatabaseReadTransaction __unused *transaction, NSString __unused *group,
+	           NSString __unused *collection, NSString __unused *key, NSNumber *object)
+	{
+		return ([object unsignedIntegerValue] % 3 == 0);
+	}];
+	
+	NSDate *start = [NSDate date];
+	
+	[coldConnection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[[transaction ext:@"refilterBenchmark"] setFiltering:newFiltering versionTag:@"three"];
+	}];
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Refilter: total time: %.6f, concurrency: %lu (cores: %lu), count: %lu", elapsed,
+	      (unsigned long)concurrency, (unsigned long)[[NSProcessInfo processInfo] activeProcessorCount],
+	      (unsigned long)count);
+	
+	[database unregisterExtensionWithName:@"refilterBenchmark"];
+	[database unregisterExtensionWithName:@"refilterBenchmarkParent"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:viewCollection];
+	}];
+}
+
++ (unsigned long long)databaseFileSize
+{
+	NSString *databasePath = [[self databaseURL] path];
+	unsigned long long size = 0;
+	
+	for (NSString *suffix in @[ @"", @"-wal" ])
+	{
+		NSString *path = [databasePath stringByAppendingString:suffix];
+		NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:NULL];
+		
+		size += [attributes fileSize];
+	}
+	
+	return size;
+}
+
++ (void)fullTextSearchContentless:(BOOL)contentless count:(NSUInteger)count
+{
+	NSString *const ftsCollection = @"ftsBenchmark";
+	NSString *modeStr = contentless ? @"contentless" : @"normal";
+	
+	// Generate a corpus of documents, using a vocabulary with a handful of very common words.
+	
+	NSMutableArray<NSString *> *vocabulary = [NSMutableArray arrayWithCapacity:5000];
+	for (NSUInteger i = 0; i < 5000; i++)
+	{
+		[vocabulary addObject:[self randomLetters:(3 + arc4random_uniform(7))]];
+	}
+	
+	NSString *(^randomDocument)(void) = ^{
+		
+		NSMutableArray<NSString *> *words = [NSMutableArray arrayWithCapacity:200];
+		for (NSUInteger i = 0; i < 200; i++)
+		{
+			uint32_t index = arc4random_uniform(50) == 0 ? arc4random_uniform(10) : arc4random_uniform(5000);
+			[words addObject:vocabulary[index]];
+		}
+		
+		return [words componentsJoinedByString:@" "];
+	};
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)i];
+			
+			[transaction setObject:randomDocument() forKey:key inCollection:ftsCollection];
+		}
+	}];
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString *collection, NSString __unused *key, id object)
+	{
+		if ([collection isEqualToString:ftsCollection]) {
+			[dict setObject:object forKey:@"content"];
+		}
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 options:nil
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS5Version
+	                                             contentless:contentless
+	                                              versionTag:@"1"];
+	
+	unsigned long long sizeBefore = [self databaseFileSize];
+	NSDate *start = [NSDate date];
+	
+	[database registerExtension:fts withName:@"ftsBenchmark"];
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	unsigned long long sizeAfter = [self databaseFileSize];
+	
+	NSLog(@"Populate fts (%@): total time: %.6f, count: %lu, size: %.2f MB", modeStr, elapsed, (unsigned long)count,
+	      (double)(sizeAfter - MIN(sizeBefore, sizeAfter)) / (1024.0 * 1024.0));
+	
+	// Write throughput: rewrite 10% of the documents
+	
+	start = [NSDate date];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < (count / 10); i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)arc4random_uniform((uint32_t)count)];
+			
+			[transaction setObject:randomDocument() forKey:key inCollection:ftsCollection];
+		}
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Update fts (%@): total time: %.6f, updated: %lu", modeStr, elapsed, (unsigned long)(count / 10));
+	
+	// Queries
+	
+	__block NSUInteger matchCount = 0;
+	start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < 100; i++)
+		{
+			NSString *query = vocabulary[arc4random_uniform(5000)];
+			
+			[[transaction ext:@"ftsBenchmark"] enumerateKeysMatching:query
+			                                              usingBlock:^(NSString __unused *collection, NSString __unused *key, BOOL __unused *stop)
+			{
+				matchCount++;
+			}];
+		}
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Query fts (%@): total time: %.6f, queries: 100, matches: %lu", modeStr, elapsed, (unsigned long)matchCount);
+	
+	// Snippets (a page of results)
+	
+	__block NSUInteger snippetCount = 0;
+	start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[[transaction ext:@"ftsBenchmark"] enumerateKeysMatching:vocabulary[0]
+		                                      withSnippetOptions:nil
+		                                              usingBlock:
+		    ^(NSString __unused *snippet, NSString __unused *collection, NSString __unused *key, BOOL *stop)
+		{
+			if (++snippetCount >= 50) *stop = YES;
+		}];
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Snippets fts (%@): total time: %.6f, snippets: %lu", modeStr, elapsed, (unsigned long)snippetCount);
+	
+	[database unregisterExtensionWithName:@"ftsBenchmark"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:ftsCollection];
+	}];
+}
+
++ (void)fullTextSearchMaintenanceWithCount:(NSUInteger)count
+{
+	NSString *const ftsCollection = @"ftsBenchmark";
+	
+	NSMutableArray<NSString *> *vocabulary = [NSMutableArray arrayWithCapacity:5000];
+	for (NSUInteger i = 0; i < 5000; i++)
+	{
+		[vocabulary addObject:[self randomLetters:(3 + arc4random_uniform(7))]];
+	}
+	
+	NSString *(^randomDocument)(void) = ^{
+		
+		NSMutableArray<NSString *> *words = [NSMutableArray arrayWithCapacity:50];
+		for (NSUInteger i = 0; i < 50; i++)
+		{
+			[words addObject:vocabulary[arc4random_uniform(5000)]];
+		}
+		
+		return [words componentsJoinedByString:@" "];
+	};
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString *collection, NSString __unused *key, id object)
+	{
+		if ([collection isEqualToString:ftsCollection]) {
+			[dict setObject:object forKey:@"content"];
+		}
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 options:nil
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS5Version
+	                                              versionTag:@"1"];
+	
+	[database registerExtension:fts withName:@"ftsBenchmark"];
+	
+	// Heavy update traffic: many small commits
+	
+	NSDate *start = [NSDate date];
+	
+	for (NSUInteger i = 0; i < (count / 10); i++)
+	{
+		[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			for (NSUInteger j = 0; j < 10; j++)
+			{
+				NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)arc4random_uniform((uint32_t)count)];
+				
+				[transaction setObject:randomDocument() forKey:key inCollection:ftsCollection];
+			}
+		}];
+	}
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Update fts: total time: %.6f, commits: %lu", elapsed, (unsigned long)(count / 10));
+	
+	NSTimeInterval (^queryTime)(void) = ^{
+		
+		NSDate *queryStart = [NSDate date];
+		
+		[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			for (NSUInteger i = 0; i < 100; i++)
+			{
+				[[transaction ext:@"ftsBenchmark"] enumerateKeysMatching:vocabulary[i]
+				                                              usingBlock:^(NSString __unused *collection, NSString __unused *key, BOOL __unused *stop)
+				{
+					// Nothing to do here
+				}];
+			}
+		}];
+		
+		return [queryStart timeIntervalSinceNow] * -1.0;
+	};
+	
+	NSTimeInterval queryTimeBefore = queryTime();
+	
+	// Background merge
+	
+	dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+	__block YapDatabaseFullTextSearchMaintenanceReport *report = nil;
+	
+	[[connection ext:@"ftsBenchmark"] asyncMergeWithPageCount:0
+	                                               probeQuery:vocabulary[0]
+	                                          completionQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)
+	                                          completionBlock:^(YapDatabaseFullTextSearchMaintenanceReport *inReport)
+	{
+		report = inReport;
+		dispatch_semaphore_signal(semaphore);
+	}];
+	
+	dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+	
+	NSTimeInterval queryTimeAfter = queryTime();
+	
+	NSLog(@"Merge fts: %@", report);
+	NSLog(@"Query fts: queries: 100, time before merge: %.6f, time after merge: %.6f", queryTimeBefore, queryTimeAfter);
+	
+	[database unregisterExtensionWithName:@"ftsBenchmark"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:ftsCollection];
+	}];
+}
+
++ (void)indexedUpdatesWithCount:(NSUInteger)count
+{
+	NSString *const indexCollection = @"indexBenchmark";
+	
+	// Each object has some indexed values (text & number), and a non-indexed counter.
+	
+	YapDatabaseFullTextSearchHandler *ftsHandler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString *collection, NSString __unused *key, id object)
+	{
+		if ([collection isEqualToString:indexCollection]) {
+			[dict setObject:[(NSDictionary *)object objectForKey:@"text"] forKey:@"content"];
+		}
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 options:nil
+	                                                 handler:ftsHandler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS5Version
+	                                              versionTag:@"1"];
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"rank" withType:YapDatabaseSecondaryIndexTypeInteger];
+	
+	YapDatabaseSecondaryIndexHandler *indexHandler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString *collection, NSString __unused *key, id object)
+	{
+		if ([collection isEqualToString:indexCollection]) {
+			[dict setObject:[(NSDictionary *)object objectForKey:@"rank"] forKey:@"rank"];
+		}
+	}];
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:indexHandler];
+	
+	[database registerExtension:fts withName:@"ftsBenchmark"];
+	[database registerExtension:secondaryIndex withName:@"indexBenchmark"];
+	
+	NSMutableArray<NSString *> *texts = [NSMutableArray arrayWithCapacity:count];
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		NSMutableArray<NSString *> *words = [NSMutableArray arrayWithCapacity:100];
+		for (NSUInteger j = 0; j < 100; j++)
+		{
+			[words addObject:[self randomLetters:(3 + arc4random_uniform(7))]];
+		}
+		
+		[texts addObject:[words componentsJoinedByString:@" "]];
+	}
+	
+	void (^updateAll)(BOOL) = ^(BOOL changeIndexedValues){
+		
+		for (NSUInteger i = 0; i < count; i += 100)
+		{
+			[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+				
+				for (NSUInteger j = i; j < MIN(i + 100, count); j++)
+				{
+					NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)j];
+					
+					NSString *text = texts[j];
+					NSUInteger rank = j;
+					if (changeIndexedValues) {
+						text = [text stringByAppendingString:@" changed"];
+						rank = j + 1;
+					}
+					
+					NSDictionary *object = @{ @"text":text, @"rank":@(rank), @"counter":@(arc4random()) };
+					
+					[transaction setObject:object forKey:key inCollection:indexCollection];
+				}
+			}];
+		}
+	};
+	
+	updateAll(NO); // populate
+	
+	unsigned long long sizeBefore = [self databaseFileSize];
+	NSDate *start = [NSDate date];
+	
+	updateAll(NO);
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	unsigned long long sizeAfter = [self databaseFileSize];
+	
+	NSLog(@"Update (indexed values unchanged): total time: %.6f, count: %lu, file growth: %.2f MB",
+	      elapsed, (unsigned long)count, (double)(sizeAfter - MIN(sizeBefore, sizeAfter)) / (1024.0 * 1024.0));
+	
+	sizeBefore = sizeAfter;
+	start = [NSDate date];
+	
+	updateAll(YES);
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	sizeAfter = [self databaseFileSize];
+	
+	NSLog(@"Update (indexed values changed)  : total time: %.6f, count: %lu, file growth: %.2f MB",
+	      elapsed, (unsigned long)count, (double)(sizeAfter - MIN(sizeBefore, sizeAfter)) / (1024.0 * 1024.0));
+	
+	[database unregisterExtensionWithName:@"ftsBenchmark"];
+	[database unregisterExtensionWithName:@"indexBenchmark"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:indexCollection];
+	}];
+}
+
++ (void)substringSearchWithCount:(NSUInteger)count
+{
+	NSString *const codeCollection = @"substringBenchmark";
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString *collection, NSString __unused *key, id object)
+	{
+		if ([collection isEqualToString:codeCollection]) {
+			[dict setObject:object forKey:@"code"];
+		}
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"code"]
+	                                                 options:@{ @"tokenize": YapDatabaseFullTextSearchTrigramTokenizer }
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS5Version
+	                                              versionTag:@"1"];
+	
+	if (![database registerExtension:fts withName:@"substringBenchmark"])
+	{
+		NSLog(@"Skipping substring search: the trigram tokenizer requires sqlite 3.34.0+");
+		return;
+	}
+	
+	for (NSUInteger i = 0; i < count; i += 1000)
+	{
+		[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			for (NSUInteger j = i; j < MIN(i + 1000, count); j++)
+			{
+				NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)j];
+				NSString *code = [NSString stringWithFormat:@"%@-%@-%@",
+				                  [self randomLetters:4], [self randomLetters:8], [self randomLetters:4]];
+				
+				[transaction setObject:code forKey:key inCollection:codeCollection];
+			}
+		}];
+	}
+	
+	NSUInteger const queryCount = 100;
+	
+	NSMutableArray<NSString *> *substrings = [NSMutableArray arrayWithCapacity:queryCount];
+	for (NSUInteger i = 0; i < queryCount; i++)
+	{
+		[substrings addObject:[self randomLetters:4]];
+	}
+	
+	__block NSUInteger matchCount = 0;
+	
+	NSDate *start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSString *substring in substrings)
+		{
+			[transaction enumerateKeysAndObjectsInCollection:codeCollection
+			                                      usingBlock:^(NSString *key, id object, BOOL *stop)
+			{
+				if ([(NSString *)object rangeOfString:substring options:NSCaseInsensitiveSearch].location != NSNotFound) {
+					matchCount++;
+				}
+			}];
+		}
+	}];
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Substring search (scan)   : total time: %.6f, queries: %lu, matches: %lu",
+	      elapsed, (unsigned long)queryCount, (unsigned long)matchCount);
+	
+	matchCount = 0;
+	start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSString *substring in substrings)
+		{
+			[[transaction ext:@"substringBenchmark"] enumerateKeysContainingSubstring:substring
+			                                                               usingBlock:
+			    ^(NSString *collection, NSString *key, BOOL *stop)
+			{
+				matchCount++;
+			}];
+		}
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Substring search (trigram): total time: %.6f, queries: %lu, matches: %lu",
+	      elapsed, (unsigned long)queryCount, (unsigned long)matchCount);
+	
+	matchCount = 0;
+	start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSString *substring in substrings)
+		{
+			NSString *pattern = [NSString stringWithFormat:@"%%-%@%%", substring];
+			
+			[[transaction ext:@"substringBenchmark"] enumerateKeysInColumn:@"code"
+			                                                          like:pattern
+			                                                    usingBlock:
+			    ^(NSString *collection, NSString *key, BOOL *stop)
+			{
+				matchCount++;
+			}];
+		}
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"LIKE search (trigram)     : total time: %.6f, queries: %lu, matches: %lu",
+	      elapsed, (unsigned long)queryCount, (unsigned long)matchCount);
+	
+	[database unregisterExtensionWithName:@"substringBenchmark"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:codeCollection];
+	}];
+}
+
++ (void)fullTextSearchFirstPageWithCount:(NSUInteger)count
+{
+	NSString *const ftsCollection = @"pageBenchmark";
+	
+	// Every document contains the query term, so every document is a hit.
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)i];
+			
+			NSMutableArray<NSString *> *words = [NSMutableArray arrayWithCapacity:20];
+			[words addObject:@"common"];
+			for (NSUInteger j = 0; j < 19; j++)
+			{
+				[words addObject:(arc4random_uniform(4) == 0 ? @"common" : [self randomLetters:6])];
+			}
+			
+			[transaction setObject:[words componentsJoinedByString:@" "] forKey:key inCollection:ftsCollection];
+		}
+	}];
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString *collection, NSString __unused *key, id object)
+	{
+		if ([collection isEqualToString:ftsCollection]) {
+			[dict setObject:object forKey:@"content"];
+		}
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 options:nil
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS5Version
+	                                              versionTag:@"1"];
+	
+	[database registerExtension:fts withName:@"pageBenchmark"];
+	
+	NSUInteger const pageSize = 20;
+	NSUInteger const loopCount = 10;
+	
+	__block NSUInteger resultCount = 0;
+	NSDate *start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < loopCount; i++)
+		{
+			__block NSUInteger pageCount = 0;
+			[[transaction ext:@"pageBenchmark"] enumerateBm25OrderedKeysMatching:@"common"
+			                                                        withWeights:nil
+			                                                         usingBlock:
+			    ^(NSString *collection, NSString *key, BOOL *stop)
+			{
+				resultCount++;
+				if (++pageCount == pageSize) *stop = YES;
+			}];
+		}
+	}];
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"First page (rank all, stop early): avg latency: %.6f, hits: %lu, results: %lu",
+	      (elapsed / loopCount), (unsigned long)count, (unsigned long)resultCount);
+	
+	resultCount = 0;
+	start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < loopCount; i++)
+		{
+			[[transaction ext:@"pageBenchmark"] enumerateBm25OrderedKeysMatching:@"common"
+			                                                        withWeights:nil
+			                                                              limit:pageSize
+			                                                             offset:0
+			                                                         usingBlock:
+			    ^(NSString *collection, NSString *key, BOOL *stop)
+			{
+				resultCount++;
+			}];
+		}
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"First page (LIMIT)               : avg latency: %.6f, hits: %lu, results: %lu",
+	      (elapsed / loopCount), (unsigned long)count, (unsigned long)resultCount);
+	
+	resultCount = 0;
+	start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < loopCount; i++)
+		{
+			[[transaction ext:@"pageBenchmark"] enumerateBm25OrderedKeysMatching:@"common"
+			                                                        withWeights:nil
+			                                                              limit:pageSize
+			                                                             offset:(pageSize * 10)
+			                                                         usingBlock:
+			    ^(NSString *collection, NSString *key, BOOL *stop)
+			{
+				resultCount++;
+			}];
+		}
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"11th page (LIMIT + OFFSET)       : avg latency: %.6f, hits: %lu, results: %lu",
+	      (elapsed / loopCount), (unsigned long)count, (unsigned long)resultCount);
+	
+	[database unregisterExtensionWithName:@"pageBenchmark"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:ftsCollection];
+	}];
+}
+
++ (void)indexQueryObjectsWithCount:(NSUInteger)count
+{
+	NSString *const indexCollection = @"indexQueryBenchmark";
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"rank" withType:YapDatabaseSecondaryIndexTypeInteger];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString *collection, NSString __unused *key, id object)
+	{
+		if ([collection isEqualToString:indexCollection]) {
+			[dict setObject:[(NSDictionary *)object objectForKey:@"rank"] forKey:@"rank"];
+		}
+	}];
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler];
+	
+	[database registerExtension:secondaryIndex withName:@"indexQueryBenchmark"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)i];
+			NSDictionary *object = @{ @"rank":@(arc4random_uniform(1000)), @"text":[self randomLetters:100] };
+			
+			[transaction setObject:object forKey:key inCollection:indexCollection];
+		}
+	}];
+	
+	// Use a connection without an object cache, so every object is read from the database.
+	
+	YapDatabaseConnection *uncachedConnection = [database newConnection];
+	uncachedConnection.objectCacheEnabled = NO;
+	
+	YapDatabaseQuery *query = [YapDatabaseQuery queryWithFormat:@"WHERE rank < ? ORDER BY rank", @(500)];
+	
+	__block NSUInteger matchCount = 0;
+	NSDate *start = [NSDate date];
+	
+	[uncachedConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[[transaction ext:@"indexQueryBenchmark"] enumerateKeysAndObjectsMatchingQuery:query usingBlock:
+		    ^(NSString __unused *collection, NSString __unused *key, id __unused object, BOOL __unused *stop)
+		{
+			matchCount++;
+		}];
+	}];
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Query objects (single statement)   : total time: %.6f, matches: %lu", elapsed, (unsigned long)matchCount);
+	
+	matchCount = 0;
+	start = [NSDate date];
+	
+	[uncachedConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[[transaction ext:@"indexQueryBenchmark"] enumerateKeysMatchingQuery:query usingBlock:
+		    ^(NSString *collection, NSString *key, BOOL __unused *stop)
+		{
+			id __unused object = [transaction objectForKey:key inCollection:collection];
+			matchCount++;
+		}];
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Query keys + objectForKey (per row): total time: %.6f, matches: %lu", elapsed, (unsigned long)matchCount);
+	
+	[database unregisterExtensionWithName:@"indexQueryBenchmark"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:indexCollection];
+	}];
+}
+
++ (void)secondaryIndexPopulationWithCount:(NSUInteger)count
+{
+	NSString *const indexCollection = @"populationBenchmark";
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)i];
+			NSDictionary *object = @{ @"rank":@(arc4random_uniform(100000)), @"name":[self randomLetters:20] };
+			
+			[transaction setObject:object forKey:key inCollection:indexCollection];
+		}
+	}];
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"rank" withType:YapDatabaseSecondaryIndexTypeInteger];
+	[setup addColumn:@"name" withType:YapDatabaseSecondaryIndexTypeText];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString __unused *collection, NSString __unused *key, id object)
+	{
+		[dict setObject:[(NSDictionary *)object objectForKey:@"rank"] forKey:@"rank"];
+		[dict setObject:[(NSDictionary *)object objectForKey:@"name"] forKey:@"name"];
+	}];
+	
+	for (NSNumber *concurrency in @[ @(1), @(4) ])
+	{
+		YapDatabaseSecondaryIndexOptions *options = [[YapDatabaseSecondaryIndexOptions alloc] init];
+		options.allowedCollections = [[YapWhitelistBlacklist alloc] initWithWhitelist:[NSSet setWithObject:indexCollection]];
+		options.populationConcurrency = [concurrency unsignedIntegerValue];
+		
+		YapDatabaseSecondaryIndex *secondaryIndex =
+		  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler versionTag:@"1" options:options];
+		
+		NSDate *start = [NSDate date];
+		
+		[database registerExtension:secondaryIndex withName:@"populationBenchmark"];
+		
+		NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+		NSLog(@"Register secondary index (concurrency %@): total time: %.6f, count: %lu",
+		      concurrency, elapsed, (unsigned long)count);
+		
+		[database unregisterExtensionWithName:@"populationBenchmark"];
+	}
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:indexCollection];
+	}];
+}
+
++ (void)materializedAggregatesWithCount:(NSUInteger)count
+{
+	NSString *const aggregateCollection = @"aggregateBenchmark";
+	NSUInteger const groupCount = 20;
+	NSUInteger const loopCount = 1000;
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"category" withType:YapDatabaseSecondaryIndexTypeInteger];
+	[setup addColumn:@"amount" withType:YapDatabaseSecondaryIndexTypeInteger];
+	
+	[setup addAggregateWithName:@"total"
+	                   function:YapDatabaseSecondaryIndexAggregateFunctionSum
+	                     column:@"amount"
+	                    groupBy:@"category"
+	                  predicate:nil];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString __unused *collection, NSString __unused *key, id object)
+	{
+		[dict setObject:[(NSDictionary *)object objectForKey:@"category"] forKey:@"category"];
+		[dict setObject:[(NSDictionary *)object objectForKey:@"amount"] forKey:@"amount"];
+	}];
+	
+	YapDatabaseSecondaryIndexOptions *options = [[YapDatabaseSecondaryIndexOptions alloc] init];
+	options.allowedCollections = [[YapWhitelistBlacklist alloc] initWithWhitelist:[NSSet setWithObject:aggregateCollection]];
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler versionTag:@"1" options:options];
+	
+	[database registerExtension:secondaryIndex withName:@"aggregateBenchmark"];
+	
+	// Write cost: each write also updates the materialized aggregate
+	
+	NSDate *start = [NSDate date];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)i];
+			NSDictionary *object = @{ @"category":@(i % groupCount), @"amount":@(arc4random_uniform(1000)) };
+			
+			[transaction setObject:object forKey:key inCollection:aggregateCollection];
+		}
+	}];
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Insert rows (with materialized aggregate): total time: %.6f, count: %lu",
+	      elapsed, (unsigned long)count);
+	
+	// Read cost: aggregate query (scans the group) vs materialized aggregate (single lookup)
+	
+	start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < loopCount; i++)
+		{
+			YapDatabaseQuery *query =
+			  [YapDatabaseQuery queryWithAggregateFunction:@"SUM(amount)" format:@"WHERE category = ?", @(i % groupCount)];
+			
+			(void)[[transaction ext:@"aggregateBenchmark"] performAggregateQuery:query];
+		}
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"performAggregateQuery: total time: %.6f, loop count: %lu", elapsed, (unsigned long)loopCount);
+	
+	start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < loopCount; i++)
+		{
+			(void)[[transaction ext:@"aggregateBenchmark"] valueForAggregate:@"total" inGroup:@(i % groupCount)];
+		}
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"valueForAggregate:inGroup: total time: %.6f, loop count: %lu", elapsed, (unsigned long)loopCount);
+	
+	[database unregisterExtensionWithName:@"aggregateBenchmark"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:aggregateCollection];
+	}];
+}
+
++ (void)expressionIndexWritesWithCount:(NSUInteger)count
+{
+	NSString *const expressionCollection = @"expressionBenchmark";
+	
+	// Expression columns read the serialized metadata, so it's stored as JSON
+	
+	[database registerMetadataSerializer:^NSData *(NSString __unused *collection, NSString __unused *key, id metadata) {
+		
+		return [NSJSONSerialization dataWithJSONObject:metadata options:0 error:nil];
+		
+	} forCollection:expressionCollection];
+	
+	[database registerMetadataDeserializer:^id (NSString __unused *collection, NSString __unused *key, NSData *data) {
+		
+		return [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+		
+	} forCollection:expressionCollection];
+	
+	YapDatabaseSecondaryIndexOptions *options = [[YapDatabaseSecondaryIndexOptions alloc] init];
+	options.allowedCollections = [[YapWhitelistBlacklist alloc] initWithWhitelist:[NSSet setWithObject:expressionCollection]];
+	
+	// Block based index
+	
+	YapDatabaseSecondaryIndexSetup *blockSetup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[blockSetup addColumn:@"rank" withType:YapDatabaseSecondaryIndexTypeInteger];
+	[blockSetup addColumn:@"name" withType:YapDatabaseSecondaryIndexTypeText];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withMetadataBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString __unused *collection, NSString __unused *key, id metadata)
+	{
+		[dict setObject:[(NSDictionary *)metadata objectForKey:@"rank"] forKey:@"rank"];
+		[dict setObject:[(NSDictionary *)metadata objectForKey:@"name"] forKey:@"name"];
+	}];
+	
+	YapDatabaseSecondaryIndex *blockIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:blockSetup handler:handler versionTag:@"1" options:options];
+	
+	// Expression based index
+	
+	YapDatabaseSecondaryIndexSetup *expressionSetup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[expressionSetup addColumn:@"rank"
+	                  withType:YapDatabaseSecondaryIndexTypeInteger
+	                expression:@"json_extract(CAST(\"metadata\" AS TEXT), '$.rank')"];
+	[expressionSetup addColumn:@"name"
+	                  withType:YapDatabaseSecondaryIndexTypeText
+	                expression:@"json_extract(CAST(\"metadata\" AS TEXT), '$.name')"];
+	
+	YapDatabaseSecondaryIndex *expressionIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:expressionSetup versionTag:@"1" options:options];
+	
+	NSArray *indexes = @[ [NSNull null], blockIndex, expressionIndex ];
+	NSArray<NSString *> *names = @[ @"no index", @"block index", @"expression index" ];
+	
+	for (NSUInteger i = 0; i < [indexes count]; i++)
+	{
+		if (indexes[i] != [NSNull null]) {
+			[database registerExtension:indexes[i] withName:@"expressionBenchmark"];
+		}
+		
+		NSDate *start = [NSDate date];
+		
+		[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			for (NSUInteger n = 0; n < count; n++)
+			{
+				NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)n];
+				NSDictionary *metadata = @{ @"rank":@(arc4random_uniform(100000)), @"name":[self randomLetters:20] };
+				
+				[transaction setObject:key forKey:key inCollection:expressionCollection withMetadata:metadata];
+			}
+		}];
+		
+		NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+		NSLog(@"Insert rows (%@): total time: %.6f, count: %lu", names[i], elapsed, (unsigned long)count);
+		
+		if (indexes[i] != [NSNull null]) {
+			[database unregisterExtensionWithName:@"expressionBenchmark"];
+		}
+		
+		[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			[transaction removeAllObjectsInCollection:expressionCollection];
+		}];
+	}
+}
+
++ (void)combinedQueryWithCount:(NSUInteger)count
+{
+	NSString *const combinedCollection = @"combinedBenchmark";
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"status" withType:YapDatabaseSecondaryIndexTypeInteger];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString *collection, NSString __unused *key, id object)
+	{
+		if ([collection isEqualToString:combinedCollection])
+			[dict setObject:[(NSDictionary *)object objectForKey:@"status"] forKey:@"status"];
+	}];
+	
+	YapDatabaseRTreeIndexSetup *rTreeSetup = [[YapDatabaseRTreeIndexSetup alloc] init];
+	[rTreeSetup setColumns:@[ @"minX", @"maxX", @"minY", @"maxY" ]];
+	
+	YapDatabaseRTreeIndexHandler *rTreeHandler = [YapDatabaseRTreeIndexHandler withObjectBlock:
+	    ^(NSMutableDictionary *dict, NSString *collection, NSString __unused *key, id object)
+	{
+		if ([collection isEqualToString:combinedCollection])
+		{
+			NSNumber *x = [(NSDictionary *)object objectForKey:@"x"];
+			NSNumber *y = [(NSDictionary *)object objectForKey:@"y"];
+			
+			[dict setObject:x forKey:@"minX"];
+			[dict setObject:x forKey:@"maxX"];
+			[dict setObject:y forKey:@"minY"];
+			[dict setObject:y forKey:@"maxY"];
+		}
+	}];
+	
+	YapDatabaseFullTextSearchHandler *ftsHandler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary *dict,
+	      NSString *collection, NSString __unused *key, id object)
+	{
+		if ([collection isEqualToString:combinedCollection])
+			[dict setObject:[(NSDictionary *)object objectForKey:@"name"] forKey:@"name"];
+	}];
+	
+	[database registerExtension:[[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler]
+	                   withName:@"combinedIdx"];
+	[database registerExtension:[[YapDatabaseRTreeIndex alloc] initWithSetup:rTreeSetup handler:rTreeHandler]
+	                   withName:@"combinedRTree"];
+	[database registerExtension:[[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[ @"name" ] handler:ftsHandler]
+	                   withName:@"combinedFts"];
+	
+	NSArray<NSString *> *words = @[ @"coffee", @"tea", @"juice", @"bakery", @"pizza" ];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger n = 0; n < count; n++)
+		{
+			NSDictionary *object = @{
+			  @"name"   : [NSString stringWithFormat:@"%@ %@", words[arc4random_uniform(5)], [self randomLetters:8]],
+			  @"status" : @(arc4random_uniform(10)),
+			  @"x"      : @(arc4random_uniform(1000)),
+			  @"y"      : @(arc4random_uniform(1000))
+			};
+			
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)n];
+			[transaction setObject:object forKey:key inCollection:combinedCollection];
+		}
+	}];
+	
+	YapDatabaseQuery *boxQuery =
+	  [YapDatabaseQuery queryWithFormat:@"WHERE minX >= ? AND maxX <= ? AND minY >= ? AND maxY <= ?",
+	                                     @(100), @(400), @(100), @(400)];
+	YapDatabaseQuery *statusQuery = [YapDatabaseQuery queryWithFormat:@"WHERE status = ?", @(3)];
+	
+	// Separate enumerations, intersected in objective-c
+	
+	__block NSUInteger separateCount = 0;
+	NSDate *start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSMutableSet<YapCollectionKey *> *textMatches = [NSMutableSet set];
+		NSMutableSet<YapCollectionKey *> *boxMatches = [NSMutableSet set];
+		
+		[[transaction ext:@"combinedFts"] enumerateKeysMatching:@"coffee"
+		                                             usingBlock:^(NSString *collection, NSString *key, BOOL *stop)
+		{
+			[textMatches addObject:YapCollectionKeyCreate(collection, key)];
+		}];
+		
+		[[transaction ext:@"combinedRTree"] enumerateKeysMatchingQuery:boxQuery
+		                                                    usingBlock:^(NSString *collection, NSString *key, BOOL *stop)
+		{
+			[boxMatches addObject:YapCollectionKeyCreate(collection, key)];
+		}];
+		
+		[textMatches intersectSet:boxMatches];
+		
+		[[transaction ext:@"combinedIdx"] enumerateKeysMatchingQuery:statusQuery
+		                                                  usingBlock:^(NSString *collection, NSString *key, BOOL *stop)
+		{
+			if ([textMatches containsObject:YapCollectionKeyCreate(collection, key)]) {
+				separateCount++;
+			}
+		}];
+	}];
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Separate queries + intersection: total time: %.6f, matches: %lu", elapsed, (unsigned long)separateCount);
+	
+	// Combined query
+	
+	__block NSUInteger combinedCount = 0;
+	start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSDictionary *queries = @{
+		  @"combinedFts"   : [[transaction ext:@"combinedFts"] queryMatching:@"coffee"],
+		  @"combinedRTree" : boxQuery,
+		  @"combinedIdx"   : statusQuery
+		};
+		
+		[transaction enumerateKeysMatchingQueries:queries
+		                               usingBlock:^(NSString *collection, NSString *key, BOOL *stop)
+		{
+			combinedCount++;
+		}];
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Combined query: total time: %.6f, matches: %lu", elapsed, (unsigned long)combinedCount);
+	
+	[database unregisterExtensionWithName:@"combinedIdx"];
+	[database unregisterExtensionWithName:@"combinedRTree"];
+	[database unregisterExtensionWithName:@"combinedFts"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:combinedCollection];
+	}];
+}
+
++ (void)rTreePopulationWithCount:(NSUInteger)count
+{
+	NSString *const rTreeCollection = @"rTreeBenchmark";
+	
+	// The rtree is populated in rowid order (i.e. the order in which the objects were inserted).
+	// So we compare the same bounding boxes, inserted in random order vs Sort-Tile-Recursive order.
+	
+	NSMutableArray<NSDictionary *> *boxes = [NSMutableArray arrayWithCapacity:count];
+	for (NSUInteger n = 0; n < count; n++)
+	{
+		double x = arc4random_uniform(100000) / 100.0;
+		double y = arc4random_uniform(100000) / 100.0;
+		
+		[boxes addObject:@{
+		  @"minX" : @(x), @"maxX" : @(x + arc4random_uniform(100) / 100.0),
+		  @"minY" : @(y), @"maxY" : @(y + arc4random_uniform(100) / 100.0)
+		}];
+	}
+	
+	// Sort-Tile-Recursive (2D):
+	// Sort by center x, cut into vertical slices of (sliceCount * nodeCapacity) boxes,
+	// and sort each slice by center y. Consecutive runs of nodeCapacity boxes then form compact tiles.
+	//
+	// The sqlite rtree module caps a node at 51 cells.
+	
+	NSUInteger const nodeCapacity = 51;
+	
+	NSComparator compareCenterX = ^NSComparisonResult (NSDictionary *box1, NSDictionary *box2) {
+		
+		double center1 = [box1[@"minX"] doubleValue] + [box1[@"maxX"] doubleValue];
+		double center2 = [box2[@"minX"] doubleValue] + [box2[@"maxX"] doubleValue];
+		
+		return [@(center1) compare:@(center2)];
+	};
+	
+	NSComparator compareCenterY = ^NSComparisonResult (NSDictionary *box1, NSDictionary *box2) {
+		
+		double center1 = [box1[@"minY"] doubleValue] + [box1[@"maxY"] doubleValue];
+		double center2 = [box2[@"minY"] doubleValue] + [box2[@"maxY"] doubleValue];
+		
+		return [@(center1) compare:@(center2)];
+	};
+	
+	NSUInteger leafCount = (count + nodeCapacity - 1) / nodeCapacity;
+	NSUInteger sliceCount = (NSUInteger)ceil(sqrt((double)leafCount));
+	NSUInteger sliceLength = MAX(sliceCount * nodeCapacity, (NSUInteger)1);
+	
+	NSMutableArray<NSDictionary *> *tiledBoxes =
+	  [[boxes sortedArrayUsingComparator:compareCenterX] mutableCopy];
+	
+	for (NSUInteger offset = 0; offset < count; offset += sliceLength)
+	{
+		NSRange range = NSMakeRange(offset, MIN(sliceLength, count - offset));
+		NSArray<NSDictionary *> *slice =
+		  [[tiledBoxes subarrayWithRange:range] sortedArrayUsingComparator:compareCenterY];
+		
+		[tiledBoxes replaceObjectsInRange:range withObjectsFromArray:slice];
+	}
+	
+	YapDatabaseRTreeIndexSetup *setup = [[YapDatabaseRTreeIndexSetup alloc] init];
+	[setup setColumns:@[ @"minX", @"maxX", @"minY", @"maxY" ]];
+	
+	YapDatabaseRTreeIndexHandler *handler = [YapDatabaseRTreeIndexHandler withObjectBlock:
+	    ^(NSMutableDictionary *dict, NSString __unused *collection, NSString __unused *key, id object)
+	{
+		[dict addEntriesFromDictionary:(NSDictionary *)object];
+	}];
+	
+	YapDatabaseRTreeIndexOptions *options = [[YapDatabaseRTreeIndexOptions alloc] init];
+	options.allowedCollections = [[YapWhitelistBlacklist alloc] initWithWhitelist:[NSSet setWithObject:rTreeCollection]];
+	
+	NSUInteger queryCount = 1000;
+	
+	NSMutableArray<YapDatabaseQuery *> *queries = [NSMutableArray arrayWithCapacity:queryCount];
+	for (NSUInteger i = 0; i < queryCount; i++)
+	{
+		double x = arc4random_uniform(99000) / 100.0;
+		double y = arc4random_uniform(99000) / 100.0;
+		
+		[queries addObject:[YapDatabaseQuery queryWithFormat:
+		  @"WHERE minX >= ? AND maxX <= ? AND minY >= ? AND maxY <= ?", @(x), @(x + 10.0), @(y), @(y + 10.0)]];
+	}
+	
+	NSDictionary<NSString *, NSArray<NSDictionary *> *> *orderings = @{ @"Random" : boxes, @"STR" : tiledBoxes };
+	
+	for (NSString *orderName in @[ @"Random", @"STR" ])
+	{
+		NSArray<NSDictionary *> *orderedBoxes = orderings[orderName];
+		
+		[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			NSUInteger n = 0;
+			for (NSDictionary *object in orderedBoxes)
+			{
+				NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)n++];
+				[transaction setObject:object forKey:key inCollection:rTreeCollection];
+			}
+		}];
+		
+		YapDatabaseRTreeIndex *rTreeIndex =
+		  [[YapDatabaseRTreeIndex alloc] initWithSetup:setup handler:handler versionTag:@"1" options:options];
+		
+		NSDate *start = [NSDate date];
+		
+		[database registerExtension:rTreeIndex withName:@"rTreeBenchmarkIdx"];
+		
+		NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+		NSLog(@"%@ order population: total time: %.6f", orderName, elapsed);
+		
+		__block NSUInteger matches = 0;
+		start = [NSDate date];
+		
+		[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			for (YapDatabaseQuery *query in queries)
+			{
+				NSUInteger queryMatches = 0;
+				[[transaction ext:@"rTreeBenchmarkIdx"] getNumberOfRows:&queryMatches matchingQuery:query];
+				
+				matches += queryMatches;
+			}
+		}];
+		
+		elapsed = [start timeIntervalSinceNow] * -1.0;
+		NSLog(@"%@ order population: %lu window queries: total time: %.6f, matches: %lu",
+		      orderName, (unsigned long)queryCount, elapsed, (unsigned long)matches);
+		
+		[database unregisterExtensionWithName:@"rTreeBenchmarkIdx"];
+		
+		[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			[transaction removeAllObjectsInCollection:rTreeCollection];
+		}];
+	}
+}
+
++ (void)nearestNeighborsWithCount:(NSUInteger)count
+{
+	NSString *const nearestCollection = @"nearestBenchmark";
+	
+	YapDatabaseRTreeIndexSetup *setup = [[YapDatabaseRTreeIndexSetup alloc] init];
+	[setup setColumns:@[ @"minX", @"maxX", @"minY", @"maxY" ]];
+	
+	YapDatabaseRTreeIndexHandler *handler = [YapDatabaseRTreeIndexHandler withObjectBlock:
+	    ^(NSMutableDictionary *dict, NSString *collection, NSString __unused *key, id object)
+	{
+		if ([collection isEqualToString:nearestCollection])
+		{
+			NSNumber *x = [(NSDictionary *)object objectForKey:@"x"];
+			NSNumber *y = [(NSDictionary *)object objectForKey:@"y"];
+			
+			[dict setObject:x forKey:@"minX"];
+			[dict setObject:x forKey:@"maxX"];
+			[dict setObject:y forKey:@"minY"];
+			[dict setObject:y forKey:@"maxY"];
+		}
+	}];
+	
+	[database registerExtension:[[YapDatabaseRTreeIndex alloc] initWithSetup:setup handler:handler]
+	                   withName:@"nearestRTree"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger n = 0; n < count; n++)
+		{
+			NSDictionary *object = @{
+			  @"x" : @(arc4random_uniform(100000) / 100.0),
+			  @"y" : @(arc4random_uniform(100000) / 100.0)
+			};
+			
+			NSString *key = [NSString stringWithFormat:@"%08lu", (unsigned long)n];
+			[transaction setObject:object forKey:key inCollection:nearestCollection];
+		}
+	}];
+	
+	NSUInteger queryCount = 1000;
+	NSUInteger k = 10;
+	
+	NSMutableArray<NSArray<NSNumber *> *> *points = [NSMutableArray arrayWithCapacity:queryCount];
+	for (NSUInteger i = 0; i < queryCount; i++)
+	{
+		[points addObject:@[ @(arc4random_uniform(100000) / 100.0), @(arc4random_uniform(100000) / 100.0) ]];
+	}
+	
+	// Widening window emulation:
+	// Query a box around the point, doubling its size until it contains at least k rows
+	// (and the k-th closest row is within the box's inscribed circle), then sort by distance.
+	
+	__block NSUInteger windowMatches = 0;
+	NSDate *start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSArray<NSNumber *> *point in points)
+		{
+			double x = [point[0] doubleValue];
+			double y = [point[1] doubleValue];
+			
+			NSMutableArray<NSNumber *> *distances = nil;
+			double radius = 5.0;
+			
+			while (YES)
+			{
+				distances = [NSMutableArray array];
+				
+				YapDatabaseQuery *query =
+				  [YapDatabaseQuery queryWithFormat:@"WHERE minX >= ? AND maxX <= ? AND minY >= ? AND maxY <= ?",
+				                                     @(x - radius), @(x + radius), @(y - radius), @(y + radius)];
+				
+				[[transaction ext:@"nearestRTree"] enumerateKeysAndObjectsMatchingQuery:query
+				                                                             usingBlock:
+				    ^(NSString *collection, NSString *key, id object, BOOL *stop)
+				{
+					double dx = [[(NSDictionary *)object objectForKey:@"x"] doubleValue] - x;
+					double dy = [[(NSDictionary *)object objectForKey:@"y"] doubleValue] - y;
+					
+					[distances addObject:@(sqrt((dx * dx) + (dy * dy)))];
+				}];
+				
+				[distances sortUsingSelector:@selector(compare:)];
+				
+				if (distances.count >= k && [distances[k - 1] doubleValue] <= radius) break;
+				if (radius > 2000.0) break;
+				
+				radius *= 2.0;
+			}
+			
+			windowMatches += MIN(distances.count, k);
+		}
+	}];
+	
+	NSTimeInterval elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Widening window (k=%lu): %lu queries: total time: %.6f, matches: %lu",
+	      (unsigned long)k, (unsigned long)queryCount, elapsed, (unsigned long)windowMatches);
+	
+	// Nearest neighbor query
+	
+	__block NSUInteger nearestMatches = 0;
+	start = [NSDate date];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSArray<NSNumber *> *point in points)
+		{
+			[[transaction ext:@"nearestRTree"] enumerateKeysAndObjectsNearestToPoint:point
+			                                                                   limit:k
+			                                                              usingBlock:
+			    ^(NSString *collection, NSString *key, id object, BOOL *stop)
+			{
+				nearestMatches++;
+			}];
+		}
+	}];
+	
+	elapsed = [start timeIntervalSinceNow] * -1.0;
+	NSLog(@"Nearest neighbors (k=%lu): %lu queries: total time: %.6f, matches: %lu",
+	      (unsigned long)k, (unsigned long)queryCount, elapsed, (unsigned long)nearestMatches);
+	
+	[database unregisterExtensionWithName:@"nearestRTree"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:nearestCollection];
+	}];
+}
+
++ (void)relationshipAdjacencyWithCount:(NSUInteger)count
+{
+	NSString *const parentCollection = @"adjacencyParents";
+	NSString *const childCollection = @"adjacencyChildren";
+	
+	NSUInteger childrenPerParent = 10;
+	NSUInteger parentCount = count / childrenPerParent;
+	
+	[database registerExtension:[[YapDatabaseRelationship alloc] init] withName:@"adjacencyRelationship"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger p = 0; p < parentCount; p++)
+		{
+			NSString *parentKey = [NSString stringWithFormat:@"%08lu", (unsigned long)p];
+			[transaction setObject:parentKey forKey:parentKey inCollection:parentCollection];
+			
+			for (NSUInteger c = 0; c < childrenPerParent; c++)
+			{
+				NSString *childKey = [NSString stringWithFormat:@"%08lu-%02lu", (unsigned long)p, (unsigned long)c];
+				[transaction setObject:childKey forKey:childKey inCollection:childCollection];
+				
+				[[transaction ext:@"adjacencyRelationship"] addEdge:
+				  [YapDatabaseRelationshipEdge edgeWithName:@"child"
+				                                  sourceKey:parentKey
+				                                 collection:parentCollection
+				                             destinationKey:childKey
+				                                 collection:childCollection
+				                            nodeDeleteRules:YDB_DeleteDestinationIfSourceDeleted]];
+			}
+		}
+	}];
+	
+	// A "screen" repeatedly asks for the children of the same (small) set of parents
+	
+	NSUInteger screenSize = 100;
+	NSUInteger passes = 50;
+	
+	NSMutableArray<NSString *> *screenKeys = [NSMutableArray arrayWithCapacity:screenSize];
+	for (NSUInteger i = 0; i < screenSize; i++)
+	{
+		NSUInteger p = arc4random_uniform((uint32_t)parentCount);
+		[screenKeys addObject:[NSString stringWithFormat:@"%08lu", (unsigned long)p]];
+	}
+	
+	NSTimeInterval (^enumerateScreen)(NSUInteger *) = ^NSTimeInterval (NSUInteger *matches){
+		
+		__block NSUInteger total = 0;
+		NSDate *start = [NSDate date];
+		
+		for (NSUInteger pass = 0; pass < passes; pass++)
+		{
+			[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+				
+				for (NSString *parentKey in screenKeys)
+				{
+					[[transaction ext:@"adjacencyRelationship"] enumerateEdgesWithName:@"child"
+					                                                          sourceKey:parentKey
+					                                                         collection:parentCollection
+					                                                         usingBlock:
+					    ^(YapDatabaseRelationshipEdge *edge, BOOL *stop)
+					{
+						if (edge.destinationKey) total++;
+					}];
+				}
+			}];
+		}
+		
+		*matches = total;
+		return [start timeIntervalSinceNow] * -1.0;
+	};
+	
+	NSUInteger matches = 0;
+	NSTimeInterval elapsed = 0;
+	
+	[[connection ext:@"adjacencyRelationship"] setAdjacencyCacheEnabled:NO];
+	
+	elapsed = enumerateScreen(&matches);
+	NSLog(@"Adjacency cache disabled: %lu enumerations: total time: %.6f, edges: %lu",
+	      (unsigned long)(screenSize * passes), elapsed, (unsigned long)matches);
+	
+	[[connection ext:@"adjacencyRelationship"] setAdjacencyCacheEnabled:YES];
+	
+	elapsed = enumerateScreen(&matches);
+	NSLog(@"Adjacency cache enabled:  %lu enumerations: total time: %.6f, edges: %lu",
+	      (unsigned long)(screenSize * passes), elapsed, (unsigned long)matches);
+	
+	[database unregisterExtensionWithName:@"adjacencyRelationship"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:parentCollection];
+		[transaction removeAllObjectsInCollection:childCollection];
+	}];
+}
+
 + (void)removeAllValues
 {
 	NSDate *start = [NSDate date];
@@ -312,6 +2021,140 @@ static NSMutableArray *keys;
 		
 		NSLog(@"====================================================");
 	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"VIEW ENUMERATION");
+		
+		[self enumerateViewGroup:100000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"VIEW CHANGESET");
+		
+		[self viewChangesetWithCount:1000];
+		[self viewChangesetWithCount:10000];
+		[self viewChangesetWithCount:50000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"FILTERED VIEW REFILTER");
+		
+		[self refilterWithConcurrency:1 count:100000];
+		[self refilterWithConcurrency:2 count:100000];
+		[self refilterWithConcurrency:4 count:100000];
+		[self refilterWithConcurrency:[[NSProcessInfo processInfo] activeProcessorCount] count:100000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"FULL TEXT SEARCH STORAGE");
+		
+		[self fullTextSearchContentless:NO count:20000];
+		[self fullTextSearchContentless:YES count:20000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"FULL TEXT SEARCH MAINTENANCE");
+		
+		[self fullTextSearchMaintenanceWithCount:10000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"INDEXED UPDATES");
+		
+		[self indexedUpdatesWithCount:10000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"SUBSTRING SEARCH");
+		
+		[self substringSearchWithCount:100000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"FULL TEXT SEARCH FIRST PAGE");
+		
+		[self fullTextSearchFirstPageWithCount:150000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"INDEX QUERY OBJECTS");
+		
+		[self indexQueryObjectsWithCount:100000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"SECONDARY INDEX POPULATION");
+		
+		[self secondaryIndexPopulationWithCount:200000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"MATERIALIZED AGGREGATES");
+		
+		[self materializedAggregatesWithCount:100000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"EXPRESSION INDEX WRITES");
+		
+		[self expressionIndexWritesWithCount:100000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"COMBINED QUERY");
+		
+		[self combinedQueryWithCount:100000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"RTREE POPULATION");
+		
+		[self rTreePopulationWithCount:100000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"NEAREST NEIGHBORS");
+		
+		[self nearestNeighborsWithCount:100000];
+		
+		NSLog(@"====================================================");
+	});
+	dispatch_async(dispatch_get_main_queue(), ^{
+		
+		NSLog(@"RELATIONSHIP ADJACENCY CACHE");
+		
+		[self relationshipAdjacencyWithCount:100000];
+		
+		NSLog(@"====================================================");
+	});
 	dispatch_async(dispatch_get_main_queue(), ^{
 		
 		NSLog(@"REMOVE ALL");
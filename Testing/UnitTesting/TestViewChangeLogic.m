@@ -993,6 +993,105 @@ static YapDatabaseViewRowChange* (^RowOp)(NSArray*, NSUInteger) = ^(NSArray *rCh
 	XCTAssertTrue(RowOp(changes, 0).finalIndex == 2, @"");
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Row: Large Batch
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_row_10A
+{
+	// A large transaction with a random mix of inserts, deletes & moves.
+	// The consolidated changes must reference the proper original & final index for every key.
+	
+	NSMutableArray *originalKeys = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 1000; i++)
+	{
+		[originalKeys addObject:[NSString stringWithFormat:@"key-%lu", (unsigned long)i]];
+	}
+	
+	NSMutableArray *finalKeys = [originalKeys mutableCopy];
+	NSUInteger nextKey = [originalKeys count];
+	
+	__block uint32_t seed = 42;
+	uint32_t (^Random)(uint32_t) = ^uint32_t (uint32_t upperBound){
+		
+		seed = (seed * 1103515245) + 12345;
+		return (seed >> 8) % upperBound;
+	};
+	
+	for (NSUInteger i = 0; i < 5000; i++)
+	{
+		uint32_t op = Random(3);
+		
+		if (op == 0 || [finalKeys count] == 0)
+		{
+			// Insert
+			
+			NSString *key = [NSString stringWithFormat:@"key-%lu", (unsigned long)nextKey++];
+			NSUInteger index = Random((uint32_t)[finalKeys count] + 1);
+			
+			[finalKeys insertObject:key atIndex:index];
+			[changes addObject:[YapDatabaseViewRowChange insertCollectionKey:YCK(nil, key) inGroup:@"" atIndex:index]];
+		}
+		else if (op == 1)
+		{
+			// Delete
+			
+			NSUInteger index = Random((uint32_t)[finalKeys count]);
+			NSString *key = [finalKeys objectAtIndex:index];
+			
+			[finalKeys removeObjectAtIndex:index];
+			[changes addObject:[YapDatabaseViewRowChange deleteCollectionKey:YCK(nil, key) inGroup:@"" atIndex:index]];
+		}
+		else
+		{
+			// Move (delete + insert)
+			
+			NSUInteger index = Random((uint32_t)[finalKeys count]);
+			NSString *key = [finalKeys objectAtIndex:index];
+			
+			[finalKeys removeObjectAtIndex:index];
+			[changes addObject:[YapDatabaseViewRowChange deleteCollectionKey:YCK(nil, key) inGroup:@"" atIndex:index]];
+			
+			index = Random((uint32_t)[finalKeys count] + 1);
+			
+			[finalKeys insertObject:key atIndex:index];
+			[changes addObject:[YapDatabaseViewRowChange insertCollectionKey:YCK(nil, key) inGroup:@"" atIndex:index]];
+		}
+	}
+	
+	// Process
+	
+	[YapDatabaseViewChange processRowChanges:changes withOriginalMappings:nil finalMappings:nil];
+	[YapDatabaseViewChange consolidateRowChanges:changes];
+	
+	// Verify
+	
+	NSMutableSet *changedKeys = [NSMutableSet set];
+	NSUInteger deleteCount = 0;
+	NSUInteger insertCount = 0;
+	
+	for (YapDatabaseViewRowChange *change in changes)
+	{
+		NSString *key = change.collectionKey.key;
+		
+		XCTAssertFalse([changedKeys containsObject:key], @"Multiple changes for key: %@", key);
+		[changedKeys addObject:key];
+		
+		if (change.type == YapDatabaseViewChangeDelete || change.type == YapDatabaseViewChangeMove)
+		{
+			XCTAssertEqualObjects([originalKeys objectAtIndex:change.originalIndex], key, @"Bad originalIndex");
+			deleteCount++;
+		}
+		if (change.type == YapDatabaseViewChangeInsert || change.type == YapDatabaseViewChangeMove)
+		{
+			XCTAssertEqualObjects([finalKeys objectAtIndex:change.finalIndex], key, @"Bad finalIndex");
+			insertCount++;
+		}
+	}
+	
+	XCTAssertTrue(([originalKeys count] - deleteCount + insertCount) == [finalKeys count], @"");
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark -
 #pragma mark Section: Insert
@@ -1461,6 +1461,61 @@ static NSMutableArray *changes;
 	XCTAssertTrue(rangePosition.offsetFromEnd == 0, @"");
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Fixed Range Beginning: Large Transaction
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_fixedRange_beginning_9A
+{
+	YapDatabaseViewMappings *mappings = [[YapDatabaseViewMappings alloc] initWithGroups:@[@""] view:@"view"];
+	
+	YapDatabaseViewRangeOptions *rangeOpts =
+	    [YapDatabaseViewRangeOptions fixedRangeWithLength:20 offset:0 from:YapDatabaseViewBeginning];
+	[mappings setRangeOptions:rangeOpts forGroup:@""];
+	
+	[mappings updateWithCounts:@{ @"":@(10000) } forceUpdateRangeOptions:NO];
+	YapDatabaseViewMappings *originalMappings = [mappings copy];
+	
+	// Move lots of items around, far away from the range
+	
+	for (NSUInteger i = 0; i < 1000; i++)
+	{
+		NSString *key = [NSString stringWithFormat:@"key-%lu", (unsigned long)i];
+		
+		[changes addObject:[YapDatabaseViewRowChange deleteCollectionKey:YCK(nil, key) inGroup:@"" atIndex:5000]];
+		[changes addObject:[YapDatabaseViewRowChange insertCollectionKey:YCK(nil, key) inGroup:@"" atIndex:8000]];
+	}
+	
+	// Move a single item into the range
+	
+	[changes addObject:[YapDatabaseViewRowChange deleteCollectionKey:YCK(nil, @"key") inGroup:@"" atIndex:500]];
+	[changes addObject:[YapDatabaseViewRowChange insertCollectionKey:YCK(nil, @"key") inGroup:@"" atIndex:3]];
+	
+	// Fetch changeset
+	
+	NSArray *rowChanges = nil;
+	
+	[mappings updateWithCounts:@{ @"":@(10000) } forceUpdateRangeOptions:NO];
+	[YapDatabaseViewChange getSectionChanges:NULL
+	                              rowChanges:&rowChanges
+	                    withOriginalMappings:originalMappings
+	                           finalMappings:mappings
+	                             fromChanges:changes];
+	
+	// Verify
+	
+	XCTAssertTrue([mappings numberOfItemsInGroup:@""] == 20, @"");
+	XCTAssertTrue([rowChanges count] == 2, @"");
+	
+	XCTAssertTrue(RowOp(rowChanges, 0).type == YapDatabaseViewChangeInsert, @"");
+	XCTAssertTrue(RowOp(rowChanges, 0).finalSection == 0, @"");
+	XCTAssertTrue(RowOp(rowChanges, 0).finalIndex == 3, @"");
+	
+	XCTAssertTrue(RowOp(rowChanges, 1).type == YapDatabaseViewChangeDelete, @"");
+	XCTAssertTrue(RowOp(rowChanges, 1).originalSection == 0, @"");
+	XCTAssertTrue(RowOp(rowChanges, 1).originalIndex == 19, @"");
+}
+
 @end
 
 
@@ -1784,4 +1784,119 @@
 	}];
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)testConcurrentFiltering
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection1 = [database newConnection];
+	YapDatabaseConnection *connection2 = [database newConnection];
+	
+	YapDatabaseViewGrouping *grouping = [YapDatabaseViewGrouping withObjectBlock:
+	    ^NSString *(YapDatabaseReadTransaction *transaction, NSString *collection, NSString *key, id object)
+	{
+		return ([(NSNumber *)object intValue] % 3 == 0) ? @"three" : @"other";
+	}];
+	
+	YapDatabaseViewSorting *sorting = [YapDatabaseViewSorting withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSString *group,
+	        NSString *collection1, NSString *key1, id obj1,
+	        NSString *collection2, NSString *key2, id obj2)
+	{
+		__unsafe_unretained NSNumber *number1 = (NSNumber *)obj1;
+		__unsafe_unretained NSNumber *number2 = (NSNumber *)obj2;
+		
+		return [number1 compare:number2];
+	}];
+	
+	YapDatabaseAutoView *view =
+	  [[YapDatabaseAutoView alloc] initWithGrouping:grouping sorting:sorting versionTag:@"1"];
+	
+	BOOL registerResult1 = [database registerExtension:view withName:@"order"];
+	XCTAssertTrue(registerResult1, @"Failure registering view extension");
+	
+	YapDatabaseViewFiltering *filtering = [YapDatabaseViewFiltering withObjectBlock:
+	    ^BOOL (YapDatabaseReadTransaction *transaction, NSString *group, NSString *collection, NSString *key, id object)
+	{
+		return ([(NSNumber *)object intValue] % 2 == 0); // even
+	}];
+	
+	YapDatabaseFilteredViewOptions *options = [[YapDatabaseFilteredViewOptions alloc] init];
+	options.filteringConcurrency = 4;
+	
+	YapDatabaseFilteredView *filteredView =
+	  [[YapDatabaseFilteredView alloc] initWithParentViewName:@"order"
+	                                                filtering:filtering
+	                                               versionTag:@"even"
+	                                                  options:options];
+	
+	BOOL registerResult2 = [database registerExtension:filteredView withName:@"filter"];
+	XCTAssertTrue(registerResult2, @"Failure registering filteredView extension");
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (int i = 0; i < 3000; i++)
+		{
+			[transaction setObject:@(i) forKey:[NSString stringWithFormat:@"key%d", i] inCollection:nil];
+		}
+	}];
+	
+	// Evaluated concurrently (the transaction hasn't modified any rows)
+	
+	YapDatabaseViewFiltering *filtering5 = [YapDatabaseViewFiltering withObjectBlock:
+	    ^BOOL (YapDatabaseReadTransaction *transaction, NSString *group, NSString *collection, NSString *key, id object)
+	{
+		return ([(NSNumber *)object intValue] % 5 == 0);
+	}];
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[[transaction ext:@"filter"] setFiltering:filtering5 versionTag:@"5"];
+		
+		NSUInteger count3 = [[transaction ext:@"filter"] numberOfItemsInGroup:@"three"];
+		NSUInteger countOther = [[transaction ext:@"filter"] numberOfItemsInGroup:@"other"];
+		
+		XCTAssertTrue(count3 == 200, @"Bad count. Expected 200, got %d", (int)count3);
+		XCTAssertTrue(countOther == 400, @"Bad count. Expected 400, got %d", (int)countOther);
+		
+		XCTAssertEqualObjects([[transaction ext:@"filter"] keyAtIndex:1 inGroup:@"three"], @"key15");
+		XCTAssertEqualObjects([[transaction ext:@"filter"] keyAtIndex:1 inGroup:@"other"], @"key10");
+	}];
+	
+	[connection2 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger count3 = [[transaction ext:@"filter"] numberOfItemsInGroup:@"three"];
+		NSUInteger countOther = [[transaction ext:@"filter"] numberOfItemsInGroup:@"other"];
+		
+		XCTAssertTrue(count3 == 200, @"Bad count. Expected 200, got %d", (int)count3);
+		XCTAssertTrue(countOther == 400, @"Bad count. Expected 400, got %d", (int)countOther);
+	}];
+	
+	// Evaluated serially (the transaction modified rows before changing the filter)
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@(3001) forKey:@"key0" inCollection:nil];
+		
+		[[transaction ext:@"filter"] setFiltering:filtering versionTag:@"even"];
+		
+		NSUInteger count3 = [[transaction ext:@"filter"] numberOfItemsInGroup:@"three"];
+		NSUInteger countOther = [[transaction ext:@"filter"] numberOfItemsInGroup:@"other"];
+		
+		XCTAssertTrue(count3 == 499, @"Bad count. Expected 499, got %d", (int)count3);
+		XCTAssertTrue(countOther == 1000, @"Bad count. Expected 1000, got %d", (int)countOther);
+	}];
+	
+	connection1 = nil;
+	connection2 = nil;
+}
+
 @end
@@ -234,4 +234,618 @@
 	}];
 }
 
+- (void)testContentless
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	if ([database.sqliteVersion compare:@"3.43.0" options:NSNumericSearch] == NSOrderedAscending)
+	{
+		NSLog(@"Skipping %@: contentless FTS requires sqlite 3.43.0+ (have %@)",
+		      NSStringFromSelector(_cmd), database.sqliteVersion);
+		return;
+	}
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict setObject:object forKey:@"content"];
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 options:nil
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS5Version
+	                                             contentless:YES
+	                                              versionTag:@"1"];
+	
+	[database registerExtension:fts withName:@"fts"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@"hello world"       forKey:@"key1" inCollection:nil];
+		[transaction setObject:@"hello coffee shop" forKey:@"key2" inCollection:nil];
+		[transaction setObject:@"hello laptop"      forKey:@"key3" inCollection:nil];
+		[transaction setObject:@"hello work"        forKey:@"key4" inCollection:nil];
+	}];
+	
+	// Updates & deletes must be reflected in the index
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@"hello distraction" forKey:@"key4" inCollection:nil];
+		[transaction removeObjectForKey:@"key3" inCollection:nil];
+	}];
+	
+	YapDatabaseFullTextSearchSnippetOptions *options = [YapDatabaseFullTextSearchSnippetOptions new];
+	options.startMatchText = @"[[";
+	options.endMatchText   = @"]]";
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		__block NSUInteger count;
+		
+		count = 0;
+		[[transaction ext:@"fts"] enumerateKeysMatching:@"hello"
+		                                     usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			count++;
+		}];
+		XCTAssertTrue(count == 3, @"Bad count: %lu", (unsigned long)count);
+		
+		count = 0;
+		[[transaction ext:@"fts"] enumerateKeysMatching:@"work OR laptop"
+		                                     usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			count++;
+		}];
+		XCTAssertTrue(count == 0, @"Bad count: %lu", (unsigned long)count);
+		
+		// Snippets are rebuilt from the objects
+		
+		count = 0;
+		[[transaction ext:@"fts"] enumerateKeysMatching:@"coffee"
+		                             withSnippetOptions:options
+		                                     usingBlock:
+		    ^(NSString *snippet, NSString *collection, NSString *key, BOOL *stop) {
+			
+			XCTAssertEqualObjects(key, @"key2");
+			XCTAssertEqualObjects(snippet, @"hello [[coffee]] shop");
+			count++;
+		}];
+		XCTAssertTrue(count == 1, @"Bad count: %lu", (unsigned long)count);
+		
+		count = 0;
+		[[transaction ext:@"fts"] enumerateKeysMatching:@"distraction"
+		                             withSnippetOptions:options
+		                                     usingBlock:
+		    ^(NSString *snippet, NSString *collection, NSString *key, BOOL *stop) {
+			
+			XCTAssertEqualObjects(snippet, @"hello [[distraction]]");
+			count++;
+		}];
+		XCTAssertTrue(count == 1, @"Bad count: %lu", (unsigned long)count);
+	}];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInAllCollections];
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		__block NSUInteger count = 0;
+		[[transaction ext:@"fts"] enumerateKeysMatching:@"hello"
+		                                     usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			count++;
+		}];
+		XCTAssertTrue(count == 0, @"Bad count: %lu", (unsigned long)count);
+	}];
+}
+
+- (void)testMerge
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict setObject:object forKey:@"content"];
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 options:nil
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS5Version
+	                                              versionTag:@"1"];
+	
+	[database registerExtension:fts withName:@"fts"];
+	
+	// Disable automerge (and raise crisismerge), so every commit leaves behind a new segment
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		XCTAssertTrue([[transaction ext:@"fts"] setAutomerge:0]);
+		XCTAssertTrue([[transaction ext:@"fts"] setCrisismerge:64]);
+		XCTAssertTrue([[transaction ext:@"fts"] setUsermerge:4]);
+	}];
+	
+	NSUInteger commitCount = 20;
+	for (NSUInteger i = 0; i < commitCount; i++)
+	{
+		[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			for (NSUInteger j = 0; j < 10; j++)
+			{
+				NSString *key = [NSString stringWithFormat:@"%lu-%lu", (unsigned long)i, (unsigned long)j];
+				NSString *text = [NSString stringWithFormat:@"hello world %@", key];
+				
+				[transaction setObject:text forKey:key inCollection:nil];
+			}
+		}];
+	}
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger segmentCount = [[transaction ext:@"fts"] segmentCount];
+		XCTAssertTrue(segmentCount >= commitCount, @"Bad segmentCount: %lu", (unsigned long)segmentCount);
+	}];
+	
+	dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+	__block YapDatabaseFullTextSearchMaintenanceReport *report = nil;
+	
+	[[connection ext:@"fts"] asyncMergeWithPageCount:4
+	                                      probeQuery:@"hello"
+	                                 completionQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)
+	                                 completionBlock:^(YapDatabaseFullTextSearchMaintenanceReport *inReport)
+	{
+		report = inReport;
+		dispatch_semaphore_signal(semaphore);
+	}];
+	
+	dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+	
+	XCTAssertNotNil(report);
+	XCTAssertTrue(report.segmentCountBefore >= commitCount, @"Bad report: %@", report);
+	XCTAssertTrue(report.segmentCountAfter == 1, @"Bad report: %@", report);
+	XCTAssertTrue(report.stepCount > 1, @"Bad report: %@", report);
+	XCTAssertTrue(report.completed, @"Bad report: %@", report);
+	
+	// Merging must not change the results
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		__block NSUInteger count = 0;
+		[[transaction ext:@"fts"] enumerateKeysMatching:@"hello"
+		                                     usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			count++;
+		}];
+		XCTAssertTrue(count == (commitCount * 10), @"Bad count: %lu", (unsigned long)count);
+		
+		count = 0;
+		[[transaction ext:@"fts"] enumerateKeysMatching:@"\"7-3\""
+		                                     usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			XCTAssertEqualObjects(key, @"7-3");
+			count++;
+		}];
+		XCTAssertTrue(count == 1, @"Bad count: %lu", (unsigned long)count);
+	}];
+	
+	// Settings that aren't supported by the fts version are rejected
+	
+	YapDatabaseFullTextSearch *fts4 =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 options:nil
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS4Version
+	                                              versionTag:@"1"];
+	
+	[database registerExtension:fts4 withName:@"fts4"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		XCTAssertTrue([[transaction ext:@"fts4"] setAutomerge:2]);
+		XCTAssertFalse([[transaction ext:@"fts4"] setCrisismerge:8]);
+		XCTAssertTrue([[transaction ext:@"fts4"] optimize]);
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger segmentCount = [[transaction ext:@"fts4"] segmentCount];
+		XCTAssertTrue(segmentCount == 1, @"Bad segmentCount: %lu", (unsigned long)segmentCount);
+	}];
+}
+
+- (void)testUnchangedUpdates
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		NSString *text = [(NSDictionary *)object objectForKey:@"text"];
+		if (text) {
+			[dict setObject:text forKey:@"content"];
+		}
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 options:nil
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS5Version
+	                                              versionTag:@"1"];
+	
+	[database registerExtension:fts withName:@"fts"];
+	
+	// Every commit that writes to the index adds a new segment.
+	// So with merging disabled, the segment count tells us whether the index was written to.
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[[transaction ext:@"fts"] setAutomerge:0];
+		[[transaction ext:@"fts"] setCrisismerge:64];
+		
+		[transaction setObject:@{ @"text":@"hello world", @"other":@(0) } forKey:@"key1" inCollection:nil];
+		[transaction setObject:@{ @"text":@"hello coffee", @"other":@(0) } forKey:@"key2" inCollection:nil];
+	}];
+	
+	__block NSUInteger segmentCount = 0;
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		segmentCount = [[transaction ext:@"fts"] segmentCount];
+	}];
+	
+	// Update the objects without changing the indexed text
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@{ @"text":@"hello world", @"other":@(1) } forKey:@"key1" inCollection:nil];
+		[transaction setObject:@{ @"text":@"hello coffee", @"other":@(1) } forKey:@"key2" inCollection:nil];
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger newSegmentCount = [[transaction ext:@"fts"] segmentCount];
+		XCTAssertTrue(newSegmentCount == segmentCount, @"Index was re-written: %lu", (unsigned long)newSegmentCount);
+	}];
+	
+	// Changes to the indexed text must still be written
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@{ @"text":@"hello laptop", @"other":@(2) } forKey:@"key1" inCollection:nil];
+		[transaction setObject:@{ @"other":@(2) } forKey:@"key2" inCollection:nil];
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger newSegmentCount = [[transaction ext:@"fts"] segmentCount];
+		XCTAssertTrue(newSegmentCount > segmentCount, @"Index wasn't written: %lu", (unsigned long)newSegmentCount);
+		
+		__block NSUInteger count = 0;
+		[[transaction ext:@"fts"] enumerateKeysMatching:@"hello"
+		                                     usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			XCTAssertEqualObjects(key, @"key1");
+			count++;
+		}];
+		XCTAssertTrue(count == 1, @"Bad count: %lu", (unsigned long)count);
+		
+		count = 0;
+		[[transaction ext:@"fts"] enumerateKeysMatching:@"world OR coffee"
+		                                     usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			count++;
+		}];
+		XCTAssertTrue(count == 0, @"Bad count: %lu", (unsigned long)count);
+	}];
+}
+
+- (void)testBm25Pagination
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict setObject:[(NSDictionary *)object objectForKey:@"title"] forKey:@"title"];
+		[dict setObject:[(NSDictionary *)object objectForKey:@"body"] forKey:@"body"];
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"title", @"body"]
+	                                                 options:nil
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS5Version
+	                                              versionTag:@"1"];
+	
+	[database registerExtension:fts withName:@"fts"];
+	
+	// Every body has the same length, so the more often "hello" appears, the better the rank.
+	// Only the first object has "hello" in its title.
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 1; i <= 50; i++)
+		{
+			NSMutableArray *words = [NSMutableArray arrayWithCapacity:60];
+			for (NSUInteger j = 0; j < 60; j++) {
+				[words addObject:(j < i ? @"hello" : @"filler")];
+			}
+			
+			NSDictionary *object = @{
+			  @"title": (i == 1 ? @"hello" : @"other"),
+			  @"body" : [words componentsJoinedByString:@" "]
+			};
+			
+			[transaction setObject:object forKey:[NSString stringWithFormat:@"key%lu", (unsigned long)i] inCollection:nil];
+		}
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSMutableArray *keys = [NSMutableArray array];
+		
+		[[transaction ext:@"fts"] enumerateBm25OrderedKeysMatching:@"hello"
+		                                               withWeights:nil
+		                                                     limit:3
+		                                                    offset:0
+		                                                usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, (@[ @"key50", @"key49", @"key48" ]));
+		
+		[keys removeAllObjects];
+		[[transaction ext:@"fts"] enumerateBm25OrderedKeysMatching:@"hello"
+		                                               withWeights:nil
+		                                                     limit:2
+		                                                    offset:3
+		                                                usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, (@[ @"key47", @"key46" ]));
+		
+		// Weights
+		
+		[keys removeAllObjects];
+		[[transaction ext:@"fts"] enumerateBm25OrderedKeysMatching:@"hello"
+		                                               withWeights:@[ @(100.0), @(1.0) ]
+		                                                     limit:2
+		                                                    offset:0
+		                                                usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, (@[ @"key1", @"key50" ]));
+		
+		// Consecutive pages cover every match exactly once
+		
+		NSMutableSet *allKeys = [NSMutableSet set];
+		__block NSUInteger count = 0;
+		
+		for (NSUInteger offset = 0; offset < 60; offset += 7)
+		{
+			[[transaction ext:@"fts"] enumerateBm25OrderedKeysAndObjectsMatching:@"hello"
+			                                                         withWeights:nil
+			                                                               limit:7
+			                                                              offset:offset
+			                                                          usingBlock:
+			    ^(NSString *collection, NSString *key, id object, BOOL *stop) {
+				
+				XCTAssertNotNil(object);
+				[allKeys addObject:key];
+				count++;
+			}];
+		}
+		
+		XCTAssertTrue(count == 50, @"Bad count: %lu", (unsigned long)count);
+		XCTAssertTrue(allKeys.count == 50, @"Bad count: %lu", (unsigned long)allKeys.count);
+	}];
+}
+
+- (void)testTrigram
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	if ([database.sqliteVersion compare:@"3.34.0" options:NSNumericSearch] == NSOrderedAscending)
+	{
+		NSLog(@"Skipping %@: the trigram tokenizer requires sqlite 3.34.0+ (have %@)",
+		      NSStringFromSelector(_cmd), database.sqliteVersion);
+		return;
+	}
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict setObject:object forKey:@"code"];
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"code"]
+	                                                 options:@{ @"tokenize": YapDatabaseFullTextSearchTrigramTokenizer }
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS5Version
+	                                              versionTag:@"1"];
+	
+	[database registerExtension:fts withName:@"fts"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@"SKU-AX4200-RED"  forKey:@"key1" inCollection:nil];
+		[transaction setObject:@"SKU-AX4201-BLUE" forKey:@"key2" inCollection:nil];
+		[transaction setObject:@"SKU-BX4200-RED"  forKey:@"key3" inCollection:nil];
+		[transaction setObject:@"PART_42 \"X\""   forKey:@"key4" inCollection:nil];
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSMutableSet *keys = [NSMutableSet set];
+		
+		[[transaction ext:@"fts"] enumerateKeysContainingSubstring:@"x420"
+		                                                usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, ([NSSet setWithObjects:@"key1", @"key2", @"key3", nil]));
+		
+		[keys removeAllObjects];
+		[[transaction ext:@"fts"] enumerateKeysContainingSubstring:@"4200-red"
+		                                                usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, ([NSSet setWithObjects:@"key1", @"key3", nil]));
+		
+		// Quotes are escaped
+		
+		[keys removeAllObjects];
+		[[transaction ext:@"fts"] enumerateKeysContainingSubstring:@"\"X\""
+		                                                usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, ([NSSet setWithObjects:@"key4", nil]));
+		
+		// Short substrings fall back to LIKE (and wildcard characters are escaped)
+		
+		[keys removeAllObjects];
+		[[transaction ext:@"fts"] enumerateKeysContainingSubstring:@"_4"
+		                                                usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, ([NSSet setWithObjects:@"key4", nil]));
+		
+		[keys removeAllObjects];
+		[[transaction ext:@"fts"] enumerateKeysInColumn:@"code"
+		                                           like:@"sku-%-red"
+		                                     usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, ([NSSet setWithObjects:@"key1", @"key3", nil]));
+		
+		[keys removeAllObjects];
+		[[transaction ext:@"fts"] enumerateKeysInColumn:@"code"
+		                                           glob:@"*AX420[0-9]*"
+		                                     usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, ([NSSet setWithObjects:@"key1", @"key2", nil]));
+		
+		[keys removeAllObjects];
+		[[transaction ext:@"fts"] enumerateKeysInColumn:@"code"
+		                                           glob:@"*ax420*"
+		                                     usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertTrue(keys.count == 0, @"GLOB should be case sensitive");
+	}];
+}
+
+- (void)testCustomTokenizer
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict setObject:object forKey:@"content"];
+	}];
+	
+	// Custom tokenizers are fts5 only
+	
+	YapDatabaseFullTextSearch *fts4 =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 options:nil
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS4Version
+	                                              versionTag:@"1"];
+	
+	XCTAssertFalse([fts4 registerTokenizer:[YapDatabaseFullTextSearch ngramTokenizerWithLength:2] withName:@"bigram"]);
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 options:@{ @"tokenize": @"bigram" }
+	                                                 handler:handler
+	                                              ftsVersion:YapDatabaseFullTextSearchFTS5Version
+	                                              versionTag:@"1"];
+	
+	XCTAssertTrue([fts registerTokenizer:[YapDatabaseFullTextSearch ngramTokenizerWithLength:2] withName:@"bigram"]);
+	XCTAssertTrue([database registerExtension:fts withName:@"fts"]);
+	
+	// Too late to register tokenizers
+	XCTAssertFalse([fts registerTokenizer:[YapDatabaseFullTextSearch ngramTokenizerWithLength:3] withName:@"trigram3"]);
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@"東京都渋谷区"     forKey:@"key1" inCollection:nil];
+		[transaction setObject:@"京都市左京区"     forKey:@"key2" inCollection:nil];
+		[transaction setObject:@"Café 👩‍💻 corner" forKey:@"key3" inCollection:nil];
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSMutableSet *keys = [NSMutableSet set];
+		
+		// A 2 character phrase is a single bigram
+		
+		[[transaction ext:@"fts"] enumerateKeysMatching:@"\"京都\""
+		                                     usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, ([NSSet setWithObjects:@"key1", @"key2", nil]));
+		
+		[keys removeAllObjects];
+		[[transaction ext:@"fts"] enumerateKeysContainingSubstring:@"京都市"
+		                                                usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, ([NSSet setWithObjects:@"key2", nil]));
+		
+		// Composed characters are never split, and tokens are lowercased
+		
+		[keys removeAllObjects];
+		[[transaction ext:@"fts"] enumerateKeysContainingSubstring:@"CAFÉ 👩‍💻"
+		                                                usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, ([NSSet setWithObjects:@"key3", nil]));
+	}];
+}
+
 @end
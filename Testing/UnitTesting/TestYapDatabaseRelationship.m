@@ -4405,4 +4405,183 @@
 	XCTAssert([Node_NotifyCount notifyCount] == 1);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)testAdjacencyCache
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database);
+	
+	YapDatabaseConnection *connection1 = [database newConnection];
+	YapDatabaseConnection *connection2 = [database newConnection];
+	
+	YapDatabaseRelationship *relationship = [[YapDatabaseRelationship alloc] init];
+	
+	BOOL registered = [database registerExtension:relationship withName:@"relationship"];
+	
+	XCTAssertTrue(registered, @"Error registering extension");
+	
+	XCTAssertTrue([[connection2 ext:@"relationship"] adjacencyCacheEnabled]);
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@"New York Yankees" forKey:@"yankees" inCollection:@"teams"];
+		
+		[transaction setObject:@"Mickey Mantle" forKey:@"1" inCollection:@"yankees"];
+		[transaction setObject:@"Derek Jeter"   forKey:@"2" inCollection:@"yankees"];
+		[transaction setObject:@"Babe Ruth"     forKey:@"3" inCollection:@"yankees"];
+		
+		[[transaction ext:@"relationship"] addEdge:
+		  [YapDatabaseRelationshipEdge edgeWithName:@"players"
+		                                  sourceKey:@"yankees"
+		                                 collection:@"teams"
+		                             destinationKey:@"1"
+		                                 collection:@"yankees"
+		                            nodeDeleteRules:YDB_DeleteDestinationIfSourceDeleted]];
+		
+		[[transaction ext:@"relationship"] addEdge:
+		  [YapDatabaseRelationshipEdge edgeWithName:@"players"
+		                                  sourceKey:@"yankees"
+		                                 collection:@"teams"
+		                             destinationKey:@"2"
+		                                 collection:@"yankees"
+		                            nodeDeleteRules:YDB_DeleteDestinationIfSourceDeleted]];
+	}];
+	
+	NSUInteger (^outgoingCount)(void) = ^NSUInteger (void){
+		
+		__block NSUInteger count = 0;
+		[connection2 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			[[transaction ext:@"relationship"] enumerateEdgesWithName:@"players"
+			                                                sourceKey:@"yankees"
+			                                               collection:@"teams"
+			                                               usingBlock:^(YapDatabaseRelationshipEdge *edge, BOOL *stop)
+			{
+				XCTAssertEqualObjects(edge.sourceKey, @"yankees");
+				XCTAssertEqualObjects(edge.sourceCollection, @"teams");
+				XCTAssertNotNil(edge.destinationKey);
+				XCTAssertEqualObjects(edge.destinationCollection, @"yankees");
+				count++;
+			}];
+			
+			NSUInteger edgeCount = [[transaction ext:@"relationship"] edgeCountWithName:@"players"
+			                                                                  sourceKey:@"yankees"
+			                                                                 collection:@"teams"];
+			XCTAssert(edgeCount == count, @"Mismatch: %lu vs %lu", (unsigned long)edgeCount, (unsigned long)count);
+		}];
+		
+		return count;
+	};
+	
+	NSUInteger (^incomingCount)(NSString *) = ^NSUInteger (NSString *playerKey){
+		
+		__block NSUInteger count = 0;
+		[connection2 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			[[transaction ext:@"relationship"] enumerateEdgesWithName:@"players"
+			                                           destinationKey:playerKey
+			                                               collection:@"yankees"
+			                                               usingBlock:^(YapDatabaseRelationshipEdge *edge, BOOL *stop)
+			{
+				XCTAssertEqualObjects(edge.sourceKey, @"yankees");
+				XCTAssertEqualObjects(edge.destinationKey, playerKey);
+				count++;
+			}];
+			
+			NSUInteger edgeCount = [[transaction ext:@"relationship"] edgeCountWithName:@"players"
+			                                                             destinationKey:playerKey
+			                                                                 collection:@"yankees"];
+			XCTAssert(edgeCount == count, @"Mismatch: %lu vs %lu", (unsigned long)edgeCount, (unsigned long)count);
+		}];
+		
+		return count;
+	};
+	
+	// Populate the cache, then hit it
+	
+	XCTAssert(outgoingCount() == 2);
+	XCTAssert(outgoingCount() == 2);
+	XCTAssert(incomingCount(@"3") == 0);
+	XCTAssert(incomingCount(@"3") == 0);
+	
+	// Inserted edges must invalidate the cache on the other connection
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[[transaction ext:@"relationship"] addEdge:
+		  [YapDatabaseRelationshipEdge edgeWithName:@"players"
+		                                  sourceKey:@"yankees"
+		                                 collection:@"teams"
+		                             destinationKey:@"3"
+		                                 collection:@"yankees"
+		                            nodeDeleteRules:YDB_DeleteDestinationIfSourceDeleted]];
+	}];
+	
+	XCTAssert(outgoingCount() == 3);
+	XCTAssert(incomingCount(@"3") == 1);
+	
+	// Removed edges must invalidate the cache on the other connection
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[[transaction ext:@"relationship"] removeEdgeWithName:@"players"
+		                                            sourceKey:@"yankees"
+		                                           collection:@"teams"
+		                                       destinationKey:@"1"
+		                                           collection:@"yankees"
+		                                       withProcessing:YDB_EdgeDeleted];
+	}];
+	
+	XCTAssert(outgoingCount() == 2);
+	XCTAssert(incomingCount(@"1") == 0);
+	
+	// Deleted nodes must invalidate the cache on the other connection
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeObjectForKey:@"2" inCollection:@"yankees"];
+	}];
+	
+	XCTAssert(outgoingCount() == 1);
+	XCTAssert(incomingCount(@"2") == 0);
+	
+	// The committing connection must not serve stale cached edges either
+	
+	[connection1 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger edgeCount = [[transaction ext:@"relationship"] edgeCountWithName:@"players"
+		                                                                  sourceKey:@"yankees"
+		                                                                 collection:@"teams"];
+		XCTAssert(edgeCount == 1);
+	}];
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeObjectForKey:@"3" inCollection:@"yankees"];
+	}];
+	
+	[connection1 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger edgeCount = [[transaction ext:@"relationship"] edgeCountWithName:@"players"
+		                                                                  sourceKey:@"yankees"
+		                                                                 collection:@"teams"];
+		XCTAssert(edgeCount == 0);
+	}];
+	
+	// Disabling the cache must not change results
+	
+	[[connection2 ext:@"relationship"] setAdjacencyCacheEnabled:NO];
+	XCTAssertFalse([[connection2 ext:@"relationship"] adjacencyCacheEnabled]);
+	
+	XCTAssert(outgoingCount() == 0);
+	XCTAssert(incomingCount(@"3") == 0);
+}
+
 @end
@@ -311,6 +311,468 @@
 	[self _testWithDatabase:database options:searchViewOptions];
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Query Refinement
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test2_queryRefinement
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	// Setup FTS
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict setObject:object forKey:@"content"];
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 handler:handler
+	                                              versionTag:@"1"];
+	
+	BOOL registerResult1 = [database registerExtension:fts withName:@"fts"];
+	XCTAssertTrue(registerResult1, @"Failure registering fts extension");
+	
+	// Setup SearchResultsView
+	
+	__block NSUInteger groupingCount = 0;
+	
+	YapDatabaseViewGrouping *grouping = [YapDatabaseViewGrouping withKeyBlock:
+	    ^NSString *(YapDatabaseReadTransaction *transaction, NSString *collection, NSString *key)
+	{
+		groupingCount++;
+		
+		if ([key isEqualToString:@"keyX"]) // Exclude keyX from view
+			return nil;
+		else
+			return @"";
+	}];
+	
+	YapDatabaseViewSorting *sorting = [YapDatabaseViewSorting withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSString *group,
+	        NSString *collection1, NSString *key1, id obj1,
+	        NSString *collection2, NSString *key2, id obj2)
+	{
+		__unsafe_unretained NSString *str1 = (NSString *)obj1;
+		__unsafe_unretained NSString *str2 = (NSString *)obj2;
+		
+		return [str1 compare:str2 options:NSLiteralSearch];
+	}];
+	
+	YapDatabaseSearchResultsViewOptions *searchViewOptions = [[YapDatabaseSearchResultsViewOptions alloc] init];
+	searchViewOptions.isPersistent = NO;
+	
+	YapDatabaseSearchResultsView *searchResultsView =
+	  [[YapDatabaseSearchResultsView alloc] initWithFullTextSearchName:@"fts"
+	                                                          grouping:grouping
+	                                                           sorting:sorting
+	                                                        versionTag:@"1"
+	                                                           options:searchViewOptions];
+	
+	BOOL registerResult2 = [database registerExtension:searchResultsView withName:@"searchResults"];
+	XCTAssertTrue(registerResult2, @"Failure registering searchResults extension");
+	
+	YapDatabaseConnection *connection1 = [database newConnection];
+	YapDatabaseConnection *connection2 = [database newConnection];
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@"yap is a database"       forKey:@"key0" inCollection:nil];
+		[transaction setObject:@"yapdatabase is fast"     forKey:@"key1" inCollection:nil];
+		[transaction setObject:@"yapdatabase has views"   forKey:@"key2" inCollection:nil];
+		[transaction setObject:@"yapping dogs"            forKey:@"key3" inCollection:nil];
+		[transaction setObject:@"yapdatabase is excluded" forKey:@"keyX" inCollection:nil];
+		[transaction setObject:@"nothing to see here"     forKey:@"key4" inCollection:nil];
+	}];
+	
+	NSUInteger (^search)(NSString *) = ^NSUInteger (NSString *query){
+		
+		__block NSUInteger count = 0;
+		[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			[[transaction ext:@"searchResults"] performSearchFor:query];
+			count = [[transaction ext:@"searchResults"] numberOfItemsInGroup:@""];
+		}];
+		
+		return count;
+	};
+	
+	XCTAssertTrue(search(@"yap*") == 4);
+	
+	// Refinement: only removes items from the view (the grouping block isn't invoked)
+	
+	groupingCount = 0;
+	
+	XCTAssertTrue(search(@"yapd*") == 2);
+	XCTAssertTrue(search(@"yapdatabase* fast") == 1);
+	XCTAssertTrue(groupingCount == 0, @"Unexpected grouping invocations: %lu", (unsigned long)groupingCount);
+	
+	// Back to an earlier (cached) query
+	
+	XCTAssertTrue(search(@"yap*") == 4);
+	
+	[connection1 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		XCTAssertNil([[transaction ext:@"searchResults"] groupForKey:@"keyX" inCollection:nil]);
+	}];
+	
+	// Changes from another connection must flush the cache
+	
+	[connection2 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@"yapdatabase is great" forKey:@"key5" inCollection:nil];
+		[transaction setObject:@"nothing to see here"  forKey:@"key1" inCollection:nil];
+	}];
+	
+	XCTAssertTrue(search(@"yap*") == 4);
+	XCTAssertTrue(search(@"yapd*") == 2);
+	
+	[connection1 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		XCTAssertNotNil([[transaction ext:@"searchResults"] groupForKey:@"key5" inCollection:nil]);
+		XCTAssertNil([[transaction ext:@"searchResults"] groupForKey:@"key1" inCollection:nil]);
+	}];
+	
+	// Changes within the same transaction as the search must not use the cache
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@"yapdatabase is everywhere" forKey:@"key6" inCollection:nil];
+		[transaction removeObjectForKey:@"key2" inCollection:nil];
+		
+		[[transaction ext:@"searchResults"] performSearchFor:@"yapda*"];
+		
+		NSUInteger count = [[transaction ext:@"searchResults"] numberOfItemsInGroup:@""];
+		XCTAssertTrue(count == 2, @"Bad count: %lu", (unsigned long)count);
+	}];
+	
+	XCTAssertTrue(search(@"yap*") == 4);
+	XCTAssertTrue(search(@"yapdat*") == 2);
+	
+	// Queries with operators are never treated as refinements
+	
+	XCTAssertTrue(search(@"yap* OR nothing") == 6);
+	XCTAssertTrue(search(@"yap* OR nothing*") == 6);
+	XCTAssertTrue(search(@"yapping OR nothing") == 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Sliced Search
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test3_slicedSearch_blocks
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	// Setup FTS
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict setObject:object forKey:@"content"];
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 handler:handler
+	                                              versionTag:@"1"];
+	
+	BOOL registerResult1 = [database registerExtension:fts withName:@"fts"];
+	XCTAssertTrue(registerResult1, @"Failure registering fts extension");
+	
+	// Setup SearchResultsView
+	
+	YapDatabaseViewGrouping *grouping = [YapDatabaseViewGrouping withObjectBlock:
+	    ^NSString *(YapDatabaseReadTransaction *transaction, NSString *collection, NSString *key, id object)
+	{
+		if ([(NSString *)object hasSuffix:@"excluded"])
+			return nil;
+		else
+			return @"";
+	}];
+	
+	YapDatabaseViewSorting *sorting = [YapDatabaseViewSorting withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSString *group,
+	        NSString *collection1, NSString *key1, id obj1,
+	        NSString *collection2, NSString *key2, id obj2)
+	{
+		__unsafe_unretained NSString *str1 = (NSString *)obj1;
+		__unsafe_unretained NSString *str2 = (NSString *)obj2;
+		
+		return [str1 compare:str2 options:NSLiteralSearch];
+	}];
+	
+	YapDatabaseSearchResultsViewOptions *searchViewOptions = [[YapDatabaseSearchResultsViewOptions alloc] init];
+	searchViewOptions.isPersistent = NO;
+	
+	YapDatabaseSearchResultsView *searchResultsView =
+	  [[YapDatabaseSearchResultsView alloc] initWithFullTextSearchName:@"fts"
+	                                                          grouping:grouping
+	                                                           sorting:sorting
+	                                                        versionTag:@"1"
+	                                                           options:searchViewOptions];
+	
+	BOOL registerResult2 = [database registerExtension:searchResultsView withName:@"searchResults"];
+	XCTAssertTrue(registerResult2, @"Failure registering searchResults extension");
+	
+	YapDatabaseConnection *connection1 = [database newConnection];
+	YapDatabaseConnection *connection2 = [database newConnection];
+	
+	NSUInteger count = 2000;
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%lu", (unsigned long)i];
+			NSString *phrase = nil;
+			
+			if (i % 10 == 0)
+				phrase = [NSString stringWithFormat:@"yap %lu excluded", (unsigned long)i];
+			else if (i % 2 == 0)
+				phrase = [NSString stringWithFormat:@"yap %lu", (unsigned long)i];
+			else
+				phrase = [NSString stringWithFormat:@"nope %lu", (unsigned long)i];
+			
+			[transaction setObject:phrase forKey:key inCollection:nil];
+		}
+	}];
+	
+	// Perform a sliced search, while another connection is modifying rows
+	
+	YapDatabaseSearchQueue *searchQueue = [[YapDatabaseSearchQueue alloc] init];
+	[searchQueue enqueueQuery:@"yap"];
+	
+	dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+	
+	YapDatabaseSearchResultsViewConnection *searchResultsViewConnection = [connection1 extension:@"searchResults"];
+	
+	[searchResultsViewConnection asyncPerformSearchWithQueue:searchQueue
+	                                               timeSlice:0.0001
+	                                         completionQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)
+	                                         completionBlock:^{
+		
+		dispatch_semaphore_signal(semaphore);
+	}];
+	
+	for (NSUInteger i = 0; i < 20; i++)
+	{
+		[connection2 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			NSString *key1 = [NSString stringWithFormat:@"%lu", (unsigned long)((i * 2) + 1)]; // nope -> yap
+			NSString *key2 = [NSString stringWithFormat:@"%lu", (unsigned long)((i * 10) + 2)]; // yap -> removed
+			
+			NSString *phrase = [NSString stringWithFormat:@"yap yap %@", key1];
+			
+			[transaction setObject:phrase forKey:key1 inCollection:nil];
+			[transaction removeObjectForKey:key2 inCollection:nil];
+		}];
+	}
+	
+	dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+	
+	// The results should match a regular search
+	
+	__block NSArray *slicedResults = nil;
+	__block NSArray *regularResults = nil;
+	
+	[connection1 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSString *query = [[transaction ext:@"searchResults"] query];
+		XCTAssertTrue([query isEqualToString:@"yap"], @"Bad query: %@", query);
+		
+		NSMutableArray *keys = [NSMutableArray array];
+		[[transaction ext:@"searchResults"] enumerateKeysInGroup:@""
+		                                              usingBlock:^(NSString *collection, NSString *key, NSUInteger index, BOOL *stop)
+		{
+			[keys addObject:key];
+		}];
+		
+		slicedResults = keys;
+	}];
+	
+	[connection2 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[[transaction ext:@"searchResults"] performSearchFor:@"nothing"];
+		[[transaction ext:@"searchResults"] performSearchFor:@"yap"];
+		
+		NSMutableArray *keys = [NSMutableArray array];
+		[[transaction ext:@"searchResults"] enumerateKeysInGroup:@""
+		                                              usingBlock:^(NSString *collection, NSString *key, NSUInteger index, BOOL *stop)
+		{
+			[keys addObject:key];
+		}];
+		
+		regularResults = keys;
+	}];
+	
+	// 800 (even, not multiple of 10) + 20 (nope -> yap) - 20 (removed)
+	
+	XCTAssertTrue([regularResults count] == 800, @"Bad count: %lu", (unsigned long)[regularResults count]);
+	XCTAssertEqualObjects(slicedResults, regularResults);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Snippets
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test4_prefetchSnippets
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	// Setup FTS
+	
+	YapDatabaseFullTextSearchHandler *handler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict setObject:object forKey:@"content"];
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[@"content"]
+	                                                 handler:handler
+	                                              versionTag:@"1"];
+	
+	BOOL registerResult1 = [database registerExtension:fts withName:@"fts"];
+	XCTAssertTrue(registerResult1, @"Failure registering fts extension");
+	
+	// Setup SearchResultsView
+	
+	YapDatabaseViewGrouping *grouping = [YapDatabaseViewGrouping withKeyBlock:
+	    ^NSString *(YapDatabaseReadTransaction *transaction, NSString *collection, NSString *key)
+	{
+		return @"";
+	}];
+	
+	YapDatabaseViewSorting *sorting = [YapDatabaseViewSorting withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSString *group,
+	        NSString *collection1, NSString *key1, id obj1,
+	        NSString *collection2, NSString *key2, id obj2)
+	{
+		__unsafe_unretained NSString *str1 = (NSString *)obj1;
+		__unsafe_unretained NSString *str2 = (NSString *)obj2;
+		
+		return [str1 compare:str2 options:NSLiteralSearch];
+	}];
+	
+	YapDatabaseFullTextSearchSnippetOptions *snippetOptions = [[YapDatabaseFullTextSearchSnippetOptions alloc] init];
+	snippetOptions.numberOfTokens = 5;
+	
+	YapDatabaseSearchResultsViewOptions *searchViewOptions = [[YapDatabaseSearchResultsViewOptions alloc] init];
+	searchViewOptions.isPersistent = NO;
+	searchViewOptions.snippetOptions = snippetOptions;
+	
+	YapDatabaseSearchResultsView *searchResultsView =
+	  [[YapDatabaseSearchResultsView alloc] initWithFullTextSearchName:@"fts"
+	                                                          grouping:grouping
+	                                                           sorting:sorting
+	                                                        versionTag:@"1"
+	                                                           options:searchViewOptions];
+	
+	BOOL registerResult2 = [database registerExtension:searchResultsView withName:@"searchResults"];
+	XCTAssertTrue(registerResult2, @"Failure registering searchResults extension");
+	
+	YapDatabaseConnection *connection1 = [database newConnection];
+	YapDatabaseConnection *connection2 = [database newConnection];
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < 100; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%02lu", (unsigned long)i];
+			NSString *phrase = nil;
+			
+			if (i % 2 == 0)
+				phrase = [NSString stringWithFormat:@"%02lu the quick brown fox jumps over the lazy yap", (unsigned long)i];
+			else
+				phrase = [NSString stringWithFormat:@"%02lu the quick brown fox jumps over the lazy dog", (unsigned long)i];
+			
+			[transaction setObject:phrase forKey:key inCollection:nil];
+		}
+		
+		[[transaction ext:@"searchResults"] performSearchFor:@"yap"];
+	}];
+	
+	// Prefetched snippets should match those generated by the FTS extension
+	
+	__block NSMutableDictionary *expectedSnippets = [NSMutableDictionary dictionary];
+	
+	[connection1 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[[transaction ext:@"fts"] enumerateKeysMatching:@"yap"
+		                             withSnippetOptions:snippetOptions
+		                                     usingBlock:^(NSString *snippet, NSString *collection, NSString *key, BOOL *stop)
+		{
+			expectedSnippets[key] = snippet;
+		}];
+		
+		XCTAssertTrue([[transaction ext:@"searchResults"] numberOfItemsInGroup:@""] == 50);
+		
+		NSRange range = NSMakeRange(10, 20);
+		
+		[[transaction ext:@"searchResults"] prefetchSnippetsInGroup:@"" range:range];
+		[[transaction ext:@"searchResults"] prefetchSnippetsInGroup:@"" range:NSMakeRange(45, 100)]; // out of bounds
+		
+		[[transaction ext:@"searchResults"] enumerateKeysInGroup:@""
+		                                             withOptions:0
+		                                                   range:range
+		                                              usingBlock:^(NSString *collection, NSString *key, NSUInteger index, BOOL *stop)
+		{
+			NSString *snippet = [[transaction ext:@"searchResults"] snippetForKey:key inCollection:collection];
+			
+			XCTAssertNotNil(snippet);
+			XCTAssertEqualObjects(snippet, expectedSnippets[key]);
+		}];
+		
+		// Not in the search results
+		XCTAssertNil([[transaction ext:@"searchResults"] snippetForKey:@"01" inCollection:nil]);
+	}];
+	
+	// Modifying a row (from another connection) must not return a stale snippet
+	
+	[connection2 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@"20 the slow green turtle crawls under the busy yap" forKey:@"20" inCollection:nil];
+	}];
+	
+	[connection1 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSString *snippet = [[transaction ext:@"searchResults"] snippetForKey:@"20" inCollection:nil];
+		
+		XCTAssertTrue([snippet rangeOfString:@"turtle"].location != NSNotFound, @"Stale snippet: %@", snippet);
+	}];
+	
+	// Modifying a row within the same transaction must not return a stale snippet
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[[transaction ext:@"searchResults"] prefetchSnippetsInGroup:@"" range:NSMakeRange(0, 20)];
+		
+		[transaction setObject:@"22 the yap sat on the mat" forKey:@"22" inCollection:nil];
+		
+		NSString *snippet = [[transaction ext:@"searchResults"] snippetForKey:@"22" inCollection:nil];
+		
+		XCTAssertTrue([snippet rangeOfString:@"mat"].location != NSNotFound, @"Stale snippet: %@", snippet);
+	}];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Test Logic
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2,6 +2,8 @@
 
 #import "YapDatabase.h"
 #import "YapDatabaseSecondaryIndex.h"
+#import "YapDatabaseRTreeIndex.h"
+#import "YapDatabaseFullTextSearch.h"
 
 #import "TestObject.h"
 
@@ -459,4 +461,1470 @@
 	}];
 }
 
+- (void)testUnchangedUpdates
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"name" withType:YapDatabaseSecondaryIndexTypeText];
+	[setup addColumn:@"someInt" withType:YapDatabaseSecondaryIndexTypeInteger];
+	[setup addColumn:@"someReal" withType:YapDatabaseSecondaryIndexTypeReal];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		__unsafe_unretained NSDictionary *values = (NSDictionary *)object;
+		
+		if (values[@"name"])
+			[dict setObject:values[@"name"] forKey:@"name"];
+		
+		[dict setObject:values[@"someInt"] forKey:@"someInt"];
+		[dict setObject:values[@"someReal"] forKey:@"someReal"];
+	}];
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler];
+	
+	[database registerExtension:secondaryIndex withName:@"idx"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (int i = 0; i < 10; i++)
+		{
+			NSDictionary *object = @{ @"name":@"a", @"someInt":@(i), @"someReal":@(i + 0.5), @"other":@(0) };
+			
+			[transaction setObject:object forKey:[NSString stringWithFormat:@"key%d", i] inCollection:nil];
+		}
+	}];
+	
+	// Unchanged values (including a missing/NULL value, and a value that gets converted by the column affinity)
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@{ @"name":@"a", @"someInt":@(0), @"someReal":@(0.5), @"other":@(1) }
+		                forKey:@"key0" inCollection:nil];
+		
+		[transaction setObject:@{ @"someInt":@(1), @"someReal":@(1.5), @"other":@(1) }
+		                forKey:@"key1" inCollection:nil];
+		[transaction setObject:@{ @"someInt":@(1), @"someReal":@(1.5), @"other":@(2) }
+		                forKey:@"key1" inCollection:nil];
+		
+		[transaction setObject:@{ @"name":@"a", @"someInt":@(2.0), @"someReal":@(2.5), @"other":@(1) }
+		                forKey:@"key2" inCollection:nil];
+		
+		// Changed values
+		
+		[transaction setObject:@{ @"name":@"b", @"someInt":@(3), @"someReal":@(3.5), @"other":@(1) }
+		                forKey:@"key3" inCollection:nil];
+		[transaction setObject:@{ @"name":@"a", @"someInt":@(40), @"someReal":@(4.5), @"other":@(1) }
+		                forKey:@"key4" inCollection:nil];
+		[transaction setObject:@{ @"name":@"a", @"someInt":@(5), @"someReal":@(5.25), @"other":@(1) }
+		                forKey:@"key5" inCollection:nil];
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger count = 0;
+		YapDatabaseQuery *query = nil;
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE name = ?", @"a"];
+		[[transaction ext:@"idx"] getNumberOfRows:&count matchingQuery:query];
+		XCTAssertTrue(count == 8, @"Incorrect count: %lu", (unsigned long)count);
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE name IS NULL"];
+		[[transaction ext:@"idx"] getNumberOfRows:&count matchingQuery:query];
+		XCTAssertTrue(count == 1, @"Incorrect count: %lu", (unsigned long)count);
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE someInt = ?", @(40)];
+		[[transaction ext:@"idx"] getNumberOfRows:&count matchingQuery:query];
+		XCTAssertTrue(count == 1, @"Incorrect count: %lu", (unsigned long)count);
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE someReal = ?", @(5.25)];
+		[[transaction ext:@"idx"] getNumberOfRows:&count matchingQuery:query];
+		XCTAssertTrue(count == 1, @"Incorrect count: %lu", (unsigned long)count);
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE someInt < ?", @(10)];
+		[[transaction ext:@"idx"] getNumberOfRows:&count matchingQuery:query];
+		XCTAssertTrue(count == 9, @"Incorrect count: %lu", (unsigned long)count);
+	}];
+}
+
+- (void)testCompositeIndexes
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"tenant" withType:YapDatabaseSecondaryIndexTypeText indexed:NO];
+	[setup addColumn:@"status" withType:YapDatabaseSecondaryIndexTypeInteger indexed:NO];
+	[setup addColumn:@"timestamp" withType:YapDatabaseSecondaryIndexTypeReal];
+	[setup addColumn:@"title" withType:YapDatabaseSecondaryIndexTypeText indexed:NO];
+	
+	[setup addIndexWithName:@"feed"
+	                columns:@[ @"tenant", @"status", @"timestamp" ]
+	        coveringColumns:@[ @"title" ]
+	              predicate:nil];
+	
+	[setup addIndexWithName:@"open"
+	                columns:@[ @"tenant" ]
+	        coveringColumns:nil
+	              predicate:@"status = 1"];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict addEntriesFromDictionary:(NSDictionary *)object];
+	}];
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler];
+	
+	XCTAssertTrue([database registerExtension:secondaryIndex withName:@"idx"]);
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (int i = 0; i < 20; i++)
+		{
+			NSDictionary *object = @{
+			  @"tenant"   : [NSString stringWithFormat:@"tenant%d", (i % 2)],
+			  @"status"   : @(i % 3),
+			  @"timestamp": @(100 - i),
+			  @"title"    : [NSString stringWithFormat:@"title%d", i]
+			};
+			
+			[transaction setObject:object forKey:[NSString stringWithFormat:@"key%d", i] inCollection:nil];
+		}
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		YapDatabaseQuery *query = nil;
+		NSString *plan = nil;
+		
+		// Filter on (tenant, status) & sort by timestamp: no separate sort step
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE tenant = ? AND status = ? ORDER BY timestamp", @"tenant0", @(1)];
+		plan = [[transaction ext:@"idx"] queryPlanForQuery:query];
+		
+		XCTAssertTrue([plan rangeOfString:@"INDEX secondaryIndex_idx_feed"].location != NSNotFound, @"Plan: %@", plan);
+		XCTAssertTrue([plan rangeOfString:@"TEMP B-TREE"].location == NSNotFound, @"Plan: %@", plan);
+		
+		NSMutableArray *keys = [NSMutableArray array];
+		[[transaction ext:@"idx"] enumerateKeysMatchingQuery:query
+		                                          usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, (@[ @"key16", @"key10", @"key4" ]));
+		
+		// Covering column
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE tenant = ? AND status = ?", @"tenant0", @(1)];
+		plan = [[transaction ext:@"idx"] queryPlanForQuery:query];
+		
+		XCTAssertTrue([plan rangeOfString:@"COVERING INDEX secondaryIndex_idx_feed"].location != NSNotFound,
+		              @"Plan: %@", plan);
+		
+		NSMutableSet *titles = [NSMutableSet set];
+		[[transaction ext:@"idx"] enumerateIndexedValuesInColumn:@"title"
+		                                           matchingQuery:query
+		                                              usingBlock:^(id indexedValue, BOOL *stop) {
+			[titles addObject:indexedValue];
+		}];
+		XCTAssertEqualObjects(titles, ([NSSet setWithObjects:@"title4", @"title10", @"title16", nil]));
+		
+		// Partial index
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE status = 1"];
+		plan = [[transaction ext:@"idx"] queryPlanForQuery:query];
+		
+		XCTAssertTrue([plan rangeOfString:@"INDEX secondaryIndex_idx_open"].location != NSNotFound, @"Plan: %@", plan);
+		
+		NSUInteger count = 0;
+		[[transaction ext:@"idx"] getNumberOfRows:&count matchingQuery:query];
+		XCTAssertTrue(count == 7, @"Incorrect count: %lu", (unsigned long)count);
+		
+		// The partial index doesn't contain the rows needed for other statuses
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE status = 2"];
+		plan = [[transaction ext:@"idx"] queryPlanForQuery:query];
+		
+		XCTAssertTrue([plan rangeOfString:@"secondaryIndex_idx_open"].location == NSNotFound, @"Plan: %@", plan);
+	}];
+}
+
+- (void)testSetupMismatch_indexed
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict addEntriesFromDictionary:(NSDictionary *)object];
+	}];
+	
+	BOOL (^registerWithIndexed)(BOOL) = ^BOOL (BOOL indexed){ @autoreleasepool {
+		
+		YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+		XCTAssertNotNil(database, @"Oops");
+		
+		YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+		[setup addColumn:@"someInt" withType:YapDatabaseSecondaryIndexTypeInteger indexed:indexed];
+		
+		YapDatabaseSecondaryIndex *secondaryIndex =
+		  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler versionTag:@"1"];
+		
+		return [database registerExtension:secondaryIndex withName:@"idx"];
+	}};
+	
+	XCTAssertTrue(registerWithIndexed(YES));
+	XCTAssertTrue(registerWithIndexed(YES));
+	
+	// Changing the indexed flag, without changing the versionTag, is a developer error
+	
+#if DEBUG
+	XCTAssertFalse(registerWithIndexed(NO));
+#endif
+}
+
+- (void)testSetupMismatch_aggregates
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict addEntriesFromDictionary:(NSDictionary *)object];
+	}];
+	
+	BOOL (^registerWithAggregates)(NSArray<NSString *> *) = ^BOOL (NSArray<NSString *> *aggregateNames){ @autoreleasepool {
+		
+		YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+		XCTAssertNotNil(database, @"Oops");
+		
+		YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+		[setup addColumn:@"salary" withType:YapDatabaseSecondaryIndexTypeInteger];
+		
+		for (NSString *name in aggregateNames)
+		{
+			[setup addAggregateWithName:name
+			                   function:YapDatabaseSecondaryIndexAggregateFunctionSum
+			                     column:@"salary"
+			                    groupBy:nil
+			                  predicate:nil];
+		}
+		
+		YapDatabaseSecondaryIndex *secondaryIndex =
+		  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler versionTag:@"1"];
+		
+		return [database registerExtension:secondaryIndex withName:@"idx"];
+	}};
+	
+	XCTAssertTrue(registerWithAggregates(@[ @"payroll" ]));
+	XCTAssertTrue(registerWithAggregates(@[ @"payroll" ]));
+	
+	// Changing the aggregates, without changing the versionTag, is a developer error
+	
+#if DEBUG
+	XCTAssertFalse(registerWithAggregates(@[ @"payroll", @"bonus" ]));
+	XCTAssertFalse(registerWithAggregates(@[ @"bonus" ]));
+	XCTAssertFalse(registerWithAggregates(@[]));
+#endif
+}
+
+- (void)testSameIndexedColumnInMultipleExtensions
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict addEntriesFromDictionary:(NSDictionary *)object];
+	}];
+	
+	// Index names are global within the database.
+	// So each extension must get its own index for its "status" column.
+	
+	BOOL (^registerBoth)(void) = ^BOOL (void){ @autoreleasepool {
+		
+		YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+		XCTAssertNotNil(database, @"Oops");
+		
+		for (NSString *name in @[ @"idxA", @"idxB" ])
+		{
+			YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+			[setup addColumn:@"status" withType:YapDatabaseSecondaryIndexTypeInteger];
+			
+			YapDatabaseSecondaryIndex *secondaryIndex =
+			  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler versionTag:@"1"];
+			
+			if (![database registerExtension:secondaryIndex withName:name]) return NO;
+		}
+		
+		YapDatabaseConnection *connection = [database newConnection];
+		[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			YapDatabaseQuery *query = [YapDatabaseQuery queryWithFormat:@"WHERE status = ?", @(1)];
+			
+			for (NSString *name in @[ @"idxA", @"idxB" ])
+			{
+				NSString *plan = [[transaction ext:name] queryPlanForQuery:query];
+				NSString *indexName = [NSString stringWithFormat:@"INDEX secondaryIndex_%@_status", name];
+				
+				XCTAssertTrue([plan rangeOfString:indexName].location != NSNotFound, @"Plan: %@", plan);
+			}
+		}];
+		
+		return YES;
+	}};
+	
+	XCTAssertTrue(registerBoth());
+	
+	// Re-registering (with the same versionTag) must pass the DEBUG setup check for both extensions
+	
+	XCTAssertTrue(registerBoth());
+}
+
+- (void)testJoinedEnumeration
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	// Count deserializations, to check that a query test (NULL block) doesn't deserialize anything.
+	
+	__block NSUInteger deserializeCount = 0;
+	YapDatabaseDeserializer defaultDeserializer = [YapDatabase defaultDeserializer];
+	[database registerDefaultDeserializer:^id (NSString *collection, NSString *key, NSData *data) {
+		
+		deserializeCount++;
+		return defaultDeserializer(collection, key, data);
+	}];
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	// Note: the "key" column has the same name as a column in the main database table
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"key" withType:YapDatabaseSecondaryIndexTypeText];
+	[setup addColumn:@"rank" withType:YapDatabaseSecondaryIndexTypeInteger];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict setObject:[(NSDictionary *)object objectForKey:@"code"] forKey:@"key"];
+		[dict setObject:[(NSDictionary *)object objectForKey:@"rank"] forKey:@"rank"];
+	}];
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler];
+	
+	[database registerExtension:secondaryIndex withName:@"idx"];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (int i = 0; i < 10; i++)
+		{
+			NSString *collection = (i % 2) ? @"odd" : @"even";
+			NSString *key = [NSString stringWithFormat:@"key%d", i];
+			NSDictionary *object = @{ @"code":[NSString stringWithFormat:@"code%d", i], @"rank":@(i) };
+			id metadata = (i % 3) ? @(i * 10) : nil;
+			
+			[transaction setObject:object forKey:key inCollection:collection withMetadata:metadata];
+		}
+	}];
+	
+	[connection flushMemoryWithFlags:YapDatabaseConnectionFlushMemoryFlags_Caches];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		YapDatabaseQuery *query = nil;
+		
+		// The results must be in the order specified by the query,
+		// with the correct collection, key, object & metadata for each row.
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE rank >= ? ORDER BY rank DESC", @(4)];
+		
+		__block int expected = 9;
+		BOOL result =
+		  [[transaction ext:@"idx"] enumerateRowsMatchingQuery:query
+		                                            usingBlock:
+		    ^(NSString *collection, NSString *key, id object, id metadata, BOOL *stop) {
+			
+			XCTAssertEqualObjects(collection, ((expected % 2) ? @"odd" : @"even"));
+			XCTAssertEqualObjects(key, ([NSString stringWithFormat:@"key%d", expected]));
+			XCTAssertEqualObjects(object[@"rank"], @(expected));
+			XCTAssertEqualObjects(metadata, ((expected % 3) ? @(expected * 10) : nil));
+			
+			expected--;
+		}];
+		
+		XCTAssertTrue(result);
+		XCTAssertTrue(expected == 3, @"Bad count");
+		
+		// Column names that also exist in the main database table
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE key = ?", @"code3"];
+		
+		NSMutableArray *keys = [NSMutableArray array];
+		[[transaction ext:@"idx"] enumerateKeysAndMetadataMatchingQuery:query
+		                                                     usingBlock:
+		    ^(NSString *collection, NSString *key, id metadata, BOOL *stop) {
+			
+			[keys addObject:key];
+			XCTAssertEqualObjects(metadata, @(30));
+		}];
+		XCTAssertEqualObjects(keys, (@[ @"key3" ]));
+		
+		NSArray *rowids = [[[transaction ext:@"idx"] rowidsForKeys:@[ @"key2", @"key6" ] inCollection:@"even"] allValues];
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE rowid IN (?) ORDER BY rank", rowids];
+		
+		[keys removeAllObjects];
+		[[transaction ext:@"idx"] enumerateKeysMatchingQuery:query
+		                                          usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		XCTAssertEqualObjects(keys, (@[ @"key2", @"key6" ]));
+		
+		// Objects already in the cache are taken from the cache
+		
+		id cachedObject = [transaction objectForKey:@"key8" inCollection:@"even"];
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE rank = ?", @(8)];
+		
+		__block id enumeratedObject = nil;
+		[[transaction ext:@"idx"] enumerateKeysAndObjectsMatchingQuery:query
+		                                                    usingBlock:
+		    ^(NSString *collection, NSString *key, id object, BOOL *stop) {
+			
+			enumeratedObject = object;
+		}];
+		XCTAssertTrue(enumeratedObject == cachedObject, @"Expected the cached instance");
+	}];
+	
+	[connection flushMemoryWithFlags:YapDatabaseConnectionFlushMemoryFlags_Caches];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		YapDatabaseQuery *query = [YapDatabaseQuery queryWithFormat:@"WHERE rank >= ?", @(0)];
+		
+		// A NULL block is a "query test" (the caller only wants the BOOL result).
+		
+		void (^rowsTest)(NSString *, NSString *, id, id, BOOL *) = NULL;
+		void (^objectsTest)(NSString *, NSString *, id, BOOL *) = NULL;
+		
+		deserializeCount = 0;
+		[[transaction ext:@"idx"] enumerateRowsMatchingQuery:query usingBlock:rowsTest];
+		[[transaction ext:@"idx"] enumerateKeysAndObjectsMatchingQuery:query usingBlock:objectsTest];
+		
+		XCTAssertTrue(deserializeCount == 0, @"Query test shouldn't deserialize: %lu", (unsigned long)deserializeCount);
+	}];
+}
+
+- (void)testPopulation
+{
+	[self _testPopulationWithConcurrency:1];
+	[self _testPopulationWithConcurrency:4];
+}
+
+- (void)_testPopulationWithConcurrency:(NSUInteger)concurrency
+{
+	NSString *name = [NSString stringWithFormat:@"%@-%lu", NSStringFromSelector(_cmd), (unsigned long)concurrency];
+	NSURL *databaseURL = [self databaseURL:name];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	// Every 10th object doesn't have a rank, and so doesn't have a row in the index.
+	
+	NSUInteger const count = 2345;
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"key%lu", (unsigned long)i];
+			NSDictionary *object = (i % 10) ? @{ @"rank":@(i) } : @{};
+			
+			[transaction setObject:object forKey:key inCollection:@"items"];
+			[transaction setObject:object forKey:key inCollection:@"ignored"];
+		}
+	}];
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"rank" withType:YapDatabaseSecondaryIndexTypeInteger];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		id rank = [(NSDictionary *)object objectForKey:@"rank"];
+		if (rank) {
+			[dict setObject:rank forKey:@"rank"];
+		}
+	}];
+	
+	YapDatabaseSecondaryIndexOptions *options = [[YapDatabaseSecondaryIndexOptions alloc] init];
+	XCTAssertTrue(options.populationConcurrency == 1);
+	
+	options.allowedCollections = [[YapWhitelistBlacklist alloc] initWithWhitelist:[NSSet setWithObject:@"items"]];
+	options.populationConcurrency = concurrency;
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler versionTag:@"1" options:options];
+	
+	XCTAssertTrue([database registerExtension:secondaryIndex withName:@"idx"], @"Error registering extension");
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger total = 0;
+		NSUInteger matches = 0;
+		
+		YapDatabaseQuery *query = [YapDatabaseQuery queryWithFormat:@"WHERE rank IS NOT NULL"];
+		[[transaction ext:@"idx"] getNumberOfRows:&total matchingQuery:query];
+		
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE rank >= ?", @(1000)];
+		[[transaction ext:@"idx"] getNumberOfRows:&matches matchingQuery:query];
+		
+		XCTAssertTrue(total == 2110, @"Bad count: %lu", (unsigned long)total);
+		XCTAssertTrue(matches == 1210, @"Bad count: %lu", (unsigned long)matches);
+		
+		// The column index is created after population
+		
+		NSString *plan = [[transaction ext:@"idx"] queryPlanForQuery:query];
+		XCTAssertTrue([plan rangeOfString:@"INDEX secondaryIndex_idx_rank"].location != NSNotFound, @"Plan: %@", plan);
+		
+		__block NSUInteger previousRank = 0;
+		query = [YapDatabaseQuery queryWithFormat:@"WHERE rank >= ? ORDER BY rank", @(2300)];
+		
+		[[transaction ext:@"idx"] enumerateKeysAndObjectsMatchingQuery:query usingBlock:
+		    ^(NSString *collection, NSString *key, id object, BOOL *stop) {
+			
+			NSUInteger rank = [[(NSDictionary *)object objectForKey:@"rank"] unsignedIntegerValue];
+			
+			XCTAssertEqualObjects(collection, @"items");
+			XCTAssertEqualObjects(key, ([NSString stringWithFormat:@"key%lu", (unsigned long)rank]));
+			XCTAssertTrue(rank > previousRank);
+			
+			previousRank = rank;
+		}];
+		
+		XCTAssertTrue(previousRank == 2344);
+	}];
+}
+
+- (void)testMaterializedAggregates
+{
+	NSString *databaseName = NSStringFromSelector(_cmd);
+	NSURL *databaseURL = [self databaseURL:databaseName];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	// Some rows exist before the extension is registered (initial population),
+	// and the rest are added afterwards (incremental updates).
+	
+	NSArray<NSString *> *departments = @[ @"dev", @"sales", @"hr" ];
+	
+	NSDictionary* (^employee)(NSUInteger) = ^NSDictionary* (NSUInteger i){
+		
+		NSMutableDictionary *dict = [NSMutableDictionary dictionaryWithCapacity:3];
+		dict[@"department"] = departments[i % 3];
+		dict[@"active"] = @((i % 4) != 0);
+		
+		if ((i % 7) != 0) {
+			dict[@"salary"] = @(1000 + ((i * 37) % 500));
+		}
+		
+		return dict;
+	};
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < 50; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"key%lu", (unsigned long)i];
+			[transaction setObject:employee(i) forKey:key inCollection:@"employees"];
+		}
+	}];
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"department" withType:YapDatabaseSecondaryIndexTypeText];
+	[setup addColumn:@"salary" withType:YapDatabaseSecondaryIndexTypeInteger];
+	[setup addColumn:@"active" withType:YapDatabaseSecondaryIndexTypeInteger];
+	
+	[setup addAggregateWithName:@"headcount"
+	                   function:YapDatabaseSecondaryIndexAggregateFunctionCount
+	                     column:nil
+	                    groupBy:@"department"
+	                  predicate:nil];
+	
+	[setup addAggregateWithName:@"payroll"
+	                   function:YapDatabaseSecondaryIndexAggregateFunctionSum
+	                     column:@"salary"
+	                    groupBy:nil
+	                  predicate:nil];
+	
+	[setup addAggregateWithName:@"avgSalary"
+	                   function:YapDatabaseSecondaryIndexAggregateFunctionAvg
+	                     column:@"salary"
+	                    groupBy:@"department"
+	                  predicate:nil];
+	
+	[setup addAggregateWithName:@"minActiveSalary"
+	                   function:YapDatabaseSecondaryIndexAggregateFunctionMin
+	                     column:@"salary"
+	                    groupBy:@"department"
+	                  predicate:@"active = 1"];
+	
+	[setup addAggregateWithName:@"maxSalary"
+	                   function:YapDatabaseSecondaryIndexAggregateFunctionMax
+	                     column:@"salary"
+	                    groupBy:nil
+	                  predicate:nil];
+	
+	XCTAssertTrue([[setup aggregates] count] == 5);
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict addEntriesFromDictionary:(NSDictionary *)object];
+	}];
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler versionTag:@"1"];
+	
+	XCTAssertTrue([database registerExtension:secondaryIndex withName:@"idx"], @"Error registering extension");
+	
+	// Every materialized aggregate should match the equivalent aggregate query
+	
+	void (^check)(YapDatabaseReadTransaction *) = ^(YapDatabaseReadTransaction *transaction){
+		
+		YapDatabaseSecondaryIndexTransaction *idx = [transaction ext:@"idx"];
+		YapDatabaseQuery *query = nil;
+		
+		query = [YapDatabaseQuery queryWithAggregateFunction:@"SUM(salary)" format:@""];
+		XCTAssertEqualObjects([idx valueForAggregate:@"payroll"], [idx performAggregateQuery:query]);
+		
+		query = [YapDatabaseQuery queryWithAggregateFunction:@"MAX(salary)" format:@""];
+		XCTAssertEqualObjects([idx valueForAggregate:@"maxSalary"], [idx performAggregateQuery:query]);
+		
+		for (NSString *department in departments)
+		{
+			query = [YapDatabaseQuery queryWithAggregateFunction:@"COUNT(*)"
+			                                              format:@"WHERE department = ?", department];
+			XCTAssertEqualObjects([idx valueForAggregate:@"headcount" inGroup:department],
+			                      [idx performAggregateQuery:query]);
+			
+			query = [YapDatabaseQuery queryWithAggregateFunction:@"MIN(salary)"
+			                                              format:@"WHERE department = ? AND active = 1", department];
+			XCTAssertEqualObjects([idx valueForAggregate:@"minActiveSalary" inGroup:department],
+			                      [idx performAggregateQuery:query]);
+			
+			query = [YapDatabaseQuery queryWithAggregateFunction:@"AVG(salary)"
+			                                              format:@"WHERE department = ?", department];
+			id avg = [idx valueForAggregate:@"avgSalary" inGroup:department];
+			id expectedAvg = [idx performAggregateQuery:query];
+			
+			if ([expectedAvg isKindOfClass:[NSNumber class]])
+				XCTAssertEqualWithAccuracy([avg doubleValue], [expectedAvg doubleValue], 0.0001);
+			else
+				XCTAssertEqualObjects(avg, expectedAvg);
+		}
+		
+		__block NSUInteger groupCount = 0;
+		__block NSUInteger headcount = 0;
+		
+		[idx enumerateGroupsForAggregate:@"headcount" usingBlock:^(id group, id value, BOOL *stop) {
+			
+			XCTAssertTrue([departments containsObject:group], @"Unexpected group: %@", group);
+			
+			groupCount++;
+			headcount += [value unsignedIntegerValue];
+		}];
+		
+		NSUInteger total = 0;
+		[idx getNumberOfRows:&total matchingQuery:[YapDatabaseQuery queryMatchingAll]];
+		
+		XCTAssertTrue(headcount == total, @"Bad headcount: %lu != %lu", (unsigned long)headcount, (unsigned long)total);
+		XCTAssertTrue(groupCount <= departments.count);
+		
+		XCTAssertNil([idx valueForAggregate:@"unknown"]);
+	};
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		check(transaction);
+	}];
+	
+	// Insert, update & remove rows
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 50; i < 100; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"key%lu", (unsigned long)i];
+			[transaction setObject:employee(i) forKey:key inCollection:@"employees"];
+		}
+		
+		// Changes within the transaction are visible immediately
+		check(transaction);
+		
+		// Move an employee to another department, and give them a raise
+		
+		[transaction setObject:@{ @"department":@"sales", @"salary":@(5000), @"active":@(YES) }
+		                forKey:@"key1"
+		          inCollection:@"employees"];
+		
+		// Remove the current min (active) salary in the dev department
+		
+		YapDatabaseSecondaryIndexTransaction *idx = [transaction ext:@"idx"];
+		NSNumber *minSalary = [idx valueForAggregate:@"minActiveSalary" inGroup:@"dev"];
+		
+		YapDatabaseQuery *query =
+		  [YapDatabaseQuery queryWithFormat:@"WHERE department = ? AND active = 1 AND salary = ?", @"dev", minSalary];
+		
+		NSMutableArray<NSString *> *keys = [NSMutableArray array];
+		[idx enumerateKeysMatchingQuery:query usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+			[keys addObject:key];
+		}];
+		
+		XCTAssertTrue(keys.count > 0);
+		[transaction removeObjectsForKeys:keys inCollection:@"employees"];
+		
+		check(transaction);
+		
+		NSNumber *newMinSalary = [idx valueForAggregate:@"minActiveSalary" inGroup:@"dev"];
+		XCTAssertTrue([newMinSalary integerValue] > [minSalary integerValue]);
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		check(transaction);
+	}];
+	
+	// Remove an entire group
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < 100; i++)
+		{
+			NSDictionary *object = employee(i);
+			if ([object[@"department"] isEqualToString:@"hr"])
+			{
+				NSString *key = [NSString stringWithFormat:@"key%lu", (unsigned long)i];
+				[transaction removeObjectForKey:key inCollection:@"employees"];
+			}
+		}
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		check(transaction);
+		
+		YapDatabaseSecondaryIndexTransaction *idx = [transaction ext:@"idx"];
+		
+		XCTAssertEqualObjects([idx valueForAggregate:@"headcount" inGroup:@"hr"], @(0));
+		XCTAssertEqualObjects([idx valueForAggregate:@"avgSalary" inGroup:@"hr"], [NSNull null]);
+	}];
+	
+	// Remove everything
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInAllCollections];
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		check(transaction);
+		
+		YapDatabaseSecondaryIndexTransaction *idx = [transaction ext:@"idx"];
+		
+		XCTAssertEqualObjects([idx valueForAggregate:@"payroll"], [NSNull null]);
+		XCTAssertEqualObjects([idx valueForAggregate:@"headcount" inGroup:@"dev"], @(0));
+	}];
+}
+
+- (YapDatabase *)jsonMetadataDatabaseWithName:(NSString *)databaseName
+{
+	NSURL *databaseURL = [self databaseURL:databaseName];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	[database registerMetadataSerializer:^NSData *(NSString *collection, NSString *key, id metadata) {
+		
+		return [NSJSONSerialization dataWithJSONObject:metadata options:0 error:nil];
+		
+	} forCollection:nil];
+	
+	[database registerMetadataDeserializer:^id (NSString *collection, NSString *key, NSData *data) {
+		
+		return [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+		
+	} forCollection:nil];
+	
+	return database;
+}
+
+- (void)testExpressionColumns
+{
+	YapDatabase *database = [self jsonMetadataDatabaseWithName:NSStringFromSelector(_cmd)];
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	// Some rows exist before the extension is registered (initial population),
+	// and the rest are added afterwards (incremental updates).
+	//
+	// Every 5th row doesn't have a rank, and so isn't included in the index.
+	
+	NSDictionary* (^metadataForIndex)(NSUInteger) = ^NSDictionary* (NSUInteger i){
+		
+		if ((i % 5) == 0)
+			return @{ @"kind":@"none" };
+		else
+			return @{ @"kind":((i % 2) ? @"odd" : @"even"), @"rank":@(i) };
+	};
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < 50; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"key%lu", (unsigned long)i];
+			
+			[transaction setObject:@"object" forKey:key inCollection:@"items" withMetadata:metadataForIndex(i)];
+			[transaction setObject:@"object" forKey:key inCollection:@"ignored" withMetadata:metadataForIndex(i)];
+		}
+	}];
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"rank"
+	        withType:YapDatabaseSecondaryIndexTypeInteger
+	      expression:@"json_extract(CAST(\"metadata\" AS TEXT), '$.rank')"];
+	[setup addColumn:@"kind"
+	        withType:YapDatabaseSecondaryIndexTypeText
+	      expression:@"CASE WHEN json_extract(CAST(\"metadata\" AS TEXT), '$.rank') IS NOT NULL"
+	                 @" THEN json_extract(CAST(\"metadata\" AS TEXT), '$.kind') END"
+	         indexed:NO];
+	
+	YapDatabaseSecondaryIndexOptions *options = [[YapDatabaseSecondaryIndexOptions alloc] init];
+	options.allowedCollections = [[YapWhitelistBlacklist alloc] initWithWhitelist:[NSSet setWithObject:@"items"]];
+	
+	// No handler needed, as every column is an expression column
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup versionTag:@"1" options:options];
+	
+	XCTAssertTrue([database registerExtension:secondaryIndex withName:@"idx"], @"Error registering extension");
+	
+	void (^check)(YapDatabaseReadTransaction *, NSUInteger, NSUInteger) =
+	  ^(YapDatabaseReadTransaction *transaction, NSUInteger expectedTotal, NSUInteger expectedOdd){
+		
+		NSUInteger total = 0;
+		NSUInteger odd = 0;
+		
+		[[transaction ext:@"idx"] getNumberOfRows:&total matchingQuery:[YapDatabaseQuery queryMatchingAll]];
+		
+		YapDatabaseQuery *query = [YapDatabaseQuery queryWithFormat:@"WHERE kind = ?", @"odd"];
+		[[transaction ext:@"idx"] getNumberOfRows:&odd matchingQuery:query];
+		
+		XCTAssertTrue(total == expectedTotal, @"Bad count: %lu", (unsigned long)total);
+		XCTAssertTrue(odd == expectedOdd, @"Bad count: %lu", (unsigned long)odd);
+	};
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		check(transaction, 40, 20);
+		
+		// The expression columns are indexed like any other column
+		
+		YapDatabaseQuery *query = [YapDatabaseQuery queryWithFormat:@"WHERE rank >= ? ORDER BY rank", @(45)];
+		
+		NSString *plan = [[transaction ext:@"idx"] queryPlanForQuery:query];
+		XCTAssertTrue([plan rangeOfString:@"INDEX secondaryIndex_idx_rank"].location != NSNotFound, @"Plan: %@", plan);
+		
+		NSMutableArray<NSString *> *keys = [NSMutableArray array];
+		[[transaction ext:@"idx"] enumerateKeysMatchingQuery:query usingBlock:
+		    ^(NSString *collection, NSString *key, BOOL *stop) {
+			
+			XCTAssertEqualObjects(collection, @"items");
+			[keys addObject:key];
+		}];
+		
+		XCTAssertEqualObjects(keys, (@[ @"key46", @"key47", @"key48", @"key49" ]));
+	}];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		// Insert
+		
+		for (NSUInteger i = 50; i < 60; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"key%lu", (unsigned long)i];
+			[transaction setObject:@"object" forKey:key inCollection:@"items" withMetadata:metadataForIndex(i)];
+		}
+		
+		check(transaction, 48, 24);
+		
+		// Update the metadata: add a rank, remove a rank, and change a rank
+		
+		[transaction replaceMetadata:@{ @"kind":@"odd", @"rank":@(1000) } forKey:@"key0" inCollection:@"items"];
+		[transaction replaceMetadata:@{ @"kind":@"none" } forKey:@"key1" inCollection:@"items"];
+		[transaction replaceMetadata:@{ @"kind":@"odd", @"rank":@(-1) } forKey:@"key2" inCollection:@"items"];
+		
+		check(transaction, 48, 25);
+		
+		// Remove
+		
+		[transaction removeObjectForKey:@"key3" inCollection:@"items"];
+		[transaction removeObjectForKey:@"key5" inCollection:@"items"]; // not in the index
+		
+		check(transaction, 47, 24);
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		check(transaction, 47, 24);
+		
+		YapDatabaseQuery *query = [YapDatabaseQuery queryWithFormat:@"WHERE rank < ? OR rank >= ?", @(1), @(1000)];
+		
+		__block NSUInteger count = 0;
+		[[transaction ext:@"idx"] enumerateKeysMatchingQuery:query usingBlock:
+		    ^(NSString *collection, NSString *key, BOOL *stop) {
+			
+			XCTAssertTrue([key isEqualToString:@"key0"] || [key isEqualToString:@"key2"], @"Unexpected key: %@", key);
+			count++;
+		}];
+		
+		XCTAssertTrue(count == 2);
+	}];
+}
+
+- (void)testMixedExpressionColumns
+{
+	YapDatabase *database = [self jsonMetadataDatabaseWithName:NSStringFromSelector(_cmd)];
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < 20; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"key%lu", (unsigned long)i];
+			NSString *object = (i % 2) ? [NSString stringWithFormat:@"name%lu", (unsigned long)i] : @"";
+			NSDictionary *metadata = (i % 3) ? @{ @"rank":@(i) } : @{};
+			
+			[transaction setObject:object forKey:key inCollection:@"items" withMetadata:metadata];
+		}
+	}];
+	
+	// The name comes from the handler block, and the rank is calculated by sqlite
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"name" withType:YapDatabaseSecondaryIndexTypeText];
+	[setup addColumn:@"rank"
+	        withType:YapDatabaseSecondaryIndexTypeInteger
+	      expression:@"json_extract(CAST(\"metadata\" AS TEXT), '$.rank')"];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withOptions:
+	    (YapDatabaseBlockInvokeIfObjectModified | YapDatabaseBlockInvokeIfMetadataModified) objectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		if ([(NSString *)object length] > 0) {
+			[dict setObject:object forKey:@"name"];
+		}
+	}];
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler versionTag:@"1"];
+	
+	XCTAssertTrue([database registerExtension:secondaryIndex withName:@"idx"], @"Error registering extension");
+	
+	// Rows are included if they have a name (odd) or a rank (not a multiple of 3).
+	// That's every row except 0, 6, 12 & 18.
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger total = 0;
+		[[transaction ext:@"idx"] getNumberOfRows:&total matchingQuery:[YapDatabaseQuery queryMatchingAll]];
+		
+		XCTAssertTrue(total == 16, @"Bad count: %lu", (unsigned long)total);
+		
+		NSUInteger both = 0;
+		YapDatabaseQuery *query = [YapDatabaseQuery queryWithFormat:@"WHERE name IS NOT NULL AND rank IS NOT NULL"];
+		[[transaction ext:@"idx"] getNumberOfRows:&both matchingQuery:query];
+		
+		XCTAssertTrue(both == 7, @"Bad count: %lu", (unsigned long)both);
+	}];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		// Remove the name (key1 still has a rank, key3 doesn't)
+		
+		[transaction replaceObject:@"" forKey:@"key1" inCollection:@"items"];
+		[transaction replaceObject:@"" forKey:@"key3" inCollection:@"items"];
+		
+		// Add a rank (key0 is included again)
+		
+		[transaction replaceMetadata:@{ @"rank":@(100) } forKey:@"key0" inCollection:@"items"];
+	}];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger total = 0;
+		[[transaction ext:@"idx"] getNumberOfRows:&total matchingQuery:[YapDatabaseQuery queryMatchingAll]];
+		
+		XCTAssertTrue(total == 16, @"Bad count: %lu", (unsigned long)total);
+		
+		NSUInteger count = 0;
+		YapDatabaseQuery *query = [YapDatabaseQuery queryWithFormat:@"WHERE name IS NULL AND rank IS NOT NULL"];
+		[[transaction ext:@"idx"] getNumberOfRows:&count matchingQuery:query];
+		
+		// 0, 1, 2, 4, 8, 10, 14, 16
+		XCTAssertTrue(count == 8, @"Bad count: %lu", (unsigned long)count);
+	}];
+}
+
+- (void)testSlowQueryLog
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"tenant" withType:YapDatabaseSecondaryIndexTypeText];
+	[setup addColumn:@"status" withType:YapDatabaseSecondaryIndexTypeInteger];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		[dict addEntriesFromDictionary:(NSDictionary *)object];
+	}];
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler];
+	
+	XCTAssertTrue([database registerExtension:secondaryIndex withName:@"idx"]);
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (int i = 0; i < 10; i++)
+		{
+			NSDictionary *object = @{
+			  @"tenant" : [NSString stringWithFormat:@"tenant%d", (i % 2)],
+			  @"status" : @(i % 3)
+			};
+			
+			[transaction setObject:object forKey:[NSString stringWithFormat:@"key%d", i] inCollection:nil];
+		}
+	}];
+	
+	YapDatabaseSecondaryIndexConnection *idxConnection = [connection ext:@"idx"];
+	
+	// Disabled by default
+	
+	XCTAssertTrue(idxConnection.slowQueryThreshold == 0.0);
+	
+	YapDatabaseQuery *query = [YapDatabaseQuery queryWithFormat:@"WHERE tenant = ? AND status >= ?", @"tenant0", @(1)];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[[transaction ext:@"idx"] enumerateKeysMatchingQuery:query usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {}];
+	}];
+	
+	XCTAssertTrue([idxConnection slowQueries].count == 0);
+	
+	// The elapsed time includes the enumeration block,
+	// so sleeping within the block makes the query slow.
+	
+	idxConnection.slowQueryThreshold = 0.001;
+	
+	__block NSUInteger matchCount = 0;
+	
+	for (int i = 0; i < 2; i++)
+	{
+		matchCount = 0;
+		
+		[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			[[transaction ext:@"idx"] enumerateKeysMatchingQuery:query
+			                                          usingBlock:^(NSString *collection, NSString *key, BOOL *stop)
+			{
+				matchCount++;
+				[NSThread sleepForTimeInterval:0.001];
+			}];
+		}];
+	}
+	
+	NSArray<YapDatabaseSlowQuery *> *slowQueries = [idxConnection slowQueries];
+	XCTAssertTrue(slowQueries.count == 2, @"Bad count: %lu", (unsigned long)slowQueries.count);
+	
+	YapDatabaseSlowQuery *slowQuery = [slowQueries lastObject];
+	
+	XCTAssertTrue([slowQuery.queryString rangeOfString:@"WHERE tenant = ? AND status >= ?"].location != NSNotFound);
+	XCTAssertEqualObjects(slowQuery.parameterShape, @"(text, integer)");
+	XCTAssertTrue(slowQuery.rowCount == matchCount, @"Bad rowCount: %lu", (unsigned long)slowQuery.rowCount);
+	XCTAssertTrue(slowQuery.duration >= 0.001);
+	
+	NSArray<YapDatabaseSlowQuerySummary *> *summary = [idxConnection slowQuerySummary];
+	XCTAssertTrue(summary.count == 1, @"Bad count: %lu", (unsigned long)summary.count);
+	
+	XCTAssertEqualObjects(summary[0].queryString, slowQuery.queryString);
+	XCTAssertTrue(summary[0].count == 2);
+	XCTAssertTrue(summary[0].totalRowCount == (matchCount * 2));
+	XCTAssertTrue(summary[0].maxDuration >= summary[0].averageDuration);
+	
+	// Fast queries aren't recorded
+	
+	idxConnection.slowQueryThreshold = 60.0;
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSUInteger count = 0;
+		[[transaction ext:@"idx"] getNumberOfRows:&count matchingQuery:query];
+	}];
+	
+	XCTAssertTrue([idxConnection slowQueries].count == 2);
+	
+	[idxConnection removeAllSlowQueries];
+	
+	XCTAssertTrue([idxConnection slowQueries].count == 0);
+	XCTAssertTrue([idxConnection slowQuerySummary].count == 0);
+	XCTAssertTrue(idxConnection.slowQueryThreshold == 60.0);
+	
+	idxConnection.slowQueryThreshold = 0.0;
+	XCTAssertTrue(idxConnection.slowQueryThreshold == 0.0);
+}
+
+- (void)testSlowQueryLogSummaryLimit
+{
+	YapDatabaseSlowQueryLog *log = [[YapDatabaseSlowQueryLog alloc] initWithThreshold:0.0];
+	log.summaryLimit = 3;
+	
+	[log recordQueryString:@"A" parameters:nil rowCount:1 duration:0.5];
+	[log recordQueryString:@"B" parameters:nil rowCount:1 duration:0.1];
+	[log recordQueryString:@"C" parameters:nil rowCount:1 duration:0.3];
+	[log recordQueryString:@"B" parameters:nil rowCount:1 duration:0.1];
+	
+	XCTAssertTrue([log summaries].count == 3);
+	
+	// The summary with the smallest totalDuration ("B" at 0.2) is evicted to make room
+	
+	[log recordQueryString:@"D" parameters:nil rowCount:1 duration:0.4];
+	
+	NSArray<YapDatabaseSlowQuerySummary *> *summaries = [log summaries];
+	XCTAssertTrue(summaries.count == 3, @"Bad count: %lu", (unsigned long)summaries.count);
+	
+	NSArray<NSString *> *queryStrings = [summaries valueForKey:@"queryString"];
+	XCTAssertEqualObjects(queryStrings, (@[ @"A", @"D", @"C" ]));
+	
+	// Existing summaries are still updated when the limit has been reached
+	
+	[log recordQueryString:@"C" parameters:nil rowCount:1 duration:0.3];
+	
+	summaries = [log summaries];
+	XCTAssertTrue(summaries.count == 3);
+	XCTAssertEqualObjects(summaries[0].queryString, @"C");
+	XCTAssertTrue(summaries[0].count == 2);
+	
+	// The queries are bounded separately
+	
+	XCTAssertTrue([log queries].count == 6);
+}
+
+- (void)testCombinedQueries
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	// Secondary index: status
+	
+	YapDatabaseSecondaryIndexSetup *setup = [[YapDatabaseSecondaryIndexSetup alloc] init];
+	[setup addColumn:@"status" withType:YapDatabaseSecondaryIndexTypeInteger];
+	
+	YapDatabaseSecondaryIndexHandler *handler = [YapDatabaseSecondaryIndexHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		dict[@"status"] = object[@"status"];
+	}];
+	
+	YapDatabaseSecondaryIndex *secondaryIndex =
+	  [[YapDatabaseSecondaryIndex alloc] initWithSetup:setup handler:handler];
+	
+	XCTAssertTrue([database registerExtension:secondaryIndex withName:@"idx"]);
+	
+	// RTree index: position
+	
+	YapDatabaseRTreeIndexSetup *rTreeSetup = [[YapDatabaseRTreeIndexSetup alloc] init];
+	[rTreeSetup setColumns:@[ @"minX", @"maxX", @"minY", @"maxY" ]];
+	
+	YapDatabaseRTreeIndexHandler *rTreeHandler = [YapDatabaseRTreeIndexHandler withObjectBlock:
+	    ^(NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		dict[@"minX"] = dict[@"maxX"] = object[@"x"];
+		dict[@"minY"] = dict[@"maxY"] = object[@"y"];
+	}];
+	
+	YapDatabaseRTreeIndex *rTreeIndex =
+	  [[YapDatabaseRTreeIndex alloc] initWithSetup:rTreeSetup handler:rTreeHandler];
+	
+	XCTAssertTrue([database registerExtension:rTreeIndex withName:@"rtree"]);
+	
+	// Full text search: name
+	
+	YapDatabaseFullTextSearchHandler *ftsHandler = [YapDatabaseFullTextSearchHandler withObjectBlock:
+	    ^(YapDatabaseReadTransaction *transaction, NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		dict[@"name"] = object[@"name"];
+	}];
+	
+	YapDatabaseFullTextSearch *fts =
+	  [[YapDatabaseFullTextSearch alloc] initWithColumnNames:@[ @"name" ] handler:ftsHandler];
+	
+	XCTAssertTrue([database registerExtension:fts withName:@"fts"]);
+	
+	NSArray<NSString *> *words = @[ @"coffee", @"tea", @"juice" ];
+	NSMutableSet<NSString *> *expectedKeys = [NSMutableSet set];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (int i = 0; i < 100; i++)
+		{
+			NSDictionary *object = @{
+			  @"name"   : [NSString stringWithFormat:@"%@ shop %d", words[i % 3], i],
+			  @"status" : @(i % 4),
+			  @"x"      : @(i % 10),
+			  @"y"      : @(i / 10)
+			};
+			
+			NSString *key = [NSString stringWithFormat:@"key%d", i];
+			[transaction setObject:object forKey:key inCollection:@"shops"];
+			
+			BOOL matchesText = (i % 3 == 0);
+			BOOL matchesStatus = (i % 4 == 3);
+			BOOL matchesBox = ((i % 10) <= 5) && ((i / 10) >= 2);
+			
+			if (matchesText && matchesStatus && matchesBox) {
+				[expectedKeys addObject:key];
+			}
+		}
+	}];
+	
+	XCTAssertTrue(expectedKeys.count > 0);
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		NSDictionary *queries = @{
+		  @"fts"   : [[transaction ext:@"fts"] queryMatching:@"coffee"],
+		  @"rtree" : [YapDatabaseQuery queryWithFormat:@"WHERE maxX <= ? AND minY >= ?", @(5), @(2)],
+		  @"idx"   : [YapDatabaseQuery queryWithFormat:@"WHERE status = ?", @(3)]
+		};
+		
+		NSMutableSet<NSString *> *keys = [NSMutableSet set];
+		
+		BOOL result = [transaction enumerateKeysAndObjectsMatchingQueries:queries
+		                                                       usingBlock:^(NSString *collection, NSString *key, id object, BOOL *stop)
+		{
+			XCTAssertEqualObjects(collection, @"shops");
+			XCTAssertTrue([object[@"name"] hasPrefix:@"coffee"]);
+			
+			[keys addObject:key];
+		}];
+		
+		XCTAssertTrue(result);
+		XCTAssertEqualObjects(keys, expectedKeys);
+		
+		NSUInteger count = 0;
+		result = [transaction getNumberOfRows:&count matchingQueries:queries];
+		
+		XCTAssertTrue(result);
+		XCTAssertTrue(count == expectedKeys.count, @"Bad count: %lu", (unsigned long)count);
+		
+		// Column query against the fts extension
+		
+		NSDictionary *columnQueries = @{
+		  @"fts" : [YapDatabaseQuery queryWithFormat:@"WHERE name MATCH ?", @"tea"],
+		  @"idx" : [YapDatabaseQuery queryWithFormat:@"WHERE status = ?", @(1)]
+		};
+		
+		count = 0;
+		[transaction getNumberOfRows:&count matchingQueries:columnQueries];
+		
+		// i % 3 == 1 && i % 4 == 1 => i % 12 == 1 => 1, 13, 25, ..., 97
+		XCTAssertTrue(count == 9, @"Bad count: %lu", (unsigned long)count);
+		
+		// Unknown extension
+		
+		NSDictionary *badQueries = @{
+		  @"idx"     : [YapDatabaseQuery queryWithFormat:@"WHERE status = ?", @(3)],
+		  @"missing" : [YapDatabaseQuery queryMatchingAll]
+		};
+		
+		result = [transaction enumerateKeysMatchingQueries:badQueries
+		                                        usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {}];
+		XCTAssertFalse(result);
+	}];
+}
+
+- (void)testRTreeNearestNeighbors
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:nil];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseConnection *connection = [database newConnection];
+	
+	YapDatabaseRTreeIndexSetup *setup = [[YapDatabaseRTreeIndexSetup alloc] init];
+	[setup setColumns:@[ @"minX", @"maxX", @"minY", @"maxY" ]];
+	
+	YapDatabaseRTreeIndexHandler *handler = [YapDatabaseRTreeIndexHandler withObjectBlock:
+	    ^(NSMutableDictionary *dict, NSString *collection, NSString *key, id object){
+		
+		dict[@"minX"] = dict[@"maxX"] = object[@"x"];
+		dict[@"minY"] = dict[@"maxY"] = object[@"y"];
+	}];
+	
+	YapDatabaseRTreeIndex *rTreeIndex = [[YapDatabaseRTreeIndex alloc] initWithSetup:setup handler:handler];
+	
+	XCTAssertTrue([database registerExtension:rTreeIndex withName:@"rtree"]);
+	
+	NSUInteger count = 1000;
+	NSMutableDictionary<NSString *, NSDictionary *> *points = [NSMutableDictionary dictionaryWithCapacity:count];
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			NSString *key = [NSString stringWithFormat:@"%lu", (unsigned long)i];
+			NSDictionary *object = @{ @"x" : @(arc4random_uniform(1000)), @"y" : @(arc4random_uniform(1000)) };
+			
+			points[key] = object;
+			[transaction setObject:object forKey:key inCollection:@"places"];
+		}
+	}];
+	
+	double (^distance)(NSDictionary *, double, double) = ^double (NSDictionary *object, double x, double y){
+		
+		double dx = [object[@"x"] doubleValue] - x;
+		double dy = [object[@"y"] doubleValue] - y;
+		
+		return sqrt((dx * dx) + (dy * dy));
+	};
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSUInteger i = 0; i < 20; i++)
+		{
+			double x = arc4random_uniform(1000);
+			double y = arc4random_uniform(1000);
+			
+			NSArray<NSDictionary *> *expectedOrder = [points.allValues
+			  sortedArrayUsingComparator:^NSComparisonResult(NSDictionary *obj1, NSDictionary *obj2) {
+				
+				return [@(distance(obj1, x, y)) compare:@(distance(obj2, x, y))];
+			}];
+			
+			NSMutableArray<NSNumber *> *distances = [NSMutableArray array];
+			
+			BOOL result =
+			  [[transaction ext:@"rtree"] enumerateKeysAndObjectsNearestToPoint:@[ @(x), @(y) ]
+			                                                              limit:10
+			                                                         usingBlock:
+			    ^(NSString *collection, NSString *key, id object, BOOL *stop)
+			{
+				XCTAssertEqualObjects(object, points[key]);
+				[distances addObject:@(distance(object, x, y))];
+			}];
+			
+			XCTAssertTrue(result);
+			XCTAssertTrue(distances.count == 10, @"Wrong count: %lu", (unsigned long)distances.count);
+			
+			for (NSUInteger n = 0; n < distances.count; n++)
+			{
+				double expected = distance(expectedOrder[n], x, y);
+				XCTAssertEqualWithAccuracy([distances[n] doubleValue], expected, 0.0001, @"Wrong order at %lu", (unsigned long)n);
+			}
+		}
+		
+		// No limit: every row, closest first
+		
+		__block NSUInteger enumerated = 0;
+		__block double lastDistance = 0.0;
+		
+		[[transaction ext:@"rtree"] enumerateKeysNearestToPoint:@[ @(500), @(500) ]
+		                                                  limit:0
+		                                             usingBlock:^(NSString *collection, NSString *key, BOOL *stop)
+		{
+			double d = distance(points[key], 500, 500);
+			XCTAssertTrue(d >= lastDistance);
+			
+			lastDistance = d;
+			enumerated++;
+		}];
+		
+		XCTAssertTrue(enumerated == count, @"Wrong count: %lu", (unsigned long)enumerated);
+		
+		// Stop ends the search early
+		
+		enumerated = 0;
+		[[transaction ext:@"rtree"] enumerateKeysNearestToPoint:@[ @(500), @(500) ]
+		                                                  limit:0
+		                                             usingBlock:^(NSString *collection, NSString *key, BOOL *stop)
+		{
+			if (++enumerated == 3) *stop = YES;
+		}];
+		
+		XCTAssertTrue(enumerated == 3, @"Wrong count: %lu", (unsigned long)enumerated);
+		
+		// The point requires a coordinate per dimension
+		
+		XCTAssertFalse([[transaction ext:@"rtree"] enumerateKeysNearestToPoint:@[ @(500) ]
+		                                                                  limit:10
+		                                                             usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {}]);
+	}];
+}
+
 @end
@@ -4,6 +4,8 @@
 #import "YapDatabaseView.h"
 #import "YapDatabaseAutoView.h"
 
+#import <sqlite3.h>
+
 @interface TestYapDatabaseView : XCTestCase
 @end
 
@@ -1954,6 +1956,285 @@
 #pragma mark -
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+- (void)testMigrationFromClassVersion3
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[self _testMigrationFromClassVersion3_withURL:databaseURL failMigration:NO];
+}
+
+- (void)testMigrationFromClassVersion3_fallback
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	[self _testMigrationFromClassVersion3_withURL:databaseURL failMigration:YES];
+}
+
+- (BOOL)_execSQL:(NSArray<NSString *> *)statements onDatabaseAtURL:(NSURL *)databaseURL
+{
+	sqlite3 *db = NULL;
+	int status = sqlite3_open_v2([[databaseURL path] UTF8String], &db, SQLITE_OPEN_READWRITE, NULL);
+	if (status != SQLITE_OK)
+	{
+		sqlite3_close(db);
+		return NO;
+	}
+	
+	BOOL result = YES;
+	for (NSString *statement in statements)
+	{
+		status = sqlite3_exec(db, [statement UTF8String], NULL, NULL, NULL);
+		if (status != SQLITE_OK)
+		{
+			NSLog(@"Error executing '%@': %d %s", statement, status, sqlite3_errmsg(db));
+			result = NO;
+			break;
+		}
+	}
+	
+	sqlite3_close(db);
+	return result;
+}
+
+- (int64_t)_int64ForQuery:(NSString *)query onDatabaseAtURL:(NSURL *)databaseURL
+{
+	sqlite3 *db = NULL;
+	sqlite3_stmt *statement = NULL;
+	int64_t result = -1;
+	
+	if (sqlite3_open_v2([[databaseURL path] UTF8String], &db, SQLITE_OPEN_READONLY, NULL) == SQLITE_OK &&
+	    sqlite3_prepare_v2(db, [query UTF8String], -1, &statement, NULL) == SQLITE_OK)
+	{
+		if (sqlite3_step(statement) == SQLITE_ROW) {
+			result = sqlite3_column_int64(statement, 0);
+		}
+	}
+	
+	sqlite3_finalize(statement);
+	sqlite3_close(db);
+	return result;
+}
+
+- (void)_testMigrationFromClassVersion3_withURL:(NSURL *)databaseURL failMigration:(BOOL)failMigration
+{
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	
+	NSString *viewName = @"order";
+	NSString *mapTableName = [NSString stringWithFormat:@"view_%@_map", viewName];
+	NSString *pageTableName = [NSString stringWithFormat:@"view_%@_page", viewName];
+	
+	__block NSUInteger groupingCount = 0;
+	
+	YapDatabaseViewGrouping *grouping = [YapDatabaseViewGrouping withObjectBlock:
+	    ^NSString *(YapDatabaseReadTransaction *transaction, NSString *collection, NSString *key, id object){
+		
+		groupingCount++;
+		return ([(NSNumber *)object integerValue] % 2 == 0) ? @"even" : @"odd";
+	}];
+	
+	YapDatabaseViewSorting *sorting = [YapDatabaseViewSorting withObjectBlock:
+		^(YapDatabaseReadTransaction *transaction, NSString *group,
+		    NSString *collection1, NSString *key1, id obj1,
+		    NSString *collection2, NSString *key2, id obj2)
+	{
+		return [(NSNumber *)obj1 compare:(NSNumber *)obj2];
+	}];
+	
+	NSDictionary<NSString *, NSArray<NSString *> *> * (^snapshot)(YapDatabaseReadTransaction *) =
+	  ^NSDictionary<NSString *, NSArray<NSString *> *> * (YapDatabaseReadTransaction *transaction){
+		
+		NSMutableDictionary<NSString *, NSArray<NSString *> *> *result = [NSMutableDictionary dictionary];
+		YapDatabaseViewTransaction *viewTransaction = [transaction ext:viewName];
+		
+		for (NSString *group in [viewTransaction allGroups])
+		{
+			NSMutableArray<NSString *> *keys = [NSMutableArray array];
+			[viewTransaction enumerateKeysInGroup:group
+			                           usingBlock:^(NSString *collection, NSString *key, NSUInteger index, BOOL *stop)
+			{
+				[keys addObject:key];
+			}];
+			
+			XCTAssert([keys count] == [viewTransaction numberOfItemsInGroup:group],
+			          @"Count mismatch in group(%@)", group);
+			
+			result[group] = keys;
+		}
+		
+		return result;
+	};
+	
+	BOOL (^registerView)(YapDatabase *) = ^BOOL (YapDatabase *database){
+		
+		YapDatabaseViewOptions *options = [[YapDatabaseViewOptions alloc] init];
+		options.isPersistent = YES;
+		
+		YapDatabaseAutoView *view =
+		  [[YapDatabaseAutoView alloc] initWithGrouping:grouping sorting:sorting versionTag:@"1" options:options];
+		
+		return [database registerExtension:view withName:viewName];
+	};
+	
+	// Populate the view using the current class version.
+	// Enough rows for several pages per group, inserted out of order so pages are split along the way.
+	
+	NSUInteger const rowCount = 400;
+	__block NSDictionary<NSString *, NSArray<NSString *> *> *expected = nil;
+	
+	@autoreleasepool {
+		
+		YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+		XCTAssertNotNil(database, @"Oops");
+		XCTAssertTrue(registerView(database));
+		
+		YapDatabaseConnection *connection = [database newConnection];
+		[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			for (NSUInteger i = 0; i < rowCount; i++)
+			{
+				NSUInteger value = (i * 7919) % rowCount;
+				[transaction setObject:@(value) forKey:[NSString stringWithFormat:@"key%lu", (unsigned long)value]
+				          inCollection:nil];
+			}
+		}];
+		
+		[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			expected = snapshot(transaction);
+		}];
+	}
+	
+	XCTAssert(expected.count == 2);
+	XCTAssert([expected[@"even"] count] == rowCount / 2);
+	XCTAssert([expected[@"odd"] count] == rowCount / 2);
+	
+	NSString *pageCountQuery = [NSString stringWithFormat:@"SELECT COUNT(*) FROM \"%@\";", pageTableName];
+	int64_t pageCount = [self _int64ForQuery:pageCountQuery onDatabaseAtURL:databaseURL];
+	
+	XCTAssert(pageCount > 2, @"Expected multiple pages per group");
+	
+	// Rewrite the tables into the class version 3 format (string pageKeys).
+	// The pages are inserted in reverse order, so the new pageIds (taken from the rowids) differ from the old ones.
+	
+	NSMutableArray<NSString *> *downgrade = [NSMutableArray arrayWithObjects:
+	
+	  @"CREATE TABLE \"v3_map\""
+	  @" (\"rowid\" INTEGER PRIMARY KEY,"
+	  @"  \"pageKey\" CHAR NOT NULL"
+	  @" );",
+	
+	  @"CREATE TABLE \"v3_page\""
+	  @" (\"pageKey\" CHAR NOT NULL PRIMARY KEY,"
+	  @"  \"group\" CHAR NOT NULL,"
+	  @"  \"prevPageKey\" CHAR,"
+	  @"  \"count\" INTEGER,"
+	  @"  \"data\" BLOB"
+	  @" );",
+	
+	  [NSString stringWithFormat:
+	    @"INSERT INTO \"v3_page\" (\"pageKey\", \"group\", \"prevPageKey\", \"count\", \"data\")"
+	    @" SELECT 'page-' || \"pageId\", \"group\", 'page-' || \"prevPageId\", \"count\", \"data\""
+	    @" FROM \"%@\" ORDER BY \"pageId\" DESC;", pageTableName],
+	
+	  [NSString stringWithFormat:
+	    @"INSERT INTO \"v3_map\" (\"rowid\", \"pageKey\")"
+	    @" SELECT \"rowid\", 'page-' || \"pageId\" FROM \"%@\";", mapTableName],
+	
+	  [NSString stringWithFormat:@"DROP TABLE \"%@\";", mapTableName],
+	  [NSString stringWithFormat:@"DROP TABLE \"%@\";", pageTableName],
+	
+	  [NSString stringWithFormat:@"ALTER TABLE \"v3_map\" RENAME TO \"%@\";", mapTableName],
+	  [NSString stringWithFormat:@"ALTER TABLE \"v3_page\" RENAME TO \"%@\";", pageTableName],
+	
+	  [NSString stringWithFormat:
+	    @"UPDATE \"yap2\" SET \"data\" = 3 WHERE \"extension\" = '%@' AND \"key\" = 'classVersion';", viewName],
+	
+	  nil];
+	
+	if (failMigration)
+	{
+		// A view with the name of the migration's temporary table makes the migration fail before anything is converted.
+		// (DROP TABLE can't be used to drop a view.)
+		
+		[downgrade addObject:[NSString stringWithFormat:
+		  @"CREATE VIEW \"%@_v4\" AS SELECT 1;", pageTableName]];
+	}
+	
+	XCTAssertTrue([self _execSQL:downgrade onDatabaseAtURL:databaseURL]);
+	
+	// Re-register the view.
+	// The tables should be migrated in place, without invoking the grouping/sorting blocks.
+	// If the migration fails, the view must fallback to re-populating itself.
+	
+	@autoreleasepool {
+		
+		groupingCount = 0;
+		
+		YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+		XCTAssertNotNil(database, @"Oops");
+		XCTAssertTrue(registerView(database));
+		
+		if (failMigration)
+			XCTAssert(groupingCount == rowCount, @"Expected view to be re-populated");
+		else
+			XCTAssert(groupingCount == 0, @"Expected view to be migrated without re-populating");
+		
+		YapDatabaseConnection *connection = [database newConnection];
+		[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			XCTAssertEqualObjects(snapshot(transaction), expected);
+		}];
+		
+		// The migrated view must continue to work (new pages must not collide with migrated pageIds).
+		
+		[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			for (NSUInteger i = rowCount; i < rowCount * 2; i++)
+			{
+				[transaction setObject:@(i) forKey:[NSString stringWithFormat:@"key%lu", (unsigned long)i]
+				          inCollection:nil];
+			}
+		}];
+		
+		[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			NSDictionary<NSString *, NSArray<NSString *> *> *result = snapshot(transaction);
+			
+			XCTAssert([result[@"even"] count] == rowCount);
+			XCTAssert([result[@"odd"] count] == rowCount);
+			
+			XCTAssertEqualObjects([result[@"even"] subarrayWithRange:NSMakeRange(0, rowCount / 2)], expected[@"even"]);
+			XCTAssertEqualObjects([result[@"odd"] subarrayWithRange:NSMakeRange(0, rowCount / 2)], expected[@"odd"]);
+		}];
+	}
+	
+	// Check the tables directly.
+	// Every page (except the first in each group) must link to an existing page in the same group.
+	
+	NSString *classVersionQuery =
+	  [NSString stringWithFormat:@"SELECT \"data\" FROM \"yap2\" WHERE \"extension\" = '%@' AND \"key\" = 'classVersion';",
+	    viewName];
+	XCTAssert([self _int64ForQuery:classVersionQuery onDatabaseAtURL:databaseURL] == 4);
+	
+	NSString *firstPagesQuery =
+	  [NSString stringWithFormat:@"SELECT COUNT(*) FROM \"%@\" WHERE \"prevPageId\" IS NULL;", pageTableName];
+	XCTAssert([self _int64ForQuery:firstPagesQuery onDatabaseAtURL:databaseURL] == 2);
+	
+	NSString *brokenLinksQuery = [NSString stringWithFormat:
+	  @"SELECT COUNT(*) FROM \"%@\" AS \"page\""
+	  @" LEFT JOIN \"%@\" AS \"prev\" ON \"prev\".\"pageId\" = \"page\".\"prevPageId\""
+	  @" WHERE \"page\".\"prevPageId\" IS NOT NULL AND (\"prev\".\"pageId\" IS NULL OR \"prev\".\"group\" != \"page\".\"group\");",
+	  pageTableName, pageTableName];
+	XCTAssert([self _int64ForQuery:brokenLinksQuery onDatabaseAtURL:databaseURL] == 0);
+	
+	NSString *mapCountQuery = [NSString stringWithFormat:@"SELECT COUNT(*) FROM \"%@\";", mapTableName];
+	XCTAssert([self _int64ForQuery:mapCountQuery onDatabaseAtURL:databaseURL] == (int64_t)(rowCount * 2));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 - (void)testViewPopulation_persistent
 {
 	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
@@ -3358,4 +3639,350 @@
 	}];
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)testBatchedEnumeration_persistent
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	YapDatabaseViewOptions *options = [[YapDatabaseViewOptions alloc] init];
+	options.isPersistent = YES;
+	
+	[self _testBatchedEnumeration_withURL:databaseURL options:options];
+}
+
+- (void)testBatchedEnumeration_nonPersistent
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	
+	YapDatabaseViewOptions *options = [[YapDatabaseViewOptions alloc] init];
+	options.isPersistent = NO;
+	
+	[self _testBatchedEnumeration_withURL:databaseURL options:options];
+}
+
+- (void)_testBatchedEnumeration_withURL:(NSURL *)databaseURL options:(YapDatabaseViewOptions *)options
+{
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseViewGrouping *grouping = [YapDatabaseViewGrouping withKeyBlock:
+	    ^NSString *(YapDatabaseReadTransaction *transaction, NSString *collection, NSString *key)
+	{
+		return @"";
+	}];
+	
+	YapDatabaseViewSorting *sorting = [YapDatabaseViewSorting withObjectBlock:
+		^(YapDatabaseReadTransaction *transaction, NSString *group,
+		    NSString *collection1, NSString *key1, id obj1,
+		    NSString *collection2, NSString *key2, id obj2)
+	{
+		__unsafe_unretained NSNumber *number1 = (NSNumber *)obj1;
+		__unsafe_unretained NSNumber *number2 = (NSNumber *)obj2;
+		
+		return [number1 compare:number2];
+	}];
+	
+	YapDatabaseAutoView *databaseView =
+	  [[YapDatabaseAutoView alloc] initWithGrouping:grouping
+	                                        sorting:sorting
+	                                     versionTag:@"1"
+	                                        options:options];
+	
+	BOOL registerResult = [database registerExtension:databaseView withName:@"order"];
+	XCTAssertTrue(registerResult, @"Failure registering extension");
+	
+	// Add enough items to span multiple pages, spread across multiple collections.
+	// Only every other item gets metadata.
+	
+	YapDatabaseConnection *connection1 = [database newConnection];
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (int i = 0; i < 500; i++)
+		{
+			NSString *collection = [NSString stringWithFormat:@"collection%d", (i % 3)];
+			NSString *key = [NSString stringWithFormat:@"key%d", i];
+			
+			id metadata = (i % 2 == 0) ? [NSString stringWithFormat:@"metadata%d", i] : nil;
+			
+			[transaction setObject:@(i) forKey:key inCollection:collection withMetadata:metadata];
+		}
+	}];
+	
+	// Use a connection with a small cache, so most items have to come from the database,
+	// and some of them are already cached.
+	
+	YapDatabaseConnection *connection2 = [database newConnection];
+	connection2.objectCacheLimit = 20;
+	connection2.metadataCacheLimit = 20;
+	
+	[connection2 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (int i = 0; i < 500; i += 37)
+		{
+			NSString *collection = [NSString stringWithFormat:@"collection%d", (i % 3)];
+			NSString *key = [NSString stringWithFormat:@"key%d", i];
+			
+			[transaction objectForKey:key inCollection:collection];
+		}
+	}];
+	
+	[connection2 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		__block int expected = 0;
+		
+		[[transaction ext:@"order"] enumerateKeysAndObjectsInGroup:@""
+		                                                usingBlock:
+		    ^(NSString *collection, NSString *key, id object, NSUInteger index, BOOL *stop)
+		{
+			XCTAssert(index == (NSUInteger)expected, @"Oops");
+			XCTAssert([object intValue] == expected, @"Oops");
+			XCTAssert([key isEqualToString:[NSString stringWithFormat:@"key%d", expected]], @"Oops");
+			XCTAssert([collection isEqualToString:[NSString stringWithFormat:@"collection%d", (expected % 3)]], @"Oops");
+			
+			expected++;
+		}];
+		
+		XCTAssert(expected == 500, @"Oops");
+		
+		// Reverse
+		
+		expected = 499;
+		
+		[[transaction ext:@"order"] enumerateRowsInGroup:@""
+		                                     withOptions:NSEnumerationReverse
+		                                      usingBlock:
+		    ^(NSString *collection, NSString *key, id object, id metadata, NSUInteger index, BOOL *stop)
+		{
+			XCTAssert(index == (NSUInteger)expected, @"Oops");
+			XCTAssert([object intValue] == expected, @"Oops");
+			
+			if (expected % 2 == 0)
+				XCTAssert([metadata isEqualToString:[NSString stringWithFormat:@"metadata%d", expected]], @"Oops");
+			else
+				XCTAssertNil(metadata, @"Oops");
+			
+			expected--;
+		}];
+		
+		XCTAssert(expected == -1, @"Oops");
+		
+		// Range (crossing page boundaries), with early stop
+		
+		expected = 90;
+		
+		[[transaction ext:@"order"] enumerateKeysAndMetadataInGroup:@""
+		                                                withOptions:0
+		                                                      range:NSMakeRange(90, 200)
+		                                                 usingBlock:
+		    ^(NSString *collection, NSString *key, id metadata, NSUInteger index, BOOL *stop)
+		{
+			XCTAssert(index == (NSUInteger)expected, @"Oops");
+			XCTAssert([key isEqualToString:[NSString stringWithFormat:@"key%d", expected]], @"Oops");
+			
+			if (expected % 2 == 0)
+				XCTAssert([metadata isEqualToString:[NSString stringWithFormat:@"metadata%d", expected]], @"Oops");
+			else
+				XCTAssertNil(metadata, @"Oops");
+			
+			if (expected == 250) *stop = YES;
+			expected++;
+		}];
+		
+		XCTAssert(expected == 251, @"Oops");
+		
+		// Reverse range
+		
+		expected = 289;
+		
+		[[transaction ext:@"order"] enumerateKeysAndObjectsInGroup:@""
+		                                               withOptions:NSEnumerationReverse
+		                                                     range:NSMakeRange(90, 200)
+		                                                usingBlock:
+		    ^(NSString *collection, NSString *key, id object, NSUInteger index, BOOL *stop)
+		{
+			XCTAssert(index == (NSUInteger)expected, @"Oops");
+			XCTAssert([object intValue] == expected, @"Oops");
+			
+			expected--;
+		}];
+		
+		XCTAssert(expected == 89, @"Oops");
+	}];
+	
+	// Updates made by the block (that don't move the item) must be visible later in the same enumeration
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		__block id updatedObject = nil;
+		
+		[[transaction ext:@"order"] enumerateKeysAndObjectsInGroup:@""
+		                                               withOptions:0
+		                                                     range:NSMakeRange(0, 3)
+		                                                usingBlock:
+		    ^(NSString *collection, NSString *key, id object, NSUInteger index, BOOL *stop)
+		{
+			if (index == 0)
+			{
+				[transaction setObject:@(1.5) forKey:@"key1" inCollection:@"collection1"];
+			}
+			else if (index == 1)
+			{
+				updatedObject = object;
+			}
+		}];
+		
+		XCTAssertEqualObjects(updatedObject, @(1.5), @"Oops");
+	}];
+
+	// Mutation during enumeration must still be detected
+	
+	[connection1 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		dispatch_block_t exceptionBlock = ^{
+			
+			[[transaction ext:@"order"] enumerateKeysAndObjectsInGroup:@""
+			                                                usingBlock:
+			    ^(NSString *collection, NSString *key, id object, NSUInteger index, BOOL *stop)
+			{
+				[transaction removeObjectForKey:key inCollection:collection];
+			}];
+		};
+		
+		XCTAssertThrows(exceptionBlock(), @"Should throw exception");
+	}];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)testLazyGroupLoading_persistent
+{
+	NSURL *databaseURL = [self databaseURL:NSStringFromSelector(_cmd)];
+	[[NSFileManager defaultManager] removeItemAtURL:databaseURL error:NULL];
+	
+	YapDatabaseViewGrouping *grouping = [YapDatabaseViewGrouping withObjectBlock:
+	    ^NSString *(YapDatabaseReadTransaction *transaction, NSString *collection, NSString *key, id obj)
+	{
+		__unsafe_unretained NSNumber *number = (NSNumber *)obj;
+		
+		return [NSString stringWithFormat:@"group-%d", ([number intValue] % 20)];
+	}];
+	
+	YapDatabaseViewSorting *sorting = [YapDatabaseViewSorting withObjectBlock:
+		^(YapDatabaseReadTransaction *transaction, NSString *group,
+		    NSString *collection1, NSString *key1, id obj1,
+		    NSString *collection2, NSString *key2, id obj2)
+	{
+		__unsafe_unretained NSNumber *number1 = (NSNumber *)obj1;
+		__unsafe_unretained NSNumber *number2 = (NSNumber *)obj2;
+		
+		return [number1 compare:number2];
+	}];
+	
+	YapDatabaseViewOptions *options = [[YapDatabaseViewOptions alloc] init];
+	options.isPersistent = YES;
+	
+	// Populate the view (with enough items to require multiple pages per group)
+	
+	@autoreleasepool {
+		
+		YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+		XCTAssertNotNil(database, @"Oops");
+		
+		YapDatabaseAutoView *databaseView =
+		  [[YapDatabaseAutoView alloc] initWithGrouping:grouping
+		                                        sorting:sorting
+		                                     versionTag:@"1"
+		                                        options:options];
+		
+		BOOL registerResult = [database registerExtension:databaseView withName:@"order"];
+		XCTAssertTrue(registerResult, @"Failure registering extension");
+		
+		YapDatabaseConnection *connection = [database newConnection];
+		
+		[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			for (int i = 0; i < 2000; i++)
+			{
+				[transaction setObject:@(i) forKey:[NSString stringWithFormat:@"key%d", i] inCollection:nil];
+			}
+		}];
+	}
+	
+	// Re-open the database.
+	// The view should now load the page metadata for each group lazily.
+	
+	YapDatabase *database = [[YapDatabase alloc] initWithURL:databaseURL];
+	XCTAssertNotNil(database, @"Oops");
+	
+	YapDatabaseAutoView *databaseView =
+	  [[YapDatabaseAutoView alloc] initWithGrouping:grouping
+	                                        sorting:sorting
+	                                     versionTag:@"1"
+	                                        options:options];
+	
+	BOOL registerResult = [database registerExtension:databaseView withName:@"order"];
+	XCTAssertTrue(registerResult, @"Failure registering extension");
+	
+	YapDatabaseConnection *connection1 = [database newConnection];
+	YapDatabaseConnection *connection2 = [database newConnection];
+	
+	[connection1 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		// Counts are available without loading any groups
+		
+		XCTAssert([[transaction ext:@"order"] numberOfGroups] == 20, @"Oops");
+		XCTAssert([[transaction ext:@"order"] numberOfItemsInAllGroups] == 2000, @"Oops");
+		XCTAssert([[transaction ext:@"order"] numberOfItemsInGroup:@"group-7"] == 100, @"Oops");
+		
+		// Locating a key loads its group
+		
+		NSString *group = nil;
+		NSUInteger index = 0;
+		[[transaction ext:@"order"] getGroup:&group index:&index forKey:@"key1234" inCollection:nil];
+		
+		XCTAssert([group isEqualToString:@"group-14"], @"Oops");
+		XCTAssert(index == 61, @"Oops");
+		
+		// As does fetching by index
+		
+		NSString *key = [[transaction ext:@"order"] keyAtIndex:99 inGroup:@"group-3"];
+		XCTAssert([key isEqualToString:@"key1983"], @"Oops");
+	}];
+	
+	// Modify a group that hasn't been loaded by the readWrite connection yet
+	
+	[connection2 readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction setObject:@(2005) forKey:@"key2005" inCollection:nil];
+		[transaction removeObjectForKey:@"key5" inCollection:nil];
+		
+		XCTAssert([[transaction ext:@"order"] numberOfItemsInGroup:@"group-5"] == 100, @"Oops");
+		XCTAssert([[[transaction ext:@"order"] keyAtIndex:0 inGroup:@"group-5"] isEqualToString:@"key25"], @"Oops");
+		XCTAssert([[[transaction ext:@"order"] keyAtIndex:99 inGroup:@"group-5"] isEqualToString:@"key2005"], @"Oops");
+		
+		// Allocating a new group must not reuse any existing pageIds
+		
+		[transaction setObject:@(2020) forKey:@"key2020" inCollection:nil];
+		[transaction setObject:@(-1) forKey:@"key-1" inCollection:nil];
+	}];
+	
+	[connection1 readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		XCTAssert([[transaction ext:@"order"] numberOfGroups] == 21, @"Oops");
+		XCTAssert([[transaction ext:@"order"] numberOfItemsInAllGroups] == 2002, @"Oops");
+		
+		XCTAssert([[[transaction ext:@"order"] keyAtIndex:99 inGroup:@"group-5"] isEqualToString:@"key2005"], @"Oops");
+		XCTAssert([[[transaction ext:@"order"] keyAtIndex:100 inGroup:@"group-0"] isEqualToString:@"key2020"], @"Oops");
+		XCTAssert([[[transaction ext:@"order"] keyAtIndex:0 inGroup:@"group--1"] isEqualToString:@"key-1"], @"Oops");
+	}];
+}
+
 @end
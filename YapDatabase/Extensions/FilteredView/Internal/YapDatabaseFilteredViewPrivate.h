@@ -49,6 +49,8 @@ static NSString *const changeset_key_filtering = @"filtering";
 	NSString *parentViewName;
 }
 
+- (NSUInteger)filteringConcurrency;
+
 @end
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -60,10 +62,14 @@ static NSString *const changeset_key_filtering = @"filtering";
 	
 	YapDatabaseViewFiltering *filtering;
 	BOOL filteringChanged;
+	
+	NSMutableArray<YapDatabaseConnection *> *filteringConnections;
 }
 
 - (void)getFiltering:(YapDatabaseViewFiltering **)filteringPtr;
 
+- (NSArray<YapDatabaseConnection *> *)filteringConnectionsWithCount:(NSUInteger)count;
+
 - (void)setFiltering:(YapDatabaseViewFiltering *)newFiltering
           versionTag:(NSString *)newVersionTag;
 
@@ -39,6 +39,8 @@ NS_ASSUME_NONNULL_BEGIN
  *
  * @param options
  *   The options allow you to specify things like creating an IN-MEMORY-ONLY VIEW (non persistent).
+ *   You may also pass a YapDatabaseFilteredViewOptions instance,
+ *   which allows you to evaluate the filter concurrently when the filtering is changed.
  */
 - (id)initWithParentViewName:(NSString *)viewName
                    filtering:(YapDatabaseViewFiltering *)filtering
@@ -92,6 +92,20 @@
 	return mostRecentFiltering;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Options
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns the maximum number of threads to use when re-filtering the view (1 == serial).
+**/
+- (NSUInteger)filteringConcurrency
+{
+	if (![options isKindOfClass:[YapDatabaseFilteredViewOptions class]]) return 1;
+	
+	return MAX(((YapDatabaseFilteredViewOptions *)options).filteringConcurrency, (NSUInteger)1);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Registration
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
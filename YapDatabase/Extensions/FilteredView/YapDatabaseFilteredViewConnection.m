@@ -42,6 +42,43 @@
 	return (YapDatabaseFilteredView *)parent;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Memory
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)_flushMemoryWithFlags:(YapDatabaseConnectionFlushMemoryFlags)flags
+{
+	if (flags & YapDatabaseConnectionFlushMemoryFlags_Caches)
+	{
+		filteringConnections = nil;
+	}
+	
+	[super _flushMemoryWithFlags:flags];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Concurrent Filtering
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns the read-only connections used to evaluate the filter concurrently (see filteringConcurrency).
+ *
+ * The connections are created lazily, and reused for every re-filter performed by this connection.
+ * This method is only invoked from within a readWriteTransaction, so it's always on the connectionQueue.
+**/
+- (NSArray<YapDatabaseConnection *> *)filteringConnectionsWithCount:(NSUInteger)count
+{
+	if (filteringConnections == nil)
+		filteringConnections = [[NSMutableArray alloc] initWithCapacity:count];
+	
+	while ([filteringConnections count] < count)
+	{
+		[filteringConnections addObject:[databaseConnection->database newConnection]];
+	}
+	
+	return [filteringConnections subarrayWithRange:NSMakeRange(0, count)];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Transactions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -22,6 +22,76 @@
 #pragma unused(ydbLogLevel)
 
 
+typedef BOOL (^YDBInvokeFilterBlock)(NSString *group, int64_t rowid, YapCollectionKey *ck);
+
+/**
+ * Returns a block that properly invokes the filterBlock, using the given transaction.
+**/
+static YDBInvokeFilterBlock YDBFilterBlockInvoker(YapDatabaseViewFiltering *filtering,
+                                                  YapDatabaseReadTransaction *transaction)
+{
+	__unsafe_unretained YapDatabaseReadTransaction *databaseTransaction = transaction;
+	
+	if (filtering->blockType == YapDatabaseBlockTypeWithKey)
+	{
+		__unsafe_unretained YapDatabaseViewFilteringWithKeyBlock filterBlock =
+		  (YapDatabaseViewFilteringWithKeyBlock)filtering->block;
+		
+		return ^(NSString *group, int64_t __unused rowid, YapCollectionKey *ck){
+			
+			return filterBlock(databaseTransaction, group, ck.collection, ck.key);
+		};
+	}
+	else if (filtering->blockType == YapDatabaseBlockTypeWithObject)
+	{
+		__unsafe_unretained YapDatabaseViewFilteringWithObjectBlock filterBlock =
+		  (YapDatabaseViewFilteringWithObjectBlock)filtering->block;
+		
+		return ^(NSString *group, int64_t rowid, YapCollectionKey *ck){
+			
+			id object = [databaseTransaction objectForCollectionKey:ck withRowid:rowid];
+			
+			return filterBlock(databaseTransaction, group, ck.collection, ck.key, object);
+		};
+	}
+	else if (filtering->blockType == YapDatabaseBlockTypeWithMetadata)
+	{
+		__unsafe_unretained YapDatabaseViewFilteringWithMetadataBlock filterBlock =
+		  (YapDatabaseViewFilteringWithMetadataBlock)filtering->block;
+		
+		return ^(NSString *group, int64_t rowid, YapCollectionKey *ck){
+			
+			id metadata = [databaseTransaction metadataForCollectionKey:ck withRowid:rowid];
+			
+			return filterBlock(databaseTransaction, group, ck.collection, ck.key, metadata);
+		};
+	}
+	else // if (filtering->blockType == YapDatabaseBlockTypeWithRow)
+	{
+		__unsafe_unretained YapDatabaseViewFilteringWithRowBlock filterBlock =
+		  (YapDatabaseViewFilteringWithRowBlock)filtering->block;
+		
+		return ^(NSString *group, int64_t rowid, YapCollectionKey *ck){
+			
+			id object = nil;
+			id metadata = nil;
+			[databaseTransaction getObject:&object metadata:&metadata forCollectionKey:ck withRowid:rowid];
+			
+			return filterBlock(databaseTransaction, group, ck.collection, ck.key, object, metadata);
+		};
+	}
+}
+
+/**
+ * Possible values in the buffer returned by concurrentFilterResultsForGroups:::.
+**/
+enum {
+	YDBFilterResultUnknown  = 0, // Not evaluated, use the serial path
+	YDBFilterResultExcluded = 1,
+	YDBFilterResultIncluded = 2,
+};
+
+
 @implementation YapDatabaseFilteredViewTransaction
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -409,6 +479,144 @@
 	}
 }
 
+/**
+ * Evaluates the filter for every row in the given groups of the parentView,
+ * spreading the work over multiple threads, each using its own read-only connection.
+ *
+ * Returns a buffer with one YDBFilterResult per row (in the enumeration order of the given groups),
+ * or NULL if the rows couldn't be evaluated concurrently. The caller is responsible for freeing the buffer.
+**/
+- (uint8_t *)concurrentFilterResultsForGroups:(NSArray<NSString *> *)groups
+                            inParentTransaction:(YapDatabaseViewTransaction *)parentViewTransaction
+                                      filtering:(YapDatabaseViewFiltering *)filtering
+                                    concurrency:(NSUInteger)concurrency
+{
+	YDBLogAutoTrace();
+	
+	__unsafe_unretained YapDatabaseConnection *databaseConnection = databaseTransaction->connection;
+	
+	// The read-only connections see the most recent commit.
+	// So if this transaction has already modified any rows, we can't use them.
+	
+	if ([databaseConnection->objectChanges count]      > 0 ||
+	    [databaseConnection->metadataChanges count]    > 0 ||
+	    [databaseConnection->insertedKeys count]       > 0 ||
+	    [databaseConnection->removedKeys count]        > 0 ||
+	    [databaseConnection->removedCollections count] > 0 ||
+	    [databaseConnection->removedRowids count]      > 0 || databaseConnection->allKeysRemoved)
+	{
+		YDBLogVerbose(@"(%@): Transaction has pending changes, re-filtering serially", [self registeredName]);
+		return NULL;
+	}
+	
+	// Step 1 of 2:
+	//
+	// Collect the rowids (in order) from the parentView.
+	// This is cheap compared to fetching the objects, and must happen within this transaction.
+	
+	NSUInteger groupCount = [groups count];
+	NSUInteger *groupOffsets = (NSUInteger *)malloc(sizeof(NSUInteger) * (groupCount + 1));
+	
+	NSUInteger totalCount = 0;
+	for (NSUInteger g = 0; g < groupCount; g++)
+	{
+		groupOffsets[g] = totalCount;
+		totalCount += [parentViewTransaction numberOfItemsInGroup:groups[g]];
+	}
+	groupOffsets[groupCount] = totalCount;
+	
+	if (totalCount == 0)
+	{
+		free(groupOffsets);
+		return NULL;
+	}
+	
+	int64_t *rowids = (int64_t *)malloc(sizeof(int64_t) * totalCount);
+	
+	for (NSUInteger g = 0; g < groupCount; g++)
+	{
+		__block NSUInteger offset = groupOffsets[g];
+		NSUInteger groupEnd = groupOffsets[g + 1];
+		
+		[parentViewTransaction enumerateRowidsInGroup:groups[g]
+		                                   usingBlock:^(int64_t rowid, NSUInteger __unused index, BOOL *stop)
+		{
+			if (offset < groupEnd)
+				rowids[offset++] = rowid;
+			else
+				*stop = YES;
+		}];
+		
+		if (offset != groupEnd)
+		{
+			YDBLogWarn(@"(%@): Unexpected count for group(%@), re-filtering serially", [self registeredName], groups[g]);
+			
+			free(groupOffsets);
+			free(rowids);
+			return NULL;
+		}
+	}
+	
+	// Step 2 of 2:
+	//
+	// Evaluate the filter concurrently.
+	//
+	// The rows are split into chunks (a few parentView pages each),
+	// and worker N processes chunks N, N+workerCount, N+(2*workerCount), ...
+	
+	NSUInteger const chunkSize = 512;
+	NSUInteger chunkCount = (totalCount + chunkSize - 1) / chunkSize;
+	NSUInteger workerCount = MIN(concurrency, chunkCount);
+	
+	uint8_t *results = (uint8_t *)calloc(totalCount, sizeof(uint8_t)); // YDBFilterResultUnknown == 0
+	
+	NSArray<YapDatabaseConnection *> *workerConnections =
+	  [(YapDatabaseFilteredViewConnection *)parentConnection filteringConnectionsWithCount:workerCount];
+	
+	dispatch_queue_t globalQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+	
+	dispatch_apply(workerCount, globalQueue, ^(size_t w) {
+		
+		YapDatabaseConnection *workerConnection = workerConnections[w];
+		
+		[workerConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			YDBInvokeFilterBlock InvokeFilterBlock = YDBFilterBlockInvoker(filtering, transaction);
+			
+			for (NSUInteger chunk = w; chunk < chunkCount; chunk += workerCount) { @autoreleasepool {
+				
+				NSUInteger start = chunk * chunkSize;
+				NSUInteger end = MIN(start + chunkSize, totalCount);
+				
+				// Find the group that contains the first row of the chunk
+				
+				NSUInteger g = 0;
+				while (groupOffsets[g + 1] <= start) g++;
+				
+				for (NSUInteger i = start; i < end; i++)
+				{
+					while (groupOffsets[g + 1] <= i) g++;
+					
+					int64_t rowid = rowids[i];
+					YapCollectionKey *ck = [transaction collectionKeyForRowid:rowid];
+					
+					if (ck == nil) continue; // YDBFilterResultUnknown
+					
+					if (InvokeFilterBlock(groups[g], rowid, ck))
+						results[i] = YDBFilterResultIncluded;
+					else
+						results[i] = YDBFilterResultExcluded;
+				}
+			}}
+		}];
+	});
+	
+	free(groupOffsets);
+	free(rowids);
+	
+	return results;
+}
+
 /**
  * This method is invoked if:
  *
@@ -438,60 +646,28 @@
 	
 	[filteredViewConnection getFiltering:&filtering];
 	
-	BOOL (^InvokeFilterBlock)(NSString *group, int64_t rowid, YapCollectionKey *ck);
+	YDBInvokeFilterBlock InvokeFilterBlock = YDBFilterBlockInvoker(filtering, databaseTransaction);
 	
-	if (filtering->blockType == YapDatabaseBlockTypeWithKey)
-	{
-		__unsafe_unretained YapDatabaseViewFilteringWithKeyBlock filterBlock =
-		  (YapDatabaseViewFilteringWithKeyBlock)filtering->block;
-		
-		InvokeFilterBlock = ^(NSString *group, int64_t __unused rowid, YapCollectionKey *ck){
-			
-			return filterBlock(self->databaseTransaction, group, ck.collection, ck.key);
-		};
-	}
-	else if (filtering->blockType == YapDatabaseBlockTypeWithObject)
-	{
-		__unsafe_unretained YapDatabaseViewFilteringWithObjectBlock filterBlock =
-		  (YapDatabaseViewFilteringWithObjectBlock)filtering->block;
-		
-		InvokeFilterBlock = ^(NSString *group, int64_t rowid, YapCollectionKey *ck){
-			
-			id object = [self->databaseTransaction objectForCollectionKey:ck withRowid:rowid];
-			
-			return filterBlock(self->databaseTransaction, group, ck.collection, ck.key, object);
-		};
-	}
-	else if (filtering->blockType == YapDatabaseBlockTypeWithMetadata)
-	{
-		__unsafe_unretained YapDatabaseViewFilteringWithMetadataBlock filterBlock =
-		  (YapDatabaseViewFilteringWithMetadataBlock)filtering->block;
-		
-		InvokeFilterBlock = ^(NSString *group, int64_t rowid, YapCollectionKey *ck){
-			
-			id metadata = [self->databaseTransaction metadataForCollectionKey:ck withRowid:rowid];
-			
-			return filterBlock(self->databaseTransaction, group, ck.collection, ck.key, metadata);
-		};
-	}
-	else // if (filteringBlockType == YapDatabaseBlockTypeWithRow)
+	NSArray<NSString *> *groups = [[parentViewTransaction allGroups] copy];
+	
+	// If configured, evaluate the filter for all the rows concurrently (up front).
+	// The changes to the view are still applied below, serially.
+	
+	uint8_t *results = NULL;
+	__block NSUInteger resultIndex = 0;
+	
+	NSUInteger concurrency = [filteredView filteringConcurrency];
+	if (concurrency > 1)
 	{
-		__unsafe_unretained YapDatabaseViewFilteringWithRowBlock filterBlock =
-		  (YapDatabaseViewFilteringWithRowBlock)filtering->block;
-		
-		InvokeFilterBlock = ^(NSString *group, int64_t rowid, YapCollectionKey *ck){
-			
-			id object = nil;
-			id metadata = nil;
-			[self->databaseTransaction getObject:&object metadata:&metadata forCollectionKey:ck withRowid:rowid];
-			
-			return filterBlock(self->databaseTransaction, group, ck.collection, ck.key, object, metadata);
-		};
+		results = [self concurrentFilterResultsForGroups:groups
+		                             inParentTransaction:parentViewTransaction
+		                                       filtering:filtering
+		                                     concurrency:concurrency];
 	}
 	
 	// Start the algorithm.
 	
-	for (NSString *group in [parentViewTransaction allGroups])
+	for (NSString *group in groups)
 	{
 		__block BOOL existing = NO;
 		__block int64_t existingRowid = 0;
@@ -505,7 +681,15 @@
 		{
 			YapCollectionKey *ck = [self->databaseTransaction collectionKeyForRowid:rowid];
 			
-			if (InvokeFilterBlock(group, rowid, ck))
+			BOOL passesFilter;
+			
+			uint8_t result = results ? results[resultIndex++] : YDBFilterResultUnknown;
+			if (result == YDBFilterResultUnknown)
+				passesFilter = InvokeFilterBlock(group, rowid, ck);
+			else
+				passesFilter = (result == YDBFilterResultIncluded);
+			
+			if (passesFilter)
 			{
 				if (existing && (existingRowid == rowid))
 				{
@@ -545,6 +729,10 @@
 			}
 		}];
 	}
+	
+	if (results) {
+		free(results);
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
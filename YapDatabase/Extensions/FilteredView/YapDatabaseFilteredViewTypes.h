@@ -2,6 +2,7 @@
 
 #import "YapDatabaseTransaction.h"
 #import "YapDatabaseExtensionTypes.h"
+#import "YapDatabaseViewOptions.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -59,4 +60,36 @@ typedef BOOL (^YapDatabaseViewFilteringWithRowBlock)
 
 @end
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Options for YapDatabaseFilteredView.
+ *
+ * All the YapDatabaseViewOptions are supported.
+ */
+@interface YapDatabaseFilteredViewOptions : YapDatabaseViewOptions
+
+/**
+ * When the filtering is changed (setFiltering:versionTag:), every row in the parentView needs to be re-filtered.
+ * For a large parentView, most of this time is spent fetching/deserializing objects & invoking the filter block.
+ *
+ * If this value is greater than 1, the filter block is evaluated concurrently, using up to this many threads.
+ * Each thread uses its own read-only connection, and passes the corresponding read-only transaction to the block.
+ * The resulting changes to the view are still applied serially, within the readWriteTransaction.
+ *
+ * IMPORTANT:
+ * Only enable this if your filter blocks are thread-safe, and only depend on the given
+ * (collection, key, object, metadata) parameters.
+ *
+ * If the readWriteTransaction has already modified rows before changing the filtering,
+ * the read-only connections wouldn't see those changes. So in that case the filter is evaluated serially.
+ *
+ * The default value is 1 (serial).
+ */
+@property (nonatomic, assign, readwrite) NSUInteger filteringConcurrency;
+
+@end
+
 NS_ASSUME_NONNULL_END
@@ -81,3 +81,30 @@
 }
 
 @end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation YapDatabaseFilteredViewOptions
+
+@synthesize filteringConcurrency = filteringConcurrency;
+
+- (id)init
+{
+	if ((self = [super init]))
+	{
+		filteringConcurrency = 1;
+	}
+	return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	YapDatabaseFilteredViewOptions *copy = [super copyWithZone:zone];
+	copy->filteringConcurrency = filteringConcurrency;
+	
+	return copy;
+}
+
+@end
@@ -22,6 +22,35 @@
  */
 #define YAP_DATABASE_FTS_CLASS_VERSION 1
 
+/**
+ * The fts5 extension API, used to register custom tokenizers.
+ *
+ * These definitions are part of sqlite's stable fts5 interface (see fts5.h in the sqlite sources).
+ * They're included in the amalgamation's sqlite3.h, but not in every version of the header,
+ * so we declare the (minimal) parts we need here.
+ */
+#ifndef _FTS5_H
+
+typedef struct Fts5Tokenizer Fts5Tokenizer;
+typedef struct fts5_tokenizer fts5_tokenizer;
+typedef struct fts5_api fts5_api;
+
+struct fts5_tokenizer {
+	int (*xCreate)(void *pUserData, const char **azArg, int nArg, Fts5Tokenizer **ppOut);
+	void (*xDelete)(Fts5Tokenizer *pTokenizer);
+	int (*xTokenize)(Fts5Tokenizer *pTokenizer, void *pCtx, int flags, const char *pText, int nText,
+	                 int (*xToken)(void *pCtx, int tflags, const char *pToken, int nToken, int iStart, int iEnd));
+};
+
+struct fts5_api {
+	int iVersion;
+	int (*xCreateTokenizer)(fts5_api *pApi, const char *zName, void *pUserData,
+	                        fts5_tokenizer *pTokenizer, void (*xDestroy)(void *pUserData));
+	// Remaining members omitted (we never allocate this struct, sqlite provides it)
+};
+
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark -
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -49,11 +78,18 @@
 	NSDictionary *options;
 	NSString *ftsVersion;
 	NSString *versionTag;
+	BOOL contentless;
+	
+	NSMutableDictionary<NSString *, YapDatabaseFullTextSearchTokenizerBlock> *tokenizers;
 	
 	id columnNamesSharedKeySet;
 }
 
 - (NSString *)tableName;
+- (NSString *)snippetTableName;
+
+- (BOOL)isFTS5;
+- (BOOL)isContentless;
 
 @end
 
@@ -81,13 +117,21 @@
 - (sqlite3_stmt *)setRowidStatement;
 - (sqlite3_stmt *)removeRowidStatement;
 - (sqlite3_stmt *)removeAllStatement;
+- (sqlite3_stmt *)unchangedRowidStatement;
 - (sqlite3_stmt *)queryStatement;
 - (sqlite3_stmt *)bm25QueryStatement;
 - (sqlite3_stmt *)bm25QueryStatementWithWeights:(NSArray<NSNumber *> *)weights;
+- (sqlite3_stmt *)bm25LimitQueryStatement;
 - (sqlite3_stmt *)querySnippetStatement;
 - (sqlite3_stmt *)rowidQueryStatement;
 - (sqlite3_stmt *)rowidQuerySnippetStatement;
 
+- (NSString *)snippetFunctionForTable:(NSString *)tableName isFTS5:(BOOL)isFTS5;
+
+- (BOOL)prepareSnippetTable;
+- (sqlite3_stmt *)snippetTableInsertStatement;
+- (sqlite3_stmt *)snippetTableClearStatement;
+
 @end
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -116,4 +160,9 @@
 - (NSString *)rowid:(int64_t)rowid matches:(NSString *)query
                         withSnippetOptions:(YapDatabaseFullTextSearchSnippetOptions *)options;
 
+- (void)enumerateSnippetsForRowids:(NSArray<NSNumber *> *)rowids
+                          matching:(NSString *)query
+                withSnippetOptions:(YapDatabaseFullTextSearchSnippetOptions *)options
+                        usingBlock:(void (NS_NOESCAPE^)(NSString *snippet, int64_t rowid, BOOL *stop))block;
+
 @end
@@ -24,6 +24,35 @@ extern NSString *const YapDatabaseFullTextSearchFTS5Version;
 extern NSString *const YapDatabaseFullTextSearchFTS4Version;
 extern NSString *const YapDatabaseFullTextSearchFTS3Version;
 
+/**
+ * The name of sqlite's built-in trigram tokenizer (fts5 only, sqlite 3.34.0+).
+ *
+ * The trigram tokenizer indexes every sequence of 3 characters, which allows for fast substring matching
+ * (e.g. over identifiers & product codes). Use it via the options dictionary:
+ *
+ * options = @{ @"tokenize": YapDatabaseFullTextSearchTrigramTokenizer };
+ *
+ * LIKE & GLOB patterns (see -[YapDatabaseFullTextSearchTransaction enumerateKeysInColumn:like:usingBlock:])
+ * are then answered using the index, instead of scanning every row.
+ *
+ * Note: by default the trigram tokenizer is case-insensitive, which is what LIKE requires.
+ * For GLOB (which is case-sensitive) to use the index, pass "trigram case_sensitive 1" instead.
+ */
+extern NSString *const YapDatabaseFullTextSearchTrigramTokenizer;
+
+/**
+ * A custom tokenizer (fts5 only).
+ *
+ * The block is given the text to tokenize (which may be either a document or a query),
+ * and must invoke the emitToken block for each token, in order.
+ * The range is the location of the token within the original text (used for snippets).
+ *
+ * The block is invoked on whatever thread is executing the transaction,
+ * so it must be thread-safe (ideally it's a pure function of the text).
+ */
+typedef void (^YapDatabaseFullTextSearchTokenizerBlock)
+  (NSString *text, void (NS_NOESCAPE^emitToken)(NSString *token, NSRange range));
+
 
 @interface YapDatabaseFullTextSearch : YapDatabaseExtension
 
@@ -45,6 +74,18 @@ extern NSString *const YapDatabaseFullTextSearchFTS3Version;
                ftsVersion:(nullable NSString *)ftsVersion
                versionTag:(nullable NSString *)versionTag;
 
+/**
+ * Creates a contentless FTS index. (See the contentless property for a discussion of the trade-offs.)
+ *
+ * Contentless mode requires ftsVersion == YapDatabaseFullTextSearchFTS5Version.
+ */
+- (id)initWithColumnNames:(NSArray<NSString *> *)columnNames
+                  options:(nullable NSDictionary *)options
+                  handler:(YapDatabaseFullTextSearchHandler *)handler
+               ftsVersion:(nullable NSString *)ftsVersion
+              contentless:(BOOL)contentless
+               versionTag:(nullable NSString *)versionTag;
+
 
 /* Inherited from YapDatabaseExtension
  
@@ -64,6 +105,68 @@ extern NSString *const YapDatabaseFullTextSearchFTS3Version;
 @property (nonatomic, copy, readonly, nullable) NSString *versionTag;
 @property (nonatomic, copy, readonly, nullable) NSString *ftsVersion;
 
+/**
+ * A normal FTS table stores its own copy of every indexed column (in addition to the index itself).
+ * Since the text is already stored in the database (within your objects), this roughly doubles
+ * the disk space & write volume for large text collections.
+ *
+ * A contentless FTS table stores only the index.
+ * Matching & ranking (e.g. bm25) work exactly the same.
+ * But snippets can no longer be extracted from the table.
+ * Instead, when snippets are requested, the text for each matching row is rebuilt by invoking the handler block
+ * (for the row's current object/metadata), and the snippet is generated from that.
+ *
+ * The trade-offs:
+ * - Inserts/updates write less data, and the database file is considerably smaller.
+ * - Snippets are more expensive, as they require deserializing the row & invoking the handler.
+ *   So only request snippets for the rows you're going to display.
+ * - The handler block must be deterministic (given the same row, produce the same text),
+ *   otherwise snippets may not line up with the indexed text.
+ *
+ * Contentless mode requires FTS5, and sqlite 3.43.0 or later (for the contentless_delete option,
+ * which allows rows to be updated & deleted). If the available sqlite version is older,
+ * the extension logs a warning and falls back to a normal FTS table.
+ *
+ * Changing this value (for an existing extension) causes the index to be rebuilt.
+ *
+ * The default value is NO.
+ */
+@property (nonatomic, assign, readonly) BOOL contentless;
+
+/**
+ * Registers a custom tokenizer with the given name. (fts5 only)
+ *
+ * The tokenizer is registered with every sqlite connection that uses this extension,
+ * and can then be used via the options dictionary:
+ *
+ * options = @{ @"tokenize": @"myTokenizerName" };
+ *
+ * Tokenizers must be registered before the extension itself is registered.
+ * And they must remain registered (with the same name) for as long as the extension exists in the database,
+ * as sqlite requires the tokenizer in order to read, write, or drop the FTS table.
+ *
+ * If you change the tokenizer (in a way that changes the generated tokens), then change the versionTag too,
+ * so the index gets rebuilt.
+ *
+ * @return
+ *   YES if the tokenizer was registered.
+ *   NO if the extension isn't fts5, or the extension has already been registered.
+ */
+- (BOOL)registerTokenizer:(YapDatabaseFullTextSearchTokenizerBlock)tokenizer withName:(NSString *)name;
+
+/**
+ * Returns a tokenizer that indexes every sequence of `length` characters (lowercased).
+ *
+ * This is similar to the built-in trigram tokenizer, but supports any length. (E.g. bigrams, which allow
+ * substring matching of 2 character strings via a phrase query such as @"\"ab\"",
+ * and are often used for languages without spaces between words.)
+ * It also works with versions of sqlite that don't have the trigram tokenizer.
+ *
+ * Characters are composed character sequences, so emoji & accented characters are never split.
+ * Text that's shorter than the given length produces no tokens.
+ */
++ (YapDatabaseFullTextSearchTokenizerBlock)ngramTokenizerWithLength:(NSUInteger)length;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -26,6 +26,8 @@ NSString *const YapDatabaseFullTextSearchFTS5Version = @"fts5";
 NSString *const YapDatabaseFullTextSearchFTS4Version = @"fts4";
 NSString *const YapDatabaseFullTextSearchFTS3Version = @"fts3";
 
+NSString *const YapDatabaseFullTextSearchTrigramTokenizer = @"trigram";
+
 
 @implementation YapDatabaseFullTextSearch
 
@@ -64,6 +66,7 @@ NSString *const YapDatabaseFullTextSearchFTS3Version = @"fts3";
 @synthesize handler = handler;
 @synthesize versionTag = versionTag;
 @synthesize ftsVersion = ftsVersion;
+@synthesize contentless = contentless;
 
 - (id)initWithColumnNames:(NSArray *)inColumnNames
                   handler:(YapDatabaseFullTextSearchHandler *)inHandler
@@ -97,6 +100,21 @@ NSString *const YapDatabaseFullTextSearchFTS3Version = @"fts3";
                   options:(NSDictionary *)inOptions
                   handler:(YapDatabaseFullTextSearchHandler *)inHandler
                ftsVersion:(NSString *)inFtsVersion
+               versionTag:(NSString *)inVersionTag
+{
+    return [self initWithColumnNames:inColumnNames
+                             options:inOptions
+                             handler:inHandler
+                          ftsVersion:inFtsVersion
+                         contentless:NO
+                          versionTag:inVersionTag];
+}
+
+- (id)initWithColumnNames:(NSArray *)inColumnNames
+                  options:(NSDictionary *)inOptions
+                  handler:(YapDatabaseFullTextSearchHandler *)inHandler
+               ftsVersion:(NSString *)inFtsVersion
+              contentless:(BOOL)inContentless
                versionTag:(NSString *)inVersionTag {
     if ([inColumnNames count] == 0)
     {
@@ -122,6 +140,9 @@ NSString *const YapDatabaseFullTextSearchFTS3Version = @"fts3";
     
     NSAssert(inHandler != NULL, @"Null handler");
     
+    NSAssert(!inContentless || [inFtsVersion isEqualToString:YapDatabaseFullTextSearchFTS5Version],
+             @"Contentless mode requires YapDatabaseFullTextSearchFTS5Version");
+    
     if ((self = [super init]))
     {
         columnNames = [NSOrderedSet orderedSetWithArray:inColumnNames];
@@ -133,10 +154,85 @@ NSString *const YapDatabaseFullTextSearchFTS3Version = @"fts3";
         
         versionTag = inVersionTag ? [inVersionTag copy] : @"";
         ftsVersion = inFtsVersion ? [inFtsVersion copy] : YapDatabaseFullTextSearchFTS4Version;
+        
+        contentless = inContentless;
     }
     return self;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Tokenizers
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for documentation.
+**/
+- (BOOL)registerTokenizer:(YapDatabaseFullTextSearchTokenizerBlock)tokenizer withName:(NSString *)name
+{
+	if (![self isFTS5])
+	{
+		YDBLogWarn(@"Custom tokenizers require fts5 (have %@)", ftsVersion);
+		return NO;
+	}
+	
+	if (self.registeredName)
+	{
+		YDBLogWarn(@"Tokenizers must be registered before the extension is registered");
+		return NO;
+	}
+	
+	if (tokenizers == nil)
+		tokenizers = [[NSMutableDictionary alloc] init];
+	
+	tokenizers[name] = [tokenizer copy];
+	return YES;
+}
+
+/**
+ * See header file for documentation.
+**/
++ (YapDatabaseFullTextSearchTokenizerBlock)ngramTokenizerWithLength:(NSUInteger)length
+{
+	NSAssert(length > 0, @"Invalid ngram length");
+	
+	return ^(NSString *text, void (NS_NOESCAPE^emitToken)(NSString *token, NSRange range)) {
+		
+		// Find the (composed) characters, so we never split a character in two.
+		
+		NSUInteger textLength = text.length;
+		NSUInteger *starts = malloc(sizeof(NSUInteger) * (textLength + 1));
+		__block NSUInteger count = 0;
+		
+		[text enumerateSubstringsInRange:NSMakeRange(0, textLength)
+		                         options:(NSStringEnumerationByComposedCharacterSequences |
+		                                  NSStringEnumerationSubstringNotRequired)
+		                      usingBlock:
+		    ^(NSString __unused *substring, NSRange substringRange, NSRange __unused enclosingRange, BOOL __unused *stop)
+		{
+			starts[count] = substringRange.location;
+			count++;
+		}];
+		
+		starts[count] = textLength;
+		
+		// Emit every window of `length` characters
+		
+		for (NSUInteger i = 0; (i + length) <= count; i++)
+		{
+			NSRange range = NSMakeRange(starts[i], starts[i + length] - starts[i]);
+			NSString *token = [[text substringWithRange:range] lowercaseString];
+			
+			emitToken(token, range);
+		}
+		
+		free(starts);
+	};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Internal
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 - (YapDatabaseExtensionConnection *)newConnection:(YapDatabaseConnection *)databaseConnection
 {
 	return [[YapDatabaseFullTextSearchConnection alloc] initWithParent:self databaseConnection:databaseConnection];
@@ -147,4 +243,28 @@ NSString *const YapDatabaseFullTextSearchFTS3Version = @"fts3";
 	return [[self class] tableNameForRegisteredName:self.registeredName];
 }
 
+/**
+ * The temporary (per-connection) table used to rebuild snippets when the index is contentless.
+**/
+- (NSString *)snippetTableName
+{
+	return [NSString stringWithFormat:@"yap_fts_snippet_%@", self.registeredName];
+}
+
+- (BOOL)isFTS5
+{
+	return [ftsVersion isEqualToString:YapDatabaseFullTextSearchFTS5Version];
+}
+
+/**
+ * Returns whether or not the FTS table is actually contentless.
+ *
+ * Contentless tables require the contentless_delete option (sqlite 3.43.0+),
+ * otherwise rows can't be updated or deleted. So we fall back to a normal table for older versions.
+**/
+- (BOOL)isContentless
+{
+	return contentless && [self isFTS5] && (sqlite3_libversion_number() >= 3043000);
+}
+
 @end
@@ -2,6 +2,7 @@
 #import "YapDatabaseExtensionConnection.h"
 
 @class YapDatabaseFullTextSearch;
+@class YapDatabaseFullTextSearchMaintenanceReport;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -31,6 +32,82 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, strong, readonly) YapDatabaseFullTextSearch *fullTextSearch;
 
+/**
+ * Incrementally merges the segments of the FTS index in the background.
+ *
+ * Heavy update traffic fragments the index into many small segments, which slowly increases the cost of queries.
+ * This method performs the equivalent of 'optimize', but in a series of small read-write transactions
+ * (each performing a single mergeWithPageCount: step), on a low priority background queue.
+ * Thus other read-write transactions only ever have to wait for a single (short) merge step.
+ *
+ * This is intended to be invoked at idle times. (E.g. after a large import, or when the app enters the background.)
+ *
+ * Under steady write traffic, new segments may keep appearing while the merge is in progress.
+ * So the merge stops after a bounded number of steps, even if there's still work to do.
+ * In that case the report's `completed` property is NO, and you may simply invoke this method again later.
+ *
+ * @param pageCount
+ *   The (approximate) number of pages written by each merge step.
+ *   Smaller values mean shorter transactions, but more of them.
+ *   If zero, a default value of 64 is used.
+ *
+ * @param probeQuery
+ *   An optional query that will be timed before & after the merge (and reported in the completionBlock).
+ *
+ * @param completionQueue
+ *   The dispatch queue to invoke the completionBlock on.
+ *   If NULL, the main thread is automatically used.
+ *
+ * @param completionBlock
+ *   An optional block to invoke once the merge has completed.
+ */
+- (void)asyncMergeWithPageCount:(NSUInteger)pageCount
+                     probeQuery:(nullable NSString *)probeQuery
+                completionQueue:(nullable dispatch_queue_t)completionQueue
+                completionBlock:(nullable void (^)(YapDatabaseFullTextSearchMaintenanceReport *report))completionBlock;
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Describes the result of a background merge.
+ * 
+ * @see -[YapDatabaseFullTextSearchConnection asyncMergeWithPageCount:probeQuery:completionQueue:completionBlock:]
+ */
+@interface YapDatabaseFullTextSearchMaintenanceReport : NSObject
+
+/**
+ * The number of segments in the index, before & after the merge.
+ */
+@property (nonatomic, assign, readonly) NSUInteger segmentCountBefore;
+@property (nonatomic, assign, readonly) NSUInteger segmentCountAfter;
+
+/**
+ * The time it took to run the probeQuery (enumerating all matches), before & after the merge.
+ * If no probeQuery was given, these values are zero.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval queryLatencyBefore;
+@property (nonatomic, assign, readonly) NSTimeInterval queryLatencyAfter;
+
+/**
+ * The number of merge steps that were performed. (Each step uses its own read-write transaction.)
+ */
+@property (nonatomic, assign, readonly) NSUInteger stepCount;
+
+/**
+ * The total time spent performing the merge steps (including waiting for each read-write transaction).
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval mergeDuration;
+
+/**
+ * YES if the index was fully merged.
+ * NO if the merge was cut short because it reached the maximum number of steps.
+ */
+@property (nonatomic, assign, readonly) BOOL completed;
+
 @end
 
 NS_ASSUME_NONNULL_END
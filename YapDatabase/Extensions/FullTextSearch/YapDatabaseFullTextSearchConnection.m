@@ -21,6 +21,110 @@
 #endif
 #pragma unused(ydbLogLevel)
 
+/**
+ * Bridges a YapDatabaseFullTextSearchTokenizerBlock to the fts5 tokenizer interface.
+ *
+ * The pUserData is the (retained) block, and since the block is stateless,
+ * it doubles as the Fts5Tokenizer instance.
+**/
+static int YDBTokenizerCreate(void *pUserData, const char __unused **azArg, int __unused nArg, Fts5Tokenizer **ppOut)
+{
+	*ppOut = (Fts5Tokenizer *)pUserData;
+	return SQLITE_OK;
+}
+
+static void YDBTokenizerDelete(Fts5Tokenizer __unused *pTokenizer)
+{
+	// Nothing to do here (the block is released via YDBTokenizerDestroy)
+}
+
+static void YDBTokenizerDestroy(void *pUserData)
+{
+	CFRelease(pUserData);
+}
+
+static int YDBTokenizerTokenize(Fts5Tokenizer *pTokenizer, void *pCtx, int __unused flags,
+                                const char *pText, int nText,
+                                int (*xToken)(void *pCtx, int tflags, const char *pToken, int nToken, int iStart, int iEnd))
+{
+	if (nText <= 0) return SQLITE_OK;
+	
+	__block int status = SQLITE_OK;
+	@autoreleasepool {
+		
+		YapDatabaseFullTextSearchTokenizerBlock tokenizer =
+		  (__bridge YapDatabaseFullTextSearchTokenizerBlock)(void *)pTokenizer;
+		
+		NSString *text = [[NSString alloc] initWithBytesNoCopy:(void *)pText
+		                                                length:(NSUInteger)nText
+		                                              encoding:NSUTF8StringEncoding
+		                                          freeWhenDone:NO];
+		if (text == nil) return SQLITE_OK; // Invalid UTF-8
+		
+		// The tokenizer block reports ranges in UTF-16 units (NSString), but fts5 requires UTF-8 byte offsets.
+		
+		NSUInteger length = text.length;
+		unichar *chars = malloc(sizeof(unichar) * length);
+		int *offsets = malloc(sizeof(int) * (length + 1));
+		
+		[text getCharacters:chars range:NSMakeRange(0, length)];
+		
+		int offset = 0;
+		for (NSUInteger i = 0; i < length; i++)
+		{
+			offsets[i] = offset;
+			
+			unichar c = chars[i];
+			if (c < 0x80)
+				offset += 1;
+			else if (c < 0x800)
+				offset += 2;
+			else if (CFStringIsSurrogateHighCharacter(c))
+				offset += 4;  // The pair is 4 bytes
+			else if (CFStringIsSurrogateLowCharacter(c))
+				offset += 0;  // Already counted with the high surrogate
+			else
+				offset += 3;
+		}
+		offsets[length] = offset;
+		
+		tokenizer(text, ^(NSString *token, NSRange range) {
+			
+			if (status != SQLITE_OK) return;
+			if (NSMaxRange(range) > length) return;
+			
+			const char *tokenBytes = [token UTF8String];
+			
+			status = xToken(pCtx, 0, tokenBytes, (int)strlen(tokenBytes),
+			                offsets[range.location], offsets[NSMaxRange(range)]);
+		});
+		
+		free(chars);
+		free(offsets);
+	}
+	
+	return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@interface YapDatabaseFullTextSearchMaintenanceReport ()
+
+@property (nonatomic, assign, readwrite) NSUInteger segmentCountBefore;
+@property (nonatomic, assign, readwrite) NSUInteger segmentCountAfter;
+@property (nonatomic, assign, readwrite) NSTimeInterval queryLatencyBefore;
+@property (nonatomic, assign, readwrite) NSTimeInterval queryLatencyAfter;
+@property (nonatomic, assign, readwrite) NSUInteger stepCount;
+@property (nonatomic, assign, readwrite) NSTimeInterval mergeDuration;
+@property (nonatomic, assign, readwrite) BOOL completed;
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 @implementation YapDatabaseFullTextSearchConnection {
 @private
@@ -29,11 +133,17 @@
 	sqlite3_stmt *setRowidStatement;
 	sqlite3_stmt *removeRowidStatement;
 	sqlite3_stmt *removeAllStatement;
+	sqlite3_stmt *unchangedRowidStatement;
 	sqlite3_stmt *queryStatement;
 	sqlite3_stmt *bm25QueryStatement;
+	sqlite3_stmt *bm25LimitQueryStatement;
 	sqlite3_stmt *querySnippetStatement;
 	sqlite3_stmt *rowidQueryStatement;
 	sqlite3_stmt *rowidQuerySnippetStatement;
+	sqlite3_stmt *snippetTableInsertStatement;
+	sqlite3_stmt *snippetTableClearStatement;
+	
+	BOOL snippetTablePrepared;
 }
 
 @synthesize fullTextSearch = parent;
@@ -45,6 +155,8 @@
 	{
 		parent = inParent;
 		databaseConnection = inDatabaseConnection;
+		
+		[self registerTokenizers];
 	}
 	return self;
 }
@@ -60,11 +172,15 @@
 	sqlite_finalize_null(&setRowidStatement);
 	sqlite_finalize_null(&removeRowidStatement);
 	sqlite_finalize_null(&removeAllStatement);
+	sqlite_finalize_null(&unchangedRowidStatement);
 	sqlite_finalize_null(&queryStatement);
 	sqlite_finalize_null(&bm25QueryStatement);
+	sqlite_finalize_null(&bm25LimitQueryStatement);
 	sqlite_finalize_null(&querySnippetStatement);
 	sqlite_finalize_null(&rowidQueryStatement);
 	sqlite_finalize_null(&rowidQuerySnippetStatement);
+	sqlite_finalize_null(&snippetTableInsertStatement);
+	sqlite_finalize_null(&snippetTableClearStatement);
 }
 
 /**
@@ -78,6 +194,51 @@
 	}
 }
 
+/**
+ * Registers the extension's custom tokenizers (if any) with our sqlite connection.
+ * This must be done before the FTS table is accessed.
+**/
+- (void)registerTokenizers
+{
+	NSDictionary<NSString *, YapDatabaseFullTextSearchTokenizerBlock> *tokenizers = parent->tokenizers;
+	if ([tokenizers count] == 0) return;
+	
+	sqlite3 *db = databaseConnection->db;
+	
+	// The fts5 API is obtained via a special query (see "Extending FTS5" in the sqlite docs)
+	
+	fts5_api *api = NULL;
+	sqlite3_stmt *statement = NULL;
+	
+	int status = sqlite3_prepare_v2(db, "SELECT fts5(?1);", -1, &statement, NULL);
+	if (status == SQLITE_OK)
+	{
+		sqlite3_bind_pointer(statement, SQLITE_BIND_START, (void *)&api, "fts5_api_ptr", NULL);
+		sqlite3_step(statement);
+	}
+	sqlite3_finalize(statement);
+	
+	if (api == NULL)
+	{
+		YDBLogError(@"Unable to register FTS tokenizers: fts5 is unavailable: %d %s", status, sqlite3_errmsg(db));
+		return;
+	}
+	
+	fts5_tokenizer methods = { YDBTokenizerCreate, YDBTokenizerDelete, YDBTokenizerTokenize };
+	
+	for (NSString *name in tokenizers)
+	{
+		void *userData = (__bridge_retained void *)[tokenizers objectForKey:name];
+		
+		status = api->xCreateTokenizer(api, [name UTF8String], userData, &methods, YDBTokenizerDestroy);
+		if (status != SQLITE_OK)
+		{
+			YDBLogError(@"Error registering FTS tokenizer (%@): %d %s", name, status, sqlite3_errmsg(db));
+			CFRelease(userData);
+		}
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Accessors
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -169,6 +330,134 @@
 	// to ensure extensions have implementations of all required methods.
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Maintenance
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for documentation.
+**/
+- (void)asyncMergeWithPageCount:(NSUInteger)pageCount
+                     probeQuery:(NSString *)probeQuery
+                completionQueue:(dispatch_queue_t)completionQueue
+                completionBlock:(void (^)(YapDatabaseFullTextSearchMaintenanceReport *report))completionBlock
+{
+	if (completionQueue == NULL && completionBlock != NULL)
+		completionQueue = dispatch_get_main_queue();
+	
+	if (pageCount == 0)
+		pageCount = 64;
+	
+	// Retain the database connection for the duration of the merge
+	// (which retains this extension connection).
+	
+	YapDatabaseConnection *connection = databaseConnection;
+	NSString *registeredName = [parent registeredName];
+	
+	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{ @autoreleasepool {
+		
+		YapDatabaseFullTextSearchMaintenanceReport *report =
+		  [self mergeWithPageCount:pageCount
+		                probeQuery:probeQuery
+		                connection:connection
+		            registeredName:registeredName];
+		
+		if (completionBlock) {
+			dispatch_async(completionQueue, ^{ @autoreleasepool {
+				
+				completionBlock(report);
+			}});
+		}
+	}});
+}
+
+- (YapDatabaseFullTextSearchMaintenanceReport *)mergeWithPageCount:(NSUInteger)pageCount
+                                                        probeQuery:(NSString *)probeQuery
+                                                        connection:(YapDatabaseConnection *)connection
+                                                    registeredName:(NSString *)registeredName
+{
+	YapDatabaseFullTextSearchMaintenanceReport *report = [[YapDatabaseFullTextSearchMaintenanceReport alloc] init];
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		YapDatabaseFullTextSearchTransaction *ftsTransaction = [transaction ext:registeredName];
+		
+		report.segmentCountBefore = [ftsTransaction segmentCount];
+		report.queryLatencyBefore = [self latencyOfQuery:probeQuery withTransaction:ftsTransaction];
+	}];
+	
+	// The first step (negative pageCount) starts a new merge of all the segments.
+	// Subsequent steps (positive pageCount) continue that merge until there's no more work to do,
+	// even if new segments are added (by other commits) in the meantime.
+	//
+	// Each step is performed within its own read-write transaction,
+	// so other writers only ever have to wait for a single step.
+	//
+	// Under steady write traffic, the merge may never run out of work.
+	// So we stop after a maximum number of steps, and report that the merge was cut short.
+	
+	NSUInteger const maxStepCount = 1000;
+	
+	__block BOOL done = NO;
+	NSInteger stepPageCount = -((NSInteger)pageCount);
+	
+	while (!done && (report.stepCount < maxStepCount))
+	{
+		CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+		
+		[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			YapDatabaseFullTextSearchTransaction *ftsTransaction = [transaction ext:registeredName];
+			if (ftsTransaction == nil)
+			{
+				// Extension was unregistered
+				done = YES;
+				return;
+			}
+			
+			done = ![ftsTransaction mergeWithPageCount:stepPageCount];
+		}];
+		
+		report.mergeDuration += (CFAbsoluteTimeGetCurrent() - start);
+		report.stepCount += 1;
+		
+		stepPageCount = (NSInteger)pageCount;
+	}
+	
+	report.completed = done;
+	
+	[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		YapDatabaseFullTextSearchTransaction *ftsTransaction = [transaction ext:registeredName];
+		
+		report.segmentCountAfter = [ftsTransaction segmentCount];
+		report.queryLatencyAfter = [self latencyOfQuery:probeQuery withTransaction:ftsTransaction];
+	}];
+	
+	YDBLogVerbose(@"Merged FTS index (%@): segments %lu -> %lu, steps %lu, completed %@",
+	              registeredName,
+	              (unsigned long)report.segmentCountBefore,
+	              (unsigned long)report.segmentCountAfter,
+	              (unsigned long)report.stepCount,
+	              report.completed ? @"YES" : @"NO");
+	
+	return report;
+}
+
+- (NSTimeInterval)latencyOfQuery:(NSString *)query withTransaction:(YapDatabaseFullTextSearchTransaction *)ftsTransaction
+{
+	if (query == nil || ftsTransaction == nil) return 0.0;
+	
+	CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+	
+	[ftsTransaction enumerateRowidsMatching:query usingBlock:^(int64_t __unused rowid, BOOL __unused *stop) {
+		
+		// Nothing to do here, we're just measuring the query
+	}];
+	
+	return (CFAbsoluteTimeGetCurrent() - start);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Statements
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -264,12 +553,51 @@
 	return *statement;
 }
 
+- (sqlite3_stmt *)unchangedRowidStatement
+{
+	sqlite3_stmt **statement = &unchangedRowidStatement;
+	if (*statement == NULL)
+	{
+		// The IS operator (unlike =) treats two NULL values as equal.
+		
+		NSMutableString *string = [NSMutableString stringWithCapacity:100];
+		[string appendFormat:@"SELECT 1 FROM \"%@\" WHERE \"rowid\" = ?", [parent tableName]];
+		
+		for (NSString *columnName in parent->columnNames)
+		{
+			[string appendFormat:@" AND \"%@\" IS ?", columnName];
+		}
+		
+		[string appendString:@";"];
+		
+		sqlite3 *db = databaseConnection->db;
+		
+		int status = sqlite3_prepare_v2(db, [string UTF8String], -1, statement, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogError(@"Error creating prepared statement: %d %s", status, sqlite3_errmsg(db));
+		}
+	}
+	
+	return *statement;
+}
+
 - (sqlite3_stmt *)removeAllStatement
 {
 	sqlite3_stmt **statement = &removeAllStatement;
 	if (*statement == NULL)
 	{
-		NSString *string = [NSString stringWithFormat:@"DELETE FROM \"%@\";", [parent tableName]];
+		NSString *string = nil;
+		if ([parent isContentless])
+		{
+			// A plain DELETE on a contentless table deletes one row at a time
+			
+			string = [NSString stringWithFormat:@"INSERT INTO \"%1$@\"(\"%1$@\") VALUES('delete-all');", [parent tableName]];
+		}
+		else
+		{
+			string = [NSString stringWithFormat:@"DELETE FROM \"%@\";", [parent tableName]];
+		}
 		
 		sqlite3 *db = databaseConnection->db;
 		
@@ -346,14 +674,40 @@
     return statement;
 }
 
+- (sqlite3_stmt *)bm25LimitQueryStatement
+{
+	sqlite3_stmt **statement = &bm25LimitQueryStatement;
+	if (*statement == NULL)
+	{
+		// The weights are passed via the rank function ("rank MATCH 'bm25(...)'"),
+		// so a single statement can be used for any set of weights.
+		//
+		// Ties are broken by rowid, so the order (and thus every page) is deterministic.
+		
+		NSString *string = [NSString stringWithFormat:
+		  @"SELECT \"rowid\" FROM \"%1$@\" WHERE \"%1$@\" MATCH ? AND \"rank\" MATCH ?"
+		  @" ORDER BY \"rank\", \"rowid\" LIMIT ? OFFSET ?;", [parent tableName]];
+		
+		sqlite3 *db = databaseConnection->db;
+		
+		int status = sqlite3_prepare_v2(db, [string UTF8String], -1, statement, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogError(@"Error creating prepared statement: %d %s", status, sqlite3_errmsg(db));
+		}
+	}
+	
+	return *statement;
+}
+
 - (sqlite3_stmt *)querySnippetStatement
 {
 	sqlite3_stmt **statement = &querySnippetStatement;
 	if (*statement == NULL)
 	{
 		NSString *string = [NSString stringWithFormat:
-		  @"SELECT \"rowid\", snippet(\"%1$@\", ?, ?, ?, ?, ?) FROM \"%1$@\" WHERE \"%1$@\" MATCH ?;",
-		  [parent tableName]];
+		  @"SELECT \"rowid\", %2$@ FROM \"%1$@\" WHERE \"%1$@\" MATCH ?;",
+		  [parent tableName], [self snippetFunctionForTable:[parent tableName] isFTS5:[parent isFTS5]]];
 		
 		sqlite3 *db = databaseConnection->db;
 		
@@ -393,8 +747,8 @@
 	if (*statement == NULL)
 	{
 		NSString *string = [NSString stringWithFormat:
-		  @"SELECT \"rowid\", snippet(\"%1$@\", ?, ?, ?, ?, ?) FROM \"%1$@\" WHERE \"rowid\" = ? AND \"%1$@\" MATCH ?;",
-		  [parent tableName]];
+		  @"SELECT \"rowid\", %2$@ FROM \"%1$@\" WHERE \"rowid\" = ? AND \"%1$@\" MATCH ?;",
+		  [parent tableName], [self snippetFunctionForTable:[parent tableName] isFTS5:[parent isFTS5]]];
 		
 		sqlite3 *db = databaseConnection->db;
 		
@@ -408,4 +762,171 @@
 	return *statement;
 }
 
+/**
+ * Returns the snippet function expression for the given table.
+ *
+ * FTS3/4 : snippet(table, startMatchText, endMatchText, ellipsesText, columnIndex, numTokens)
+ * FTS5   : snippet(table, columnIndex, startMatchText, endMatchText, ellipsesText, numTokens)
+ *
+ * We use numbered parameters, so the bind indexes are the same regardless of the fts version.
+ * Any parameters that follow in the query (e.g. rowid, query) continue at index 6.
+**/
+- (NSString *)snippetFunctionForTable:(NSString *)tableName isFTS5:(BOOL)isFTS5
+{
+	if (isFTS5)
+		return [NSString stringWithFormat:@"snippet(\"%@\", ?4, ?1, ?2, ?3, abs(?5))", tableName];
+	else
+		return [NSString stringWithFormat:@"snippet(\"%@\", ?1, ?2, ?3, ?4, ?5)", tableName];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Snippet Table
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A contentless FTS table doesn't store the indexed text, so it can't generate snippets.
+ *
+ * Instead, we rebuild the text for the requested rows (via the handler),
+ * insert it into a temporary FTS5 table (configured just like the real one),
+ * generate the snippets from there, and then clear the temporary table.
+ *
+ * The temporary table lives in the connection's private "temp" database,
+ * so it may be used within read-only transactions, and is never written to the database file.
+**/
+- (BOOL)prepareSnippetTable
+{
+	if (snippetTablePrepared) return YES;
+	
+	sqlite3 *db = databaseConnection->db;
+	
+	NSString *snippetTableName = [parent snippetTableName];
+	
+	// Drop any leftover table (e.g. from a previous registration with different columns)
+	
+	NSString *dropTable = [NSString stringWithFormat:@"DROP TABLE IF EXISTS temp.\"%@\";", snippetTableName];
+	
+	int status = sqlite3_exec(db, [dropTable UTF8String], NULL, NULL, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Failed dropping FTS snippet table (%@): %d %s", snippetTableName, status, sqlite3_errmsg(db));
+		return NO;
+	}
+	
+	// CREATE VIRTUAL TABLE temp."snippetTableName" USING fts5("column1", "column2", ..., option=value, ...);
+	
+	NSMutableString *createTable = [NSMutableString stringWithCapacity:100];
+	[createTable appendFormat:@"CREATE VIRTUAL TABLE temp.\"%@\" USING %@(",
+	  snippetTableName, YapDatabaseFullTextSearchFTS5Version];
+	
+	__block NSUInteger i = 0;
+	
+	for (NSString *columnName in parent->columnNames)
+	{
+		if (i == 0)
+			[createTable appendFormat:@"\"%@\"", columnName];
+		else
+			[createTable appendFormat:@", \"%@\"", columnName];
+		
+		i++;
+	}
+	
+	[parent->options enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL __unused *stop) {
+		
+		[createTable appendFormat:@", %@=%@", (NSString *)key, (NSString *)obj];
+	}];
+	
+	[createTable appendString:@");"];
+	
+	status = sqlite3_exec(db, [createTable UTF8String], NULL, NULL, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Failed creating FTS snippet table (%@): %d %s", snippetTableName, status, sqlite3_errmsg(db));
+		return NO;
+	}
+	
+	snippetTablePrepared = YES;
+	return YES;
+}
+
+- (sqlite3_stmt *)snippetTableInsertStatement
+{
+	sqlite3_stmt **statement = &snippetTableInsertStatement;
+	if (*statement == NULL)
+	{
+		NSMutableString *string = [NSMutableString stringWithCapacity:100];
+		[string appendFormat:@"INSERT INTO temp.\"%@\" (\"rowid\"", [parent snippetTableName]];
+		
+		for (NSString *columnName in parent->columnNames)
+		{
+			[string appendFormat:@", \"%@\"", columnName];
+		}
+		
+		[string appendString:@") VALUES (?"];
+		
+		NSUInteger count = [parent->columnNames count];
+		NSUInteger i;
+		for (i = 0; i < count; i++)
+		{
+			[string appendString:@", ?"];
+		}
+		
+		[string appendString:@");"];
+		
+		sqlite3 *db = databaseConnection->db;
+		
+		int status = sqlite3_prepare_v2(db, [string UTF8String], -1, statement, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogError(@"Error creating prepared statement: %d %s", status, sqlite3_errmsg(db));
+		}
+	}
+	
+	return *statement;
+}
+
+- (sqlite3_stmt *)snippetTableClearStatement
+{
+	sqlite3_stmt **statement = &snippetTableClearStatement;
+	if (*statement == NULL)
+	{
+		NSString *string = [NSString stringWithFormat:@"DELETE FROM temp.\"%@\";", [parent snippetTableName]];
+		
+		sqlite3 *db = databaseConnection->db;
+		
+		int status = sqlite3_prepare_v2(db, [string UTF8String], -1, statement, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogError(@"Error creating prepared statement: %d %s", status, sqlite3_errmsg(db));
+		}
+	}
+	
+	return *statement;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation YapDatabaseFullTextSearchMaintenanceReport
+
+@synthesize segmentCountBefore;
+@synthesize segmentCountAfter;
+@synthesize queryLatencyBefore;
+@synthesize queryLatencyAfter;
+@synthesize stepCount;
+@synthesize mergeDuration;
+@synthesize completed;
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:
+	  @"<YapDatabaseFullTextSearchMaintenanceReport: segments %lu -> %lu, latency %.4f -> %.4f, steps %lu, duration %.4f,"
+	  @" completed %@>",
+	  (unsigned long)segmentCountBefore, (unsigned long)segmentCountAfter,
+	  queryLatencyBefore, queryLatencyAfter,
+	  (unsigned long)stepCount, mergeDuration, (completed ? @"YES" : @"NO")];
+}
+
 @end
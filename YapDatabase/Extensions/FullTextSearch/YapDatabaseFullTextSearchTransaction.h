@@ -2,6 +2,7 @@
 
 #import "YapDatabaseExtensionTransaction.h"
 #import "YapDatabaseFullTextSearchSnippetOptions.h"
+#import "YapDatabaseQuery.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -44,6 +45,17 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)enumerateRowsMatching:(NSString *)query
                    usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, __nullable id metadata, BOOL *stop))block;
 
+// Combined queries
+//
+// Full text search can be combined with other extensions (e.g. a secondary index or rtree index)
+// in a single statement. See -[YapDatabaseReadTransaction enumerateKeysMatchingQueries:usingBlock:].
+//
+// The query for this extension is a regular "WHERE ..." clause against the fts table,
+// so you can match against a single column. E.g. [YapDatabaseQuery queryWithFormat:@"WHERE name MATCH ?", text]
+// This method returns a query that matches against all columns (just like enumerateKeysMatching:usingBlock:).
+
+- (YapDatabaseQuery *)queryMatching:(NSString *)query;
+
 // FTS5 bm25 ordering
 
 - (void)enumerateBm25OrderedKeysMatching:(NSString *)query
@@ -62,6 +74,42 @@ NS_ASSUME_NONNULL_BEGIN
                              withWeights:(nullable NSArray<NSNumber *> *)weights
                               usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, __nullable id metadata, BOOL *stop))block;
 
+// FTS5 bm25 ordering, top-k & pagination
+//
+// The methods above rank every matching row, and sqlite must sort the entire result set
+// before the first row can be returned. (Stopping the enumeration early doesn't avoid this cost.)
+//
+// These methods push the LIMIT & OFFSET into sqlite, so only the top (offset + limit) rows are kept while sorting.
+// Rows with equal rank are ordered by rowid, so the order is stable, and consecutive pages never overlap.
+// (Assuming the database isn't modified between fetching the pages.)
+//
+// For example, to fetch the 3rd page of 20 results:
+// [ftsTransaction enumerateBm25OrderedKeysMatching:query withWeights:nil limit:20 offset:40 usingBlock:...];
+
+- (void)enumerateBm25OrderedKeysMatching:(NSString *)query
+                             withWeights:(nullable NSArray<NSNumber *> *)weights
+                                   limit:(NSUInteger)limit
+                                  offset:(NSUInteger)offset
+                              usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block;
+
+- (void)enumerateBm25OrderedKeysAndMetadataMatching:(NSString *)query
+                                        withWeights:(nullable NSArray<NSNumber *> *)weights
+                                              limit:(NSUInteger)limit
+                                             offset:(NSUInteger)offset
+                                         usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, __nullable id metadata, BOOL *stop))block;
+
+- (void)enumerateBm25OrderedKeysAndObjectsMatching:(NSString *)query
+                                       withWeights:(nullable NSArray<NSNumber *> *)weights
+                                             limit:(NSUInteger)limit
+                                            offset:(NSUInteger)offset
+                                        usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, BOOL *stop))block;
+
+- (void)enumerateBm25OrderedRowsMatching:(NSString *)query
+                             withWeights:(nullable NSArray<NSNumber *> *)weights
+                                   limit:(NSUInteger)limit
+                                  offset:(NSUInteger)offset
+                              usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, __nullable id metadata, BOOL *stop))block;
+
 // Query matching + Snippets
 
 - (void)enumerateKeysMatching:(NSString *)query
@@ -84,6 +132,115 @@ NS_ASSUME_NONNULL_BEGIN
                    usingBlock:
             (void (NS_NOESCAPE^)(NSString *snippet, NSString *collection, NSString *key, id object, __nullable id metadata, BOOL *stop))block;
 
+// Substring matching
+//
+// These methods are designed for use with the trigram tokenizer (YapDatabaseFullTextSearchTrigramTokenizer),
+// or a custom n-gram tokenizer (see +[YapDatabaseFullTextSearch ngramTokenizerWithLength:]).
+// With such a tokenizer, substring, LIKE & GLOB queries are answered using the full text index,
+// instead of scanning every row.
+//
+// With any other tokenizer, the LIKE & GLOB methods still work, but require a full table scan.
+
+/**
+ * Enumerates all rows containing the given substring (in any column).
+ *
+ * If the substring is at least 3 characters long, this is performed as an FTS phrase query.
+ * Which matches exactly the rows containing the substring when using a trigram / n-gram tokenizer (n <= 3).
+ *
+ * Shorter substrings are too short to be made up of trigrams,
+ * so they fall back to a LIKE query on every column (which scans the table, and ignores contentless tables).
+**/
+- (void)enumerateKeysContainingSubstring:(NSString *)substring
+                              usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block;
+
+- (void)enumerateKeysAndObjectsContainingSubstring:(NSString *)substring
+                                        usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, BOOL *stop))block;
+
+/**
+ * Enumerates all rows where the given column matches the LIKE / GLOB pattern.
+ * E.g. [ftsTransaction enumerateKeysInColumn:@"code" like:@"%x-42%" usingBlock:...]
+ *
+ * The trigram tokenizer can only accelerate LIKE queries if it's case insensitive (the default),
+ * and GLOB queries if it's case sensitive (@{ @"tokenize": @"trigram case_sensitive 1" }).
+ * Patterns also require at least 3 consecutive non-wildcard characters to use the index.
+**/
+- (void)enumerateKeysInColumn:(NSString *)column
+                         like:(NSString *)pattern
+                   usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block;
+
+- (void)enumerateKeysInColumn:(NSString *)column
+                         glob:(NSString *)pattern
+                   usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block;
+
+// Index maintenance
+//
+// Every commit that modifies the FTS index adds a new segment (b-tree) to it.
+// Sqlite merges these segments together over time (automerge), but heavy update traffic can still leave
+// the index fragmented, which slowly increases the cost of each MATCH query.
+//
+// The settings below are stored within the FTS table, and are automatically re-applied
+// if the extension needs to re-create its table (e.g. the versionTag changes).
+// Methods that modify the index are only allowed within a read-write transaction.
+//
+// For merging the index in the background, see:
+// -[YapDatabaseFullTextSearchConnection asyncMergeWithPageCount:probeQuery:completionQueue:completionBlock:]
+//
+// For more information about the settings, see the sqlite documentation:
+// https://www.sqlite.org/fts5.html#fts5_automerge_option
+// https://www.sqlite.org/fts3.html#automerge
+
+/**
+ * Sets the 'automerge' option. (fts4 & fts5)
+ * This controls how many segments must accumulate on a level before they're automatically merged.
+ * A value of zero disables automatic merging entirely (in which case you must merge manually).
+ *
+ * @return
+ *   YES if the setting was applied. NO otherwise (e.g. unsupported by the ftsVersion, or invalid value).
+ */
+- (BOOL)setAutomerge:(NSInteger)automerge;
+
+/**
+ * Sets the 'crisismerge' option. (fts5 only)
+ * If this many segments accumulate on a single level, they're merged immediately (as part of the commit),
+ * regardless of the automerge setting.
+ */
+- (BOOL)setCrisismerge:(NSInteger)crisismerge;
+
+/**
+ * Sets the 'usermerge' option. (fts5 only)
+ * This controls how many segments must exist on a level before they're merged via mergeWithPageCount:
+ * (when invoked with a positive pageCount).
+ */
+- (BOOL)setUsermerge:(NSInteger)usermerge;
+
+/**
+ * Performs a single incremental merge step, writing (roughly) the given number of pages.
+ *
+ * A negative pageCount starts a new merge of all segments (even if there are only a few of them),
+ * and a positive pageCount continues any merge in progress (or merges levels that have reached 'usermerge').
+ * Thus, to incrementally optimize the index, invoke this method once with a negative value,
+ * and then repeatedly with a positive value until it returns NO.
+ *
+ * @return
+ *   YES if the merge did some work (and there may be more work to do).
+ *   NO if there was nothing to merge.
+ */
+- (BOOL)mergeWithPageCount:(NSInteger)pageCount;
+
+/**
+ * Merges all segments of the index into a single segment.
+ *
+ * This results in the fastest possible queries, but for a large index it can take a considerable amount of time,
+ * during which the read-write transaction is held open. Prefer mergeWithPageCount: for large indexes.
+ */
+- (BOOL)optimize;
+
+/**
+ * Returns the number of segments (b-trees) in the index.
+ * A lower number means (generally) faster queries.
+ */
+- (NSUInteger)segmentCount;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -23,6 +23,10 @@
 static NSString *const ext_key__classVersion       = @"classVersion";
 static NSString *const ext_key__versionTag         = @"versionTag";
 static NSString *const ext_key__ftsVersion         = @"ftsVersion";
+static NSString *const ext_key__contentless        = @"contentless";
+static NSString *const ext_key__automerge          = @"automerge";
+static NSString *const ext_key__crisismerge        = @"crisismerge";
+static NSString *const ext_key__usermerge          = @"usermerge";
 static NSString *const ext_key__version_deprecated = @"version";
 
 
@@ -64,6 +68,7 @@ static NSString *const ext_key__version_deprecated = @"version";
 		}
 		
 		if (![self createTable]) return NO;
+		[self restoreMergeSettings];
 		if (![self populate]) return NO;
 		
 		[self setIntValue:classVersion forExtensionKey:ext_key__classVersion persistent:YES];
@@ -73,6 +78,9 @@ static NSString *const ext_key__version_deprecated = @"version";
         
         NSString *ftsVersion = parentConnection->parent->ftsVersion;
         [self setStringValue:ftsVersion forExtensionKey:ext_key__ftsVersion persistent:YES];
+		
+		BOOL contentless = [parentConnection->parent isContentless];
+		[self setBoolValue:contentless forExtensionKey:ext_key__contentless persistent:YES];
 	}
 	else
 	{
@@ -87,6 +95,11 @@ static NSString *const ext_key__version_deprecated = @"version";
         
         NSString *oldFtsVesrion = [self stringValueForExtensionKey:ext_key__ftsVersion persistent:YES];
 		
+		BOOL contentless = [parentConnection->parent isContentless];
+		
+		BOOL oldContentless = NO;
+		[self getBoolValue:&oldContentless forExtensionKey:ext_key__contentless persistent:YES];
+		
 		BOOL hasOldVersion_deprecated = NO;
 		if (oldVersionTag == nil)
 		{
@@ -101,14 +114,17 @@ static NSString *const ext_key__version_deprecated = @"version";
 			}
 		}
 		
-		if (![oldVersionTag isEqualToString:versionTag] || ![oldFtsVesrion isEqualToString:ftsVersion])
+		if (![oldVersionTag isEqualToString:versionTag] ||
+		    ![oldFtsVesrion isEqualToString:ftsVersion] || (oldContentless != contentless))
 		{
 			if (![self dropTable]) return NO;
 			if (![self createTable]) return NO;
+			[self restoreMergeSettings];
 			if (![self populate]) return NO;
 			
 			[self setStringValue:versionTag forExtensionKey:ext_key__versionTag persistent:YES];
 			[self setStringValue:ftsVersion forExtensionKey:ext_key__ftsVersion persistent:YES];
+			[self setBoolValue:contentless forExtensionKey:ext_key__contentless persistent:YES];
 			
 			if (hasOldVersion_deprecated)
 				[self removeValueForExtensionKey:ext_key__version_deprecated persistent:YES];
@@ -208,6 +224,19 @@ static NSString *const ext_key__version_deprecated = @"version";
 		i++;
 	}];
 	
+	if ([parentConnection->parent isContentless])
+	{
+		// Store only the index (not a copy of the text).
+		// The contentless_delete option is required so that rows can be updated & deleted.
+		
+		[createTable appendString:@", content='', contentless_delete=1"];
+	}
+	else if (parentConnection->parent->contentless)
+	{
+		YDBLogWarn(@"Contentless FTS requires fts5 & sqlite 3.43.0+ (have %s). Using a normal FTS table for: %@",
+		           sqlite3_libversion(), [self registeredName]);
+	}
+	
 	[createTable appendString:@");"];
 	
 	int status = sqlite3_exec(db, [createTable UTF8String], NULL, NULL, NULL);
@@ -406,6 +435,55 @@ static NSString *const ext_key__version_deprecated = @"version";
 	[parentConnection->mutationStack markAsMutated];
 }
 
+/**
+ * Returns YES if the FTS table already contains the given rowid, with the values in the 'blockDict' ivar.
+ * In which case there's no need to re-write the row (which means re-tokenizing all of its text).
+**/
+- (BOOL)isUnchangedRowid:(int64_t)rowid
+{
+	// A contentless table doesn't store the values, so there's nothing to compare against.
+	
+	if ([parentConnection->parent isContentless]) return NO;
+	
+	sqlite3_stmt *statement = [parentConnection unchangedRowidStatement];
+	if (statement == NULL)
+		return NO;
+	
+	// SELECT 1 FROM "tableName" WHERE "rowid" = ? AND "column1" IS ? AND "column2" IS ? ...;
+	
+	sqlite3_bind_int64(statement, SQLITE_BIND_START, rowid);
+	
+	int i = SQLITE_BIND_START + 1;
+	for (NSString *columnName in parentConnection->parent->columnNames)
+	{
+		NSString *columnValue = [parentConnection->blockDict objectForKey:columnName];
+		if (columnValue)
+		{
+			sqlite3_bind_text(statement, i, [columnValue UTF8String], -1, SQLITE_TRANSIENT);
+		}
+		
+		i++;
+	}
+	
+	BOOL unchanged = NO;
+	
+	int status = sqlite3_step(statement);
+	if (status == SQLITE_ROW)
+	{
+		unchanged = YES;
+	}
+	else if (status != SQLITE_DONE)
+	{
+		YDBLogError(@"Error executing 'unchangedRowidStatement': %d %s",
+		            status, sqlite3_errmsg(databaseTransaction->connection->db));
+	}
+	
+	sqlite3_clear_bindings(statement);
+	sqlite3_reset(statement);
+	
+	return unchanged;
+}
+
 - (void)removeRowid:(int64_t)rowid
 {
 	YDBLogAutoTrace();
@@ -617,14 +695,22 @@ static NSString *const ext_key__version_deprecated = @"version";
 	
 	if ([parentConnection->blockDict count] == 0)
 	{
-		// This was an insert operation, so we don't have to worry about removing anything.
+		// Remove associated values from index (if needed).
+		
+		if (!isInsert)
+		{
+			[self removeRowid:rowid];
+		}
 	}
 	else
 	{
-		// Add values to index.
-		// This was an insert operation, so we know we can insert rather than update.
+		// Add values to index (or update them).
+		// If this was an update operation, and the indexed text didn't change, we can skip the write.
 		
-		[self addRowid:rowid isNew:isInsert];
+		if (isInsert || ![self isUnchangedRowid:rowid])
+		{
+			[self addRowid:rowid isNew:isInsert];
+		}
 		[parentConnection->blockDict removeAllObjects];
 	}
 }
@@ -978,6 +1064,210 @@ static NSString *const ext_key__version_deprecated = @"version";
 	}];
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Combined Queries
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns a query that matches the given search string against all columns.
+ * For use with the combined query methods of YapDatabaseReadTransaction.
+ *
+ * Within the fts table, the hidden column (that represents all columns) has the same name as the table.
+ * And it can't be referenced via an alias, so we use the actual table name.
+**/
+- (YapDatabaseQuery *)queryMatching:(NSString *)query
+{
+	NSString *queryString = [NSString stringWithFormat:@"WHERE \"%@\" MATCH ?", [self tableName]];
+	
+	return [YapDatabaseQuery queryWithString:queryString parameters:@[ (query ?: @"") ]];
+}
+
+/**
+ * Optional override method from YapDatabaseExtensionTransaction.
+ * Used by the combined query methods of YapDatabaseReadTransaction.
+**/
+- (NSString *)rowidQueryStringForQuery:(YapDatabaseQuery *)query
+{
+	if (query.isAggregateQuery) return nil;
+	
+	return [NSString stringWithFormat:@"SELECT \"rowid\" FROM \"%@\" %@", [self tableName], query.queryString];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Substring Queries
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Internal method.
+ *
+ * Enumerates the rowids matching the given WHERE clause, which has a single parameter (?1).
+ * Used for LIKE & GLOB queries, which can't use a cached statement (as the column varies).
+**/
+- (void)enumerateRowidsWhere:(NSString *)whereClause
+                   parameter:(NSString *)parameter
+                  usingBlock:(void (NS_NOESCAPE^)(int64_t rowid, BOOL *stop))block
+{
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	NSString *query = [NSString stringWithFormat:@"SELECT \"rowid\" FROM \"%@\" WHERE %@;", [self tableName], whereClause];
+	
+	sqlite3_stmt *statement = NULL;
+	
+	int status = sqlite3_prepare_v2(db, [query UTF8String], -1, &statement, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Error creating statement (%@): %d %s", query, status, sqlite3_errmsg(db));
+		return;
+	}
+	
+	BOOL stop = NO;
+	YapMutationStackItem_Bool *mutation = [parentConnection->mutationStack push]; // mutation during enum protection
+	
+	int const column_idx_rowid = SQLITE_COLUMN_START;
+	int const bind_idx_param   = SQLITE_BIND_START;
+	
+	YapDatabaseString _param; MakeYapDatabaseString(&_param, parameter);
+	sqlite3_bind_text(statement, bind_idx_param, _param.str, _param.length, SQLITE_STATIC);
+	
+	while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+	{
+		int64_t rowid = sqlite3_column_int64(statement, column_idx_rowid);
+		
+		block(rowid, &stop);
+		
+		if (stop || mutation.isMutated) break;
+	}
+	
+	if ((status != SQLITE_DONE) && !stop && !mutation.isMutated)
+	{
+		YDBLogError(@"sqlite_step error: %d %s", status, sqlite3_errmsg(db));
+	}
+	
+	sqlite3_finalize(statement);
+	FreeYapDatabaseString(&_param);
+	
+	if (!stop && mutation.isMutated)
+	{
+		@throw [databaseTransaction mutationDuringEnumerationException];
+	}
+}
+
+- (void)enumerateRowidsInColumn:(NSString *)column
+                       operator:(NSString *)operator
+                        pattern:(NSString *)pattern
+                     usingBlock:(void (NS_NOESCAPE^)(int64_t rowid, BOOL *stop))block
+{
+	if (block == nil) return;
+	if ([pattern length] == 0) return;
+	
+	if (![parentConnection->parent->columnNames containsObject:column])
+	{
+		YDBLogWarn(@"%@: Unknown column: %@", [self registeredName], column);
+		return;
+	}
+	
+	NSString *whereClause = [NSString stringWithFormat:@"\"%@\" %@ ?1", column, operator];
+	
+	[self enumerateRowidsWhere:whereClause parameter:pattern usingBlock:block];
+}
+
+- (void)enumerateRowidsContainingSubstring:(NSString *)substring
+                                usingBlock:(void (NS_NOESCAPE^)(int64_t rowid, BOOL *stop))block
+{
+	if (block == nil) return;
+	if ([substring length] == 0) return;
+	
+	__block NSUInteger characterCount = 0;
+	[substring enumerateSubstringsInRange:NSMakeRange(0, substring.length)
+	                              options:(NSStringEnumerationByComposedCharacterSequences |
+	                                       NSStringEnumerationSubstringNotRequired)
+	                           usingBlock:
+	    ^(NSString __unused *s, NSRange __unused range, NSRange __unused enclosingRange, BOOL *innerStop)
+	{
+		if (++characterCount >= 3) *innerStop = YES;
+	}];
+	
+	if (characterCount >= 3)
+	{
+		// With a trigram (or n-gram) tokenizer, the substring is tokenized into a sequence of consecutive n-grams.
+		// So a phrase query matches exactly those rows that contain the substring, and is answered by the index.
+		
+		NSString *escaped = [substring stringByReplacingOccurrencesOfString:@"\"" withString:@"\"\""];
+		NSString *phrase = [NSString stringWithFormat:@"\"%@\"", escaped];
+		
+		[self enumerateRowidsMatching:phrase usingBlock:block];
+	}
+	else
+	{
+		// Too short to be made up of trigrams.
+		// Fall back to a LIKE query on every column (which scans the table).
+		
+		NSMutableString *pattern = [NSMutableString stringWithCapacity:(substring.length + 4)];
+		[pattern appendString:@"%"];
+		[pattern appendString:[[[substring
+		  stringByReplacingOccurrencesOfString:@"\\" withString:@"\\\\"]
+		  stringByReplacingOccurrencesOfString:@"%" withString:@"\\%"]
+		  stringByReplacingOccurrencesOfString:@"_" withString:@"\\_"]];
+		[pattern appendString:@"%"];
+		
+		NSMutableArray<NSString *> *clauses = [NSMutableArray arrayWithCapacity:[parentConnection->parent->columnNames count]];
+		for (NSString *columnName in parentConnection->parent->columnNames)
+		{
+			[clauses addObject:[NSString stringWithFormat:@"\"%@\" LIKE ?1 ESCAPE '\\'", columnName]];
+		}
+		
+		[self enumerateRowidsWhere:[clauses componentsJoinedByString:@" OR "] parameter:pattern usingBlock:block];
+	}
+}
+
+- (void)enumerateKeysContainingSubstring:(NSString *)substring
+                              usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block
+{
+	[self enumerateRowidsContainingSubstring:substring usingBlock:^(int64_t rowid, BOOL *stop) {
+		
+		YapCollectionKey *ck = [self->databaseTransaction collectionKeyForRowid:rowid];
+		
+		block(ck.collection, ck.key, stop);
+	}];
+}
+
+- (void)enumerateKeysAndObjectsContainingSubstring:(NSString *)substring
+                                        usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, BOOL *stop))block
+{
+	[self enumerateRowidsContainingSubstring:substring usingBlock:^(int64_t rowid, BOOL *stop) {
+		
+		YapCollectionKey *ck = nil;
+		id object = nil;
+		[self->databaseTransaction getCollectionKey:&ck object:&object forRowid:rowid];
+		
+		block(ck.collection, ck.key, object, stop);
+	}];
+}
+
+- (void)enumerateKeysInColumn:(NSString *)column
+                         like:(NSString *)pattern
+                   usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block
+{
+	[self enumerateRowidsInColumn:column operator:@"LIKE" pattern:pattern usingBlock:^(int64_t rowid, BOOL *stop) {
+		
+		YapCollectionKey *ck = [self->databaseTransaction collectionKeyForRowid:rowid];
+		
+		block(ck.collection, ck.key, stop);
+	}];
+}
+
+- (void)enumerateKeysInColumn:(NSString *)column
+                         glob:(NSString *)pattern
+                   usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block
+{
+	[self enumerateRowidsInColumn:column operator:@"GLOB" pattern:pattern usingBlock:^(int64_t rowid, BOOL *stop) {
+		
+		YapCollectionKey *ck = [self->databaseTransaction collectionKeyForRowid:rowid];
+		
+		block(ck.collection, ck.key, stop);
+	}];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark bm25  Queries
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1091,76 +1381,229 @@ static NSString *const ext_key__version_deprecated = @"version";
     }];
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#pragma mark Queries with Snippets
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-- (void)enumerateRowidsMatching:(NSString *)query
-             withSnippetOptions:(YapDatabaseFullTextSearchSnippetOptions *)inOptions
-                     usingBlock:
-            (void (NS_NOESCAPE^)(NSString *snippet, int64_t rowid, BOOL *stop))block
+/**
+ * Internal method.
+ *
+ * Same as enumerateBm25OrderedRowidsMatching:withWeights:usingBlock:,
+ * but pushes the LIMIT & OFFSET into sqlite, so that only the requested page of results is ranked & returned.
+ * (Sqlite only has to keep the top (offset + limit) rows while sorting, instead of sorting every match.)
+**/
+- (void)enumerateBm25OrderedRowidsMatching:(NSString *)query
+                               withWeights:(nullable NSArray<NSNumber *> *)weights
+                                     limit:(NSUInteger)limit
+                                    offset:(NSUInteger)offset
+                                usingBlock:(void (NS_NOESCAPE^)(int64_t rowid, BOOL *stop))block
 {
-	if (block == nil) return;
-	if ([query length] == 0) return;
-	
-	sqlite3_stmt *statement = [parentConnection querySnippetStatement];
-	if (statement == NULL) return;
-	
-	YapDatabaseFullTextSearchSnippetOptions *options;
-	if (inOptions)
-		options = [inOptions copy];
-	else
-		options = [[YapDatabaseFullTextSearchSnippetOptions alloc] init]; // default snippet options
-	
-	BOOL stop = NO;
-	YapMutationStackItem_Bool *mutation = [parentConnection->mutationStack push]; // mutation during enum protection
-	
-	// SELECT "rowid", snippet("tableName", ?, ?, ?, ?, ?) FROM "tableName" WHERE "tableName" MATCH ?;
-	
-	int const column_idx_rowid        = SQLITE_COLUMN_START + 0;
-	int const column_idx_snippet      = SQLITE_COLUMN_START + 1;
-	
-	int const bind_idx_startMatchText = SQLITE_BIND_START + 0;
-	int const bind_idx_endMatchText   = SQLITE_BIND_START + 1;
-	int const bind_idx_ellipsesText   = SQLITE_BIND_START + 2;
-	int const bind_idx_columnIndex    = SQLITE_BIND_START + 3;
-	int const bind_idx_numTokens      = SQLITE_BIND_START + 4;
-	int const bind_idx_query          = SQLITE_BIND_START + 5;
-	
-	YapDatabaseString _startMatchText; MakeYapDatabaseString(&_startMatchText, options.startMatchText);
-	sqlite3_bind_text(statement, bind_idx_startMatchText, _startMatchText.str, _startMatchText.length, SQLITE_STATIC);
-	
-	YapDatabaseString _endMatchText; MakeYapDatabaseString(&_endMatchText, options.endMatchText);
-	sqlite3_bind_text(statement, bind_idx_endMatchText, _endMatchText.str, _endMatchText.length, SQLITE_STATIC);
-	
-	YapDatabaseString _ellipsesText; MakeYapDatabaseString(&_ellipsesText, options.ellipsesText);
-	sqlite3_bind_text(statement, bind_idx_ellipsesText, _ellipsesText.str, _ellipsesText.length, SQLITE_STATIC);
-
-	int columnIndex = -1;
-	if (options.columnName)
-	{
-		NSUInteger index = [parentConnection->parent->columnNames indexOfObject:options.columnName];
-		if (index == NSNotFound)
-		{
-			YDBLogWarn(@"Invalid snippet option: columnName(%@) not found", options.columnName);
-		}
-		else
-		{
-			columnIndex = (int)index;
-		}
-	}
-	sqlite3_bind_int(statement, bind_idx_columnIndex, columnIndex);
-	sqlite3_bind_int(statement, bind_idx_numTokens, options.numberOfTokens);
-	
-	YapDatabaseString _query; MakeYapDatabaseString(&_query, query);
-	sqlite3_bind_text(statement, bind_idx_query, _query.str, _query.length, SQLITE_STATIC);
-	
-	int status;
-	while ((status = sqlite3_step(statement)) == SQLITE_ROW)
-	{
-		int64_t rowid = sqlite3_column_int64(statement, column_idx_rowid);
-		
-		const unsigned char *text = sqlite3_column_text(statement, column_idx_snippet);
+    if (![parentConnection->parent.ftsVersion isEqualToString:YapDatabaseFullTextSearchFTS5Version]) {
+        NSString *reason = [NSString stringWithFormat:
+                            @"bm25 ordering used on non fts5 extension %@", parentConnection->parent.registeredName];
+        
+        NSDictionary *userInfo = @{ NSLocalizedRecoverySuggestionErrorKey:
+                                    @"You may want to initialize that extension with YapDatabaseFullTextSearchFTS5Version" };
+        
+        @throw [NSException exceptionWithName:@"YapDatabaseFullTextSearch" reason:reason userInfo:userInfo];
+        return;
+    }
+    
+    if (block == nil) return;
+    if ([query length] == 0) return;
+    if (limit == 0) return;
+    
+    sqlite3_stmt *statement = [parentConnection bm25LimitQueryStatement];
+    if (statement == NULL) return;
+    
+    BOOL stop = NO;
+    YapMutationStackItem_Bool *mutation = [parentConnection->mutationStack push]; // mutation during enum protection
+    
+    // SELECT "rowid" FROM "tableName" WHERE "tableName" MATCH ? AND "rank" MATCH ?
+    //   ORDER BY "rank", "rowid" LIMIT ? OFFSET ?;
+    
+    int const column_idx_rowid  = SQLITE_COLUMN_START;
+    int const bind_idx_query    = SQLITE_BIND_START + 0;
+    int const bind_idx_rank     = SQLITE_BIND_START + 1;
+    int const bind_idx_limit    = SQLITE_BIND_START + 2;
+    int const bind_idx_offset   = SQLITE_BIND_START + 3;
+    
+    NSString *rankFunction = @"bm25()";
+    if (weights.count > 0) {
+        rankFunction = [NSString stringWithFormat:@"bm25(%@)", [weights componentsJoinedByString:@", "]];
+    }
+    
+    YapDatabaseString _query; MakeYapDatabaseString(&_query, query);
+    sqlite3_bind_text(statement, bind_idx_query, _query.str, _query.length, SQLITE_STATIC);
+    
+    YapDatabaseString _rank; MakeYapDatabaseString(&_rank, rankFunction);
+    sqlite3_bind_text(statement, bind_idx_rank, _rank.str, _rank.length, SQLITE_STATIC);
+    
+    sqlite3_bind_int64(statement, bind_idx_limit, (sqlite3_int64)MIN(limit, (NSUInteger)INT64_MAX));
+    sqlite3_bind_int64(statement, bind_idx_offset, (sqlite3_int64)MIN(offset, (NSUInteger)INT64_MAX));
+    
+    int status;
+    while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+    {
+        int64_t rowid = sqlite3_column_int64(statement, column_idx_rowid);
+        
+        block(rowid, &stop);
+        
+        if (stop || mutation.isMutated) break;
+    }
+    
+    if ((status != SQLITE_DONE) && !stop && !mutation.isMutated)
+    {
+        YDBLogError(@"sqlite_step error: %d %s",
+                    status, sqlite3_errmsg(databaseTransaction->connection->db));
+    }
+    
+    sqlite3_clear_bindings(statement);
+    sqlite3_reset(statement);
+    FreeYapDatabaseString(&_query);
+    FreeYapDatabaseString(&_rank);
+    
+    if (!stop && mutation.isMutated)
+    {
+        @throw [databaseTransaction mutationDuringEnumerationException];
+    }
+}
+
+- (void)enumerateBm25OrderedKeysMatching:(NSString *)query
+                             withWeights:(nullable NSArray<NSNumber *> *)weights
+                                   limit:(NSUInteger)limit
+                                  offset:(NSUInteger)offset
+                              usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block {
+    [self enumerateBm25OrderedRowidsMatching:query withWeights:weights limit:limit offset:offset
+                                  usingBlock:^(int64_t rowid, BOOL *stop) {
+        
+        YapCollectionKey *ck = [self->databaseTransaction collectionKeyForRowid:rowid];
+        
+        block(ck.collection, ck.key, stop);
+    }];
+}
+
+- (void)enumerateBm25OrderedKeysAndMetadataMatching:(NSString *)query
+                                        withWeights:(nullable NSArray<NSNumber *> *)weights
+                                              limit:(NSUInteger)limit
+                                             offset:(NSUInteger)offset
+                                         usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, id metadata, BOOL *stop))block {
+    [self enumerateBm25OrderedRowidsMatching:query withWeights:weights limit:limit offset:offset
+                                  usingBlock:^(int64_t rowid, BOOL *stop) {
+        
+        YapCollectionKey *ck = nil;
+        id metadata = nil;
+        [self->databaseTransaction getCollectionKey:&ck metadata:&metadata forRowid:rowid];
+        
+        block(ck.collection, ck.key, metadata, stop);
+    }];
+}
+
+- (void)enumerateBm25OrderedKeysAndObjectsMatching:(NSString *)query
+                                       withWeights:(nullable NSArray<NSNumber *> *)weights
+                                             limit:(NSUInteger)limit
+                                            offset:(NSUInteger)offset
+                                        usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, BOOL *stop))block {
+    [self enumerateBm25OrderedRowidsMatching:query withWeights:weights limit:limit offset:offset
+                                  usingBlock:^(int64_t rowid, BOOL *stop) {
+        
+        YapCollectionKey *ck = nil;
+        id object = nil;
+        [self->databaseTransaction getCollectionKey:&ck object:&object forRowid:rowid];
+        
+        block(ck.collection, ck.key, object, stop);
+    }];
+}
+
+- (void)enumerateBm25OrderedRowsMatching:(NSString *)query
+                             withWeights:(nullable NSArray<NSNumber *> *)weights
+                                   limit:(NSUInteger)limit
+                                  offset:(NSUInteger)offset
+                              usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, id metadata, BOOL *stop))block {
+    [self enumerateBm25OrderedRowidsMatching:query withWeights:weights limit:limit offset:offset
+                                  usingBlock:^(int64_t rowid, BOOL *stop) {
+        
+        YapCollectionKey *ck = nil;
+        id object = nil;
+        id metadata = nil;
+        [self->databaseTransaction getCollectionKey:&ck object:&object metadata:&metadata forRowid:rowid];
+        
+        block(ck.collection, ck.key, object, metadata, stop);
+    }];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Queries with Snippets
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)enumerateRowidsMatching:(NSString *)query
+             withSnippetOptions:(YapDatabaseFullTextSearchSnippetOptions *)inOptions
+                     usingBlock:
+            (void (NS_NOESCAPE^)(NSString *snippet, int64_t rowid, BOOL *stop))block
+{
+	if (block == nil) return;
+	if ([query length] == 0) return;
+	
+	if ([parentConnection->parent isContentless])
+	{
+		[self enumerateRebuiltSnippetsMatching:query withSnippetOptions:inOptions usingBlock:block];
+		return;
+	}
+	
+	sqlite3_stmt *statement = [parentConnection querySnippetStatement];
+	if (statement == NULL) return;
+	
+	YapDatabaseFullTextSearchSnippetOptions *options;
+	if (inOptions)
+		options = [inOptions copy];
+	else
+		options = [[YapDatabaseFullTextSearchSnippetOptions alloc] init]; // default snippet options
+	
+	BOOL stop = NO;
+	YapMutationStackItem_Bool *mutation = [parentConnection->mutationStack push]; // mutation during enum protection
+	
+	// SELECT "rowid", snippet("tableName", ?, ?, ?, ?, ?) FROM "tableName" WHERE "tableName" MATCH ?;
+	
+	int const column_idx_rowid        = SQLITE_COLUMN_START + 0;
+	int const column_idx_snippet      = SQLITE_COLUMN_START + 1;
+	
+	int const bind_idx_startMatchText = SQLITE_BIND_START + 0;
+	int const bind_idx_endMatchText   = SQLITE_BIND_START + 1;
+	int const bind_idx_ellipsesText   = SQLITE_BIND_START + 2;
+	int const bind_idx_columnIndex    = SQLITE_BIND_START + 3;
+	int const bind_idx_numTokens      = SQLITE_BIND_START + 4;
+	int const bind_idx_query          = SQLITE_BIND_START + 5;
+	
+	YapDatabaseString _startMatchText; MakeYapDatabaseString(&_startMatchText, options.startMatchText);
+	sqlite3_bind_text(statement, bind_idx_startMatchText, _startMatchText.str, _startMatchText.length, SQLITE_STATIC);
+	
+	YapDatabaseString _endMatchText; MakeYapDatabaseString(&_endMatchText, options.endMatchText);
+	sqlite3_bind_text(statement, bind_idx_endMatchText, _endMatchText.str, _endMatchText.length, SQLITE_STATIC);
+	
+	YapDatabaseString _ellipsesText; MakeYapDatabaseString(&_ellipsesText, options.ellipsesText);
+	sqlite3_bind_text(statement, bind_idx_ellipsesText, _ellipsesText.str, _ellipsesText.length, SQLITE_STATIC);
+
+	int columnIndex = -1;
+	if (options.columnName)
+	{
+		NSUInteger index = [parentConnection->parent->columnNames indexOfObject:options.columnName];
+		if (index == NSNotFound)
+		{
+			YDBLogWarn(@"Invalid snippet option: columnName(%@) not found", options.columnName);
+		}
+		else
+		{
+			columnIndex = (int)index;
+		}
+	}
+	sqlite3_bind_int(statement, bind_idx_columnIndex, columnIndex);
+	sqlite3_bind_int(statement, bind_idx_numTokens, options.numberOfTokens);
+	
+	YapDatabaseString _query; MakeYapDatabaseString(&_query, query);
+	sqlite3_bind_text(statement, bind_idx_query, _query.str, _query.length, SQLITE_STATIC);
+	
+	int status;
+	while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+	{
+		int64_t rowid = sqlite3_column_int64(statement, column_idx_rowid);
+		
+		const unsigned char *text = sqlite3_column_text(statement, column_idx_snippet);
 		int textSize = sqlite3_column_bytes(statement, column_idx_snippet);
 		
 		NSString *snippet = [[NSString alloc] initWithBytes:text length:textSize encoding:NSUTF8StringEncoding];
@@ -1303,6 +1746,21 @@ static NSString *const ext_key__version_deprecated = @"version";
 {
 	if ([query length] == 0) return nil;
 	
+	if ([parentConnection->parent isContentless])
+	{
+		__block NSString *snippet = nil;
+		[self enumerateRebuiltSnippetsForRowids:@[ @(rowid) ]
+		                               matching:query
+		                     withSnippetOptions:inOptions
+		                             usingBlock:^(NSString *rebuiltSnippet, int64_t __unused rebuiltRowid, BOOL *stop)
+		{
+			snippet = rebuiltSnippet;
+			*stop = YES;
+		}];
+		
+		return snippet;
+	}
+	
 	sqlite3_stmt *statement = [parentConnection rowidQuerySnippetStatement];
 	if (statement == NULL) return nil;
 	
@@ -1383,4 +1841,613 @@ static NSString *const ext_key__version_deprecated = @"version";
 	return snippet;
 }
 
+/**
+ * Fetches the snippets for the given rows (those that match the query) using a single FTS query
+ * (or as few as possible, if the number of rowids exceeds the host parameter limit).
+ *
+ * Rows that don't match the query are simply not enumerated.
+**/
+- (void)enumerateSnippetsForRowids:(NSArray<NSNumber *> *)rowids
+                          matching:(NSString *)query
+                withSnippetOptions:(YapDatabaseFullTextSearchSnippetOptions *)options
+                        usingBlock:(void (NS_NOESCAPE^)(NSString *snippet, int64_t rowid, BOOL *stop))block
+{
+	if ([parentConnection->parent isContentless])
+	{
+		[self enumerateRebuiltSnippetsForRowids:rowids matching:query withSnippetOptions:options usingBlock:block];
+	}
+	else
+	{
+		[self _enumerateSnippetsForRowids:rowids
+		                          inTable:[self tableName]
+		                           isFTS5:[parentConnection->parent isFTS5]
+		                         matching:query
+		               withSnippetOptions:options
+		                       usingBlock:block];
+	}
+}
+
+- (void)_enumerateSnippetsForRowids:(NSArray<NSNumber *> *)rowids
+                            inTable:(NSString *)tableName
+                             isFTS5:(BOOL)isFTS5
+                           matching:(NSString *)query
+                 withSnippetOptions:(YapDatabaseFullTextSearchSnippetOptions *)inOptions
+                         usingBlock:(void (NS_NOESCAPE^)(NSString *snippet, int64_t rowid, BOOL *stop))block
+{
+	if ([rowids count] == 0) return;
+	if ([query length] == 0) return;
+	if (block == NULL) return;
+	
+	YapDatabaseFullTextSearchSnippetOptions *options;
+	if (inOptions)
+		options = [inOptions copy];
+	else
+		options = [[YapDatabaseFullTextSearchSnippetOptions alloc] init]; // default snippet options
+	
+	int columnIndex = -1;
+	if (options.columnName)
+	{
+		NSUInteger index = [parentConnection->parent->columnNames indexOfObject:options.columnName];
+		if (index == NSNotFound)
+		{
+			YDBLogWarn(@"Invalid snippet option: columnName(%@) not found", options.columnName);
+		}
+		else
+		{
+			columnIndex = (int)index;
+		}
+	}
+	
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	NSString *snippetFunction = [parentConnection snippetFunctionForTable:tableName isFTS5:isFTS5];
+	
+	YapDatabaseString _startMatchText; MakeYapDatabaseString(&_startMatchText, options.startMatchText);
+	YapDatabaseString _endMatchText;   MakeYapDatabaseString(&_endMatchText, options.endMatchText);
+	YapDatabaseString _ellipsesText;   MakeYapDatabaseString(&_ellipsesText, options.ellipsesText);
+	YapDatabaseString _query;          MakeYapDatabaseString(&_query, query);
+	
+	// SELECT "rowid", snippet("tableName", ?1, ?2, ?3, ?4, ?5) FROM "tableName"
+	//   WHERE "rowid" IN (?, ?, ...) AND "tableName" MATCH ?;
+	
+	int const column_idx_rowid        = SQLITE_COLUMN_START + 0;
+	int const column_idx_snippet      = SQLITE_COLUMN_START + 1;
+	
+	int const bind_idx_startMatchText = SQLITE_BIND_START + 0;
+	int const bind_idx_endMatchText   = SQLITE_BIND_START + 1;
+	int const bind_idx_ellipsesText   = SQLITE_BIND_START + 2;
+	int const bind_idx_columnIndex    = SQLITE_BIND_START + 3;
+	int const bind_idx_numTokens      = SQLITE_BIND_START + 4;
+	int const bind_idx_rowids         = SQLITE_BIND_START + 5;
+	
+	NSUInteger maxHostParams = (NSUInteger) sqlite3_limit(db, SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+	NSUInteger maxRowidParams = maxHostParams - 6; // minus 5 snippet params & 1 query param
+	
+	NSUInteger offset = 0;
+	NSUInteger rowidsCount = [rowids count];
+	
+	BOOL stop = NO;
+	
+	do
+	{
+		NSUInteger numRowidParams = MIN(rowidsCount - offset, maxRowidParams);
+		
+		NSMutableString *string = [NSMutableString stringWithCapacity:(160 + (numRowidParams * 3))];
+		[string appendFormat:@"SELECT \"rowid\", %@ FROM \"%@\"", snippetFunction, tableName];
+		[string appendString:@" WHERE \"rowid\" IN ("];
+		
+		for (NSUInteger i = 0; i < numRowidParams; i++)
+		{
+			if (i == 0)
+				[string appendString:@"?"];
+			else
+				[string appendString:@", ?"];
+		}
+		
+		[string appendFormat:@") AND \"%@\" MATCH ?;", tableName];
+		
+		sqlite3_stmt *statement;
+		
+		int status = sqlite3_prepare_v2(db, [string UTF8String], -1, &statement, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogError(@"Error creating 'snippetsForRowids' statement: %d %s", status, sqlite3_errmsg(db));
+			break; // Break from do/while. Still need to free strings.
+		}
+		
+		sqlite3_bind_text(statement, bind_idx_startMatchText, _startMatchText.str, _startMatchText.length, SQLITE_STATIC);
+		sqlite3_bind_text(statement, bind_idx_endMatchText, _endMatchText.str, _endMatchText.length, SQLITE_STATIC);
+		sqlite3_bind_text(statement, bind_idx_ellipsesText, _ellipsesText.str, _ellipsesText.length, SQLITE_STATIC);
+		sqlite3_bind_int(statement, bind_idx_columnIndex, columnIndex);
+		sqlite3_bind_int(statement, bind_idx_numTokens, options.numberOfTokens);
+		
+		for (NSUInteger i = 0; i < numRowidParams; i++)
+		{
+			int64_t rowid = [rowids[offset + i] longLongValue];
+			
+			sqlite3_bind_int64(statement, (int)(bind_idx_rowids + i), rowid);
+		}
+		
+		int bind_idx_query = (int)(bind_idx_rowids + numRowidParams);
+		sqlite3_bind_text(statement, bind_idx_query, _query.str, _query.length, SQLITE_STATIC);
+		
+		while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+		{
+			int64_t rowid = sqlite3_column_int64(statement, column_idx_rowid);
+			
+			const unsigned char *text = sqlite3_column_text(statement, column_idx_snippet);
+			int textSize = sqlite3_column_bytes(statement, column_idx_snippet);
+			
+			NSString *snippet = [[NSString alloc] initWithBytes:text length:textSize encoding:NSUTF8StringEncoding];
+			
+			block(snippet, rowid, &stop);
+			
+			if (stop) break;
+		}
+		
+		if ((status != SQLITE_DONE) && !stop)
+		{
+			YDBLogError(@"sqlite_step error: %d %s", status, sqlite3_errmsg(db));
+		}
+		
+		sqlite3_finalize(statement);
+		
+		offset += numRowidParams;
+		
+	} while (!stop && (offset < rowidsCount));
+	
+	FreeYapDatabaseString(&_startMatchText);
+	FreeYapDatabaseString(&_endMatchText);
+	FreeYapDatabaseString(&_ellipsesText);
+	FreeYapDatabaseString(&_query);
+}
+
+/**
+ * Invokes the handler for the given row (using its current object/metadata),
+ * which fills the given dictionary with the text that was indexed for the row.
+**/
+- (BOOL)getIndexedValues:(NSMutableDictionary *)values forRowid:(int64_t)rowid
+{
+	__unsafe_unretained YapDatabaseFullTextSearchHandler *handler = parentConnection->parent->handler;
+	
+	YapCollectionKey *ck = nil;
+	
+	if (handler->blockType == YapDatabaseBlockTypeWithKey)
+	{
+		__unsafe_unretained YapDatabaseFullTextSearchWithKeyBlock block =
+		    (YapDatabaseFullTextSearchWithKeyBlock)handler->block;
+		
+		ck = [databaseTransaction collectionKeyForRowid:rowid];
+		if (ck == nil) return NO;
+		
+		block(databaseTransaction, values, ck.collection, ck.key);
+	}
+	else if (handler->blockType == YapDatabaseBlockTypeWithObject)
+	{
+		__unsafe_unretained YapDatabaseFullTextSearchWithObjectBlock block =
+		    (YapDatabaseFullTextSearchWithObjectBlock)handler->block;
+		
+		id object = nil;
+		if (![databaseTransaction getCollectionKey:&ck object:&object forRowid:rowid]) return NO;
+		
+		block(databaseTransaction, values, ck.collection, ck.key, object);
+	}
+	else if (handler->blockType == YapDatabaseBlockTypeWithMetadata)
+	{
+		__unsafe_unretained YapDatabaseFullTextSearchWithMetadataBlock block =
+		    (YapDatabaseFullTextSearchWithMetadataBlock)handler->block;
+		
+		id metadata = nil;
+		if (![databaseTransaction getCollectionKey:&ck metadata:&metadata forRowid:rowid]) return NO;
+		
+		block(databaseTransaction, values, ck.collection, ck.key, metadata);
+	}
+	else
+	{
+		__unsafe_unretained YapDatabaseFullTextSearchWithRowBlock block =
+		    (YapDatabaseFullTextSearchWithRowBlock)handler->block;
+		
+		id object = nil;
+		id metadata = nil;
+		if (![databaseTransaction getCollectionKey:&ck object:&object metadata:&metadata forRowid:rowid]) return NO;
+		
+		block(databaseTransaction, values, ck.collection, ck.key, object, metadata);
+	}
+	
+	return YES;
+}
+
+/**
+ * Generates snippets for a contentless FTS table.
+ *
+ * The indexed text of each row is rebuilt (via the handler), and inserted into the connection's temporary
+ * snippet table. The snippets are then generated from the temporary table, which is cleared afterwards.
+ *
+ * Callers should pass a limited number of rowids (e.g. the visible rows),
+ * as each one requires deserializing the row & invoking the handler.
+**/
+- (void)enumerateRebuiltSnippetsForRowids:(NSArray<NSNumber *> *)rowids
+                                 matching:(NSString *)query
+                       withSnippetOptions:(YapDatabaseFullTextSearchSnippetOptions *)options
+                               usingBlock:(void (NS_NOESCAPE^)(NSString *snippet, int64_t rowid, BOOL *stop))block
+{
+	if ([rowids count] == 0) return;
+	if ([query length] == 0) return;
+	if (block == NULL) return;
+	
+	if (![parentConnection prepareSnippetTable]) return;
+	
+	sqlite3_stmt *insertStatement = [parentConnection snippetTableInsertStatement];
+	sqlite3_stmt *clearStatement = [parentConnection snippetTableClearStatement];
+	
+	if (insertStatement == NULL || clearStatement == NULL) return;
+	
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	// Rebuild the text for each row
+	//
+	// INSERT INTO temp."snippetTableName" ("rowid", "column1", "column2", ...) VALUES (?, ?, ? ...)
+	
+	NSMutableDictionary *values =
+	  [NSMutableDictionary dictionaryWithSharedKeySet:parentConnection->parent->columnNamesSharedKeySet];
+	
+	for (NSNumber *rowidNumber in rowids)
+	{
+		int64_t rowid = [rowidNumber longLongValue];
+		
+		if (![self getIndexedValues:values forRowid:rowid] || ([values count] == 0))
+		{
+			[values removeAllObjects];
+			continue;
+		}
+		
+		sqlite3_bind_int64(insertStatement, SQLITE_BIND_START, rowid);
+		
+		int i = SQLITE_BIND_START + 1;
+		for (NSString *columnName in parentConnection->parent->columnNames)
+		{
+			NSString *columnValue = [values objectForKey:columnName];
+			if (columnValue)
+			{
+				sqlite3_bind_text(insertStatement, i, [columnValue UTF8String], -1, SQLITE_TRANSIENT);
+			}
+			
+			i++;
+		}
+		
+		int status = sqlite3_step(insertStatement);
+		if (status != SQLITE_DONE)
+		{
+			YDBLogError(@"Error executing 'snippetTableInsertStatement': %d %s", status, sqlite3_errmsg(db));
+		}
+		
+		sqlite3_clear_bindings(insertStatement);
+		sqlite3_reset(insertStatement);
+		
+		[values removeAllObjects];
+	}
+	
+	// Generate the snippets.
+	//
+	// We gather all the results before invoking the block,
+	// as the block may (indirectly) request more snippets, which would re-use the temporary table.
+	
+	NSMutableArray<NSString *> *snippets = [NSMutableArray arrayWithCapacity:[rowids count]];
+	NSMutableArray<NSNumber *> *snippetRowids = [NSMutableArray arrayWithCapacity:[rowids count]];
+	
+	[self _enumerateSnippetsForRowids:rowids
+	                          inTable:[parentConnection->parent snippetTableName]
+	                           isFTS5:YES
+	                         matching:query
+	               withSnippetOptions:options
+	                       usingBlock:^(NSString *snippet, int64_t rowid, BOOL __unused *stop)
+	{
+		[snippets addObject:(snippet ?: @"")];
+		[snippetRowids addObject:@(rowid)];
+	}];
+	
+	// DELETE FROM temp."snippetTableName";
+	
+	int status = sqlite3_step(clearStatement);
+	if (status != SQLITE_DONE)
+	{
+		YDBLogError(@"Error executing 'snippetTableClearStatement': %d %s", status, sqlite3_errmsg(db));
+	}
+	
+	sqlite3_reset(clearStatement);
+	
+	BOOL stop = NO;
+	
+	NSUInteger count = [snippets count];
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		block(snippets[i], [snippetRowids[i] longLongValue], &stop);
+		
+		if (stop) break;
+	}
+}
+
+/**
+ * Contentless version of enumerateRowidsMatching:withSnippetOptions:usingBlock:.
+ *
+ * The matching rowids are found via the index, and the snippets are then rebuilt in batches.
+**/
+- (void)enumerateRebuiltSnippetsMatching:(NSString *)query
+                      withSnippetOptions:(YapDatabaseFullTextSearchSnippetOptions *)options
+                              usingBlock:(void (NS_NOESCAPE^)(NSString *snippet, int64_t rowid, BOOL *stop))block
+{
+	NSUInteger const batchSize = 100;
+	
+	NSMutableArray<NSNumber *> *rowids = [NSMutableArray array];
+	
+	[self enumerateRowidsMatching:query usingBlock:^(int64_t rowid, BOOL __unused *stop) {
+		
+		[rowids addObject:@(rowid)];
+	}];
+	
+	__block BOOL stop = NO;
+	YapMutationStackItem_Bool *mutation = [parentConnection->mutationStack push]; // mutation during enum protection
+	
+	NSUInteger count = [rowids count];
+	for (NSUInteger offset = 0; offset < count; offset += batchSize)
+	{
+		NSArray<NSNumber *> *batch = [rowids subarrayWithRange:NSMakeRange(offset, MIN(batchSize, count - offset))];
+		
+		[self enumerateRebuiltSnippetsForRowids:batch
+		                               matching:query
+		                     withSnippetOptions:options
+		                             usingBlock:^(NSString *snippet, int64_t rowid, BOOL *innerStop)
+		{
+			block(snippet, rowid, &stop);
+			
+			if (stop || mutation.isMutated) *innerStop = YES;
+		}];
+		
+		if (stop || mutation.isMutated) break;
+	}
+	
+	if (!stop && mutation.isMutated)
+	{
+		@throw [databaseTransaction mutationDuringEnumerationException];
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Index Maintenance
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Internal method.
+ *
+ * Executes a special FTS command, such as:
+ *   fts5 : INSERT INTO "tableName"("tableName", rank) VALUES('automerge', 8);
+ * fts3/4 : INSERT INTO "tableName"("tableName") VALUES('automerge=8');
+ *
+ * Returns the number of changes made by the command (as reported by sqlite3_total_changes),
+ * or -1 if an error occurred.
+**/
+- (int)executeCommand:(NSString *)command withValue:(NSString *)value
+{
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	NSString *tableName = [self tableName];
+	NSString *sql = nil;
+	
+	if (value == nil)
+	{
+		sql = [NSString stringWithFormat:@"INSERT INTO \"%@\"(\"%@\") VALUES('%@');", tableName, tableName, command];
+	}
+	else if ([parentConnection->parent isFTS5])
+	{
+		sql = [NSString stringWithFormat:@"INSERT INTO \"%@\"(\"%@\", rank) VALUES('%@', %@);",
+		       tableName, tableName, command, value];
+	}
+	else
+	{
+		sql = [NSString stringWithFormat:@"INSERT INTO \"%@\"(\"%@\") VALUES('%@=%@');",
+		       tableName, tableName, command, value];
+	}
+	
+	int totalChangesBefore = sqlite3_total_changes(db);
+	
+	int status = sqlite3_exec(db, [sql UTF8String], NULL, NULL, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"(%@): Error executing '%@': %d %s",
+		            [self registeredName], sql, status, sqlite3_errmsg(db));
+		return -1;
+	}
+	
+	return (sqlite3_total_changes(db) - totalChangesBefore);
+}
+
+/**
+ * Internal method.
+ *
+ * Merge settings are stored within the FTS table itself.
+ * So if the table is re-created (e.g. the versionTag changed), we re-apply the settings that were configured.
+**/
+- (void)restoreMergeSettings
+{
+	NSArray<NSString *> *settings = @[ ext_key__automerge, ext_key__crisismerge, ext_key__usermerge ];
+	
+	for (NSString *setting in settings)
+	{
+		int value = 0;
+		if ([self getIntValue:&value forExtensionKey:setting persistent:YES])
+		{
+			[self executeCommand:setting withValue:[NSString stringWithFormat:@"%d", value]];
+		}
+	}
+}
+
+/**
+ * Internal method.
+ *
+ * Applies the given merge setting to the FTS table, and remembers it (so it can be restored if the table is re-created).
+**/
+- (BOOL)setMergeSetting:(NSString *)setting value:(NSInteger)value
+{
+	if (!databaseTransaction->isReadWriteTransaction)
+	{
+		YDBLogWarn(@"Method only allowed in readWrite transaction");
+		return NO;
+	}
+	
+	// fts5   : automerge, crisismerge & usermerge
+	// fts4   : automerge
+	// fts3   : (none)
+	
+	NSString *ftsVersion = parentConnection->parent->ftsVersion;
+	
+	BOOL supported = [parentConnection->parent isFTS5] ||
+	  ([ftsVersion isEqualToString:YapDatabaseFullTextSearchFTS4Version] && [setting isEqualToString:ext_key__automerge]);
+	
+	if (!supported)
+	{
+		YDBLogWarn(@"(%@): The '%@' setting isn't supported by %@", [self registeredName], setting, ftsVersion);
+		return NO;
+	}
+	
+	if ([self executeCommand:setting withValue:[NSString stringWithFormat:@"%ld", (long)value]] < 0)
+	{
+		return NO;
+	}
+	
+	[self setIntValue:(int)value forExtensionKey:setting persistent:YES];
+	return YES;
+}
+
+/**
+ * See header file for documentation.
+**/
+- (BOOL)setAutomerge:(NSInteger)automerge
+{
+	return [self setMergeSetting:ext_key__automerge value:automerge];
+}
+
+/**
+ * See header file for documentation.
+**/
+- (BOOL)setCrisismerge:(NSInteger)crisismerge
+{
+	return [self setMergeSetting:ext_key__crisismerge value:crisismerge];
+}
+
+/**
+ * See header file for documentation.
+**/
+- (BOOL)setUsermerge:(NSInteger)usermerge
+{
+	return [self setMergeSetting:ext_key__usermerge value:usermerge];
+}
+
+/**
+ * See header file for documentation.
+**/
+- (BOOL)mergeWithPageCount:(NSInteger)pageCount
+{
+	YDBLogAutoTrace();
+	
+	if (!databaseTransaction->isReadWriteTransaction)
+	{
+		YDBLogWarn(@"Method only allowed in readWrite transaction");
+		return NO;
+	}
+	
+	if (pageCount == 0) return NO;
+	
+	int changes = 0;
+	if ([parentConnection->parent isFTS5])
+	{
+		changes = [self executeCommand:@"merge" withValue:[NSString stringWithFormat:@"%ld", (long)pageCount]];
+	}
+	else
+	{
+		// fts3/4 : 'merge=X,Y'
+		// Where X is the number of pages, and Y is the minimum number of segments on a level to merge them.
+		//
+		// A negative pageCount (for fts5) means "merge even if few segments".
+		// So we map it to the smallest allowed Y value (2), and otherwise use the sqlite default (8).
+		
+		NSString *value = [NSString stringWithFormat:@"%ld,%d", (long)ABS(pageCount), (pageCount < 0) ? 2 : 8];
+		changes = [self executeCommand:@"merge" withValue:value];
+	}
+	
+	if (changes > 0) {
+		[parentConnection->mutationStack markAsMutated];
+	}
+	
+	// From the sqlite docs:
+	//
+	// If the difference in sqlite3_total_changes() (before & after) is less than two,
+	// then the merge did no work, and the index is fully merged.
+	
+	return (changes >= 2);
+}
+
+/**
+ * See header file for documentation.
+**/
+- (BOOL)optimize
+{
+	YDBLogAutoTrace();
+	
+	if (!databaseTransaction->isReadWriteTransaction)
+	{
+		YDBLogWarn(@"Method only allowed in readWrite transaction");
+		return NO;
+	}
+	
+	int changes = [self executeCommand:@"optimize" withValue:nil];
+	
+	[parentConnection->mutationStack markAsMutated];
+	return (changes >= 0);
+}
+
+/**
+ * See header file for documentation.
+**/
+- (NSUInteger)segmentCount
+{
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	// fts5   : Each segment has one or more entries in the %_idx table (one per leaf page).
+	// fts3/4 : Each segment has exactly one entry in the %_segdir table.
+	
+	NSString *tableName = [self tableName];
+	NSString *sql = nil;
+	
+	if ([parentConnection->parent isFTS5])
+		sql = [NSString stringWithFormat:@"SELECT COUNT(DISTINCT \"segid\") FROM \"%@_idx\";", tableName];
+	else
+		sql = [NSString stringWithFormat:@"SELECT COUNT(*) FROM \"%@_segdir\";", tableName];
+	
+	sqlite3_stmt *statement = NULL;
+	
+	int status = sqlite3_prepare_v2(db, [sql UTF8String], -1, &statement, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"(%@): Error creating 'segmentCount' statement: %d %s",
+		            [self registeredName], status, sqlite3_errmsg(db));
+		return 0;
+	}
+	
+	NSUInteger count = 0;
+	
+	status = sqlite3_step(statement);
+	if (status == SQLITE_ROW)
+	{
+		count = (NSUInteger)sqlite3_column_int64(statement, SQLITE_COLUMN_START);
+	}
+	else if (status != SQLITE_DONE)
+	{
+		YDBLogError(@"(%@): Error executing 'segmentCount' statement: %d %s",
+		            [self registeredName], status, sqlite3_errmsg(db));
+	}
+	
+	sqlite3_finalize(statement);
+	return count;
+}
+
 @end
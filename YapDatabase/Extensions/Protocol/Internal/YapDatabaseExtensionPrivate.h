@@ -9,6 +9,7 @@
 #import "YapDatabaseTransaction.h"
 
 #import "YapCollectionKey.h"
+#import "YapDatabaseQuery.h"
 
 #ifdef SQLITE_HAS_CODEC
   #import <SQLCipher/sqlite3.h>
@@ -117,6 +118,8 @@ typedef NS_OPTIONS(NSUInteger, YapDatabaseConnectionFlushMemoryFlags_Extension)
 - (void)didCommitTransaction;
 - (void)didRollbackTransaction;
 
+- (NSString *)rowidQueryStringForQuery:(YapDatabaseQuery *)query;
+
 #pragma mark Hooks
 
 /**
@@ -217,6 +217,24 @@
 	return nil;
 }
 
+/**
+ * Subclasses MAY implement this method.
+ * It's used by the combined query methods of YapDatabaseReadTransaction. (enumerateXMatchingQueries:usingBlock:)
+ *
+ * If the extension stores its rows in a table keyed by the rowid of the database2 table,
+ * then it can return a statement that selects the "rowid" of every row matching the given query.
+ * For example: SELECT "rowid" FROM "tableName" WHERE ...
+ *
+ * The statement is joined (on rowid) with the statements of the other extensions,
+ * so it must bind its parameters in the same order as query.queryParameters.
+ *
+ * The default implementation returns nil, meaning combined queries aren't supported.
+**/
+- (NSString *)rowidQueryStringForQuery:(YapDatabaseQuery __unused *)query
+{
+	return nil;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Hooks
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
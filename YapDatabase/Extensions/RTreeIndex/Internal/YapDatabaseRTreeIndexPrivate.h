@@ -24,6 +24,14 @@
  */
 #define YAP_DATABASE_RTREE_INDEX_CLASS_VERSION 1
 
+/**
+ * The name of the rtree query function used for nearest neighbor queries.
+ * It's registered with each connection's sqlite database (see YapDatabaseRTreeIndexConnection).
+ *
+ * SELECT "rowid" FROM "tableName" WHERE "rowid" MATCH yap_rtree_nearest(x, y, ...) LIMIT k;
+ */
+#define YAP_DATABASE_RTREE_NEAREST_FUNCTION "yap_rtree_nearest"
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark -
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -91,6 +99,8 @@
 	YapCache *queryCache;
 	NSUInteger queryCacheLimit;
 	
+	YapDatabaseSlowQueryLog *slowQueryLog;
+	
 	YapMutationStack_Bool *mutationStack;
 }
 
@@ -103,6 +113,7 @@
 - (sqlite3_stmt *)updateStatement;
 - (sqlite3_stmt *)removeStatement;
 - (sqlite3_stmt *)removeAllStatement;
+- (sqlite3_stmt *)unchangedStatement;
 
 @end
 
@@ -22,12 +22,49 @@ static const int ydbLogLevel = YDBLogLevelWarning;
 static const int ydbLogLevel = YDBLogLevelWarning;
 #endif
 
+/**
+ * The rtree query callback for YAP_DATABASE_RTREE_NEAREST_FUNCTION.
+ *
+ * The parameters are the coordinates of the point (one per dimension).
+ * The score of each node & entry is the squared distance from the point to the closest point within its box.
+ * The rtree module visits nodes & returns entries in order of increasing score (using a priority queue),
+ * so the results are in order of distance, and a LIMIT clause ends the search early.
+**/
+static int YDBRTreeNearestCallback(sqlite3_rtree_query_info *info)
+{
+	int dimensionCount = info->nCoord / 2;
+	if (info->nParam != dimensionCount) return SQLITE_ERROR;
+
+	double distanceSquared = 0.0;
+
+	for (int i = 0; i < dimensionCount; i++)
+	{
+		double point = info->aParam[i];
+		double min = info->aCoord[i * 2];
+		double max = info->aCoord[i * 2 + 1];
+
+		double delta = 0.0;
+		if (point < min)
+			delta = min - point;
+		else if (point > max)
+			delta = point - max;
+
+		distanceSquared += (delta * delta);
+	}
+
+	info->rScore = distanceSquared;
+	info->eWithin = PARTLY_WITHIN;
+
+	return SQLITE_OK;
+}
+
 @implementation YapDatabaseRTreeIndexConnection
 {
 	sqlite3_stmt *insertStatement;
 	sqlite3_stmt *updateStatement;
 	sqlite3_stmt *removeStatement;
 	sqlite3_stmt *removeAllStatement;
+	sqlite3_stmt *unchangedStatement;
 }
 
 @synthesize rTreeIndex = parent;
@@ -43,6 +80,8 @@ static const int ydbLogLevel = YDBLogLevelWarning;
 		queryCache = [[YapCache alloc] initWithCountLimit:queryCacheLimit];
 		queryCache.allowedKeyClasses = [NSSet setWithObject:[NSString class]];
 		queryCache.allowedObjectClasses = [NSSet setWithObject:[YapDatabaseStatement class]];
+
+		[self registerQueryFunctions];
 	}
 	return self;
 }
@@ -59,6 +98,24 @@ static const int ydbLogLevel = YDBLogLevelWarning;
 	sqlite_finalize_null(&updateStatement);
 	sqlite_finalize_null(&removeStatement);
 	sqlite_finalize_null(&removeAllStatement);
+	sqlite_finalize_null(&unchangedStatement);
+}
+
+/**
+ * Registers the rtree query function(s) used by the transaction with our sqlite connection.
+ * Re-registering the same function (for another rtree extension) simply replaces it.
+**/
+- (void)registerQueryFunctions
+{
+	sqlite3 *db = databaseConnection->db;
+
+	int status = sqlite3_rtree_query_callback(db, YAP_DATABASE_RTREE_NEAREST_FUNCTION,
+	                                          YDBRTreeNearestCallback, NULL, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Error registering rtree query function (%s): %d %s",
+		            YAP_DATABASE_RTREE_NEAREST_FUNCTION, status, sqlite3_errmsg(db));
+	}
 }
 
 /**
@@ -166,6 +223,93 @@ static const int ydbLogLevel = YDBLogLevelWarning;
 		dispatch_async(databaseConnection->connectionQueue, block);
 }
 
+- (NSTimeInterval)slowQueryThreshold
+{
+	__block NSTimeInterval result = 0.0;
+
+	dispatch_block_t block = ^{
+
+		result = self->slowQueryLog.threshold;
+	};
+
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_sync(databaseConnection->connectionQueue, block);
+
+	return result;
+}
+
+- (void)setSlowQueryThreshold:(NSTimeInterval)newSlowQueryThreshold
+{
+	dispatch_block_t block = ^{
+
+		if (newSlowQueryThreshold > 0.0)
+		{
+			if (self->slowQueryLog == nil)
+				self->slowQueryLog = [[YapDatabaseSlowQueryLog alloc] initWithThreshold:newSlowQueryThreshold];
+			else
+				self->slowQueryLog.threshold = newSlowQueryThreshold;
+		}
+		else
+		{
+			self->slowQueryLog = nil;
+		}
+	};
+
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_async(databaseConnection->connectionQueue, block);
+}
+
+- (NSArray<YapDatabaseSlowQuery *> *)slowQueries
+{
+	__block NSArray<YapDatabaseSlowQuery *> *result = nil;
+
+	dispatch_block_t block = ^{
+
+		result = [self->slowQueryLog queries];
+	};
+
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_sync(databaseConnection->connectionQueue, block);
+
+	return result ?: [NSArray array];
+}
+
+- (NSArray<YapDatabaseSlowQuerySummary *> *)slowQuerySummary
+{
+	__block NSArray<YapDatabaseSlowQuerySummary *> *result = nil;
+
+	dispatch_block_t block = ^{
+
+		result = [self->slowQueryLog summaries];
+	};
+
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_sync(databaseConnection->connectionQueue, block);
+
+	return result ?: [NSArray array];
+}
+
+- (void)removeAllSlowQueries
+{
+	dispatch_block_t block = ^{
+
+		[self->slowQueryLog removeAllQueries];
+	};
+
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_async(databaseConnection->connectionQueue, block);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Transactions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -324,6 +468,27 @@ static const int ydbLogLevel = YDBLogLevelWarning;
 	return *statement;
 }
 
+- (sqlite3_stmt *)unchangedStatement
+{
+	sqlite3_stmt **statement = &unchangedStatement;
+	if (*statement == NULL)
+	{
+		NSMutableString *string = [NSMutableString stringWithCapacity:100];
+		[string appendFormat:@"SELECT 1 FROM \"%@\" WHERE \"rowid\" = ?", [parent tableName]];
+
+		for (NSString *columnName in parent->setup)
+		{
+			[string appendFormat:@" AND \"%@\" IS ?", columnName];
+		}
+
+		[string appendString:@";"];
+
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+
+	return *statement;
+}
+
 - (sqlite3_stmt *)removeStatement
 {
 	sqlite3_stmt **statement = &removeStatement;
@@ -50,6 +50,53 @@ NS_ASSUME_NONNULL_BEGIN
 - (BOOL)enumerateRowsMatchingQuery:(YapDatabaseQuery *)query
                         usingBlock:
                             (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, _Nullable id metadata, BOOL *stop))block;
+
+/**
+ * These methods enumerate the rows closest to the given point, in order of increasing distance.
+ * This is a k-nearest-neighbor query, performed as a best-first search over the rtree.
+ * So the search ends as soon as `limit` rows have been found (or you set stop to YES),
+ * and only the nodes of the rtree that could contain a closer row are visited.
+ *
+ * The point must have one coordinate per dimension of the rtree, in the same order as the setup's columns.
+ * For example, for an rtree with columns (minLon, maxLon, minLat, maxLat):
+ *
+ * [[transaction ext:@"idx"] enumerateKeysNearestToPoint:@[ @(lon), @(lat) ]
+ *                                                 limit:10
+ *                                            usingBlock:^(NSString *collection, NSString *key, BOOL *stop) {
+ *
+ *     // The 10 closest rows, closest first
+ * }];
+ *
+ * The distance to a row is the euclidean distance from the point to the closest point within the row's box.
+ * (So a row whose box contains the point has a distance of zero.)
+ * Keep in mind that the rtree module stores coordinates as 32-bit floats, and the distance is computed using those.
+ *
+ * @param limit
+ *   The maximum number of rows to enumerate.
+ *   If zero, all rows are enumerated (in order of increasing distance).
+ *
+ * @return NO if the point is invalid (or there was a problem executing the query). YES otherwise.
+ */
+
+- (BOOL)enumerateKeysNearestToPoint:(NSArray<NSNumber *> *)point
+                              limit:(NSUInteger)limit
+                         usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block;
+
+- (BOOL)enumerateKeysAndMetadataNearestToPoint:(NSArray<NSNumber *> *)point
+                                         limit:(NSUInteger)limit
+                                    usingBlock:
+                            (void (NS_NOESCAPE^)(NSString *collection, NSString *key, _Nullable id metadata, BOOL *stop))block;
+
+- (BOOL)enumerateKeysAndObjectsNearestToPoint:(NSArray<NSNumber *> *)point
+                                        limit:(NSUInteger)limit
+                                   usingBlock:
+                            (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, BOOL *stop))block;
+
+- (BOOL)enumerateRowsNearestToPoint:(NSArray<NSNumber *> *)point
+                              limit:(NSUInteger)limit
+                         usingBlock:
+                            (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, _Nullable id metadata, BOOL *stop))block;
+
 /**
  * Skips the enumeration process, and just gives you the count of matching rows.
  */
@@ -72,6 +119,19 @@ NS_ASSUME_NONNULL_BEGIN
 - (NSDictionary<NSString*, NSNumber*> *)rowidsForKeys:(NSArray<NSString *> *)keys
 										 inCollection:(nullable NSString *)collection;
 
+/**
+ * Returns the output of EXPLAIN QUERY PLAN for the given query (one line per step of the plan).
+ * The plan is for the statement executed by the enumerate methods,
+ * which joins the matching rows to the database table (to fetch the key, object & metadata in the same pass).
+ *
+ * This is useful for checking that the rtree is used to constrain the query.
+ * A plan such as "SCAN ... VIRTUAL TABLE INDEX 2:D0B1" means the rtree constraints are applied,
+ * whereas "INDEX 2:" (with no constraints) means every row in the rtree is visited.
+ *
+ * For more information, see the sqlite docs: https://www.sqlite.org/eqp.html
+ */
+- (nullable NSString *)queryPlanForQuery:(YapDatabaseQuery *)query;
+
 @end
 
 NS_ASSUME_NONNULL_END
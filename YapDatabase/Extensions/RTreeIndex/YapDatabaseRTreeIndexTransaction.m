@@ -1,6 +1,7 @@
 #import "YapDatabaseRTreeIndexTransaction.h"
 #import "YapDatabaseRTreeIndexPrivate.h"
 #import "YapDatabaseStatement.h"
+#import "YapNull.h"
 
 #import "YapDatabasePrivate.h"
 #import "YapDatabaseExtensionPrivate.h"
@@ -25,6 +26,31 @@ static NSString *const ext_key_classVersion       = @"classVersion";
 static NSString *const ext_key_versionTag         = @"versionTag";
 static NSString *const ext_key_version_deprecated = @"version";
 
+/**
+ * The rtree module stores each coordinate as a 32-bit float,
+ * rounding the min value of each dimension down, and the max value up (so the box always contains the original).
+ *
+ * These functions replicate that rounding (see rtreeValueDown & rtreeValueUp in sqlite's rtree.c),
+ * so we can compare new values against the stored values.
+**/
+static double YDBRTreeValueDown(double d)
+{
+	float f = (float)d;
+	if (f > d) {
+		f = (float)(d * (d < 0 ? (1.0 + 1.0/8388608.0) : (1.0 - 1.0/8388608.0)));
+	}
+	return f;
+}
+
+static double YDBRTreeValueUp(double d)
+{
+	float f = (float)d;
+	if (f < d) {
+		f = (float)(d * (d < 0 ? (1.0 - 1.0/8388608.0) : (1.0 + 1.0/8388608.0)));
+	}
+	return f;
+}
+
 
 @implementation YapDatabaseRTreeIndexTransaction
 
@@ -494,6 +520,69 @@ static NSString *const ext_key_version_deprecated = @"version";
 	[parentConnection->mutationStack markAsMutated];
 }
 
+/**
+ * Returns YES if the index already contains the given rowid, with the values in the 'blockDict' ivar.
+ * In which case there's no need to re-write the row (and re-balance the rtree).
+**/
+- (BOOL)isUnchangedRowid:(int64_t)rowid
+{
+	sqlite3_stmt *statement = [parentConnection unchangedStatement];
+	if (statement == NULL)
+		return NO;
+
+	// SELECT 1 FROM "tableName" WHERE "rowid" = ? AND "column1" IS ? AND "column2" IS ? ...;
+
+	int bind_idx = SQLITE_BIND_START;
+
+	sqlite3_bind_int64(statement, bind_idx, rowid);
+	bind_idx++;
+
+	BOOL bound = YES;
+	NSUInteger i = 0;
+
+	for (NSString *columnName in parentConnection->parent->setup)
+	{
+		id columnValue = [parentConnection->blockDict objectForKey:columnName];
+		if (![columnValue isKindOfClass:[NSNumber class]])
+		{
+			// Let addRowid:isNew: handle (and log) the error
+			bound = NO;
+			break;
+		}
+
+		// Columns are (min, max) pairs
+		double num = [(NSNumber *)columnValue doubleValue];
+		if ((i % 2) == 0)
+			sqlite3_bind_double(statement, bind_idx, YDBRTreeValueDown(num));
+		else
+			sqlite3_bind_double(statement, bind_idx, YDBRTreeValueUp(num));
+
+		bind_idx++;
+		i++;
+	}
+
+	BOOL unchanged = NO;
+
+	if (bound)
+	{
+		int status = sqlite3_step(statement);
+		if (status == SQLITE_ROW)
+		{
+			unchanged = YES;
+		}
+		else if (status != SQLITE_DONE)
+		{
+			YDBLogError(@"Error executing 'unchangedStatement': %d %s",
+			            status, sqlite3_errmsg(databaseTransaction->connection->db));
+		}
+	}
+
+	sqlite3_clear_bindings(statement);
+	sqlite3_reset(statement);
+
+	return unchanged;
+}
+
 - (void)removeRowid:(int64_t)rowid
 {
 	YDBLogAutoTrace();
@@ -721,9 +810,12 @@ static NSString *const ext_key_version_deprecated = @"version";
 	else
 	{
 		// Add values to index (or update them).
-		// This was an update operation, so we need to insert or update.
+		// If this was an update operation, and the indexed values didn't change, we can skip the write.
 
-		[self addRowid:rowid isNew:NO];
+		if (isInsert || ![self isUnchangedRowid:rowid])
+		{
+			[self addRowid:rowid isNew:NO];
+		}
 		[parentConnection->blockDict removeAllObjects];
 	}
 }
@@ -986,17 +1078,79 @@ static NSString *const ext_key_version_deprecated = @"version";
 	[self removeAllRowids];
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Utilities
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Adds the query to the connection's slow query log (if the elapsed time exceeds the threshold).
+ * Only invoke this method if the log is enabled (parentConnection->slowQueryLog is non-nil).
+**/
+- (void)recordQueryString:(NSString *)fullQueryString
+               parameters:(NSArray *)queryParams
+                 rowCount:(NSUInteger)rowCount
+                startTime:(CFAbsoluteTime)startTime
+{
+	NSTimeInterval elapsed = CFAbsoluteTimeGetCurrent() - startTime;
+
+	[parentConnection->slowQueryLog recordQueryString:fullQueryString
+	                                       parameters:queryParams
+	                                         rowCount:rowCount
+	                                         duration:elapsed];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Enumerate
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-- (BOOL)_enumerateRowidsMatchingQuery:(YapDatabaseQuery *)query
-                           usingBlock:(void (NS_NOESCAPE^)(int64_t rowid, BOOL *stop))block
+/**
+ * Returns the statement executed by the enumerate methods for the given query.
+**/
+- (NSString *)enumerateQueryStringForQuery:(YapDatabaseQuery *)query
+                               withObjects:(BOOL)withObjects
+                                  metadata:(BOOL)withMetadata
 {
-	// Create full query using given filtering clause(s)
+	// The rtree query is nested within a subquery, so the column names within the given filtering clause(s)
+	// can't conflict with those in the database2 table (e.g. "rowid").
+	// The extra level of nesting (with "LIMIT -1") prevents sqlite from flattening the subquery into the join,
+	// which would discard its ORDER BY clause.
+	// And the CROSS JOIN ensures the matches are the outer loop, so the results are returned in that order.
+
+	NSMutableString *fullQueryString = [NSMutableString stringWithCapacity:256];
+	[fullQueryString appendString:@"SELECT \"database2\".\"collection\", \"database2\".\"key\""];
+
+	if (withObjects)
+		[fullQueryString appendString:@", \"database2\".\"data\""];
+	if (withMetadata)
+		[fullQueryString appendString:@", \"database2\".\"metadata\""];
+
+	[fullQueryString appendFormat:
+	  @" FROM (SELECT \"rowid\" FROM (SELECT \"rowid\" FROM \"%@\" %@) LIMIT -1) AS \"matches\""
+	  @" CROSS JOIN \"database2\" ON \"database2\".\"rowid\" = \"matches\".\"rowid\";",
+	  [self tableName], query.queryString];
+
+	return fullQueryString;
+}
 
-	NSString *fullQueryString =
-	    [NSString stringWithFormat:@"SELECT \"rowid\" FROM \"%@\" %@;", [self tableName], query.queryString];
+/**
+ * Internal method.
+ *
+ * Executes the query as a single statement that joins the rtree table to the database2 table (on rowid),
+ * so the collection, key, object & metadata are fetched in the same pass.
+ * This avoids a separate lookup (or 2) in the database2 table for every matching row.
+ *
+ * Objects & metadata that are already in the connection's cache are taken from the cache (and not deserialized).
+**/
+- (BOOL)_enumerateRowsMatchingQuery:(YapDatabaseQuery *)query
+                        withObjects:(BOOL)withObjects
+                           metadata:(BOOL)withMetadata
+                         usingBlock:(void (NS_NOESCAPE^)(YapCollectionKey *ck, id object, id metadata, BOOL *stop))block
+{
+	// Create full query using given filtering clause(s).
+
+	NSString *fullQueryString = [self enumerateQueryStringForQuery:query withObjects:withObjects metadata:withMetadata];
+
+	CFAbsoluteTime startTime = parentConnection->slowQueryLog ? CFAbsoluteTimeGetCurrent() : 0.0;
 
 	// Turn query into compiled sqlite statement.
 	// Use cache if possible.
@@ -1030,75 +1184,38 @@ static NSString *const ext_key_version_deprecated = @"version";
 
 	// Bind query parameters appropriately.
 
-	int bind_idx = SQLITE_BIND_START;
-	for (id value in query.queryParameters)
-	{
-		if ([value isKindOfClass:[NSNumber class]])
-		{
-			__unsafe_unretained NSNumber *cast = (NSNumber *)value;
-
-			CFNumberType numType = CFNumberGetType((__bridge CFNumberRef)cast);
-
-			if (numType == kCFNumberFloatType   ||
-			    numType == kCFNumberFloat32Type ||
-			    numType == kCFNumberFloat64Type ||
-			    numType == kCFNumberDoubleType  ||
-			    numType == kCFNumberCGFloatType  )
-			{
-				double num = [cast doubleValue];
-				sqlite3_bind_double(statement, bind_idx, num);
-			}
-			else
-			{
-				int64_t num = [cast longLongValue];
-				sqlite3_bind_int64(statement, bind_idx, (sqlite3_int64)num);
-			}
-		}
-		else if ([value isKindOfClass:[NSDate class]])
-		{
-			__unsafe_unretained NSDate *cast = (NSDate *)value;
-
-			double num = [cast timeIntervalSinceReferenceDate];
-			sqlite3_bind_double(statement, bind_idx, num);
-		}
-		else if ([value isKindOfClass:[NSString class]])
-		{
-			__unsafe_unretained NSString *cast = (NSString *)value;
+	[databaseTransaction bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
 
-			sqlite3_bind_text(statement, bind_idx, [cast UTF8String], -1, SQLITE_TRANSIENT);
-		}
-		else
-		{
-			YDBLogWarn(@"Unable to bind value for with unsupported class: %@", NSStringFromClass([value class]));
-		}
+	// Enumerate query results
 
-		bind_idx++;
-	}
+	int const column_idx_collection = SQLITE_COLUMN_START + 0;
+	int const column_idx_key        = SQLITE_COLUMN_START + 1;
+	int const column_idx_data       = withObjects  ? (column_idx_key + 1) : -1;
+	int const column_idx_metadata   = withMetadata ? (column_idx_key + (withObjects ? 2 : 1)) : -1;
 
-	// Enumerate query results
+	NSUInteger rowCount = 0;
 
 	BOOL stop = NO;
 	YapMutationStackItem_Bool *mutation = [parentConnection->mutationStack push]; // mutation during enum protection
 
-	int status;
-	while ((status = sqlite3_step(statement)) == SQLITE_ROW)
-	{
-		int64_t rowid = sqlite3_column_int64(statement, SQLITE_COLUMN_START);
-
-		block(rowid, &stop);
+	int status = [databaseTransaction _enumerateRowsWithStatement:statement
+	                                             collectionColumn:column_idx_collection
+	                                                    keyColumn:column_idx_key
+	                                                 objectColumn:column_idx_data
+	                                               metadataColumn:column_idx_metadata
+	                                                     mutation:mutation
+	                                                         stop:&stop
+	                                                     rowCount:&rowCount
+	                                                   usingBlock:block];
 
-		if (stop || mutation.isMutated) break;
-	}
+	sqlite3_clear_bindings(statement);
+	sqlite3_reset(statement);
 
-	if ((status != SQLITE_DONE) && !stop && !mutation.isMutated)
+	if (parentConnection->slowQueryLog)
 	{
-		YDBLogError(@"sqlite_step error: %d %s",
-		            status, sqlite3_errmsg(databaseTransaction->connection->db));
+		[self recordQueryString:fullQueryString parameters:query.queryParameters rowCount:rowCount startTime:startTime];
 	}
 
-	sqlite3_clear_bindings(statement);
-	sqlite3_reset(statement);
-
 	if (!stop && mutation.isMutated)
 	{
 		@throw [self mutationDuringEnumerationException];
@@ -1113,10 +1230,11 @@ static NSString *const ext_key_version_deprecated = @"version";
 	if (query == nil) return NO;
 	if (block == nil) return NO;
 
-	BOOL result = [self _enumerateRowidsMatchingQuery:query usingBlock:^(int64_t rowid, BOOL *stop) {
-
-		YapCollectionKey *ck = [self->databaseTransaction collectionKeyForRowid:rowid];
-
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:NO
+	                                       metadata:NO
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
 		block(ck.collection, ck.key, stop);
 	}];
 
@@ -1130,12 +1248,11 @@ static NSString *const ext_key_version_deprecated = @"version";
 	if (query == nil) return NO;
 	if (block == nil) return NO;
 
-	BOOL result = [self _enumerateRowidsMatchingQuery:query usingBlock:^(int64_t rowid, BOOL *stop) {
-
-		YapCollectionKey *ck = nil;
-		id metadata = nil;
-		[self->databaseTransaction getCollectionKey:&ck metadata:&metadata forRowid:rowid];
-
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:NO
+	                                       metadata:YES
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
 		block(ck.collection, ck.key, metadata, stop);
 	}];
 
@@ -1149,12 +1266,11 @@ static NSString *const ext_key_version_deprecated = @"version";
 	if (query == nil) return NO;
 	if (block == nil) return NO;
 
-	BOOL result = [self _enumerateRowidsMatchingQuery:query usingBlock:^(int64_t rowid, BOOL *stop) {
-
-		YapCollectionKey *ck = nil;
-		id object = nil;
-		[self->databaseTransaction getCollectionKey:&ck object:&object forRowid:rowid];
-
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:YES
+	                                       metadata:NO
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
 		block(ck.collection, ck.key, object, stop);
 	}];
 
@@ -1168,13 +1284,146 @@ static NSString *const ext_key_version_deprecated = @"version";
 	if (query == nil) return NO;
 	if (block == nil) return NO;
 
-	BOOL result = [self _enumerateRowidsMatchingQuery:query usingBlock:^(int64_t rowid, BOOL *stop) {
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:YES
+	                                       metadata:YES
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
+		block(ck.collection, ck.key, object, metadata, stop);
+	}];
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Nearest Neighbors
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Internal method.
+ *
+ * Returns a query for the rows closest to the given point, in order of increasing distance.
+ * The rtree module performs a best-first search (see YDBRTreeNearestCallback),
+ * so the LIMIT clause ends the search as soon as enough rows have been found.
+ *
+ * Returns nil if the point doesn't have exactly one coordinate (NSNumber) per dimension of the rtree.
+**/
+- (YapDatabaseQuery *)queryForNearestToPoint:(NSArray<NSNumber *> *)point limit:(NSUInteger)limit
+{
+	NSUInteger dimensionCount = [parentConnection->parent->setup count] / 2;
+	if ([point count] != dimensionCount)
+	{
+		YDBLogWarn(@"Invalid point: has %lu coordinate(s), but the rtree has %lu dimension(s)",
+		           (unsigned long)[point count], (unsigned long)dimensionCount);
+		return nil;
+	}
+
+	NSMutableString *queryString = [NSMutableString stringWithCapacity:64];
+	NSMutableArray *queryParameters = [NSMutableArray arrayWithCapacity:(dimensionCount + 1)];
+
+	[queryString appendFormat:@"WHERE \"rowid\" MATCH %s(", YAP_DATABASE_RTREE_NEAREST_FUNCTION];
+
+	for (id coordinate in point)
+	{
+		if (![coordinate isKindOfClass:[NSNumber class]])
+		{
+			YDBLogWarn(@"Invalid point: coordinate with unsupported class: %@. Coordinates require NSNumber.",
+			           NSStringFromClass([coordinate class]));
+			return nil;
+		}
+
+		[queryString appendString:([queryParameters count] == 0) ? @"?" : @", ?"];
+		[queryParameters addObject:@([(NSNumber *)coordinate doubleValue])];
+	}
+
+	[queryString appendString:@")"];
+
+	if (limit > 0)
+	{
+		[queryString appendString:@" LIMIT ?"];
+		[queryParameters addObject:@(limit)];
+	}
+
+	return [YapDatabaseQuery queryWithString:queryString parameters:queryParameters];
+}
+
+- (BOOL)enumerateKeysNearestToPoint:(NSArray<NSNumber *> *)point
+                              limit:(NSUInteger)limit
+                         usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block
+{
+	if (block == nil) return NO;
+
+	YapDatabaseQuery *query = [self queryForNearestToPoint:point limit:limit];
+	if (query == nil) return NO;
+
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:NO
+	                                       metadata:NO
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
+		block(ck.collection, ck.key, stop);
+	}];
+
+	return result;
+}
+
+- (BOOL)enumerateKeysAndMetadataNearestToPoint:(NSArray<NSNumber *> *)point
+                                         limit:(NSUInteger)limit
+                                    usingBlock:
+                            (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id metadata, BOOL *stop))block
+{
+	if (block == nil) return NO;
+
+	YapDatabaseQuery *query = [self queryForNearestToPoint:point limit:limit];
+	if (query == nil) return NO;
+
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:NO
+	                                       metadata:YES
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
+		block(ck.collection, ck.key, metadata, stop);
+	}];
+
+	return result;
+}
+
+- (BOOL)enumerateKeysAndObjectsNearestToPoint:(NSArray<NSNumber *> *)point
+                                        limit:(NSUInteger)limit
+                                   usingBlock:
+                            (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, BOOL *stop))block
+{
+	if (block == nil) return NO;
+
+	YapDatabaseQuery *query = [self queryForNearestToPoint:point limit:limit];
+	if (query == nil) return NO;
+
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:YES
+	                                       metadata:NO
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
+		block(ck.collection, ck.key, object, stop);
+	}];
+
+	return result;
+}
+
+- (BOOL)enumerateRowsNearestToPoint:(NSArray<NSNumber *> *)point
+                              limit:(NSUInteger)limit
+                         usingBlock:
+                            (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, id metadata, BOOL *stop))block
+{
+	if (block == nil) return NO;
 
-		YapCollectionKey *ck = nil;
-		id object = nil;
-		id metadata = nil;
-		[self->databaseTransaction getCollectionKey:&ck object:&object metadata:&metadata forRowid:rowid];
+	YapDatabaseQuery *query = [self queryForNearestToPoint:point limit:limit];
+	if (query == nil) return NO;
 
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:YES
+	                                       metadata:YES
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
 		block(ck.collection, ck.key, object, metadata, stop);
 	}];
 
@@ -1193,6 +1442,8 @@ static NSString *const ext_key_version_deprecated = @"version";
 	    [NSString stringWithFormat:@"SELECT COUNT(*) AS NumberOfRows FROM \"%@\" %@;",
 	                                                           [self tableName], query.queryString];
 
+	CFAbsoluteTime startTime = parentConnection->slowQueryLog ? CFAbsoluteTimeGetCurrent() : 0.0;
+
 	// Turn query into compiled sqlite statement.
 	// Use cache if possible.
 
@@ -1225,50 +1476,7 @@ static NSString *const ext_key_version_deprecated = @"version";
 
 	// Bind query parameters appropriately.
 
-	int bind_idx = SQLITE_BIND_START;
-	for (id value in query.queryParameters)
-	{
-		if ([value isKindOfClass:[NSNumber class]])
-		{
-			__unsafe_unretained NSNumber *cast = (NSNumber *)value;
-
-			CFNumberType numType = CFNumberGetType((__bridge CFNumberRef)cast);
-
-			if (numType == kCFNumberFloatType   ||
-			    numType == kCFNumberFloat32Type ||
-			    numType == kCFNumberFloat64Type ||
-			    numType == kCFNumberDoubleType  ||
-			    numType == kCFNumberCGFloatType  )
-			{
-				double num = [cast doubleValue];
-				sqlite3_bind_double(statement, bind_idx, num);
-			}
-			else
-			{
-				int64_t num = [cast longLongValue];
-				sqlite3_bind_int64(statement, bind_idx, (sqlite3_int64)num);
-			}
-		}
-		else if ([value isKindOfClass:[NSDate class]])
-		{
-			__unsafe_unretained NSDate *cast = (NSDate *)value;
-
-			double num = [cast timeIntervalSinceReferenceDate];
-			sqlite3_bind_double(statement, bind_idx, num);
-		}
-		else if ([value isKindOfClass:[NSString class]])
-		{
-			__unsafe_unretained NSString *cast = (NSString *)value;
-
-			sqlite3_bind_text(statement, bind_idx, [cast UTF8String], -1, SQLITE_TRANSIENT);
-		}
-		else
-		{
-			YDBLogWarn(@"Unable to bind value for with unsupported class: %@", NSStringFromClass([value class]));
-		}
-
-		bind_idx++;
-	}
+	[databaseTransaction bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
 
 	// Execute query
 
@@ -1290,6 +1498,11 @@ static NSString *const ext_key_version_deprecated = @"version";
 	sqlite3_clear_bindings(statement);
 	sqlite3_reset(statement);
 
+	if (parentConnection->slowQueryLog)
+	{
+		[self recordQueryString:fullQueryString parameters:query.queryParameters rowCount:(result ? 1 : 0) startTime:startTime];
+	}
+
 	if (countPtr) *countPtr = count;
 	return result;
 }
@@ -1328,6 +1541,76 @@ static NSString *const ext_key_version_deprecated = @"version";
 	return results;
 }
 
+/**
+ * Returns the output of EXPLAIN QUERY PLAN for the given query (one line per step of the plan).
+ * This is the statement that would be executed by the enumerate methods.
+ *
+ * For example:
+ * "CO-ROUTINE matches
+ *  SCAN rTreeIndex_idx VIRTUAL TABLE INDEX 2:D0B1D2B3
+ *  SCAN matches
+ *  SEARCH database2 USING INTEGER PRIMARY KEY (rowid=?)"
+ *
+ * For more information, see the sqlite docs: https://www.sqlite.org/eqp.html
+**/
+- (NSString *)queryPlanForQuery:(YapDatabaseQuery *)query
+{
+	if (query == nil) return nil;
+
+	NSString *fullQueryString = [@"EXPLAIN QUERY PLAN "
+	  stringByAppendingString:[self enumerateQueryStringForQuery:query withObjects:YES metadata:YES]];
+
+	sqlite3 *db = databaseTransaction->connection->db;
+	sqlite3_stmt *statement = NULL;
+
+	int status = sqlite3_prepare_v2(db, [fullQueryString UTF8String], -1, &statement, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Error creating query:\n query: '%@'\n error: %d %s",
+		            fullQueryString, status, sqlite3_errmsg(db));
+		return nil;
+	}
+
+	[databaseTransaction bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
+
+	// id|parent|notused|detail
+	// 0 |1     |2      |3
+
+	int const column_idx_detail = SQLITE_COLUMN_START + 3;
+
+	NSMutableArray<NSString *> *lines = [NSMutableArray array];
+
+	while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+	{
+		const unsigned char *text = sqlite3_column_text(statement, column_idx_detail);
+		int textSize = sqlite3_column_bytes(statement, column_idx_detail);
+
+		NSString *detail = [[NSString alloc] initWithBytes:text length:textSize encoding:NSUTF8StringEncoding];
+		if (detail) {
+			[lines addObject:detail];
+		}
+	}
+
+	if (status != SQLITE_DONE)
+	{
+		YDBLogError(@"sqlite_step error: %d %s", status, sqlite3_errmsg(db));
+	}
+
+	sqlite3_finalize(statement);
+	return [lines componentsJoinedByString:@"\n"];
+}
+
+/**
+ * Optional override method from YapDatabaseExtensionTransaction.
+ * Used by the combined query methods of YapDatabaseReadTransaction.
+**/
+- (NSString *)rowidQueryStringForQuery:(YapDatabaseQuery *)query
+{
+	if (query.isAggregateQuery) return nil;
+
+	return [NSString stringWithFormat:@"SELECT \"rowid\" FROM \"%@\" %@", [self tableName], query.queryString];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Exceptions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -35,6 +35,7 @@ static NSString *const ext_key_version_deprecated = @"version";
 
 static NSString *const changeset_key_deletedEdges  = @"deletedEdges";
 static NSString *const changeset_key_modifiedEdges = @"modifiedEdges";
+static NSString *const changeset_key_modifiedNodes = @"modifiedNodes";
 static NSString *const changeset_key_reset         = @"reset";
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -87,6 +88,9 @@ static NSString *const changeset_key_reset         = @"reset";
 	
 	YapCache<NSNumber*, YapDatabaseRelationshipEdge*> *edgeCache;                // key:edgeRowid, value:edge
 	
+	YapCache<NSNumber*, NSMutableDictionary*> *adjacencyCache;                   // key:nodeRowid, value:edge lists
+	NSUInteger adjacencyCacheLimit;
+	
 	NSMutableDictionary<NSNumber*, NSMutableArray*> *protocolChanges;            // key:srcRowid, value:edges
 	NSMutableDictionary<NSString*, NSMutableArray*> *manualChanges;              // key:edgeName, value:edges
 	
@@ -99,6 +103,7 @@ static NSString *const changeset_key_reset         = @"reset";
 	
 	NSMutableSet<NSNumber *> *deletedEdges;                                      // values:edgeRowid
 	NSMutableDictionary<NSNumber*, YapDatabaseRelationshipEdge*> *modifiedEdges; // key:edgeRowid, value:edge
+	NSMutableSet<NSNumber *> *modifiedNodes;                                     // values:db_rowid (src/dst of changed edges)
 	
 	NSMutableSet<NSURL *> *filesToDelete;
 }
@@ -108,6 +113,15 @@ static NSString *const changeset_key_reset         = @"reset";
 - (void)postCommitCleanup;
 - (void)postRollbackCleanup;
 
+- (NSArray<YapDatabaseRelationshipEdge *> *)cachedEdgesForNode:(int64_t)rowid
+                                                           name:(NSString *)name
+                                                       outgoing:(BOOL)outgoing;
+
+- (void)cacheEdges:(NSArray<YapDatabaseRelationshipEdge *> *)edges
+           forNode:(int64_t)rowid
+              name:(NSString *)name
+          outgoing:(BOOL)outgoing;
+
 - (sqlite3_stmt *)findEdgesWithNodeStatement;
 - (sqlite3_stmt *)findManualEdgeWithDstStatement;
 - (sqlite3_stmt *)findManualEdgeWithDstFileURLStatement;
@@ -28,6 +28,29 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, strong, readonly) YapDatabaseRelationship *relationship;
 
+/**
+ * The adjacencyCache speeds up repeated edge lookups for the same node.
+ * That is, enumerateEdgesWithName:sourceKey:collection:usingBlock: (and the destinationKey variant),
+ * and edgeCountWithName:sourceKey:collection: (and the destinationKey variant).
+ *
+ * The first time the edges of a node are enumerated (within a read-only transaction),
+ * the resulting edges are cached, keyed by (node, edge name, direction).
+ * Subsequent lookups are then served from memory, without querying sqlite,
+ * and without re-resolving the rowids of the source/destination nodes to their collection/key.
+ *
+ * The cache is automatically updated as other connections make changes to the graph.
+ * Read-write transactions don't use the cache, as they may have pending changes that aren't yet on disk.
+ *
+ * Please note that the countLimit applies to the number of nodes, not the number of edges.
+ *
+ * By default the adjacencyCache is enabled and has a limit of 250.
+ *
+ * To disable the cache entirely, set adjacencyCacheEnabled to NO.
+ * To use an infinite cache size, set the adjacencyCacheLimit to ZERO.
+ */
+@property (atomic, assign, readwrite) BOOL adjacencyCacheEnabled;
+@property (atomic, assign, readwrite) NSUInteger adjacencyCacheLimit;
+
 @end
 
 NS_ASSUME_NONNULL_END
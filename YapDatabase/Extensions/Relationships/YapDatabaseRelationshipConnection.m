@@ -23,6 +23,20 @@
 #endif
 #pragma unused(ydbLogLevel)
 
+/**
+ * The adjacencyCache is keyed by node rowid.
+ * Each value is a dictionary of the node's cached edge lists, keyed by direction & (optional) edge name.
+**/
+static NSString *AdjacencyKey(NSString *name, BOOL outgoing)
+{
+	NSString *direction = outgoing ? @">" : @"<";
+	
+	if (name)
+		return [NSString stringWithFormat:@"%@:%@", direction, name];
+	else
+		return direction;
+}
+
 
 @implementation YapDatabaseRelationshipConnection
 {
@@ -71,6 +85,11 @@
 		edgeCache.allowedKeyClasses = [NSSet setWithObject:[NSNumber class]];
 		edgeCache.allowedObjectClasses = [NSSet setWithObject:[YapDatabaseRelationshipEdge class]];
 		
+		adjacencyCacheLimit = 250;
+		adjacencyCache = [[YapCache alloc] initWithCountLimit:adjacencyCacheLimit];
+		adjacencyCache.allowedKeyClasses = [NSSet setWithObject:[NSNumber class]];
+		adjacencyCache.allowedObjectClasses = [NSSet setWithObject:[NSMutableDictionary class]];
+		
 		sharedKeySetForInternalChangeset = [NSDictionary sharedKeySetForKeys:[self internalChangesetKeys]];
 	}
 	return self;
@@ -128,6 +147,7 @@
 	if (flags & YapDatabaseConnectionFlushMemoryFlags_Caches)
 	{
 		[edgeCache removeAllObjects];
+		[adjacencyCache removeAllObjects];
 	}
 }
 
@@ -143,6 +163,132 @@
 	return parent;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Configuration
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (BOOL)adjacencyCacheEnabled
+{
+	__block BOOL result = NO;
+	
+	dispatch_block_t block = ^{
+		
+		result = (self->adjacencyCache == nil) ? NO : YES;
+	};
+	
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_sync(databaseConnection->connectionQueue, block);
+	
+	return result;
+}
+
+- (void)setAdjacencyCacheEnabled:(BOOL)adjacencyCacheEnabled
+{
+	dispatch_block_t block = ^{
+		
+		if (adjacencyCacheEnabled)
+		{
+			if (self->adjacencyCache == nil)
+			{
+				self->adjacencyCache = [[YapCache alloc] initWithCountLimit:self->adjacencyCacheLimit];
+				self->adjacencyCache.allowedKeyClasses = [NSSet setWithObject:[NSNumber class]];
+				self->adjacencyCache.allowedObjectClasses = [NSSet setWithObject:[NSMutableDictionary class]];
+			}
+		}
+		else
+		{
+			self->adjacencyCache = nil;
+		}
+	};
+	
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_async(databaseConnection->connectionQueue, block);
+}
+
+- (NSUInteger)adjacencyCacheLimit
+{
+	__block NSUInteger result = 0;
+	
+	dispatch_block_t block = ^{
+		
+		result = self->adjacencyCacheLimit;
+	};
+	
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_sync(databaseConnection->connectionQueue, block);
+	
+	return result;
+}
+
+- (void)setAdjacencyCacheLimit:(NSUInteger)newAdjacencyCacheLimit
+{
+	dispatch_block_t block = ^{
+		
+		self->adjacencyCacheLimit = newAdjacencyCacheLimit;
+		self->adjacencyCache.countLimit = self->adjacencyCacheLimit;
+	};
+	
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_async(databaseConnection->connectionQueue, block);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Adjacency Cache
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns the cached edges with the given source (outgoing) or destination (incoming) node,
+ * or nil if they're not in the cache.
+**/
+- (NSArray<YapDatabaseRelationshipEdge *> *)cachedEdgesForNode:(int64_t)rowid
+                                                           name:(NSString *)name
+                                                       outgoing:(BOOL)outgoing
+{
+	NSMutableDictionary *adjacency = [adjacencyCache objectForKey:@(rowid)];
+	
+	return adjacency[AdjacencyKey(name, outgoing)];
+}
+
+- (void)cacheEdges:(NSArray<YapDatabaseRelationshipEdge *> *)edges
+           forNode:(int64_t)rowid
+              name:(NSString *)name
+          outgoing:(BOOL)outgoing
+{
+	if (adjacencyCache == nil) return;
+	
+	NSMutableDictionary *adjacency = [adjacencyCache objectForKey:@(rowid)];
+	if (adjacency == nil)
+	{
+		adjacency = [NSMutableDictionary dictionaryWithCapacity:2];
+		[adjacencyCache setObject:adjacency forKey:@(rowid)];
+	}
+	
+	adjacency[AdjacencyKey(name, outgoing)] = [edges copy];
+}
+
+/**
+ * Removes the cached edge lists of every node that was the source or destination of a changed edge.
+**/
+- (void)invalidateAdjacencyCacheWithModifiedNodes:(NSSet<NSNumber *> *)nodes reset:(BOOL)isReset
+{
+	if (isReset)
+	{
+		[adjacencyCache removeAllObjects];
+	}
+	else if (nodes.count > 0)
+	{
+		[adjacencyCache removeObjectsForKeys:[nodes allObjects]];
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Transactions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -202,6 +348,9 @@
 	if (modifiedEdges == nil)
 		modifiedEdges = [[NSMutableDictionary alloc] init];
 	
+	if (modifiedNodes == nil)
+		modifiedNodes = [[NSMutableSet alloc] init];
+	
 	if (filesToDelete == nil)
 		filesToDelete = [[NSMutableSet alloc] init];
 }
@@ -219,11 +368,17 @@
 	[deletedOrder removeAllObjects];
 	[deletedInfo removeAllObjects];
 	
+	// Other connections update their adjacencyCache via processChangeset.
+	// Our own cache doesn't see the changeset, so we update it here.
+	
+	[self invalidateAdjacencyCacheWithModifiedNodes:modifiedNodes reset:reset];
+	
 	reset = NO;
 	
 	// The following may be stored in the changeset notification:
 	// - deletedEdges
 	// - modifiedEdges
+	// - modifiedNodes
 	// - reset
 	//
 	// The following are used post-transaction:
@@ -237,6 +392,9 @@
 	if (modifiedEdges.count > 0)
 		modifiedEdges = nil;
 	
+	if (modifiedNodes.count > 0)
+		modifiedNodes = nil;
+	
 	if ([filesToDelete count] > 0)
 		filesToDelete = nil;
 }
@@ -258,13 +416,19 @@
 	
 	[deletedEdges removeAllObjects];
 	[modifiedEdges removeAllObjects];
+	[modifiedNodes removeAllObjects];
 	[filesToDelete removeAllObjects];
+	
+	// The read-write transaction may have modified cached edges (e.g. marked them for deletion).
+	
+	[adjacencyCache removeAllObjects];
 }
 
 - (NSArray *)internalChangesetKeys
 {
 	return @[ changeset_key_deletedEdges,
 	          changeset_key_modifiedEdges,
+	          changeset_key_modifiedNodes,
 	          changeset_key_reset ];
 }
 
@@ -280,6 +444,7 @@
 	
 	if (deletedEdges.count  > 0 ||
 	    modifiedEdges.count > 0 ||
+	    modifiedNodes.count > 0 ||
 		reset)
 	{
 		internalChangeset = [NSMutableDictionary dictionaryWithSharedKeySet:sharedKeySetForInternalChangeset];
@@ -294,6 +459,11 @@
 			internalChangeset[changeset_key_modifiedEdges] = modifiedEdges;
 		}
 		
+		if (modifiedNodes.count > 0)
+		{
+			internalChangeset[changeset_key_modifiedNodes] = modifiedNodes;
+		}
+		
 		if (reset)
 		{
 			internalChangeset[changeset_key_reset] = @(reset);
@@ -313,6 +483,7 @@
 	
 	NSSet        *changeset_deletedEdges  = changeset[changeset_key_deletedEdges];
 	NSDictionary *changeset_modifiedEdges = changeset[changeset_key_modifiedEdges];
+	NSSet        *changeset_modifiedNodes = changeset[changeset_key_modifiedNodes];
 	
 	BOOL changeset_reset = [changeset[changeset_key_reset] boolValue];
 	
@@ -356,6 +527,10 @@
 			[edgeCache setObject:[edge copy] forKey:edgeRowid];
 		}
 	}
+	
+	// Update adjacencyCache
+	
+	[self invalidateAdjacencyCacheWithModifiedNodes:changeset_modifiedNodes reset:changeset_reset];
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -394,7 +569,7 @@
 	if (*statement == NULL)
 	{
 		NSString *string = [NSString stringWithFormat:
-		  @"SELECT \"rowid\" FROM \"%@\" WHERE \"src\" = ? OR \"dst\" = ?;", [parent tableName]];
+		  @"SELECT \"rowid\", \"src\", \"dst\" FROM \"%@\" WHERE \"src\" = ? OR \"dst\" = ?;", [parent tableName]];
 		
 		[self prepareStatement:statement withString:string caller:_cmd];
 	}
@@ -2687,6 +2687,26 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 	}
 }
 
+/**
+ * Records the source & destination nodes of an edge that's being inserted, updated or deleted.
+ * The edge lists of these nodes are then removed from the adjacencyCache of every connection.
+**/
+- (void)markNodesAsModifiedForEdge:(YapDatabaseRelationshipEdge *)edge
+{
+	[self lookupEdgeSource:edge];
+	
+	if (edge->state & YDB_EdgeState_HasSourceRowid)
+		[parentConnection->modifiedNodes addObject:@(edge->sourceRowid)];
+	
+	if (!(edge->state & YDB_EdgeState_DestinationFileURL))
+	{
+		[self lookupEdgeDestination:edge];
+		
+		if (edge->state & YDB_EdgeState_HasDestinationRowid)
+			[parentConnection->modifiedNodes addObject:@(edge->destinationRowid)];
+	}
+}
+
 /**
  * Helper method for executing the sqlite statement to insert an edge into the database.
 **/
@@ -2740,6 +2760,8 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 		edge->flags = 0;
 		
 		[parentConnection->edgeCache setObject:edge forKey:@(edge->edgeRowid)];
+		
+		[self markNodesAsModifiedForEdge:edge];
 	}
 	else
 	{
@@ -2780,6 +2802,8 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 		
 		[parentConnection->modifiedEdges setObject:[edge copy] forKey:@(edge->edgeRowid)];
 		[parentConnection->deletedEdges removeObject:@(edge->edgeRowid)];
+		
+		[self markNodesAsModifiedForEdge:edge];
 	}
 	else
 	{
@@ -2814,6 +2838,8 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 		
 		[parentConnection->deletedEdges addObject:@(edge->edgeRowid)];
 		[parentConnection->modifiedEdges removeObjectForKey:@(edge->edgeRowid)];
+		
+		[self markNodesAsModifiedForEdge:edge];
 	}
 	else
 	{
@@ -2836,9 +2862,11 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 		sqlite3_stmt *statement = [parentConnection findEdgesWithNodeStatement];
 		if (statement == NULL) return;
 		
-		// SELECT "rowid" FROM "tableName" WHERE "src" = ? OR "dst" = ?;
+		// SELECT "rowid", "src", "dst" FROM "tableName" WHERE "src" = ? OR "dst" = ?;
 		
-		int const column_idx_rowid = SQLITE_COLUMN_START;
+		int const column_idx_rowid = SQLITE_COLUMN_START + 0;
+		int const column_idx_src   = SQLITE_COLUMN_START + 1;
+		int const column_idx_dst   = SQLITE_COLUMN_START + 2;
 		
 		int const bind_idx_src = SQLITE_BIND_START + 0;
 		int const bind_idx_dst = SQLITE_BIND_START + 1;
@@ -2852,6 +2880,15 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 			int64_t edgeRowid = sqlite3_column_int64(statement, column_idx_rowid);
 			
 			[parentConnection->deletedEdges addObject:@(edgeRowid)];
+			
+			// Both ends of the edge need their adjacencyCache entries invalidated
+			
+			[parentConnection->modifiedNodes addObject:@(sqlite3_column_int64(statement, column_idx_src))];
+			
+			if (sqlite3_column_type(statement, column_idx_dst) == SQLITE_INTEGER)
+			{
+				[parentConnection->modifiedNodes addObject:@(sqlite3_column_int64(statement, column_idx_dst))];
+			}
 		}
 		
 		if (status != SQLITE_DONE)
@@ -3044,6 +3081,7 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 	
 	[parentConnection->modifiedEdges removeAllObjects];
 	[parentConnection->deletedEdges removeAllObjects];
+	[parentConnection->modifiedNodes removeAllObjects];
 	
 	parentConnection->reset = YES;
 }
@@ -4560,6 +4598,31 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 	
 	BOOL stop = NO;
 	
+	// Read-only transactions don't have any pending changes in memory,
+	// so the edges on disk are exactly the edges we enumerate, and we can use the adjacencyCache.
+	
+	BOOL useAdjacencyCache = hasSrcRowid && !databaseTransaction->isReadWriteTransaction && (parentConnection->adjacencyCache != nil);
+	NSMutableArray<YapDatabaseRelationshipEdge *> *adjacentEdges = nil;
+	
+	if (useAdjacencyCache)
+	{
+		NSArray<YapDatabaseRelationshipEdge *> *cachedEdges =
+		  [parentConnection cachedEdgesForNode:srcRowid name:name outgoing:YES];
+		
+		if (cachedEdges)
+		{
+			for (YapDatabaseRelationshipEdge *edge in cachedEdges)
+			{
+				block(edge, &stop);
+				if (stop) break;
+			}
+			
+			return;
+		}
+		
+		adjacentEdges = [NSMutableArray array];
+	}
+	
 	// There may be edges in memory that haven't yet been written to disk.
 	// We need to find these edges, and ensure they override their corresponding counterparts from disk.
 	
@@ -4789,6 +4852,8 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 				continue;
 			}
 			
+			[adjacentEdges addObject:edge];
+			
 			block(edge, &stop);
 			if (stop) break;
 		}
@@ -4799,6 +4864,11 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 			            status, sqlite3_errmsg(databaseTransaction->connection->db));
 		}
 		
+		if (adjacentEdges && (status == SQLITE_DONE))
+		{
+			[parentConnection cacheEdges:adjacentEdges forNode:srcRowid name:name outgoing:YES];
+		}
+		
 		sqlite_enum_reset(statement,needsFinalize);
 		if (name) {
 			FreeYapDatabaseString(&_name);
@@ -4877,6 +4947,31 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 	
 	BOOL stop = NO;
 	
+	// Read-only transactions don't have any pending changes in memory,
+	// so the edges on disk are exactly the edges we enumerate, and we can use the adjacencyCache.
+	
+	BOOL useAdjacencyCache = hasDstRowid && !databaseTransaction->isReadWriteTransaction && (parentConnection->adjacencyCache != nil);
+	NSMutableArray<YapDatabaseRelationshipEdge *> *adjacentEdges = nil;
+	
+	if (useAdjacencyCache)
+	{
+		NSArray<YapDatabaseRelationshipEdge *> *cachedEdges =
+		  [parentConnection cachedEdgesForNode:dstRowid name:name outgoing:NO];
+		
+		if (cachedEdges)
+		{
+			for (YapDatabaseRelationshipEdge *edge in cachedEdges)
+			{
+				block(edge, &stop);
+				if (stop) break;
+			}
+			
+			return;
+		}
+		
+		adjacentEdges = [NSMutableArray array];
+	}
+	
 	// There may be edges in memory that haven't yet been written to disk.
 	// We need to find these edges, and ensure they override their corresponding counterparts from disk.
 	
@@ -5068,6 +5163,8 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 				continue;
 			}
 			
+			[adjacentEdges addObject:edge];
+			
 			block(edge, &stop);
 			if (stop) break;
 		}
@@ -5078,6 +5175,11 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 			            status, sqlite3_errmsg(databaseTransaction->connection->db));
 		}
 		
+		if (adjacentEdges && (status == SQLITE_DONE))
+		{
+			[parentConnection cacheEdges:adjacentEdges forNode:dstRowid name:name outgoing:NO];
+		}
+		
 		sqlite_enum_reset(statement, needsFinalize);
 		if (name) {
 			FreeYapDatabaseString(&_name);
@@ -6306,6 +6408,14 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 		return 0;
 	}
 	
+	NSArray<YapDatabaseRelationshipEdge *> *cachedEdges =
+	  [parentConnection cachedEdgesForNode:srcRowid name:name outgoing:YES];
+	
+	if (cachedEdges)
+	{
+		return cachedEdges.count;
+	}
+	
 	sqlite3_stmt *statement = NULL;
 	YapDatabaseString _name;
 	
@@ -6402,6 +6512,14 @@ NS_INLINE BOOL URLMatchesURL(NSURL *url1, NSURL *url2)
 		return 0;
 	}
 	
+	NSArray<YapDatabaseRelationshipEdge *> *cachedEdges =
+	  [parentConnection cachedEdgesForNode:dstRowid name:name outgoing:NO];
+	
+	if (cachedEdges)
+	{
+		return cachedEdges.count;
+	}
+	
 	sqlite3_stmt *statement = NULL;
 	YapDatabaseString _name;
 	
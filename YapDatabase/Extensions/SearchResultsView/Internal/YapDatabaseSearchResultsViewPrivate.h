@@ -5,6 +5,8 @@
 
 #import "YapDatabaseViewPrivate.h"
 #import "YapDatabaseAutoViewPrivate.h"
+#import "YapDatabaseSearchQueue.h"
+#import "YapRowidSet.h"
 
 /**
  * Changeset keys (for changeset notification dictionary)
@@ -21,6 +23,35 @@ static NSString *const changeset_key_query = @"query";
 #pragma mark -
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Tracks the progress of a time-sliced search.
+ * See -[YapDatabaseSearchResultsViewConnection asyncPerformSearchWithQueue:timeSlice:completionQueue:completionBlock:].
+ *
+ * All work in progress is stored here (outside of any transaction),
+ * until it's applied to the view in the final read-write transaction.
+**/
+@interface YapDatabaseSearchResultsViewSlicedSearch : NSObject {
+@public
+	
+	NSString *query;
+	YapDatabaseViewGrouping *grouping;             // grouping used to calculate the groups (if not using parentView)
+	
+	YapRowidSet *ftsRowids;                        // FTS results (as of the snapshot in which they were calculated)
+	NSMutableArray<NSNumber *> *ungroupedRowids;   // FTS results whose group hasn't been calculated yet
+	NSMutableDictionary<NSNumber *, id> *groups;   // rowid -> group (or NSNull if excluded from the view)
+	
+	YapRowidSet *modifiedRowids;                   // rows modified since the search started
+	BOOL allRowidsModified;
+}
+
+- (instancetype)initWithQuery:(NSString *)query;
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 @interface YapDatabaseSearchResultsView () {
 @public
 	
@@ -28,6 +59,15 @@ static NSString *const changeset_key_query = @"query";
 	NSString *fullTextSearchName;
 }
 
+// These methods may only be invoked from within a read-write transaction.
+// (Read-write transactions are serialized, so no additional locking is required.)
+
+- (void)addSlicedSearch:(YapDatabaseSearchResultsViewSlicedSearch *)slicedSearch;
+- (void)removeSlicedSearch:(YapDatabaseSearchResultsViewSlicedSearch *)slicedSearch;
+
+- (void)noteModifiedRowid:(int64_t)rowid;
+- (void)noteAllRowidsModified;
+
 @end
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -39,12 +79,31 @@ static NSString *const changeset_key_query = @"query";
 	
 	NSString *query;
 	BOOL queryChanged;
+	
+	NSMutableArray<NSString *> *cachedQueries;                   // most recently used last
+	NSMutableDictionary<NSString *, NSValue *> *cachedQueryRowids; // query -> (YapRowidSet *)
+	uint64_t cachedQueriesSnapshot;
+	
+	NSString *cachedSnippetsQuery;
+	NSMutableDictionary<NSNumber *, id> *cachedSnippets; // rowid -> snippet (or NSNull if row doesn't match)
 }
 
 - (NSString *)query;
 - (void)getQuery:(NSString **)queryPtr wasChanged:(BOOL *)wasChangedPtr;
 - (void)setQuery:(NSString *)newQuery isChange:(BOOL)isChange;
 
+- (YapRowidSet *)cachedRowidsForQuery:(NSString *)query snapshot:(uint64_t)snapshot;
+- (void)enumerateCachedQueriesForSnapshot:(uint64_t)snapshot
+                               usingBlock:(void (NS_NOESCAPE^)(NSString *query, YapRowidSet *rowids, BOOL *stop))block;
+
+- (void)cacheRowids:(YapRowidSet *)rowids forQuery:(NSString *)query snapshot:(uint64_t)snapshot;
+
+- (id)cachedSnippetForRowid:(int64_t)rowid query:(NSString *)query snapshot:(uint64_t)snapshot;
+- (void)cacheSnippets:(NSDictionary<NSNumber *, id> *)snippets forQuery:(NSString *)query snapshot:(uint64_t)snapshot;
+
+- (void)advanceQueryCacheFromSnapshot:(uint64_t)fromSnapshot toSnapshot:(uint64_t)toSnapshot;
+- (void)flushQueryCache;
+
 @end
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -54,6 +113,14 @@ static NSString *const changeset_key_query = @"query";
 @interface YapDatabaseSearchResultsViewTransaction () {
 @private
 	
+	uint64_t snapshot; // connection snapshot when the transaction started
 }
 
+- (BOOL)continueSlicedSearch:(YapDatabaseSearchResultsViewSlicedSearch *)slicedSearch
+                   withQueue:(YapDatabaseSearchQueue *)searchQueue
+                    deadline:(CFAbsoluteTime)deadline;
+
+- (void)finishSlicedSearch:(YapDatabaseSearchResultsViewSlicedSearch *)slicedSearch
+                 withQueue:(YapDatabaseSearchQueue *)searchQueue;
+
 @end
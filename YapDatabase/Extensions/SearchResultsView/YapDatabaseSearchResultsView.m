@@ -23,6 +23,9 @@
 
 
 @implementation YapDatabaseSearchResultsView
+{
+	NSMutableArray<YapDatabaseSearchResultsViewSlicedSearch *> *slicedSearches;
+}
 
 #pragma mark Invalid
 
@@ -169,4 +172,70 @@
 	return [[YapDatabaseSearchResultsViewConnection alloc] initWithParent:self databaseConnection:databaseConnection];
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Sliced Searches
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A time-sliced search performs most of its work in read-only transactions.
+ * Any rows modified by read-write transactions in the meantime (from any connection) are tracked here,
+ * so the search can reconcile its results before applying them to the view.
+**/
+- (void)addSlicedSearch:(YapDatabaseSearchResultsViewSlicedSearch *)slicedSearch
+{
+	if (slicedSearches == nil)
+		slicedSearches = [[NSMutableArray alloc] initWithCapacity:1];
+	
+	[slicedSearches addObject:slicedSearch];
+}
+
+- (void)removeSlicedSearch:(YapDatabaseSearchResultsViewSlicedSearch *)slicedSearch
+{
+	[slicedSearches removeObjectIdenticalTo:slicedSearch];
+}
+
+- (void)noteModifiedRowid:(int64_t)rowid
+{
+	for (YapDatabaseSearchResultsViewSlicedSearch *slicedSearch in slicedSearches)
+	{
+		YapRowidSetAdd(slicedSearch->modifiedRowids, rowid);
+	}
+}
+
+- (void)noteAllRowidsModified
+{
+	for (YapDatabaseSearchResultsViewSlicedSearch *slicedSearch in slicedSearches)
+	{
+		slicedSearch->allRowidsModified = YES;
+	}
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation YapDatabaseSearchResultsViewSlicedSearch
+
+- (instancetype)initWithQuery:(NSString *)inQuery
+{
+	if ((self = [super init]))
+	{
+		query = [inQuery copy];
+		modifiedRowids = YapRowidSetCreate(0);
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	if (ftsRowids) {
+		YapRowidSetRelease(ftsRowids);
+	}
+	if (modifiedRowids) {
+		YapRowidSetRelease(modifiedRowids);
+	}
+}
+
 @end
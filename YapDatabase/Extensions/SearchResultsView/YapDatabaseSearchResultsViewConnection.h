@@ -2,6 +2,7 @@
 #import "YapDatabaseAutoViewConnection.h"
 
 @class YapDatabaseSearchResultsView;
+@class YapDatabaseSearchQueue;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -10,6 +11,39 @@ NS_ASSUME_NONNULL_BEGIN
 // Returns properly typed parent instance
 @property (nonatomic, strong, readonly) YapDatabaseSearchResultsView *searchResultsView;
 
+/**
+ * Performs a search (for the most recent query in the given queue) without holding
+ * a read-write transaction for the duration of the search.
+ *
+ * The expensive parts of the search (running the FTS query, and invoking the grouping block for new matches)
+ * are performed in a series of read-only transactions, each limited to roughly the given timeSlice.
+ * Read-only transactions never block writers, and in between the slices the connection is free for other work.
+ *
+ * Once complete, the results are applied to the view within a single (short) read-write transaction.
+ * Any rows that were modified in the meantime (by any connection) are re-evaluated at that point,
+ * so the view ends up exactly as if performSearchWithQueue: had been used.
+ *
+ * If the search is aborted (via the queue), nothing is committed,
+ * regardless of the shouldRollback parameter.
+ *
+ * @param queue
+ *   The search queue. The most recent query is flushed from the queue, and searched for.
+ *
+ * @param timeSlice
+ *   The (approximate) maximum duration of each read-only transaction, in seconds.
+ *
+ * @param completionQueue
+ *   The dispatch queue to invoke the completionBlock on.
+ *   If NULL, the main thread is automatically used.
+ *
+ * @param completionBlock
+ *   An optional block to invoke once the search has completed (or was aborted).
+ */
+- (void)asyncPerformSearchWithQueue:(YapDatabaseSearchQueue *)queue
+                          timeSlice:(NSTimeInterval)timeSlice
+                    completionQueue:(nullable dispatch_queue_t)completionQueue
+                    completionBlock:(nullable dispatch_block_t)completionBlock;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -1,5 +1,6 @@
 #import "YapDatabaseSearchResultsViewConnection.h"
 #import "YapDatabaseSearchResultsViewPrivate.h"
+#import "YapDatabaseSearchQueuePrivate.h"
 #import "YapDatabaseExtensionPrivate.h"
 #import "YapDatabasePrivate.h"
 #import "YapDatabaseString.h"
@@ -23,6 +24,11 @@
 
 @implementation YapDatabaseSearchResultsViewConnection
 
+- (void)dealloc
+{
+	[self flushQueryCache];
+}
+
 - (YapDatabaseSearchResultsView *)searchResultsView
 {
 	return (YapDatabaseSearchResultsView *)parent;
@@ -131,6 +137,119 @@
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Sliced Searching
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for documentation.
+**/
+- (void)asyncPerformSearchWithQueue:(YapDatabaseSearchQueue *)searchQueue
+                          timeSlice:(NSTimeInterval)timeSlice
+                    completionQueue:(dispatch_queue_t)completionQueue
+                    completionBlock:(dispatch_block_t)completionBlock
+{
+	if (completionQueue == NULL && completionBlock != NULL)
+		completionQueue = dispatch_get_main_queue();
+	
+	// Retain the database connection for the duration of the search
+	// (which retains this extension connection).
+	
+	YapDatabaseConnection *connection = databaseConnection;
+	NSString *registeredName = [parent registeredName];
+	
+	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{ @autoreleasepool {
+		
+		[self performSlicedSearchWithQueue:searchQueue
+		                         timeSlice:timeSlice
+		                        connection:connection
+		                    registeredName:registeredName];
+		
+		if (completionBlock) {
+			dispatch_async(completionQueue, completionBlock);
+		}
+	}});
+}
+
+- (void)performSlicedSearchWithQueue:(YapDatabaseSearchQueue *)searchQueue
+                           timeSlice:(NSTimeInterval)timeSlice
+                          connection:(YapDatabaseConnection *)connection
+                      registeredName:(NSString *)registeredName
+{
+	NSString *newQuery = [searchQueue flushQueue];
+	if (newQuery == nil) return;
+	
+	__unsafe_unretained YapDatabaseSearchResultsView *searchResultsView = [self searchResultsView];
+	
+	YapDatabaseSearchResultsViewSlicedSearch *slicedSearch =
+	  [[YapDatabaseSearchResultsViewSlicedSearch alloc] initWithQuery:newQuery];
+	
+	// Step 1 of 3:
+	//
+	// Start tracking modified rows.
+	// We do this within a (brief) read-write transaction, as read-write transactions are serialized.
+	// Thus any commit that isn't reflected in the read-only transactions below is guaranteed to be tracked.
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction __unused *transaction) {
+		
+		[searchResultsView addSlicedSearch:slicedSearch];
+	}];
+	
+	// Step 2 of 3:
+	//
+	// Perform the search within a series of read-only transactions,
+	// each limited to (roughly) the given time slice.
+	
+	__block BOOL done = NO;
+	__block BOOL aborted = NO;
+	
+	while (!done && !aborted)
+	{
+		[connection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			YapDatabaseSearchResultsViewTransaction *searchResultsViewTransaction = [transaction ext:registeredName];
+			if (searchResultsViewTransaction == nil)
+			{
+				// Extension was unregistered
+				aborted = YES;
+				return;
+			}
+			
+			CFAbsoluteTime deadline = CFAbsoluteTimeGetCurrent() + timeSlice;
+			
+			done = [searchResultsViewTransaction continueSlicedSearch:slicedSearch
+			                                                withQueue:searchQueue
+			                                                 deadline:deadline];
+		}];
+		
+		if ([searchQueue shouldAbortSearchInProgressAndRollback:NULL]) {
+			aborted = YES;
+		}
+	}
+	
+	// Step 3 of 3:
+	//
+	// Stop tracking modified rows, and apply the results to the view.
+	
+	[connection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[searchResultsView removeSlicedSearch:slicedSearch];
+		
+		if (aborted) return;
+		
+		YapDatabaseSearchResultsViewTransaction *searchResultsViewTransaction = [transaction ext:registeredName];
+		
+		[searchResultsViewTransaction finishSlicedSearch:slicedSearch withQueue:searchQueue];
+		
+		BOOL rollback = NO;
+		BOOL abort = [searchQueue shouldAbortSearchInProgressAndRollback:&rollback];
+		if (abort && rollback)
+		{
+			[transaction rollback];
+		}
+	}];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Internal
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -168,4 +287,204 @@
 	queryChanged = queryChanged || isChange;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Query Cache
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The query cache stores the FTS results (set of rowids) of recent queries,
+ * as well as the snippets that have been generated for the current query.
+ *
+ * The results are only valid for the snapshot in which they were calculated.
+ * Any read-write transaction that modifies rows flushes the cache,
+ * and so does a commit from another connection (which we detect via a snapshot mismatch).
+**/
+- (BOOL)validateQueryCacheForSnapshot:(uint64_t)snapshot
+{
+	NSAssert(dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey), @"Expected to be on connectionQueue");
+	
+	if (cachedQueriesSnapshot != snapshot)
+	{
+		[self flushQueryCache];
+		cachedQueriesSnapshot = snapshot;
+	}
+	
+	return ([cachedQueries count] > 0);
+}
+
+/**
+ * Returns the cached FTS results for the given query (if available).
+ * The returned set is owned by the cache, and must not be modified or released.
+**/
+- (YapRowidSet *)cachedRowidsForQuery:(NSString *)inQuery snapshot:(uint64_t)snapshot
+{
+	if (inQuery == nil) return NULL;
+	if (![self validateQueryCacheForSnapshot:snapshot]) return NULL;
+	
+	NSValue *value = cachedQueryRowids[inQuery];
+	if (value == nil) return NULL;
+	
+	// Move to end of list (most recently used)
+	
+	NSUInteger index = [cachedQueries indexOfObject:inQuery];
+	if (index != NSNotFound && index != ([cachedQueries count] - 1))
+	{
+		NSString *cachedQuery = cachedQueries[index];
+		[cachedQueries removeObjectAtIndex:index];
+		[cachedQueries addObject:cachedQuery];
+	}
+	
+	return (YapRowidSet *)[value pointerValue];
+}
+
+/**
+ * Enumerates the cached queries, most recently used first.
+ * The given sets are owned by the cache, and must not be modified or released.
+**/
+- (void)enumerateCachedQueriesForSnapshot:(uint64_t)snapshot
+                               usingBlock:(void (NS_NOESCAPE^)(NSString *query, YapRowidSet *rowids, BOOL *stop))block
+{
+	if (![self validateQueryCacheForSnapshot:snapshot]) return;
+	
+	BOOL stop = NO;
+	
+	for (NSString *cachedQuery in [cachedQueries reverseObjectEnumerator])
+	{
+		YapRowidSet *rowids = (YapRowidSet *)[cachedQueryRowids[cachedQuery] pointerValue];
+		
+		block(cachedQuery, rowids, &stop);
+		if (stop) break;
+	}
+}
+
+/**
+ * Stores a copy of the given FTS results in the cache,
+ * evicting the least recently used query if the cache is full.
+**/
+- (void)cacheRowids:(YapRowidSet *)rowids forQuery:(NSString *)inQuery snapshot:(uint64_t)snapshot
+{
+	NSAssert(dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey), @"Expected to be on connectionQueue");
+	
+	if (rowids == NULL || inQuery == nil) return;
+	
+	__unsafe_unretained YapDatabaseSearchResultsViewOptions *options =
+	  (YapDatabaseSearchResultsViewOptions *)parent->options;
+	
+	NSUInteger limit = options.queryCacheLimit;
+	if (limit == 0) return;
+	
+	[self validateQueryCacheForSnapshot:snapshot];
+	
+	if (cachedQueries == nil)
+	{
+		cachedQueries = [[NSMutableArray alloc] initWithCapacity:limit];
+		cachedQueryRowids = [[NSMutableDictionary alloc] initWithCapacity:limit];
+	}
+	
+	NSString *cachedQuery = [inQuery copy];
+	
+	NSValue *existing = cachedQueryRowids[cachedQuery];
+	if (existing)
+	{
+		YapRowidSetRelease((YapRowidSet *)[existing pointerValue]);
+		[cachedQueries removeObject:cachedQuery];
+	}
+	
+	cachedQueryRowids[cachedQuery] = [NSValue valueWithPointer:YapRowidSetCopy(rowids)];
+	[cachedQueries addObject:cachedQuery];
+	
+	while ([cachedQueries count] > limit)
+	{
+		NSString *evictedQuery = [cachedQueries firstObject];
+		
+		YapRowidSetRelease((YapRowidSet *)[cachedQueryRowids[evictedQuery] pointerValue]);
+		[cachedQueryRowids removeObjectForKey:evictedQuery];
+		[cachedQueries removeObjectAtIndex:0];
+	}
+}
+
+/**
+ * Returns the cached snippet for the given row & query (if available).
+ * The result is NSNull if the row is known not to match the query.
+ *
+ * Snippets share the snapshot of the query cache, and are flushed along with it.
+**/
+- (id)cachedSnippetForRowid:(int64_t)rowid query:(NSString *)inQuery snapshot:(uint64_t)snapshot
+{
+	NSAssert(dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey), @"Expected to be on connectionQueue");
+	
+	if (inQuery == nil) return nil;
+	
+	[self validateQueryCacheForSnapshot:snapshot];
+	
+	if (![cachedSnippetsQuery isEqualToString:inQuery]) return nil;
+	
+	return cachedSnippets[@(rowid)];
+}
+
+/**
+ * Stores the given snippets (rowid -> snippet or NSNull) in the cache.
+ *
+ * Only the snippets for a single query are kept.
+ * If the cache is full, it's simply emptied (the snippets for the visible rows will be re-fetched as a batch).
+**/
+- (void)cacheSnippets:(NSDictionary<NSNumber *, id> *)snippets forQuery:(NSString *)inQuery snapshot:(uint64_t)snapshot
+{
+	NSAssert(dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey), @"Expected to be on connectionQueue");
+	
+	if ([snippets count] == 0 || inQuery == nil) return;
+	
+	__unsafe_unretained YapDatabaseSearchResultsViewOptions *options =
+	  (YapDatabaseSearchResultsViewOptions *)parent->options;
+	
+	NSUInteger limit = options.snippetCacheLimit;
+	if (limit == 0) return;
+	
+	[self validateQueryCacheForSnapshot:snapshot];
+	
+	if (![cachedSnippetsQuery isEqualToString:inQuery])
+	{
+		cachedSnippetsQuery = [inQuery copy];
+		[cachedSnippets removeAllObjects];
+	}
+	
+	if (([cachedSnippets count] + [snippets count]) > limit)
+	{
+		[cachedSnippets removeAllObjects];
+	}
+	
+	if (cachedSnippets == nil)
+		cachedSnippets = [[NSMutableDictionary alloc] initWithCapacity:[snippets count]];
+	
+	[cachedSnippets addEntriesFromDictionary:snippets];
+}
+
+/**
+ * Invoked when a read-write transaction commits without modifying any rows.
+ *
+ * Such a commit may still increment the snapshot (e.g. because the view itself changed),
+ * but it cannot have changed the FTS results. So the cache remains valid for the new snapshot.
+**/
+- (void)advanceQueryCacheFromSnapshot:(uint64_t)fromSnapshot toSnapshot:(uint64_t)toSnapshot
+{
+	if (cachedQueriesSnapshot == fromSnapshot)
+		cachedQueriesSnapshot = toSnapshot;
+	else
+		[self flushQueryCache];
+}
+
+- (void)flushQueryCache
+{
+	for (NSValue *value in [cachedQueryRowids objectEnumerator])
+	{
+		YapRowidSetRelease((YapRowidSet *)[value pointerValue]);
+	}
+	
+	[cachedQueryRowids removeAllObjects];
+	[cachedQueries removeAllObjects];
+	
+	cachedSnippetsQuery = nil;
+	[cachedSnippets removeAllObjects];
+}
+
 @end
@@ -35,10 +35,45 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  * Set this option to include snippets with the search results.
  *
+ * Snippets are generated lazily, only for the items you actually request
+ * (via snippetForKey:inCollection: or prefetchSnippetsInGroup:range:).
+ *
  * The default value is nil.
  */
 @property (nonatomic, copy, readwrite, nullable) YapDatabaseFullTextSearchSnippetOptions *snippetOptions;
 
+/**
+ * The maximum number of snippets (for the current query) each connection keeps in memory.
+ *
+ * Snippets are cached per (query, row), and are discarded whenever the database is modified.
+ * The limit should be comfortably larger than the number of items you display at once.
+ * Set to zero to disable the cache.
+ *
+ * The default value is 500.
+ */
+@property (nonatomic, assign, readwrite) NSUInteger snippetCacheLimit;
+
+/**
+ * The number of recent query results each connection keeps in memory.
+ *
+ * This allows the view to avoid re-running the full FTS query as the user types:
+ *
+ * - If the user deletes characters, returning to a recent query (e.g. "yapd*" -> "yap*"),
+ *   the cached results are used as-is.
+ * - If the new query only narrows a recent query (e.g. "yap*" -> "yapd*"),
+ *   only the rowids matching the recent query are re-checked against the new query.
+ *   And, since the results can only shrink, the view simply removes the items that no longer match.
+ *
+ * Refinement is only detected for simple queries (space separated terms, optionally followed by a '*'),
+ * and only if the FTS extension uses a tokenizer that doesn't stem (e.g. not porter).
+ *
+ * The cache is flushed whenever the database is modified.
+ * Set to zero to disable the cache (and refinement detection).
+ *
+ * The default value is 8.
+ */
+@property (nonatomic, assign, readwrite) NSUInteger queryCacheLimit;
+
 @end
 
 NS_ASSUME_NONNULL_END
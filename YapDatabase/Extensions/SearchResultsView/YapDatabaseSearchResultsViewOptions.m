@@ -6,12 +6,16 @@
 
 @synthesize allowedGroups = allowedGroups;
 @synthesize snippetOptions = snippetOptions;
+@synthesize queryCacheLimit = queryCacheLimit;
+@synthesize snippetCacheLimit = snippetCacheLimit;
 
 - (id)init
 {
 	if ((self = [super init]))
 	{
 		self.isPersistent = NO; // <<-- This is changed for YapDatabaseSearchResultsOptions
+		queryCacheLimit = 8;
+		snippetCacheLimit = 500;
 	}
 	return self;
 }
@@ -37,6 +41,8 @@
 	
 	copy->allowedGroups = allowedGroups;
 	copy->snippetOptions = snippetOptions;
+	copy->queryCacheLimit = queryCacheLimit;
+	copy->snippetCacheLimit = snippetCacheLimit;
 	
 	return copy;
 }
@@ -10,10 +10,26 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  * Returns the snippet for the given collection/key tuple.
  *
+ * Snippets are generated on demand, and cached (per query) by the connection.
+ * If you're displaying a range of items, use prefetchSnippetsInGroup:range: first,
+ * which generates all the snippets for the range using a single FTS query.
+ *
  * Note: snippets must be enabled via YapDatabaseSearchResultsViewOptions.
  */
 - (nullable NSString *)snippetForKey:(NSString *)key inCollection:(nullable NSString *)collection;
 
+/**
+ * Generates the snippets for the items in the given range (using a single FTS query),
+ * and stores them in the connection's snippet cache.
+ * Subsequent calls to snippetForKey:inCollection: for these items are then serviced from the cache.
+ *
+ * Items whose snippets are already cached are skipped.
+ *
+ * Note: snippets must be enabled via YapDatabaseSearchResultsViewOptions.
+ * The range is capped at the snippetCacheLimit option.
+ */
+- (void)prefetchSnippetsInGroup:(NSString *)group range:(NSRange)range;
+
 @end
 
 @interface YapDatabaseSearchResultsViewTransaction (ReadWrite)
@@ -29,6 +29,81 @@
 static NSString *const ext_key_subclassVersion = @"searchResultViewClassVersion";
 static NSString *const ext_key_query           = @"query";
 
+/**
+ * When refining the results of a previous query,
+ * we check each previous result individually (if there aren't too many of them).
+ * Otherwise it's faster to simply run the query, and intersect the results.
+**/
+#define YDB_SEARCH_REFINEMENT_MAX_ROWID_CHECKS 2500
+
+/**
+ * Returns the terms of a "simple" FTS query, or nil if the query uses any other syntax.
+ *
+ * A simple query is a list of whitespace separated terms (implicit AND),
+ * where each term is alphanumeric and optionally ends with a '*' (prefix query).
+**/
+static NSArray<NSString *> *YDBSimpleQueryTerms(NSString *query)
+{
+	NSCharacterSet *nonAlphanumericSet = [[NSCharacterSet alphanumericCharacterSet] invertedSet];
+	NSMutableArray<NSString *> *terms = [NSMutableArray array];
+	
+	for (NSString *term in [query componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]])
+	{
+		if ([term length] == 0) continue;
+		
+		NSString *word = [term hasSuffix:@"*"] ? [term substringToIndex:([term length] - 1)] : term;
+		
+		if ([word length] == 0) return nil;
+		if ([word rangeOfCharacterFromSet:nonAlphanumericSet].location != NSNotFound) return nil;
+		
+		if ([word isEqualToString:@"AND"] || [word isEqualToString:@"OR"] ||
+		    [word isEqualToString:@"NOT"] || [word isEqualToString:@"NEAR"]) return nil;
+		
+		[terms addObject:term];
+	}
+	
+	return ([terms count] > 0) ? terms : nil;
+}
+
+/**
+ * Returns YES if every row matching the query is guaranteed to also match the baseQuery.
+ * For example: "yap*" -> "yapd*", or "yap" -> "yap data".
+ *
+ * This assumes the tokenizer doesn't stem.
+**/
+static BOOL YDBQueryRefinesQuery(NSString *query, NSString *baseQuery)
+{
+	if (query == nil || baseQuery == nil) return NO;
+	
+	NSArray<NSString *> *terms = YDBSimpleQueryTerms(query);
+	NSArray<NSString *> *baseTerms = YDBSimpleQueryTerms(baseQuery);
+	
+	if (terms == nil || baseTerms == nil) return NO;
+	if ([terms count] < [baseTerms count]) return NO;
+	
+	// Each base term must be narrowed by the term at the same position.
+	// Any additional terms only narrow the results further.
+	
+	NSUInteger i = 0;
+	for (NSString *baseTerm in baseTerms)
+	{
+		NSString *term = terms[i++];
+		
+		if ([baseTerm hasSuffix:@"*"])
+		{
+			NSString *basePrefix = [baseTerm substringToIndex:([baseTerm length] - 1)];
+			
+			if (![term hasPrefix:basePrefix]) return NO;
+		}
+		else
+		{
+			if (![term isEqualToString:baseTerm]) return NO;
+		}
+	}
+	
+	return YES;
+}
+
 
 @implementation YapDatabaseSearchResultsViewTransaction
 {
@@ -93,6 +168,9 @@ static NSString *const ext_key_query           = @"query";
 	
 	if (![super prepareIfNeeded]) return NO;
 	
+	// Used to validate the query cache (see YapDatabaseSearchResultsViewConnection)
+	snapshot = [databaseTransaction->connection snapshot];
+	
 	__unsafe_unretained YapDatabaseSearchResultsViewConnection *searchResultsConnection =
 	  (YapDatabaseSearchResultsViewConnection *)parentConnection;
 	
@@ -177,12 +255,60 @@ static NSString *const ext_key_query           = @"query";
 	return fts.handler;
 }
 
+/**
+ * Returns YES if the FTS extension uses a tokenizer for which query refinement can be detected.
+ *
+ * A stemming tokenizer (such as porter) may map a longer term to a token that doesn't share the prefix
+ * of the shorter term. So in that case, we can't assume that "yapd*" only matches a subset of "yap*".
+**/
+- (BOOL)supportsQueryRefinement
+{
+	__unsafe_unretained YapDatabaseSearchResultsView *searchResultsView =
+	  (YapDatabaseSearchResultsView *)parentConnection->parent;
+	
+	__unsafe_unretained YapDatabaseFullTextSearchTransaction *ftsTransaction =
+	  [databaseTransaction ext:searchResultsView->fullTextSearchName];
+	
+	__unsafe_unretained YapDatabaseFullTextSearch *fts =
+	  (YapDatabaseFullTextSearch *)ftsTransaction.extensionConnection.extension;
+	
+	id tokenizer = fts->options[@"tokenize"];
+	if (tokenizer == nil) return YES; // default tokenizer (simple / unicode61)
+	
+	if (![tokenizer isKindOfClass:[NSString class]]) return NO;
+	
+	NSString *lowercaseTokenizer = [(NSString *)tokenizer lowercaseString];
+	
+	if ([lowercaseTokenizer rangeOfString:@"porter"].location != NSNotFound) return NO;
+	
+	return ([lowercaseTokenizer rangeOfString:@"simple"].location    != NSNotFound ||
+	        [lowercaseTokenizer rangeOfString:@"unicode61"].location != NSNotFound ||
+	        [lowercaseTokenizer rangeOfString:@"ascii"].location     != NSNotFound);
+}
+
+/**
+ * Returns YES if the current read-write transaction has modified any rows.
+ * If so, the FTS results may have changed since the query cache was populated.
+**/
+- (BOOL)hasPendingRowChanges
+{
+	__unsafe_unretained YapDatabaseConnection *databaseConnection = databaseTransaction->connection;
+	
+	return ([databaseConnection->objectChanges count]      > 0 ||
+	        [databaseConnection->metadataChanges count]    > 0 ||
+	        [databaseConnection->insertedKeys count]       > 0 ||
+	        [databaseConnection->removedKeys count]        > 0 ||
+	        [databaseConnection->removedCollections count] > 0 ||
+	        [databaseConnection->removedRowids count]      > 0 || databaseConnection->allKeysRemoved);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Repopulate
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /**
- * Executes the FTS query, and populates the ftsRowids & snippets ivars.
+ * Executes the FTS query, and populates the ftsRowids ivar.
+ * (Snippets are generated lazily. See snippetForKey:inCollection: & prefetchSnippetsInGroup:range:.)
 **/
 - (void)repopulateFtsRowids
 {
@@ -223,6 +349,133 @@ static NSString *const ext_key_query           = @"query";
 	}];
 }
 
+/**
+ * Populates the ftsRowids ivar, using the query cache if possible.
+ *
+ * - If the query is cached, the cached results are used as-is.
+ * - If the query is a refinement of a cached query, only the cached results are re-checked.
+ * - Otherwise the full FTS query is executed.
+**/
+- (void)repopulateFtsRowidsUsingQueryCache
+{
+	YDBLogAutoTrace();
+	
+	__unsafe_unretained YapDatabaseSearchResultsViewConnection *searchResultsViewConnection =
+	  (YapDatabaseSearchResultsViewConnection *)parentConnection;
+	
+	NSString *query = [self query];
+	
+	YapRowidSet *cachedRowids = [searchResultsViewConnection cachedRowidsForQuery:query snapshot:snapshot];
+	if (cachedRowids)
+	{
+		YDBLogVerbose(@"(%@): Using cached results for query: %@", [self registeredName], query);
+		
+		if (ftsRowids) {
+			YapRowidSetRelease(ftsRowids);
+		}
+		ftsRowids = YapRowidSetCopy(cachedRowids);
+		return;
+	}
+	
+	if ([self supportsQueryRefinement])
+	{
+		// Find the smallest cached result set that's guaranteed to be a superset of the new results.
+		
+		__block YapRowidSet *baseRowids = NULL;
+		
+		[searchResultsViewConnection enumerateCachedQueriesForSnapshot:snapshot
+		                                                     usingBlock:^(NSString *cachedQuery, YapRowidSet *rowids, BOOL *stop)
+		{
+			if (YDBQueryRefinesQuery(query, cachedQuery))
+			{
+				if (baseRowids == NULL || YapRowidSetCount(rowids) < YapRowidSetCount(baseRowids)) {
+					baseRowids = rowids;
+				}
+			}
+		}];
+		
+		if (baseRowids)
+		{
+			YDBLogVerbose(@"(%@): Refining cached results for query: %@", [self registeredName], query);
+			
+			[self refineFtsRowids:baseRowids];
+			return;
+		}
+	}
+	
+	[self repopulateFtsRowids];
+}
+
+/**
+ * Executes the FTS query, but only considers the rowids in the given set.
+ * The given set must be the results of a query for which the current query is a refinement.
+**/
+- (void)refineFtsRowids:(YapRowidSet *)baseRowids
+{
+	YDBLogAutoTrace();
+	
+	__unsafe_unretained YapDatabaseSearchResultsView *searchResultsView =
+	  (YapDatabaseSearchResultsView *)parentConnection->parent;
+	
+	YapDatabaseFullTextSearchTransaction *ftsTransaction =
+	  (YapDatabaseFullTextSearchTransaction *)[databaseTransaction ext:searchResultsView->fullTextSearchName];
+	
+	// Prepare ftsRowids ivar
+	
+	if (ftsRowids)
+		YapRowidSetRemoveAll(ftsRowids);
+	else
+		ftsRowids = YapRowidSetCreate(YapRowidSetCount(baseRowids));
+	
+	// Perform search
+	
+	NSString *query = [self query];
+	__block int processed = 0;
+	
+	if (YapRowidSetCount(baseRowids) <= YDB_SEARCH_REFINEMENT_MAX_ROWID_CHECKS)
+	{
+		YapRowidSetEnumerate(baseRowids, ^(int64_t rowid, BOOL *stop) {
+		#pragma clang diagnostic push
+		#pragma clang diagnostic ignored "-Wimplicit-retain-self"
+			
+			if ([ftsTransaction rowid:rowid matches:query]) {
+				YapRowidSetAdd(ftsRowids, rowid);
+			}
+			
+			if (++processed == 500)
+			{
+				processed = 0;
+				if ([searchQueue shouldAbortSearchInProgressAndRollback:NULL]) {
+					*stop = YES;
+				}
+			}
+		
+		#pragma clang diagnostic pop
+		});
+	}
+	else
+	{
+		[ftsTransaction enumerateRowidsMatching:query usingBlock:^(int64_t rowid, BOOL *stop) {
+		#pragma clang diagnostic push
+		#pragma clang diagnostic ignored "-Wimplicit-retain-self"
+			
+			if (YapRowidSetContains(baseRowids, rowid)) {
+				YapRowidSetAdd(ftsRowids, rowid);
+			}
+			
+			if (++processed == 2500)
+			{
+				processed = 0;
+				if ([searchQueue shouldAbortSearchInProgressAndRollback:NULL]) {
+					*stop = YES;
+				}
+			}
+		
+		#pragma clang diagnostic pop
+		}];
+	}
+}
+
 /**
  * This method is invoked if:
  *
@@ -515,6 +768,32 @@ static NSString *const ext_key_query           = @"query";
 	[super flushPendingChangesToExtensionTables];
 }
 
+/**
+ * Invoked by our YapDatabaseTransaction at the completion of the commitTransaction method.
+**/
+- (void)didCommitTransaction
+{
+	YDBLogAutoTrace();
+	
+	// If this transaction didn't modify any rows, then the FTS results haven't changed.
+	// So the query cache remains valid, even though the snapshot may have been incremented.
+	
+	__unsafe_unretained YapDatabaseSearchResultsViewConnection *searchResultsViewConnection =
+	  (YapDatabaseSearchResultsViewConnection *)parentConnection;
+	
+	if ([self hasPendingRowChanges])
+	{
+		[searchResultsViewConnection flushQueryCache];
+	}
+	else
+	{
+		[searchResultsViewConnection advanceQueryCacheFromSnapshot:snapshot
+		                                                toSnapshot:[databaseTransaction->connection snapshot]];
+	}
+	
+	[super didCommitTransaction];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Logic
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -724,6 +1003,10 @@ static NSString *const ext_key_query           = @"query";
 	__unsafe_unretained YapDatabaseSearchResultsViewOptions *searchResultsOptions =
 	  (YapDatabaseSearchResultsViewOptions *)searchResultsView->options;
 	
+	// Track modified rows for any in-progress time-sliced searches
+	
+	[searchResultsView noteModifiedRowid:rowid];
+	
 	NSAssert((searchResultsView->parentViewName != nil), @"Improper method invocation!");
 	
 	// Should we ignore the row based on the allowedCollections ?
@@ -796,6 +1079,10 @@ static NSString *const ext_key_query           = @"query";
 	__unsafe_unretained YapDatabaseSearchResultsViewOptions *searchResultsOptions =
 	  (YapDatabaseSearchResultsViewOptions *)searchResultsView->options;
 	
+	// Track modified rows for any in-progress time-sliced searches
+	
+	[searchResultsView noteModifiedRowid:rowid];
+	
 	__unsafe_unretained NSString *collection = collectionKey.collection;
 	__unsafe_unretained NSString *key = collectionKey.key;
 	
@@ -1390,6 +1677,60 @@ static NSString *const ext_key_query           = @"query";
 	}
 }
 
+/**
+ * YapDatabase extension hook.
+ * This method is invoked by a YapDatabaseReadWriteTransaction as a post-operation-hook.
+ * This method overrides the version in YapDatabaseAutoViewTransaction.
+**/
+- (void)didRemoveObjectForCollectionKey:(YapCollectionKey *)collectionKey withRowid:(int64_t)rowid
+{
+	YDBLogAutoTrace();
+	
+	__unsafe_unretained YapDatabaseSearchResultsView *searchResultsView =
+	  (YapDatabaseSearchResultsView *)parentConnection->parent;
+	
+	[searchResultsView noteModifiedRowid:rowid];
+	
+	[super didRemoveObjectForCollectionKey:collectionKey withRowid:rowid];
+}
+
+/**
+ * YapDatabase extension hook.
+ * This method is invoked by a YapDatabaseReadWriteTransaction as a post-operation-hook.
+ * This method overrides the version in YapDatabaseAutoViewTransaction.
+**/
+- (void)didRemoveObjectsForKeys:(NSArray *)keys inCollection:(NSString *)collection withRowids:(NSArray *)rowids
+{
+	YDBLogAutoTrace();
+	
+	__unsafe_unretained YapDatabaseSearchResultsView *searchResultsView =
+	  (YapDatabaseSearchResultsView *)parentConnection->parent;
+	
+	for (NSNumber *rowidNumber in rowids)
+	{
+		[searchResultsView noteModifiedRowid:[rowidNumber longLongValue]];
+	}
+	
+	[super didRemoveObjectsForKeys:keys inCollection:collection withRowids:rowids];
+}
+
+/**
+ * YapDatabase extension hook.
+ * This method is invoked by a YapDatabaseReadWriteTransaction as a post-operation-hook.
+ * This method overrides the version in YapDatabaseAutoViewTransaction.
+**/
+- (void)didRemoveAllObjectsInAllCollections
+{
+	YDBLogAutoTrace();
+	
+	__unsafe_unretained YapDatabaseSearchResultsView *searchResultsView =
+	  (YapDatabaseSearchResultsView *)parentConnection->parent;
+	
+	[searchResultsView noteAllRowidsModified];
+	
+	[super didRemoveAllObjectsInAllCollections];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark YapDatabaseViewDependency Protocol
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1648,6 +1989,71 @@ static NSString *const ext_key_query           = @"query";
 	}
 }
 
+/**
+ * Invokes the grouping block to find out if the row should be included in the view.
+ * Returns nil if the row is excluded (by the grouping block, or by the allowedCollections).
+ *
+ * If the object and/or metadata needed to be fetched for the grouping block,
+ * they're returned via the given pointers (so they can be reused for the sorting block).
+**/
+- (NSString *)invokeGroupingForRowid:(int64_t)rowid
+                       collectionKey:(YapCollectionKey *)ck
+                            grouping:(YapDatabaseViewGrouping *)grouping
+                              object:(id *)objectPtr
+                            metadata:(id *)metadataPtr
+{
+	YapWhitelistBlacklist *allowedCollections = parentConnection->parent->options.allowedCollections;
+	
+	if (allowedCollections && ![allowedCollections isAllowed:ck.collection])
+	{
+		return nil;
+	}
+	
+	NSString *group = nil;
+	id object = nil;
+	id metadata = nil;
+	
+	if (grouping->blockType == YapDatabaseBlockTypeWithKey)
+	{
+		__unsafe_unretained YapDatabaseViewGroupingWithKeyBlock groupingBlock =
+		  (YapDatabaseViewGroupingWithKeyBlock)grouping->block;
+		
+		group = groupingBlock(databaseTransaction, ck.collection, ck.key);
+	}
+	else if (grouping->blockType == YapDatabaseBlockTypeWithObject)
+	{
+		__unsafe_unretained YapDatabaseViewGroupingWithObjectBlock groupingBlock =
+		  (YapDatabaseViewGroupingWithObjectBlock)grouping->block;
+		
+		object = [databaseTransaction objectForCollectionKey:ck withRowid:rowid];
+		
+		group = groupingBlock(databaseTransaction, ck.collection, ck.key, object);
+	}
+	else if (grouping->blockType == YapDatabaseBlockTypeWithMetadata)
+	{
+		__unsafe_unretained YapDatabaseViewGroupingWithMetadataBlock groupingBlock =
+		  (YapDatabaseViewGroupingWithMetadataBlock)grouping->block;
+		
+		metadata = [databaseTransaction metadataForCollectionKey:ck withRowid:rowid];
+		
+		group = groupingBlock(databaseTransaction, ck.collection, ck.key, metadata);
+	}
+	else
+	{
+		__unsafe_unretained YapDatabaseViewGroupingWithRowBlock groupingBlock =
+		  (YapDatabaseViewGroupingWithRowBlock)grouping->block;
+		
+		[databaseTransaction getObject:&object metadata:&metadata forCollectionKey:ck withRowid:rowid];
+		
+		group = groupingBlock(databaseTransaction, ck.collection, ck.key, object, metadata);
+	}
+	
+	if (objectPtr) *objectPtr = object;
+	if (metadataPtr) *metadataPtr = metadata;
+	
+	return [group copy]; // mutable string protection
+}
+
 /**
  * This method updates the view by using the updated ftsRowids set.
  * Only use this method if parentViewName is nil.
@@ -1655,6 +2061,20 @@ static NSString *const ext_key_query           = @"query";
  * Note: You must update ftsRowids before invoking this method.
 **/
 - (void)updateViewUsingBlocks
+{
+	[self updateViewUsingBlocksWithGroups:nil];
+}
+
+/**
+ * This method updates the view by using the updated ftsRowids set.
+ * Only use this method if parentViewName is nil.
+ *
+ * The given groups (rowid -> group, or NSNull if excluded from the view) are used instead of
+ * invoking the grouping block for rows that aren't already in the view.
+ *
+ * Note: You must update ftsRowids before invoking this method.
+**/
+- (void)updateViewUsingBlocksWithGroups:(NSDictionary<NSNumber *, id> *)groups
 {
 	YDBLogAutoTrace();
 	
@@ -1759,8 +2179,6 @@ static NSString *const ext_key_query           = @"query";
 	__unsafe_unretained YapDatabaseSearchResultsViewConnection *searchResultsViewConnection =
 	  (YapDatabaseSearchResultsViewConnection *)parentConnection;
 	
-	YapDatabaseViewGroupingBlock groupingBlock_generic = NULL;
-	
 	YapDatabaseViewGrouping *grouping = nil;
 	YapDatabaseViewSorting  *sorting  = nil;
 	
@@ -1777,46 +2195,23 @@ static NSString *const ext_key_query           = @"query";
 		id metadata = nil;
 		
 		// Invoke the grouping block to find out if the object should be included in the view.
+		// Unless the group was already calculated (during a time-sliced search).
 		
 		NSString *group = nil;
-		YapWhitelistBlacklist *allowedCollections = parentConnection->parent->options.allowedCollections;
+		id precalculatedGroup = groups[@(rowid)];
 		
-		if (!allowedCollections || [allowedCollections isAllowed:ck.collection])
+		if (precalculatedGroup)
 		{
-			if (grouping->blockType == YapDatabaseBlockTypeWithKey)
-			{
-				__unsafe_unretained YapDatabaseViewGroupingWithKeyBlock groupingBlock =
-			      (YapDatabaseViewGroupingWithKeyBlock)grouping->block;
-				
-				group = groupingBlock(databaseTransaction, ck.collection, ck.key);
-			}
-			else if (grouping->blockType == YapDatabaseBlockTypeWithObject)
-			{
-				__unsafe_unretained YapDatabaseViewGroupingWithObjectBlock groupingBlock =
-			      (YapDatabaseViewGroupingWithObjectBlock)grouping->block;
-				
-				object = [databaseTransaction objectForCollectionKey:ck withRowid:rowid];
-				
-				group = groupingBlock(databaseTransaction, ck.collection, ck.key, object);
-			}
-			else if (grouping->blockType == YapDatabaseBlockTypeWithMetadata)
-			{
-				__unsafe_unretained YapDatabaseViewGroupingWithMetadataBlock groupingBlock =
-			      (YapDatabaseViewGroupingWithMetadataBlock)grouping->block;
-				
-				metadata = [databaseTransaction metadataForCollectionKey:ck withRowid:rowid];
-				
-				group = groupingBlock(databaseTransaction, ck.collection, ck.key, metadata);
-			}
-			else
-			{
-				__unsafe_unretained YapDatabaseViewGroupingWithRowBlock groupingBlock =
-			      (YapDatabaseViewGroupingWithRowBlock)groupingBlock_generic;
-				
-				[databaseTransaction getObject:&object metadata:&metadata forCollectionKey:ck withRowid:rowid];
-				
-				group = groupingBlock(databaseTransaction, ck.collection, ck.key, object, metadata);
-			}
+			if (precalculatedGroup != [NSNull null])
+				group = (NSString *)precalculatedGroup;
+		}
+		else
+		{
+			group = [self invokeGroupingForRowid:rowid
+			                       collectionKey:ck
+			                            grouping:grouping
+			                              object:&object
+			                            metadata:&metadata];
 		}
 		
 		if (group)
@@ -1872,6 +2267,51 @@ static NSString *const ext_key_query           = @"query";
 	}
 }
 
+/**
+ * This method updates the view when the query is a refinement of the previous query.
+ *
+ * In this case the updated ftsRowids set is a subset of the previous results (baseRowids),
+ * and the view already contains every item from the previous results that belongs in the view.
+ * So we only need to remove the items that no longer match.
+ *
+ * Note: You must update ftsRowids before invoking this method.
+**/
+- (void)updateViewByRemovingUnmatchedRowids:(YapRowidSet *)baseRowids
+{
+	YDBLogAutoTrace();
+	
+	if ([searchQueue shouldAbortSearchInProgressAndRollback:NULL]) {
+		return;
+	}
+	
+	NSMutableDictionary<NSNumber *, YapCollectionKey *> *collectionKeys = [NSMutableDictionary dictionary];
+	NSMutableDictionary<NSNumber *, YapDatabaseViewLocator *> *locators = [NSMutableDictionary dictionary];
+	
+	YapRowidSetEnumerate(baseRowids, ^(int64_t rowid, BOOL __unused *stop) {
+	#pragma clang diagnostic push
+	#pragma clang diagnostic ignored "-Wimplicit-retain-self"
+		
+		if (!YapRowidSetContains(ftsRowids, rowid))
+		{
+			YapDatabaseViewLocator *locator = [self locatorForRowid:rowid];
+			if (locator)
+			{
+				NSNumber *number = @(rowid);
+				
+				collectionKeys[number] = [databaseTransaction collectionKeyForRowid:rowid];
+				locators[number] = locator;
+			}
+		}
+	
+	#pragma clang diagnostic pop
+	});
+	
+	if ([locators count] > 0)
+	{
+		[self removeRowidsWithCollectionKeys:collectionKeys locators:locators];
+	}
+}
+
 /**
  * Updates the view to include search results for the given query.
  *
@@ -1895,21 +2335,62 @@ static NSString *const ext_key_query           = @"query";
 	__unsafe_unretained YapDatabaseSearchResultsViewConnection *searchResultsViewConnection =
 	  (YapDatabaseSearchResultsViewConnection *)parentConnection;
 	
+	NSString *previousQuery = [searchResultsViewConnection query];
+	
 	[searchResultsViewConnection setQuery:query isChange:YES];
 	
-	// Run the query against the FTS extension, and populate the ftsRowids & snippets ivars
+	// Run the query against the FTS extension, and populate the ftsRowids ivar.
+	//
+	// The query cache can only be used if this transaction hasn't modified any rows,
+	// as these changes may have altered the FTS results.
 	
-	[self repopulateFtsRowids];
+	BOOL useQueryCache = ![self hasPendingRowChanges];
+	YapRowidSet *previousRowids = NULL; // owned by the query cache
+	
+	if (useQueryCache)
+	{
+		previousRowids = [searchResultsViewConnection cachedRowidsForQuery:previousQuery snapshot:snapshot];
+		
+		[self repopulateFtsRowidsUsingQueryCache];
+	}
+	else
+	{
+		[self repopulateFtsRowids];
+	}
 	
 	// Update the view (using FTS results stored in ftsRowids)
 	
 	__unsafe_unretained YapDatabaseSearchResultsView *searchResultsView =
 	  (YapDatabaseSearchResultsView *)parentConnection->parent;
 	
-	if (searchResultsView->parentViewName)
+	__unsafe_unretained YapDatabaseSearchResultsViewOptions *searchResultsOptions =
+	  (YapDatabaseSearchResultsViewOptions *)searchResultsView->options;
+	
+	BOOL isRefinement = (previousRowids != NULL)
+	                 && (searchResultsOptions.snippetOptions_NoCopy == nil) // snippets of every item need updating
+	                 && [self supportsQueryRefinement]
+	                 && YDBQueryRefinesQuery(query, previousQuery);
+	
+	if (isRefinement)
+		[self updateViewByRemovingUnmatchedRowids:previousRowids];
+	else if (searchResultsView->parentViewName)
 		[self updateViewFromParent];
 	else
 		[self updateViewUsingBlocks];
+	
+	// Update the query cache.
+	//
+	// If the search was aborted, the results (and the view) may be incomplete.
+	// And the view no longer reflects any cached query, so we can't use the cache for refinement.
+	
+	if ([searchQueue shouldAbortSearchInProgressAndRollback:NULL])
+	{
+		[searchResultsViewConnection flushQueryCache];
+	}
+	else if (useQueryCache)
+	{
+		[searchResultsViewConnection cacheRowids:ftsRowids forQuery:query snapshot:snapshot];
+	}
 }
 
 /**
@@ -1949,11 +2430,251 @@ static NSString *const ext_key_query           = @"query";
 	searchQueue = nil;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Sliced Searching
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Performs the next "slice" of a time-sliced search.
+ * This method is invoked from within a read-only transaction.
+ *
+ * The first slice executes the FTS query.
+ * The following slices invoke the grouping block for matching rows that aren't already in the view,
+ * until the given deadline is reached.
+ *
+ * Returns YES if the search is complete (and ready to be applied via finishSlicedSearch:withQueue:).
+ * Returns NO if there's more work to do (or if the search was aborted).
+**/
+- (BOOL)continueSlicedSearch:(YapDatabaseSearchResultsViewSlicedSearch *)slicedSearch
+                   withQueue:(YapDatabaseSearchQueue *)inSearchQueue
+                    deadline:(CFAbsoluteTime)deadline
+{
+	YDBLogAutoTrace();
+	
+	__unsafe_unretained YapDatabaseSearchResultsView *searchResultsView =
+	  (YapDatabaseSearchResultsView *)parentConnection->parent;
+	
+	searchQueue = inSearchQueue;
+	
+	if (slicedSearch->ftsRowids == NULL)
+	{
+		// Run the query against the FTS extension.
+		//
+		// Note: This isn't resumable, so it always completes within a single slice.
+		// But since it's performed within a read-only transaction, it doesn't block any writers.
+		
+		YapDatabaseFullTextSearchTransaction *ftsTransaction =
+		  (YapDatabaseFullTextSearchTransaction *)[databaseTransaction ext:searchResultsView->fullTextSearchName];
+		
+		YapRowidSet *rowids = YapRowidSetCreate(0);
+		__block int processed = 0;
+		
+		[ftsTransaction enumerateRowidsMatching:slicedSearch->query usingBlock:^(int64_t rowid, BOOL *stop) {
+		#pragma clang diagnostic push
+		#pragma clang diagnostic ignored "-Wimplicit-retain-self"
+			
+			YapRowidSetAdd(rowids, rowid);
+			
+			if (++processed == 2500)
+			{
+				processed = 0;
+				if ([searchQueue shouldAbortSearchInProgressAndRollback:NULL]) {
+					*stop = YES;
+				}
+			}
+		
+		#pragma clang diagnostic pop
+		}];
+		
+		if ([searchQueue shouldAbortSearchInProgressAndRollback:NULL])
+		{
+			YapRowidSetRelease(rowids);
+			searchQueue = nil;
+			return NO;
+		}
+		
+		slicedSearch->ftsRowids = rowids;
+		
+		if (searchResultsView->parentViewName == nil)
+		{
+			// Figure out which rows will need to be grouped.
+			// Rows that are already in the view keep their current group.
+			
+			__unsafe_unretained YapDatabaseSearchResultsViewConnection *searchResultsViewConnection =
+			  (YapDatabaseSearchResultsViewConnection *)parentConnection;
+			
+			YapDatabaseViewGrouping *grouping = nil;
+			[searchResultsViewConnection getGrouping:&grouping sorting:NULL];
+			
+			NSMutableArray<NSNumber *> *ungroupedRowids = [NSMutableArray array];
+			
+			YapRowidSetEnumerate(rowids, ^(int64_t rowid, BOOL __unused *stop) {
+				
+				if (![self containsRowid:rowid]) {
+					[ungroupedRowids addObject:@(rowid)];
+				}
+			});
+			
+			slicedSearch->grouping = grouping;
+			slicedSearch->ungroupedRowids = ungroupedRowids;
+			slicedSearch->groups = [NSMutableDictionary dictionaryWithCapacity:[ungroupedRowids count]];
+		}
+	}
+	
+	// Invoke the grouping block for the remaining rows (until we run out of time)
+	
+	__unsafe_unretained NSMutableArray<NSNumber *> *ungroupedRowids = slicedSearch->ungroupedRowids;
+	int processed = 0;
+	
+	while ([ungroupedRowids count] > 0)
+	{
+		@autoreleasepool {
+			
+			NSNumber *rowidNumber = [ungroupedRowids lastObject];
+			int64_t rowid = [rowidNumber longLongValue];
+			
+			NSString *group = nil;
+			
+			YapCollectionKey *ck = [databaseTransaction collectionKeyForRowid:rowid];
+			if (ck)
+			{
+				group = [self invokeGroupingForRowid:rowid
+				                       collectionKey:ck
+				                            grouping:slicedSearch->grouping
+				                              object:NULL
+				                            metadata:NULL];
+			}
+			
+			slicedSearch->groups[rowidNumber] = group ?: [NSNull null];
+			[ungroupedRowids removeLastObject];
+		}
+		
+		if (++processed == 16)
+		{
+			processed = 0;
+			if ([searchQueue shouldAbortSearchInProgressAndRollback:NULL] || (CFAbsoluteTimeGetCurrent() >= deadline)) {
+				break;
+			}
+		}
+	}
+	
+	BOOL done = ([ungroupedRowids count] == 0) && ![searchQueue shouldAbortSearchInProgressAndRollback:NULL];
+	
+	searchQueue = nil;
+	return done;
+}
+
+/**
+ * Applies the results of a time-sliced search to the view.
+ * This method is invoked from within a read-write transaction.
+ *
+ * Rows may have been modified since the search was performed (by this or any other connection).
+ * So the FTS results & groups for those rows are recalculated before the view is updated.
+**/
+- (void)finishSlicedSearch:(YapDatabaseSearchResultsViewSlicedSearch *)slicedSearch
+                 withQueue:(YapDatabaseSearchQueue *)inSearchQueue
+{
+	YDBLogAutoTrace();
+	
+	if (!databaseTransaction->isReadWriteTransaction)
+	{
+		YDBLogWarn(@"Method only allowed in readWrite transaction");
+		return;
+	}
+	
+	__unsafe_unretained YapDatabaseSearchResultsView *searchResultsView =
+	  (YapDatabaseSearchResultsView *)parentConnection->parent;
+	
+	__unsafe_unretained YapDatabaseSearchResultsViewConnection *searchResultsViewConnection =
+	  (YapDatabaseSearchResultsViewConnection *)parentConnection;
+	
+	searchQueue = inSearchQueue;
+	
+	// Update stored query
+	
+	NSString *query = slicedSearch->query;
+	[searchResultsViewConnection setQuery:query isChange:YES];
+	
+	// Reconcile the search results with any rows modified in the meantime.
+	//
+	// Changes made by other processes aren't tracked,
+	// so we have to start over if multi-process support is enabled.
+	
+	NSMutableDictionary<NSNumber *, id> *groups = slicedSearch->groups;
+	
+	if (slicedSearch->allRowidsModified ||
+	    databaseTransaction->connection->database.options.enableMultiProcessSupport)
+	{
+		[self repopulateFtsRowids];
+		groups = nil;
+	}
+	else
+	{
+		if (ftsRowids) {
+			YapRowidSetRelease(ftsRowids);
+		}
+		ftsRowids = YapRowidSetCopy(slicedSearch->ftsRowids);
+		
+		YapDatabaseFullTextSearchTransaction *ftsTransaction =
+		  (YapDatabaseFullTextSearchTransaction *)[databaseTransaction ext:searchResultsView->fullTextSearchName];
+		
+		YapRowidSetEnumerate(slicedSearch->modifiedRowids, ^(int64_t rowid, BOOL __unused *stop) {
+		#pragma clang diagnostic push
+		#pragma clang diagnostic ignored "-Wimplicit-retain-self"
+			
+			if ([ftsTransaction rowid:rowid matches:query])
+				YapRowidSetAdd(ftsRowids, rowid);
+			else
+				YapRowidSetRemove(ftsRowids, rowid);
+			
+			[groups removeObjectForKey:@(rowid)];
+		
+		#pragma clang diagnostic pop
+		});
+	}
+	
+	// Update the view (using FTS results stored in ftsRowids)
+	
+	if (searchResultsView->parentViewName)
+	{
+		[self updateViewFromParent];
+	}
+	else
+	{
+		// If the grouping was changed in the meantime, the calculated groups are useless.
+		
+		YapDatabaseViewGrouping *grouping = nil;
+		[searchResultsViewConnection getGrouping:&grouping sorting:NULL];
+		
+		if (grouping != slicedSearch->grouping) {
+			groups = nil;
+		}
+		
+		[self updateViewUsingBlocksWithGroups:groups];
+	}
+	
+	// Update the query cache
+	
+	if ([searchQueue shouldAbortSearchInProgressAndRollback:NULL])
+	{
+		[searchResultsViewConnection flushQueryCache];
+	}
+	else if (![self hasPendingRowChanges])
+	{
+		[searchResultsViewConnection cacheRowids:ftsRowids forQuery:query snapshot:snapshot];
+	}
+	
+	searchQueue = nil;
+}
+
 - (NSString *)snippetForKey:(NSString *)key inCollection:(NSString *)collection
 {
 	__unsafe_unretained YapDatabaseSearchResultsView *searchResultsView =
 	  (YapDatabaseSearchResultsView *)parentConnection->parent;
 	
+	__unsafe_unretained YapDatabaseSearchResultsViewConnection *searchResultsViewConnection =
+	  (YapDatabaseSearchResultsViewConnection *)parentConnection;
+	
 	__unsafe_unretained YapDatabaseSearchResultsViewOptions *searchResultsOptions =
 	  (YapDatabaseSearchResultsViewOptions *)searchResultsView->options;
 	
@@ -1970,12 +2691,110 @@ static NSString *const ext_key_query           = @"query";
 		return nil;
 	}
 	
+	NSString *query = [self query];
+	
+	// The cache is only valid for committed data.
+	// So we bypass it if this read-write transaction has modified any rows.
+	
+	BOOL useCache = ![self hasPendingRowChanges];
+	if (useCache)
+	{
+		id cachedSnippet = [searchResultsViewConnection cachedSnippetForRowid:rowid query:query snapshot:snapshot];
+		if (cachedSnippet)
+		{
+			if (cachedSnippet == [NSNull null])
+				return nil;
+			else
+				return (NSString *)cachedSnippet;
+		}
+	}
+	
 	YapDatabaseFullTextSearchTransaction *ftsTransaction =
 	  [databaseTransaction ext:searchResultsView->fullTextSearchName];
 	
-	NSString *snippet = [ftsTransaction rowid:rowid matches:[self query] withSnippetOptions:snippetOptions];
+	NSString *snippet = [ftsTransaction rowid:rowid matches:query withSnippetOptions:snippetOptions];
+	
+	if (useCache)
+	{
+		[searchResultsViewConnection cacheSnippets:@{ @(rowid): (snippet ?: [NSNull null]) }
+		                                  forQuery:query
+		                                  snapshot:snapshot];
+	}
 	
 	return snippet;
 }
 
+- (void)prefetchSnippetsInGroup:(NSString *)group range:(NSRange)range
+{
+	__unsafe_unretained YapDatabaseSearchResultsView *searchResultsView =
+	  (YapDatabaseSearchResultsView *)parentConnection->parent;
+	
+	__unsafe_unretained YapDatabaseSearchResultsViewConnection *searchResultsViewConnection =
+	  (YapDatabaseSearchResultsViewConnection *)parentConnection;
+	
+	__unsafe_unretained YapDatabaseSearchResultsViewOptions *searchResultsOptions =
+	  (YapDatabaseSearchResultsViewOptions *)searchResultsView->options;
+	
+	__unsafe_unretained YapDatabaseFullTextSearchSnippetOptions *snippetOptions =
+	  searchResultsOptions.snippetOptions_NoCopy;
+	
+	if (snippetOptions == nil) {
+		// Ignore - snippets not being used
+		return;
+	}
+	
+	if (searchResultsOptions.snippetCacheLimit == 0) return;
+	if ([self hasPendingRowChanges]) return;
+	
+	NSString *query = [self query];
+	if ([query length] == 0) return;
+	
+	NSUInteger count = [self numberOfItemsInGroup:group];
+	if (range.location >= count) return;
+	
+	range.length = MIN(range.length, count - range.location);
+	range.length = MIN(range.length, searchResultsOptions.snippetCacheLimit);
+	
+	// Gather the rows that aren't already cached
+	
+	NSMutableArray<NSNumber *> *rowids = [NSMutableArray arrayWithCapacity:range.length];
+	
+	[self enumerateRowidsInGroup:group
+	                 withOptions:0
+	                       range:range
+	                  usingBlock:^(int64_t rowid, NSUInteger __unused index, BOOL __unused *stop)
+	{
+		if ([searchResultsViewConnection cachedSnippetForRowid:rowid query:query snapshot:self->snapshot] == nil)
+		{
+			[rowids addObject:@(rowid)];
+		}
+	}];
+	
+	if ([rowids count] == 0) return;
+	
+	// Fetch all the snippets in a single FTS query
+	
+	YapDatabaseFullTextSearchTransaction *ftsTransaction =
+	  [databaseTransaction ext:searchResultsView->fullTextSearchName];
+	
+	NSMutableDictionary<NSNumber *, id> *snippets = [NSMutableDictionary dictionaryWithCapacity:[rowids count]];
+	
+	[ftsTransaction enumerateSnippetsForRowids:rowids
+	                                  matching:query
+	                        withSnippetOptions:snippetOptions
+	                                usingBlock:^(NSString *snippet, int64_t rowid, BOOL __unused *stop)
+	{
+		snippets[@(rowid)] = snippet;
+	}];
+	
+	for (NSNumber *rowidNumber in rowids)
+	{
+		if (snippets[rowidNumber] == nil) {
+			snippets[rowidNumber] = [NSNull null];
+		}
+	}
+	
+	[searchResultsViewConnection cacheSnippets:snippets forQuery:query snapshot:snapshot];
+}
+
 @end
@@ -23,7 +23,7 @@
  * If there is a major re-write to this class, then the version number will be incremented,
  * and the class can automatically rebuild the table as needed.
  */
-#define YAP_DATABASE_SECONDARY_INDEX_CLASS_VERSION 1
+#define YAP_DATABASE_SECONDARY_INDEX_CLASS_VERSION 2
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark -
@@ -56,6 +56,13 @@
  */
 - (BOOL)matchesExistingColumnNamesAndAffinity:(NSDictionary *)columns;
 
+/**
+ * Whether the setup contains any expression columns (calculated by sqlite),
+ * and/or any regular columns (provided by the handler block).
+ */
+- (BOOL)hasExpressionColumns;
+- (BOOL)hasBlockColumns;
+
 @end
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -68,14 +75,22 @@
 	YapDatabaseSecondaryIndexSetup *setup;
 	YapDatabaseSecondaryIndexOptions *options;
 	
+	NSArray<YapDatabaseSecondaryIndexAggregate *> *aggregates;
+	
 	YapDatabaseSecondaryIndexHandler *handler;
 	
+	BOOL hasBlockColumns;
+	BOOL hasExpressionColumns;
+	
 	NSString *versionTag;
 	
 	id columnNamesSharedKeySet;
 }
 
++ (NSString *)aggregatesTableNameForRegisteredName:(NSString *)registeredName;
+
 - (NSString *)tableName;
+- (NSString *)aggregatesTableName;
 
 @end
 
@@ -94,6 +109,8 @@
 	YapCache<NSString *, YapDatabaseStatement *> *queryCache;
 	NSUInteger queryCacheLimit;
 	
+	YapDatabaseSlowQueryLog *slowQueryLog;
+	
 	YapMutationStack_Bool *mutationStack;
 }
 
@@ -107,6 +124,22 @@
 - (sqlite3_stmt *)updateStatement;
 - (sqlite3_stmt *)removeStatement;
 - (sqlite3_stmt *)removeAllStatement;
+- (sqlite3_stmt *)unchangedStatement;
+
+- (sqlite3_stmt *)bulkInsertStatement;
+- (NSUInteger)bulkInsertRowCount;
+
+- (sqlite3_stmt *)expressionInsertStatement;
+
+- (sqlite3_stmt *)aggregateContributionsStatement;
+- (sqlite3_stmt *)aggregateAddStatement;
+- (sqlite3_stmt *)aggregateInsertStatement;
+- (sqlite3_stmt *)aggregateRemoveStatement;
+- (sqlite3_stmt *)aggregateRemoveEmptyStatement;
+- (sqlite3_stmt *)aggregateRemoveAllStatement;
+- (sqlite3_stmt *)aggregateValueStatement;
+- (sqlite3_stmt *)aggregateGroupsStatement;
+- (sqlite3_stmt *)aggregateExtremeStatementAtIndex:(NSUInteger)index;
 
 @end
 
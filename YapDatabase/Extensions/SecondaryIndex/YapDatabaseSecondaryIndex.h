@@ -115,6 +115,20 @@ NS_ASSUME_NONNULL_BEGIN
          versionTag:(nullable NSString *)versionTag
             options:(nullable YapDatabaseSecondaryIndexOptions *)options;
 
+/**
+ * Creates a new secondary index extension, for a setup that only contains expression columns.
+ *
+ * No handler is needed, as sqlite calculates every column from the serialized rows in the database.
+ * So populating & updating the index doesn't require invoking any blocks, or deserializing any objects.
+ *
+ * The row is re-indexed whenever its object or metadata is modified.
+ *
+ * @see -[YapDatabaseSecondaryIndexSetup addColumn:withType:expression:]
+ */
+- (id)initWithSetup:(YapDatabaseSecondaryIndexSetup *)setup
+         versionTag:(nullable NSString *)versionTag
+            options:(nullable YapDatabaseSecondaryIndexOptions *)options;
+
 
 /* Inherited from YapDatabaseExtension
  
@@ -38,6 +38,16 @@
 	{
 		YDBLogError(@"Failed dropping table (%@): %d %s", tableName, status, sqlite3_errmsg(db));
 	}
+	
+	NSString *aggregatesTableName = [self aggregatesTableNameForRegisteredName:registeredName];
+	
+	dropTable = [NSString stringWithFormat:@"DROP TABLE IF EXISTS \"%@\";", aggregatesTableName];
+	
+	status = sqlite3_exec(db, [dropTable UTF8String], NULL, NULL, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Failed dropping table (%@): %d %s", aggregatesTableName, status, sqlite3_errmsg(db));
+	}
 }
 
 + (NSArray *)previousClassNames
@@ -50,6 +60,11 @@
 	return [NSString stringWithFormat:@"secondaryIndex_%@", registeredName];
 }
 
++ (NSString *)aggregatesTableNameForRegisteredName:(NSString *)registeredName
+{
+	return [NSString stringWithFormat:@"secondaryIndexAggregates_%@", registeredName];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Instance
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -75,6 +90,13 @@
 	return [self initWithSetup:inSetup handler:inHandler versionTag:inVersionTag options:nil];
 }
 
+- (id)initWithSetup:(YapDatabaseSecondaryIndexSetup *)inSetup
+         versionTag:(NSString *)inVersionTag
+            options:(YapDatabaseSecondaryIndexOptions *)inOptions
+{
+	return [self initWithSetup:inSetup handler:nil versionTag:inVersionTag options:inOptions];
+}
+
 - (id)initWithSetup:(YapDatabaseSecondaryIndexSetup *)inSetup
             handler:(YapDatabaseSecondaryIndexHandler *)inHandler
          versionTag:(NSString *)inVersionTag
@@ -98,7 +120,7 @@
 		return nil;
 	}
 	
-	if (inHandler == NULL)
+	if (inHandler == NULL && [inSetup hasBlockColumns])
 	{
 		NSAssert(NO, @"Invalid handler: NULL");
 		
@@ -113,7 +135,24 @@
 		setup = [inSetup copy];
 		handler = inHandler;
 		
+		hasBlockColumns = [setup hasBlockColumns];
+		hasExpressionColumns = [setup hasExpressionColumns];
+		
+		if (handler == nil)
+		{
+			// Every column is an expression column, so the block is never invoked.
+			// The handler only specifies when the row needs to be re-indexed.
+			
+			YapDatabaseBlockInvoke invokeOptions =
+			  YapDatabaseBlockInvokeIfObjectModified | YapDatabaseBlockInvokeIfMetadataModified;
+			
+			handler = [YapDatabaseSecondaryIndexHandler withOptions:invokeOptions keyBlock:
+			    ^(YapDatabaseReadTransaction __unused *transaction, NSMutableDictionary __unused *dict,
+			      NSString __unused *collection, NSString __unused *key){}];
+		}
+		
 		columnNamesSharedKeySet = [NSDictionary sharedKeySetForKeys:[setup columnNames]];
+		aggregates = [setup aggregates];
 		
 		versionTag = inVersionTag ? [inVersionTag copy] : @"";
 		
@@ -132,4 +171,9 @@
 	return [[self class] tableNameForRegisteredName:self.registeredName];
 }
 
+- (NSString *)aggregatesTableName
+{
+	return [[self class] aggregatesTableNameForRegisteredName:self.registeredName];
+}
+
 @end
@@ -1,5 +1,6 @@
 #import <Foundation/Foundation.h>
 #import "YapDatabaseExtensionConnection.h"
+#import "YapDatabaseQuery.h"
 
 @class YapDatabaseSecondaryIndex;
 
@@ -31,6 +32,34 @@ NS_ASSUME_NONNULL_BEGIN
 @property (atomic, assign, readwrite) BOOL queryCacheEnabled;
 @property (atomic, assign, readwrite) NSUInteger queryCacheLimit;
 
+/**
+ * The slow query log records every query (executed through this connection) that takes
+ * longer than the slowQueryThreshold. This includes the query text, the shape of the parameters
+ * (but not their values), the number of rows returned, and the elapsed time.
+ *
+ * Note that for enumerations, the elapsed time includes the time spent within your block.
+ *
+ * By default the slow query log is disabled (slowQueryThreshold is ZERO).
+ * Setting the slowQueryThreshold to ZERO disables the log again, and discards its contents.
+ */
+@property (atomic, assign, readwrite) NSTimeInterval slowQueryThreshold;
+
+/**
+ * Returns the most recent slow queries (oldest first).
+ */
+- (NSArray<YapDatabaseSlowQuery *> *)slowQueries;
+
+/**
+ * Returns a summary of the slow queries, grouped by query text,
+ * and sorted by total duration (slowest first).
+ */
+- (NSArray<YapDatabaseSlowQuerySummary *> *)slowQuerySummary;
+
+/**
+ * Removes everything from the slow query log (without disabling it).
+ */
+- (void)removeAllSlowQueries;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -30,6 +30,18 @@
 	sqlite3_stmt *updateStatement;
 	sqlite3_stmt *removeStatement;
 	sqlite3_stmt *removeAllStatement;
+	sqlite3_stmt *unchangedStatement;
+	sqlite3_stmt *bulkInsertStatement;
+	sqlite3_stmt *expressionInsertStatement;
+	sqlite3_stmt *aggregateContributionsStatement;
+	sqlite3_stmt *aggregateAddStatement;
+	sqlite3_stmt *aggregateInsertStatement;
+	sqlite3_stmt *aggregateRemoveStatement;
+	sqlite3_stmt *aggregateRemoveEmptyStatement;
+	sqlite3_stmt *aggregateRemoveAllStatement;
+	sqlite3_stmt *aggregateValueStatement;
+	sqlite3_stmt *aggregateGroupsStatement;
+	sqlite3_stmt **aggregateExtremeStatements; // one per aggregate (only used for MIN & MAX aggregates)
 }
 
 @synthesize secondaryIndex = parent;
@@ -62,6 +74,29 @@
 	sqlite_finalize_null(&updateStatement);
 	sqlite_finalize_null(&removeStatement);
 	sqlite_finalize_null(&removeAllStatement);
+	sqlite_finalize_null(&unchangedStatement);
+	sqlite_finalize_null(&bulkInsertStatement);
+	sqlite_finalize_null(&expressionInsertStatement);
+	sqlite_finalize_null(&aggregateContributionsStatement);
+	sqlite_finalize_null(&aggregateAddStatement);
+	sqlite_finalize_null(&aggregateInsertStatement);
+	sqlite_finalize_null(&aggregateRemoveStatement);
+	sqlite_finalize_null(&aggregateRemoveEmptyStatement);
+	sqlite_finalize_null(&aggregateRemoveAllStatement);
+	sqlite_finalize_null(&aggregateValueStatement);
+	sqlite_finalize_null(&aggregateGroupsStatement);
+	
+	if (aggregateExtremeStatements)
+	{
+		NSUInteger count = [parent->aggregates count];
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			sqlite_finalize_null(&aggregateExtremeStatements[i]);
+		}
+		
+		free(aggregateExtremeStatements);
+		aggregateExtremeStatements = NULL;
+	}
 }
 
 /**
@@ -169,6 +204,93 @@
 		dispatch_async(databaseConnection->connectionQueue, block);
 }
 
+- (NSTimeInterval)slowQueryThreshold
+{
+	__block NSTimeInterval result = 0.0;
+	
+	dispatch_block_t block = ^{
+		
+		result = self->slowQueryLog.threshold;
+	};
+	
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_sync(databaseConnection->connectionQueue, block);
+	
+	return result;
+}
+
+- (void)setSlowQueryThreshold:(NSTimeInterval)newSlowQueryThreshold
+{
+	dispatch_block_t block = ^{
+		
+		if (newSlowQueryThreshold > 0.0)
+		{
+			if (self->slowQueryLog == nil)
+				self->slowQueryLog = [[YapDatabaseSlowQueryLog alloc] initWithThreshold:newSlowQueryThreshold];
+			else
+				self->slowQueryLog.threshold = newSlowQueryThreshold;
+		}
+		else
+		{
+			self->slowQueryLog = nil;
+		}
+	};
+	
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_async(databaseConnection->connectionQueue, block);
+}
+
+- (NSArray<YapDatabaseSlowQuery *> *)slowQueries
+{
+	__block NSArray<YapDatabaseSlowQuery *> *result = nil;
+	
+	dispatch_block_t block = ^{
+		
+		result = [self->slowQueryLog queries];
+	};
+	
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_sync(databaseConnection->connectionQueue, block);
+	
+	return result ?: [NSArray array];
+}
+
+- (NSArray<YapDatabaseSlowQuerySummary *> *)slowQuerySummary
+{
+	__block NSArray<YapDatabaseSlowQuerySummary *> *result = nil;
+	
+	dispatch_block_t block = ^{
+		
+		result = [self->slowQueryLog summaries];
+	};
+	
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_sync(databaseConnection->connectionQueue, block);
+	
+	return result ?: [NSArray array];
+}
+
+- (void)removeAllSlowQueries
+{
+	dispatch_block_t block = ^{
+		
+		[self->slowQueryLog removeAllQueries];
+	};
+	
+	if (dispatch_get_specific(databaseConnection->IsOnConnectionQueueKey))
+		block();
+	else
+		dispatch_async(databaseConnection->connectionQueue, block);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Transactions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -327,6 +449,154 @@
 	return *statement;
 }
 
+/**
+ * The number of rows inserted by each execution of the bulkInsertStatement.
+ *
+ * This is limited by the maximum number of parameters in a single statement,
+ * which defaults to 999 in older versions of sqlite.
+**/
+- (NSUInteger)bulkInsertRowCount
+{
+	NSUInteger parametersPerRow = 1 + [parent->setup count]; // rowid + columns
+	
+	return MAX(1, MIN(100, (999 / parametersPerRow)));
+}
+
+/**
+ * Multi-row version of the insertStatement, used when populating the table.
+**/
+- (sqlite3_stmt *)bulkInsertStatement
+{
+	sqlite3_stmt **statement = &bulkInsertStatement;
+	if (*statement == NULL)
+	{
+		NSMutableString *string = [NSMutableString stringWithCapacity:100];
+		[string appendFormat:@"INSERT INTO \"%@\" (\"rowid\"", [parent tableName]];
+		
+		for (YapDatabaseSecondaryIndexColumn *column in parent->setup)
+		{
+			[string appendFormat:@", \"%@\"", column.name];
+		}
+		
+		[string appendString:@") VALUES "];
+		
+		NSUInteger count = [parent->setup count];
+		NSUInteger rowCount = [self bulkInsertRowCount];
+		
+		for (NSUInteger row = 0; row < rowCount; row++)
+		{
+			if (row > 0)
+				[string appendString:@", "];
+			
+			[string appendString:@"(?"];
+			
+			for (NSUInteger i = 0; i < count; i++)
+			{
+				[string appendString:@", ?"];
+			}
+			
+			[string appendString:@")"];
+		}
+		
+		[string appendString:@";"];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+/**
+ * Used (instead of the insertStatement & updateStatement) when the setup contains expression columns.
+ *
+ * The expression columns are calculated by sqlite from the row in the database table,
+ * and the regular columns are bound as usual (in the order of the setup columns, starting at ?2).
+ *
+ * The last parameter is a flag that indicates whether the handler block provided any values.
+ * If it didn't, then the row is only written if at least one of the expressions is non-NULL.
+**/
+- (sqlite3_stmt *)expressionInsertStatement
+{
+	sqlite3_stmt **statement = &expressionInsertStatement;
+	if (*statement == NULL)
+	{
+		// INSERT OR REPLACE INTO "tableName" ("rowid", "column1", "column2", ...)
+		//   SELECT "_rowid", ?2, "_e1", ... FROM
+		//     (SELECT "rowid" AS "_rowid", (expression2) AS "_e1", ... FROM "database2" WHERE "rowid" = ?1)
+		//   WHERE ?N OR "_e1" IS NOT NULL OR ...;
+		
+		NSMutableString *columns = [NSMutableString stringWithString:@"\"rowid\""];
+		NSMutableString *values = [NSMutableString stringWithString:@"\"_rowid\""];
+		NSMutableString *expressions = [NSMutableString stringWithString:@"\"rowid\" AS \"_rowid\""];
+		NSMutableString *where = [NSMutableString string];
+		
+		NSUInteger i = 0;
+		for (YapDatabaseSecondaryIndexColumn *column in parent->setup)
+		{
+			[columns appendFormat:@", \"%@\"", column.name];
+			
+			if (column.expression)
+			{
+				[values appendFormat:@", \"_e%lu\"", (unsigned long)i];
+				[expressions appendFormat:@", (%@) AS \"_e%lu\"", column.expression, (unsigned long)i];
+				[where appendFormat:@" OR \"_e%lu\" IS NOT NULL", (unsigned long)i];
+			}
+			else
+			{
+				[values appendFormat:@", ?%lu", (unsigned long)(i + 2)];
+			}
+			
+			i++;
+		}
+		
+		NSString *string = [NSString stringWithFormat:
+		  @"INSERT OR REPLACE INTO \"%@\" (%@) SELECT %@ FROM"
+		  @" (SELECT %@ FROM \"database2\" WHERE \"rowid\" = ?1) WHERE ?%lu%@;",
+		  [parent tableName], columns, values, expressions, (unsigned long)(i + 2), where];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+- (sqlite3_stmt *)unchangedStatement
+{
+	sqlite3_stmt **statement = &unchangedStatement;
+	if (*statement == NULL)
+	{
+		// The IS operator (unlike =) treats two NULL values as equal.
+		//
+		// The parameters are numbered explicitly (?2 is the first column, and so on),
+		// because expression columns are compared against the expression (evaluated for rowid ?1) instead.
+		
+		NSMutableString *string = [NSMutableString stringWithCapacity:100];
+		[string appendFormat:@"SELECT 1 FROM \"%@\" WHERE \"rowid\" = ?1", [parent tableName]];
+		
+		NSUInteger i = 0;
+		for (YapDatabaseSecondaryIndexColumn *column in parent->setup)
+		{
+			if (column.expression)
+			{
+				[string appendFormat:@" AND \"%@\" IS (SELECT (%@) FROM \"database2\" WHERE \"rowid\" = ?1)",
+				                     column.name, column.expression];
+			}
+			else
+			{
+				[string appendFormat:@" AND \"%@\" IS ?%lu", column.name, (unsigned long)(i + 2)];
+			}
+			
+			i++;
+		}
+		
+		[string appendString:@";"];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
 - (sqlite3_stmt *)removeStatement
 {
 	sqlite3_stmt **statement = &removeStatement;
@@ -355,4 +625,210 @@
 	return *statement;
 }
 
+/**
+ * Returns the current (group, value) of a row for each of the materialized aggregates,
+ * along with whether or not the row matches the aggregate's predicate.
+ *
+ * SELECT "group1", "column1", CASE WHEN (predicate1) THEN 1 ELSE 0 END, ... FROM "tableName" WHERE "rowid" = ?;
+**/
+- (sqlite3_stmt *)aggregateContributionsStatement
+{
+	sqlite3_stmt **statement = &aggregateContributionsStatement;
+	if (*statement == NULL)
+	{
+		NSMutableString *string = [NSMutableString stringWithCapacity:100];
+		[string appendString:@"SELECT "];
+		
+		NSUInteger i = 0;
+		for (YapDatabaseSecondaryIndexAggregate *aggregate in parent->aggregates)
+		{
+			if (i > 0)
+				[string appendString:@", "];
+			
+			if (aggregate.groupByColumn)
+				[string appendFormat:@"\"%@\", ", aggregate.groupByColumn];
+			else
+				[string appendString:@"NULL, "];
+			
+			if (aggregate.column)
+				[string appendFormat:@"\"%@\", ", aggregate.column];
+			else
+				[string appendString:@"NULL, "];
+			
+			if (aggregate.predicate)
+				[string appendFormat:@"CASE WHEN (%@) THEN 1 ELSE 0 END", aggregate.predicate];
+			else
+				[string appendString:@"1"];
+			
+			i++;
+		}
+		
+		[string appendFormat:@" FROM \"%@\" WHERE \"rowid\" = ?;", [parent tableName]];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+- (sqlite3_stmt *)aggregateAddStatement
+{
+	sqlite3_stmt **statement = &aggregateAddStatement;
+	if (*statement == NULL)
+	{
+		// ?1 = name, ?2 = group, ?3 = value
+		
+		NSString *string = [NSString stringWithFormat:
+		  @"UPDATE \"%@\" SET \"rows\" = \"rows\" + 1, \"count\" = \"count\" + (?3 IS NOT NULL),"
+		  @" \"sum\" = CASE WHEN ?3 IS NULL THEN \"sum\" WHEN \"sum\" IS NULL THEN ?3 ELSE \"sum\" + ?3 END,"
+		  @" \"min\" = CASE WHEN ?3 IS NOT NULL AND (\"min\" IS NULL OR ?3 < \"min\") THEN ?3 ELSE \"min\" END,"
+		  @" \"max\" = CASE WHEN ?3 IS NOT NULL AND (\"max\" IS NULL OR ?3 > \"max\") THEN ?3 ELSE \"max\" END"
+		  @" WHERE \"name\" = ?1 AND \"group\" IS ?2;", [parent aggregatesTableName]];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+- (sqlite3_stmt *)aggregateInsertStatement
+{
+	sqlite3_stmt **statement = &aggregateInsertStatement;
+	if (*statement == NULL)
+	{
+		// ?1 = name, ?2 = group, ?3 = value
+		
+		NSString *string = [NSString stringWithFormat:
+		  @"INSERT INTO \"%@\" (\"name\", \"group\", \"rows\", \"count\", \"sum\", \"min\", \"max\")"
+		  @" VALUES (?1, ?2, 1, (?3 IS NOT NULL), ?3, ?3, ?3);", [parent aggregatesTableName]];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+- (sqlite3_stmt *)aggregateRemoveStatement
+{
+	sqlite3_stmt **statement = &aggregateRemoveStatement;
+	if (*statement == NULL)
+	{
+		// ?1 = name, ?2 = group, ?3 = value
+		//
+		// Note: The min & max are updated separately (only when the current min/max value is removed).
+		
+		NSString *string = [NSString stringWithFormat:
+		  @"UPDATE \"%@\" SET \"rows\" = \"rows\" - 1, \"count\" = \"count\" - (?3 IS NOT NULL),"
+		  @" \"sum\" = CASE WHEN ?3 IS NULL THEN \"sum\" WHEN \"count\" = 1 THEN NULL ELSE \"sum\" - ?3 END"
+		  @" WHERE \"name\" = ?1 AND \"group\" IS ?2;", [parent aggregatesTableName]];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+- (sqlite3_stmt *)aggregateRemoveEmptyStatement
+{
+	sqlite3_stmt **statement = &aggregateRemoveEmptyStatement;
+	if (*statement == NULL)
+	{
+		NSString *string = [NSString stringWithFormat:
+		  @"DELETE FROM \"%@\" WHERE \"name\" = ? AND \"group\" IS ? AND \"rows\" <= 0;", [parent aggregatesTableName]];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+- (sqlite3_stmt *)aggregateRemoveAllStatement
+{
+	sqlite3_stmt **statement = &aggregateRemoveAllStatement;
+	if (*statement == NULL)
+	{
+		NSString *string = [NSString stringWithFormat:
+		  @"DELETE FROM \"%@\";", [parent aggregatesTableName]];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+- (sqlite3_stmt *)aggregateValueStatement
+{
+	sqlite3_stmt **statement = &aggregateValueStatement;
+	if (*statement == NULL)
+	{
+		NSString *string = [NSString stringWithFormat:
+		  @"SELECT \"rows\", \"count\", \"sum\", \"min\", \"max\" FROM \"%@\" WHERE \"name\" = ? AND \"group\" IS ?;",
+		  [parent aggregatesTableName]];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+- (sqlite3_stmt *)aggregateGroupsStatement
+{
+	sqlite3_stmt **statement = &aggregateGroupsStatement;
+	if (*statement == NULL)
+	{
+		NSString *string = [NSString stringWithFormat:
+		  @"SELECT \"group\", \"rows\", \"count\", \"sum\", \"min\", \"max\" FROM \"%@\" WHERE \"name\" = ?;",
+		  [parent aggregatesTableName]];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+/**
+ * Recalculates the min (or max) value of a group, after the current min (or max) value was removed.
+ * The statement is specific to the aggregate (column, groupBy & predicate), so there's one per aggregate.
+ *
+ * ?1 = name, ?2 = group, ?3 = removed value
+ *
+ * UPDATE "aggregatesTableName"
+ *   SET "min" = (SELECT MIN("column") FROM "tableName" WHERE "groupBy" IS ?2 AND (predicate))
+ *   WHERE "name" = ?1 AND "group" IS ?2 AND "min" = ?3;
+**/
+- (sqlite3_stmt *)aggregateExtremeStatementAtIndex:(NSUInteger)index
+{
+	NSArray<YapDatabaseSecondaryIndexAggregate *> *aggregates = parent->aggregates;
+	if (index >= [aggregates count]) return NULL;
+	
+	if (aggregateExtremeStatements == NULL)
+		aggregateExtremeStatements = (sqlite3_stmt **)calloc([aggregates count], sizeof(sqlite3_stmt *));
+	
+	sqlite3_stmt **statement = &aggregateExtremeStatements[index];
+	if (*statement == NULL)
+	{
+		YapDatabaseSecondaryIndexAggregate *aggregate = aggregates[index];
+		
+		NSString *extreme = (aggregate.function == YapDatabaseSecondaryIndexAggregateFunctionMin) ? @"min" : @"max";
+		
+		NSMutableString *string = [NSMutableString stringWithCapacity:200];
+		[string appendFormat:@"UPDATE \"%@\" SET \"%@\" = (SELECT %@(\"%@\") FROM \"%@\"",
+		  [parent aggregatesTableName], extreme,
+		  [extreme uppercaseString], aggregate.column, [parent tableName]];
+		
+		if (aggregate.groupByColumn && aggregate.predicate)
+			[string appendFormat:@" WHERE \"%@\" IS ?2 AND (%@)", aggregate.groupByColumn, aggregate.predicate];
+		else if (aggregate.groupByColumn)
+			[string appendFormat:@" WHERE \"%@\" IS ?2", aggregate.groupByColumn];
+		else if (aggregate.predicate)
+			[string appendFormat:@" WHERE %@", aggregate.predicate];
+		
+		[string appendFormat:@") WHERE \"name\" = ?1 AND \"group\" IS ?2 AND \"%@\" = ?3;", extreme];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
 @end
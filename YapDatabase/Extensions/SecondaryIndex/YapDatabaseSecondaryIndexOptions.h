@@ -40,6 +40,26 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, strong, readwrite, nullable) YapWhitelistBlacklist *allowedCollections;
 
+/**
+ * When the extension first populates itself (or re-populates itself due to a versionTag change),
+ * the handler block is invoked for every (allowed) row in the database.
+ * For a large database, most of this time is spent fetching/deserializing objects & invoking the handler block.
+ *
+ * If this value is greater than 1, the handler block is invoked concurrently, using up to this many threads.
+ * Each thread uses its own read-only connection, and passes the corresponding read-only transaction to the block.
+ * The resulting values are still written to the table serially, within the readWriteTransaction.
+ *
+ * IMPORTANT:
+ * Only enable this if your handler block is thread-safe, and only depends on the given
+ * (collection, key, object, metadata) parameters.
+ *
+ * If the readWriteTransaction has already modified rows before the extension is populated,
+ * the read-only connections wouldn't see those changes. So in that case the extension is populated serially.
+ *
+ * The default value is 1 (serial).
+ */
+@property (nonatomic, assign, readwrite) NSUInteger populationConcurrency;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -15,11 +15,22 @@
 @implementation YapDatabaseSecondaryIndexOptions
 
 @synthesize allowedCollections = allowedCollections;
+@synthesize populationConcurrency = populationConcurrency;
+
+- (id)init
+{
+	if ((self = [super init]))
+	{
+		populationConcurrency = 1;
+	}
+	return self;
+}
 
 - (id)copyWithZone:(NSZone __unused *)zone
 {
 	YapDatabaseSecondaryIndexOptions *copy = [[YapDatabaseSecondaryIndexOptions alloc] init];
 	copy->allowedCollections = allowedCollections;
+	copy->populationConcurrency = populationConcurrency;
 	
 	return copy;
 }
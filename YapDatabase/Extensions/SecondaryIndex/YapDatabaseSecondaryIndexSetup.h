@@ -1,6 +1,8 @@
 #import <Foundation/Foundation.h>
 
 @class YapDatabaseSecondaryIndexColumn;
+@class YapDatabaseSecondaryIndexCompositeIndex;
+@class YapDatabaseSecondaryIndexAggregate;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -18,19 +20,153 @@ typedef NS_ENUM(NSInteger, YapDatabaseSecondaryIndexType) {
 
 NSString* NSStringFromYapDatabaseSecondaryIndexType(YapDatabaseSecondaryIndexType type);
 
+/**
+ * The aggregate functions supported by materialized aggregates.
+ * These have the same semantics as the corresponding sqlite functions.
+ */
+typedef NS_ENUM(NSInteger, YapDatabaseSecondaryIndexAggregateFunction) {
+	YapDatabaseSecondaryIndexAggregateFunctionCount,
+	YapDatabaseSecondaryIndexAggregateFunctionSum,
+	YapDatabaseSecondaryIndexAggregateFunctionAvg,
+	YapDatabaseSecondaryIndexAggregateFunctionMin,
+	YapDatabaseSecondaryIndexAggregateFunctionMax
+};
+
+NSString* NSStringFromYapDatabaseSecondaryIndexAggregateFunction(YapDatabaseSecondaryIndexAggregateFunction function);
+
 
 @interface YapDatabaseSecondaryIndexSetup : NSObject <NSCopying, NSFastEnumeration>
 
 - (id)init;
 - (id)initWithCapacity:(NSUInteger)capacity;
 
+/**
+ * Adds a column to the secondary index table.
+ * By default, every column gets its own (single column) index.
+ */
 - (void)addColumn:(NSString *)name withType:(YapDatabaseSecondaryIndexType)type;
 
+/**
+ * Adds a column to the secondary index table, with or without its own (single column) index.
+ *
+ * Columns that are only queried as part of a composite index (or are only used as covering columns)
+ * don't need their own index. Skipping it saves space, and an index update for every write.
+ */
+- (void)addColumn:(NSString *)name withType:(YapDatabaseSecondaryIndexType)type indexed:(BOOL)indexed;
+
+/**
+ * Adds an expression column to the secondary index table.
+ *
+ * The value of an expression column isn't provided by the handler block.
+ * Instead, sqlite calculates it from the serialized row in the database (without deserializing it).
+ * The expression may reference the "collection", "key", "data" (serialized object) & "metadata" columns.
+ *
+ * This is useful if your objects (or metadata) are serialized as JSON. For example:
+ *
+ * [setup addColumn:@"rank" withType:YapDatabaseSecondaryIndexTypeInteger
+ *       expression:@"json_extract(CAST(\"metadata\" AS TEXT), '$.rank')"];
+ *
+ * (The data & metadata columns are blobs, so they need to be cast to text for the json functions.)
+ *
+ * If every column is an expression column, then you don't need a handler at all.
+ * (See -[YapDatabaseSecondaryIndex initWithSetup:versionTag:options:].)
+ * In which case the index is populated & updated entirely within sqlite,
+ * without any objective-c blocks being invoked, or any objects being deserialized.
+ *
+ * If the setup also contains regular columns, then the row is updated whenever the handler block is invoked.
+ * So make sure the handler's blockInvokeOptions cover changes to the data the expressions read.
+ *
+ * A row is included in the index if the handler block provides any values,
+ * or if any of the expressions evaluate to a non-NULL value.
+ */
+- (void)addColumn:(NSString *)name withType:(YapDatabaseSecondaryIndexType)type expression:(NSString *)expression;
+
+- (void)addColumn:(NSString *)name
+         withType:(YapDatabaseSecondaryIndexType)type
+       expression:(NSString *)expression
+          indexed:(BOOL)indexed;
+
 - (NSUInteger)count;
 - (nullable YapDatabaseSecondaryIndexColumn *)columnAtIndex:(NSUInteger)index;
 
 - (NSArray<NSString *> *)columnNames;
 
+/**
+ * Adds a multi-column (composite) index.
+ *
+ * Sqlite can only use one index per table in a query.
+ * So if your queries filter on (tenant, status) and sort by timestamp,
+ * then the ideal index is on (tenant, status, timestamp), which avoids a separate sort step.
+ *
+ * The columns must have been added to the setup (via addColumn:withType:) before the index is added.
+ * The name must be unique amongst the indexes within this setup, and mustn't match a column name.
+ */
+- (void)addIndexWithName:(NSString *)name columns:(NSArray<NSString *> *)columns;
+
+/**
+ * Adds a multi-column (composite) index, with optional covering columns and an optional predicate.
+ *
+ * @param coveringColumns
+ *   Additional columns that are appended to the index.
+ *   If a query only reads columns that are in the index,
+ *   then sqlite can answer it without reading the table (a "covering index").
+ *   For example, with enumerateIndexedValuesInColumn:matchingQuery:usingBlock:.
+ *
+ * @param predicate
+ *   Creates a partial index, which only contains the rows matching the predicate.
+ *   E.g. @"status = 1"
+ *   Sqlite only uses a partial index if the query's WHERE clause implies the predicate.
+ *   Use literal values within the query (rather than '?' parameters) for the predicate terms.
+ *   For more information, see the sqlite docs: https://www.sqlite.org/partialindex.html
+ *
+ * If you change the indexes, you must change the versionTag too (just like when you change the columns).
+ */
+- (void)addIndexWithName:(NSString *)name
+                 columns:(NSArray<NSString *> *)columns
+         coveringColumns:(nullable NSArray<NSString *> *)coveringColumns
+               predicate:(nullable NSString *)predicate;
+
+- (NSArray<YapDatabaseSecondaryIndexCompositeIndex *> *)indexes;
+
+/**
+ * Adds a materialized aggregate.
+ *
+ * The performAggregateQuery: method calculates the aggregate from scratch each time (scanning the matching rows).
+ * A materialized aggregate is stored in the database, and kept up-to-date as rows are added, updated & removed.
+ * So reading the value (via valueForAggregate:inGroup:) is a simple lookup, regardless of the number of rows.
+ *
+ * @param name
+ *   The name is used to read the aggregate (via valueForAggregate:inGroup:).
+ *   It must be unique amongst the aggregates within this setup.
+ *
+ * @param function
+ *   The aggregate function (COUNT, SUM, AVG, MIN or MAX).
+ *
+ * @param column
+ *   The column that is aggregated.
+ *   For YapDatabaseSecondaryIndexAggregateFunctionCount, you may pass nil, which is equivalent to COUNT(*).
+ *
+ * @param groupByColumn
+ *   Optional column to group by. If set, the aggregate is maintained separately for each distinct value.
+ *   (Equivalent to "GROUP BY groupByColumn".)
+ *
+ * @param predicate
+ *   Optional filter. If set, only matching rows are included in the aggregate.
+ *   (Equivalent to "WHERE predicate".) E.g. @"status = 1"
+ *
+ * Note: When the current MIN (or MAX) value is removed, the new value is calculated from the table.
+ * Add an index on (groupByColumn, column) to make this fast.
+ *
+ * If you change the aggregates, you must change the versionTag too (just like when you change the columns).
+ */
+- (void)addAggregateWithName:(NSString *)name
+                    function:(YapDatabaseSecondaryIndexAggregateFunction)function
+                      column:(nullable NSString *)column
+                     groupBy:(nullable NSString *)groupByColumn
+                   predicate:(nullable NSString *)predicate;
+
+- (NSArray<YapDatabaseSecondaryIndexAggregate *> *)aggregates;
+
 @end
 
 #pragma mark -
@@ -39,6 +175,36 @@ NSString* NSStringFromYapDatabaseSecondaryIndexType(YapDatabaseSecondaryIndexTyp
 
 @property (nonatomic, copy, readonly) NSString *name;
 @property (nonatomic, assign, readonly) YapDatabaseSecondaryIndexType type;
+@property (nonatomic, assign, readonly) BOOL indexed;
+
+/**
+ * The sql expression that calculates the value of the column (if this is an expression column).
+ * Nil for regular columns, which are provided by the handler block.
+ */
+@property (nonatomic, copy, readonly, nullable) NSString *expression;
+
+@end
+
+#pragma mark -
+
+@interface YapDatabaseSecondaryIndexCompositeIndex : NSObject
+
+@property (nonatomic, copy, readonly) NSString *name;
+@property (nonatomic, copy, readonly) NSArray<NSString *> *columns;
+@property (nonatomic, copy, readonly) NSArray<NSString *> *coveringColumns;
+@property (nonatomic, copy, readonly, nullable) NSString *predicate;
+
+@end
+
+#pragma mark -
+
+@interface YapDatabaseSecondaryIndexAggregate : NSObject
+
+@property (nonatomic, copy, readonly) NSString *name;
+@property (nonatomic, assign, readonly) YapDatabaseSecondaryIndexAggregateFunction function;
+@property (nonatomic, copy, readonly, nullable) NSString *column;
+@property (nonatomic, copy, readonly, nullable) NSString *groupByColumn;
+@property (nonatomic, copy, readonly, nullable) NSString *predicate;
 
 @end
 
@@ -30,8 +30,39 @@ NSString* NSStringFromYapDatabaseSecondaryIndexType(YapDatabaseSecondaryIndexTyp
 	}
 }
 
+NSString* NSStringFromYapDatabaseSecondaryIndexAggregateFunction(YapDatabaseSecondaryIndexAggregateFunction function)
+{
+	switch (function)
+	{
+		case YapDatabaseSecondaryIndexAggregateFunctionCount : return @"COUNT";
+		case YapDatabaseSecondaryIndexAggregateFunctionSum   : return @"SUM";
+		case YapDatabaseSecondaryIndexAggregateFunctionAvg   : return @"AVG";
+		case YapDatabaseSecondaryIndexAggregateFunctionMin   : return @"MIN";
+		case YapDatabaseSecondaryIndexAggregateFunctionMax   : return @"MAX";
+		default                                              : return @"UNKNOWN";
+	}
+}
+
 @interface YapDatabaseSecondaryIndexColumn ()
-- (id)initWithName:(NSString *)name type:(YapDatabaseSecondaryIndexType)type;
+- (id)initWithName:(NSString *)name
+              type:(YapDatabaseSecondaryIndexType)type
+           indexed:(BOOL)indexed
+        expression:(nullable NSString *)expression;
+@end
+
+@interface YapDatabaseSecondaryIndexCompositeIndex ()
+- (id)initWithName:(NSString *)name
+           columns:(NSArray<NSString *> *)columns
+   coveringColumns:(nullable NSArray<NSString *> *)coveringColumns
+         predicate:(nullable NSString *)predicate;
+@end
+
+@interface YapDatabaseSecondaryIndexAggregate ()
+- (id)initWithName:(NSString *)name
+          function:(YapDatabaseSecondaryIndexAggregateFunction)function
+            column:(nullable NSString *)column
+     groupByColumn:(nullable NSString *)groupByColumn
+         predicate:(nullable NSString *)predicate;
 @end
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -41,6 +72,8 @@ NSString* NSStringFromYapDatabaseSecondaryIndexType(YapDatabaseSecondaryIndexTyp
 @implementation YapDatabaseSecondaryIndexSetup
 {
 	NSMutableArray *setup;
+	NSMutableArray *indexes;
+	NSMutableArray *aggregates;
 }
 
 - (id)init
@@ -96,6 +129,42 @@ NSString* NSStringFromYapDatabaseSecondaryIndexType(YapDatabaseSecondaryIndexTyp
 }
 
 - (void)addColumn:(NSString *)columnName withType:(YapDatabaseSecondaryIndexType)type
+{
+	[self addColumn:columnName withType:type indexed:YES];
+}
+
+- (void)addColumn:(NSString *)columnName withType:(YapDatabaseSecondaryIndexType)type indexed:(BOOL)indexed
+{
+	[self _addColumn:columnName withType:type indexed:indexed expression:nil];
+}
+
+- (void)addColumn:(NSString *)columnName
+         withType:(YapDatabaseSecondaryIndexType)type
+       expression:(NSString *)expression
+{
+	[self addColumn:columnName withType:type expression:expression indexed:YES];
+}
+
+- (void)addColumn:(NSString *)columnName
+         withType:(YapDatabaseSecondaryIndexType)type
+       expression:(NSString *)expression
+          indexed:(BOOL)indexed
+{
+	if ([expression length] == 0)
+	{
+		NSAssert(NO, @"Invalid expression: empty");
+		
+		YDBLogError(@"Invalid expression: empty");
+		return;
+	}
+	
+	[self _addColumn:columnName withType:type indexed:indexed expression:expression];
+}
+
+- (void)_addColumn:(NSString *)columnName
+          withType:(YapDatabaseSecondaryIndexType)type
+           indexed:(BOOL)indexed
+        expression:(NSString *)expression
 {
 	if (columnName == nil)
 	{
@@ -121,6 +190,17 @@ NSString* NSStringFromYapDatabaseSecondaryIndexType(YapDatabaseSecondaryIndexTyp
 		return;
 	}
 	
+	for (YapDatabaseSecondaryIndexCompositeIndex *index in indexes)
+	{
+		if ([index.name caseInsensitiveCompare:columnName] == NSOrderedSame)
+		{
+			NSAssert(NO, @"Invalid columnName: columnName matches an index name");
+			
+			YDBLogError(@"Invalid columnName: columnName matches an index name");
+			return;
+		}
+	}
+	
 	if (type != YapDatabaseSecondaryIndexTypeInteger &&
 	    type != YapDatabaseSecondaryIndexTypeReal    &&
 	    type != YapDatabaseSecondaryIndexTypeNumeric &&
@@ -134,7 +214,10 @@ NSString* NSStringFromYapDatabaseSecondaryIndexType(YapDatabaseSecondaryIndexTyp
 	}
 	
 	YapDatabaseSecondaryIndexColumn *column =
-	    [[YapDatabaseSecondaryIndexColumn alloc] initWithName:columnName type:type];
+	    [[YapDatabaseSecondaryIndexColumn alloc] initWithName:columnName
+	                                                      type:type
+	                                                   indexed:indexed
+	                                                expression:expression];
 	
 	[setup addObject:column];
 }
@@ -164,10 +247,183 @@ NSString* NSStringFromYapDatabaseSecondaryIndexType(YapDatabaseSecondaryIndexTyp
 	return [columnNames copy];
 }
 
+- (BOOL)hasExpressionColumns
+{
+	for (YapDatabaseSecondaryIndexColumn *column in setup)
+	{
+		if (column.expression) return YES;
+	}
+	
+	return NO;
+}
+
+- (BOOL)hasBlockColumns
+{
+	for (YapDatabaseSecondaryIndexColumn *column in setup)
+	{
+		if (column.expression == nil) return YES;
+	}
+	
+	return NO;
+}
+
+- (void)addIndexWithName:(NSString *)name columns:(NSArray<NSString *> *)columns
+{
+	[self addIndexWithName:name columns:columns coveringColumns:nil predicate:nil];
+}
+
+- (void)addIndexWithName:(NSString *)name
+                 columns:(NSArray<NSString *> *)columns
+         coveringColumns:(NSArray<NSString *> *)coveringColumns
+               predicate:(NSString *)predicate
+{
+	if (name == nil)
+	{
+		NSAssert(NO, @"Invalid index name: nil");
+		
+		YDBLogError(@"Invalid index name: nil");
+		return;
+	}
+	
+	for (YapDatabaseSecondaryIndexCompositeIndex *index in indexes)
+	{
+		if ([index.name caseInsensitiveCompare:name] == NSOrderedSame)
+		{
+			NSAssert(NO, @"Invalid index name: name already exists");
+			
+			YDBLogError(@"Invalid index name: name already exists");
+			return;
+		}
+	}
+	
+	// The single column indexes are named after their column (within the same namespace).
+	
+	if ([self isExistingName:name])
+	{
+		NSAssert(NO, @"Invalid index name: name matches a column name");
+		
+		YDBLogError(@"Invalid index name: name matches a column name");
+		return;
+	}
+	
+	if ([columns count] == 0)
+	{
+		NSAssert(NO, @"Invalid index columns: empty");
+		
+		YDBLogError(@"Invalid index columns: empty");
+		return;
+	}
+	
+	for (NSString *columnName in [columns arrayByAddingObjectsFromArray:(coveringColumns ?: @[])])
+	{
+		if (![self isExistingName:columnName])
+		{
+			NSAssert(NO, @"Invalid index column: column doesn't exist (add the columns before the index)");
+			
+			YDBLogError(@"Invalid index column (%@): column doesn't exist (add the columns before the index)",
+			            columnName);
+			return;
+		}
+	}
+	
+	YapDatabaseSecondaryIndexCompositeIndex *index =
+	    [[YapDatabaseSecondaryIndexCompositeIndex alloc] initWithName:name
+	                                                          columns:columns
+	                                                  coveringColumns:coveringColumns
+	                                                        predicate:predicate];
+	
+	if (indexes == nil)
+		indexes = [[NSMutableArray alloc] init];
+	
+	[indexes addObject:index];
+}
+
+- (NSArray *)indexes
+{
+	return indexes ? [indexes copy] : @[];
+}
+
+- (void)addAggregateWithName:(NSString *)name
+                    function:(YapDatabaseSecondaryIndexAggregateFunction)function
+                      column:(NSString *)column
+                     groupBy:(NSString *)groupByColumn
+                   predicate:(NSString *)predicate
+{
+	if (name == nil)
+	{
+		NSAssert(NO, @"Invalid aggregate name: nil");
+		
+		YDBLogError(@"Invalid aggregate name: nil");
+		return;
+	}
+	
+	for (YapDatabaseSecondaryIndexAggregate *aggregate in aggregates)
+	{
+		if ([aggregate.name isEqualToString:name])
+		{
+			NSAssert(NO, @"Invalid aggregate name: name already exists");
+			
+			YDBLogError(@"Invalid aggregate name: name already exists");
+			return;
+		}
+	}
+	
+	if (function != YapDatabaseSecondaryIndexAggregateFunctionCount &&
+	    function != YapDatabaseSecondaryIndexAggregateFunctionSum   &&
+	    function != YapDatabaseSecondaryIndexAggregateFunctionAvg   &&
+	    function != YapDatabaseSecondaryIndexAggregateFunctionMin   &&
+	    function != YapDatabaseSecondaryIndexAggregateFunctionMax    )
+	{
+		NSAssert(NO, @"Invalid aggregate function");
+		
+		YDBLogError(@"Invalid aggregate function");
+		return;
+	}
+	
+	if (column == nil && function != YapDatabaseSecondaryIndexAggregateFunctionCount)
+	{
+		NSAssert(NO, @"Invalid aggregate column: nil (only allowed for COUNT)");
+		
+		YDBLogError(@"Invalid aggregate column: nil (only allowed for COUNT)");
+		return;
+	}
+	
+	for (NSString *columnName in @[ (column ?: @"rowid"), (groupByColumn ?: @"rowid") ])
+	{
+		if (![self isReservedName:columnName] && ![self isExistingName:columnName])
+		{
+			NSAssert(NO, @"Invalid aggregate column: column doesn't exist (add the columns before the aggregate)");
+			
+			YDBLogError(@"Invalid aggregate column (%@): column doesn't exist (add the columns before the aggregate)",
+			            columnName);
+			return;
+		}
+	}
+	
+	YapDatabaseSecondaryIndexAggregate *aggregate =
+	    [[YapDatabaseSecondaryIndexAggregate alloc] initWithName:name
+	                                                    function:function
+	                                                      column:column
+	                                               groupByColumn:groupByColumn
+	                                                   predicate:predicate];
+	
+	if (aggregates == nil)
+		aggregates = [[NSMutableArray alloc] init];
+	
+	[aggregates addObject:aggregate];
+}
+
+- (NSArray *)aggregates
+{
+	return aggregates ? [aggregates copy] : @[];
+}
+
 - (id)copyWithZone:(NSZone __unused *)zone
 {
 	YapDatabaseSecondaryIndexSetup *copy = [[YapDatabaseSecondaryIndexSetup alloc] initForCopy];
 	copy->setup = [setup mutableCopy];
+	copy->indexes = [indexes mutableCopy];
+	copy->aggregates = [aggregates mutableCopy];
 	
 	return copy;
 }
@@ -242,13 +498,20 @@ NSString* NSStringFromYapDatabaseSecondaryIndexType(YapDatabaseSecondaryIndexTyp
 
 @synthesize name = name;
 @synthesize type = type;
+@synthesize indexed = indexed;
+@synthesize expression = expression;
 
-- (id)initWithName:(NSString *)inName type:(YapDatabaseSecondaryIndexType)inType
+- (id)initWithName:(NSString *)inName
+              type:(YapDatabaseSecondaryIndexType)inType
+           indexed:(BOOL)inIndexed
+        expression:(NSString *)inExpression
 {
 	if ((self = [super init]))
 	{
 		name = [inName copy];
 		type = inType;
+		indexed = inIndexed;
+		expression = [inExpression copy];
 	}
 	return self;
 }
@@ -257,7 +520,95 @@ NSString* NSStringFromYapDatabaseSecondaryIndexType(YapDatabaseSecondaryIndexTyp
 {
 	NSString *typeStr = NSStringFromYapDatabaseSecondaryIndexType(type);
 	
-	return [NSString stringWithFormat:@"<YapDatabaseSecondaryIndexColumn: name(%@), type(%@)>", name, typeStr];
+	if (expression)
+	{
+		return [NSString stringWithFormat:
+		  @"<YapDatabaseSecondaryIndexColumn: name(%@), type(%@), indexed(%@), expression(%@)>",
+		  name, typeStr, (indexed ? @"YES" : @"NO"), expression];
+	}
+	
+	return [NSString stringWithFormat:@"<YapDatabaseSecondaryIndexColumn: name(%@), type(%@), indexed(%@)>",
+	                                  name, typeStr, (indexed ? @"YES" : @"NO")];
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation YapDatabaseSecondaryIndexCompositeIndex
+
+@synthesize name = name;
+@synthesize columns = columns;
+@synthesize coveringColumns = coveringColumns;
+@synthesize predicate = predicate;
+
+- (id)initWithName:(NSString *)inName
+           columns:(NSArray<NSString *> *)inColumns
+   coveringColumns:(NSArray<NSString *> *)inCoveringColumns
+         predicate:(NSString *)inPredicate
+{
+	if ((self = [super init]))
+	{
+		name = [inName copy];
+		columns = [inColumns copy];
+		coveringColumns = inCoveringColumns ? [inCoveringColumns copy] : @[];
+		predicate = [inPredicate copy];
+	}
+	return self;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:
+	  @"<YapDatabaseSecondaryIndexCompositeIndex: name(%@), columns(%@), coveringColumns(%@), predicate(%@)>",
+	  name,
+	  [columns componentsJoinedByString:@", "],
+	  [coveringColumns componentsJoinedByString:@", "],
+	  predicate];
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation YapDatabaseSecondaryIndexAggregate
+
+@synthesize name = name;
+@synthesize function = function;
+@synthesize column = column;
+@synthesize groupByColumn = groupByColumn;
+@synthesize predicate = predicate;
+
+- (id)initWithName:(NSString *)inName
+          function:(YapDatabaseSecondaryIndexAggregateFunction)inFunction
+            column:(NSString *)inColumn
+     groupByColumn:(NSString *)inGroupByColumn
+         predicate:(NSString *)inPredicate
+{
+	if ((self = [super init]))
+	{
+		name = [inName copy];
+		function = inFunction;
+		column = [inColumn copy];
+		groupByColumn = [inGroupByColumn copy];
+		predicate = [inPredicate copy];
+	}
+	return self;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:
+	  @"<YapDatabaseSecondaryIndexAggregate: name(%@), function(%@), column(%@), groupBy(%@), predicate(%@)>",
+	  name,
+	  NSStringFromYapDatabaseSecondaryIndexAggregateFunction(function),
+	  (column ?: @"*"),
+	  groupByColumn,
+	  predicate];
 }
 
 @end
@@ -79,6 +79,34 @@ NS_REFINED_FOR_SWIFT;
  */
 - (nullable id)performAggregateQuery:(YapDatabaseQuery *)query;
 
+/**
+ * Returns the current value of a materialized aggregate.
+ * (See -[YapDatabaseSecondaryIndexSetup addAggregateWithName:function:column:groupBy:predicate:])
+ *
+ * Unlike performAggregateQuery:, the value isn't calculated by scanning the table.
+ * It's kept up-to-date as rows are changed, so reading it is a simple lookup.
+ * The value reflects the state of the database as seen by this transaction.
+ *
+ * The first version is for aggregates without a groupByColumn.
+ * For aggregates with a groupByColumn, pass the value of the group (nil for rows where the column is NULL).
+ * The group must have the same type as the values stored in the groupByColumn (e.g. NSString for a text column).
+ *
+ * The result is the same as the corresponding aggregate query. E.g.:
+ * SELECT function(column) FROM "tableName" WHERE (predicate) AND groupByColumn IS group;
+ *
+ * Thus, for a group without any matching rows, COUNT returns zero, and the other functions return NSNull.
+ * Returns nil if there's no aggregate with the given name.
+ */
+- (nullable id)valueForAggregate:(NSString *)name;
+- (nullable id)valueForAggregate:(NSString *)name inGroup:(nullable id)group;
+
+/**
+ * Enumerates the groups of a materialized aggregate (that have at least one matching row), along with their value.
+ * The group is NSNull for rows where the groupByColumn is NULL (and for aggregates without a groupByColumn).
+ */
+- (void)enumerateGroupsForAggregate:(NSString *)name
+                         usingBlock:(void (NS_NOESCAPE^)(id group, id value, BOOL *stop))block;
+
 /**
  * This method assists in performing a query over a subset of rows,
  * where the subset is a known set of keys.
@@ -98,6 +126,20 @@ NS_REFINED_FOR_SWIFT;
 - (NSDictionary<NSString*, NSNumber*> *)rowidsForKeys:(NSArray<NSString *> *)keys
                                          inCollection:(nullable NSString *)collection;
 
+/**
+ * Returns the output of EXPLAIN QUERY PLAN for the given query (one line per step of the plan).
+ * The plan is for the statement executed by the enumerate methods,
+ * which joins the matching rows to the database table (to fetch the key, object & metadata in the same pass).
+ * For an aggregate query, it's the statement executed by performAggregateQuery:.
+ *
+ * This is useful for checking that a query uses the intended index.
+ * For example, a composite index (see -[YapDatabaseSecondaryIndexSetup addIndexWithName:columns:])
+ * can avoid a separate sort step, which shows up in the plan as "USE TEMP B-TREE FOR ORDER BY".
+ *
+ * For more information, see the sqlite docs: https://www.sqlite.org/eqp.html
+ */
+- (nullable NSString *)queryPlanForQuery:(YapDatabaseQuery *)query;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -1,6 +1,7 @@
 #import "YapDatabaseSecondaryIndexTransaction.h"
 #import "YapDatabaseSecondaryIndexPrivate.h"
 #import "YapDatabaseStatement.h"
+#import "YapNull.h"
 
 #import "YapDatabasePrivate.h"
 #import "YapDatabaseExtensionPrivate.h"
@@ -25,6 +26,17 @@
 static NSString *const ext_key_classVersion       = @"classVersion";
 static NSString *const ext_key_versionTag         = @"versionTag";
 static NSString *const ext_key_version_deprecated = @"version";
+static NSString *const ext_key_aggregateNames     = @"aggregateNames";
+
+/**
+ * The contribution of a single row to a materialized aggregate.
+ * The row is only included in the aggregate if it matches the aggregate's predicate.
+**/
+typedef struct {
+	BOOL included;
+	sqlite3_value *group;
+	sqlite3_value *value;
+} YDBAggregateContribution;
 
 
 @implementation YapDatabaseSecondaryIndexTransaction
@@ -57,6 +69,19 @@ static NSString *const ext_key_version_deprecated = @"version";
 	
 	int classVersion = YAP_DATABASE_SECONDARY_INDEX_CLASS_VERSION;
 	
+	if (hasOldClassVersion && (oldClassVersion != classVersion))
+	{
+		// Upgrading from older codebase
+		
+		if ([self migrateIndexesFromOldClassVersion:oldClassVersion])
+		{
+			// The existing table was converted in place, so there's no need to re-populate it.
+			
+			[self setIntValue:classVersion forExtensionKey:ext_key_classVersion persistent:YES];
+			oldClassVersion = classVersion;
+		}
+	}
+	
 	if (oldClassVersion != classVersion)
 	{
 		// First time registration (or at least for this version)
@@ -67,6 +92,8 @@ static NSString *const ext_key_version_deprecated = @"version";
 		
 		if (![self createTable]) return NO;
 		if (![self populate]) return NO;
+		if (![self createIndexes]) return NO;
+		if (![self populateAggregates]) return NO;
 		
 		[self setIntValue:classVersion forExtensionKey:ext_key_classVersion persistent:YES];
 		
@@ -100,6 +127,8 @@ static NSString *const ext_key_version_deprecated = @"version";
 			if (![self dropTable]) return NO;
 			if (![self createTable]) return NO;
 			if (![self populate]) return NO;
+			if (![self createIndexes]) return NO;
+			if (![self populateAggregates]) return NO;
 			
 			[self setStringValue:versionTag forExtensionKey:ext_key_versionTag persistent:YES];
 			
@@ -146,7 +175,37 @@ static NSString *const ext_key_version_deprecated = @"version";
 			
 			YapDatabaseSecondaryIndexSetup *setup = parentConnection->parent->setup;
 			
-			if (![setup matchesExistingColumnNamesAndAffinity:columns])
+			// The single column indexes only exist for indexed columns.
+			
+			NSMutableSet<NSString *> *indexNames = [NSMutableSet set];
+			for (YapDatabaseSecondaryIndexColumn *column in setup)
+			{
+				if (column.indexed) {
+					[indexNames addObject:[self sqlNameForColumnIndex:column]];
+				}
+			}
+			for (YapDatabaseSecondaryIndexCompositeIndex *index in [setup indexes])
+			{
+				[indexNames addObject:[self sqlNameForIndex:index]];
+			}
+			
+			BOOL indexesMatch = [indexNames isEqualToSet:[self existingIndexNames]];
+			
+			// The aggregates table only exists if there are aggregates,
+			// and the names of the populated aggregates are stored alongside the versionTag.
+			
+			NSArray<YapDatabaseSecondaryIndexAggregate *> *aggregates = parentConnection->parent->aggregates;
+			
+			BOOL hasAggregatesTable =
+			  [YapDatabase tableExists:[parentConnection->parent aggregatesTableName] using:db];
+			
+			NSString *aggregateNames = [self aggregateNames];
+			NSString *oldAggregateNames = [self stringValueForExtensionKey:ext_key_aggregateNames persistent:YES];
+			
+			BOOL aggregatesMatch = (hasAggregatesTable == ([aggregates count] > 0)) &&
+			                       (aggregateNames == oldAggregateNames || [aggregateNames isEqualToString:oldAggregateNames]);
+			
+			if (![setup matchesExistingColumnNamesAndAffinity:columns] || !indexesMatch || !aggregatesMatch)
 			{
 				YDBLogError(@"Error creating secondary index extension:"
 				            @" The given setup doesn't match the previously registered setup."
@@ -197,9 +256,66 @@ static NSString *const ext_key_version_deprecated = @"version";
 		return NO;
 	}
 	
+	NSString *aggregatesTableName = [parentConnection->parent aggregatesTableName];
+	NSString *dropAggregatesTable = [NSString stringWithFormat:@"DROP TABLE IF EXISTS \"%@\";", aggregatesTableName];
+	
+	status = sqlite3_exec(db, [dropAggregatesTable UTF8String], NULL, NULL, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Failed dropping secondary index table (%@): %d %s",
+		            dropAggregatesTable, status, sqlite3_errmsg(db));
+		return NO;
+	}
+	
 	return YES;
 }
 
+/**
+ * Codebase upgrade helper.
+ *
+ * Attempts to convert the table from an older class version into the current format,
+ * without having to re-populate it (which requires invoking the handler block for every row).
+ *
+ * Returns YES if the table was migrated.
+ * Returns NO if migration isn't supported for the given version, or if an error occurred.
+ * In which case the caller should fallback to dropping the table & re-populating it.
+**/
+- (BOOL)migrateIndexesFromOldClassVersion:(int)oldClassVersion
+{
+	if (oldClassVersion != 1) return NO;
+	
+	// In version 2, the single column indexes were renamed from "columnName" to "tableName_columnName".
+	//
+	// Index names are global within the database.
+	// So if 2 secondary index tables had a column with the same name,
+	// the second "CREATE INDEX IF NOT EXISTS" was a no-op, and the second table didn't get an index.
+	//
+	// We drop any old (column named) indexes on our table, and create the indexes using the new names.
+	// (Sqlite doesn't support renaming an index.)
+	
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	YapDatabaseSecondaryIndexSetup *setup = parentConnection->parent->setup;
+	NSSet<NSString *> *existingIndexNames = [self existingIndexNames];
+	
+	for (YapDatabaseSecondaryIndexColumn *column in setup)
+	{
+		if (![existingIndexNames containsObject:column.name]) continue;
+		
+		NSString *dropIndex = [NSString stringWithFormat:@"DROP INDEX IF EXISTS \"%@\";", column.name];
+		
+		int status = sqlite3_exec(db, [dropIndex UTF8String], NULL, NULL, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogWarn(@"(%@): Unable to migrate secondary index from classVersion %d: %d %s",
+			           [self registeredName], oldClassVersion, status, sqlite3_errmsg(db));
+			return NO;
+		}
+	}
+	
+	return [self createIndexes];
+}
+
 /**
  * Internal method.
  *
@@ -252,11 +368,72 @@ static NSString *const ext_key_version_deprecated = @"version";
 		return NO;
 	}
 	
+	if ([parentConnection->parent->aggregates count] > 0)
+	{
+		// The state of each materialized aggregate (for each group):
+		//
+		// - rows  : the number of rows in the group (that match the predicate)
+		// - count : the number of non-NULL values
+		// - sum   : the sum of the non-NULL values (NULL if there aren't any)
+		// - min   : the min value (only maintained for MIN aggregates)
+		// - max   : the max value (only maintained for MAX aggregates)
+		//
+		// Note: The "group" column is NULL for aggregates without a groupByColumn.
+		// So we can't use a unique constraint (which treats NULL values as distinct), and use an index instead.
+		
+		NSString *aggregatesTableName = [parentConnection->parent aggregatesTableName];
+		
+		NSString *createAggregatesTable = [NSString stringWithFormat:
+		  @"CREATE TABLE IF NOT EXISTS \"%@\" (\"name\" TEXT NOT NULL, \"group\","
+		  @" \"rows\" INTEGER NOT NULL, \"count\" INTEGER NOT NULL, \"sum\", \"min\", \"max\");",
+		  aggregatesTableName];
+		
+		NSString *createAggregatesIndex = [NSString stringWithFormat:
+		  @"CREATE INDEX IF NOT EXISTS \"%@_name_group\" ON \"%@\" (\"name\", \"group\");",
+		  aggregatesTableName, aggregatesTableName];
+		
+		for (NSString *sql in @[ createAggregatesTable, createAggregatesIndex ])
+		{
+			status = sqlite3_exec(db, [sql UTF8String], NULL, NULL, NULL);
+			if (status != SQLITE_OK)
+			{
+				YDBLogError(@"Failed creating secondary index aggregates table (%@): %d %s",
+				            aggregatesTableName, status, sqlite3_errmsg(db));
+				return NO;
+			}
+		}
+	}
+	
+	return YES;
+}
+
+/**
+ * Internal method.
+ *
+ * This method is called, after the table has been populated, to create the (sqlite) indexes on the table.
+ *
+ * Creating the indexes after population is much faster than populating a table with existing indexes.
+ * Each insert would otherwise have to update every index (in random order),
+ * whereas creating an index on a populated table sorts the values once.
+**/
+- (BOOL)createIndexes
+{
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	NSString *tableName = [self tableName];
+	YapDatabaseSecondaryIndexSetup *setup = parentConnection->parent->setup;
+	
+	int status;
+	
 	for (YapDatabaseSecondaryIndexColumn *column in setup)
 	{
+		if (!column.indexed) continue;
+		
+		// CREATE INDEX IF NOT EXISTS "tableName_columnName" ON "tableName" ("columnName");
+		
 		NSString *createIndex =
 		    [NSString stringWithFormat:@"CREATE INDEX IF NOT EXISTS \"%@\" ON \"%@\" (\"%@\");",
-		        column.name, tableName, column.name];
+		        [self sqlNameForColumnIndex:column], tableName, column.name];
 		
 		status = sqlite3_exec(db, [createIndex UTF8String], NULL, NULL, NULL);
 		if (status != SQLITE_OK)
@@ -266,14 +443,212 @@ static NSString *const ext_key_version_deprecated = @"version";
 		}
 	}
 	
+	for (YapDatabaseSecondaryIndexCompositeIndex *index in [setup indexes])
+	{
+		// CREATE INDEX IF NOT EXISTS "tableName_indexName" ON "tableName" ("column1", "column2", ...) WHERE predicate;
+		
+		NSMutableString *createIndex = [NSMutableString stringWithCapacity:100];
+		[createIndex appendFormat:@"CREATE INDEX IF NOT EXISTS \"%@\" ON \"%@\" (",
+		                          [self sqlNameForIndex:index], tableName];
+		
+		NSUInteger i = 0;
+		for (NSString *columnName in [index.columns arrayByAddingObjectsFromArray:index.coveringColumns])
+		{
+			if (i == 0)
+				[createIndex appendFormat:@"\"%@\"", columnName];
+			else
+				[createIndex appendFormat:@", \"%@\"", columnName];
+			
+			i++;
+		}
+		
+		[createIndex appendString:@")"];
+		
+		if (index.predicate) {
+			[createIndex appendFormat:@" WHERE %@", index.predicate];
+		}
+		
+		[createIndex appendString:@";"];
+		
+		status = sqlite3_exec(db, [createIndex UTF8String], NULL, NULL, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogError(@"Failed creating index '%@': %d %s", index.name, status, sqlite3_errmsg(db));
+			return NO;
+		}
+	}
+	
+	return YES;
+}
+
+/**
+ * Internal method.
+ *
+ * This method is called, after the table has been populated (and indexed),
+ * to calculate the initial state of the materialized aggregates.
+ * From then on, they're updated incrementally as rows are added, updated & removed.
+**/
+- (BOOL)populateAggregates
+{
+	NSArray<YapDatabaseSecondaryIndexAggregate *> *aggregates = parentConnection->parent->aggregates;
+	if ([aggregates count] == 0)
+	{
+		[self removeValueForExtensionKey:ext_key_aggregateNames persistent:YES];
+		return YES;
+	}
+	
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	NSString *tableName = [self tableName];
+	NSString *aggregatesTableName = [parentConnection->parent aggregatesTableName];
+	
+	for (YapDatabaseSecondaryIndexAggregate *aggregate in aggregates)
+	{
+		// INSERT INTO "aggregatesTableName" ("name", "group", "rows", "count", "sum", "min", "max")
+		//   SELECT ?, "groupBy", COUNT(*), COUNT("column"), SUM("column"), MIN("column"), MAX("column")
+		//   FROM "tableName" WHERE (predicate) GROUP BY "groupBy";
+		
+		NSString *group = aggregate.groupByColumn
+		  ? [NSString stringWithFormat:@"\"%@\"", aggregate.groupByColumn]
+		  : @"NULL";
+		
+		NSString *column = aggregate.column
+		  ? [NSString stringWithFormat:@"\"%@\"", aggregate.column]
+		  : @"NULL";
+		
+		NSMutableString *query = [NSMutableString stringWithCapacity:200];
+		[query appendFormat:
+		  @"INSERT INTO \"%@\" (\"name\", \"group\", \"rows\", \"count\", \"sum\", \"min\", \"max\")"
+		  @" SELECT ?, %@, COUNT(*), COUNT(%@), SUM(%@), MIN(%@), MAX(%@) FROM \"%@\"",
+		  aggregatesTableName, group, column, column, column, column, tableName];
+		
+		if (aggregate.predicate) {
+			[query appendFormat:@" WHERE %@", aggregate.predicate];
+		}
+		
+		[query appendFormat:@" GROUP BY %@;", group];
+		
+		sqlite3_stmt *statement = NULL;
+		
+		int status = sqlite3_prepare_v2(db, [query UTF8String], -1, &statement, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogError(@"Error creating statement for aggregate '%@': %d %s",
+			            aggregate.name, status, sqlite3_errmsg(db));
+			return NO;
+		}
+		
+		sqlite3_bind_text(statement, SQLITE_BIND_START, [aggregate.name UTF8String], -1, SQLITE_TRANSIENT);
+		
+		status = sqlite3_step(statement);
+		if (status != SQLITE_DONE)
+		{
+			YDBLogError(@"Error populating aggregate '%@': %d %s", aggregate.name, status, sqlite3_errmsg(db));
+		}
+		
+		sqlite3_finalize(statement);
+		
+		if (status != SQLITE_DONE) return NO;
+	}
+	
+	// Used by the DEBUG sanity check in createIfNeeded.
+	// (An aggregate may not have any rows in the aggregates table, so we can't get the names from there.)
+	
+	[self setStringValue:[self aggregateNames] forExtensionKey:ext_key_aggregateNames persistent:YES];
+	
 	return YES;
 }
 
 /**
  * Internal method.
  *
- * This method is called, if needed, to populate the FTS indexes.
- * It does so by enumerating the rows in the database, and invoking the usual blocks and insertion methods.
+ * Returns the (sorted) names of the aggregates in the setup, as a single string.
+ * Returns nil if there aren't any aggregates.
+**/
+- (NSString *)aggregateNames
+{
+	NSArray<YapDatabaseSecondaryIndexAggregate *> *aggregates = parentConnection->parent->aggregates;
+	if ([aggregates count] == 0) return nil;
+	
+	NSArray<NSString *> *names = [[aggregates valueForKey:@"name"] sortedArrayUsingSelector:@selector(compare:)];
+	
+	return [names componentsJoinedByString:@","];
+}
+
+/**
+ * Internal method.
+ *
+ * Index names are global within the database (not per-table),
+ * so the composite indexes are prefixed with our table name.
+**/
+- (NSString *)sqlNameForIndex:(YapDatabaseSecondaryIndexCompositeIndex *)index
+{
+	return [NSString stringWithFormat:@"%@_%@", [self tableName], index.name];
+}
+
+/**
+ * Internal method.
+ *
+ * The single column indexes are prefixed with our table name too.
+ * (The setup doesn't allow an index name that matches a column name, so these can't collide.)
+**/
+- (NSString *)sqlNameForColumnIndex:(YapDatabaseSecondaryIndexColumn *)column
+{
+	return [NSString stringWithFormat:@"%@_%@", [self tableName], column.name];
+}
+
+/**
+ * Internal method.
+ *
+ * Returns the names of all the (sqlite) indexes on our table.
+**/
+- (NSSet<NSString *> *)existingIndexNames
+{
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	NSMutableSet<NSString *> *indexNames = [NSMutableSet set];
+	
+	sqlite3_stmt *statement = NULL;
+	const char *query = "SELECT \"name\" FROM \"sqlite_master\" WHERE \"type\" = 'index' AND \"tbl_name\" = ?;";
+	
+	int status = sqlite3_prepare_v2(db, query, -1, &statement, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Error creating statement! %d %s", status, sqlite3_errmsg(db));
+		return indexNames;
+	}
+	
+	sqlite3_bind_text(statement, SQLITE_BIND_START, [[self tableName] UTF8String], -1, SQLITE_TRANSIENT);
+	
+	while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+	{
+		const unsigned char *text = sqlite3_column_text(statement, SQLITE_COLUMN_START);
+		int textSize = sqlite3_column_bytes(statement, SQLITE_COLUMN_START);
+		
+		NSString *name = [[NSString alloc] initWithBytes:text length:textSize encoding:NSUTF8StringEncoding];
+		if (name) {
+			[indexNames addObject:name];
+		}
+	}
+	
+	if (status != SQLITE_DONE)
+	{
+		YDBLogError(@"Error executing statement! %d %s", status, sqlite3_errmsg(db));
+	}
+	
+	sqlite3_finalize(statement);
+	return indexNames;
+}
+
+/**
+ * Internal method.
+ *
+ * This method is called, if needed, to populate the secondary index table.
+ * It does so by enumerating the rows in the database, and invoking the usual blocks.
+ * Expression columns are then calculated by sqlite (see populateExpressionColumns).
+ *
+ * The rows are inserted in batches (see insertRowids:withValues:).
+ * And the (sqlite) indexes on the table are only created afterwards (see createIndexes).
 **/
 - (BOOL)populate
 {
@@ -289,9 +664,42 @@ static NSString *const ext_key_version_deprecated = @"version";
 	__unsafe_unretained YapDatabaseSecondaryIndex *secondaryIndex = parentConnection->parent;
 	__unsafe_unretained YapWhitelistBlacklist *allowedCollections = secondaryIndex->options.allowedCollections;
 	
+	if (!secondaryIndex->hasBlockColumns)
+	{
+		// Every column is an expression column
+		return [self populateExpressionColumns];
+	}
+	
+	NSUInteger concurrency = secondaryIndex->options.populationConcurrency;
+	if (concurrency > 1 && [self populateWithConcurrency:concurrency])
+	{
+		return [self populateExpressionColumns];
+	}
+	
 	YapDatabaseSecondaryIndexHandler *handler = secondaryIndex->handler;
 	YapDatabaseBlockType blockType = handler->blockType;
 	
+	// The rows are collected, and inserted in batches.
+	
+	NSUInteger const batchSize = 1000;
+	
+	NSMutableData *pendingRowids = [NSMutableData dataWithCapacity:(batchSize * sizeof(int64_t))];
+	NSMutableArray<NSDictionary *> *pendingValues = [NSMutableArray arrayWithCapacity:batchSize];
+	
+	void (^addPendingRow)(int64_t rowid) = ^(int64_t rowid) {
+		
+		[pendingRowids appendBytes:&rowid length:sizeof(int64_t)];
+		[pendingValues addObject:[parentConnection->blockDict copy]];
+		
+		if ([pendingValues count] >= batchSize)
+		{
+			[self insertRowids:(const int64_t *)[pendingRowids bytes] withValues:pendingValues];
+			
+			[pendingRowids setLength:0];
+			[pendingValues removeAllObjects];
+		}
+	};
+	
 	if (blockType == YapDatabaseBlockTypeWithKey)
 	{
 		__unsafe_unretained YapDatabaseSecondaryIndexWithKeyBlock secondaryIndexBlock =
@@ -304,7 +712,7 @@ static NSString *const ext_key_version_deprecated = @"version";
 			
 			if ([parentConnection->blockDict count] > 0)
 			{
-				[self addRowid:rowid isNew:YES];
+				addPendingRow(rowid);
 				[parentConnection->blockDict removeAllObjects];
 			}
 		};
@@ -336,7 +744,7 @@ static NSString *const ext_key_version_deprecated = @"version";
 			
 			if ([parentConnection->blockDict count] > 0)
 			{
-				[self addRowid:rowid isNew:YES];
+				addPendingRow(rowid);
 				[parentConnection->blockDict removeAllObjects];
 			}
 		};
@@ -369,7 +777,7 @@ static NSString *const ext_key_version_deprecated = @"version";
 			
 			if ([parentConnection->blockDict count] > 0)
 			{
-				[self addRowid:rowid isNew:YES];
+				addPendingRow(rowid);
 				[parentConnection->blockDict removeAllObjects];
 			}
 		};
@@ -402,7 +810,7 @@ static NSString *const ext_key_version_deprecated = @"version";
 			
 			if ([parentConnection->blockDict count] > 0)
 			{
-				[self addRowid:rowid isNew:YES];
+				addPendingRow(rowid);
 				[parentConnection->blockDict removeAllObjects];
 			}
 		};
@@ -423,72 +831,353 @@ static NSString *const ext_key_version_deprecated = @"version";
 		}
 	}
 	
-	return YES;
+	if ([pendingValues count] > 0)
+	{
+		[self insertRowids:(const int64_t *)[pendingRowids bytes] withValues:pendingValues];
+	}
+	
+	return [self populateExpressionColumns];
 	
 #pragma clang diagnostic pop
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#pragma mark Accessors
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/**
- * Required override method from YapDatabaseExtensionTransaction.
-**/
-- (YapDatabaseReadTransaction *)databaseTransaction
-{
-	return databaseTransaction;
-}
-
-/**
- * Required override method from YapDatabaseExtensionTransaction.
-**/
-- (YapDatabaseExtensionConnection *)extensionConnection
-{
-	return parentConnection;
-}
-
-- (NSString *)registeredName
-{
-	return [parentConnection->parent registeredName];
-}
-
-- (NSString *)tableName
-{
-	return [parentConnection->parent tableName];
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#pragma mark Logic
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
 /**
- * Adds a row to the table, using the given rowid along with the values in the 'blockDict' ivar.
+ * Internal method.
+ *
+ * Populates the table by invoking the handler block concurrently,
+ * spreading the work over multiple threads, each using its own read-only connection.
+ *
+ * Returns NO if the table couldn't be populated concurrently (in which case nothing was written).
 **/
-- (void)addRowid:(int64_t)rowid isNew:(BOOL)isNew
+- (BOOL)populateWithConcurrency:(NSUInteger)concurrency
 {
 	YDBLogAutoTrace();
 	
-	sqlite3_stmt *statement = NULL;
-	if (isNew)
-		statement = [parentConnection insertStatement];
-	else
-		statement = [parentConnection updateStatement];
+	__unsafe_unretained YapDatabaseConnection *databaseConnection = databaseTransaction->connection;
 	
-	if (statement == NULL)
-		return;
+	// The read-only connections see the most recent commit.
+	// So if this transaction has already modified any rows, we can't use them.
 	
-	//  isNew : INSERT            INTO "tableName" ("rowid", "column1", "column2", ...) VALUES (?, ?, ? ...);
-	// !isNew : INSERT OR REPLACE INTO "tableName" ("rowid", "column1", "column2", ...) VALUES (?, ?, ? ...);
+	if ([databaseConnection->objectChanges count]      > 0 ||
+	    [databaseConnection->metadataChanges count]    > 0 ||
+	    [databaseConnection->insertedKeys count]       > 0 ||
+	    [databaseConnection->removedKeys count]        > 0 ||
+	    [databaseConnection->removedCollections count] > 0 ||
+	    [databaseConnection->removedRowids count]      > 0 || databaseConnection->allKeysRemoved)
+	{
+		YDBLogVerbose(@"(%@): Transaction has pending changes, populating serially", [self registeredName]);
+		return NO;
+	}
 	
-	int bind_idx = SQLITE_BIND_START;
+	__unsafe_unretained YapDatabaseSecondaryIndex *secondaryIndex = parentConnection->parent;
+	__unsafe_unretained YapWhitelistBlacklist *allowedCollections = secondaryIndex->options.allowedCollections;
+	
+	YapDatabaseSecondaryIndexHandler *handler = secondaryIndex->handler;
+	YapDatabaseBlockType blockType = handler->blockType;
+	YapDatabaseSecondaryIndexBlock block = handler->block;
+	
+	// Step 1 of 2:
+	//
+	// Collect the rowids.
+	// This is cheap compared to fetching the objects, and must happen within this transaction.
+	
+	NSMutableData *rowidData = [NSMutableData data];
+	
+	void (^enumBlock)(int64_t rowid, NSString *collection, NSString *key, BOOL *stop);
+	enumBlock = ^(int64_t rowid, NSString __unused *collection, NSString __unused *key, BOOL __unused *stop) {
+		
+		[rowidData appendBytes:&rowid length:sizeof(int64_t)];
+	};
+	
+	if (allowedCollections)
+	{
+		[databaseTransaction enumerateCollectionsUsingBlock:^(NSString *collection, BOOL __unused *stop) {
+			
+			if ([allowedCollections isAllowed:collection])
+			{
+				[self->databaseTransaction _enumerateKeysInCollections:@[ collection ] usingBlock:enumBlock];
+			}
+		}];
+	}
+	else // if (!allowedCollections)
+	{
+		[databaseTransaction _enumerateKeysInAllCollectionsUsingBlock:enumBlock];
+	}
+	
+	NSUInteger totalCount = [rowidData length] / sizeof(int64_t);
+	const int64_t *rowids = (const int64_t *)[rowidData bytes];
+	
+	if (totalCount == 0) {
+		return YES;
+	}
+	
+	// Step 2 of 2:
+	//
+	// Process the rows in batches.
+	//
+	// For each batch, the handler block is invoked concurrently.
+	// The rows of the batch are split into chunks,
+	// and worker N processes chunks N, N+workerCount, N+(2*workerCount), ...
+	// Then the resulting values are inserted into the table (serially, in rowid order).
+	
+	NSUInteger const chunkSize = 256;
+	NSUInteger const batchSize = chunkSize * concurrency * 4;
+	
+	NSUInteger workerCount = MIN(concurrency, (totalCount + chunkSize - 1) / chunkSize);
+	
+	YapDatabase *database = databaseConnection->database;
+	NSMutableArray<YapDatabaseConnection *> *workerConnections = [NSMutableArray arrayWithCapacity:workerCount];
+	
+	for (NSUInteger w = 0; w < workerCount; w++)
+	{
+		[workerConnections addObject:[database newConnection]];
+	}
+	
+	id columnNamesSharedKeySet = secondaryIndex->columnNamesSharedKeySet;
+	dispatch_queue_t globalQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+	
+	for (NSUInteger batchStart = 0; batchStart < totalCount; batchStart += batchSize) { @autoreleasepool {
+		
+		NSUInteger batchCount = MIN(batchSize, totalCount - batchStart);
+		NSUInteger chunkCount = (batchCount + chunkSize - 1) / chunkSize;
+		NSUInteger batchWorkerCount = MIN(workerCount, chunkCount);
+		
+		NSMutableArray<NSMutableDictionary *> *batchValues = [NSMutableArray arrayWithCapacity:batchCount];
+		for (NSUInteger i = 0; i < batchCount; i++)
+		{
+			[batchValues addObject:[NSMutableDictionary dictionaryWithSharedKeySet:columnNamesSharedKeySet]];
+		}
+		
+		dispatch_apply(batchWorkerCount, globalQueue, ^(size_t w) {
+			
+			YapDatabaseConnection *workerConnection = workerConnections[w];
+			
+			[workerConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+				
+				for (NSUInteger chunk = w; chunk < chunkCount; chunk += batchWorkerCount) { @autoreleasepool {
+					
+					NSUInteger start = chunk * chunkSize;
+					NSUInteger end = MIN(start + chunkSize, batchCount);
+					
+					for (NSUInteger i = start; i < end; i++)
+					{
+						int64_t rowid = rowids[batchStart + i];
+						NSMutableDictionary *dict = batchValues[i];
+						
+						YapCollectionKey *ck = nil;
+						
+						if (blockType == YapDatabaseBlockTypeWithKey)
+						{
+							ck = [transaction collectionKeyForRowid:rowid];
+							if (ck == nil) continue;
+							
+							__unsafe_unretained YapDatabaseSecondaryIndexWithKeyBlock secondaryIndexBlock =
+							    (YapDatabaseSecondaryIndexWithKeyBlock)block;
+							
+							secondaryIndexBlock(transaction, dict, ck.collection, ck.key);
+						}
+						else if (blockType == YapDatabaseBlockTypeWithObject)
+						{
+							id object = nil;
+							if (![transaction getCollectionKey:&ck object:&object forRowid:rowid]) continue;
+							
+							__unsafe_unretained YapDatabaseSecondaryIndexWithObjectBlock secondaryIndexBlock =
+							    (YapDatabaseSecondaryIndexWithObjectBlock)block;
+							
+							secondaryIndexBlock(transaction, dict, ck.collection, ck.key, object);
+						}
+						else if (blockType == YapDatabaseBlockTypeWithMetadata)
+						{
+							id metadata = nil;
+							if (![transaction getCollectionKey:&ck metadata:&metadata forRowid:rowid]) continue;
+							
+							__unsafe_unretained YapDatabaseSecondaryIndexWithMetadataBlock secondaryIndexBlock =
+							    (YapDatabaseSecondaryIndexWithMetadataBlock)block;
+							
+							secondaryIndexBlock(transaction, dict, ck.collection, ck.key, metadata);
+						}
+						else // if (blockType == YapDatabaseBlockTypeWithRow)
+						{
+							id object = nil;
+							id metadata = nil;
+							if (![transaction getCollectionKey:&ck object:&object metadata:&metadata forRowid:rowid]) continue;
+							
+							__unsafe_unretained YapDatabaseSecondaryIndexWithRowBlock secondaryIndexBlock =
+							    (YapDatabaseSecondaryIndexWithRowBlock)block;
+							
+							secondaryIndexBlock(transaction, dict, ck.collection, ck.key, object, metadata);
+						}
+					}
+				}}
+			}];
+		});
+		
+		[self insertRowids:(rowids + batchStart) withValues:batchValues];
+	}}
+	
+	return YES;
+}
+
+/**
+ * Internal method.
+ *
+ * This method is called, after the table has been populated via the handler block (if needed),
+ * to calculate the expression columns for every row.
+ * This happens entirely within sqlite, without deserializing any objects.
+**/
+- (BOOL)populateExpressionColumns
+{
+	YDBLogAutoTrace();
+	
+	__unsafe_unretained YapDatabaseSecondaryIndex *secondaryIndex = parentConnection->parent;
+	if (!secondaryIndex->hasExpressionColumns) return YES;
+	
+	__unsafe_unretained YapWhitelistBlacklist *allowedCollections = secondaryIndex->options.allowedCollections;
+	
+	sqlite3 *db = databaseTransaction->connection->db;
+	NSString *tableName = [self tableName];
+	
+	// The regular columns (if any) have already been written, so they're copied from the existing rows.
+	//
+	// INSERT OR REPLACE INTO "tableName" ("rowid", "column1", "column2", ...)
+	//   SELECT d."_rowid", t."column1", d."_e1", ... FROM
+	//     (SELECT "rowid" AS "_rowid", (expression2) AS "_e1", ... FROM "database2" WHERE "collection" = ?) AS d
+	//     LEFT JOIN "tableName" AS t ON t."rowid" = d."_rowid"
+	//   WHERE t."rowid" IS NOT NULL OR d."_e1" IS NOT NULL OR ...;
+	
+	NSMutableString *columns = [NSMutableString stringWithString:@"\"rowid\""];
+	NSMutableString *values = [NSMutableString stringWithString:@"d.\"_rowid\""];
+	NSMutableString *expressions = [NSMutableString stringWithString:@"\"rowid\" AS \"_rowid\""];
+	NSMutableString *where = [NSMutableString stringWithString:@"t.\"rowid\" IS NOT NULL"];
+	
+	NSUInteger i = 0;
+	for (YapDatabaseSecondaryIndexColumn *column in secondaryIndex->setup)
+	{
+		[columns appendFormat:@", \"%@\"", column.name];
+		
+		if (column.expression)
+		{
+			[values appendFormat:@", d.\"_e%lu\"", (unsigned long)i];
+			[expressions appendFormat:@", (%@) AS \"_e%lu\"", column.expression, (unsigned long)i];
+			[where appendFormat:@" OR d.\"_e%lu\" IS NOT NULL", (unsigned long)i];
+		}
+		else
+		{
+			[values appendFormat:@", t.\"%@\"", column.name];
+		}
+		
+		i++;
+	}
+	
+	NSString *query = [NSString stringWithFormat:
+	  @"INSERT OR REPLACE INTO \"%@\" (%@) SELECT %@ FROM"
+	  @" (SELECT %@ FROM \"database2\"%@) AS d"
+	  @" LEFT JOIN \"%@\" AS t ON t.\"rowid\" = d.\"_rowid\" WHERE %@;",
+	  tableName, columns, values,
+	  expressions, (allowedCollections ? @" WHERE \"collection\" = ?" : @""),
+	  tableName, where];
+	
+	sqlite3_stmt *statement = NULL;
+	
+	int status = sqlite3_prepare_v2(db, [query UTF8String], -1, &statement, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Error creating statement for expression columns (%@): %d %s",
+		            tableName, status, sqlite3_errmsg(db));
+		return NO;
+	}
+	
+	__block BOOL result = YES;
+	
+	void (^execute)(NSString *collection) = ^(NSString *collection) {
+		
+		if (collection) {
+			sqlite3_bind_text(statement, SQLITE_BIND_START, [collection UTF8String], -1, SQLITE_TRANSIENT);
+		}
+		
+		int stepStatus = sqlite3_step(statement);
+		if (stepStatus != SQLITE_DONE)
+		{
+			YDBLogError(@"Error populating expression columns (%@): %d %s",
+			            tableName, stepStatus, sqlite3_errmsg(db));
+			result = NO;
+		}
+		
+		sqlite3_clear_bindings(statement);
+		sqlite3_reset(statement);
+	};
+	
+	if (allowedCollections)
+	{
+		NSMutableArray<NSString *> *collections = [NSMutableArray array];
+		
+		[databaseTransaction enumerateCollectionsUsingBlock:^(NSString *collection, BOOL __unused *stop) {
+			
+			if ([allowedCollections isAllowed:collection])
+			{
+				[collections addObject:collection];
+			}
+		}];
+		
+		for (NSString *collection in collections)
+		{
+			execute(collection);
+		}
+	}
+	else // if (!allowedCollections)
+	{
+		execute(nil);
+	}
 	
-	sqlite3_bind_int64(statement, bind_idx, rowid);
-	bind_idx++;
+	sqlite3_finalize(statement);
 	
+	[parentConnection->mutationStack markAsMutated];
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Accessors
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Required override method from YapDatabaseExtensionTransaction.
+**/
+- (YapDatabaseReadTransaction *)databaseTransaction
+{
+	return databaseTransaction;
+}
+
+/**
+ * Required override method from YapDatabaseExtensionTransaction.
+**/
+- (YapDatabaseExtensionConnection *)extensionConnection
+{
+	return parentConnection;
+}
+
+- (NSString *)registeredName
+{
+	return [parentConnection->parent registeredName];
+}
+
+- (NSString *)tableName
+{
+	return [parentConnection->parent tableName];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Logic
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Binds the given values (generally the 'blockDict' ivar) to the given statement (in the order of the setup columns).
+ * Used for both writing the index, and checking whether the index is already up-to-date.
+**/
+- (void)bindColumnValues:(NSDictionary *)values toStatement:(sqlite3_stmt *)statement startingAtIndex:(int)bind_idx
+{
 	for (YapDatabaseSecondaryIndexColumn *column in parentConnection->parent->setup)
 	{
-		id columnValue = [parentConnection->blockDict objectForKey:column.name];
+		id columnValue = [values objectForKey:column.name];
 		if (columnValue && columnValue != [NSNull null])
 		{
 			if (column.type == YapDatabaseSecondaryIndexTypeInteger ||
@@ -566,21 +1255,448 @@ static NSString *const ext_key_version_deprecated = @"version";
 		
 		bind_idx++;
 	}
+}
+
+/**
+ * Adds a row to the table, using the given rowid along with the values in the 'blockDict' ivar.
+ *
+ * If the setup contains expression columns, then those are calculated by sqlite.
+ * And if neither the blockDict nor the expressions provide any values, then the row is removed instead.
+**/
+- (void)addRowid:(int64_t)rowid isNew:(BOOL)isNew
+{
+	YDBLogAutoTrace();
+	
+	BOOL hasExpressionColumns = parentConnection->parent->hasExpressionColumns;
+	
+	sqlite3_stmt *statement = NULL;
+	if (hasExpressionColumns)
+		statement = [parentConnection expressionInsertStatement];
+	else if (isNew)
+		statement = [parentConnection insertStatement];
+	else
+		statement = [parentConnection updateStatement];
+	
+	if (statement == NULL)
+		return;
+	
+	// The materialized aggregates (if any) are updated by removing the row's previous contribution,
+	// and then adding its new contribution.
+	
+	BOOL hasAggregates = ([parentConnection->parent->aggregates count] > 0);
+	
+	YDBAggregateContribution *oldContributions = NULL;
+	if (hasAggregates && !isNew)
+	{
+		oldContributions = [self aggregateContributionsForRowid:rowid];
+	}
+	
+	//  isNew : INSERT            INTO "tableName" ("rowid", "column1", "column2", ...) VALUES (?, ?, ? ...);
+	// !isNew : INSERT OR REPLACE INTO "tableName" ("rowid", "column1", "column2", ...) VALUES (?, ?, ? ...);
+	
+	sqlite3_bind_int64(statement, SQLITE_BIND_START, rowid);
+	[self bindColumnValues:parentConnection->blockDict toStatement:statement startingAtIndex:(SQLITE_BIND_START + 1)];
+	
+	if (hasExpressionColumns)
+	{
+		int bind_idx_hasValues = SQLITE_BIND_START + 1 + (int)[parentConnection->parent->setup count];
+		sqlite3_bind_int(statement, bind_idx_hasValues, ([parentConnection->blockDict count] > 0));
+	}
+	
+	BOOL written = NO;
 	
 	int status = sqlite3_step(statement);
-	if (status != SQLITE_DONE)
+	if (status == SQLITE_DONE)
+	{
+		written = !hasExpressionColumns || (sqlite3_changes(databaseTransaction->connection->db) > 0);
+	}
+	else
 	{
 		YDBLogError(@"Error executing '%s': %d %s",
-		            isNew ? "insertStatement" : "updateStatement",
+		            hasExpressionColumns ? "expressionInsertStatement" : (isNew ? "insertStatement" : "updateStatement"),
 		            status, sqlite3_errmsg(databaseTransaction->connection->db));
 	}
 	
 	sqlite3_clear_bindings(statement);
 	sqlite3_reset(statement);
 	
+	if (hasExpressionColumns && !written && status == SQLITE_DONE)
+	{
+		// Neither the handler block nor the expressions provided any values.
+		
+		[self freeAggregateContributions:oldContributions];
+		
+		if (!isNew) {
+			[self removeRowid:rowid];
+		}
+		return;
+	}
+	
+	if (hasAggregates)
+	{
+		[self removeAggregateContributions:oldContributions];
+		[self freeAggregateContributions:oldContributions];
+		
+		YDBAggregateContribution *newContributions = [self aggregateContributionsForRowid:rowid];
+		
+		[self addAggregateContributions:newContributions];
+		[self freeAggregateContributions:newContributions];
+	}
+	
 	[parentConnection->mutationStack markAsMutated];
 }
 
+/**
+ * Adds multiple rows to the table, using the given rowids along with the corresponding values.
+ * Rows with empty values are skipped.
+ *
+ * This is used when populating the table.
+ * The rows are inserted in groups, using the multi-row bulkInsertStatement,
+ * which is significantly faster than executing the insertStatement for each row.
+**/
+- (void)insertRowids:(const int64_t *)rowids withValues:(NSArray<NSDictionary *> *)values
+{
+	YDBLogAutoTrace();
+	
+	sqlite3_stmt *bulkStatement = [parentConnection bulkInsertStatement];
+	sqlite3_stmt *statement = [parentConnection insertStatement];
+	
+	if (bulkStatement == NULL || statement == NULL)
+		return;
+	
+	NSUInteger count = 0;
+	NSUInteger *indexes = (NSUInteger *)malloc(sizeof(NSUInteger) * MAX([values count], (NSUInteger)1));
+	
+	NSUInteger index = 0;
+	for (NSDictionary *rowValues in values)
+	{
+		if ([rowValues count] > 0) {
+			indexes[count++] = index;
+		}
+		index++;
+	}
+	
+	// Full groups of rows are inserted with the bulkInsertStatement,
+	// and any remaining rows are inserted one at a time with the insertStatement.
+	//
+	// INSERT INTO "tableName" ("rowid", "column1", ...) VALUES (?, ?, ...), (?, ?, ...), ...;
+	// INSERT INTO "tableName" ("rowid", "column1", ...) VALUES (?, ?, ...);
+	
+	NSUInteger rowsPerStatement = [parentConnection bulkInsertRowCount];
+	NSUInteger bulkCount = (count / rowsPerStatement) * rowsPerStatement;
+	
+	int parametersPerRow = (int)(1 + [parentConnection->parent->setup count]);
+	
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		int64_t rowid = rowids[indexes[i]];
+		NSDictionary *rowValues = values[indexes[i]];
+		
+		if (i < bulkCount)
+		{
+			int bind_idx = SQLITE_BIND_START + (int)(i % rowsPerStatement) * parametersPerRow;
+			
+			sqlite3_bind_int64(bulkStatement, bind_idx, rowid);
+			[self bindColumnValues:rowValues toStatement:bulkStatement startingAtIndex:(bind_idx + 1)];
+			
+			if ((i % rowsPerStatement) == (rowsPerStatement - 1))
+			{
+				int status = sqlite3_step(bulkStatement);
+				if (status != SQLITE_DONE)
+				{
+					YDBLogError(@"Error executing 'bulkInsertStatement': %d %s",
+					            status, sqlite3_errmsg(databaseTransaction->connection->db));
+				}
+				
+				sqlite3_clear_bindings(bulkStatement);
+				sqlite3_reset(bulkStatement);
+			}
+		}
+		else
+		{
+			sqlite3_bind_int64(statement, SQLITE_BIND_START, rowid);
+			[self bindColumnValues:rowValues toStatement:statement startingAtIndex:(SQLITE_BIND_START + 1)];
+			
+			int status = sqlite3_step(statement);
+			if (status != SQLITE_DONE)
+			{
+				YDBLogError(@"Error executing 'insertStatement': %d %s",
+				            status, sqlite3_errmsg(databaseTransaction->connection->db));
+			}
+			
+			sqlite3_clear_bindings(statement);
+			sqlite3_reset(statement);
+		}
+	}
+	
+	free(indexes);
+	
+	if (count > 0) {
+		[parentConnection->mutationStack markAsMutated];
+	}
+}
+
+/**
+ * Returns YES if the index already contains the given rowid, with the values in the 'blockDict' ivar.
+ * In which case there's no need to re-write the row (or update the sqlite indexes on its columns).
+**/
+- (BOOL)isUnchangedRowid:(int64_t)rowid
+{
+	sqlite3_stmt *statement = [parentConnection unchangedStatement];
+	if (statement == NULL)
+		return NO;
+	
+	// SELECT 1 FROM "tableName" WHERE "rowid" = ? AND "column1" IS ? AND "column2" IS ? ...;
+	//
+	// Note: The values are bound exactly as they are when writing the row,
+	// so the comparison is subject to the same type affinity conversions.
+	
+	sqlite3_bind_int64(statement, SQLITE_BIND_START, rowid);
+	[self bindColumnValues:parentConnection->blockDict toStatement:statement startingAtIndex:(SQLITE_BIND_START + 1)];
+	
+	BOOL unchanged = NO;
+	
+	int status = sqlite3_step(statement);
+	if (status == SQLITE_ROW)
+	{
+		unchanged = YES;
+	}
+	else if (status != SQLITE_DONE)
+	{
+		YDBLogError(@"Error executing 'unchangedStatement': %d %s",
+		            status, sqlite3_errmsg(databaseTransaction->connection->db));
+	}
+	
+	sqlite3_clear_bindings(statement);
+	sqlite3_reset(statement);
+	
+	return unchanged;
+}
+
+/**
+ * Returns the contribution of the given row to each of the materialized aggregates (in the order of the aggregates).
+ * Returns NULL if there aren't any aggregates, or if the row doesn't exist.
+ *
+ * The values are copied, so the result remains valid after the row is changed.
+ * The caller must free the result using freeAggregateContributions:.
+**/
+- (YDBAggregateContribution *)aggregateContributionsForRowid:(int64_t)rowid
+{
+	NSUInteger count = [parentConnection->parent->aggregates count];
+	if (count == 0) return NULL;
+	
+	sqlite3_stmt *statement = [parentConnection aggregateContributionsStatement];
+	if (statement == NULL) return NULL;
+	
+	// SELECT "group1", "column1", CASE WHEN (predicate1) THEN 1 ELSE 0 END, ... FROM "tableName" WHERE "rowid" = ?;
+	
+	sqlite3_bind_int64(statement, SQLITE_BIND_START, rowid);
+	
+	YDBAggregateContribution *contributions = NULL;
+	
+	int status = sqlite3_step(statement);
+	if (status == SQLITE_ROW)
+	{
+		contributions = (YDBAggregateContribution *)calloc(count, sizeof(YDBAggregateContribution));
+		
+		for (NSUInteger i = 0; i < count; i++)
+		{
+			int column_idx = SQLITE_COLUMN_START + (int)(i * 3);
+			
+			if (sqlite3_column_int(statement, column_idx + 2) != 0)
+			{
+				contributions[i].included = YES;
+				contributions[i].group = sqlite3_value_dup(sqlite3_column_value(statement, column_idx));
+				contributions[i].value = sqlite3_value_dup(sqlite3_column_value(statement, column_idx + 1));
+			}
+		}
+	}
+	else if (status != SQLITE_DONE)
+	{
+		YDBLogError(@"Error executing 'aggregateContributionsStatement': %d %s",
+		            status, sqlite3_errmsg(databaseTransaction->connection->db));
+	}
+	
+	sqlite3_clear_bindings(statement);
+	sqlite3_reset(statement);
+	
+	return contributions;
+}
+
+- (void)freeAggregateContributions:(YDBAggregateContribution *)contributions
+{
+	if (contributions == NULL) return;
+	
+	NSUInteger count = [parentConnection->parent->aggregates count];
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		sqlite3_value_free(contributions[i].group);
+		sqlite3_value_free(contributions[i].value);
+	}
+	
+	free(contributions);
+}
+
+/**
+ * Binds the aggregate's name (?1), along with the group (?2) & value (?3) of the contribution.
+**/
+- (void)bindAggregate:(YapDatabaseSecondaryIndexAggregate *)aggregate
+         contribution:(YDBAggregateContribution *)contribution
+          toStatement:(sqlite3_stmt *)statement
+{
+	sqlite3_bind_text(statement, SQLITE_BIND_START, [aggregate.name UTF8String], -1, SQLITE_TRANSIENT);
+	sqlite3_bind_value(statement, SQLITE_BIND_START + 1, contribution->group);
+	
+	if (sqlite3_bind_parameter_count(statement) > 2) {
+		sqlite3_bind_value(statement, SQLITE_BIND_START + 2, contribution->value);
+	}
+}
+
+/**
+ * Adds the contributions of a row (that was just added or updated) to the materialized aggregates.
+**/
+- (void)addAggregateContributions:(YDBAggregateContribution *)contributions
+{
+	if (contributions == NULL) return;
+	
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	sqlite3_stmt *addStatement = [parentConnection aggregateAddStatement];
+	sqlite3_stmt *insertStatement = [parentConnection aggregateInsertStatement];
+	
+	if (addStatement == NULL || insertStatement == NULL)
+		return;
+	
+	NSUInteger i = 0;
+	for (YapDatabaseSecondaryIndexAggregate *aggregate in parentConnection->parent->aggregates)
+	{
+		YDBAggregateContribution *contribution = &contributions[i++];
+		if (!contribution->included) continue;
+		
+		// UPDATE "aggregatesTableName" SET "rows" = "rows" + 1, ... WHERE "name" = ?1 AND "group" IS ?2;
+		
+		[self bindAggregate:aggregate contribution:contribution toStatement:addStatement];
+		
+		BOOL groupExists = NO;
+		
+		int status = sqlite3_step(addStatement);
+		if (status == SQLITE_DONE)
+		{
+			groupExists = (sqlite3_changes(db) > 0);
+		}
+		else
+		{
+			YDBLogError(@"Error executing 'aggregateAddStatement': %d %s", status, sqlite3_errmsg(db));
+		}
+		
+		sqlite3_clear_bindings(addStatement);
+		sqlite3_reset(addStatement);
+		
+		if (groupExists || status != SQLITE_DONE) continue;
+		
+		// First row in the group:
+		//
+		// INSERT INTO "aggregatesTableName" ("name", "group", "rows", "count", "sum", "min", "max")
+		//   VALUES (?1, ?2, 1, (?3 IS NOT NULL), ?3, ?3, ?3);
+		
+		[self bindAggregate:aggregate contribution:contribution toStatement:insertStatement];
+		
+		status = sqlite3_step(insertStatement);
+		if (status != SQLITE_DONE)
+		{
+			YDBLogError(@"Error executing 'aggregateInsertStatement': %d %s", status, sqlite3_errmsg(db));
+		}
+		
+		sqlite3_clear_bindings(insertStatement);
+		sqlite3_reset(insertStatement);
+	}
+}
+
+/**
+ * Removes the contributions of a row (that was just updated or removed) from the materialized aggregates.
+**/
+- (void)removeAggregateContributions:(YDBAggregateContribution *)contributions
+{
+	if (contributions == NULL) return;
+	
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	sqlite3_stmt *removeStatement = [parentConnection aggregateRemoveStatement];
+	sqlite3_stmt *removeEmptyStatement = [parentConnection aggregateRemoveEmptyStatement];
+	
+	if (removeStatement == NULL || removeEmptyStatement == NULL)
+		return;
+	
+	NSUInteger i = 0;
+	for (YapDatabaseSecondaryIndexAggregate *aggregate in parentConnection->parent->aggregates)
+	{
+		NSUInteger aggregateIndex = i++;
+		
+		YDBAggregateContribution *contribution = &contributions[aggregateIndex];
+		if (!contribution->included) continue;
+		
+		// UPDATE "aggregatesTableName" SET "rows" = "rows" - 1, ... WHERE "name" = ?1 AND "group" IS ?2;
+		
+		[self bindAggregate:aggregate contribution:contribution toStatement:removeStatement];
+		
+		int status = sqlite3_step(removeStatement);
+		if (status != SQLITE_DONE)
+		{
+			YDBLogError(@"Error executing 'aggregateRemoveStatement': %d %s", status, sqlite3_errmsg(db));
+		}
+		
+		sqlite3_clear_bindings(removeStatement);
+		sqlite3_reset(removeStatement);
+		
+		if ((aggregate.function == YapDatabaseSecondaryIndexAggregateFunctionMin ||
+		     aggregate.function == YapDatabaseSecondaryIndexAggregateFunctionMax) &&
+		    sqlite3_value_type(contribution->value) != SQLITE_NULL)
+		{
+			[self recalculateExtremeForAggregateAtIndex:aggregateIndex ifRemovedContribution:contribution];
+		}
+		
+		// DELETE FROM "aggregatesTableName" WHERE "name" = ? AND "group" IS ? AND "rows" <= 0;
+		
+		[self bindAggregate:aggregate contribution:contribution toStatement:removeEmptyStatement];
+		
+		status = sqlite3_step(removeEmptyStatement);
+		if (status != SQLITE_DONE)
+		{
+			YDBLogError(@"Error executing 'aggregateRemoveEmptyStatement': %d %s", status, sqlite3_errmsg(db));
+		}
+		
+		sqlite3_clear_bindings(removeEmptyStatement);
+		sqlite3_reset(removeEmptyStatement);
+	}
+}
+
+/**
+ * If the removed value was the current min (or max) value of the group,
+ * then the new min (or max) value is calculated from the table (using an index, if available).
+**/
+- (void)recalculateExtremeForAggregateAtIndex:(NSUInteger)aggregateIndex
+                        ifRemovedContribution:(YDBAggregateContribution *)contribution
+{
+	sqlite3_stmt *statement = [parentConnection aggregateExtremeStatementAtIndex:aggregateIndex];
+	if (statement == NULL) return;
+	
+	YapDatabaseSecondaryIndexAggregate *aggregate = parentConnection->parent->aggregates[aggregateIndex];
+	
+	// UPDATE "aggregatesTableName" SET "min" = (SELECT MIN(...) ...) WHERE "name" = ?1 AND "group" IS ?2 AND "min" = ?3;
+	
+	[self bindAggregate:aggregate contribution:contribution toStatement:statement];
+	
+	int status = sqlite3_step(statement);
+	if (status != SQLITE_DONE)
+	{
+		YDBLogError(@"Error recalculating aggregate '%@': %d %s",
+		            aggregate.name, status, sqlite3_errmsg(databaseTransaction->connection->db));
+	}
+	
+	sqlite3_clear_bindings(statement);
+	sqlite3_reset(statement);
+}
+
 - (void)removeRowid:(int64_t)rowid
 {
 	YDBLogAutoTrace();
@@ -588,6 +1704,8 @@ static NSString *const ext_key_version_deprecated = @"version";
 	sqlite3_stmt *statement = [parentConnection removeStatement];
 	if (statement == NULL) return;
 	
+	YDBAggregateContribution *contributions = [self aggregateContributionsForRowid:rowid];
+	
 	// DELETE FROM "tableName" WHERE "rowid" = ?;
 	
 	int const bind_idx_rowid = SQLITE_BIND_START;
@@ -604,6 +1722,9 @@ static NSString *const ext_key_version_deprecated = @"version";
 	sqlite3_clear_bindings(statement);
 	sqlite3_reset(statement);
 	
+	[self removeAggregateContributions:contributions];
+	[self freeAggregateContributions:contributions];
+	
 	[parentConnection->mutationStack markAsMutated];
 }
 
@@ -614,11 +1735,15 @@ static NSString *const ext_key_version_deprecated = @"version";
 	NSUInteger count = [rowids count];
 	
 	if (count == 0) return;
-	if (count == 1)
+	if (count == 1 || [parentConnection->parent->aggregates count] > 0)
 	{
-		int64_t rowid = [[rowids objectAtIndex:0] longLongValue];
+		// The materialized aggregates need the values of each row before it's removed.
+		// So in that case, the rows are removed one at a time.
 		
-		[self removeRowid:rowid];
+		for (NSNumber *rowidNumber in rowids)
+		{
+			[self removeRowid:[rowidNumber longLongValue]];
+		}
 		return;
 	}
 	
@@ -696,6 +1821,25 @@ static NSString *const ext_key_version_deprecated = @"version";
 	
 	sqlite3_reset(statement);
 	
+	if ([parentConnection->parent->aggregates count] > 0)
+	{
+		sqlite3_stmt *aggregatesStatement = [parentConnection aggregateRemoveAllStatement];
+		if (aggregatesStatement)
+		{
+			// DELETE FROM "aggregatesTableName";
+			
+			status = sqlite3_step(aggregatesStatement);
+			if (status != SQLITE_DONE)
+			{
+				YDBLogError(@"(%@): Error in aggregateRemoveAllStatement: %d %s",
+				            [self registeredName],
+				            status, sqlite3_errmsg(databaseTransaction->connection->db));
+			}
+			
+			sqlite3_reset(aggregatesStatement);
+		}
+	}
+	
 	[parentConnection->mutationStack markAsMutated];
 }
 
@@ -766,40 +1910,55 @@ static NSString *const ext_key_version_deprecated = @"version";
 	}
 	
 	// Invoke the block to find out if the object should be included in the index.
+	// (Unless every column is an expression column, in which case sqlite calculates all the values.)
 	
 	YapDatabaseSecondaryIndexHandler *handler = secondaryIndex->handler;
 	YapDatabaseBlockType blockType = handler->blockType;
 	
-	if (blockType == YapDatabaseBlockTypeWithKey)
-	{
-		__unsafe_unretained YapDatabaseSecondaryIndexWithKeyBlock block =
-		    (YapDatabaseSecondaryIndexWithKeyBlock)handler->block;
-		
-		block(databaseTransaction, parentConnection->blockDict, collection, key);
-	}
-	else if (blockType == YapDatabaseBlockTypeWithObject)
-	{
-		__unsafe_unretained YapDatabaseSecondaryIndexWithObjectBlock block =
-		    (YapDatabaseSecondaryIndexWithObjectBlock)handler->block;
-		
-		block(databaseTransaction, parentConnection->blockDict, collection, key, object);
-	}
-	else if (blockType == YapDatabaseBlockTypeWithMetadata)
+	if (secondaryIndex->hasBlockColumns)
 	{
-		__unsafe_unretained YapDatabaseSecondaryIndexWithMetadataBlock block =
-		    (YapDatabaseSecondaryIndexWithMetadataBlock)handler->block;
-		
-		block(databaseTransaction, parentConnection->blockDict, collection, key, metadata);
+		if (blockType == YapDatabaseBlockTypeWithKey)
+		{
+			__unsafe_unretained YapDatabaseSecondaryIndexWithKeyBlock block =
+			    (YapDatabaseSecondaryIndexWithKeyBlock)handler->block;
+			
+			block(databaseTransaction, parentConnection->blockDict, collection, key);
+		}
+		else if (blockType == YapDatabaseBlockTypeWithObject)
+		{
+			__unsafe_unretained YapDatabaseSecondaryIndexWithObjectBlock block =
+			    (YapDatabaseSecondaryIndexWithObjectBlock)handler->block;
+			
+			block(databaseTransaction, parentConnection->blockDict, collection, key, object);
+		}
+		else if (blockType == YapDatabaseBlockTypeWithMetadata)
+		{
+			__unsafe_unretained YapDatabaseSecondaryIndexWithMetadataBlock block =
+			    (YapDatabaseSecondaryIndexWithMetadataBlock)handler->block;
+			
+			block(databaseTransaction, parentConnection->blockDict, collection, key, metadata);
+		}
+		else
+		{
+			__unsafe_unretained YapDatabaseSecondaryIndexWithRowBlock block =
+			    (YapDatabaseSecondaryIndexWithRowBlock)handler->block;
+			
+			block(databaseTransaction, parentConnection->blockDict, collection, key, object, metadata);
+		}
 	}
-	else
+	
+	if (secondaryIndex->hasExpressionColumns)
 	{
-		__unsafe_unretained YapDatabaseSecondaryIndexWithRowBlock block =
-		    (YapDatabaseSecondaryIndexWithRowBlock)handler->block;
+		// The row is included if the block provided any values, or if any of the expressions are non-NULL.
+		// This is decided by sqlite (see addRowid:isNew:).
 		
-		block(databaseTransaction, parentConnection->blockDict, collection, key, object, metadata);
+		if (isInsert || ![self isUnchangedRowid:rowid])
+		{
+			[self addRowid:rowid isNew:isInsert];
+		}
+		[parentConnection->blockDict removeAllObjects];
 	}
-	
-	if ([parentConnection->blockDict count] == 0)
+	else if ([parentConnection->blockDict count] == 0)
 	{
 		// Remove associated values from index (if needed).
 		
@@ -811,9 +1970,12 @@ static NSString *const ext_key_version_deprecated = @"version";
 	else
 	{
 		// Add values to index (or update them).
-		// This was an update operation, so we need to insert or update.
+		// If this was an update operation, and the indexed values didn't change, we can skip the write.
 		
-		[self addRowid:rowid isNew:isInsert];
+		if (isInsert || ![self isUnchangedRowid:rowid])
+		{
+			[self addRowid:rowid isNew:isInsert];
+		}
 		[parentConnection->blockDict removeAllObjects];
 	}
 }
@@ -1120,69 +2282,82 @@ static NSString *const ext_key_version_deprecated = @"version";
 	return statement;
 }
 
-- (void)bindQueryParameters:(NSArray *)queryParams forStatement:(sqlite3_stmt *)statement withOffset:(int)bind_idx_start
+/**
+ * Adds the query to the connection's slow query log (if the elapsed time exceeds the threshold).
+ * Only invoke this method if the log is enabled (parentConnection->slowQueryLog is non-nil).
+**/
+- (void)recordQueryString:(NSString *)fullQueryString
+               parameters:(NSArray *)queryParams
+                 rowCount:(NSUInteger)rowCount
+                startTime:(CFAbsoluteTime)startTime
 {
-	int bind_idx = bind_idx_start;
+	NSTimeInterval elapsed = CFAbsoluteTimeGetCurrent() - startTime;
 	
-	for (id value in queryParams)
-	{
-		if ([value isKindOfClass:[NSNumber class]])
-		{
-			__unsafe_unretained NSNumber *cast = (NSNumber *)value;
-			
-			CFNumberType numType = CFNumberGetType((__bridge CFNumberRef)cast);
-			
-			if (numType == kCFNumberFloatType   ||
-			    numType == kCFNumberFloat32Type ||
-			    numType == kCFNumberFloat64Type ||
-			    numType == kCFNumberDoubleType  ||
-			    numType == kCFNumberCGFloatType  )
-			{
-				double num = [cast doubleValue];
-				sqlite3_bind_double(statement, bind_idx, num);
-			}
-			else
-			{
-				int64_t num = [cast longLongValue];
-				sqlite3_bind_int64(statement, bind_idx, (sqlite3_int64)num);
-			}
-		}
-		else if ([value isKindOfClass:[NSDate class]])
-		{
-			__unsafe_unretained NSDate *cast = (NSDate *)value;
-			
-			double num = [cast timeIntervalSinceReferenceDate];
-			sqlite3_bind_double(statement, bind_idx, num);
-		}
-		else if ([value isKindOfClass:[NSString class]])
-		{
-			__unsafe_unretained NSString *cast = (NSString *)value;
-			
-			sqlite3_bind_text(statement, bind_idx, [cast UTF8String], -1, SQLITE_TRANSIENT);
-		}
-		else
-		{
-			YDBLogWarn(@"Unable to bind value for with unsupported class: %@", NSStringFromClass([value class]));
-		}
-		
-		bind_idx++;
-	}
+	[parentConnection->slowQueryLog recordQueryString:fullQueryString
+	                                       parameters:queryParams
+	                                         rowCount:rowCount
+	                                         duration:elapsed];
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Standard Query - Enumerate
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-- (BOOL)_enumerateRowidsMatchingQuery:(YapDatabaseQuery *)query
-                           usingBlock:(void (NS_NOESCAPE^)(int64_t rowid, BOOL *stop))block
+/**
+ * Returns the statement executed by the enumerate methods for the given query.
+**/
+- (NSString *)enumerateQueryStringForQuery:(YapDatabaseQuery *)query
+                               withObjects:(BOOL)withObjects
+                                  metadata:(BOOL)withMetadata
+{
+	// The index query is nested within a subquery, so the column names within the given filtering clause(s)
+	// can't conflict with those in the database2 table (e.g. "rowid").
+	// The extra level of nesting (with "LIMIT -1") prevents sqlite from flattening the subquery into the join,
+	// which would discard its ORDER BY clause.
+	// And the CROSS JOIN ensures the matches are the outer loop, so the results are returned in that order.
+	//
+	// SELECT "database2"."collection", "database2"."key" [, "database2"."data"] [, "database2"."metadata"]
+	//   FROM (SELECT "rowid" FROM (SELECT "rowid" FROM "tableName" <query>) LIMIT -1) AS "matches"
+	//   CROSS JOIN "database2" ON "database2"."rowid" = "matches"."rowid";
+	
+	NSMutableString *fullQueryString = [NSMutableString stringWithCapacity:256];
+	[fullQueryString appendString:@"SELECT \"database2\".\"collection\", \"database2\".\"key\""];
+	
+	if (withObjects)
+		[fullQueryString appendString:@", \"database2\".\"data\""];
+	if (withMetadata)
+		[fullQueryString appendString:@", \"database2\".\"metadata\""];
+	
+	[fullQueryString appendFormat:
+	  @" FROM (SELECT \"rowid\" FROM (SELECT \"rowid\" FROM \"%@\" %@) LIMIT -1) AS \"matches\""
+	  @" CROSS JOIN \"database2\" ON \"database2\".\"rowid\" = \"matches\".\"rowid\";",
+	  [self tableName], query.queryString];
+	
+	return fullQueryString;
+}
+
+/**
+ * Internal method.
+ *
+ * Executes the query as a single statement that joins the index table to the database2 table (on rowid),
+ * so the collection, key, object & metadata are fetched in the same pass.
+ * This avoids a separate lookup (or 2) in the database2 table for every matching row.
+ *
+ * Objects & metadata that are already in the connection's cache are taken from the cache (and not deserialized).
+**/
+- (BOOL)_enumerateRowsMatchingQuery:(YapDatabaseQuery *)query
+                        withObjects:(BOOL)withObjects
+                           metadata:(BOOL)withMetadata
+                         usingBlock:(void (NS_NOESCAPE^)(YapCollectionKey *ck, id object, id metadata, BOOL *stop))block
 {
 	if (query == nil) return NO;
 	if (query.isAggregateQuery) return NO;
 	
-	// Create full query using given filtering clause(s)
+	// Create full query using given filtering clause(s).
 	
-	NSString *fullQueryString =
-	    [NSString stringWithFormat:@"SELECT \"rowid\" FROM \"%@\" %@;", [self tableName], query.queryString];
+	NSString *fullQueryString = [self enumerateQueryStringForQuery:query withObjects:withObjects metadata:withMetadata];
+	
+	CFAbsoluteTime startTime = parentConnection->slowQueryLog ? CFAbsoluteTimeGetCurrent() : 0.0;
 	
 	// Turn query into compiled sqlite statement (using cache if possible)
 	
@@ -1194,32 +2369,38 @@ static NSString *const ext_key_version_deprecated = @"version";
 	
 	// Bind query parameters appropriately.
 	
-	[self bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
+	[databaseTransaction bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
 	
 	// Enumerate query results
 	
+	int const column_idx_collection = SQLITE_COLUMN_START + 0;
+	int const column_idx_key        = SQLITE_COLUMN_START + 1;
+	int const column_idx_data       = withObjects  ? (column_idx_key + 1) : -1;
+	int const column_idx_metadata   = withMetadata ? (column_idx_key + (withObjects ? 2 : 1)) : -1;
+	
+	NSUInteger rowCount = 0;
+	
 	BOOL stop = NO;
 	YapMutationStackItem_Bool *mutation = [parentConnection->mutationStack push]; // mutation during enum protection
 	
-	int status;
-	while ((status = sqlite3_step(statement)) == SQLITE_ROW)
-	{
-		int64_t rowid = sqlite3_column_int64(statement, SQLITE_COLUMN_START);
-		
-		block(rowid, &stop);
-			
-		if (stop || mutation.isMutated) break;
-	}
-	
-	if ((status != SQLITE_DONE) && !stop && !mutation.isMutated)
-	{
-		YDBLogError(@"sqlite_step error: %d %s",
-		            status, sqlite3_errmsg(databaseTransaction->connection->db));
-	}
+	int status = [databaseTransaction _enumerateRowsWithStatement:statement
+	                                             collectionColumn:column_idx_collection
+	                                                    keyColumn:column_idx_key
+	                                                 objectColumn:column_idx_data
+	                                               metadataColumn:column_idx_metadata
+	                                                     mutation:mutation
+	                                                         stop:&stop
+	                                                     rowCount:&rowCount
+	                                                   usingBlock:block];
 	
 	sqlite3_clear_bindings(statement);
 	sqlite3_reset(statement);
 	
+	if (parentConnection->slowQueryLog)
+	{
+		[self recordQueryString:fullQueryString parameters:query.queryParameters rowCount:rowCount startTime:startTime];
+	}
+	
 	if (!stop && mutation.isMutated)
 	{
 		@throw [self mutationDuringEnumerationException];
@@ -1231,16 +2412,17 @@ static NSString *const ext_key_version_deprecated = @"version";
 - (BOOL)enumerateKeysMatchingQuery:(YapDatabaseQuery *)query
                         usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block
 {
-	BOOL result = [self _enumerateRowidsMatchingQuery:query usingBlock:^(int64_t rowid, BOOL *stop) {
-		
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:NO
+	                                       metadata:NO
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
 		if (block == NULL) // Query test : caller still wants BOOL result
 		{
 			*stop = YES;
 			return; // from block
 		}
 		
-		YapCollectionKey *ck = [self->databaseTransaction collectionKeyForRowid:rowid];
-		
 		block(ck.collection, ck.key, stop);
 	}];
 	
@@ -1251,18 +2433,17 @@ static NSString *const ext_key_version_deprecated = @"version";
                                    usingBlock:
                             (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id metadata, BOOL *stop))block
 {
-	BOOL result = [self _enumerateRowidsMatchingQuery:query usingBlock:^(int64_t rowid, BOOL *stop) {
-		
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:NO
+	                                       metadata:(block != NULL)
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
 		if (block == NULL) // Query test : caller still wants BOOL result
 		{
 			*stop = YES;
 			return; // from block
 		}
 		
-		YapCollectionKey *ck = nil;
-		id metadata = nil;
-		[self->databaseTransaction getCollectionKey:&ck metadata:&metadata forRowid:rowid];
-		
 		block(ck.collection, ck.key, metadata, stop);
 	}];
 	
@@ -1273,18 +2454,17 @@ static NSString *const ext_key_version_deprecated = @"version";
                                   usingBlock:
                             (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, BOOL *stop))block
 {
-	BOOL result = [self _enumerateRowidsMatchingQuery:query usingBlock:^(int64_t rowid, BOOL *stop) {
-		
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:(block != NULL)
+	                                       metadata:NO
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
 		if (block == NULL) // Query test : caller still wants BOOL result
 		{
 			*stop = YES;
 			return; // from block
 		}
 		
-		YapCollectionKey *ck = nil;
-		id object = nil;
-		[self->databaseTransaction getCollectionKey:&ck object:&object forRowid:rowid];
-		
 		block(ck.collection, ck.key, object, stop);
 	}];
 	
@@ -1295,19 +2475,17 @@ static NSString *const ext_key_version_deprecated = @"version";
                         usingBlock:
                             (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, id metadata, BOOL *stop))block
 {
-	BOOL result = [self _enumerateRowidsMatchingQuery:query usingBlock:^(int64_t rowid, BOOL *stop) {
-		
+	BOOL result = [self _enumerateRowsMatchingQuery:query
+	                                    withObjects:(block != NULL)
+	                                       metadata:(block != NULL)
+	                                     usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
 		if (block == NULL) // Query test : caller still wants BOOL result
 		{
 			*stop = YES;
 			return; // from block
 		}
 		
-		YapCollectionKey *ck = nil;
-		id object = nil;
-		id metadata = nil;
-		[self->databaseTransaction getCollectionKey:&ck object:&object metadata:&metadata forRowid:rowid];
-		
 		block(ck.collection, ck.key, object, metadata, stop);
 	}];
 	
@@ -1328,6 +2506,8 @@ static NSString *const ext_key_version_deprecated = @"version";
 	  [NSString stringWithFormat:@"SELECT \"%@\" AS IndexedValue FROM \"%@\" %@;",
 	  column, [self tableName], query.queryString];
 
+	CFAbsoluteTime startTime = parentConnection->slowQueryLog ? CFAbsoluteTimeGetCurrent() : 0.0;
+
 	// Turn query into compiled sqlite statement (using cache if possible)
 
 	sqlite3_stmt *statement = [self prepareQueryString:fullQueryString];
@@ -1338,10 +2518,12 @@ static NSString *const ext_key_version_deprecated = @"version";
 
 	// Bind query parameters appropriately.
 
-	[self bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
+	[databaseTransaction bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
 
 	// Enumerate query results
 
+	NSUInteger rowCount = 0;
+
 	BOOL stop = NO;
 	YapMutationStackItem_Bool *mutation = [parentConnection->mutationStack push]; // mutation during enum protection
 
@@ -1383,6 +2565,7 @@ static NSString *const ext_key_version_deprecated = @"version";
 			}
 		}
 		
+		rowCount++;
 		block(indexedValue, &stop);
 
 		if (stop || mutation.isMutated) break;
@@ -1397,6 +2580,11 @@ static NSString *const ext_key_version_deprecated = @"version";
 	sqlite3_clear_bindings(statement);
 	sqlite3_reset(statement);
 
+	if (parentConnection->slowQueryLog)
+	{
+		[self recordQueryString:fullQueryString parameters:query.queryParameters rowCount:rowCount startTime:startTime];
+	}
+
 	if (!stop && mutation.isMutated)
 	{
 		@throw [self mutationDuringEnumerationException];
@@ -1437,6 +2625,8 @@ static NSString *const ext_key_version_deprecated = @"version";
 	    [NSString stringWithFormat:@"SELECT COUNT(*) AS NumberOfRows FROM \"%@\" %@;",
 	                                                           [self tableName], query.queryString];
 	
+	CFAbsoluteTime startTime = parentConnection->slowQueryLog ? CFAbsoluteTimeGetCurrent() : 0.0;
+	
 	// Turn query into compiled sqlite statement (using cache if possible)
 	
 	sqlite3_stmt *statement = [self prepareQueryString:fullQueryString];
@@ -1447,7 +2637,7 @@ static NSString *const ext_key_version_deprecated = @"version";
 	
 	// Bind query parameters appropriately
 	
-	[self bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
+	[databaseTransaction bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
 	
 	// Execute query
 	
@@ -1469,6 +2659,11 @@ static NSString *const ext_key_version_deprecated = @"version";
 	sqlite3_clear_bindings(statement);
 	sqlite3_reset(statement);
 	
+	if (parentConnection->slowQueryLog)
+	{
+		[self recordQueryString:fullQueryString parameters:query.queryParameters rowCount:(result ? 1 : 0) startTime:startTime];
+	}
+	
 	if (countPtr) *countPtr = count;
 	return result;
 }
@@ -1477,6 +2672,45 @@ static NSString *const ext_key_version_deprecated = @"version";
 #pragma mark Aggregate Query
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Converts the value of the given column (of the current row) into its objective-c counterpart.
+**/
+- (id)objectForColumn:(int)column_idx ofStatement:(sqlite3_stmt *)statement
+{
+	int column_type = sqlite3_column_type(statement, column_idx);
+	
+	if (column_type == SQLITE_INTEGER)
+	{
+		int64_t num = sqlite3_column_int64(statement, column_idx);
+		return @(num);
+	}
+	else if (column_type == SQLITE_FLOAT)
+	{
+		double num = sqlite3_column_double(statement, column_idx);
+		return @(num);
+	}
+	else if (column_type == SQLITE_TEXT)
+	{
+		const unsigned char *text = sqlite3_column_text(statement, column_idx);
+		int textSize = sqlite3_column_bytes(statement, column_idx);
+		
+		return [[NSString alloc] initWithBytes:text length:textSize encoding:NSUTF8StringEncoding];
+	}
+	else if (column_type == SQLITE_BLOB)
+	{
+		const void *blob = sqlite3_column_blob(statement, column_idx);
+		int blobSize = sqlite3_column_bytes(statement, column_idx);
+		
+		return [[NSData alloc] initWithBytes:blob length:blobSize];
+	}
+	else if (column_type == SQLITE_NULL)
+	{
+		return [NSNull null];
+	}
+	
+	return nil;
+}
+
 - (id)performAggregateQuery:(YapDatabaseQuery *)query
 {
 	if (query == nil) return nil;
@@ -1486,6 +2720,8 @@ static NSString *const ext_key_version_deprecated = @"version";
 	    [NSString stringWithFormat:@"SELECT %@ AS Result FROM \"%@\" %@;",
 	                                        query.aggregateFunction, [self tableName], query.queryString];
 	
+	CFAbsoluteTime startTime = parentConnection->slowQueryLog ? CFAbsoluteTimeGetCurrent() : 0.0;
+	
 	// Turn query into compiled sqlite statement (using cache if possible)
 	
 	sqlite3_stmt *statement = [self prepareQueryString:fullQueryString];
@@ -1496,7 +2732,7 @@ static NSString *const ext_key_version_deprecated = @"version";
 	
 	// Bind query parameters appropriately
 	
-	[self bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
+	[databaseTransaction bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
 	
 	// Execute query
 	
@@ -1505,41 +2741,134 @@ static NSString *const ext_key_version_deprecated = @"version";
 	int status = sqlite3_step(statement);
 	if (status == SQLITE_ROW)
 	{
-		int column_idx = SQLITE_COLUMN_START;
-		int column_type = sqlite3_column_type(statement, column_idx);
-		
-		if (column_type == SQLITE_INTEGER)
+		result = [self objectForColumn:SQLITE_COLUMN_START ofStatement:statement];
+	}
+	else if (status == SQLITE_ERROR)
+	{
+		YDBLogError(@"sqlite_step error: %d %s",
+		            status, sqlite3_errmsg(databaseTransaction->connection->db));
+	}
+	
+	sqlite3_clear_bindings(statement);
+	sqlite3_reset(statement);
+	
+	if (parentConnection->slowQueryLog)
+	{
+		[self recordQueryString:fullQueryString parameters:query.queryParameters rowCount:(status == SQLITE_ROW ? 1 : 0) startTime:startTime];
+	}
+	
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Materialized Aggregates
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (YapDatabaseSecondaryIndexAggregate *)aggregateWithName:(NSString *)name
+{
+	for (YapDatabaseSecondaryIndexAggregate *aggregate in parentConnection->parent->aggregates)
+	{
+		if ([aggregate.name isEqualToString:name])
+		{
+			return aggregate;
+		}
+	}
+	
+	YDBLogWarn(@"No secondary index aggregate with name: %@", name);
+	return nil;
+}
+
+/**
+ * Calculates the value of the aggregate from its stored state.
+ * The given column index is for the "rows" column, which is followed by "count", "sum", "min" & "max".
+**/
+- (id)valueForAggregate:(YapDatabaseSecondaryIndexAggregate *)aggregate
+          withStatement:(sqlite3_stmt *)statement
+       startingAtColumn:(int)column_idx
+{
+	int const column_idx_rows  = column_idx;
+	int const column_idx_count = column_idx + 1;
+	int const column_idx_sum   = column_idx + 2;
+	int const column_idx_min   = column_idx + 3;
+	int const column_idx_max   = column_idx + 4;
+	
+	switch (aggregate.function)
+	{
+		case YapDatabaseSecondaryIndexAggregateFunctionCount :
 		{
-			int64_t num = sqlite3_column_int64(statement, column_idx);
-			result = @(num);
+			// COUNT(*) counts the rows, COUNT(column) counts the non-NULL values
+			
+			int64_t count = sqlite3_column_int64(statement, (aggregate.column ? column_idx_count : column_idx_rows));
+			return @(count);
 		}
-		else if (column_type == SQLITE_FLOAT)
+		case YapDatabaseSecondaryIndexAggregateFunctionSum :
 		{
-			double num = sqlite3_column_double(statement, column_idx);
-			result = @(num);
+			return [self objectForColumn:column_idx_sum ofStatement:statement];
 		}
-		else if (column_type == SQLITE_TEXT)
+		case YapDatabaseSecondaryIndexAggregateFunctionAvg :
 		{
-			const unsigned char *text = sqlite3_column_text(statement, column_idx);
-			int textSize = sqlite3_column_bytes(statement, column_idx);
+			int64_t count = sqlite3_column_int64(statement, column_idx_count);
+			if (count == 0) return [NSNull null];
 			
-			result = [[NSString alloc] initWithBytes:text length:textSize encoding:NSUTF8StringEncoding];
+			double sum = sqlite3_column_double(statement, column_idx_sum);
+			return @(sum / (double)count);
 		}
-		else if (column_type == SQLITE_BLOB)
+		case YapDatabaseSecondaryIndexAggregateFunctionMin :
 		{
-			const void *blob = sqlite3_column_blob(statement, column_idx);
-			int blobSize = sqlite3_column_bytes(statement, column_idx);
-			
-			result = [[NSData alloc] initWithBytes:blob length:blobSize];
+			return [self objectForColumn:column_idx_min ofStatement:statement];
 		}
-		else if (column_type == SQLITE_NULL)
+		case YapDatabaseSecondaryIndexAggregateFunctionMax :
 		{
-			result = [NSNull null];
+			return [self objectForColumn:column_idx_max ofStatement:statement];
 		}
 	}
-	else if (status == SQLITE_ERROR)
+	
+	return nil;
+}
+
+- (id)valueForAggregate:(NSString *)name
+{
+	return [self valueForAggregate:name inGroup:nil];
+}
+
+- (id)valueForAggregate:(NSString *)name inGroup:(id)group
+{
+	YapDatabaseSecondaryIndexAggregate *aggregate = [self aggregateWithName:name];
+	if (aggregate == nil) return nil;
+	
+	sqlite3_stmt *statement = [parentConnection aggregateValueStatement];
+	if (statement == NULL) return nil;
+	
+	// SELECT "rows", "count", "sum", "min", "max" FROM "aggregatesTableName" WHERE "name" = ? AND "group" IS ?;
+	
+	sqlite3_bind_text(statement, SQLITE_BIND_START, [name UTF8String], -1, SQLITE_TRANSIENT);
+	
+	if (group == nil || group == [NSNull null])
+		sqlite3_bind_null(statement, SQLITE_BIND_START + 1);
+	else if ([group isKindOfClass:[NSData class]])
+		sqlite3_bind_blob(statement, SQLITE_BIND_START + 1, [group bytes], (int)[group length], SQLITE_TRANSIENT);
+	else
+		[databaseTransaction bindQueryParameters:@[ group ] forStatement:statement withOffset:(SQLITE_BIND_START + 1)];
+	
+	id result = nil;
+	
+	int status = sqlite3_step(statement);
+	if (status == SQLITE_ROW)
 	{
-		YDBLogError(@"sqlite_step error: %d %s",
+		result = [self valueForAggregate:aggregate withStatement:statement startingAtColumn:SQLITE_COLUMN_START];
+	}
+	else if (status == SQLITE_DONE)
+	{
+		// No matching rows in the group
+		
+		if (aggregate.function == YapDatabaseSecondaryIndexAggregateFunctionCount)
+			result = @(0);
+		else
+			result = [NSNull null];
+	}
+	else
+	{
+		YDBLogError(@"Error executing 'aggregateValueStatement': %d %s",
 		            status, sqlite3_errmsg(databaseTransaction->connection->db));
 	}
 	
@@ -1549,6 +2878,50 @@ static NSString *const ext_key_version_deprecated = @"version";
 	return result;
 }
 
+- (void)enumerateGroupsForAggregate:(NSString *)name
+                         usingBlock:(void (NS_NOESCAPE^)(id group, id value, BOOL *stop))block
+{
+	if (block == NULL) return;
+	
+	YapDatabaseSecondaryIndexAggregate *aggregate = [self aggregateWithName:name];
+	if (aggregate == nil) return;
+	
+	sqlite3_stmt *statement = [parentConnection aggregateGroupsStatement];
+	if (statement == NULL) return;
+	
+	// SELECT "group", "rows", "count", "sum", "min", "max" FROM "aggregatesTableName" WHERE "name" = ?;
+	
+	sqlite3_bind_text(statement, SQLITE_BIND_START, [name UTF8String], -1, SQLITE_TRANSIENT);
+	
+	BOOL stop = NO;
+	YapMutationStackItem_Bool *mutation = [parentConnection->mutationStack push]; // mutation during enum protection
+	
+	int status;
+	while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+	{
+		id group = [self objectForColumn:SQLITE_COLUMN_START ofStatement:statement];
+		id value = [self valueForAggregate:aggregate withStatement:statement startingAtColumn:(SQLITE_COLUMN_START + 1)];
+		
+		block(group, value, &stop);
+		
+		if (stop || mutation.isMutated) break;
+	}
+	
+	if ((status != SQLITE_DONE) && !stop && !mutation.isMutated)
+	{
+		YDBLogError(@"sqlite_step error: %d %s",
+		            status, sqlite3_errmsg(databaseTransaction->connection->db));
+	}
+	
+	sqlite3_clear_bindings(statement);
+	sqlite3_reset(statement);
+	
+	if (!stop && mutation.isMutated)
+	{
+		@throw [self mutationDuringEnumerationException];
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Query Utilities
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1585,6 +2958,86 @@ static NSString *const ext_key_version_deprecated = @"version";
 	return results;
 }
 
+/**
+ * Returns the output of EXPLAIN QUERY PLAN for the given query (one line per step of the plan).
+ * This is the statement that would be executed by the enumerate methods
+ * (or by performAggregateQuery:, if the query is an aggregate query).
+ *
+ * For example:
+ * "CO-ROUTINE matches
+ *  SEARCH secondaryIndex_idx USING COVERING INDEX secondaryIndex_idx_feed (tenant=? AND status=?)
+ *  SCAN matches
+ *  SEARCH database2 USING INTEGER PRIMARY KEY (rowid=?)"
+ *
+ * For more information, see the sqlite docs: https://www.sqlite.org/eqp.html
+**/
+- (NSString *)queryPlanForQuery:(YapDatabaseQuery *)query
+{
+	if (query == nil) return nil;
+	
+	NSString *fullQueryString = nil;
+	if (query.isAggregateQuery)
+	{
+		fullQueryString = [NSString stringWithFormat:@"EXPLAIN QUERY PLAN SELECT %@ AS Result FROM \"%@\" %@;",
+		                                             query.aggregateFunction, [self tableName], query.queryString];
+	}
+	else
+	{
+		fullQueryString = [@"EXPLAIN QUERY PLAN "
+		  stringByAppendingString:[self enumerateQueryStringForQuery:query withObjects:YES metadata:YES]];
+	}
+	
+	sqlite3 *db = databaseTransaction->connection->db;
+	sqlite3_stmt *statement = NULL;
+	
+	int status = sqlite3_prepare_v2(db, [fullQueryString UTF8String], -1, &statement, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Error creating query:\n query: '%@'\n error: %d %s",
+		            fullQueryString, status, sqlite3_errmsg(db));
+		return nil;
+	}
+	
+	[databaseTransaction bindQueryParameters:query.queryParameters forStatement:statement withOffset:SQLITE_BIND_START];
+	
+	// id|parent|notused|detail
+	// 0 |1     |2      |3
+	
+	int const column_idx_detail = SQLITE_COLUMN_START + 3;
+	
+	NSMutableArray<NSString *> *lines = [NSMutableArray array];
+	
+	while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+	{
+		const unsigned char *text = sqlite3_column_text(statement, column_idx_detail);
+		int textSize = sqlite3_column_bytes(statement, column_idx_detail);
+		
+		NSString *detail = [[NSString alloc] initWithBytes:text length:textSize encoding:NSUTF8StringEncoding];
+		if (detail) {
+			[lines addObject:detail];
+		}
+	}
+	
+	if (status != SQLITE_DONE)
+	{
+		YDBLogError(@"sqlite_step error: %d %s", status, sqlite3_errmsg(db));
+	}
+	
+	sqlite3_finalize(statement);
+	return [lines componentsJoinedByString:@"\n"];
+}
+
+/**
+ * Optional override method from YapDatabaseExtensionTransaction.
+ * Used by the combined query methods of YapDatabaseReadTransaction.
+**/
+- (NSString *)rowidQueryStringForQuery:(YapDatabaseQuery *)query
+{
+	if (query.isAggregateQuery) return nil;
+	
+	return [NSString stringWithFormat:@"SELECT \"rowid\" FROM \"%@\" %@", [self tableName], query.queryString];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Exceptions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -6,12 +6,15 @@ NS_ASSUME_NONNULL_BEGIN
 @interface YapDatabaseViewLocator : NSObject
 
 - (instancetype)initWithGroup:(NSString *)group index:(NSUInteger)index;
-- (instancetype)initWithGroup:(NSString *)group index:(NSUInteger)index pageKey:(nullable NSString *)pageKey;
+- (instancetype)initWithGroup:(NSString *)group index:(NSUInteger)index pageId:(int64_t)pageId;
 
 @property (nonatomic, readonly, copy) NSString *group;
 @property (nonatomic, readonly, assign) NSUInteger index;
 
-@property (nonatomic, readonly, copy, nullable) NSString *pageKey;
+/**
+ * The page the item is in, or zero if unknown.
+ */
+@property (nonatomic, readonly, assign) int64_t pageId;
 
 @end
 
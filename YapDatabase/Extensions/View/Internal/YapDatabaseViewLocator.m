@@ -5,20 +5,20 @@
 
 @synthesize group = group;
 @synthesize index = index;
-@synthesize pageKey = pageKey;
+@synthesize pageId = pageId;
 
 - (instancetype)initWithGroup:(NSString *)inGroup index:(NSUInteger)inIndex
 {
-	return [self initWithGroup:inGroup index:inIndex pageKey:nil];
+	return [self initWithGroup:inGroup index:inIndex pageId:0];
 }
 
-- (instancetype)initWithGroup:(NSString *)inGroup index:(NSUInteger)inIndex pageKey:(NSString *)inPageKey
+- (instancetype)initWithGroup:(NSString *)inGroup index:(NSUInteger)inIndex pageId:(int64_t)inPageId
 {
 	if ((self = [super init]))
 	{
 		group = [inGroup copy];
 		index = inIndex;
-		pageKey = [inPageKey copy];
+		pageId = inPageId;
 	}
 	return self;
 }
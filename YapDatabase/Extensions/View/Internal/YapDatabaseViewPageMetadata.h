@@ -7,7 +7,7 @@
  * The metadata does the following:
  * 
  * - stores the associated group
- * - keeps the pages ordered (via prevPageKey).
+ * - keeps the pages ordered (via prevPageId).
  * - keeps the count on hand to make it easier to find a particular index
  * 
  * This class is designed only to store the metadata in RAM.
@@ -16,8 +16,8 @@
 @interface YapDatabaseViewPageMetadata : NSObject <NSCopying> {
 @public
 	
-	NSString * pageKey;
-	NSString * prevPageKey;
+	int64_t    pageId;
+	int64_t    prevPageId; // Zero if this is the first page in the group
 	NSString * group;
 	NSUInteger count;
 	
@@ -7,8 +7,8 @@
 {
 	YapDatabaseViewPageMetadata *copy = [[YapDatabaseViewPageMetadata alloc] init];
 	
-	copy->pageKey = pageKey;
-	copy->prevPageKey = prevPageKey;
+	copy->pageId = pageId;
+	copy->prevPageId = prevPageId;
 	copy->group = group;
 	copy->count = count;
 	
@@ -21,8 +21,8 @@
 - (NSString *)description
 {
 	return [NSString stringWithFormat:
-	    @"<YapDatabaseViewPageMetadata[%p]: group(%@) count(%lu) pageKey(%@) prevPageKey(%@)>",
-	    self, group, (unsigned long)count, pageKey, prevPageKey];
+	    @"<YapDatabaseViewPageMetadata[%p]: group(%@) count(%lu) pageId(%lld) prevPageId(%lld)>",
+	    self, group, (unsigned long)count, pageId, prevPageId];
 }
 
 @end
@@ -24,7 +24,7 @@
  * If there is a major re-write to this class, then the version number will be incremented,
  * and the class can automatically rebuild the tables as needed.
  */
-#define YAP_DATABASE_VIEW_CLASS_VERSION 3
+#define YAP_DATABASE_VIEW_CLASS_VERSION 4
 
 /**
  * The view is tasked with storing ordered arrays of rowids.
@@ -128,17 +128,19 @@ static NSString *const changeset_key_versionTag = @"versionTag";
 
 - (void)prepareStatement:(sqlite3_stmt **)statement withString:(NSString *)stmtString caller:(SEL)caller_cmd;
 
-- (sqlite3_stmt *)mapTable_getPageKeyForRowidStatement;
-- (sqlite3_stmt *)mapTable_setPageKeyForRowidStatement;
+- (sqlite3_stmt *)mapTable_getPageIdForRowidStatement;
+- (sqlite3_stmt *)mapTable_setPageIdForRowidStatement;
 - (sqlite3_stmt *)mapTable_removeForRowidStatement;
 - (sqlite3_stmt *)mapTable_removeAllStatement;
 
-- (sqlite3_stmt *)pageTable_getDataForPageKeyStatement;
-- (sqlite3_stmt *)pageTable_insertForPageKeyStatement;
-- (sqlite3_stmt *)pageTable_updateAllForPageKeyStatement;
-- (sqlite3_stmt *)pageTable_updatePageForPageKeyStatement;
-- (sqlite3_stmt *)pageTable_updateLinkForPageKeyStatement;
-- (sqlite3_stmt *)pageTable_removeForPageKeyStatement;
+- (sqlite3_stmt *)pageTable_getDataForPageIdStatement;
+- (sqlite3_stmt *)pageTable_getGroupForPageIdStatement;
+- (sqlite3_stmt *)pageTable_getMetadataForGroupStatement;
+- (sqlite3_stmt *)pageTable_insertForPageIdStatement;
+- (sqlite3_stmt *)pageTable_updateAllForPageIdStatement;
+- (sqlite3_stmt *)pageTable_updatePageForPageIdStatement;
+- (sqlite3_stmt *)pageTable_updateLinkForPageIdStatement;
+- (sqlite3_stmt *)pageTable_removeForPageIdStatement;
 - (sqlite3_stmt *)pageTable_removeAllStatement;
 
 @end
@@ -187,6 +189,14 @@ static NSString *const changeset_key_versionTag = @"versionTag";
                          range:(NSRange)range
                     usingBlock:(void (NS_NOESCAPE^)(int64_t rowid, NSUInteger index, BOOL *stop))block;
 
+- (void)enumerateRowsInGroup:(NSString *)group
+                 withOptions:(NSEnumerationOptions)inOptions
+                       range:(NSRange)range
+                 withObjects:(BOOL)withObjects
+                    metadata:(BOOL)withMetadata
+                  usingBlock:
+            (void (NS_NOESCAPE^)(YapCollectionKey *ck, id object, id metadata, NSUInteger index, BOOL *stop))block;
+
 // Logic - ReadOnly
 
 - (BOOL)containsRowid:(int64_t)rowid;
@@ -8,16 +8,53 @@
 
 #pragma mark Access
 
+/**
+ * Returns nil if the group doesn't exist, or if its pagesMetadata haven't been loaded yet.
+ * Use needsLoadForGroup: to distinguish between the two.
+ */
 - (NSArray *)pagesMetadataForGroup:(NSString *)group;
-- (NSString *)groupForPageKey:(NSString *)pageKey;
+- (NSString *)groupForPageId:(int64_t)pageId;
+
+/**
+ * Returns YES if the group exists in the database, but its pagesMetadata haven't been loaded yet.
+ */
+- (BOOL)needsLoadForGroup:(NSString *)group;
 
 - (NSUInteger)numberOfGroups;
+- (NSUInteger)numberOfItemsInGroup:(NSString *)group;
 
 - (void)enumerateGroupsWithBlock:(void (NS_NOESCAPE^)(NSString *group, BOOL *stop))block;
-- (void)enumerateWithBlock:(void (NS_NOESCAPE^)(NSString *group, NSArray *pagesMetadataForGroup, BOOL *stop))block;
+- (void)enumerateGroupCountsWithBlock:(void (NS_NOESCAPE^)(NSString *group, NSUInteger count, BOOL *stop))block;
+
+#pragma mark Lazy Loading
+
+/**
+ * Registers a group that exists in the database, without loading its pagesMetadata.
+ * Only the name of the group & the total number of items within it are tracked until the group is loaded.
+ */
+- (void)addUnloadedGroup:(NSString *)group withCount:(NSUInteger)count;
+
+/**
+ * Informs the state that pageIds up to (and including) the given value are already in use.
+ */
+- (void)reservePageIdsUpTo:(int64_t)pageId;
+
+/**
+ * Stores the properly ordered pagesMetadata for a group that was previously registered as unloaded.
+ *
+ * This is a cache fill, and is thus permitted on immutable state (which may be shared between connections).
+ * If another thread loaded the group first, the existing pagesMetadata are returned instead.
+ */
+- (NSArray *)didLoadPagesMetadata:(NSArray *)pagesMetadata forGroup:(NSString *)group;
 
 #pragma mark Mutation
 
+/**
+ * Returns a new pageId, unique amongst all pages in the view.
+ * PageIds are never zero (which is used to signify "no page").
+ */
+- (int64_t)generatePageId;
+
 - (NSArray *)createGroup:(NSString *)group;
 - (NSArray *)createGroup:(NSString *)group withCapacity:(NSUInteger)capacity;
 
@@ -1,14 +1,27 @@
 #import "YapDatabaseViewState.h"
+#import "YapDatabaseAtomic.h"
 
 #define AssertIsMutable() NSAssert(!isImmutable, @"Attempting to mutate immutable state")
 
 @implementation YapDatabaseViewState
 {
 	NSMutableDictionary<NSString *, NSMutableArray<YapDatabaseViewPageMetadata *> *> *group_pagesMetadata_dict;
-	NSMutableDictionary<NSString *, NSString *> *pageKey_group_dict;
+	NSMutableDictionary<NSString *, NSNumber *> *unloadedGroup_count_dict;
+	NSMutableDictionary<NSNumber *, NSString *> *pageId_group_dict;
 	
-	// - group_pagesMetadata_dict : group -> @[ YapDatabaseViewPageMetadata, ... ]
-	// - pageKey_group_dict       : pageKey -> group
+	int64_t maxPageId;
+	
+	// - group_pagesMetadata_dict : group -> @[ YapDatabaseViewPageMetadata, ... ]   (loaded groups)
+	// - unloadedGroup_count_dict : group -> number of items in group                (groups not yet loaded)
+	// - pageId_group_dict        : pageId -> group                                  (loaded groups only)
+	// - maxPageId                : largest pageId ever handed out (or loaded) by this state
+	//
+	// A group is either loaded or unloaded, never both.
+	//
+	// Immutable state may be shared between multiple connections (on different threads),
+	// and unloaded groups may be loaded at any time. So all access to the dictionaries goes through the lock.
+	
+	YAPUnfairLock lock;
 }
 
 @synthesize isImmutable = isImmutable;
@@ -20,14 +33,21 @@
 		isImmutable = NO;
 		
 		group_pagesMetadata_dict = [[NSMutableDictionary alloc] init];
-		pageKey_group_dict = [[NSMutableDictionary alloc] init];
+		unloadedGroup_count_dict = [[NSMutableDictionary alloc] init];
+		pageId_group_dict = [[NSMutableDictionary alloc] init];
+		maxPageId = 0;
+		
+		lock = YAP_UNFAIR_LOCK_INIT;
 	}
 	return self;
 }
 
 - (id)initForCopy
 {
-	if ((self = [super init])) { }
+	if ((self = [super init]))
+	{
+		lock = YAP_UNFAIR_LOCK_INIT;
+	}
 	return self;
 }
 
@@ -53,6 +73,23 @@
 	return deepCopy;
 }
 
+- (YapDatabaseViewState *)copyAsImmutable:(BOOL)immutable
+{
+	YapDatabaseViewState *copy = [[YapDatabaseViewState alloc] initForCopy];
+	copy->isImmutable = immutable;
+	
+	YAPUnfairLockLock(&lock);
+	{
+		copy->group_pagesMetadata_dict = [self group_pagesMetadata_dict_deepCopy];
+		copy->unloadedGroup_count_dict = [unloadedGroup_count_dict mutableCopy];
+		copy->pageId_group_dict = [pageId_group_dict mutableCopy];
+		copy->maxPageId = maxPageId;
+	}
+	YAPUnfairLockUnlock(&lock);
+	
+	return copy;
+}
+
 - (id)copyWithZone:(NSZone __unused *)zone
 {
 	if (isImmutable)
@@ -61,23 +98,13 @@
 	}
 	else
 	{
-		YapDatabaseViewState *copy = [[YapDatabaseViewState alloc] initForCopy];
-		copy->isImmutable = YES;
-		copy->group_pagesMetadata_dict = [self group_pagesMetadata_dict_deepCopy];
-		copy->pageKey_group_dict = [pageKey_group_dict mutableCopy];
-		
-		return copy;
+		return [self copyAsImmutable:YES];
 	}
 }
 
 - (id)mutableCopyWithZone:(NSZone __unused *)zone
 {
-	YapDatabaseViewState *copy = [[YapDatabaseViewState alloc] initForCopy];
-	copy->isImmutable = NO;
-	copy->group_pagesMetadata_dict = [self group_pagesMetadata_dict_deepCopy];
-	copy->pageKey_group_dict = [pageKey_group_dict mutableCopy];
-	
-	return copy;
+	return [self copyAsImmutable:NO];
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -86,23 +113,98 @@
 
 - (NSArray *)pagesMetadataForGroup:(NSString *)group
 {
-	return [group_pagesMetadata_dict objectForKey:group];
+	NSArray *pagesMetadataForGroup = nil;
+	
+	YAPUnfairLockLock(&lock);
+	{
+		pagesMetadataForGroup = [group_pagesMetadata_dict objectForKey:group];
+	}
+	YAPUnfairLockUnlock(&lock);
+	
+	return pagesMetadataForGroup;
+}
+
+- (NSString *)groupForPageId:(int64_t)pageId
+{
+	NSString *group = nil;
+	
+	YAPUnfairLockLock(&lock);
+	{
+		group = [pageId_group_dict objectForKey:@(pageId)];
+	}
+	YAPUnfairLockUnlock(&lock);
+	
+	return group;
 }
 
-- (NSString *)groupForPageKey:(NSString *)pageKey
+- (BOOL)needsLoadForGroup:(NSString *)group
 {
-	return [pageKey_group_dict objectForKey:pageKey];
+	BOOL needsLoad = NO;
+	
+	YAPUnfairLockLock(&lock);
+	{
+		needsLoad = ([unloadedGroup_count_dict objectForKey:group] != nil);
+	}
+	YAPUnfairLockUnlock(&lock);
+	
+	return needsLoad;
 }
 
 - (NSUInteger)numberOfGroups
 {
-	return [group_pagesMetadata_dict count];
+	NSUInteger count = 0;
+	
+	YAPUnfairLockLock(&lock);
+	{
+		count = [group_pagesMetadata_dict count] + [unloadedGroup_count_dict count];
+	}
+	YAPUnfairLockUnlock(&lock);
+	
+	return count;
+}
+
+- (NSUInteger)numberOfItemsInGroup:(NSString *)group
+{
+	NSUInteger count = 0;
+	
+	YAPUnfairLockLock(&lock);
+	{
+		NSArray *pagesMetadataForGroup = [group_pagesMetadata_dict objectForKey:group];
+		if (pagesMetadataForGroup)
+		{
+			for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
+			{
+				count += pageMetadata->count;
+			}
+		}
+		else
+		{
+			count = [[unloadedGroup_count_dict objectForKey:group] unsignedIntegerValue];
+		}
+	}
+	YAPUnfairLockUnlock(&lock);
+	
+	return count;
 }
 
 - (void)enumerateGroupsWithBlock:(void (NS_NOESCAPE^)(NSString *group, BOOL *stop))block
 {
+	// The block may trigger a lazy load of a group, which requires the lock.
+	// So we take a snapshot of the group names, and invoke the block outside the lock.
+	
+	NSMutableArray<NSString *> *groups = nil;
+	
+	YAPUnfairLockLock(&lock);
+	{
+		groups = [NSMutableArray arrayWithCapacity:([group_pagesMetadata_dict count] + [unloadedGroup_count_dict count])];
+		
+		[groups addObjectsFromArray:[group_pagesMetadata_dict allKeys]];
+		[groups addObjectsFromArray:[unloadedGroup_count_dict allKeys]];
+	}
+	YAPUnfairLockUnlock(&lock);
+	
 	BOOL stop = NO;
-	for (NSString *group in group_pagesMetadata_dict)
+	for (NSString *group in groups)
 	{
 		block(group, &stop);
 		
@@ -110,15 +212,104 @@
 	}
 }
 
-- (void)enumerateWithBlock:(void (NS_NOESCAPE^)(NSString *group, NSArray *pagesMetadataForGroup, BOOL *stop))block
+- (void)enumerateGroupCountsWithBlock:(void (NS_NOESCAPE^)(NSString *group, NSUInteger count, BOOL *stop))block
+{
+	NSMutableDictionary<NSString *, NSNumber *> *group_count_dict = nil;
+	
+	YAPUnfairLockLock(&lock);
+	{
+		group_count_dict = [unloadedGroup_count_dict mutableCopy];
+		
+		[group_pagesMetadata_dict enumerateKeysAndObjectsUsingBlock:
+		    ^(NSString *group, NSMutableArray *pagesMetadata, BOOL __unused *stop)
+		{
+			NSUInteger count = 0;
+			for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadata)
+			{
+				count += pageMetadata->count;
+			}
+			
+			group_count_dict[group] = @(count);
+		}];
+	}
+	YAPUnfairLockUnlock(&lock);
+	
+	[group_count_dict enumerateKeysAndObjectsUsingBlock:^(NSString *group, NSNumber *count, BOOL *stop) {
+		
+		block(group, [count unsignedIntegerValue], stop);
+	}];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Lazy Loading
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)addUnloadedGroup:(NSString *)group withCount:(NSUInteger)count
+{
+	AssertIsMutable();
+	
+	YAPUnfairLockLock(&lock);
+	{
+		if ([group_pagesMetadata_dict objectForKey:group] == nil)
+		{
+			[unloadedGroup_count_dict setObject:@(count) forKey:group];
+		}
+	}
+	YAPUnfairLockUnlock(&lock);
+}
+
+- (void)reservePageIdsUpTo:(int64_t)pageId
+{
+	AssertIsMutable();
+	
+	if (pageId > maxPageId)
+		maxPageId = pageId;
+}
+
+- (NSArray *)didLoadPagesMetadata:(NSArray *)pagesMetadata forGroup:(NSString *)group
 {
-	[group_pagesMetadata_dict enumerateKeysAndObjectsUsingBlock:block];
+	NSMutableArray *pagesMetadataForGroup = nil;
+	
+	YAPUnfairLockLock(&lock);
+	{
+		pagesMetadataForGroup = [group_pagesMetadata_dict objectForKey:group];
+		
+		if (pagesMetadataForGroup == nil && [unloadedGroup_count_dict objectForKey:group])
+		{
+			pagesMetadataForGroup = [pagesMetadata mutableCopy];
+			
+			for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
+			{
+				[pageId_group_dict setObject:group forKey:@(pageMetadata->pageId)];
+			}
+			
+			[group_pagesMetadata_dict setObject:pagesMetadataForGroup forKey:group];
+			[unloadedGroup_count_dict removeObjectForKey:group];
+		}
+	}
+	YAPUnfairLockUnlock(&lock);
+	
+	return pagesMetadataForGroup;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Mutation
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Mutable state is only ever used by a single connection (within a readwrite transaction).
+// So the mutation methods below don't need to go through the lock.
+
+- (int64_t)generatePageId
+{
+	AssertIsMutable();
+	
+	// PageIds are handed out in increasing order, and are never reused within the lifetime of the state.
+	// This guarantees a dropped page can't be confused with a newly created page in any connection's pageCache.
+	
+	maxPageId++;
+	return maxPageId;
+}
+
 - (NSArray *)createGroup:(NSString *)group
 {
 	return [self createGroup:group withCapacity:0];
@@ -127,6 +318,7 @@
 - (NSArray *)createGroup:(NSString *)group withCapacity:(NSUInteger)capacity
 {
 	AssertIsMutable();
+	NSAssert([unloadedGroup_count_dict objectForKey:group] == nil, @"Attempting to create unloaded group");
 	
 	NSMutableArray *pagesMetadataForGroup = [group_pagesMetadata_dict objectForKey:group];
 	if (pagesMetadataForGroup == nil)
@@ -148,7 +340,10 @@
 	AssertIsMutable();
 	NSParameterAssert(pageMetadata != nil);
 	
-	[pageKey_group_dict setObject:group forKey:pageMetadata->pageKey];
+	[pageId_group_dict setObject:group forKey:@(pageMetadata->pageId)];
+	
+	if (pageMetadata->pageId > maxPageId)
+		maxPageId = pageMetadata->pageId;
 	
 	NSMutableArray *pagesMetadataForGroup = [group_pagesMetadata_dict objectForKey:group];
 	[pagesMetadataForGroup addObject:pageMetadata];
@@ -163,7 +358,10 @@
 	AssertIsMutable();
 	NSParameterAssert(pageMetadata != nil);
 	
-	[pageKey_group_dict setObject:group forKey:pageMetadata->pageKey];
+	[pageId_group_dict setObject:group forKey:@(pageMetadata->pageId)];
+	
+	if (pageMetadata->pageId > maxPageId)
+		maxPageId = pageMetadata->pageId;
 	
 	NSMutableArray *pagesMetadataForGroup = [group_pagesMetadata_dict objectForKey:group];
 	[pagesMetadataForGroup insertObject:pageMetadata atIndex:index];
@@ -178,7 +376,7 @@
 	NSMutableArray *pagesMetadataForGroup = [group_pagesMetadata_dict objectForKey:group];
 	YapDatabaseViewPageMetadata *pageMetadata = [pagesMetadataForGroup objectAtIndex:index];
 	
-	[pageKey_group_dict removeObjectForKey:pageMetadata->pageKey];
+	[pageId_group_dict removeObjectForKey:@(pageMetadata->pageId)];
 	[pagesMetadataForGroup removeObjectAtIndex:index];
 	
 	return pagesMetadataForGroup;
@@ -202,7 +400,10 @@
 	AssertIsMutable();
 	
 	[group_pagesMetadata_dict removeAllObjects];
-	[pageKey_group_dict removeAllObjects];
+	[unloadedGroup_count_dict removeAllObjects];
+	[pageId_group_dict removeAllObjects];
+	
+	// Note: We intentionally do NOT reset maxPageId.
 }
 
 @end
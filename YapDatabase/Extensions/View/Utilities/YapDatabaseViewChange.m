@@ -22,6 +22,522 @@
 #endif
 #pragma unused(ydbLogLevel)
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Index Shifting
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Processing a changeset is mostly a matter of tracing row indexes through a list of inserts & deletes.
+ * Doing that pairwise (every change against every other change) is O(n^2),
+ * which gets very slow for transactions that touch tens of thousands of rows.
+ *
+ * Instead we model each group as a sequence of rows, stored in an implicit treap (ordered by position),
+ * and replay the inserts & deletes against it. Tracing an index is then a lookup in O(log n).
+ *
+ * The sequence is unbounded, so indexes beyond the end of the group behave exactly as they did before.
+ * Consecutive rows with consecutive values are stored as a single "run" node,
+ * so the initial state of a group (row N has value N) is a single node.
+**/
+
+typedef struct YDBChangeChain YDBChangeChain;
+typedef struct YDBIndexNode YDBIndexNode;
+
+struct YDBIndexNode {
+	YDBIndexNode *left;
+	YDBIndexNode *right;
+	uint32_t priority;
+	NSUInteger size;          // number of rows in this subtree
+	NSUInteger length;        // number of rows in this node
+	NSUInteger value;         // value of the first row in this node (subsequent rows are value+1, value+2, ...)
+	YDBChangeChain *markers;  // consolidation chains positioned on this row (only for nodes with length == 1)
+};
+
+#define YDB_INDEX_NODE_BLOCK_SIZE 512
+
+typedef struct YDBIndexNodeBlock {
+	struct YDBIndexNodeBlock *next;
+	NSUInteger count;
+	YDBIndexNode nodes[YDB_INDEX_NODE_BLOCK_SIZE];
+} YDBIndexNodeBlock;
+
+typedef struct {
+	YDBIndexNodeBlock *blocks;
+	uint32_t seed;
+} YDBIndexArena;
+
+static YDBIndexNode *YDBIndexNodeCreate(YDBIndexArena *arena, NSUInteger value, NSUInteger length)
+{
+	if (arena->blocks == NULL || arena->blocks->count == YDB_INDEX_NODE_BLOCK_SIZE)
+	{
+		YDBIndexNodeBlock *block = (YDBIndexNodeBlock *)malloc(sizeof(YDBIndexNodeBlock));
+		block->next = arena->blocks;
+		block->count = 0;
+		
+		arena->blocks = block;
+	}
+	
+	YDBIndexNode *node = &arena->blocks->nodes[arena->blocks->count++];
+	
+	// xorshift32
+	uint32_t x = arena->seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	arena->seed = x;
+	
+	node->left = NULL;
+	node->right = NULL;
+	node->priority = x;
+	node->size = length;
+	node->length = length;
+	node->value = value;
+	node->markers = NULL;
+	
+	return node;
+}
+
+static void YDBIndexArenaFree(YDBIndexArena *arena)
+{
+	YDBIndexNodeBlock *block = arena->blocks;
+	while (block)
+	{
+		YDBIndexNodeBlock *next = block->next;
+		free(block);
+		block = next;
+	}
+	
+	arena->blocks = NULL;
+}
+
+static inline NSUInteger YDBIndexNodeSize(YDBIndexNode *node)
+{
+	return node ? node->size : 0;
+}
+
+static inline void YDBIndexNodeUpdate(YDBIndexNode *node)
+{
+	node->size = YDBIndexNodeSize(node->left) + node->length + YDBIndexNodeSize(node->right);
+}
+
+/**
+ * Splits the tree such that the first `count` rows end up in `left`, and the remainder in `right`.
+ * If the split point falls within a run, the run is split into two nodes.
+**/
+static void YDBIndexSplit(YDBIndexArena *arena, YDBIndexNode *node, NSUInteger count,
+                          YDBIndexNode **left, YDBIndexNode **right)
+{
+	if (node == NULL)
+	{
+		*left = NULL;
+		*right = NULL;
+		return;
+	}
+	
+	NSUInteger leftSize = YDBIndexNodeSize(node->left);
+	
+	if (count <= leftSize)
+	{
+		YDBIndexSplit(arena, node->left, count, left, &node->left);
+		YDBIndexNodeUpdate(node);
+		*right = node;
+	}
+	else if (count >= (leftSize + node->length))
+	{
+		YDBIndexSplit(arena, node->right, (count - leftSize - node->length), &node->right, right);
+		YDBIndexNodeUpdate(node);
+		*left = node;
+	}
+	else
+	{
+		NSUInteger offset = count - leftSize;
+		
+		YDBIndexNode *tail = YDBIndexNodeCreate(arena, (node->value + offset), (node->length - offset));
+		tail->priority = node->priority; // keeps heap order with node->right
+		tail->right = node->right;
+		YDBIndexNodeUpdate(tail);
+		
+		node->length = offset;
+		node->right = NULL;
+		YDBIndexNodeUpdate(node);
+		
+		*left = node;
+		*right = tail;
+	}
+}
+
+static YDBIndexNode *YDBIndexMerge(YDBIndexNode *left, YDBIndexNode *right)
+{
+	if (left == NULL) return right;
+	if (right == NULL) return left;
+	
+	if (left->priority >= right->priority)
+	{
+		left->right = YDBIndexMerge(left->right, right);
+		YDBIndexNodeUpdate(left);
+		return left;
+	}
+	else
+	{
+		right->left = YDBIndexMerge(left, right->left);
+		YDBIndexNodeUpdate(right);
+		return right;
+	}
+}
+
+/**
+ * Returns the node containing the row at the given position, and the row's offset within that node.
+**/
+static YDBIndexNode *YDBIndexNodeAt(YDBIndexNode *node, NSUInteger position, NSUInteger *offsetPtr)
+{
+	while (node)
+	{
+		NSUInteger leftSize = YDBIndexNodeSize(node->left);
+		
+		if (position < leftSize)
+		{
+			node = node->left;
+		}
+		else if (position < (leftSize + node->length))
+		{
+			*offsetPtr = position - leftSize;
+			return node;
+		}
+		else
+		{
+			position -= (leftSize + node->length);
+			node = node->right;
+		}
+	}
+	
+	*offsetPtr = 0;
+	return NULL;
+}
+
+static NSUInteger YDBIndexValueAt(YDBIndexNode *root, NSUInteger position)
+{
+	NSUInteger offset = 0;
+	YDBIndexNode *node = YDBIndexNodeAt(root, position, &offset);
+	
+	return node ? (node->value + offset) : position;
+}
+
+/**
+ * Ensures the row at the given position is a node of its own (length == 1), and returns it.
+**/
+static YDBIndexNode *YDBIndexIsolate(YDBIndexArena *arena, YDBIndexNode **rootPtr, NSUInteger position)
+{
+	YDBIndexNode *a, *b, *row, *c;
+	
+	YDBIndexSplit(arena, *rootPtr, position, &a, &b);
+	YDBIndexSplit(arena, b, 1, &row, &c);
+	
+	*rootPtr = YDBIndexMerge(YDBIndexMerge(a, row), c);
+	return row;
+}
+
+static void YDBIndexInsert(YDBIndexArena *arena, YDBIndexNode **rootPtr, NSUInteger position, NSUInteger value)
+{
+	YDBIndexNode *a, *b;
+	YDBIndexSplit(arena, *rootPtr, position, &a, &b);
+	
+	YDBIndexNode *row = YDBIndexNodeCreate(arena, value, 1);
+	
+	*rootPtr = YDBIndexMerge(YDBIndexMerge(a, row), b);
+}
+
+/**
+ * Removes the row at the given position, and returns its (now detached) node.
+**/
+static YDBIndexNode *YDBIndexRemove(YDBIndexArena *arena, YDBIndexNode **rootPtr, NSUInteger position)
+{
+	YDBIndexNode *a, *b, *row, *c;
+	
+	YDBIndexSplit(arena, *rootPtr, position, &a, &b);
+	YDBIndexSplit(arena, b, 1, &row, &c);
+	
+	*rootPtr = YDBIndexMerge(a, c);
+	return row;
+}
+
+static YDBIndexNode **YDBIndexRootsCreate(YDBIndexArena *arena, NSUInteger groupCount)
+{
+	YDBIndexNode **roots = (YDBIndexNode **)malloc(sizeof(YDBIndexNode *) * (groupCount ?: 1));
+	
+	for (NSUInteger g = 0; g < groupCount; g++)
+	{
+		roots[g] = YDBIndexNodeCreate(arena, 0, (NSUIntegerMax / 4));
+	}
+	
+	return roots;
+}
+
+/**
+ * A single step to replay against the per-group sequences.
+ *
+ * First, if queryGroup is valid, the given index is traced (result = value of the row at queryIndex).
+ * Then, the shift (if any) is applied to the sequence.
+ *
+ * The value of an inserted row is the value of the row it was inserted in front of.
+ * This matches the pairwise algorithm, which leaves an index equal to the insertion point unchanged.
+**/
+typedef enum {
+	YDBIndexShiftNone = 0,
+	YDBIndexShiftInsert,
+	YDBIndexShiftRemove,
+} YDBIndexShift;
+
+typedef struct {
+	NSInteger queryGroup;
+	NSUInteger queryIndex;
+	NSUInteger result;
+	
+	YDBIndexShift shift;
+	NSInteger shiftGroup;
+	NSUInteger shiftIndex;
+} YDBIndexTraceStep;
+
+static void YDBIndexTrace(YDBIndexTraceStep *steps, NSUInteger stepCount, NSUInteger groupCount)
+{
+	YDBIndexArena arena = { NULL, 2463534242u };
+	YDBIndexNode **roots = YDBIndexRootsCreate(&arena, groupCount);
+	
+	for (NSUInteger i = 0; i < stepCount; i++)
+	{
+		YDBIndexTraceStep *step = &steps[i];
+		
+		if (step->queryGroup >= 0)
+		{
+			step->result = YDBIndexValueAt(roots[step->queryGroup], step->queryIndex);
+		}
+		
+		if (step->shiftGroup >= 0)
+		{
+			YDBIndexNode **rootPtr = &roots[step->shiftGroup];
+			
+			if (step->shift == YDBIndexShiftInsert)
+			{
+				NSUInteger value = YDBIndexValueAt(*rootPtr, step->shiftIndex);
+				YDBIndexInsert(&arena, rootPtr, step->shiftIndex, value);
+			}
+			else if (step->shift == YDBIndexShiftRemove)
+			{
+				YDBIndexRemove(&arena, rootPtr, step->shiftIndex);
+			}
+		}
+	}
+	
+	free(roots);
+	YDBIndexArenaFree(&arena);
+}
+
+
+/**
+ * Consolidation groups the changes into chains, where each chain represents a single row (i.e. a single key).
+ *
+ * Most changes are matched to their chain by key.
+ * Changes without a key (injected for cell drawing dependencies, or when a group is reset)
+ * are matched by position instead: a chain tracks the row of its most recent insert/update,
+ * and a keyless update/delete at that row belongs to it.
+ *
+ * To track those positions, each chain places a "marker" on its row in the group's sequence.
+ * As rows are inserted & deleted, the markers move along with them.
+ * When a row is deleted, its markers move to the following row (same as the pairwise algorithm).
+**/
+struct YDBChangeChain {
+	YDBIndexNode *node;      // the row this chain is currently tracking (NULL if none)
+	YDBChangeChain *prev;    // other chains tracking the same row
+	YDBChangeChain *next;    // other chains tracking the same row
+	NSUInteger first;        // index of the first change for this row
+	NSUInteger mostRecent;   // index of the most recent change for this row
+};
+
+static void YDBChangeChainAttach(YDBChangeChain *chain, YDBIndexNode *node)
+{
+	chain->node = node;
+	chain->prev = NULL;
+	chain->next = node->markers;
+	
+	if (node->markers) {
+		node->markers->prev = chain;
+	}
+	node->markers = chain;
+}
+
+static void YDBChangeChainDetach(YDBChangeChain *chain)
+{
+	if (chain->node == NULL) return;
+	
+	if (chain->prev)
+		chain->prev->next = chain->next;
+	else
+		chain->node->markers = chain->next;
+	
+	if (chain->next) {
+		chain->next->prev = chain->prev;
+	}
+	
+	chain->node = NULL;
+	chain->prev = NULL;
+	chain->next = NULL;
+}
+
+typedef struct {
+	YapDatabaseViewChangeType type;
+	NSInteger originalGroup;   // -1 if nil
+	NSInteger finalGroup;      // -1 if nil
+	NSUInteger opOriginalIndex;
+	NSUInteger opFinalIndex;
+	
+	NSInteger key;             // -1 if nil (keys may be filled in during consolidation)
+	NSInteger chain;           // output: index of the first change of the chain this change belongs to, or -1
+} YDBConsolidateItem;
+
+static void YDBConsolidateChains(YDBConsolidateItem *items, NSUInteger count,
+                                 NSUInteger groupCount, NSUInteger keyCount)
+{
+	YDBIndexArena arena = { NULL, 2463534242u };
+	YDBIndexNode **roots = YDBIndexRootsCreate(&arena, groupCount);
+	
+	YDBChangeChain *chains = (YDBChangeChain *)calloc((count ?: 1), sizeof(YDBChangeChain));
+	
+	NSInteger *chainForKey = (NSInteger *)malloc(sizeof(NSInteger) * (keyCount ?: 1));
+	for (NSUInteger k = 0; k < keyCount; k++)
+	{
+		chainForKey[k] = -1;
+	}
+	
+	for (NSUInteger j = 0; j < count; j++)
+	{
+		YDBConsolidateItem *item = &items[j];
+		item->chain = -1;
+		
+		// Find the (earliest) chain this change belongs to
+		
+		NSInteger claimer = -1;
+		BOOL claimedByKey = NO;
+		
+		if (item->key >= 0 && chainForKey[item->key] >= 0)
+		{
+			claimer = chainForKey[item->key];
+			claimedByKey = YES;
+		}
+		
+		if ((item->type == YapDatabaseViewChangeUpdate || item->type == YapDatabaseViewChangeDelete) &&
+		    (item->originalGroup >= 0))
+		{
+			NSUInteger offset = 0;
+			YDBIndexNode *node = YDBIndexNodeAt(roots[item->originalGroup], item->opOriginalIndex, &offset);
+			
+			for (YDBChangeChain *chain = (node ? node->markers : NULL); chain; chain = chain->next)
+			{
+				NSInteger c = (NSInteger)chain->first;
+				
+				if (claimer >= 0 && c >= claimer) continue;
+				
+				// If both have a key, then they're only compared by key
+				if (items[c].key >= 0 && item->key >= 0) continue;
+				
+				if (items[chain->mostRecent].type == YapDatabaseViewChangeInsert &&
+				    item->type != YapDatabaseViewChangeUpdate) continue;
+				
+				claimer = c;
+				claimedByKey = NO;
+			}
+		}
+		
+		YDBChangeChain *chain = NULL;
+		
+		if (claimer >= 0)
+		{
+			chain = &chains[claimer];
+			item->chain = claimer;
+			
+			if (!claimedByKey)
+			{
+				YDBConsolidateItem *mostRecent = &items[chain->mostRecent];
+				YDBConsolidateItem *first = &items[claimer];
+				
+				if (mostRecent->key < 0)
+					mostRecent->key = item->key;
+				else
+					item->key = mostRecent->key;
+				
+				if (first->key < 0)
+					first->key = mostRecent->key;
+				
+				if (first->key >= 0 &&
+				    (chainForKey[first->key] < 0 || chainForKey[first->key] > claimer))
+				{
+					chainForKey[first->key] = claimer;
+				}
+			}
+			
+			YDBChangeChainDetach(chain);
+			chain->mostRecent = j;
+		}
+		else
+		{
+			chain = &chains[j];
+			chain->first = j;
+			chain->mostRecent = j;
+			
+			if (item->key >= 0 && chainForKey[item->key] < 0) {
+				chainForKey[item->key] = (NSInteger)j;
+			}
+		}
+		
+		// Shift every other chain's row
+		
+		if (item->type == YapDatabaseViewChangeInsert && item->finalGroup >= 0)
+		{
+			YDBIndexInsert(&arena, &roots[item->finalGroup], item->opFinalIndex, 0);
+		}
+		else if (item->type == YapDatabaseViewChangeDelete && item->originalGroup >= 0)
+		{
+			YDBIndexNode **rootPtr = &roots[item->originalGroup];
+			YDBIndexNode *row = YDBIndexRemove(&arena, rootPtr, item->opOriginalIndex);
+			
+			if (row->markers)
+			{
+				YDBIndexNode *nextRow = YDBIndexIsolate(&arena, rootPtr, item->opOriginalIndex);
+				
+				YDBChangeChain *marker = row->markers;
+				YDBChangeChain *lastMarker = NULL;
+				while (marker)
+				{
+					marker->node = nextRow;
+					lastMarker = marker;
+					marker = marker->next;
+				}
+				
+				lastMarker->next = nextRow->markers;
+				if (nextRow->markers) {
+					nextRow->markers->prev = lastMarker;
+				}
+				nextRow->markers = row->markers;
+				row->markers = NULL;
+			}
+		}
+		
+		// And track this change's row
+		
+		if ((item->type == YapDatabaseViewChangeInsert || item->type == YapDatabaseViewChangeUpdate) &&
+		    (item->finalGroup >= 0))
+		{
+			YDBIndexNode *row = YDBIndexIsolate(&arena, &roots[item->finalGroup], item->opFinalIndex);
+			YDBChangeChainAttach(chain, row);
+		}
+	}
+	
+	free(chainForKey);
+	free(chains);
+	free(roots);
+	YDBIndexArenaFree(&arena);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 @implementation YapDatabaseViewSectionChange {
 
@@ -627,115 +1143,155 @@
 	// TestViewChangeLogic.m
 	
 	__block NSUInteger i;
-	__block NSUInteger j;
-	
-	// STEP 1
-	//
-	// First we enumerate the items BACKWARDS,
-	// and update the ORIGINAL index values.
 	
 	NSUInteger rowChangesCount = [rowChanges count];
 	
 	__unsafe_unretained id *_rowChanges = (__unsafe_unretained id *)malloc(sizeof(id) * rowChangesCount);
 	[rowChanges getObjects:_rowChanges range:NSMakeRange(0, rowChangesCount)];
 	
-	for (i = rowChangesCount; i > 0; i--)
+	// Tracing is done against a model of each group (see YDBIndexTrace),
+	// so we need to convert each group name into a group number.
+	
+	NSMutableDictionary *groupIds = [NSMutableDictionary dictionary];
+	
+	NSInteger *originalGroupIds = (NSInteger *)malloc(sizeof(NSInteger) * (rowChangesCount ?: 1));
+	NSInteger *finalGroupIds = (NSInteger *)malloc(sizeof(NSInteger) * (rowChangesCount ?: 1));
+	
+	NSInteger (^GroupId)(NSString *group) = ^NSInteger (NSString *group){
+		
+		if (group == nil) return -1;
+		
+		NSNumber *groupId = [groupIds objectForKey:group];
+		if (groupId == nil)
+		{
+			groupId = @([groupIds count]);
+			[groupIds setObject:groupId forKey:group];
+		}
+		
+		return [groupId integerValue];
+	};
+	
+	for (i = 0; i < rowChangesCount; i++)
 	{
-		__unsafe_unretained YapDatabaseViewRowChange *rowChange = _rowChanges[i-1];
+		__unsafe_unretained YapDatabaseViewRowChange *rowChange = _rowChanges[i];
+		
+		originalGroupIds[i] = GroupId(rowChange->originalGroup);
+		finalGroupIds[i] = GroupId(rowChange->finalGroup);
+	}
+	
+	YDBIndexTraceStep *steps = (YDBIndexTraceStep *)malloc(sizeof(YDBIndexTraceStep) * (rowChangesCount ?: 1));
+	
+	// STEP 1
+	//
+	// First we update the ORIGINAL index values.
+	//
+	// We replay the changes FORWARDS, and trace each delete & update back through every earlier change.
+	//
+	// - A DELETE operation may affect the ORIGINAL index value of operations that occurred AFTER it,
+	//   IF the later operation occurs at a greater or equal index value.  ( +1 )
+	// - An INSERT operation may affect the ORIGINAL index value of operations that occurred AFTER it,
+	//   IF the later operation occurs at a greater (but not equal) index value.  ( -1 )
+	
+	for (i = 0; i < rowChangesCount; i++)
+	{
+		__unsafe_unretained YapDatabaseViewRowChange *rowChange = _rowChanges[i];
+		YDBIndexTraceStep *step = &steps[i];
+		
+		step->queryGroup = -1;
+		step->shift = YDBIndexShiftNone;
+		step->shiftGroup = -1;
 		
 		if (rowChange->type == YapDatabaseViewChangeDelete)
 		{
-			// A DELETE operation may affect the ORIGINAL index value of operations that occurred AFTER it,
-			//  IF the later operation occurs at a greater or equal index value.  ( +1 )
+			step->queryGroup = originalGroupIds[i];
+			step->queryIndex = rowChange->originalIndex;
 			
-			for (j = i; j < rowChangesCount; j++)
-			{
-				__unsafe_unretained YapDatabaseViewRowChange *laterRowChange = _rowChanges[j];
-				
-				if (laterRowChange->type == YapDatabaseViewChangeDelete ||
-					laterRowChange->type == YapDatabaseViewChangeUpdate)
-				{
-					if (laterRowChange->originalIndex >= rowChange->opOriginalIndex &&
-					   [laterRowChange->originalGroup isEqualToString:rowChange->originalGroup])
-					{
-						laterRowChange->originalIndex += 1;
-					}
-				}
-			}
+			step->shift = YDBIndexShiftRemove;
+			step->shiftGroup = originalGroupIds[i];
+			step->shiftIndex = rowChange->opOriginalIndex;
+		}
+		else if (rowChange->type == YapDatabaseViewChangeUpdate)
+		{
+			step->queryGroup = originalGroupIds[i];
+			step->queryIndex = rowChange->originalIndex;
 		}
 		else if (rowChange->type == YapDatabaseViewChangeInsert)
 		{
-			// An INSERT operation may affect the ORIGINAL index value of operations that occurred AFTER it,
-			//   IF the later operation occurs at a greater (but not equal) index value.  ( -1 )
-			
-			for (j = i; j < rowChangesCount; j++)
-			{
-				__unsafe_unretained YapDatabaseViewRowChange *laterRowChange = _rowChanges[j];
-				
-				if (laterRowChange->type == YapDatabaseViewChangeDelete ||
-				    laterRowChange->type == YapDatabaseViewChangeUpdate)
-				{
-					if (laterRowChange->originalIndex > rowChange->opFinalIndex &&
-					   [laterRowChange->originalGroup isEqualToString:rowChange->finalGroup])
-					{
-						laterRowChange->originalIndex -= 1;
-					}
-				}
-			}
+			step->shift = YDBIndexShiftInsert;
+			step->shiftGroup = finalGroupIds[i];
+			step->shiftIndex = rowChange->opFinalIndex;
+		}
+	}
+	
+	YDBIndexTrace(steps, rowChangesCount, [groupIds count]);
+	
+	for (i = 0; i < rowChangesCount; i++)
+	{
+		if (steps[i].queryGroup >= 0)
+		{
+			__unsafe_unretained YapDatabaseViewRowChange *rowChange = _rowChanges[i];
+			rowChange->originalIndex = steps[i].result;
 		}
 	}
 	
 	// STEP 2
 	//
-	// Next we enumerate the items FORWARDS,
-	// and update the FINAL index values.
+	// Next we update the FINAL index values.
+	//
+	// We replay the changes BACKWARDS, and trace each insert & update forward through every later change.
+	//
+	// - A DELETE operation may affect the FINAL index value of operations that occurred BEFORE it,
+	//   IF the earlier operation occurs at a greater (but not equal) index value. ( -1 )
+	// - An INSERT operation may affect the FINAL index value of operations that occurred BEFORE it,
+	//   IF the earlier operation occurs at a greater or equal index value ( +1 )
 	
-	for (i = 1; i < rowChangesCount; i++)
+	for (i = 0; i < rowChangesCount; i++)
 	{
-		__unsafe_unretained YapDatabaseViewRowChange *rowChange = _rowChanges[i];
+		__unsafe_unretained YapDatabaseViewRowChange *rowChange = _rowChanges[rowChangesCount - 1 - i];
+		NSUInteger rowChangeIndex = rowChangesCount - 1 - i;
+		YDBIndexTraceStep *step = &steps[i];
 		
-		if (rowChange->type == YapDatabaseViewChangeDelete)
+		step->queryGroup = -1;
+		step->shift = YDBIndexShiftNone;
+		step->shiftGroup = -1;
+		
+		if (rowChange->type == YapDatabaseViewChangeInsert)
 		{
-			// A DELETE operation may affect the FINAL index value of operations that occurred BEFORE it,
-			//  IF the earlier operation occurs at a greater (but not equal) index value. ( -1 )
+			step->queryGroup = finalGroupIds[rowChangeIndex];
+			step->queryIndex = rowChange->finalIndex;
 			
-			for (j = i; j > 0; j--)
-			{
-				__unsafe_unretained YapDatabaseViewRowChange *earlierRowChange = _rowChanges[j-1];
-				
-				if (earlierRowChange->type == YapDatabaseViewChangeInsert ||
-				    earlierRowChange->type == YapDatabaseViewChangeUpdate  )
-				{
-					if (earlierRowChange->finalIndex > rowChange->opOriginalIndex &&
-					   [earlierRowChange->finalGroup isEqualToString:rowChange->originalGroup])
-					{
-						earlierRowChange->finalIndex -= 1;
-					}
-				}
-			}
+			step->shift = YDBIndexShiftRemove;
+			step->shiftGroup = finalGroupIds[rowChangeIndex];
+			step->shiftIndex = rowChange->opFinalIndex;
 		}
-		else if (rowChange->type == YapDatabaseViewChangeInsert)
+		else if (rowChange->type == YapDatabaseViewChangeUpdate)
 		{
-			// An INSERT operation may affect the FINAL index value of operations that occurred BEFORE it,
-			//   IF the earlier operation occurs at a greater or equal index value ( +1 )
-			
-			for (j = i; j > 0; j--)
-			{
-				__unsafe_unretained YapDatabaseViewRowChange *earlierRowChange = _rowChanges[j-1];
-				
-				if (earlierRowChange->type == YapDatabaseViewChangeInsert ||
-				    earlierRowChange->type == YapDatabaseViewChangeUpdate)
-				{
-					if (earlierRowChange->finalIndex >= rowChange->opFinalIndex &&
-					   [earlierRowChange->finalGroup isEqualToString:rowChange->finalGroup])
-					{
-						earlierRowChange->finalIndex += 1;
-					}
-				}
-			}
+			step->queryGroup = finalGroupIds[rowChangeIndex];
+			step->queryIndex = rowChange->finalIndex;
+		}
+		else if (rowChange->type == YapDatabaseViewChangeDelete)
+		{
+			step->shift = YDBIndexShiftInsert;
+			step->shiftGroup = originalGroupIds[rowChangeIndex];
+			step->shiftIndex = rowChange->opOriginalIndex;
 		}
 	}
 	
+	YDBIndexTrace(steps, rowChangesCount, [groupIds count]);
+	
+	for (i = 0; i < rowChangesCount; i++)
+	{
+		if (steps[i].queryGroup >= 0)
+		{
+			__unsafe_unretained YapDatabaseViewRowChange *rowChange = _rowChanges[rowChangesCount - 1 - i];
+			rowChange->finalIndex = steps[i].result;
+		}
+	}
+	
+	free(steps);
+	free(originalGroupIds);
+	free(finalGroupIds);
+
 	// STEP 3
 	//
 	// The user may have various range options set for each group.
@@ -1002,6 +1558,155 @@
 	}
 }
 
+/**
+ * When the mappings use range options, the vast majority of a large changeset may be outside the visible range.
+ * For example, the mappings display the top 20 items, and the transaction touched 50,000 items in the group.
+ *
+ * This method removes the row changes for any key that never comes near the visible range,
+ * so that consolidation & post-processing only have to deal with the changes that might actually be displayed.
+ *
+ * It must be invoked after processRowChanges (so the original & final index of every change is known,
+ * and the final range has been updated), and before consolidateRowChanges.
+ *
+ * Nothing is lost by removing these changes:
+ * - the final group counts come from the mappings, not from the changeset
+ * - a consolidated change is only affected by the original index of its first change,
+ *   and the final index of its last change, both of which are outside the range (plus a margin)
+ *
+ * Groups with keyless changes (injected for cell drawing dependencies, or when a group is reset) are left untouched,
+ * as consolidation matches those changes by index rather than by key.
+**/
++ (void)filterRowChangesOutsideRange:(NSMutableArray *)rowChanges
+                withOriginalMappings:(YapDatabaseViewMappings *)originalMappings
+                       finalMappings:(YapDatabaseViewMappings *)finalMappings
+{
+	if (![originalMappings hasRangeOptions] && ![finalMappings hasRangeOptions]) return;
+	
+	// Group consolidation may need every change in the mappings
+	if ([originalMappings autoConsolidateGroupsThreshold] > 0 ||
+	    [finalMappings autoConsolidateGroupsThreshold] > 0) return;
+	
+	NSRange (^VisibleRange)(YapDatabaseViewMappings*, NSString*) =
+	  ^NSRange (YapDatabaseViewMappings *mappings, NSString *group)
+	{
+		NSUInteger groupCount = [mappings fullCountForGroup:group];
+		YapDatabaseViewRangeOptions *rangeOpts = [mappings _rangeOptionsForGroup:group];
+		
+		NSUInteger rangeLength = rangeOpts.length;
+		NSUInteger rangeOffset = rangeOpts.offset;
+		
+		NSUInteger rangeMin;
+		NSUInteger rangeMax;
+		
+		if (rangeOpts.pin == YapDatabaseViewBeginning)
+		{
+			rangeMin = rangeOffset;
+			rangeMax = rangeOffset + rangeLength;
+		}
+		else // if (rangeOpts.pin == YapDatabaseViewEnd)
+		{
+			if (rangeOffset < groupCount) {
+				rangeMax = groupCount - rangeOffset;
+				rangeMin = rangeMax - rangeLength;
+			}
+			else {
+				rangeMax = 0;
+				rangeMin = 0;
+			}
+		}
+		
+		// Add a margin on both sides.
+		// A flexible range may grow (up to its minLength) during post-processing.
+		
+		NSUInteger margin = MAX(rangeLength, rangeOpts.minLength);
+		
+		rangeMin = (rangeMin > margin) ? (rangeMin - margin) : 0;
+		rangeMax = rangeMax + margin;
+		
+		return NSMakeRange(rangeMin, (rangeMax - rangeMin));
+	};
+	
+	NSMutableDictionary *originalRanges = [NSMutableDictionary dictionary];
+	NSMutableDictionary *finalRanges = [NSMutableDictionary dictionary];
+	
+	for (NSString *group in [originalMappings allGroups])
+	{
+		if ([originalMappings hasRangeOptionsForGroup:group] && [finalMappings hasRangeOptionsForGroup:group])
+		{
+			[originalRanges setObject:[NSValue valueWithRange:VisibleRange(originalMappings, group)] forKey:group];
+			[finalRanges setObject:[NSValue valueWithRange:VisibleRange(finalMappings, group)] forKey:group];
+		}
+	}
+	
+	if ([originalRanges count] == 0) return;
+	
+	for (YapDatabaseViewRowChange *rowChange in rowChanges)
+	{
+		if (rowChange->collectionKey == nil)
+		{
+			if (rowChange->originalGroup) {
+				[originalRanges removeObjectForKey:rowChange->originalGroup];
+				[finalRanges removeObjectForKey:rowChange->originalGroup];
+			}
+			if (rowChange->finalGroup) {
+				[originalRanges removeObjectForKey:rowChange->finalGroup];
+				[finalRanges removeObjectForKey:rowChange->finalGroup];
+			}
+		}
+	}
+	
+	if ([originalRanges count] == 0) return;
+	
+	// Find every key that has at least one change near the visible range.
+	// (Or in a group without range options.)
+	
+	NSMutableSet *visibleKeys = [NSMutableSet set];
+	
+	for (YapDatabaseViewRowChange *rowChange in rowChanges)
+	{
+		if (rowChange->collectionKey == nil) continue;
+		
+		BOOL isVisible = NO;
+		
+		if (rowChange->type == YapDatabaseViewChangeDelete || rowChange->type == YapDatabaseViewChangeUpdate)
+		{
+			NSValue *range = [originalRanges objectForKey:rowChange->originalGroup];
+			
+			if (range == nil || NSLocationInRange(rowChange->originalIndex, [range rangeValue]))
+				isVisible = YES;
+		}
+		
+		if (rowChange->type == YapDatabaseViewChangeInsert || rowChange->type == YapDatabaseViewChangeUpdate)
+		{
+			NSValue *range = [finalRanges objectForKey:rowChange->finalGroup];
+			
+			if (range == nil || NSLocationInRange(rowChange->finalIndex, [range rangeValue]))
+				isVisible = YES;
+		}
+		
+		if (isVisible) {
+			[visibleKeys addObject:rowChange->collectionKey];
+		}
+	}
+	
+	NSMutableIndexSet *indexesToRemove = [NSMutableIndexSet indexSet];
+	
+	NSUInteger rowChangeIndex = 0;
+	for (YapDatabaseViewRowChange *rowChange in rowChanges)
+	{
+		if (rowChange->collectionKey && ![visibleKeys containsObject:rowChange->collectionKey])
+		{
+			[indexesToRemove addIndex:rowChangeIndex];
+		}
+		
+		rowChangeIndex++;
+	}
+	
+	if ([indexesToRemove count] > 0) {
+		[rowChanges removeObjectsAtIndexes:indexesToRemove];
+	}
+}
+
 /**
  * This method consolidates multiple changes to the same row into a single change that reflects
  * the original and final position of each changed row.
@@ -1019,116 +1724,111 @@
 	__unsafe_unretained id *_changes = (__unsafe_unretained id *)malloc(sizeof(id) * changesCount);
 	[changes getObjects:_changes range:NSMakeRange(0, changesCount)];
 	
+	// Consolidation is done against a model of each group (see YDBConsolidateChains),
+	// so we need to convert each group name & collectionKey into a number.
+	
+	NSMutableDictionary *groupIds = [NSMutableDictionary dictionary];
+	NSMutableDictionary *keyIds = [NSMutableDictionary dictionary];
+	NSMutableArray *keys = [NSMutableArray array];
+	
+	NSInteger (^GroupId)(NSString *group) = ^NSInteger (NSString *group){
+		
+		if (group == nil) return -1;
+		
+		NSNumber *groupId = [groupIds objectForKey:group];
+		if (groupId == nil)
+		{
+			groupId = @([groupIds count]);
+			[groupIds setObject:groupId forKey:group];
+		}
+		
+		return [groupId integerValue];
+	};
+	
+	YDBConsolidateItem *items = (YDBConsolidateItem *)malloc(sizeof(YDBConsolidateItem) * (changesCount ?: 1));
+	
 	for (i = 0; i < changesCount; i++)
 	{
-		if ([indexesToRemove containsIndex:i]) continue;
+		__unsafe_unretained YapDatabaseViewRowChange *change = _changes[i];
+		YDBConsolidateItem *item = &items[i];
+		
+		item->type = change->type;
+		item->originalGroup = GroupId(change->originalGroup);
+		item->finalGroup = GroupId(change->finalGroup);
+		item->opOriginalIndex = change->opOriginalIndex;
+		item->opFinalIndex = change->opFinalIndex;
+		item->key = -1;
+		item->chain = -1;
+		
+		if (change->collectionKey)
+		{
+			NSNumber *keyId = [keyIds objectForKey:change->collectionKey];
+			if (keyId == nil)
+			{
+				keyId = @([keys count]);
+				[keyIds setObject:keyId forKey:change->collectionKey];
+				[keys addObject:change->collectionKey];
+			}
+			
+			item->key = [keyId integerValue];
+		}
+	}
+	
+	// Find later operations with the same key.
+	//
+	// Changes with a nil key are matched by comparing indexes & groups instead.
+	// This technique applies to situations where one of the changes is an Update with a nil key,
+	// which was injected during pre-processing due to cell drawing dependencies.
+	//
+	// When a nil key is matched this way, the key is filled in from the matching change.
+	
+	YDBConsolidateChains(items, changesCount, [groupIds count], [keys count]);
+	
+	NSUInteger *nextInChain = (NSUInteger *)malloc(sizeof(NSUInteger) * (changesCount ?: 1));
+	NSUInteger *tailOfChain = (NSUInteger *)malloc(sizeof(NSUInteger) * (changesCount ?: 1));
+	
+	for (i = 0; i < changesCount; i++)
+	{
+		__unsafe_unretained YapDatabaseViewRowChange *change = _changes[i];
+		YDBConsolidateItem *item = &items[i];
 		
-		__unsafe_unretained YapDatabaseViewRowChange *firstChangeForKey = _changes[i];
-		__unsafe_unretained YapDatabaseViewRowChange *mostRecentChangeForKey = firstChangeForKey;
+		if (item->key >= 0)
+		{
+			__unsafe_unretained YapCollectionKey *collectionKey = [keys objectAtIndex:item->key];
+			
+			if (change->collectionKey != collectionKey) {
+				change->collectionKey = collectionKey;
+			}
+		}
 		
-		NSUInteger mostRecentChangeForKey_OpIndex = 0;
+		nextInChain[i] = NSNotFound;
 		
-		if (mostRecentChangeForKey->type == YapDatabaseViewChangeUpdate ||
-			mostRecentChangeForKey->type == YapDatabaseViewChangeInsert)
-			mostRecentChangeForKey_OpIndex = mostRecentChangeForKey->opFinalIndex;
+		if (item->chain >= 0)
+		{
+			NSUInteger firstIndex = (NSUInteger)item->chain;
+			
+			nextInChain[tailOfChain[firstIndex]] = i;
+			tailOfChain[firstIndex] = i;
+		}
+		else
+		{
+			tailOfChain[i] = i;
+		}
+	}
+	
+	for (i = 0; i < changesCount; i++)
+	{
+		if (items[i].chain >= 0) continue; // belongs to an earlier change for the same key
 		
-		// Find later operations with the same key
+		__unsafe_unretained YapDatabaseViewRowChange *firstChangeForKey = _changes[i];
 		
-		for (j = i+1; j < changesCount; j++)
+		for (j = nextInChain[i]; j != NSNotFound; j = nextInChain[j])
 		{
 			__unsafe_unretained YapDatabaseViewRowChange *laterChange = _changes[j];
-			BOOL changesAreForSameKey = NO;
-			
-			if (![indexesToRemove containsIndex:j])
-			{
-				if (firstChangeForKey->collectionKey && laterChange->collectionKey)
-				{
-					// Compare keys
-					
-					if (YapCollectionKeyEqual(laterChange->collectionKey, firstChangeForKey->collectionKey))
-						changesAreForSameKey = YES;
-				}
-				else
-				{
-					// Compare indexes & groups
-					//
-					// This technique is used if one of the keys is nil,
-					// and applies to situations where one of the changes is an Update with a nil key,
-					// which was injected during pre-processing due to cell drawing dependencies.
-					
-					if (mostRecentChangeForKey->type == YapDatabaseViewChangeUpdate)
-					{
-						if (laterChange->type == YapDatabaseViewChangeUpdate ||
-						    laterChange->type == YapDatabaseViewChangeDelete)
-						{
-							if (mostRecentChangeForKey_OpIndex == laterChange->opOriginalIndex &&
-							   [mostRecentChangeForKey->originalGroup isEqualToString:laterChange->originalGroup]) {
-								changesAreForSameKey = YES;
-							}
-						}
-					}
-					else if (mostRecentChangeForKey->type == YapDatabaseViewChangeInsert)
-					{
-						if (laterChange->type == YapDatabaseViewChangeUpdate)
-						{
-							if (mostRecentChangeForKey_OpIndex == laterChange->opOriginalIndex &&
-							   [mostRecentChangeForKey->finalGroup isEqualToString:laterChange->finalGroup]) {
-								changesAreForSameKey = YES;
-							}
-						}
-					}
-					
-					if (changesAreForSameKey)
-					{
-						if (mostRecentChangeForKey->collectionKey == nil)
-							mostRecentChangeForKey->collectionKey = laterChange->collectionKey;
-						else
-							laterChange->collectionKey = mostRecentChangeForKey->collectionKey;
-						
-						if (firstChangeForKey->collectionKey == nil)
-							firstChangeForKey->collectionKey = mostRecentChangeForKey->collectionKey;
-					}
-				}
-			}
 			
-			if (changesAreForSameKey)
-			{
-				firstChangeForKey->changes |= laterChange->changes;
-				[indexesThatMatch addIndex:j];
-				
-				mostRecentChangeForKey = laterChange;
-				
-				if (mostRecentChangeForKey->type == YapDatabaseViewChangeUpdate ||
-				    mostRecentChangeForKey->type == YapDatabaseViewChangeInsert)
-					mostRecentChangeForKey_OpIndex = mostRecentChangeForKey->opFinalIndex;
-				else
-					mostRecentChangeForKey_OpIndex = 0;
-			}
-			else
-			{
-				if (mostRecentChangeForKey->type == YapDatabaseViewChangeUpdate ||
-				    mostRecentChangeForKey->type == YapDatabaseViewChangeInsert)
-				{
-					if (laterChange->type == YapDatabaseViewChangeInsert)
-					{
-						if (laterChange->opFinalIndex <= mostRecentChangeForKey_OpIndex &&
-							[laterChange->finalGroup isEqualToString:mostRecentChangeForKey->finalGroup])
-						{
-							mostRecentChangeForKey_OpIndex++;
-						}
-					}
-					else if (laterChange->type == YapDatabaseViewChangeDelete)
-					{
-						if (laterChange->opOriginalIndex < mostRecentChangeForKey_OpIndex &&
-							[laterChange->originalGroup isEqualToString:mostRecentChangeForKey->finalGroup])
-						{
-							mostRecentChangeForKey_OpIndex--;
-						}
-					}
-				}
-			}
-		
-		} // end for (j = i+1; j < changesCount; j++)
+			firstChangeForKey->changes |= laterChange->changes;
+			[indexesThatMatch addIndex:j];
+		}
 		
 		if ([indexesThatMatch count] > 0)
 		{
@@ -1304,6 +2004,10 @@
 		
 	} // while (i < count)
 	
+	free(items);
+	free(nextInChain);
+	free(tailOfChain);
+	
 	if (_changes) {
 		free(_changes);
 	}
@@ -1410,6 +2114,60 @@
 	}
 }
 
+/**
+ * Used when manually adding inserts or deletes to a group (to fix the final counts).
+ * 
+ * For type == YapDatabaseViewChangeDelete:
+ *   Returns the first delete, move or update in the group for each originalIndex.
+ * 
+ * For type == YapDatabaseViewChangeInsert:
+ *   Returns the first insert, move or update in the group for each finalIndex.
+ * 
+ * This avoids scanning the entire list of changes for every manually added operation.
+**/
++ (NSDictionary *)rowChangesByIndex:(NSArray *)rowChanges
+                            inGroup:(NSString *)group
+                            forType:(YapDatabaseViewChangeType)type
+{
+	NSMutableDictionary *rowChangesByIndex = [NSMutableDictionary dictionary];
+	
+	for (YapDatabaseViewRowChange *rowChange in rowChanges)
+	{
+		if (type == YapDatabaseViewChangeDelete)
+		{
+			if (rowChange->type == YapDatabaseViewChangeDelete ||
+			    rowChange->type == YapDatabaseViewChangeMove   ||
+			    rowChange->type == YapDatabaseViewChangeUpdate)
+			{
+				if ([rowChange->originalGroup isEqualToString:group])
+				{
+					NSNumber *index = @(rowChange->originalIndex);
+					
+					if ([rowChangesByIndex objectForKey:index] == nil)
+						[rowChangesByIndex setObject:rowChange forKey:index];
+				}
+			}
+		}
+		else // if (type == YapDatabaseViewChangeInsert)
+		{
+			if (rowChange->type == YapDatabaseViewChangeInsert ||
+			    rowChange->type == YapDatabaseViewChangeMove   ||
+			    rowChange->type == YapDatabaseViewChangeUpdate)
+			{
+				if ([rowChange->finalGroup isEqualToString:group])
+				{
+					NSNumber *index = @(rowChange->finalIndex);
+					
+					if ([rowChangesByIndex objectForKey:index] == nil)
+						[rowChangesByIndex setObject:rowChange forKey:index];
+				}
+			}
+		}
+	}
+	
+	return rowChangesByIndex;
+}
+
 /**
  * This method applies the given mappings to the processed list of row changes.
  * Based upon the configuration of the mappings, it will
@@ -1874,6 +2632,9 @@
 			else
 				index = 0;                       // Note: offset ignored because op's already mapped
 			
+			NSDictionary *rowChangesByIndex =
+			  [self rowChangesByIndex:rowChanges inGroup:group forType:YapDatabaseViewChangeDelete];
+			
 			while (count < numberOfDeleteOperationsToManuallyAdd)
 			{
 				// We need to be careful not to step on existing rowChanges.
@@ -1883,28 +2644,17 @@
 				
 				BOOL found = NO;
 				
-				for (YapDatabaseViewRowChange *rowChange in rowChanges)
+				YapDatabaseViewRowChange *existingRowChange = [rowChangesByIndex objectForKey:@(index)];
+				if (existingRowChange)
 				{
-					if (rowChange->type == YapDatabaseViewChangeDelete ||
-						rowChange->type == YapDatabaseViewChangeMove)
-					{
-						if (rowChange->originalIndex == index && [rowChange->originalGroup isEqualToString:group])
-						{
-							found = YES;
-							break;
-						}
-					}
-					else if (rowChange->type == YapDatabaseViewChangeUpdate)
+					if (existingRowChange->type == YapDatabaseViewChangeUpdate)
 					{
-						if (rowChange->originalIndex == index && [rowChange->originalGroup isEqualToString:group])
-						{
-							rowChange->type = YapDatabaseViewChangeDelete;
-							
-							count++;
-							found = YES;
-							break;
-						}
+						existingRowChange->type = YapDatabaseViewChangeDelete;
+						
+						count++;
 					}
+					
+					found = YES;
 				}
 				
 				if (!found)
@@ -1943,6 +2693,9 @@
 			else
 				index = finalRangeLength - 1; // Note: offset ignored because op's already mapped
 			
+			NSDictionary *rowChangesByIndex =
+			  [self rowChangesByIndex:rowChanges inGroup:group forType:YapDatabaseViewChangeInsert];
+			
 			while ((count < numberOfInsertOperationsToManuallyAdd) && (i < flexibleRangePinSideInsertDiff))
 			{
 				// We need to be careful not to step on existing rowChanges.
@@ -1954,28 +2707,17 @@
 				
 				BOOL found = NO;
 				
-				for (YapDatabaseViewRowChange *rowChange in rowChanges)
+				YapDatabaseViewRowChange *existingRowChange = [rowChangesByIndex objectForKey:@(index)];
+				if (existingRowChange)
 				{
-					if (rowChange->type == YapDatabaseViewChangeInsert ||
-						rowChange->type == YapDatabaseViewChangeMove)
-					{
-						if (rowChange->finalIndex == index && [rowChange->finalGroup isEqualToString:group])
-						{
-							found = YES;
-							break;
-						}
-					}
-					else if (rowChange->type == YapDatabaseViewChangeUpdate)
+					if (existingRowChange->type == YapDatabaseViewChangeUpdate)
 					{
-						if (rowChange->finalIndex == index && [rowChange->finalGroup isEqualToString:group])
-						{
-							rowChange->type = YapDatabaseViewChangeInsert;
-							
-							count++;
-							found = YES;
-							break;
-						}
+						existingRowChange->type = YapDatabaseViewChangeInsert;
+						
+						count++;
 					}
+					
+					found = YES;
 				}
 				
 				if (!found)
@@ -2015,6 +2757,9 @@
 			else
 				index = 0;                    // Note: offset ignored because op's already mapped
 			
+			NSDictionary *rowChangesByIndex =
+			  [self rowChangesByIndex:rowChanges inGroup:group forType:YapDatabaseViewChangeInsert];
+			
 			while (count < numberOfInsertOperationsToManuallyAdd)
 			{
 				// We need to be careful not to step on existing rowChanges.
@@ -2026,28 +2771,17 @@
 				
 				BOOL found = NO;
 				
-				for (YapDatabaseViewRowChange *rowChange in rowChanges)
+				YapDatabaseViewRowChange *existingRowChange = [rowChangesByIndex objectForKey:@(index)];
+				if (existingRowChange)
 				{
-					if (rowChange->type == YapDatabaseViewChangeInsert ||
-						rowChange->type == YapDatabaseViewChangeMove)
-					{
-						if (rowChange->finalIndex == index && [rowChange->finalGroup isEqualToString:group])
-						{
-							found = YES;
-							break;
-						}
-					}
-					else if (rowChange->type == YapDatabaseViewChangeUpdate)
+					if (existingRowChange->type == YapDatabaseViewChangeUpdate)
 					{
-						if (rowChange->finalIndex == index && [rowChange->finalGroup isEqualToString:group])
-						{
-							rowChange->type = YapDatabaseViewChangeInsert;
-							
-							count++;
-							found = YES;
-							break;
-						}
+						existingRowChange->type = YapDatabaseViewChangeInsert;
+						
+						count++;
 					}
+					
+					found = YES;
 				}
 				
 				if (!found)
@@ -2740,6 +3474,15 @@
 	   withOriginalMappings:originalMappings
 	          finalMappings:finalMappings];
 	
+	// FILTERING
+	//
+	// If the mappings only display a range of each group,
+	// then changes to keys that are nowhere near the range can be dropped before consolidation.
+	
+	[self filterRowChangesOutsideRange:rowChanges
+	              withOriginalMappings:originalMappings
+	                     finalMappings:finalMappings];
+	
 	// CONSOLIDATION
 	//
 	// Merge multiple changes to same row into a single change.
@@ -25,17 +25,19 @@
 @implementation YapDatabaseViewConnection {
 @private
 	
-	sqlite3_stmt *mapTable_getPageKeyForRowidStatement;
-	sqlite3_stmt *mapTable_setPageKeyForRowidStatement;
+	sqlite3_stmt *mapTable_getPageIdForRowidStatement;
+	sqlite3_stmt *mapTable_setPageIdForRowidStatement;
 	sqlite3_stmt *mapTable_removeForRowidStatement;
 	sqlite3_stmt *mapTable_removeAllStatement;
 	
-	sqlite3_stmt *pageTable_getDataForPageKeyStatement;
-	sqlite3_stmt *pageTable_insertForPageKeyStatement;
-	sqlite3_stmt *pageTable_updateAllForPageKeyStatement;
-	sqlite3_stmt *pageTable_updatePageForPageKeyStatement;
-	sqlite3_stmt *pageTable_updateLinkForPageKeyStatement;
-	sqlite3_stmt *pageTable_removeForPageKeyStatement;
+	sqlite3_stmt *pageTable_getDataForPageIdStatement;
+	sqlite3_stmt *pageTable_getGroupForPageIdStatement;
+	sqlite3_stmt *pageTable_getMetadataForGroupStatement;
+	sqlite3_stmt *pageTable_insertForPageIdStatement;
+	sqlite3_stmt *pageTable_updateAllForPageIdStatement;
+	sqlite3_stmt *pageTable_updatePageForPageIdStatement;
+	sqlite3_stmt *pageTable_updateLinkForPageIdStatement;
+	sqlite3_stmt *pageTable_removeForPageIdStatement;
 	sqlite3_stmt *pageTable_removeAllStatement;
 }
 
@@ -50,10 +52,10 @@
 		
 		mapCache = [[YapCache alloc] initWithCountLimit:100];
 		mapCache.allowedKeyClasses = [NSSet setWithObject:[NSNumber class]];
-		mapCache.allowedObjectClasses = [NSSet setWithObjects:[NSString class], [NSNull class], nil];
+		mapCache.allowedObjectClasses = [NSSet setWithObjects:[NSNumber class], [NSNull class], nil];
 		
 		pageCache = [[YapCache alloc] initWithCountLimit:40];
-		pageCache.allowedKeyClasses = [NSSet setWithObject:[NSString class]];
+		pageCache.allowedKeyClasses = [NSSet setWithObject:[NSNumber class]];
 		pageCache.allowedObjectClasses = [NSSet setWithObject:[YapDatabaseViewPage class]];
 		
 		sharedKeySetForInternalChangeset = [NSDictionary sharedKeySetForKeys:[self internalChangesetKeys]];
@@ -69,17 +71,19 @@
 
 - (void)_flushStatements
 {
-	sqlite_finalize_null(&mapTable_getPageKeyForRowidStatement);
-	sqlite_finalize_null(&mapTable_setPageKeyForRowidStatement);
+	sqlite_finalize_null(&mapTable_getPageIdForRowidStatement);
+	sqlite_finalize_null(&mapTable_setPageIdForRowidStatement);
 	sqlite_finalize_null(&mapTable_removeForRowidStatement);
 	sqlite_finalize_null(&mapTable_removeAllStatement);
 	
-	sqlite_finalize_null(&pageTable_getDataForPageKeyStatement);
-	sqlite_finalize_null(&pageTable_insertForPageKeyStatement);
-	sqlite_finalize_null(&pageTable_updateAllForPageKeyStatement);
-	sqlite_finalize_null(&pageTable_updatePageForPageKeyStatement);
-	sqlite_finalize_null(&pageTable_updateLinkForPageKeyStatement);
-	sqlite_finalize_null(&pageTable_removeForPageKeyStatement);
+	sqlite_finalize_null(&pageTable_getDataForPageIdStatement);
+	sqlite_finalize_null(&pageTable_getGroupForPageIdStatement);
+	sqlite_finalize_null(&pageTable_getMetadataForGroupStatement);
+	sqlite_finalize_null(&pageTable_insertForPageIdStatement);
+	sqlite_finalize_null(&pageTable_updateAllForPageIdStatement);
+	sqlite_finalize_null(&pageTable_updatePageForPageIdStatement);
+	sqlite_finalize_null(&pageTable_updateLinkForPageIdStatement);
+	sqlite_finalize_null(&pageTable_removeForPageIdStatement);
 	sqlite_finalize_null(&pageTable_removeAllStatement);
 }
 
@@ -130,13 +134,13 @@
 {
 	NSNull *nsnull = [NSNull null];
 	
-	for (NSString *pageKey in [dirtyPages allKeys])
+	for (NSNumber *pageId in [dirtyPages allKeys])
 	{
-		YapDatabaseViewPage *page = [dirtyPages objectForKey:pageKey];
+		YapDatabaseViewPage *page = [dirtyPages objectForKey:pageId];
 		
 		if ((id)page != nsnull)
 		{
-			[dirtyPages setObject:[page copy] forKey:pageKey];
+			[dirtyPages setObject:[page copy] forKey:pageId];
 		}
 	}
 }
@@ -360,14 +364,14 @@
 		
 		NSNull *nsnull = [NSNull null];
 		
-		for (NSString *key in keysToUpdate)
+		for (NSNumber *key in keysToUpdate)
 		{
-			NSString *pageKey = [changeset_dirtyMaps objectForKey:key];
+			NSNumber *pageId = [changeset_dirtyMaps objectForKey:key];
 			
-			if ((id)pageKey == nsnull)
+			if ((id)pageId == nsnull)
 				[mapCache removeObjectForKey:key];
 			else
-				[mapCache setObject:pageKey forKey:key];
+				[mapCache setObject:pageId forKey:key];
 		}
 	}
 	
@@ -403,17 +407,17 @@
 		
 		NSNull *nsnull = [NSNull null];
 		
-		for (NSString *pageKey in keysToUpdate)
+		for (NSNumber *pageId in keysToUpdate)
 		{
-			YapDatabaseViewPage *page = [changeset_dirtyPages objectForKey:pageKey];
+			YapDatabaseViewPage *page = [changeset_dirtyPages objectForKey:pageId];
 			
 			// Each viewConnection needs its own independent mutable copy of the page.
 			// Mutable pages cannot be shared between multiple view connections.
 			
 			if ((id)page == nsnull)
-				[pageCache removeObjectForKey:pageKey];
+				[pageCache removeObjectForKey:pageId];
 			else
-				[pageCache setObject:[page copy] forKey:pageKey];
+				[pageCache setObject:[page copy] forKey:pageId];
 		}
 	}
 }
@@ -728,15 +732,15 @@
 #pragma mark Statements - MapTable
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-- (sqlite3_stmt *)mapTable_getPageKeyForRowidStatement
+- (sqlite3_stmt *)mapTable_getPageIdForRowidStatement
 {
 	NSAssert([self isPersistentView], @"In-memory view accessing sqlite");
 	
-	sqlite3_stmt **statement = &mapTable_getPageKeyForRowidStatement;
+	sqlite3_stmt **statement = &mapTable_getPageIdForRowidStatement;
 	if (*statement == NULL)
 	{
 		NSString *string = [NSString stringWithFormat:
-		    @"SELECT \"pageKey\" FROM \"%@\" WHERE \"rowid\" = ?;", [parent mapTableName]];
+		    @"SELECT \"pageId\" FROM \"%@\" WHERE \"rowid\" = ?;", [parent mapTableName]];
 		
 		[self prepareStatement:statement withString:string caller:_cmd];
 	}
@@ -744,15 +748,15 @@
 	return *statement;
 }
 
-- (sqlite3_stmt *)mapTable_setPageKeyForRowidStatement
+- (sqlite3_stmt *)mapTable_setPageIdForRowidStatement
 {
 	NSAssert([self isPersistentView], @"In-memory view accessing sqlite");
 
-	sqlite3_stmt **statement = &mapTable_setPageKeyForRowidStatement;
+	sqlite3_stmt **statement = &mapTable_setPageIdForRowidStatement;
 	if (*statement == NULL)
 	{
 		NSString *string = [NSString stringWithFormat:
-		    @"INSERT OR REPLACE INTO \"%@\" (\"rowid\", \"pageKey\") VALUES (?, ?);", [parent mapTableName]];
+		    @"INSERT OR REPLACE INTO \"%@\" (\"rowid\", \"pageId\") VALUES (?, ?);", [parent mapTableName]];
 		
 		[self prepareStatement:statement withString:string caller:_cmd];
 	}
@@ -796,15 +800,15 @@
 #pragma mark Statements - PageTable
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-- (sqlite3_stmt *)pageTable_getDataForPageKeyStatement
+- (sqlite3_stmt *)pageTable_getDataForPageIdStatement
 {
 	NSAssert([self isPersistentView], @"In-memory view accessing sqlite");
 
-	sqlite3_stmt **statement = &pageTable_getDataForPageKeyStatement;
+	sqlite3_stmt **statement = &pageTable_getDataForPageIdStatement;
 	if (*statement == NULL)
 	{
 		NSString *string = [NSString stringWithFormat:
-		    @"SELECT \"data\" FROM \"%@\" WHERE \"pageKey\" = ?;", [parent pageTableName]];
+		    @"SELECT \"data\" FROM \"%@\" WHERE \"pageId\" = ?;", [parent pageTableName]];
 		
 		[self prepareStatement:statement withString:string caller:_cmd];
 	}
@@ -812,16 +816,49 @@
 	return *statement;
 }
 
-- (sqlite3_stmt *)pageTable_insertForPageKeyStatement
+- (sqlite3_stmt *)pageTable_getGroupForPageIdStatement
 {
 	NSAssert([self isPersistentView], @"In-memory view accessing sqlite");
 
-	sqlite3_stmt **statement = &pageTable_insertForPageKeyStatement;
+	sqlite3_stmt **statement = &pageTable_getGroupForPageIdStatement;
+	if (*statement == NULL)
+	{
+		NSString *string = [NSString stringWithFormat:
+		    @"SELECT \"group\" FROM \"%@\" WHERE \"pageId\" = ?;", [parent pageTableName]];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+- (sqlite3_stmt *)pageTable_getMetadataForGroupStatement
+{
+	NSAssert([self isPersistentView], @"In-memory view accessing sqlite");
+
+	sqlite3_stmt **statement = &pageTable_getMetadataForGroupStatement;
+	if (*statement == NULL)
+	{
+		NSString *string = [NSString stringWithFormat:
+		    @"SELECT \"pageId\", \"prevPageId\", \"count\" FROM \"%@\" WHERE \"group\" = ?;",
+		    [parent pageTableName]];
+		
+		[self prepareStatement:statement withString:string caller:_cmd];
+	}
+	
+	return *statement;
+}
+
+- (sqlite3_stmt *)pageTable_insertForPageIdStatement
+{
+	NSAssert([self isPersistentView], @"In-memory view accessing sqlite");
+
+	sqlite3_stmt **statement = &pageTable_insertForPageIdStatement;
 	if (*statement == NULL)
 	{
 		NSString *string = [NSString stringWithFormat:
 			@"INSERT INTO \"%@\""
-			@" (\"pageKey\", \"group\", \"prevPageKey\", \"count\", \"data\") VALUES (?, ?, ?, ?, ?);",
+			@" (\"pageId\", \"group\", \"prevPageId\", \"count\", \"data\") VALUES (?, ?, ?, ?, ?);",
 			[parent pageTableName]];
 		
 		[self prepareStatement:statement withString:string caller:_cmd];
@@ -830,15 +867,15 @@
 	return *statement;
 }
 
-- (sqlite3_stmt *)pageTable_updateAllForPageKeyStatement
+- (sqlite3_stmt *)pageTable_updateAllForPageIdStatement
 {
 	NSAssert([self isPersistentView], @"In-memory view accessing sqlite");
 
-	sqlite3_stmt **statement = &pageTable_updateAllForPageKeyStatement;
+	sqlite3_stmt **statement = &pageTable_updateAllForPageIdStatement;
 	if (*statement == NULL)
 	{
 		NSString *string = [NSString stringWithFormat:
-			@"UPDATE \"%@\" SET \"prevPageKey\" = ?, \"count\" = ?, \"data\" = ? WHERE \"pageKey\" = ?;",
+			@"UPDATE \"%@\" SET \"prevPageId\" = ?, \"count\" = ?, \"data\" = ? WHERE \"pageId\" = ?;",
 			[parent pageTableName]];
 		
 		[self prepareStatement:statement withString:string caller:_cmd];
@@ -847,15 +884,15 @@
 	return *statement;
 }
 
-- (sqlite3_stmt *)pageTable_updatePageForPageKeyStatement
+- (sqlite3_stmt *)pageTable_updatePageForPageIdStatement
 {
 	NSAssert([self isPersistentView], @"In-memory view accessing sqlite");
 
-	sqlite3_stmt **statement = &pageTable_updatePageForPageKeyStatement;
+	sqlite3_stmt **statement = &pageTable_updatePageForPageIdStatement;
 	if (*statement == NULL)
 	{
 		NSString *string = [NSString stringWithFormat:
-			@"UPDATE \"%@\" SET \"count\" = ?, \"data\" = ? WHERE \"pageKey\" = ?;", [parent pageTableName]];
+			@"UPDATE \"%@\" SET \"count\" = ?, \"data\" = ? WHERE \"pageId\" = ?;", [parent pageTableName]];
 		
 		[self prepareStatement:statement withString:string caller:_cmd];
 	}
@@ -863,15 +900,15 @@
 	return *statement;
 }
 
-- (sqlite3_stmt *)pageTable_updateLinkForPageKeyStatement
+- (sqlite3_stmt *)pageTable_updateLinkForPageIdStatement
 {
 	NSAssert([self isPersistentView], @"In-memory view accessing sqlite");
 
-	sqlite3_stmt **statement = &pageTable_updateLinkForPageKeyStatement;
+	sqlite3_stmt **statement = &pageTable_updateLinkForPageIdStatement;
 	if (*statement == NULL)
 	{
 		NSString *string = [NSString stringWithFormat:
-			@"UPDATE \"%@\" SET \"prevPageKey\" = ? WHERE \"pageKey\" = ?;", [parent pageTableName]];
+			@"UPDATE \"%@\" SET \"prevPageId\" = ? WHERE \"pageId\" = ?;", [parent pageTableName]];
 		
 		[self prepareStatement:statement withString:string caller:_cmd];
 	}
@@ -879,15 +916,15 @@
 	return *statement;
 }
 
-- (sqlite3_stmt *)pageTable_removeForPageKeyStatement
+- (sqlite3_stmt *)pageTable_removeForPageIdStatement
 {
 	NSAssert([self isPersistentView], @"In-memory view accessing sqlite");
 
-	sqlite3_stmt **statement = &pageTable_removeForPageKeyStatement;
+	sqlite3_stmt **statement = &pageTable_removeForPageIdStatement;
 	if (*statement == NULL)
 	{
 		NSString *string = [NSString stringWithFormat:
-		    @"DELETE FROM \"%@\" WHERE \"pageKey\" = ?;", [parent pageTableName]];
+		    @"DELETE FROM \"%@\" WHERE \"pageId\" = ?;", [parent pageTableName]];
 		
 		[self prepareStatement:statement withString:string caller:_cmd];
 	}
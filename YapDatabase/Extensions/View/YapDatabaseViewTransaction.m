@@ -126,9 +126,17 @@
 		{
 			// Upgrading from older codebase
 			
-			[self dropTablesForOldClassVersion:oldClassVersion];
-			needsCreateTables = YES;
-			needsPopulateView = YES; // Not initialViewPopulation, but rather codebase upgrade.
+			if ([self migrateTablesFromOldClassVersion:oldClassVersion])
+			{
+				// The existing tables were converted in place.
+				// The contents of the view haven't changed, so there's no need to re-populate it.
+			}
+			else
+			{
+				[self dropTablesForOldClassVersion:oldClassVersion];
+				needsCreateTables = YES;
+				needsPopulateView = YES; // Not initialViewPopulation, but rather codebase upgrade.
+			}
 		}
 	
 		// Create the database tables (if needed)
@@ -137,6 +145,12 @@
 		{
 			if (![self createTables]) return NO;
 		}
+		else
+		{
+			// Existing tables may predate the index on the "group" column.
+			
+			if (![self createPageTableIndex]) return NO;
+		}
 		
 		// Check other variables (if needed)
 		
@@ -237,46 +251,32 @@
 		return YES;
 	}
 	
-	// Enumerate over the page rows in the database, and populate our data structure.
-	// Each row has the following information:
-	//
-	// - group
-	// - pageKey
-	// - prevPageKey
-	//
-	// From this information we need to piece together the group_pagesMetadata_dict:
-	// - dict.key = group
-	// - dict.value = properly ordered array of YapDatabaseViewKeyPageMetadata objects
-	//
-	// To piece together the proper page order we make a temporary dictionary with each link in the linked-list.
-	// For example:
-	//
-	// pageC.prevPage = pageB  =>      B -> C
-	// pageB.prevPage = pageA  =>      A -> B
-	// pageA.prevPage = nil    => NSNull -> A
-	//
-	// After the enumeration of all rows is complete, we can simply walk the linked list from the first page.
-	
-	NSMutableDictionary<NSString *, NSMutableDictionary *> *groupPageDict  = [[NSMutableDictionary alloc] init];
-	NSMutableDictionary<NSString *, NSMutableDictionary *> *groupOrderDict = [[NSMutableDictionary alloc] init];
-	
-	__block BOOL error = NO;
-
 	if ([self isPersistentView])
 	{
+		// We don't load the page metadata for every group up front.
+		// A view may have an enormous number of groups, and a transaction typically only touches a handful of them.
+		//
+		// Instead we only fetch the name of each group, along with the number of items in it.
+		// This is sufficient to answer questions such as numberOfGroups, allGroups & numberOfItemsInGroup.
+		// The page metadata for a group is loaded on first access (see pagesMetadataForGroup:),
+		// using the index on the "group" column of the page table.
+		
 		sqlite3 *db = databaseTransaction->connection->db;
 		
-		NSString *string = [NSString stringWithFormat:
-			@"SELECT \"pageKey\", \"group\", \"prevPageKey\", \"count\" FROM \"%@\";", [self pageTableName]];
+		YapDatabaseViewState *newState = [[YapDatabaseViewState alloc] init];
+		BOOL error = NO;
+		
+		// Step 1 of 2: Fetch the groups (and their counts)
 		
-		int const column_idx_pageKey     = SQLITE_COLUMN_START + 0;
-		int const column_idx_group       = SQLITE_COLUMN_START + 1;
-		int const column_idx_prevPageKey = SQLITE_COLUMN_START + 2;
-		int const column_idx_count       = SQLITE_COLUMN_START + 3;
+		NSString *groupsString = [NSString stringWithFormat:
+		    @"SELECT \"group\", SUM(\"count\") FROM \"%@\" GROUP BY \"group\";", [self pageTableName]];
+		
+		int const column_idx_group = SQLITE_COLUMN_START + 0;
+		int const column_idx_count = SQLITE_COLUMN_START + 1;
 		
 		sqlite3_stmt *statement = NULL;
 		
-		int status = sqlite3_prepare_v2(db, [string UTF8String], -1, &statement, NULL);
+		int status = sqlite3_prepare_v2(db, [groupsString UTF8String], -1, &statement, NULL);
 		if (status != SQLITE_OK)
 		{
 			YDBLogError(@"(%@): Cannot create 'enumerate_stmt': %d %s",
@@ -286,70 +286,30 @@
 		
 		unsigned int stepCount = 0;
 		
-		while (sqlite3_step(statement) == SQLITE_ROW)
+		while ((status = sqlite3_step(statement)) == SQLITE_ROW)
 		{
 			stepCount++;
 			
-			const unsigned char *text0 = sqlite3_column_text(statement, column_idx_pageKey);
-			int textSize0 = sqlite3_column_bytes(statement, column_idx_pageKey);
-			
-			NSString *pageKey = [[NSString alloc] initWithBytes:text0 length:textSize0 encoding:NSUTF8StringEncoding];
+			const unsigned char *text = sqlite3_column_text(statement, column_idx_group);
+			int textSize = sqlite3_column_bytes(statement, column_idx_group);
 			
-			const unsigned char *text1 = sqlite3_column_text(statement, column_idx_group);
-			int textSize1 = sqlite3_column_bytes(statement, column_idx_group);
+			NSString *group = [[NSString alloc] initWithBytes:text length:textSize encoding:NSUTF8StringEncoding];
 			
-			NSString *group = [[NSString alloc] initWithBytes:text1 length:textSize1 encoding:NSUTF8StringEncoding];
-			
-			const unsigned char *text2 = sqlite3_column_text(statement, column_idx_prevPageKey);
-			int textSize2 = sqlite3_column_bytes(statement, column_idx_prevPageKey);
-			
-			NSString *prevPageKey = nil;
-			if (textSize2 > 0)
-				prevPageKey = [[NSString alloc] initWithBytes:text2 length:textSize2 encoding:NSUTF8StringEncoding];
-			
-			int count = sqlite3_column_int(statement, column_idx_count);
+			int64_t count = sqlite3_column_int64(statement, column_idx_count);
 			
 			if (count >= 0)
 			{
-				YapDatabaseViewPageMetadata *pageMetadata = [[YapDatabaseViewPageMetadata alloc] init];
-				pageMetadata->pageKey = pageKey;
-				pageMetadata->group = group;
-				pageMetadata->prevPageKey = prevPageKey;
-				pageMetadata->count = (NSUInteger)count;
-				
-				NSMutableDictionary *pageDict = groupPageDict[group];
-				if (pageDict == nil)
-				{
-					pageDict = [[NSMutableDictionary alloc] init];
-					groupPageDict[group] = pageDict;
-				}
-				
-				NSMutableDictionary *orderDict = groupOrderDict[group];
-				if (orderDict == nil)
-				{
-					orderDict = [[NSMutableDictionary alloc] init];
-					groupOrderDict[group] = orderDict;
-				}
-			
-				[pageDict setObject:pageMetadata forKey:pageKey];
-				
-				if (prevPageKey)
-					[orderDict setObject:pageKey forKey:prevPageKey];
-				else
-					[orderDict setObject:pageKey forKey:[NSNull null]];
+				[newState addUnloadedGroup:group withCount:(NSUInteger)count];
 			}
 			else
 			{
-				YDBLogWarn(@"(%@): Encountered invalid count: %d", [self registeredName], count);
+				YDBLogWarn(@"(%@): Encountered invalid count: %lld", [self registeredName], count);
 			}
 		}
-	
-		YDBLogVerbose(@"Processing %u items from %@...", stepCount, [self pageTableName]);
 		
-		YDBLogVerbose(@"groupPageDict: %@", groupPageDict);
-		YDBLogVerbose(@"groupOrderDict: %@", groupOrderDict);
+		YDBLogVerbose(@"Processing %u groups from %@...", stepCount, [self pageTableName]);
 		
-		if ((status != SQLITE_OK) && (status != SQLITE_DONE))
+		if (status != SQLITE_DONE)
 		{
 			error = YES;
 			YDBLogError(@"(%@): Error enumerating page table: %d %s",
@@ -357,126 +317,196 @@
 		}
 		
 		sqlite3_finalize(statement);
-	}
-	else // if (isNonPersistentView)
-	{
-		[pageMetadataTableTransaction enumerateKeysAndObjectsWithBlock:^(id __unused key, id obj, BOOL __unused *stop) {
-			
-			YapDatabaseViewPageMetadata *pageMetadata = [(YapDatabaseViewPageMetadata *)obj copy];
+		statement = NULL;
+		
+		// Step 2 of 2: Fetch the largest pageId in use.
+		//
+		// New pageIds are handed out in increasing order,
+		// so we need to know this even though we haven't loaded the pages.
+		
+		if (!error)
+		{
+			NSString *maxPageIdString = [NSString stringWithFormat:
+			    @"SELECT MAX(\"pageId\") FROM \"%@\";", [self pageTableName]];
 			
-			NSMutableDictionary *pageDict = [groupPageDict objectForKey:pageMetadata->group];
-			if (pageDict == nil)
+			status = sqlite3_prepare_v2(db, [maxPageIdString UTF8String], -1, &statement, NULL);
+			if (status != SQLITE_OK)
 			{
-				pageDict = [[NSMutableDictionary alloc] init];
-				[groupPageDict setObject:pageDict forKey:pageMetadata->group];
+				YDBLogError(@"(%@): Cannot create 'maxPageId_stmt': %d %s",
+				            [self registeredName], status, sqlite3_errmsg(db));
+				return NO;
 			}
 			
-			NSMutableDictionary *orderDict = [groupOrderDict objectForKey:pageMetadata->group];
-			if (orderDict == nil)
+			status = sqlite3_step(statement);
+			if (status == SQLITE_ROW)
 			{
-				orderDict = [[NSMutableDictionary alloc] init];
-				[groupOrderDict setObject:orderDict forKey:pageMetadata->group];
+				int64_t maxPageId = sqlite3_column_int64(statement, SQLITE_COLUMN_START); // NULL => 0
+				
+				[newState reservePageIdsUpTo:maxPageId];
 			}
-			
-			[pageDict setObject:pageMetadata forKey:pageMetadata->pageKey];
-			
-			if (pageMetadata->prevPageKey)
-				[orderDict setObject:pageMetadata->pageKey forKey:pageMetadata->prevPageKey];
 			else
-				[orderDict setObject:pageMetadata->pageKey forKey:[NSNull null]];
-		}];
+			{
+				error = YES;
+				YDBLogError(@"(%@): Error fetching max pageId: %d %s",
+				            [self registeredName], status, sqlite3_errmsg(db));
+			}
+			
+			sqlite3_finalize(statement);
+		}
+		
+		if (error) {
+			return NO;
+		}
+		
+		parentConnection->state = newState;
+		
+		YDBLogVerbose(@"parentConnection->state: %@", parentConnection->state);
+		return YES;
 	}
 	
+	// Enumerate over the pages in the memory table, and populate our data structure.
+	// Each entry has the following information:
+	//
+	// - group
+	// - pageId
+	// - prevPageId
+	//
+	// From this information we need to piece together the group_pagesMetadata_dict:
+	// - dict.key = group
+	// - dict.value = properly ordered array of YapDatabaseViewKeyPageMetadata objects
+	//
+	// To piece together the proper page order we make a temporary dictionary with each link in the linked-list.
+	// For example:
+	//
+	// pageC.prevPage = pageB  =>      B -> C
+	// pageB.prevPage = pageA  =>      A -> B
+	// pageA.prevPage = 0      =>      0 -> A
+	//
+	// After the enumeration of all rows is complete, we can simply walk the linked list from the first page.
+	
+	NSMutableDictionary<NSString *, NSMutableDictionary *> *groupPageDict  = [[NSMutableDictionary alloc] init];
+	NSMutableDictionary<NSString *, NSMutableDictionary *> *groupOrderDict = [[NSMutableDictionary alloc] init];
+	
+	[pageMetadataTableTransaction enumerateKeysAndObjectsWithBlock:^(id __unused key, id obj, BOOL __unused *stop) {
+		
+		YapDatabaseViewPageMetadata *pageMetadata = [(YapDatabaseViewPageMetadata *)obj copy];
+		
+		NSMutableDictionary *pageDict = [groupPageDict objectForKey:pageMetadata->group];
+		if (pageDict == nil)
+		{
+			pageDict = [[NSMutableDictionary alloc] init];
+			[groupPageDict setObject:pageDict forKey:pageMetadata->group];
+		}
+		
+		NSMutableDictionary *orderDict = [groupOrderDict objectForKey:pageMetadata->group];
+		if (orderDict == nil)
+		{
+			orderDict = [[NSMutableDictionary alloc] init];
+			[groupOrderDict setObject:orderDict forKey:pageMetadata->group];
+		}
+		
+		[pageDict setObject:pageMetadata forKey:@(pageMetadata->pageId)];
+		[orderDict setObject:@(pageMetadata->pageId) forKey:@(pageMetadata->prevPageId)];
+	}];
+	
 	// Now that we have all the metadata about each page,
 	// it's time to piece them together in the proper order.
-
-	if (!error)
+	
+	YapDatabaseViewState *newState = [[YapDatabaseViewState alloc] init];
+	__block BOOL error = NO;
+	
+	[groupOrderDict enumerateKeysAndObjectsUsingBlock:
+	    ^(NSString *group, NSMutableDictionary *orderDict, BOOL *stop)
 	{
-		// Initialize ivars in viewConnection.
-		// We try not to do this before we know the table exists.
+	#pragma clang diagnostic push
+	#pragma clang diagnostic ignored "-Wimplicit-retain-self"
 		
-		parentConnection->state = [[YapDatabaseViewState alloc] init];
+		NSArray *pagesMetadataForGroup =
+		  [self orderedPagesMetadataForGroup:group pageDict:groupPageDict[group] orderDict:orderDict];
 		
-		// Enumerate over each group
+		if (pagesMetadataForGroup == nil)
+		{
+			error = YES;
+			*stop = YES;
+			return;//from block
+		}
 		
-		[groupOrderDict enumerateKeysAndObjectsUsingBlock:
-		    ^(NSString *group, NSMutableDictionary *orderDict, BOOL __unused *stop)
+		[newState createGroup:group withCapacity:[pagesMetadataForGroup count]];
+		
+		for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
 		{
-		#pragma clang diagnostic push
-		#pragma clang diagnostic ignored "-Wimplicit-retain-self"
-			
-			NSMutableDictionary *pageDict = [groupPageDict objectForKey:group];
-			
-			// Walk the linked-list to stitch together the pages for this section.
-			//
-			// NSNull -> firstPageKey
-			// firstPageKey -> secondPageKey
-			// ...
-			// secondToLastPageKey -> lastPageKey
-			//
-			// And from the keys, we can get the actual pageMetadata using the pageDict.
-			
-			NSUInteger pageCount = 0;
-			NSUInteger expectedPageCount = [orderDict count];
-			
-			[parentConnection->state createGroup:group withCapacity:expectedPageCount];
-			
-			NSString *pageKey = [orderDict objectForKey:[NSNull null]];
-			while (pageKey)
-			{
-				YapDatabaseViewPageMetadata *pageMetadata = [pageDict objectForKey:pageKey];
-				if (pageMetadata == nil)
-				{
-					YDBLogError(@"(%@): Invalid key ordering detected in group(%@)", [self registeredName], group);
-					
-					error = YES;
-					break;
-				}
-				
-				[parentConnection->state addPageMetadata:pageMetadata toGroup:group];
-				pageCount++;
-				
-				// get the next pageKey in the linked list
-				pageKey = [orderDict objectForKey:pageKey];
-				
-				// sanity check for circular linked list
-				if (pageCount > expectedPageCount)
-				{
-					YDBLogError(@"(%@): Circular key ordering detected in group(%@)", [self registeredName], group);
-					
-					error = YES;
-					break;
-				}
-			}
-			
-			// Validate data for this section
-			
-			if (!error && (pageCount != expectedPageCount))
-			{
-				YDBLogError(@"(%@): Missing key page(s) in group(%@)", [self registeredName], group);
-				
-				error = YES;
-			}
-			
-		#pragma clang diagnostic pop
-		}];
+			[newState addPageMetadata:pageMetadata toGroup:group];
+		}
+		
+	#pragma clang diagnostic pop
+	}];
+	
+	if (error) {
+		return NO;
 	}
 	
-	// Validate data
+	parentConnection->state = newState;
 	
-	if (error)
+	YDBLogVerbose(@"parentConnection->state: %@", parentConnection->state);
+	return YES;
+}
+
+/**
+ * Walks the linked-list of pages within a single group, and returns the properly ordered pagesMetadata.
+ *
+ * - pageDict  : pageId -> YapDatabaseViewPageMetadata
+ * - orderDict : prevPageId -> pageId
+ *
+ * Returns nil if the linked-list is broken (missing or circular pages).
+**/
+- (NSArray *)orderedPagesMetadataForGroup:(NSString *)group
+                                 pageDict:(NSDictionary<NSNumber *, YapDatabaseViewPageMetadata *> *)pageDict
+                                orderDict:(NSDictionary<NSNumber *, NSNumber *> *)orderDict
+{
+	// Walk the linked-list to stitch together the pages for this section.
+	//
+	// 0 -> firstPageId
+	// firstPageId -> secondPageId
+	// ...
+	// secondToLastPageId -> lastPageId
+	//
+	// And from the pageIds, we can get the actual pageMetadata using the pageDict.
+	
+	NSUInteger expectedPageCount = [orderDict count];
+	NSMutableArray *pagesMetadataForGroup = [[NSMutableArray alloc] initWithCapacity:expectedPageCount];
+	
+	NSNumber *pageId = [orderDict objectForKey:@(0)];
+	while (pageId)
 	{
-		// If there was an error opening the view, we need to reset the ivars to nil.
-		// These are checked at the beginning of this method as a shortcut.
+		YapDatabaseViewPageMetadata *pageMetadata = [pageDict objectForKey:pageId];
+		if (pageMetadata == nil)
+		{
+			YDBLogError(@"(%@): Invalid key ordering detected in group(%@)", [self registeredName], group);
+			return nil;
+		}
+		
+		[pagesMetadataForGroup addObject:pageMetadata];
 		
-		parentConnection->state = nil;
+		// get the next pageId in the linked list
+		pageId = [orderDict objectForKey:pageId];
+		
+		// sanity check for circular linked list
+		if ([pagesMetadataForGroup count] > expectedPageCount)
+		{
+			YDBLogError(@"(%@): Circular key ordering detected in group(%@)", [self registeredName], group);
+			return nil;
+		}
 	}
-	else
+	
+	// Validate data for this section
+	
+	if ([pagesMetadataForGroup count] != expectedPageCount)
 	{
-		YDBLogVerbose(@"parentConnection->state: %@", parentConnection->state);
+		YDBLogError(@"(%@): Missing key page(s) in group(%@)", [self registeredName], group);
+		return nil;
 	}
 	
-	return !error;
+	return pagesMetadataForGroup;
 }
 
 /**
@@ -527,6 +557,128 @@
 			            dropPageTable, status, sqlite3_errmsg(db));
 		}
 	}
+	
+	if (oldClassVersion == 2 || oldClassVersion == 3)
+	{
+		// In version 4, we switched from string pageKeys to integer pageIds.
+		// Both the 'view_name_map' and 'view_name_page' tables changed their column types.
+		//
+		// We only get here if we were unable to migrate the tables in place.
+		
+		sqlite3 *db = databaseTransaction->connection->db;
+		
+		NSString *dropMapTable = [NSString stringWithFormat:@"DROP TABLE IF EXISTS \"%@\";", [self mapTableName]];
+		NSString *dropPageTable = [NSString stringWithFormat:@"DROP TABLE IF EXISTS \"%@\";", [self pageTableName]];
+		
+		int status;
+		
+		status = sqlite3_exec(db, [dropMapTable UTF8String], NULL, NULL, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogError(@"Failed dropping old map table (%@): %d %s",
+			            dropMapTable, status, sqlite3_errmsg(db));
+		}
+		
+		status = sqlite3_exec(db, [dropPageTable UTF8String], NULL, NULL, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogError(@"Failed dropping old page table (%@): %d %s",
+			            dropPageTable, status, sqlite3_errmsg(db));
+		}
+	}
+}
+
+/**
+ * Codebase upgrade helper.
+ *
+ * Attempts to convert the tables from an older class version into the current format,
+ * without having to re-populate the view (which requires invoking the grouping/sorting blocks for every row).
+ *
+ * Returns YES if the tables were migrated.
+ * Returns NO if migration isn't supported for the given version, or if an error occurred.
+ * In which case the caller should fallback to dropping the tables & re-populating the view.
+**/
+- (BOOL)migrateTablesFromOldClassVersion:(int)oldClassVersion
+{
+	YDBLogAutoTrace();
+	
+	if (oldClassVersion != 3) return NO;
+	
+	// In version 4, we switched from string pageKeys to integer pageIds.
+	//
+	// The old page table was declared with a CHAR primary key, so every page already has an integer rowid.
+	// We simply use that rowid as the new pageId, and translate the prevPageKey & map table pointers to match.
+	
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	NSString *mapTableName = [self mapTableName];
+	NSString *pageTableName = [self pageTableName];
+	
+	NSString *newMapTableName = [mapTableName stringByAppendingString:@"_v4"];
+	NSString *newPageTableName = [pageTableName stringByAppendingString:@"_v4"];
+	
+	NSArray<NSString *> *statements = @[
+	
+	  [NSString stringWithFormat:@"DROP TABLE IF EXISTS \"%@\";", newMapTableName],
+	  [NSString stringWithFormat:@"DROP TABLE IF EXISTS \"%@\";", newPageTableName],
+	
+	  [NSString stringWithFormat:
+	    @"CREATE TABLE \"%@\""
+	    @" (\"rowid\" INTEGER PRIMARY KEY,"
+	    @"  \"pageId\" INTEGER NOT NULL"
+	    @" ) WITHOUT ROWID;", newMapTableName],
+	
+	  [NSString stringWithFormat:
+	    @"CREATE TABLE \"%@\""
+	    @" (\"pageId\" INTEGER PRIMARY KEY,"
+	    @"  \"group\" CHAR NOT NULL,"
+	    @"  \"prevPageId\" INTEGER,"
+	    @"  \"count\" INTEGER,"
+	    @"  \"data\" BLOB"
+	    @" );", newPageTableName],
+	
+	  [NSString stringWithFormat:
+	    @"INSERT INTO \"%@\" (\"pageId\", \"group\", \"prevPageId\", \"count\", \"data\")"
+	    @" SELECT \"page\".\"rowid\", \"page\".\"group\", \"prev\".\"rowid\", \"page\".\"count\", \"page\".\"data\""
+	    @" FROM \"%@\" AS \"page\""
+	    @" LEFT JOIN \"%@\" AS \"prev\" ON \"prev\".\"pageKey\" = \"page\".\"prevPageKey\";",
+	    newPageTableName, pageTableName, pageTableName],
+	
+	  [NSString stringWithFormat:
+	    @"INSERT INTO \"%@\" (\"rowid\", \"pageId\")"
+	    @" SELECT \"map\".\"rowid\", \"page\".\"rowid\""
+	    @" FROM \"%@\" AS \"map\""
+	    @" INNER JOIN \"%@\" AS \"page\" ON \"page\".\"pageKey\" = \"map\".\"pageKey\";",
+	    newMapTableName, mapTableName, pageTableName],
+	
+	  [NSString stringWithFormat:@"DROP TABLE \"%@\";", mapTableName],
+	  [NSString stringWithFormat:@"DROP TABLE \"%@\";", pageTableName],
+	
+	  [NSString stringWithFormat:@"ALTER TABLE \"%@\" RENAME TO \"%@\";", newMapTableName, mapTableName],
+	  [NSString stringWithFormat:@"ALTER TABLE \"%@\" RENAME TO \"%@\";", newPageTableName, pageTableName],
+	];
+	
+	for (NSString *statement in statements)
+	{
+		int status = sqlite3_exec(db, [statement UTF8String], NULL, NULL, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogWarn(@"(%@): Unable to migrate view tables from classVersion %d: %d %s",
+			           [self registeredName], oldClassVersion, status, sqlite3_errmsg(db));
+			
+			NSString *dropNewMapTable =
+			  [NSString stringWithFormat:@"DROP TABLE IF EXISTS \"%@\";", newMapTableName];
+			NSString *dropNewPageTable =
+			  [NSString stringWithFormat:@"DROP TABLE IF EXISTS \"%@\";", newPageTableName];
+			
+			sqlite3_exec(db, [dropNewMapTable UTF8String], NULL, NULL, NULL);
+			sqlite3_exec(db, [dropNewPageTable UTF8String], NULL, NULL, NULL);
+			
+			return NO;
+		}
+	}
+	
+	return YES;
 }
 
 /**
@@ -547,17 +699,20 @@
 		YDBLogVerbose(@"Creating view tables for registeredName(%@): %@, %@",
 		              [self registeredName], mapTableName, pageTableName);
 		
+		// The map table is declared WITHOUT ROWID.
+		// Both columns are integers, so the (rowid -> pageId) pairs are stored directly in the b-tree leaves.
+		
 		NSString *createMapTable = [NSString stringWithFormat:
 		    @"CREATE TABLE IF NOT EXISTS \"%@\""
 		    @" (\"rowid\" INTEGER PRIMARY KEY,"
-		    @"  \"pageKey\" CHAR NOT NULL"
-		    @" );", mapTableName];
+		    @"  \"pageId\" INTEGER NOT NULL"
+		    @" ) WITHOUT ROWID;", mapTableName];
 		
 		NSString *createPageTable = [NSString stringWithFormat:
 		    @"CREATE TABLE IF NOT EXISTS \"%@\""
-		    @" (\"pageKey\" CHAR NOT NULL PRIMARY KEY,"
+		    @" (\"pageId\" INTEGER PRIMARY KEY,"
 		    @"  \"group\" CHAR NOT NULL,"
-		    @"  \"prevPageKey\" CHAR,"
+		    @"  \"prevPageId\" INTEGER,"
 		    @"  \"count\" INTEGER,"
 		    @"  \"data\" BLOB"
 		    @" );", pageTableName];
@@ -578,7 +733,7 @@
 			return NO;
 		}
 		
-		return YES;
+		return [self createPageTableIndex];
 	}
 	else // if (isNonPersistentView)
 	{
@@ -587,8 +742,8 @@
 		NSString *pageMetadataTableName = [self pageMetadataTableName];
 		
 		YapMemoryTable *mapTable = [[YapMemoryTable alloc] initWithKeyClass:[NSNumber class]];
-		YapMemoryTable *pageTable = [[YapMemoryTable alloc] initWithKeyClass:[NSString class]];
-		YapMemoryTable *pageMetadataTable = [[YapMemoryTable alloc] initWithKeyClass:[NSString class]];
+		YapMemoryTable *pageTable = [[YapMemoryTable alloc] initWithKeyClass:[NSNumber class]];
+		YapMemoryTable *pageMetadataTable = [[YapMemoryTable alloc] initWithKeyClass:[NSNumber class]];
 		
 		if (![databaseTransaction->connection registerMemoryTable:mapTable withName:mapTableName])
 		{
@@ -616,6 +771,35 @@
 	}
 }
 
+/**
+ * The page metadata for each group is loaded lazily (see pagesMetadataForGroup:).
+ * This index allows us to fetch the pages for a single group without scanning the entire page table.
+ *
+ * The index also covers the prevPageId & count columns.
+ * So neither loading a group, nor counting the items in each group (prepareIfNeeded), needs to touch the page data.
+**/
+- (BOOL)createPageTableIndex
+{
+	YDBLogAutoTrace();
+	
+	sqlite3 *db = databaseTransaction->connection->db;
+	
+	NSString *pageTableName = [self pageTableName];
+	
+	NSString *createIndex = [NSString stringWithFormat:
+	    @"CREATE INDEX IF NOT EXISTS \"%@_group\" ON \"%@\" (\"group\", \"prevPageId\", \"count\");",
+	    pageTableName, pageTableName];
+	
+	int status = sqlite3_exec(db, [createIndex UTF8String], NULL, NULL, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Failed creating index on page table (%@): %d %s", pageTableName, status, sqlite3_errmsg(db));
+		return NO;
+	}
+	
+	return YES;
+}
+
 /**
  * Method designed for subclasses to override.
 **/
@@ -692,64 +876,64 @@
 #pragma mark Utilities
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-- (NSString *)generatePageKey
+- (int64_t)generatePageId
 {
-	return [[NSUUID UUID] UUIDString];
+	return [parentConnection->state generatePageId];
 }
 
 /**
- * If the given rowid is in the view, returns the associated pageKey.
+ * If the given rowid is in the view, returns the associated pageId.
+ * Otherwise returns zero.
  *
  * This method will use the cache(s) if possible.
  * Otherwise it will lookup the value in the map table.
 **/
-- (NSString *)pageKeyForRowid:(int64_t)rowid
+- (int64_t)pageIdForRowid:(int64_t)rowid
 {
-	NSString *pageKey = nil;
+	NSNumber *pageId = nil;
 	NSNumber *rowidNumber = @(rowid);
 	
 	// Check dirty cache & clean cache
 	
-	pageKey = [parentConnection->dirtyMaps objectForKey:rowidNumber];
-	if (pageKey)
+	pageId = [parentConnection->dirtyMaps objectForKey:rowidNumber];
+	if (pageId)
 	{
-		if ((id)pageKey == (id)[NSNull null])
-			return nil;
+		if ((id)pageId == (id)[NSNull null])
+			return 0;
 		else
-			return pageKey;
+			return [pageId longLongValue];
 	}
 	
-	pageKey = [parentConnection->mapCache objectForKey:rowidNumber];
-	if (pageKey)
+	pageId = [parentConnection->mapCache objectForKey:rowidNumber];
+	if (pageId)
 	{
-		if ((id)pageKey == (id)[NSNull null])
-			return nil;
+		if ((id)pageId == (id)[NSNull null])
+			return 0;
 		else
-			return pageKey;
+			return [pageId longLongValue];
 	}
 	
 	// Otherwise pull from the database
 	
+	int64_t result = 0;
+	
 	if ([self isPersistentView])
 	{
-		sqlite3_stmt *statement = [parentConnection mapTable_getPageKeyForRowidStatement];
+		sqlite3_stmt *statement = [parentConnection mapTable_getPageIdForRowidStatement];
 		if (statement == NULL)
-			return nil;
+			return 0;
 		
-		// SELECT "pageKey" FROM "mapTableName" WHERE "rowid" = ? ;
+		// SELECT "pageId" FROM "mapTableName" WHERE "rowid" = ? ;
 		
-		int const column_idx_pageKey = SQLITE_COLUMN_START;
-		int const bind_idx_rowid     = SQLITE_BIND_START;
+		int const column_idx_pageId = SQLITE_COLUMN_START;
+		int const bind_idx_rowid    = SQLITE_BIND_START;
 		
 		sqlite3_bind_int64(statement, bind_idx_rowid, rowid);
 		
 		int status = sqlite3_step(statement);
 		if (status == SQLITE_ROW)
 		{
-			const unsigned char *text = sqlite3_column_text(statement, column_idx_pageKey);
-			int textSize = sqlite3_column_bytes(statement, column_idx_pageKey);
-			
-			pageKey = [[NSString alloc] initWithBytes:text length:textSize encoding:NSUTF8StringEncoding];
+			result = sqlite3_column_int64(statement, column_idx_pageId);
 		}
 		else if (status == SQLITE_ERROR)
 		{
@@ -763,50 +947,50 @@
 	}
 	else // if (isNonPersistentView)
 	{
-		pageKey = [mapTableTransaction objectForKey:rowidNumber];
+		result = [[mapTableTransaction objectForKey:rowidNumber] longLongValue];
 	}
 	
-	if (pageKey)
-		[parentConnection->mapCache setObject:pageKey forKey:rowidNumber];
+	if (result != 0)
+		[parentConnection->mapCache setObject:@(result) forKey:rowidNumber];
 	else
 		[parentConnection->mapCache setObject:[NSNull null] forKey:rowidNumber];
 	
-	return pageKey;
+	return result;
 }
 
 /**
- * Fetches the page for the given pageKey.
+ * Fetches the page for the given pageId.
  * 
  * This method will use the cache(s) if possible.
  * Otherwise it will load the data from the page table and deserialize it.
 **/
-- (YapDatabaseViewPage *)pageForPageKey:(NSString *)pageKey
+- (YapDatabaseViewPage *)pageForPageId:(int64_t)pageId
 {
 	YapDatabaseViewPage *page = nil;
+	NSNumber *pageIdNumber = @(pageId);
 	
 	// Check dirty cache & clean cache
 	
-	page = [parentConnection->dirtyPages objectForKey:pageKey];
+	page = [parentConnection->dirtyPages objectForKey:pageIdNumber];
 	if (page) return page;
 	
-	page = [parentConnection->pageCache objectForKey:pageKey];
+	page = [parentConnection->pageCache objectForKey:pageIdNumber];
 	if (page) return page;
 	
 	// Otherwise pull from the database
 	
 	if ([self isPersistentView])
 	{
-		sqlite3_stmt *statement = [parentConnection pageTable_getDataForPageKeyStatement];
+		sqlite3_stmt *statement = [parentConnection pageTable_getDataForPageIdStatement];
 		if (statement == NULL)
 			return nil;
 		
-		// SELECT "data" FROM 'pageTableName' WHERE pageKey = ? ;
+		// SELECT "data" FROM 'pageTableName' WHERE pageId = ? ;
 		
-		int const column_idx_data  = SQLITE_COLUMN_START;
-		int const bind_idx_pageKey = SQLITE_BIND_START;
+		int const column_idx_data = SQLITE_COLUMN_START;
+		int const bind_idx_pageId = SQLITE_BIND_START;
 		
-		YapDatabaseString _pageKey; MakeYapDatabaseString(&_pageKey, pageKey);
-		sqlite3_bind_text(statement, bind_idx_pageKey, _pageKey.str, _pageKey.length, SQLITE_STATIC);
+		sqlite3_bind_int64(statement, bind_idx_pageId, pageId);
 		
 		int status = sqlite3_step(statement);
 		if (status == SQLITE_ROW)
@@ -827,30 +1011,173 @@
 		
 		sqlite3_clear_bindings(statement);
 		sqlite3_reset(statement);
-		FreeYapDatabaseString(&_pageKey);
 	}
 	else // if (isNonPersistentView)
 	{
-		page = [[pageTableTransaction objectForKey:pageKey] copy];
+		page = [[pageTableTransaction objectForKey:pageIdNumber] copy];
 	}
 	
 	// Store in cache if found
 	if (page)
-		[parentConnection->pageCache setObject:page forKey:pageKey];
+		[parentConnection->pageCache setObject:page forKey:pageIdNumber];
 	
 	return page;
 }
 
-- (NSUInteger)indexForRowid:(int64_t)rowid inGroup:(NSString *)group withPageKey:(NSString *)pageKey
+/**
+ * Returns the properly ordered pagesMetadata for the given group, or nil if the group doesn't exist.
+ *
+ * Persistent views load the pagesMetadata for a group lazily, on first access.
+ * So all access to the pagesMetadata should go through this method (as opposed to the state directly).
+**/
+- (NSArray *)pagesMetadataForGroup:(NSString *)group
+{
+	if (group == nil) return nil;
+	
+	YapDatabaseViewState *state = parentConnection->state;
+	
+	NSArray *pagesMetadataForGroup = [state pagesMetadataForGroup:group];
+	if (pagesMetadataForGroup) return pagesMetadataForGroup;
+	
+	if (![state needsLoadForGroup:group]) return nil;
+	
+	// Load the pagesMetadata from the page table.
+	// Each row has the following information:
+	//
+	// - pageId
+	// - prevPageId
+	// - count
+	//
+	// We piece together the proper page order by walking the linked list (same as prepareIfNeeded).
+	
+	sqlite3_stmt *statement = [parentConnection pageTable_getMetadataForGroupStatement];
+	if (statement == NULL)
+		return nil;
+	
+	// SELECT "pageId", "prevPageId", "count" FROM "pageTableName" WHERE "group" = ?;
+	
+	int const column_idx_pageId     = SQLITE_COLUMN_START + 0;
+	int const column_idx_prevPageId = SQLITE_COLUMN_START + 1;
+	int const column_idx_count      = SQLITE_COLUMN_START + 2;
+	int const bind_idx_group        = SQLITE_BIND_START;
+	
+	YapDatabaseString _group; MakeYapDatabaseString(&_group, group);
+	sqlite3_bind_text(statement, bind_idx_group, _group.str, _group.length, SQLITE_STATIC);
+	
+	NSMutableDictionary<NSNumber *, YapDatabaseViewPageMetadata *> *pageDict = [[NSMutableDictionary alloc] init];
+	NSMutableDictionary<NSNumber *, NSNumber *> *orderDict = [[NSMutableDictionary alloc] init];
+	
+	int status;
+	while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+	{
+		int64_t pageId = sqlite3_column_int64(statement, column_idx_pageId);
+		int64_t prevPageId = sqlite3_column_int64(statement, column_idx_prevPageId); // NULL => 0
+		int count = sqlite3_column_int(statement, column_idx_count);
+		
+		if (count >= 0)
+		{
+			YapDatabaseViewPageMetadata *pageMetadata = [[YapDatabaseViewPageMetadata alloc] init];
+			pageMetadata->pageId = pageId;
+			pageMetadata->group = group;
+			pageMetadata->prevPageId = prevPageId;
+			pageMetadata->count = (NSUInteger)count;
+			
+			[pageDict setObject:pageMetadata forKey:@(pageId)];
+			[orderDict setObject:@(pageId) forKey:@(prevPageId)];
+		}
+		else
+		{
+			YDBLogWarn(@"(%@): Encountered invalid count: %d", [self registeredName], count);
+		}
+	}
+	
+	if (status != SQLITE_DONE)
+	{
+		YDBLogError(@"(%@): Error executing statement: %d %s",
+		            [self registeredName],
+		            status, sqlite3_errmsg(databaseTransaction->connection->db));
+	}
+	
+	sqlite3_clear_bindings(statement);
+	sqlite3_reset(statement);
+	FreeYapDatabaseString(&_group);
+	
+	if (status != SQLITE_DONE) {
+		return nil;
+	}
+	
+	pagesMetadataForGroup = [self orderedPagesMetadataForGroup:group pageDict:pageDict orderDict:orderDict];
+	if (pagesMetadataForGroup == nil) {
+		return nil;
+	}
+	
+	// Note: If another connection sharing this (immutable) state loaded the group first,
+	// then the state returns the previously loaded pagesMetadata (which are equivalent).
+	
+	return [state didLoadPagesMetadata:pagesMetadataForGroup forGroup:group];
+}
+
+/**
+ * Returns the group for the given pageId.
+ *
+ * If the page belongs to a group that hasn't been loaded yet,
+ * then the group is looked up in the page table, and its pagesMetadata are loaded.
+**/
+- (NSString *)groupForPageId:(int64_t)pageId
+{
+	NSString *group = [parentConnection->state groupForPageId:pageId];
+	if (group || ![self isPersistentView]) return group;
+	
+	sqlite3_stmt *statement = [parentConnection pageTable_getGroupForPageIdStatement];
+	if (statement == NULL)
+		return nil;
+	
+	// SELECT "group" FROM "pageTableName" WHERE "pageId" = ?;
+	
+	int const column_idx_group = SQLITE_COLUMN_START;
+	int const bind_idx_pageId  = SQLITE_BIND_START;
+	
+	sqlite3_bind_int64(statement, bind_idx_pageId, pageId);
+	
+	int status = sqlite3_step(statement);
+	if (status == SQLITE_ROW)
+	{
+		const unsigned char *text = sqlite3_column_text(statement, column_idx_group);
+		int textSize = sqlite3_column_bytes(statement, column_idx_group);
+		
+		group = [[NSString alloc] initWithBytes:text length:textSize encoding:NSUTF8StringEncoding];
+	}
+	else if (status == SQLITE_ERROR)
+	{
+		YDBLogError(@"(%@): Error executing statement: %d %s",
+		            [self registeredName],
+		            status, sqlite3_errmsg(databaseTransaction->connection->db));
+	}
+	
+	sqlite3_clear_bindings(statement);
+	sqlite3_reset(statement);
+	
+	// The page may have been dropped within this transaction (or belong to a group that no longer exists).
+	// So we only return the group if its metadata actually contains the page.
+	
+	if (group && [self pagesMetadataForGroup:group])
+	{
+		return [parentConnection->state groupForPageId:pageId];
+	}
+	
+	return nil;
+}
+
+- (NSUInteger)indexForRowid:(int64_t)rowid inGroup:(NSString *)group withPageId:(int64_t)pageId
 {
 	// Calculate the offset of the corresponding page within the group.
 	
 	NSUInteger pageOffset = 0;
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+	NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 	
 	for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
 	{
-		if ([pageMetadata->pageKey isEqualToString:pageKey])
+		if (pageMetadata->pageId == pageId)
 		{
 			break;
 		}
@@ -860,7 +1187,7 @@
 	
 	// Fetch the actual page (ordered array of rowid's)
 	
-	YapDatabaseViewPage *page = [self pageForPageKey:pageKey];
+	YapDatabaseViewPage *page = [self pageForPageId:pageId];
 	
 	// Find the exact index of the rowid within the page
 	
@@ -881,27 +1208,30 @@
 
 - (BOOL)containsRowid:(int64_t)rowid
 {
-	return ([self pageKeyForRowid:rowid] != nil);
+	return ([self pageIdForRowid:rowid] != 0);
 }
 
 - (NSString *)groupForRowid:(int64_t)rowid
 {
-	return [parentConnection->state groupForPageKey:[self pageKeyForRowid:rowid]];
+	int64_t pageId = [self pageIdForRowid:rowid];
+	if (pageId == 0) return nil;
+	
+	return [self groupForPageId:pageId];
 }
 
 - (YapDatabaseViewLocator *)locatorForRowid:(int64_t)rowid
 {
 	YapDatabaseViewLocator *locator = nil;
 	
-	NSString *pageKey = [self pageKeyForRowid:rowid];
-	if (pageKey)
+	int64_t pageId = [self pageIdForRowid:rowid];
+	if (pageId != 0)
 	{
-		NSString *group = [parentConnection->state groupForPageKey:pageKey];
+		NSString *group = [self groupForPageId:pageId];
 		if (group)
 		{
-			NSUInteger index = [self indexForRowid:rowid inGroup:group withPageKey:pageKey];
+			NSUInteger index = [self indexForRowid:rowid inGroup:group withPageId:pageId];
 			
-			locator = [[YapDatabaseViewLocator alloc] initWithGroup:group index:index pageKey:pageKey];
+			locator = [[YapDatabaseViewLocator alloc] initWithGroup:group index:index pageId:pageId];
 		}
 	}
 	
@@ -937,36 +1267,36 @@
 			return [NSDictionary dictionary];
 	}
 	
-	NSMutableDictionary *pageKeys = [NSMutableDictionary dictionaryWithCapacity:rowids.count];
+	NSMutableDictionary<NSNumber *, NSNumber *> *pageIds = [NSMutableDictionary dictionaryWithCapacity:rowids.count];
 	NSMutableArray *remainingRowids = [NSMutableArray arrayWithCapacity:rowids.count];
 	
 	// Step 1 of 3:
 	//
-	// Check for any (rowid -> pageKey) information we already have in memory.
+	// Check for any (rowid -> pageId) information we already have in memory.
 	//
 	// This is actually a requirement if the information is in dirtyMaps.
 	// If the info is in mapCache, then its just an optimization.
 	
 	for (NSNumber *rowidNumber in rowids)
 	{
-		NSString *pageKey = nil;
+		NSNumber *pageId = nil;
 		
-		pageKey = [parentConnection->dirtyMaps objectForKey:rowidNumber];
-		if (pageKey == nil)
+		pageId = [parentConnection->dirtyMaps objectForKey:rowidNumber];
+		if (pageId == nil)
 		{
-			pageKey = [parentConnection->mapCache objectForKey:rowidNumber];
+			pageId = [parentConnection->mapCache objectForKey:rowidNumber];
 		}
 		
-		if (pageKey)
+		if (pageId)
 		{
-			if ((id)pageKey == (id)[NSNull null])
+			if ((id)pageId == (id)[NSNull null])
 			{
 				// This rowid has already been removed from the view,
 				// and is marked for deletion from the mapTable.
 			}
 			else
 			{
-				pageKeys[rowidNumber] = pageKey;
+				pageIds[rowidNumber] = pageId;
 			}
 		}
 		else
@@ -978,7 +1308,7 @@
 	
 	// Step 2 of 3:
 	//
-	// Fetch any pageKey information we're still missing from the database.
+	// Fetch any pageId information we're still missing from the database.
 	
 	if ([self isPersistentView])
 	{
@@ -992,15 +1322,15 @@
 			
 			NSUInteger count = MIN(remainingRowids.count, maxHostParams);
 			
-			// SELECT "rowid", "pageKey" FROM "mapTableName" WHERE "rowid" IN (?, ?, ...);
+			// SELECT "rowid", "pageId" FROM "mapTableName" WHERE "rowid" IN (?, ?, ...);
 			
-			int const column_idx_rowid   = SQLITE_COLUMN_START + 0;
-			int const column_idx_pageKey = SQLITE_COLUMN_START + 1;
+			int const column_idx_rowid  = SQLITE_COLUMN_START + 0;
+			int const column_idx_pageId = SQLITE_COLUMN_START + 1;
 			
 			NSUInteger capacity = 50 + (count * 3);
 			NSMutableString *query = [NSMutableString stringWithCapacity:capacity];
 			
-			[query appendFormat:@"SELECT \"rowid\", \"pageKey\" FROM \"%@\" WHERE \"rowid\" IN (", [self mapTableName]];
+			[query appendFormat:@"SELECT \"rowid\", \"pageId\" FROM \"%@\" WHERE \"rowid\" IN (", [self mapTableName]];
 			
 			for (NSUInteger i = 0; i < count; i++)
 			{
@@ -1035,18 +1365,14 @@
 			
 			while ((status = sqlite3_step(statement)) == SQLITE_ROW)
 			{
-				// Extract rowid & pageKey from row
+				// Extract rowid & pageId from row
 				
 				int64_t rowid = sqlite3_column_int64(statement, column_idx_rowid);
-				
-				const unsigned char *text = sqlite3_column_text(statement, column_idx_pageKey);
-				int textSize = sqlite3_column_bytes(statement, column_idx_pageKey);
-				
-				NSString *pageKey = [[NSString alloc] initWithBytes:text length:textSize encoding:NSUTF8StringEncoding];
+				int64_t pageId = sqlite3_column_int64(statement, column_idx_pageId);
 				
 				// Add to result dictionary
 				
-				pageKeys[@(rowid)] = pageKey;
+				pageIds[@(rowid)] = @(pageId);
 			}
 			
 			if (status != SQLITE_DONE)
@@ -1071,12 +1397,12 @@
 				
 				for (NSNumber *rowidNumber in remainingRowids)
 				{
-					NSString *pageKey = [mapTableTransaction objectForKey:rowidNumber];
-					if (pageKey)
+					NSNumber *pageId = [mapTableTransaction objectForKey:rowidNumber];
+					if (pageId)
 					{
 						// Add to result dictionary
 						
-						pageKeys[rowidNumber] = pageKey;
+						pageIds[rowidNumber] = pageId;
 					}
 				}
 				
@@ -1087,27 +1413,27 @@
 	
 	// Step 3 of 3
 	//
-	// Use the pageKey mappings to create the locators.
+	// Use the pageId mappings to create the locators.
 	//
 	// In order to do this, we'll need to fetch the page for each rowid.
 	// And since many of the rowids may share the same page,
-	// we'll optimize the IO by sorting rowids by pageKey first.
+	// we'll optimize the IO by sorting rowids by pageId first.
 	
-	NSMutableDictionary *result = [NSMutableDictionary dictionaryWithCapacity:pageKeys.count];
+	NSMutableDictionary *result = [NSMutableDictionary dictionaryWithCapacity:pageIds.count];
 	
-	NSArray *sortedRowids = [pageKeys keysSortedByValueUsingSelector:@selector(compare:)];
+	NSArray *sortedRowids = [pageIds keysSortedByValueUsingSelector:@selector(compare:)];
 	for (NSNumber *rowidNumber in sortedRowids)
 	{
-		NSString *pageKey = pageKeys[rowidNumber];
+		int64_t pageId = [pageIds[rowidNumber] longLongValue];
 		
-		NSString *group = [parentConnection->state groupForPageKey:pageKey];
+		NSString *group = [self groupForPageId:pageId];
 		if (group)
 		{
 			int64_t rowid = [rowidNumber longLongValue];
-			NSUInteger index = [self indexForRowid:rowid inGroup:group withPageKey:pageKey];
+			NSUInteger index = [self indexForRowid:rowid inGroup:group withPageId:pageId];
 			
 			YapDatabaseViewLocator *locator =
-			  [[YapDatabaseViewLocator alloc] initWithGroup:group index:index pageKey:pageKey];
+			  [[YapDatabaseViewLocator alloc] initWithGroup:group index:index pageId:pageId];
 			
 			result[rowidNumber] = locator;
 		}
@@ -1118,14 +1444,14 @@
 
 - (BOOL)getRowid:(int64_t *)rowidPtr atIndex:(NSUInteger)index inGroup:(NSString *)group
 {
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+	NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 	NSUInteger pageOffset = 0;
 	
 	for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
 	{
 		if ((index < (pageOffset + pageMetadata->count)) && (pageMetadata->count > 0))
 		{
-			YapDatabaseViewPage *page = [self pageForPageKey:pageMetadata->pageKey];
+			YapDatabaseViewPage *page = [self pageForPageId:pageMetadata->pageId];
 			
 			int64_t rowid = [page rowidAtIndex:(index - pageOffset)];
 			
@@ -1152,7 +1478,7 @@
 	// else
 	//     return nil;
 	
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+	NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 	
 	__block int64_t rowid = 0;
 	__block BOOL found = NO;
@@ -1164,7 +1490,7 @@
 		
 		if (pageMetadata->count > 0)
 		{
-			YapDatabaseViewPage *lastPage = [self pageForPageKey:pageMetadata->pageKey];
+			YapDatabaseViewPage *lastPage = [self pageForPageId:pageMetadata->pageId];
 			
 			rowid = [lastPage rowidAtIndex:(pageMetadata->count - 1)];
 			found = YES;
@@ -1199,20 +1525,20 @@
 	NSParameterAssert(collectionKey != nil);
 	NSParameterAssert(group != nil);
 	
-	// Find pageMetadata, pageKey and page
+	// Find pageMetadata, pageId and page
 	
 	YapDatabaseViewPageMetadata *pageMetadata = nil;
 	
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+	NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 	
 	if (pagesMetadataForGroup == nil)
 	{
 		// First object added to group.
 		
-		NSString *pageKey = [self generatePageKey];
+		int64_t pageId = [self generatePageId];
 		
-		YDBLogVerbose(@"Inserting key(%@) collection(%@) in new group(%@) with page(%@)",
-					  collectionKey.key, collectionKey.collection, group, pageKey);
+		YDBLogVerbose(@"Inserting key(%@) collection(%@) in new group(%@) with page(%lld)",
+					  collectionKey.key, collectionKey.collection, group, pageId);
 		
 		// Create page
 		
@@ -1223,8 +1549,8 @@
 		// Create pageMetadata
 		
 		pageMetadata = [[YapDatabaseViewPageMetadata alloc] init];
-		pageMetadata->pageKey = pageKey;
-		pageMetadata->prevPageKey = nil;
+		pageMetadata->pageId = pageId;
+		pageMetadata->prevPageId = 0;
 		pageMetadata->group = group;
 		pageMetadata->count = 1;
 		pageMetadata->isNew = YES;
@@ -1236,13 +1562,13 @@
 		
 		// Mark page as dirty
 		
-		[parentConnection->dirtyPages setObject:page forKey:pageKey];
-		[parentConnection->pageCache setObject:page forKey:pageKey];
+		[parentConnection->dirtyPages setObject:page forKey:@(pageId)];
+		[parentConnection->pageCache setObject:page forKey:@(pageId)];
 		
 		// Mark map as dirty
 		
-		[parentConnection->dirtyMaps setObject:pageKey forKey:@(rowid) withPreviousValue:nil];
-		[parentConnection->mapCache setObject:pageKey forKey:@(rowid)];
+		[parentConnection->dirtyMaps setObject:@(pageId) forKey:@(rowid) withPreviousValue:nil];
+		[parentConnection->mapCache setObject:@(pageId) forKey:@(rowid)];
 		
 		// Add change to log
 		
@@ -1301,12 +1627,12 @@
 		
 		NSAssert(pageMetadata != nil, @"Missing pageMetadata in group(%@)", group);
 		
-		NSString *pageKey = pageMetadata->pageKey;
-		YapDatabaseViewPage *page = [self pageForPageKey:pageKey];
+		int64_t pageId = pageMetadata->pageId;
+		YapDatabaseViewPage *page = [self pageForPageId:pageId];
 		
-		YDBLogVerbose(@"Inserting key(%@) collection(%@) in group(%@) at index(%lu) with page(%@) pageOffset(%lu)",
+		YDBLogVerbose(@"Inserting key(%@) collection(%@) in group(%@) at index(%lu) with page(%lld) pageOffset(%lu)",
 		              collectionKey.key, collectionKey.collection, group,
-		              (unsigned long)index, pageKey, (unsigned long)(index - pageOffset));
+		              (unsigned long)index, pageId, (unsigned long)(index - pageOffset));
 		
 		// Update page (insert rowid)
 		
@@ -1318,13 +1644,13 @@
 		
 		// Mark page as dirty
 		
-		[parentConnection->dirtyPages setObject:page forKey:pageKey];
-		[parentConnection->pageCache setObject:page forKey:pageKey];
+		[parentConnection->dirtyPages setObject:page forKey:@(pageId)];
+		[parentConnection->pageCache setObject:page forKey:@(pageId)];
 		
 		// Mark map as dirty
 		
-		[parentConnection->dirtyMaps setObject:pageKey forKey:@(rowid)  withPreviousValue:nil];
-		[parentConnection->mapCache setObject:pageKey forKey:@(rowid)];
+		[parentConnection->dirtyMaps setObject:@(pageId) forKey:@(rowid)  withPreviousValue:nil];
+		[parentConnection->mapCache setObject:@(pageId) forKey:@(rowid)];
 		
 		// Add change to log
 		
@@ -1345,7 +1671,7 @@
 		
 		if ([page count] > trigger)
 		{
-			[self splitOversizedPage:page withPageKey:pageKey toSize:target];
+			[self splitOversizedPage:page withPageId:pageId toSize:target];
 		}
 	}
 }
@@ -1391,7 +1717,7 @@
 	    collectionKey:collectionKey
 	          atIndex:index
 	          inGroup:group
-	      withPageKey:nil];
+	       withPageId:0];
 }
 
 /**
@@ -1412,7 +1738,7 @@
 	    collectionKey:collectionKey
 	          atIndex:locator.index
 	          inGroup:locator.group
-	      withPageKey:locator.pageKey];
+	       withPageId:locator.pageId];
 }
 
 /**
@@ -1428,32 +1754,32 @@
 - (void)removeRowid:(int64_t)rowid collectionKey:(YapCollectionKey *)collectionKey
                                          atIndex:(NSUInteger)index
                                          inGroup:(NSString *)group
-                                     withPageKey:(NSString *)pageKey
+                                      withPageId:(int64_t)pageId
 {
 	YDBLogAutoTrace();
 	
 	NSParameterAssert(collectionKey != nil);
 	NSParameterAssert(group != nil);
 	
-	// Fetch pageKey (if unknown)
+	// Fetch pageId (if unknown)
 	
-	if (pageKey == nil)
-		pageKey = [self pageKeyForRowid:rowid];
+	if (pageId == 0)
+		pageId = [self pageIdForRowid:rowid];
 	
-	NSAssert(pageKey != nil, @"Missing pageKey for rowid(%lld) in group(%@)", rowid, group);
+	NSAssert(pageId != 0, @"Missing pageId for rowid(%lld) in group(%@)", rowid, group);
 	
 	// Fetch page & pageMetadata
 	
-	YapDatabaseViewPage *page = [self pageForPageKey:pageKey];
+	YapDatabaseViewPage *page = [self pageForPageId:pageId];
 	
 	YapDatabaseViewPageMetadata *pageMetadata = nil;
 	NSUInteger pageOffset = 0;
 	
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+	NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 	
 	for (YapDatabaseViewPageMetadata *pm in pagesMetadataForGroup)
 	{
-		if ([pm->pageKey isEqualToString:pageKey])
+		if (pm->pageId == pageId)
 		{
 			pageMetadata = pm;
 			break;
@@ -1462,7 +1788,7 @@
 		pageOffset += pm->count;
 	}
 	
-	NSAssert(pageMetadata != nil, @"Missing pageMetadata in group(%@) withPageKey(%@)", group, pageKey);
+	NSAssert(pageMetadata != nil, @"Missing pageMetadata in group(%@) withPageId(%lld)", group, pageId);
 	
 	// Find index within page
 	
@@ -1471,8 +1797,8 @@
 	
 	if (!found)
 	{
-		YDBLogError(@"(%@): collection(%@) key(%@) expected to be in page(%@), but is missing",
-		            [self registeredName], collectionKey.collection, collectionKey.key, pageKey);
+		YDBLogError(@"(%@): collection(%@) key(%@) expected to be in page(%lld), but is missing",
+		            [self registeredName], collectionKey.collection, collectionKey.key, pageId);
 		return;
 	}
 	
@@ -1498,14 +1824,14 @@
 	
 	// Mark page as dirty
 	
-	YDBLogVerbose(@"Dirty page(%@)", pageKey);
+	YDBLogVerbose(@"Dirty page(%lld)", pageId);
 	
-	[parentConnection->dirtyPages setObject:page forKey:pageKey];
-	[parentConnection->pageCache setObject:page forKey:pageKey];
+	[parentConnection->dirtyPages setObject:page forKey:@(pageId)];
+	[parentConnection->pageCache setObject:page forKey:@(pageId)];
 	
 	// Mark map as dirty
 	
-	[parentConnection->dirtyMaps setObject:[NSNull null] forKey:@(rowid) withPreviousValue:pageKey];
+	[parentConnection->dirtyMaps setObject:[NSNull null] forKey:@(rowid) withPreviousValue:@(pageId)];
 	[parentConnection->mapCache removeObjectForKey:@(rowid)];
 }
 
@@ -1522,30 +1848,27 @@
 - (void)removeRowidsWithCollectionKeys:(NSDictionary<NSNumber *, YapCollectionKey *> *)collectionKeys
                               locators:(NSDictionary<NSNumber *, YapDatabaseViewLocator *> *)locators
 {
-	// Let's optimize IO by enumerating the items by pageKey.
+	// Let's optimize IO by enumerating the items by pageId.
 	// That is, group our changes by page.
 	
 	NSArray *sortedRowids = [locators keysSortedByValueUsingComparator:
 		^NSComparisonResult(YapDatabaseViewLocator *locator1, YapDatabaseViewLocator *locator2)
 	{
-		__unsafe_unretained NSString *pageKey1 = locator1.pageKey;
-		__unsafe_unretained NSString *pageKey2 = locator2.pageKey;
+		int64_t pageId1 = locator1.pageId;
+		int64_t pageId2 = locator2.pageId;
 		
-		if (pageKey1)
-		{
-			if (pageKey2)
-				return [pageKey1 compare:pageKey2];
-			else
-				return NSOrderedAscending;
-		}
-		else if (pageKey2)
-		{
+		// Unknown pageIds (zero) sort last
+		
+		if (pageId1 == pageId2)
+			return NSOrderedSame;
+		else if (pageId2 == 0)
+			return NSOrderedAscending;
+		else if (pageId1 == 0)
 			return NSOrderedDescending;
-		}
+		else if (pageId1 < pageId2)
+			return NSOrderedAscending;
 		else
-		{
-			return NSOrderedSame;
-		}
+			return NSOrderedDescending;
 	}];
 	
 	for (NSNumber *rowidNumber in sortedRowids)
@@ -1573,12 +1896,12 @@
 **/
 - (void)removeAllRowidsInGroup:(NSString *)group
 {
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+	NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 	NSMutableArray *removedRowids = [NSMutableArray array];
 	
 	for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
 	{
-		YapDatabaseViewPage *page = [self pageForPageKey:pageMetadata->pageKey];
+		YapDatabaseViewPage *page = [self pageForPageId:pageMetadata->pageId];
 		
 		// Mark all rowids for deletion
 		
@@ -1588,7 +1911,7 @@
 			
 			[removedRowids addObject:@(rowid)];
 			
-			[parentConnection->dirtyMaps setObject:[NSNull null] forKey:@(rowid) withPreviousValue:pageMetadata->pageKey];
+			[parentConnection->dirtyMaps setObject:[NSNull null] forKey:@(rowid) withPreviousValue:@(pageMetadata->pageId)];
 			[parentConnection->mapCache removeObjectForKey:@(rowid)];
 			
 		#pragma clang diagnostic pop
@@ -1604,10 +1927,10 @@
 		
 		// Mark page as dirty
 		
-		YDBLogVerbose(@"Dirty page(%@)", pageMetadata->pageKey);
+		YDBLogVerbose(@"Dirty page(%lld)", pageMetadata->pageId);
 		
-		[parentConnection->dirtyPages setObject:page forKey:pageMetadata->pageKey];
-		[parentConnection->pageCache setObject:page forKey:pageMetadata->pageKey];
+		[parentConnection->dirtyPages setObject:page forKey:@(pageMetadata->pageId)];
+		[parentConnection->pageCache setObject:page forKey:@(pageMetadata->pageId)];
 	}
 	
 	[parentConnection->changes addObject:[YapDatabaseViewSectionChange resetGroup:group]];
@@ -1700,26 +2023,26 @@
 #pragma mark Cleanup & Commit
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-- (void)splitOversizedPage:(YapDatabaseViewPage *)page withPageKey:(NSString *)pageKey toSize:(NSUInteger)maxPageSize
+- (void)splitOversizedPage:(YapDatabaseViewPage *)page withPageId:(int64_t)pageId toSize:(NSUInteger)maxPageSize
 {
 	YDBLogAutoTrace();
 	
 	// Find associated pageMetadata
 	
-	NSString *group = [parentConnection->state groupForPageKey:pageKey];
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+	NSString *group = [self groupForPageId:pageId];
+	NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 	
 	YapDatabaseViewPageMetadata *pageMetadata;
 	for (YapDatabaseViewPageMetadata *pm in pagesMetadataForGroup)
 	{
-		if ([pm->pageKey isEqualToString:pageKey])
+		if (pm->pageId == pageId)
 		{
 			pageMetadata = pm;
 			break;
 		}
 	}
 	
-	NSAssert(pageMetadata != nil, @"Missing pageMetadata in group(%@) withPageKey(%@)", group, pageKey);
+	NSAssert(pageMetadata != nil, @"Missing pageMetadata in group(%@) withPageId(%lld)", group, pageId);
 	
 	// Split the page as many times as needed to make it fit the designated maxPageSize
 	
@@ -1740,7 +2063,7 @@
 			{
 				// Move objects from beginning of page to end of previous page
 				
-				YapDatabaseViewPage *prevPage = [self pageForPageKey:prevPageMetadata->pageKey];
+				YapDatabaseViewPage *prevPage = [self pageForPageId:prevPageMetadata->pageId];
 				
 				NSUInteger excessInPage = pageMetadata->count - maxPageSize;
 				NSUInteger spaceInPrevPage = maxPageSize - prevPageMetadata->count;
@@ -1761,8 +2084,8 @@
 				// Mark prevPage as dirty.
 				// The page is already marked as dirty.
 				
-				[parentConnection->dirtyPages setObject:prevPage forKey:prevPageMetadata->pageKey];
-				[parentConnection->pageCache setObject:prevPage forKey:prevPageMetadata->pageKey];
+				[parentConnection->dirtyPages setObject:prevPage forKey:@(prevPageMetadata->pageId)];
+				[parentConnection->pageCache setObject:prevPage forKey:@(prevPageMetadata->pageId)];
 				
 				// Mark rowid mappings as dirty
 				
@@ -1770,8 +2093,8 @@
 				                               range:prevPageRange
 				                          usingBlock:^(int64_t rowid, NSUInteger __unused index, BOOL __unused *stop)
 				{
-					[self->parentConnection->dirtyMaps setObject:prevPageMetadata->pageKey forKey:@(rowid) withPreviousValue:pageMetadata->pageKey];
-					[self->parentConnection->mapCache setObject:prevPageMetadata->pageKey forKey:@(rowid)];
+					[self->parentConnection->dirtyMaps setObject:@(prevPageMetadata->pageId) forKey:@(rowid) withPreviousValue:@(pageMetadata->pageId)];
+					[self->parentConnection->mapCache setObject:@(prevPageMetadata->pageId) forKey:@(rowid)];
 				}];
 				
 				continue;
@@ -1788,7 +2111,7 @@
 			{
 				// Move objects from end of page to beginning of next page
 				
-				YapDatabaseViewPage *nextPage = [self pageForPageKey:nextPageMetadata->pageKey];
+				YapDatabaseViewPage *nextPage = [self pageForPageId:nextPageMetadata->pageId];
 				
 				NSUInteger excessInPage = pageMetadata->count - maxPageSize;
 				NSUInteger spaceInNextPage = maxPageSize - nextPageMetadata->count;
@@ -1809,8 +2132,8 @@
 				// Mark nextPage as dirty.
 				// The page is already marked as dirty.
 				
-				[parentConnection->dirtyPages setObject:nextPage forKey:nextPageMetadata->pageKey];
-				[parentConnection->pageCache setObject:nextPage forKey:nextPageMetadata->pageKey];
+				[parentConnection->dirtyPages setObject:nextPage forKey:@(nextPageMetadata->pageId)];
+				[parentConnection->pageCache setObject:nextPage forKey:@(nextPageMetadata->pageId)];
 				
 				// Mark rowid mappings as dirty
 				
@@ -1818,8 +2141,8 @@
 				                               range:nextPageRange
 				                          usingBlock:^(int64_t rowid, NSUInteger __unused index, BOOL __unused *stop) {
 					
-					[self->parentConnection->dirtyMaps setObject:nextPageMetadata->pageKey forKey:@(rowid) withPreviousValue:pageMetadata->pageKey];
-					[self->parentConnection->mapCache setObject:nextPageMetadata->pageKey forKey:@(rowid)];
+					[self->parentConnection->dirtyMaps setObject:@(nextPageMetadata->pageId) forKey:@(rowid) withPreviousValue:@(pageMetadata->pageId)];
+					[self->parentConnection->mapCache setObject:@(nextPageMetadata->pageId) forKey:@(rowid)];
 				}];
 				
 				continue;
@@ -1832,14 +2155,14 @@
 		NSUInteger excessInPage = pageMetadata->count - maxPageSize;
 		NSUInteger numToMove = MIN(excessInPage, maxPageSize);
 		
-		NSString *newPageKey = [self generatePageKey];
+		int64_t newPageId = [self generatePageId];
 		YapDatabaseViewPage *newPage = [[YapDatabaseViewPage alloc] initWithCapacity:numToMove];
 		
 		// Create new pageMetadata
 		
 		YapDatabaseViewPageMetadata *newPageMetadata = [[YapDatabaseViewPageMetadata alloc] init];
-		newPageMetadata->pageKey = newPageKey;
-		newPageMetadata->prevPageKey = pageMetadata->pageKey;
+		newPageMetadata->pageId = newPageId;
+		newPageMetadata->prevPageId = pageMetadata->pageId;
 		newPageMetadata->group = pageMetadata->group;
 		newPageMetadata->isNew = YES;
 		
@@ -1854,9 +2177,9 @@
 		if ((pageIndex + 2) < [pagesMetadataForGroup count])
 		{
 			YapDatabaseViewPageMetadata *nextPageMetadata = [pagesMetadataForGroup objectAtIndex:(pageIndex + 2)];
-			nextPageMetadata->prevPageKey = newPageKey;
+			nextPageMetadata->prevPageId = newPageId;
 			
-			[parentConnection->dirtyLinks setObject:nextPageMetadata forKey:nextPageMetadata->pageKey];
+			[parentConnection->dirtyLinks setObject:nextPageMetadata forKey:@(nextPageMetadata->pageId)];
 		}
 		
 		// Move objects from end of page to beginning of new page
@@ -1874,35 +2197,35 @@
 		// Mark newPage as dirty.
 		// The page is already marked as dirty.
 		
-		[parentConnection->dirtyPages setObject:newPage forKey:newPageKey];
-		[parentConnection->pageCache setObject:newPage forKey:newPageKey];
+		[parentConnection->dirtyPages setObject:newPage forKey:@(newPageId)];
+		[parentConnection->pageCache setObject:newPage forKey:@(newPageId)];
 		
 		// Mark rowid mappings as dirty
 		
 		[newPage enumerateRowidsUsingBlock:^(int64_t rowid, NSUInteger __unused idx, BOOL __unused *stop) {
 			
-			[self->parentConnection->dirtyMaps setObject:newPageKey forKey:@(rowid) withPreviousValue:pageMetadata->pageKey];
-			[self->parentConnection->mapCache setObject:newPageKey forKey:@(rowid)];
+			[self->parentConnection->dirtyMaps setObject:@(newPageId) forKey:@(rowid) withPreviousValue:@(pageMetadata->pageId)];
+			[self->parentConnection->mapCache setObject:@(newPageId) forKey:@(rowid)];
 		}];
 		
 	} // end while (pageMetadata->count > maxPageSize)
 }
 
-- (void)dropEmptyPage:(YapDatabaseViewPage __unused *)page withPageKey:(NSString *)pageKey
+- (void)dropEmptyPage:(YapDatabaseViewPage __unused *)page withPageId:(int64_t)pageId
 {
 	YDBLogAutoTrace();
 	
 	// Find associated pageMetadata
 	
-	NSString *group = [parentConnection->state groupForPageKey:pageKey];
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+	NSString *group = [self groupForPageId:pageId];
+	NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 	
 	YapDatabaseViewPageMetadata *pageMetadata = nil;
 	NSUInteger pageIndex = 0;
 	
 	for (YapDatabaseViewPageMetadata *pm in pagesMetadataForGroup)
 	{
-		if ([pm->pageKey isEqualToString:pageKey])
+		if (pm->pageId == pageId)
 		{
 			pageMetadata = pm;
 			break;
@@ -1918,9 +2241,9 @@
 	if ((pageIndex + 1) < [pagesMetadataForGroup count])
 	{
 		YapDatabaseViewPageMetadata *nextPageMetadata = [pagesMetadataForGroup objectAtIndex:(pageIndex + 1)];
-		nextPageMetadata->prevPageKey = pageMetadata->prevPageKey;
+		nextPageMetadata->prevPageId = pageMetadata->prevPageId;
 		
-		[parentConnection->dirtyLinks setObject:nextPageMetadata forKey:nextPageMetadata->pageKey];
+		[parentConnection->dirtyLinks setObject:nextPageMetadata forKey:@(nextPageMetadata->pageId)];
 	}
 	
 	// Drop pageMetada (from in-memory state)
@@ -1929,10 +2252,10 @@
 	
 	// Mark page as dropped
 	
-	[parentConnection->dirtyPages setObject:[NSNull null] forKey:pageMetadata->pageKey];
-	[parentConnection->pageCache removeObjectForKey:pageMetadata->pageKey];
+	[parentConnection->dirtyPages setObject:[NSNull null] forKey:@(pageMetadata->pageId)];
+	[parentConnection->pageCache removeObjectForKey:@(pageMetadata->pageId)];
 	
-	[parentConnection->dirtyLinks removeObjectForKey:pageMetadata->pageKey];
+	[parentConnection->dirtyLinks removeObjectForKey:@(pageMetadata->pageId)];
 	
 	// Maybe drop group
 	
@@ -1969,20 +2292,20 @@
 	// Get all the dirty pageMetadata objects.
 	// We snapshot the items so we can make modifications as we enumerate.
 	
-	NSArray *pageKeys = [parentConnection->dirtyPages allKeys];
+	NSArray<NSNumber *> *pageIds = [parentConnection->dirtyPages allKeys];
 	
 	// Step 1 is to "expand" the oversized pages.
 	//
 	// This means either splitting them in 2,
 	// or allowing items to spill over into a neighboring page (that has room).
 	
-	for (NSString *pageKey in pageKeys)
+	for (NSNumber *pageId in pageIds)
 	{
-		YapDatabaseViewPage *page = [parentConnection->dirtyPages objectForKey:pageKey];
+		YapDatabaseViewPage *page = [parentConnection->dirtyPages objectForKey:pageId];
 		
 		if ([page count] > maxPageSize)
 		{
-			[self splitOversizedPage:page withPageKey:pageKey toSize:maxPageSize];
+			[self splitOversizedPage:page withPageId:[pageId longLongValue] toSize:maxPageSize];
 		}
 	}
 	
@@ -1993,13 +2316,13 @@
 	//
 	// Note: We do this after "expansion" to allow undersized pages to first accomodate overflow.
 	
-	for (NSString *pageKey in pageKeys)
+	for (NSNumber *pageId in pageIds)
 	{
-		YapDatabaseViewPage *page = [parentConnection->dirtyPages objectForKey:pageKey];
+		YapDatabaseViewPage *page = [parentConnection->dirtyPages objectForKey:pageId];
 		
 		if ([page count] == 0)
 		{
-			[self dropEmptyPage:page withPageKey:pageKey];
+			[self dropEmptyPage:page withPageId:[pageId longLongValue]];
 		}
 	}
 }
@@ -2038,7 +2361,7 @@
 		#pragma clang diagnostic push
 		#pragma clang diagnostic ignored "-Wimplicit-retain-self"
 			
-			__unsafe_unretained NSString *pageKey = (NSString *)key;
+			int64_t pageId = [(NSNumber *)key longLongValue];
 			__unsafe_unretained YapDatabaseViewPage *page = (YapDatabaseViewPage *)obj;
 			
 			BOOL needsInsert = NO;
@@ -2046,19 +2369,19 @@
 			
 			YapDatabaseViewPageMetadata *pageMetadata = nil;
 			
-			pageMetadata = [parentConnection->dirtyLinks objectForKey:pageKey];
+			pageMetadata = [parentConnection->dirtyLinks objectForKey:key];
 			if (pageMetadata)
 			{
 				hasDirtyLink = YES;
 			}
 			else
 			{
-				NSString *group = [parentConnection->state groupForPageKey:pageKey];
-				NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+				NSString *group = [parentConnection->state groupForPageId:pageId];
+				NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 				
 				for (YapDatabaseViewPageMetadata *pm in pagesMetadataForGroup)
 				{
-					if ([pm->pageKey isEqualToString:pageKey])
+					if (pm->pageId == pageId)
 					{
 						pageMetadata = pm;
 						break;
@@ -2074,22 +2397,21 @@
 			
 			if ((id)page == (id)[NSNull null])
 			{
-				sqlite3_stmt *statement = [parentConnection pageTable_removeForPageKeyStatement];
+				sqlite3_stmt *statement = [parentConnection pageTable_removeForPageIdStatement];
 				if (statement == NULL)
 				{
 					NSAssert(NO, @"Cannot get proper statement! View will become corrupt!");
 					return;//from block
 				}
 				
-				// DELETE FROM "pageTableName" WHERE "pageKey" = ?;
+				// DELETE FROM "pageTableName" WHERE "pageId" = ?;
 				
-				int const bind_idx_pageKey = SQLITE_BIND_START;
+				int const bind_idx_pageId = SQLITE_BIND_START;
 				
-				YDBLogVerbose(@"DELETE FROM '%@' WHERE 'pageKey' = ?;\n"
-				              @" - pageKey: %@", [self pageTableName], pageKey);
+				YDBLogVerbose(@"DELETE FROM '%@' WHERE 'pageId' = ?;\n"
+				              @" - pageId: %lld", [self pageTableName], pageId);
 				
-				YapDatabaseString _pageKey; MakeYapDatabaseString(&_pageKey, pageKey);
-				sqlite3_bind_text(statement, bind_idx_pageKey, _pageKey.str, _pageKey.length, SQLITE_STATIC);
+				sqlite3_bind_int64(statement, bind_idx_pageId, pageId);
 				
 				int status = sqlite3_step(statement);
 				if (status != SQLITE_DONE)
@@ -2101,11 +2423,10 @@
 				
 				sqlite3_clear_bindings(statement);
 				sqlite3_reset(statement);
-				FreeYapDatabaseString(&_pageKey);
 			}
 			else if (needsInsert)
 			{
-				sqlite3_stmt *statement = [parentConnection pageTable_insertForPageKeyStatement];
+				sqlite3_stmt *statement = [parentConnection pageTable_insertForPageIdStatement];
 				if (statement == NULL)
 				{
 					NSAssert(NO, @"Cannot get proper statement! View will become corrupt!");
@@ -2113,32 +2434,29 @@
 				}
 				
 				// INSERT INTO "pageTableName"
-				//   ("pageKey", "group", "prevPageKey", "count", "data") VALUES (?, ?, ?, ?, ?);
+				//   ("pageId", "group", "prevPageId", "count", "data") VALUES (?, ?, ?, ?, ?);
 				
-				int const bind_idx_pageKey     = SQLITE_BIND_START + 0;
-				int const bind_idx_group       = SQLITE_BIND_START + 1;
-				int const bind_idx_prevPageKey = SQLITE_BIND_START + 2;
-				int const bind_idx_count       = SQLITE_BIND_START + 3;
-				int const bind_idx_data        = SQLITE_BIND_START + 4;
+				int const bind_idx_pageId     = SQLITE_BIND_START + 0;
+				int const bind_idx_group      = SQLITE_BIND_START + 1;
+				int const bind_idx_prevPageId = SQLITE_BIND_START + 2;
+				int const bind_idx_count      = SQLITE_BIND_START + 3;
+				int const bind_idx_data       = SQLITE_BIND_START + 4;
 				
 				YDBLogVerbose(@"INSERT INTO '%@'"
-				              @" ('pageKey', 'group', 'prevPageKey', 'count', 'data') VALUES (?,?,?,?,?);\n"
-				              @" - pageKey   : %@\n"
+				              @" ('pageId', 'group', 'prevPageId', 'count', 'data') VALUES (?,?,?,?,?);\n"
+				              @" - pageId    : %lld\n"
 				              @" - group     : %@\n"
-				              @" - prePageKey: %@\n"
-				              @" - count     : %d", [self pageTableName], pageKey,
-				              pageMetadata->group, pageMetadata->prevPageKey, (int)pageMetadata->count);
+				              @" - prevPageId: %lld\n"
+				              @" - count     : %d", [self pageTableName], pageId,
+				              pageMetadata->group, pageMetadata->prevPageId, (int)pageMetadata->count);
 				
-				YapDatabaseString _pageKey; MakeYapDatabaseString(&_pageKey, pageKey);
-				sqlite3_bind_text(statement, bind_idx_pageKey, _pageKey.str, _pageKey.length, SQLITE_STATIC);
+				sqlite3_bind_int64(statement, bind_idx_pageId, pageId);
 				
 				YapDatabaseString _group; MakeYapDatabaseString(&_group, pageMetadata->group);
 				sqlite3_bind_text(statement, bind_idx_group, _group.str, _group.length, SQLITE_STATIC);
 				
-				YapDatabaseString _prevPageKey; MakeYapDatabaseString(&_prevPageKey, pageMetadata->prevPageKey);
-				if (pageMetadata->prevPageKey) {
-					sqlite3_bind_text(statement, bind_idx_prevPageKey,
-					                  _prevPageKey.str, _prevPageKey.length, SQLITE_STATIC);
+				if (pageMetadata->prevPageId != 0) {
+					sqlite3_bind_int64(statement, bind_idx_prevPageId, pageMetadata->prevPageId);
 				}
 				
 				sqlite3_bind_int(statement, bind_idx_count, (int)(pageMetadata->count));
@@ -2156,36 +2474,32 @@
 				
 				sqlite3_clear_bindings(statement);
 				sqlite3_reset(statement);
-				FreeYapDatabaseString(&_prevPageKey);
 				FreeYapDatabaseString(&_group);
-				FreeYapDatabaseString(&_pageKey);
 			}
 			else if (hasDirtyLink)
 			{
-				sqlite3_stmt *statement = [parentConnection pageTable_updateAllForPageKeyStatement];
+				sqlite3_stmt *statement = [parentConnection pageTable_updateAllForPageIdStatement];
 				if (statement == NULL)
 				{
 					NSAssert(NO, @"Cannot get proper statement! View will become corrupt!");
 					return;//from block
 				}
 				
-				// UPDATE "pageTableName" SET "prevPageKey" = ?, "count" = ?, "data" = ? WHERE "pageKey" = ?;
+				// UPDATE "pageTableName" SET "prevPageId" = ?, "count" = ?, "data" = ? WHERE "pageId" = ?;
 				
-				int const bind_idx_prevPageKey = SQLITE_BIND_START + 0;
-				int const bind_idx_count       = SQLITE_BIND_START + 1;
-				int const bind_idx_data        = SQLITE_BIND_START + 2;
-				int const bind_idx_pageKey     = SQLITE_BIND_START + 3;
+				int const bind_idx_prevPageId = SQLITE_BIND_START + 0;
+				int const bind_idx_count      = SQLITE_BIND_START + 1;
+				int const bind_idx_data       = SQLITE_BIND_START + 2;
+				int const bind_idx_pageId     = SQLITE_BIND_START + 3;
 				
-				YDBLogVerbose(@"UPDATE '%@' SET 'prevPageKey' = ?, 'count' = ?, 'data' = ? WHERE 'pageKey' = ?;\n"
-				              @" - pageKey    : %@\n"
-				              @" - prevPageKey: %@\n"
-				              @" - count      : %d", [self pageTableName], pageKey,
-				              pageMetadata->prevPageKey, (int)pageMetadata->count);
+				YDBLogVerbose(@"UPDATE '%@' SET 'prevPageId' = ?, 'count' = ?, 'data' = ? WHERE 'pageId' = ?;\n"
+				              @" - pageId    : %lld\n"
+				              @" - prevPageId: %lld\n"
+				              @" - count     : %d", [self pageTableName], pageId,
+				              pageMetadata->prevPageId, (int)pageMetadata->count);
 				
-				YapDatabaseString _prevPageKey; MakeYapDatabaseString(&_prevPageKey, pageMetadata->prevPageKey);
-				if (pageMetadata->prevPageKey) {
-					sqlite3_bind_text(statement, bind_idx_prevPageKey,
-					                  _prevPageKey.str, _prevPageKey.length, SQLITE_STATIC);
+				if (pageMetadata->prevPageId != 0) {
+					sqlite3_bind_int64(statement, bind_idx_prevPageId, pageMetadata->prevPageId);
 				}
 				
 				sqlite3_bind_int(statement, bind_idx_count, (int)(pageMetadata->count));
@@ -2193,8 +2507,7 @@
 				__attribute__((objc_precise_lifetime)) NSData *rawData = [self serializePage:page];
 				sqlite3_bind_blob(statement, bind_idx_data, rawData.bytes, (int)rawData.length, SQLITE_STATIC);
 				
-				YapDatabaseString _pageKey; MakeYapDatabaseString(&_pageKey, pageKey);
-				sqlite3_bind_text(statement, bind_idx_pageKey, _pageKey.str, _pageKey.length, SQLITE_STATIC);
+				sqlite3_bind_int64(statement, bind_idx_pageId, pageId);
 				
 				int status = sqlite3_step(statement);
 				if (status != SQLITE_DONE)
@@ -2206,35 +2519,32 @@
 				
 				sqlite3_clear_bindings(statement);
 				sqlite3_reset(statement);
-				FreeYapDatabaseString(&_prevPageKey);
-				FreeYapDatabaseString(&_pageKey);
 			}
 			else
 			{
-				sqlite3_stmt *statement = [parentConnection pageTable_updatePageForPageKeyStatement];
+				sqlite3_stmt *statement = [parentConnection pageTable_updatePageForPageIdStatement];
 				if (statement == NULL)
 				{
 					NSAssert(NO, @"Cannot get proper statement! View will become corrupt!");
 					return;//from block
 				}
 			
-				// UPDATE "pageTableName" SET "count" = ?, "data" = ? WHERE "pageKey" = ?;
+				// UPDATE "pageTableName" SET "count" = ?, "data" = ? WHERE "pageId" = ?;
 				
-				int const bind_idx_count   = SQLITE_BIND_START + 0;
-				int const bind_idx_data    = SQLITE_BIND_START + 1;
-				int const bind_idx_pageKey = SQLITE_BIND_START + 2;
+				int const bind_idx_count  = SQLITE_BIND_START + 0;
+				int const bind_idx_data   = SQLITE_BIND_START + 1;
+				int const bind_idx_pageId = SQLITE_BIND_START + 2;
 				
-				YDBLogVerbose(@"UPDATE '%@' SET 'count' = ?, 'data' = ? WHERE 'pageKey' = ?;\n"
-				              @" - pageKey: %@\n"
-				              @" - count  : %d", [self pageTableName], pageKey, (int)(pageMetadata->count));
+				YDBLogVerbose(@"UPDATE '%@' SET 'count' = ?, 'data' = ? WHERE 'pageId' = ?;\n"
+				              @" - pageId: %lld\n"
+				              @" - count : %d", [self pageTableName], pageId, (int)(pageMetadata->count));
 				
 				sqlite3_bind_int(statement, bind_idx_count, (int)[page count]);
 				
 				__attribute__((objc_precise_lifetime)) NSData *rawData = [self serializePage:page];
 				sqlite3_bind_blob(statement, bind_idx_data, rawData.bytes, (int)rawData.length, SQLITE_STATIC);
 				
-				YapDatabaseString _pageKey; MakeYapDatabaseString(&_pageKey, pageKey);
-				sqlite3_bind_text(statement, bind_idx_pageKey, _pageKey.str, _pageKey.length, SQLITE_STATIC);
+				sqlite3_bind_int64(statement, bind_idx_pageId, pageId);
 				
 				int status = sqlite3_step(statement);
 				if (status != SQLITE_DONE)
@@ -2246,7 +2556,6 @@
 				
 				sqlite3_clear_bindings(statement);
 				sqlite3_reset(statement);
-				FreeYapDatabaseString(&_pageKey);
 			}
 			
 		#pragma clang diagnostic pop
@@ -2254,17 +2563,17 @@
 		
 		// Persistent View: Step 2 of 3
 		//
-		// Write dirty prevPageKey values to table (those not also associated with dirty pages).
-		// This happens when only the prevPageKey pointer is changed.
+		// Write dirty prevPageId values to table (those not also associated with dirty pages).
+		// This happens when only the prevPageId pointer is changed.
 		
 		[parentConnection->dirtyLinks enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
 		#pragma clang diagnostic push
 		#pragma clang diagnostic ignored "-Wimplicit-retain-self"
 			
-			NSString *pageKey = (NSString *)key;
+			int64_t pageId = [(NSNumber *)key longLongValue];
 			YapDatabaseViewPageMetadata *pageMetadata = (YapDatabaseViewPageMetadata *)obj;
 			
-			if ([parentConnection->dirtyPages objectForKey:pageKey])
+			if ([parentConnection->dirtyPages objectForKey:key])
 			{
 				// Both the page and metadata were dirty, so we wrote them both to disk at the same time.
 				// No need to write the metadata again.
@@ -2272,29 +2581,26 @@
 				return;//continue;
 			}
 			
-			sqlite3_stmt *statement = [parentConnection pageTable_updateLinkForPageKeyStatement];
+			sqlite3_stmt *statement = [parentConnection pageTable_updateLinkForPageIdStatement];
 			if (statement == NULL) {
 				*stop = YES;
 				return;//from block
 			}
 				
-			// UPDATE "pageTableName" SET "prevPageKey" = ? WHERE "pageKey" = ?;
+			// UPDATE "pageTableName" SET "prevPageId" = ? WHERE "pageId" = ?;
 			
-			int const bind_idx_prevPageKey = SQLITE_BIND_START + 0;
-			int const bind_idx_pageKey     = SQLITE_BIND_START + 1;
+			int const bind_idx_prevPageId = SQLITE_BIND_START + 0;
+			int const bind_idx_pageId     = SQLITE_BIND_START + 1;
 			
-			YDBLogVerbose(@"UPDATE '%@' SET 'prevPageKey' = ? WHERE 'pageKey' = ?;\n"
-			              @" - pageKey    : %@\n"
-			              @" - prevPageKey: %@", [self pageTableName], pageKey, pageMetadata->prevPageKey);
+			YDBLogVerbose(@"UPDATE '%@' SET 'prevPageId' = ? WHERE 'pageId' = ?;\n"
+			              @" - pageId    : %lld\n"
+			              @" - prevPageId: %lld", [self pageTableName], pageId, pageMetadata->prevPageId);
 			
-			YapDatabaseString _prevPageKey; MakeYapDatabaseString(&_prevPageKey, pageMetadata->prevPageKey);
-			if (pageMetadata->prevPageKey) {
-				sqlite3_bind_text(statement, bind_idx_prevPageKey,
-				                  _prevPageKey.str, _prevPageKey.length, SQLITE_STATIC);
+			if (pageMetadata->prevPageId != 0) {
+				sqlite3_bind_int64(statement, bind_idx_prevPageId, pageMetadata->prevPageId);
 			}
 			
-			YapDatabaseString _pageKey; MakeYapDatabaseString(&_pageKey, pageKey);
-			sqlite3_bind_text(statement, bind_idx_pageKey, _pageKey.str, _pageKey.length, SQLITE_STATIC);
+			sqlite3_bind_int64(statement, bind_idx_pageId, pageId);
 			
 			int status = sqlite3_step(statement);
 			if (status != SQLITE_DONE)
@@ -2306,24 +2612,22 @@
 			
 			sqlite3_clear_bindings(statement);
 			sqlite3_reset(statement);
-			FreeYapDatabaseString(&_prevPageKey);
-			FreeYapDatabaseString(&_pageKey);
 			
 		#pragma clang diagnostic pop
 		}];
 		
 		// Persistent View: Step 3 of 3
 		//
-		// Update the dirty rowid -> pageKey mappings.
+		// Update the dirty rowid -> pageId mappings.
 		
-		[parentConnection->dirtyMaps enumerateKeysAndObjectsUsingBlock:^(id rowIdObj, id pageKeyObj, BOOL *stop) {
+		[parentConnection->dirtyMaps enumerateKeysAndObjectsUsingBlock:^(id rowIdObj, id pageIdObj, BOOL *stop) {
 		#pragma clang diagnostic push
 		#pragma clang diagnostic ignored "-Wimplicit-retain-self"
 			
 			int64_t rowid = [(NSNumber *)rowIdObj longLongValue];
-			__unsafe_unretained NSString *pageKey = (NSString *)pageKeyObj;
+			__unsafe_unretained NSNumber *pageIdNumber = (NSNumber *)pageIdObj;
 			
-			if ((id)pageKey == (id)[NSNull null])
+			if ((id)pageIdNumber == (id)[NSNull null])
 			{
 				sqlite3_stmt *statement = [parentConnection mapTable_removeForRowidStatement];
 				if (statement == NULL)
@@ -2354,26 +2658,26 @@
 			}
 			else
 			{
-				sqlite3_stmt *statement = [parentConnection mapTable_setPageKeyForRowidStatement];
+				sqlite3_stmt *statement = [parentConnection mapTable_setPageIdForRowidStatement];
 				if (statement == NULL)
 				{
 					*stop = YES;
 					return;//continue;
 				}
 				
-				// INSERT OR REPLACE INTO "mapTableName" ("rowid", "pageKey") VALUES (?, ?);
+				// INSERT OR REPLACE INTO "mapTableName" ("rowid", "pageId") VALUES (?, ?);
 				
-				int const bind_idx_rowid   = SQLITE_BIND_START + 0;
-				int const bind_idx_pageKey = SQLITE_BIND_START + 1;
+				int64_t pageId = [pageIdNumber longLongValue];
 				
-				YDBLogVerbose(@"INSERT OR REPLACE INTO '%@' ('rowid', 'pageKey') VALUES (?, ?);\n"
-				              @" - rowid  : %lld\n"
-				              @" - pageKey: %@", [self mapTableName], rowid, pageKey);
+				int const bind_idx_rowid  = SQLITE_BIND_START + 0;
+				int const bind_idx_pageId = SQLITE_BIND_START + 1;
 				
-				sqlite3_bind_int64(statement, bind_idx_rowid, rowid);
+				YDBLogVerbose(@"INSERT OR REPLACE INTO '%@' ('rowid', 'pageId') VALUES (?, ?);\n"
+				              @" - rowid : %lld\n"
+				              @" - pageId: %lld", [self mapTableName], rowid, pageId);
 				
-				YapDatabaseString _pageKey; MakeYapDatabaseString(&_pageKey, pageKey);
-				sqlite3_bind_text(statement, bind_idx_pageKey, _pageKey.str, _pageKey.length, SQLITE_STATIC);
+				sqlite3_bind_int64(statement, bind_idx_rowid, rowid);
+				sqlite3_bind_int64(statement, bind_idx_pageId, pageId);
 				
 				int status = sqlite3_step(statement);
 				if (status != SQLITE_DONE)
@@ -2385,7 +2689,6 @@
 				
 				sqlite3_clear_bindings(statement);
 				sqlite3_reset(statement);
-				FreeYapDatabaseString(&_pageKey);
 			}
 			
 		#pragma clang diagnostic pop
@@ -2409,16 +2712,16 @@
 				
 				[parentConnection->dirtyPages enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL __unused *stop) {
 					
-					__unsafe_unretained NSString *pageKey = (NSString *)key;
+					__unsafe_unretained NSNumber *pageId = (NSNumber *)key;
 					__unsafe_unretained YapDatabaseViewPage *page = (YapDatabaseViewPage *)obj;
 					
 					if ((id)page == (id)[NSNull null])
 					{
-						[pageTableTransaction removeObjectForKey:pageKey];
+						[pageTableTransaction removeObjectForKey:pageId];
 					}
 					else
 					{
-						[pageTableTransaction setObject:[page copy] forKey:pageKey];
+						[pageTableTransaction setObject:[page copy] forKey:pageId];
 					}
 				}];
 				
@@ -2438,26 +2741,26 @@
 				
 				[parentConnection->dirtyPages enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL __unused *stop) {
 					
-					__unsafe_unretained NSString *pageKey = (NSString *)key;
+					__unsafe_unretained NSNumber *pageId = (NSNumber *)key;
 					__unsafe_unretained YapDatabaseViewPage *page = (YapDatabaseViewPage *)obj;
 					
 					if ((id)page == (id)[NSNull null])
 					{
-						[pageMetadataTableTransaction removeObjectForKey:pageKey];
+						[pageMetadataTableTransaction removeObjectForKey:pageId];
 					}
 					else
 					{
 						YapDatabaseViewPageMetadata *pageMetadata = nil;
 						
-						pageMetadata = [parentConnection->dirtyLinks objectForKey:pageKey];
+						pageMetadata = [parentConnection->dirtyLinks objectForKey:pageId];
 						if (pageMetadata == nil)
 						{
-							NSString *group = [parentConnection->state groupForPageKey:pageKey];
-							NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+							NSString *group = [parentConnection->state groupForPageId:[pageId longLongValue]];
+							NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 							
 							for (YapDatabaseViewPageMetadata *pm in pagesMetadataForGroup)
 							{
-								if ([pm->pageKey isEqualToString:pageKey])
+								if (pm->pageId == [pageId longLongValue])
 								{
 									pageMetadata = pm;
 									break;
@@ -2470,17 +2773,17 @@
 							if (pageMetadata->isNew)
 								pageMetadata->isNew = NO; // Clear flag
 							
-							[pageMetadataTableTransaction setObject:[pageMetadata copy] forKey:pageKey];
+							[pageMetadataTableTransaction setObject:[pageMetadata copy] forKey:pageId];
 						}
 					}
 				}];
 				
 				[parentConnection->dirtyLinks enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL __unused *stop) {
 					
-					__unsafe_unretained NSString *pageKey = (NSString *)key;
+					__unsafe_unretained NSNumber *pageId = (NSNumber *)key;
 					__unsafe_unretained YapDatabaseViewPageMetadata *pageMetadata = (YapDatabaseViewPageMetadata *)obj;
 					
-					if ([parentConnection->dirtyPages objectForKey:pageKey])
+					if ([parentConnection->dirtyPages objectForKey:pageId])
 					{
 						// Both the page and metadata were dirty, so we wrote them both to disk at the same time.
 						// No need to write the metadata again.
@@ -2488,7 +2791,7 @@
 						return;//continue;
 					}
 					
-					[pageMetadataTableTransaction setObject:[pageMetadata copy] forKey:pageKey];
+					[pageMetadataTableTransaction setObject:[pageMetadata copy] forKey:pageId];
 				}];
 				
 			#pragma clang diagnostic pop
@@ -2497,7 +2800,7 @@
 		
 		// Memory View: Step 3 of 3
 		//
-		// Update the dirty rowid -> pageKey mappings.
+		// Update the dirty rowid -> pageId mappings.
 		
 		if (hasDirtyMaps)
 		{
@@ -2508,15 +2811,15 @@
 				[parentConnection->dirtyMaps enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL __unused *stop) {
 					
 					__unsafe_unretained NSNumber *rowidNumber = (NSNumber *)key;
-					__unsafe_unretained NSString *pageKey = (NSString *)obj;
+					__unsafe_unretained NSNumber *pageId = (NSNumber *)obj;
 					
-					if ((id)pageKey == (id)[NSNull null])
+					if ((id)pageId == (id)[NSNull null])
 					{
 						[mapTableTransaction removeObjectForKey:rowidNumber];
 					}
 					else
 					{
-						[mapTableTransaction setObject:pageKey forKey:rowidNumber];
+						[mapTableTransaction setObject:pageId forKey:rowidNumber];
 					}
 				}];
 				
@@ -2584,16 +2887,11 @@
 	
 	__block NSUInteger count = 0;
 	
-	[parentConnection->state enumerateWithBlock:^(NSString __unused *group, NSArray *pagesMetadataForGroup, BOOL __unused *stop) {
-		
-		for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
-		{
-			if (pageMetadata->count > 0)
-			{
-				count++;
-				break;
-			}
-		}
+	[parentConnection->state enumerateGroupCountsWithBlock:
+	  ^(NSString __unused *group, NSUInteger countForGroup, BOOL __unused *stop)
+	{
+		if (countForGroup > 0)
+			count++;
 	}];
 	
 	return count;
@@ -2606,16 +2904,11 @@
 	
 	NSMutableArray *allGroups = [NSMutableArray arrayWithCapacity:[parentConnection->state numberOfGroups]];
 	
-	[parentConnection->state enumerateWithBlock:^(NSString *group, NSArray *pagesMetadataForGroup, BOOL __unused *stop) {
-		
-		for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
-		{
-			if (pageMetadata->count > 0)
-			{
-				[allGroups addObject:group];
-				break;
-			}
-		}
+	[parentConnection->state enumerateGroupCountsWithBlock:
+	  ^(NSString *group, NSUInteger countForGroup, BOOL __unused *stop)
+	{
+		if (countForGroup > 0)
+			[allGroups addObject:group];
 	}];
 	
 	return [allGroups copy];
@@ -2630,15 +2923,7 @@
 	// Note: We don't remove pages or groups until flushPendingChangesToExtensionTables.
 	// This allows us to recycle pages whenever possible, which reduces disk IO during the commit.
 	
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
-	
-	for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
-	{
-		if (pageMetadata->count > 0)
-			return YES;
-	}
-	
-	return NO;
+	return ([parentConnection->state numberOfItemsInGroup:group] > 0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2647,28 +2932,19 @@
 
 - (NSUInteger)numberOfItemsInGroup:(NSString *)group
 {
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
-	NSUInteger count = 0;
-	
-	for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
-	{
-		count += pageMetadata->count;
-	}
+	// Note: This doesn't require the pagesMetadata for the group to be loaded.
 	
-	return count;
+	return [parentConnection->state numberOfItemsInGroup:group];
 }
 
 - (NSUInteger)numberOfItemsInAllGroups
 {
 	__block NSUInteger count = 0;
 	
-	[parentConnection->state enumerateWithBlock:
-	  ^(NSString __unused *group, NSArray *pagesMetadataForGroup, BOOL __unused *stop)
+	[parentConnection->state enumerateGroupCountsWithBlock:
+	  ^(NSString __unused *group, NSUInteger countForGroup, BOOL __unused *stop)
 	{
-		for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
-		{
-			count += pageMetadata->count;
-		}
+		count += countForGroup;
 	}];
 	
 	return count;
@@ -2680,16 +2956,7 @@
 **/
 - (BOOL)isEmptyGroup:(NSString *)group
 {
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
-	
-	for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
-	{
-		if (pageMetadata->count > 0) {
-			return NO;
-		}
-	}
-	
-	return YES;
+	return ([parentConnection->state numberOfItemsInGroup:group] == 0);
 }
 
 /**
@@ -2700,17 +2967,13 @@
 {
 	__block BOOL result = YES;
 	
-	[parentConnection->state enumerateWithBlock:^(NSString __unused *group, NSArray *pagesMetadataForGroup, BOOL *stop) {
-		
-		for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
+	[parentConnection->state enumerateGroupCountsWithBlock:
+	  ^(NSString __unused *group, NSUInteger countForGroup, BOOL *stop)
+	{
+		if (countForGroup > 0)
 		{
-			if (pageMetadata->count > 0)
-			{
-				result = NO;
-				
-				*stop = YES;
-				break;
-			}
+			result = NO;
+			*stop = YES;
 		}
 	}];
 	
@@ -2794,7 +3057,9 @@
 	int64_t rowid;
 	if ([databaseTransaction getRowid:&rowid forKey:key inCollection:collection])
 	{
-		return [parentConnection->state groupForPageKey:[self pageKeyForRowid:rowid]];
+		int64_t pageId = [self pageIdForRowid:rowid];
+		if (pageId != 0)
+			return [self groupForPageId:pageId];
 	}
 	
 	return nil;
@@ -2826,22 +3091,22 @@
 		// Query the database to see if the given key is in the view.
 		// If it is, the query will return the corresponding page the key is in.
 		
-		NSString *pageKey = [self pageKeyForRowid:rowid];
-		if (pageKey)
+		int64_t pageId = [self pageIdForRowid:rowid];
+		if (pageId != 0)
 		{
-			// Now that we have the pageKey, fetch the corresponding group.
+			// Now that we have the pageId, fetch the corresponding group.
 			// This is done using an in-memory cache.
 			
-			group = [parentConnection->state groupForPageKey:pageKey];
+			group = [self groupForPageId:pageId];
 		
 			// Calculate the offset of the corresponding page within the group.
 			
 			NSUInteger pageOffset = 0;
-			NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+			NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 			
 			for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
 			{
-				if ([pageMetadata->pageKey isEqualToString:pageKey])
+				if (pageMetadata->pageId == pageId)
 				{
 					break;
 				}
@@ -2851,7 +3116,7 @@
 			
 			// Fetch the actual page (ordered array of keys)
 			
-			YapDatabaseViewPage *page = [self pageForPageKey:pageKey];
+			YapDatabaseViewPage *page = [self pageForPageId:pageId];
 			
 			// And find the exact index of the key within the page
 			
@@ -2971,11 +3236,11 @@
 	__block BOOL stop = NO;
 	
 	NSUInteger pageOffset = 0;
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+	NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 	
 	for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataForGroup)
 	{
-		YapDatabaseViewPage *page = [self pageForPageKey:pageMetadata->pageKey];
+		YapDatabaseViewPage *page = [self pageForPageId:pageMetadata->pageId];
 		
 		[page enumerateRowidsUsingBlock:^(int64_t rowid, NSUInteger idx, BOOL *innerStop) {
 			
@@ -3014,7 +3279,7 @@
 	else
 		index = [self numberOfItemsInGroup:group] - 1;
 	
-	NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+	NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 	
 	[pagesMetadataForGroup enumerateObjectsWithOptions:options
 	                                        usingBlock:^(id pageMetadataObj, NSUInteger __unused outerIdx, BOOL *outerStop)
@@ -3022,7 +3287,7 @@
 		__unsafe_unretained YapDatabaseViewPageMetadata *pageMetadata =
 		    (YapDatabaseViewPageMetadata *)pageMetadataObj;
 		
-		YapDatabaseViewPage *page = [self pageForPageKey:pageMetadata->pageKey];
+		YapDatabaseViewPage *page = [self pageForPageId:pageMetadata->pageId];
 		
 		[page enumerateRowidsWithOptions:options usingBlock:^(int64_t rowid, NSUInteger __unused innerIdx, BOOL *innerStop) {
 			
@@ -3063,7 +3328,7 @@
 	{
 		// Forward enumeration (optimized)
 		
-		NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+		NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 		
 		NSUInteger pageOffset = 0;
 		BOOL startedRange = NO;
@@ -3076,7 +3341,7 @@
 			if (intersection.length > 0)
 			{
 				startedRange = YES;
-				YapDatabaseViewPage *page = [self pageForPageKey:pageMetadata->pageKey];
+				YapDatabaseViewPage *page = [self pageForPageId:pageMetadata->pageId];
 				
 				// Enumerate the subset
 				
@@ -3108,7 +3373,7 @@
 	{
 		// Reverse enumeration
 		
-		NSArray *pagesMetadataForGroup = [parentConnection->state pagesMetadataForGroup:group];
+		NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
 		
 		__block NSUInteger pageOffset = [self numberOfItemsInGroup:group];
 		__block BOOL startedRange = NO;
@@ -3127,7 +3392,7 @@
 			if (intersection.length > 0)
 			{
 				startedRange = YES;
-				YapDatabaseViewPage *page = [self pageForPageKey:pageMetadata->pageKey];
+				YapDatabaseViewPage *page = [self pageForPageId:pageMetadata->pageId];
 				
 				// Enumerate the subset
 				
@@ -3168,6 +3433,176 @@
 	}
 }
 
+/**
+ * Enumerates the rows within the given range, fetching the objects and/or metadata a page at a time.
+ *
+ * For each page, the rowids within the range are gathered,
+ * and any items not already in the cache are fetched from the database in a single query.
+ * The block is then invoked for each item, in view order.
+ *
+ * Within a read-write transaction, each item is instead fetched just before the block is invoked for it.
+**/
+- (void)enumerateRowsInGroup:(NSString *)group
+                 withOptions:(NSEnumerationOptions)inOptions
+                       range:(NSRange)range
+                 withObjects:(BOOL)withObjects
+                    metadata:(BOOL)withMetadata
+                  usingBlock:
+            (void (NS_NOESCAPE^)(YapCollectionKey *ck, id object, id metadata, NSUInteger index, BOOL *stop))block
+{
+	if (block == NULL) return;
+	
+	NSEnumerationOptions options = (inOptions & NSEnumerationReverse); // We only support NSEnumerationReverse
+	BOOL forwardEnumeration = (options != NSEnumerationReverse);
+	
+	[parentConnection->mutatedGroups removeObject:group]; // mutation during enumeration protection
+	
+	BOOL stop = NO;
+	NSUInteger keysLeft = range.length;
+	
+	NSArray *pagesMetadataForGroup = [self pagesMetadataForGroup:group];
+	
+	NSUInteger pageOffset = 0;
+	NSEnumerator *pagesMetadataEnumerator = nil;
+	
+	if (forwardEnumeration)
+	{
+		pagesMetadataEnumerator = [pagesMetadataForGroup objectEnumerator];
+	}
+	else
+	{
+		pageOffset = [self numberOfItemsInGroup:group];
+		pagesMetadataEnumerator = [pagesMetadataForGroup reverseObjectEnumerator];
+	}
+	
+	// Within a read-write transaction, the block may modify a row that comes later in the same page.
+	// If the row doesn't move within the view, the group isn't marked as mutated,
+	// and a prefetched object would be stale by the time we hand it out.
+	// So we only prefetch within read-only transactions.
+	
+	BOOL prefetch = !databaseTransaction->isReadWriteTransaction;
+	
+	NSMutableData *rowidsBuffer = [NSMutableData data];
+	
+	NSPointerArray *batchKeys     = [NSPointerArray strongObjectsPointerArray];
+	NSPointerArray *batchObjects  = [NSPointerArray strongObjectsPointerArray];
+	NSPointerArray *batchMetadata = [NSPointerArray strongObjectsPointerArray];
+	
+	BOOL startedRange = NO;
+	
+	for (YapDatabaseViewPageMetadata *pageMetadata in pagesMetadataEnumerator)
+	{
+		if (!forwardEnumeration) {
+			pageOffset -= pageMetadata->count;
+		}
+		
+		NSRange pageRange = NSMakeRange(pageOffset, pageMetadata->count);
+		NSRange intersection = NSIntersectionRange(pageRange, range);
+		
+		if (intersection.length > 0)
+		{
+			startedRange = YES;
+			YapDatabaseViewPage *page = [self pageForPageId:pageMetadata->pageId];
+			
+			// Gather the rowids for the subset (in page order)
+			
+			NSRange enumRange = NSMakeRange(intersection.location - pageOffset, intersection.length);
+			NSUInteger batchCount = enumRange.length;
+			
+			[rowidsBuffer setLength:(batchCount * sizeof(int64_t))];
+			int64_t *rowids = (int64_t *)[rowidsBuffer mutableBytes];
+			
+			for (NSUInteger i = 0; i < batchCount; i++)
+			{
+				rowids[i] = [page rowidAtIndex:(enumRange.location + i)];
+			}
+			
+			// Fetch everything for the subset in one go
+			
+			if (prefetch)
+			{
+				[batchKeys setCount:0];
+				[batchObjects setCount:0];
+				[batchMetadata setCount:0];
+				
+				[batchKeys setCount:batchCount];
+				[batchObjects setCount:batchCount];
+				[batchMetadata setCount:batchCount];
+				
+				[databaseTransaction _enumerateRowsForRowids:rowids
+				                                       count:batchCount
+				                                 withObjects:withObjects
+				                                    metadata:withMetadata
+				                         unorderedUsingBlock:^(NSUInteger rowidIndex, YapCollectionKey *ck, id object, id metadata)
+				{
+					[batchKeys replacePointerAtIndex:rowidIndex withPointer:(__bridge void *)ck];
+					[batchObjects replacePointerAtIndex:rowidIndex withPointer:(__bridge void *)object];
+					[batchMetadata replacePointerAtIndex:rowidIndex withPointer:(__bridge void *)metadata];
+				}];
+			}
+			
+			// Invoke the block in view order
+			
+			for (NSUInteger n = 0; n < batchCount; n++)
+			{
+				NSUInteger i = forwardEnumeration ? n : (batchCount - 1 - n);
+				
+				if (prefetch)
+				{
+					block((__bridge YapCollectionKey *)[batchKeys pointerAtIndex:i],
+					      (__bridge id)[batchObjects pointerAtIndex:i],
+					      (__bridge id)[batchMetadata pointerAtIndex:i],
+					      (pageOffset + enumRange.location + i), &stop);
+				}
+				else
+				{
+					YapCollectionKey *ck = nil;
+					id object = nil;
+					id metadata = nil;
+					
+					if (withObjects && withMetadata)
+						[databaseTransaction getCollectionKey:&ck object:&object metadata:&metadata forRowid:rowids[i]];
+					else if (withObjects)
+						[databaseTransaction getCollectionKey:&ck object:&object forRowid:rowids[i]];
+					else if (withMetadata)
+						[databaseTransaction getCollectionKey:&ck metadata:&metadata forRowid:rowids[i]];
+					else
+						ck = [databaseTransaction collectionKeyForRowid:rowids[i]];
+					
+					block(ck, object, metadata, (pageOffset + enumRange.location + i), &stop);
+				}
+				
+				if (stop || [parentConnection->mutatedGroups containsObject:group]) break;
+			}
+			
+			if (stop || [parentConnection->mutatedGroups containsObject:group]) break;
+			
+			keysLeft -= enumRange.length;
+		}
+		else if (startedRange && (pageRange.length > 0))
+		{
+			// We've completed the range
+			break;
+		}
+		
+		if (forwardEnumeration) {
+			pageOffset += pageMetadata->count;
+		}
+	}
+	
+	if (!stop && [parentConnection->mutatedGroups containsObject:group])
+	{
+		@throw [self mutationDuringEnumerationException:group];
+	}
+	
+	if (!stop && keysLeft > 0)
+	{
+		YDBLogWarn(@"Range out of bounds: range(%lu, %lu) >= numberOfKeys(%lu) in group %@",
+		    (unsigned long)range.location, (unsigned long)range.length,
+		    (unsigned long)[self numberOfItemsInGroup:group], group);
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Exceptions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3354,12 +3789,13 @@
 {
 	if (block == NULL) return;
 	
-	[self enumerateRowidsInGroup:group usingBlock:^(int64_t rowid, NSUInteger index, BOOL *stop) {
-		
-		YapCollectionKey *ck = nil;
-		id metadata = nil;
-		[self->databaseTransaction getCollectionKey:&ck metadata:&metadata forRowid:rowid];
-		
+	[self enumerateRowsInGroup:group
+	               withOptions:0
+	                     range:NSMakeRange(0, [self numberOfItemsInGroup:group])
+	               withObjects:NO
+	                  metadata:YES
+	                usingBlock:^(YapCollectionKey *ck, id __unused object, id metadata, NSUInteger index, BOOL *stop)
+	{
 		block(ck.collection, ck.key, metadata, index, stop);
 	}];
 }
@@ -3371,14 +3807,13 @@
 {
 	if (block == NULL) return;
 	
-	[self enumerateRowidsInGroup:group
-	                 withOptions:options
-	                  usingBlock:^(int64_t rowid, NSUInteger index, BOOL *stop)
+	[self enumerateRowsInGroup:group
+	               withOptions:options
+	                     range:NSMakeRange(0, [self numberOfItemsInGroup:group])
+	               withObjects:NO
+	                  metadata:YES
+	                usingBlock:^(YapCollectionKey *ck, id __unused object, id metadata, NSUInteger index, BOOL *stop)
 	{
-		YapCollectionKey *ck = nil;
-		id metadata = nil;
-		[self->databaseTransaction getCollectionKey:&ck metadata:&metadata forRowid:rowid];
-						  
 		block(ck.collection, ck.key, metadata, index, stop);
 	}];
 }
@@ -3391,15 +3826,13 @@
 {
 	if (block == NULL) return;
 	
-	[self enumerateRowidsInGroup:group
-	                 withOptions:options
-	                       range:range
-	                  usingBlock:^(int64_t rowid, NSUInteger index, BOOL *stop)
+	[self enumerateRowsInGroup:group
+	               withOptions:options
+	                     range:range
+	               withObjects:NO
+	                  metadata:YES
+	                usingBlock:^(YapCollectionKey *ck, id __unused object, id metadata, NSUInteger index, BOOL *stop)
 	{
-		YapCollectionKey *ck = nil;
-		id metadata = nil;
-		[self->databaseTransaction getCollectionKey:&ck metadata:&metadata forRowid:rowid];
-		
 		block(ck.collection, ck.key, metadata, index, stop);
 	}];
 }
@@ -3444,12 +3877,13 @@
 {
 	if (block == NULL) return;
 	
-	[self enumerateRowidsInGroup:group usingBlock:^(int64_t rowid, NSUInteger index, BOOL *stop) {
-		
-		YapCollectionKey *ck = nil;
-		id object = nil;
-		[self->databaseTransaction getCollectionKey:&ck object:&object forRowid:rowid];
-		
+	[self enumerateRowsInGroup:group
+	               withOptions:0
+	                     range:NSMakeRange(0, [self numberOfItemsInGroup:group])
+	               withObjects:YES
+	                  metadata:NO
+	                usingBlock:^(YapCollectionKey *ck, id object, id __unused metadata, NSUInteger index, BOOL *stop)
+	{
 		block(ck.collection, ck.key, object, index, stop);
 	}];
 }
@@ -3461,14 +3895,13 @@
 {
 	if (block == NULL) return;
 	
-	[self enumerateRowidsInGroup:group
-	                 withOptions:options
-	                  usingBlock:^(int64_t rowid, NSUInteger index, BOOL *stop)
+	[self enumerateRowsInGroup:group
+	               withOptions:options
+	                     range:NSMakeRange(0, [self numberOfItemsInGroup:group])
+	               withObjects:YES
+	                  metadata:NO
+	                usingBlock:^(YapCollectionKey *ck, id object, id __unused metadata, NSUInteger index, BOOL *stop)
 	{
-		YapCollectionKey *ck = nil;
-		id object = nil;
-		[self->databaseTransaction getCollectionKey:&ck object:&object forRowid:rowid];
-		
 		block(ck.collection, ck.key, object, index, stop);
 	}];
 }
@@ -3481,15 +3914,13 @@
 {
 	if (block == NULL) return;
 	
-	[self enumerateRowidsInGroup:group
-	                 withOptions:options
-	                       range:range
-	                  usingBlock:^(int64_t rowid, NSUInteger index, BOOL *stop)
+	[self enumerateRowsInGroup:group
+	               withOptions:options
+	                     range:range
+	               withObjects:YES
+	                  metadata:NO
+	                usingBlock:^(YapCollectionKey *ck, id object, id __unused metadata, NSUInteger index, BOOL *stop)
 	{
-		YapCollectionKey *ck = nil;
-		id object = nil;
-		[self->databaseTransaction getCollectionKey:&ck object:&object forRowid:rowid];
-		
 		block(ck.collection, ck.key, object, index, stop);
 	}];
 }
@@ -3534,13 +3965,13 @@
 {
 	if (block == NULL) return;
 	
-	[self enumerateRowidsInGroup:group usingBlock:^(int64_t rowid, NSUInteger index, BOOL *stop) {
-		
-		YapCollectionKey *ck = nil;
-		id object = nil;
-		id metadata = nil;
-		[self->databaseTransaction getCollectionKey:&ck object:&object metadata:&metadata forRowid:rowid];
-		
+	[self enumerateRowsInGroup:group
+	               withOptions:0
+	                     range:NSMakeRange(0, [self numberOfItemsInGroup:group])
+	               withObjects:YES
+	                  metadata:YES
+	                usingBlock:^(YapCollectionKey *ck, id object, id metadata, NSUInteger index, BOOL *stop)
+	{
 		block(ck.collection, ck.key, object, metadata, index, stop);
 	}];
 }
@@ -3552,15 +3983,13 @@
 {
 	if (block == NULL) return;
 	
-	[self enumerateRowidsInGroup:group
-	                 withOptions:options
-	                  usingBlock:^(int64_t rowid, NSUInteger index, BOOL *stop)
+	[self enumerateRowsInGroup:group
+	               withOptions:options
+	                     range:NSMakeRange(0, [self numberOfItemsInGroup:group])
+	               withObjects:YES
+	                  metadata:YES
+	                usingBlock:^(YapCollectionKey *ck, id object, id metadata, NSUInteger index, BOOL *stop)
 	{
-		YapCollectionKey *ck = nil;
-		id object = nil;
-		id metadata = nil;
-		[self->databaseTransaction getCollectionKey:&ck object:&object metadata:&metadata forRowid:rowid];
-		
 		block(ck.collection, ck.key, object, metadata, index, stop);
 	}];
 }
@@ -3573,16 +4002,13 @@
 {
 	if (block == NULL) return;
 	
-	[self enumerateRowidsInGroup:group
-	                 withOptions:options
-	                       range:range
-	                  usingBlock:^(int64_t rowid, NSUInteger index, BOOL *stop)
+	[self enumerateRowsInGroup:group
+	               withOptions:options
+	                     range:range
+	               withObjects:YES
+	                  metadata:YES
+	                usingBlock:^(YapCollectionKey *ck, id object, id metadata, NSUInteger index, BOOL *stop)
 	{
-		YapCollectionKey *ck = nil;
-		id object = nil;
-		id metadata = nil;
-		[self->databaseTransaction getCollectionKey:&ck object:&object metadata:&metadata forRowid:rowid];
-		
 		block(ck.collection, ck.key, object, metadata, index, stop);
 	}];
 }
@@ -455,6 +455,26 @@ static NSString *const ext_key_class = @"class";
                    inCollection:(NSString *)collection
             unorderedUsingBlock:(void (NS_NOESCAPE^)(NSUInteger keyIndex, int64_t rowid, BOOL *stop))block;
 
+- (void)_enumerateRowsForRowids:(const int64_t *)rowids
+                          count:(NSUInteger)count
+                    withObjects:(BOOL)withObjects
+                       metadata:(BOOL)withMetadata
+            unorderedUsingBlock:(void (NS_NOESCAPE^)(NSUInteger rowidIndex,
+                                                     YapCollectionKey *ck, id _Nullable object, id _Nullable metadata))block;
+
+- (void)bindQueryParameters:(NSArray *)queryParams forStatement:(sqlite3_stmt *)statement withOffset:(int)bind_idx_start;
+
+- (int)_enumerateRowsWithStatement:(sqlite3_stmt *)statement
+                  collectionColumn:(int)column_idx_collection
+                         keyColumn:(int)column_idx_key
+                      objectColumn:(int)column_idx_data
+                    metadataColumn:(int)column_idx_metadata
+                          mutation:(YapMutationStackItem_Bool *)mutation
+                              stop:(nullable BOOL *)stopPtr
+                          rowCount:(nullable NSUInteger *)rowCountPtr
+                        usingBlock:(void (NS_NOESCAPE^)(YapCollectionKey *ck,
+                                                        id _Nullable object, id _Nullable metadata, BOOL *stop))block;
+
 @end
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -106,4 +106,103 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+#pragma mark -
+
+/**
+ * A query that took longer than the slow query threshold.
+ *
+ * @see -[YapDatabaseSecondaryIndexConnection slowQueryThreshold]
+ * @see -[YapDatabaseRTreeIndexConnection slowQueryThreshold]
+ */
+@interface YapDatabaseSlowQuery : NSObject
+
+/** The full SQL statement that was executed (including the part generated by the extension). */
+@property (nonatomic, copy, readonly) NSString *queryString;
+
+/**
+ * The shape of the parameters, e.g. "(integer, text, real)".
+ * The values themselves aren't recorded.
+ */
+@property (nonatomic, copy, readonly) NSString *parameterShape;
+
+/** The number of rows returned by the statement. */
+@property (nonatomic, assign, readonly) NSUInteger rowCount;
+
+/** The time it took to execute the query, including the time spent within the enumeration block (if any). */
+@property (nonatomic, assign, readonly) NSTimeInterval duration;
+
+/** When the query was executed. */
+@property (nonatomic, strong, readonly) NSDate *date;
+
+@end
+
+#pragma mark -
+
+/**
+ * Summary of all the slow queries with the same queryString.
+ */
+@interface YapDatabaseSlowQuerySummary : NSObject
+
+@property (nonatomic, copy, readonly) NSString *queryString;
+
+@property (nonatomic, assign, readonly) NSUInteger count;
+@property (nonatomic, assign, readonly) NSUInteger totalRowCount;
+
+@property (nonatomic, assign, readonly) NSTimeInterval totalDuration;
+@property (nonatomic, assign, readonly) NSTimeInterval maxDuration;
+@property (nonatomic, assign, readonly) NSTimeInterval averageDuration;
+
+@end
+
+#pragma mark -
+
+/**
+ * Records the queries that take longer than a given threshold.
+ *
+ * This is used by the extension connections (one log per connection).
+ * It isn't thread-safe, and is only accessed within the connection's queue.
+ */
+@interface YapDatabaseSlowQueryLog : NSObject
+
+- (instancetype)initWithThreshold:(NSTimeInterval)threshold;
+
+@property (nonatomic, assign, readwrite) NSTimeInterval threshold;
+
+/**
+ * The maximum number of (most recent) queries that are kept.
+ * The summaries aren't affected by this limit (see summaryLimit).
+ *
+ * The default value is 100.
+ */
+@property (nonatomic, assign, readwrite) NSUInteger limit;
+
+/**
+ * The maximum number of summaries (distinct queryStrings) that are kept.
+ *
+ * When a new queryString is recorded and the limit has been reached,
+ * the summary with the smallest totalDuration is evicted to make room.
+ * So the summaries of the most expensive queries are retained.
+ *
+ * The default value is 100.
+ */
+@property (nonatomic, assign, readwrite) NSUInteger summaryLimit;
+
+/**
+ * Records the query, if the duration exceeds the threshold.
+ */
+- (void)recordQueryString:(NSString *)queryString
+               parameters:(nullable NSArray *)parameters
+                 rowCount:(NSUInteger)rowCount
+                 duration:(NSTimeInterval)duration;
+
+/** The most recent slow queries (oldest first). */
+- (NSArray<YapDatabaseSlowQuery *> *)queries;
+
+/** A summary per queryString, sorted by totalDuration (slowest first). */
+- (NSArray<YapDatabaseSlowQuerySummary *> *)summaries;
+
+- (void)removeAllQueries;
+
+@end
+
 NS_ASSUME_NONNULL_END
@@ -357,3 +357,284 @@
 }
 
 @end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@interface YapDatabaseSlowQuery ()
+
+- (instancetype)initWithQueryString:(NSString *)queryString
+                     parameterShape:(NSString *)parameterShape
+                           rowCount:(NSUInteger)rowCount
+                           duration:(NSTimeInterval)duration;
+
+@end
+
+@interface YapDatabaseSlowQuerySummary () {
+@public
+	
+	NSUInteger count;
+	NSUInteger totalRowCount;
+	NSTimeInterval totalDuration;
+	NSTimeInterval maxDuration;
+}
+
+- (instancetype)initWithQueryString:(NSString *)queryString;
+
+@end
+
+@implementation YapDatabaseSlowQuery
+
+@synthesize queryString = queryString;
+@synthesize parameterShape = parameterShape;
+@synthesize rowCount = rowCount;
+@synthesize duration = duration;
+@synthesize date = date;
+
+- (instancetype)initWithQueryString:(NSString *)inQueryString
+                     parameterShape:(NSString *)inParameterShape
+                           rowCount:(NSUInteger)inRowCount
+                           duration:(NSTimeInterval)inDuration
+{
+	if ((self = [super init]))
+	{
+		queryString = [inQueryString copy];
+		parameterShape = [inParameterShape copy];
+		rowCount = inRowCount;
+		duration = inDuration;
+		date = [NSDate date];
+	}
+	return self;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<YapDatabaseSlowQuery: %.6f sec, %lu rows, %@ %@>",
+	          duration, (unsigned long)rowCount, queryString, parameterShape];
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation YapDatabaseSlowQuerySummary
+
+@synthesize queryString = queryString;
+@synthesize count = count;
+@synthesize totalRowCount = totalRowCount;
+@synthesize totalDuration = totalDuration;
+@synthesize maxDuration = maxDuration;
+
+@dynamic averageDuration;
+
+- (instancetype)initWithQueryString:(NSString *)inQueryString
+{
+	if ((self = [super init]))
+	{
+		queryString = [inQueryString copy];
+	}
+	return self;
+}
+
+- (NSTimeInterval)averageDuration
+{
+	return (count > 0) ? (totalDuration / count) : 0.0;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"<YapDatabaseSlowQuerySummary: count=%lu total=%.6f max=%.6f avg=%.6f, %@>",
+	          (unsigned long)count, totalDuration, maxDuration, [self averageDuration], queryString];
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation YapDatabaseSlowQueryLog
+{
+	NSMutableArray<YapDatabaseSlowQuery *> *queries;
+	NSMutableDictionary<NSString *, YapDatabaseSlowQuerySummary *> *summaries;
+}
+
+@synthesize threshold = threshold;
+@synthesize limit = limit;
+@synthesize summaryLimit = summaryLimit;
+
+- (instancetype)initWithThreshold:(NSTimeInterval)inThreshold
+{
+	if ((self = [super init]))
+	{
+		threshold = inThreshold;
+		limit = 100;
+		summaryLimit = 100;
+		
+		queries = [[NSMutableArray alloc] init];
+		summaries = [[NSMutableDictionary alloc] init];
+	}
+	return self;
+}
+
+/**
+ * Describes the parameters by type only.
+ * Parameter values may contain user data, so we never log them.
+**/
++ (NSString *)shapeOfParameters:(NSArray *)parameters
+{
+	NSMutableArray<NSString *> *types = [NSMutableArray arrayWithCapacity:parameters.count];
+	
+	for (id param in parameters)
+	{
+		if ([param isKindOfClass:[NSNumber class]])
+		{
+			CFNumberType numberType = CFNumberGetType((__bridge CFNumberRef)param);
+			
+			if (numberType == kCFNumberFloat32Type ||
+			    numberType == kCFNumberFloat64Type ||
+			    numberType == kCFNumberFloatType   ||
+			    numberType == kCFNumberDoubleType  ||
+			    numberType == kCFNumberCGFloatType  )
+			{
+				[types addObject:@"real"];
+			}
+			else
+			{
+				[types addObject:@"integer"];
+			}
+		}
+		else if ([param isKindOfClass:[NSDate class]])
+		{
+			[types addObject:@"real"];
+		}
+		else if ([param isKindOfClass:[NSString class]])
+		{
+			[types addObject:@"text"];
+		}
+		else if ([param isKindOfClass:[NSData class]])
+		{
+			[types addObject:@"blob"];
+		}
+		else if ([param isKindOfClass:[NSNull class]])
+		{
+			[types addObject:@"null"];
+		}
+		else
+		{
+			[types addObject:NSStringFromClass([param class])];
+		}
+	}
+	
+	return [NSString stringWithFormat:@"(%@)", [types componentsJoinedByString:@", "]];
+}
+
+- (void)recordQueryString:(NSString *)queryString
+               parameters:(NSArray *)parameters
+                 rowCount:(NSUInteger)rowCount
+                 duration:(NSTimeInterval)duration
+{
+	if (duration < threshold) return;
+	if (queryString == nil) return;
+	
+	NSString *parameterShape = [[self class] shapeOfParameters:parameters];
+	
+	YapDatabaseSlowQuery *query =
+	  [[YapDatabaseSlowQuery alloc] initWithQueryString:queryString
+	                                     parameterShape:parameterShape
+	                                           rowCount:rowCount
+	                                           duration:duration];
+	
+	[queries addObject:query];
+	if (queries.count > limit)
+	{
+		[queries removeObjectsInRange:NSMakeRange(0, queries.count - limit)];
+	}
+	
+	YapDatabaseSlowQuerySummary *summary = summaries[queryString];
+	if (summary == nil && summaryLimit > 0)
+	{
+		while (summaries.count >= summaryLimit)
+		{
+			[self removeCheapestSummary];
+		}
+		
+		summary = [[YapDatabaseSlowQuerySummary alloc] initWithQueryString:queryString];
+		summaries[queryString] = summary;
+	}
+	
+	if (summary)
+	{
+		summary->count++;
+		summary->totalRowCount += rowCount;
+		summary->totalDuration += duration;
+		summary->maxDuration = MAX(summary->maxDuration, duration);
+	}
+	
+	YDBLogInfo(@"Slow query: %@", query);
+}
+
+/**
+ * Evicts the summary with the smallest totalDuration.
+ * This is a linear scan, but the number of summaries is bounded by the (small) summaryLimit.
+**/
+- (void)removeCheapestSummary
+{
+	NSString *cheapestQueryString = nil;
+	NSTimeInterval cheapestDuration = 0.0;
+	
+	for (YapDatabaseSlowQuerySummary *summary in [summaries objectEnumerator])
+	{
+		if (cheapestQueryString == nil || summary->totalDuration < cheapestDuration)
+		{
+			cheapestQueryString = summary.queryString;
+			cheapestDuration = summary->totalDuration;
+		}
+	}
+	
+	if (cheapestQueryString)
+		[summaries removeObjectForKey:cheapestQueryString];
+}
+
+- (NSArray<YapDatabaseSlowQuery *> *)queries
+{
+	return [queries copy];
+}
+
+- (NSArray<YapDatabaseSlowQuerySummary *> *)summaries
+{
+	// Return copies, so the caller doesn't see later updates
+	
+	NSMutableArray<YapDatabaseSlowQuerySummary *> *result = [NSMutableArray arrayWithCapacity:summaries.count];
+	
+	for (YapDatabaseSlowQuerySummary *summary in [summaries objectEnumerator])
+	{
+		YapDatabaseSlowQuerySummary *copy = [[YapDatabaseSlowQuerySummary alloc] initWithQueryString:summary.queryString];
+		copy->count = summary->count;
+		copy->totalRowCount = summary->totalRowCount;
+		copy->totalDuration = summary->totalDuration;
+		copy->maxDuration = summary->maxDuration;
+		
+		[result addObject:copy];
+	}
+	
+	[result sortUsingComparator:^NSComparisonResult(YapDatabaseSlowQuerySummary *s1, YapDatabaseSlowQuerySummary *s2) {
+		
+		if (s1->totalDuration > s2->totalDuration) return NSOrderedAscending;
+		if (s1->totalDuration < s2->totalDuration) return NSOrderedDescending;
+		return NSOrderedSame;
+	}];
+	
+	return result;
+}
+
+- (void)removeAllQueries
+{
+	[queries removeAllObjects];
+	[summaries removeAllObjects];
+}
+
+@end
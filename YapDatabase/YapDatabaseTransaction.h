@@ -4,6 +4,7 @@
 
 @class YapDatabaseConnection;
 @class YapDatabaseExtensionTransaction;
+@class YapDatabaseQuery;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -463,6 +464,60 @@ NS_REFINED_FOR_SWIFT;
 - (nullable __kindof YapDatabaseExtensionTransaction *)extension:(NSString *)extensionName;
 - (nullable __kindof YapDatabaseExtensionTransaction *)ext:(NSString *)extensionName; // <-- Shorthand (same as extension: method)
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Combined Queries
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Enumerates the rows that match ALL of the given queries,
+ * where each query is performed against the extension registered under the corresponding name.
+ *
+ * For example, to find items matching a text search, within a bounding box, and with a particular status:
+ *
+ * NSDictionary *queries = @{
+ *   @"fts"   : [[transaction ext:@"fts"] queryMatching:@"coffee"],
+ *   @"rtree" : [YapDatabaseQuery queryWithFormat:@"WHERE minLon > ? AND maxLon < ?", @(minLon), @(maxLon)],
+ *   @"idx"   : [YapDatabaseQuery queryWithFormat:@"WHERE status = ?", @(3)]
+ * };
+ *
+ * [transaction enumerateKeysMatchingQueries:queries usingBlock:^(NSString *collection, NSString *key, BOOL *stop){
+ *     ...
+ * }];
+ *
+ * The queries are compiled into a single statement, which joins the extension tables (on rowid).
+ * So sqlite chooses the best order in which to evaluate them (e.g. the most selective one first),
+ * and the results are streamed back without collecting intermediate sets of rowids.
+ *
+ * Each query is a regular "WHERE ..." clause against the extension's table (just as you would pass to the extension).
+ * However, the results are returned in no particular order, so ORDER BY & LIMIT clauses aren't recommended.
+ * Aggregate queries aren't supported.
+ *
+ * The supported extensions are: YapDatabaseSecondaryIndex, YapDatabaseRTreeIndex & YapDatabaseFullTextSearch.
+ *
+ * @return
+ *   NO if any of the extensions isn't registered (or doesn't support combined queries),
+ *   or if there was a problem with the query. YES otherwise.
+ */
+- (BOOL)enumerateKeysMatchingQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries
+                          usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block;
+
+- (BOOL)enumerateKeysAndMetadataMatchingQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries
+                                     usingBlock:
+                    (void (NS_NOESCAPE^)(NSString *collection, NSString *key, __nullable id metadata, BOOL *stop))block;
+
+- (BOOL)enumerateKeysAndObjectsMatchingQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries
+                                    usingBlock:
+                    (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, BOOL *stop))block;
+
+- (BOOL)enumerateRowsMatchingQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries
+                          usingBlock:
+        (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, __nullable id metadata, BOOL *stop))block;
+
+/**
+ * Skips the enumeration process, and just gives you the count of rows matching ALL of the given queries.
+ */
+- (BOOL)getNumberOfRows:(NSUInteger *)count matchingQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries;
+
 NS_ASSUME_NONNULL_END
 @end
 
@@ -2,6 +2,7 @@
 
 #import "YapDatabasePrivate.h"
 #import "YapDatabaseExtensionPrivate.h"
+#import "YapDatabaseQuery.h"
 #import "YapDatabaseString.h"
 #import "YapDatabaseLogging.h"
 #import "YapCache.h"
@@ -4161,6 +4162,387 @@
 	FreeYapDatabaseString(&_collection);
 }
 
+/**
+ * Fetches the collection/key, object and/or metadata for each given rowid.
+ *
+ * Items that are fully cached are delivered first.
+ * The remainder are fetched using "WHERE rowid IN (?, ?, ...)" queries,
+ * which avoids a separate sqlite round trip (and statement reset) per row.
+ * Fetched items are added to the connection's caches.
+ *
+ * The items are delivered unordered, which is why the block has a rowidIndex parameter.
+ * If a rowid doesn't exist in the database, the block is never invoked for its rowidIndex.
+**/
+- (void)_enumerateRowsForRowids:(const int64_t *)rowids
+                          count:(NSUInteger)count
+                    withObjects:(BOOL)withObjects
+                       metadata:(BOOL)withMetadata
+            unorderedUsingBlock:(void (NS_NOESCAPE^)(NSUInteger rowidIndex,
+                                                     YapCollectionKey *ck, id object, id metadata))block
+{
+	if (block == NULL) return;
+	if (count == 0) return;
+	
+	// Check the cache first
+	
+	NSMutableArray *missingIndexes = [NSMutableArray arrayWithCapacity:count];
+	
+	for (NSUInteger rowidIndex = 0; rowidIndex < count; rowidIndex++)
+	{
+		YapCollectionKey *ck = [connection->keyCache objectForKey:@(rowids[rowidIndex])];
+		if (ck == nil)
+		{
+			[missingIndexes addObject:@(rowidIndex)];
+			continue;
+		}
+		
+		id object = nil;
+		if (withObjects)
+		{
+			object = [connection->objectCache objectForKey:ck];
+			if (object == nil)
+			{
+				[missingIndexes addObject:@(rowidIndex)];
+				continue;
+			}
+		}
+		
+		id metadata = nil;
+		if (withMetadata)
+		{
+			metadata = [connection->metadataCache objectForKey:ck];
+			if (metadata == nil)
+			{
+				[missingIndexes addObject:@(rowidIndex)];
+				continue;
+			}
+			
+			if (metadata == [YapNull null])
+				metadata = nil;
+		}
+		
+		block(rowidIndex, ck, object, metadata);
+	}
+	
+	if ([missingIndexes count] == 0) {
+		return;
+	}
+	
+	// Go to database for any missing rowids
+	
+	NSString *lastCollection = nil;
+	YapDatabaseDeserializer objectDeserializer = NULL;
+	YapDatabaseDeserializer metadataDeserializer = NULL;
+	
+	NSMutableDictionary *rowidIndexDict = nil;
+	
+	// Sqlite has an upper bound on the number of host parameters that may be used in a single query.
+	// We need to watch out for this in case a large array of rowids is passed.
+	
+	NSUInteger maxHostParams = (NSUInteger) sqlite3_limit(connection->db, SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+	NSUInteger offset = 0;
+	
+	do
+	{
+		// Determine how many parameters to use in the query
+		
+		NSUInteger numRowidParams = MIN([missingIndexes count] - offset, maxHostParams);
+		
+		// Create the SQL query:
+		//
+		// SELECT "rowid", "collection", "key", "data", "metadata" FROM "database2" WHERE "rowid" IN (?, ?, ...);
+		
+		int const column_idx_rowid      = SQLITE_COLUMN_START + 0;
+		int const column_idx_collection = SQLITE_COLUMN_START + 1;
+		int const column_idx_key        = SQLITE_COLUMN_START + 2;
+		int const column_idx_data       = SQLITE_COLUMN_START + 3;
+		int const column_idx_metadata   = SQLITE_COLUMN_START + 4;
+		
+		NSUInteger capacity = 100 + (numRowidParams * 3);
+		NSMutableString *query = [NSMutableString stringWithCapacity:capacity];
+		
+		[query appendString:@"SELECT \"rowid\", \"collection\", \"key\", \"data\", \"metadata\" FROM \"database2\""];
+		[query appendString:@" WHERE \"rowid\" IN ("];
+		
+		NSUInteger i;
+		for (i = 0; i < numRowidParams; i++)
+		{
+			if (i == 0)
+				[query appendString:@"?"];
+			else
+				[query appendString:@", ?"];
+		}
+		
+		[query appendString:@");"];
+		
+		sqlite3_stmt *statement;
+		
+		int status = sqlite3_prepare_v2(connection->db, [query UTF8String], -1, &statement, NULL);
+		if (status != SQLITE_OK)
+		{
+			YDBLogError(@"Error creating 'rowsForRowids' statement: %d %s",
+			            status, sqlite3_errmsg(connection->db));
+			break;
+		}
+		
+		// Bind parameters.
+		
+		if (rowidIndexDict == nil)
+			rowidIndexDict = [NSMutableDictionary dictionaryWithCapacity:numRowidParams];
+		else
+			[rowidIndexDict removeAllObjects];
+		
+		for (i = 0; i < numRowidParams; i++)
+		{
+			NSNumber *rowidIndexNumber = missingIndexes[offset + i];
+			int64_t rowid = rowids[[rowidIndexNumber unsignedIntegerValue]];
+			
+			[rowidIndexDict setObject:rowidIndexNumber forKey:@(rowid)];
+			
+			sqlite3_bind_int64(statement, (int)(SQLITE_BIND_START + i), rowid);
+		}
+		
+		// Execute the query and step over the results
+		
+		while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+		{
+			int64_t rowid = sqlite3_column_int64(statement, column_idx_rowid);
+			NSNumber *rowidNumber = @(rowid);
+			
+			NSUInteger rowidIndex = [[rowidIndexDict objectForKey:rowidNumber] unsignedIntegerValue];
+			
+			YapCollectionKey *ck = [connection->keyCache objectForKey:rowidNumber];
+			if (ck == nil)
+			{
+				const unsigned char *text0 = sqlite3_column_text(statement, column_idx_collection);
+				int textSize0 = sqlite3_column_bytes(statement, column_idx_collection);
+				
+				const unsigned char *text1 = sqlite3_column_text(statement, column_idx_key);
+				int textSize1 = sqlite3_column_bytes(statement, column_idx_key);
+				
+				NSString *collection =
+				  [[NSString alloc] initWithBytes:text0 length:textSize0 encoding:NSUTF8StringEncoding];
+				NSString *key =
+				  [[NSString alloc] initWithBytes:text1 length:textSize1 encoding:NSUTF8StringEncoding];
+				
+				ck = [[YapCollectionKey alloc] initWithCollection:collection key:key];
+				
+				[connection->keyCache setObject:ck forKey:rowidNumber];
+			}
+			
+			if (![ck.collection isEqualToString:lastCollection])
+			{
+				lastCollection = ck.collection;
+				objectDeserializer = nil;
+				metadataDeserializer = nil;
+			}
+			
+			// Note: When we checked the caches (above),
+			// we could only process the item if everything requested was cached.
+			// So it's worthwhile to check each individual cache here.
+			
+			id object = nil;
+			if (withObjects)
+			{
+				object = [connection->objectCache objectForKey:ck];
+				if (object == nil)
+				{
+					if (objectDeserializer == nil)
+						objectDeserializer = [connection->database objectDeserializerForCollection:ck.collection];
+					
+					const void *oBlob = sqlite3_column_blob(statement, column_idx_data);
+					int oBlobSize = sqlite3_column_bytes(statement, column_idx_data);
+					
+					NSData *oData = [NSData dataWithBytesNoCopy:(void *)oBlob length:oBlobSize freeWhenDone:NO];
+					object = objectDeserializer(ck.collection, ck.key, oData);
+					
+					if (object)
+						[connection->objectCache setObject:object forKey:ck];
+				}
+			}
+			
+			id metadata = nil;
+			if (withMetadata)
+			{
+				metadata = [connection->metadataCache objectForKey:ck];
+				if (metadata)
+				{
+					if (metadata == [YapNull null])
+						metadata = nil;
+				}
+				else
+				{
+					const void *mBlob = sqlite3_column_blob(statement, column_idx_metadata);
+					int mBlobSize = sqlite3_column_bytes(statement, column_idx_metadata);
+					
+					if (mBlobSize > 0)
+					{
+						if (metadataDeserializer == nil)
+							metadataDeserializer =
+							  [connection->database metadataDeserializerForCollection:ck.collection];
+						
+						NSData *mData = [NSData dataWithBytesNoCopy:(void *)mBlob length:mBlobSize freeWhenDone:NO];
+						metadata = metadataDeserializer(ck.collection, ck.key, mData);
+					}
+					
+					if (metadata)
+						[connection->metadataCache setObject:metadata forKey:ck];
+					else
+						[connection->metadataCache setObject:[YapNull null] forKey:ck];
+				}
+			}
+			
+			block(rowidIndex, ck, object, metadata);
+		}
+		
+		if (status != SQLITE_DONE)
+		{
+			YDBLogError(@"sqlite_step error: %d %s", status, sqlite3_errmsg(connection->db));
+		}
+		
+		sqlite3_finalize(statement);
+		statement = NULL;
+		
+		offset += numRowidParams;
+		
+	} while (offset < [missingIndexes count]);
+}
+
+/**
+ * Steps over the given (prepared & bound) statement, and delivers the collection/key,
+ * object and/or metadata for each row.
+ *
+ * The statement must select the collection & key, and (optionally) the serialized object & metadata,
+ * at the given column indexes. Pass a negative column index to skip the object or metadata.
+ * Objects & metadata that are already in the connection's cache are taken from the cache (and not deserialized).
+ *
+ * Enumeration stops if the block sets stop, or if the given mutation item is marked as mutated.
+ * The caller is responsible for resetting (or finalizing) the statement,
+ * and for throwing the mutationDuringEnumerationException.
+ *
+ * Returns the status of the last sqlite3_step (SQLITE_DONE if every row was enumerated).
+**/
+- (int)_enumerateRowsWithStatement:(sqlite3_stmt *)statement
+                  collectionColumn:(int)column_idx_collection
+                         keyColumn:(int)column_idx_key
+                      objectColumn:(int)column_idx_data
+                    metadataColumn:(int)column_idx_metadata
+                          mutation:(YapMutationStackItem_Bool *)mutation
+                              stop:(BOOL *)stopPtr
+                          rowCount:(NSUInteger *)rowCountPtr
+                        usingBlock:(void (NS_NOESCAPE^)(YapCollectionKey *ck, id object, id metadata, BOOL *stop))block
+{
+	BOOL withObjects = (column_idx_data >= 0);
+	BOOL withMetadata = (column_idx_metadata >= 0);
+	
+	BOOL unlimitedObjectCacheLimit = (connection->objectCacheLimit == 0);
+	BOOL unlimitedMetadataCacheLimit = (connection->metadataCacheLimit == 0);
+	
+	NSString *lastCollection = nil;
+	YapDatabaseDeserializer objectDeserializer = NULL;
+	YapDatabaseDeserializer metadataDeserializer = NULL;
+	
+	NSUInteger rowCount = 0;
+	BOOL stop = NO;
+	
+	int status;
+	while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+	{
+		const unsigned char *text0 = sqlite3_column_text(statement, column_idx_collection);
+		int textSize0 = sqlite3_column_bytes(statement, column_idx_collection);
+		
+		const unsigned char *text1 = sqlite3_column_text(statement, column_idx_key);
+		int textSize1 = sqlite3_column_bytes(statement, column_idx_key);
+		
+		NSString *collection = [[NSString alloc] initWithBytes:text0 length:textSize0 encoding:NSUTF8StringEncoding];
+		NSString *key        = [[NSString alloc] initWithBytes:text1 length:textSize1 encoding:NSUTF8StringEncoding];
+		
+		if (lastCollection == nil || ![lastCollection isEqualToString:collection])
+		{
+			lastCollection = collection;
+			objectDeserializer = withObjects ? [connection->database objectDeserializerForCollection:collection] : NULL;
+			metadataDeserializer = withMetadata ? [connection->database metadataDeserializerForCollection:collection] : NULL;
+		}
+		
+		YapCollectionKey *ck = [[YapCollectionKey alloc] initWithCollection:collection key:key];
+		
+		id object = nil;
+		if (withObjects)
+		{
+			object = [connection->objectCache objectForKey:ck];
+			if (object == nil)
+			{
+				const void *oBlob = sqlite3_column_blob(statement, column_idx_data);
+				int oBlobSize = sqlite3_column_bytes(statement, column_idx_data);
+				
+				// Performance tuning:
+				// Use dataWithBytesNoCopy to avoid an extra allocation and memcpy.
+				
+				NSData *oData = [NSData dataWithBytesNoCopy:(void *)oBlob length:oBlobSize freeWhenDone:NO];
+				object = objectDeserializer(collection, key, oData);
+				
+				// Cache considerations:
+				// The cache should generally be reserved for items that are explicitly fetched,
+				// and we don't want to crowd them out during enumerations.
+				
+				if (unlimitedObjectCacheLimit || [connection->objectCache count] < connection->objectCacheLimit)
+				{
+					if (object)
+						[connection->objectCache setObject:object forKey:ck];
+				}
+			}
+		}
+		
+		id metadata = nil;
+		if (withMetadata)
+		{
+			metadata = [connection->metadataCache objectForKey:ck];
+			if (metadata)
+			{
+				if (metadata == [YapNull null])
+					metadata = nil;
+			}
+			else
+			{
+				const void *mBlob = sqlite3_column_blob(statement, column_idx_metadata);
+				int mBlobSize = sqlite3_column_bytes(statement, column_idx_metadata);
+				
+				if (mBlobSize > 0)
+				{
+					// Performance tuning:
+					// Use dataWithBytesNoCopy to avoid an extra allocation and memcpy.
+					
+					NSData *mData = [NSData dataWithBytesNoCopy:(void *)mBlob length:mBlobSize freeWhenDone:NO];
+					metadata = metadataDeserializer(collection, key, mData);
+				}
+				
+				if (unlimitedMetadataCacheLimit || [connection->metadataCache count] < connection->metadataCacheLimit)
+				{
+					if (metadata)
+						[connection->metadataCache setObject:metadata forKey:ck];
+					else
+						[connection->metadataCache setObject:[YapNull null] forKey:ck];
+				}
+			}
+		}
+		
+		rowCount++;
+		block(ck, object, metadata, &stop);
+		
+		if (stop || mutation.isMutated) break;
+	}
+	
+	if ((status != SQLITE_DONE) && !stop && !mutation.isMutated)
+	{
+		YDBLogError(@"sqlite_step error: %d %s", status, sqlite3_errmsg(connection->db));
+	}
+	
+	if (stopPtr) *stopPtr = stop;
+	if (rowCountPtr) *rowCountPtr = rowCount;
+	
+	return status;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Extensions
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -4295,6 +4677,317 @@
 	return orderedExtensions;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Combined Queries
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Internal method.
+ *
+ * Returns the JOIN clause(s) for the given queries (keyed by extension name),
+ * and appends the corresponding query parameters (in the same order).
+ *
+ * Each extension provides a statement that selects the rowids matching its query.
+ * These are joined (as subqueries) to the database2 table on rowid:
+ *
+ * JOIN (SELECT "rowid" FROM "tableName" <query>) AS "m0" ON "m0"."rowid" = "database2"."rowid"
+ *
+ * Simple subqueries are flattened by sqlite into the outer query,
+ * so sqlite is free to choose the order in which the tables are searched.
+**/
+- (NSString *)joinClauseForQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries
+                        parameters:(NSMutableArray *)parameters
+{
+	if ([queries count] == 0) return nil;
+	
+	NSMutableString *joinClause = [NSMutableString stringWithCapacity:256];
+	NSUInteger joinIndex = 0;
+	
+	// Sort the extension names, so a given set of queries always produces the same statement.
+	
+	NSArray<NSString *> *extNames = [[queries allKeys] sortedArrayUsingSelector:@selector(compare:)];
+	for (NSString *extName in extNames)
+	{
+		YapDatabaseQuery *query = queries[extName];
+		
+		YapDatabaseExtensionTransaction *extTransaction = [self extension:extName];
+		NSString *rowidQueryString = [extTransaction rowidQueryStringForQuery:query];
+		
+		if (rowidQueryString == nil)
+		{
+			YDBLogWarn(@"Unable to perform combined query: extension(%@) isn't registered,"
+			           @" or doesn't support the given query", extName);
+			return nil;
+		}
+		
+		[joinClause appendFormat:@" JOIN (%@) AS \"m%lu\" ON \"m%lu\".\"rowid\" = \"database2\".\"rowid\"",
+		                         rowidQueryString, (unsigned long)joinIndex, (unsigned long)joinIndex];
+		
+		[parameters addObjectsFromArray:query.queryParameters];
+		joinIndex++;
+	}
+	
+	return joinClause;
+}
+
+/**
+ * Binds the query parameters (NSNumber, NSDate & NSString) in order, starting with the given index.
+ *
+ * This is shared by the query-based extensions (SecondaryIndex, RTreeIndex), and the combined queries.
+**/
+- (void)bindQueryParameters:(NSArray *)queryParams forStatement:(sqlite3_stmt *)statement withOffset:(int)bind_idx_start
+{
+	int bind_idx = bind_idx_start;
+	
+	for (id value in queryParams)
+	{
+		if ([value isKindOfClass:[NSNumber class]])
+		{
+			__unsafe_unretained NSNumber *cast = (NSNumber *)value;
+			
+			CFNumberType numType = CFNumberGetType((__bridge CFNumberRef)cast);
+			
+			if (numType == kCFNumberFloatType   ||
+			    numType == kCFNumberFloat32Type ||
+			    numType == kCFNumberFloat64Type ||
+			    numType == kCFNumberDoubleType  ||
+			    numType == kCFNumberCGFloatType  )
+			{
+				double num = [cast doubleValue];
+				sqlite3_bind_double(statement, bind_idx, num);
+			}
+			else
+			{
+				int64_t num = [cast longLongValue];
+				sqlite3_bind_int64(statement, bind_idx, (sqlite3_int64)num);
+			}
+		}
+		else if ([value isKindOfClass:[NSDate class]])
+		{
+			__unsafe_unretained NSDate *cast = (NSDate *)value;
+			
+			double num = [cast timeIntervalSinceReferenceDate];
+			sqlite3_bind_double(statement, bind_idx, num);
+		}
+		else if ([value isKindOfClass:[NSString class]])
+		{
+			__unsafe_unretained NSString *cast = (NSString *)value;
+			
+			sqlite3_bind_text(statement, bind_idx, [cast UTF8String], -1, SQLITE_TRANSIENT);
+		}
+		else
+		{
+			YDBLogWarn(@"Unable to bind value for with unsupported class: %@", NSStringFromClass([value class]));
+		}
+		
+		bind_idx++;
+	}
+}
+
+/**
+ * Internal method.
+ *
+ * Executes the combined query as a single statement, and enumerates the matching rows.
+ * Objects & metadata that are already in the connection's cache are taken from the cache (and not deserialized).
+**/
+- (BOOL)_enumerateRowsMatchingQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries
+                          withObjects:(BOOL)withObjects
+                             metadata:(BOOL)withMetadata
+                           usingBlock:(void (NS_NOESCAPE^)(YapCollectionKey *ck, id object, id metadata, BOOL *stop))block
+{
+	NSMutableArray *parameters = [NSMutableArray array];
+	
+	NSString *joinClause = [self joinClauseForQueries:queries parameters:parameters];
+	if (joinClause == nil) return NO;
+	
+	// SELECT "database2"."collection", "database2"."key" [, "database2"."data"] [, "database2"."metadata"]
+	//   FROM "database2" JOIN (...) AS "m0" ON "m0"."rowid" = "database2"."rowid" [JOIN ...];
+	
+	NSMutableString *fullQueryString = [NSMutableString stringWithCapacity:512];
+	[fullQueryString appendString:@"SELECT \"database2\".\"collection\", \"database2\".\"key\""];
+	
+	if (withObjects)
+		[fullQueryString appendString:@", \"database2\".\"data\""];
+	if (withMetadata)
+		[fullQueryString appendString:@", \"database2\".\"metadata\""];
+	
+	[fullQueryString appendFormat:@" FROM \"database2\"%@;", joinClause];
+	
+	sqlite3 *db = connection->db;
+	sqlite3_stmt *statement = NULL;
+	
+	int status = sqlite3_prepare_v2(db, [fullQueryString UTF8String], -1, &statement, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Error creating query:\n query: '%@'\n error: %d %s",
+		            fullQueryString, status, sqlite3_errmsg(db));
+		return NO;
+	}
+	
+	[self bindQueryParameters:parameters forStatement:statement withOffset:SQLITE_BIND_START];
+	
+	int const column_idx_collection = SQLITE_COLUMN_START + 0;
+	int const column_idx_key        = SQLITE_COLUMN_START + 1;
+	int const column_idx_data       = withObjects  ? (column_idx_key + 1) : -1;
+	int const column_idx_metadata   = withMetadata ? (column_idx_key + (withObjects ? 2 : 1)) : -1;
+	
+	BOOL stop = NO;
+	YapMutationStackItem_Bool *mutation = [connection->mutationStack push]; // mutation during enumeration protection
+	
+	status = [self _enumerateRowsWithStatement:statement
+	                          collectionColumn:column_idx_collection
+	                                 keyColumn:column_idx_key
+	                              objectColumn:column_idx_data
+	                            metadataColumn:column_idx_metadata
+	                                  mutation:mutation
+	                                      stop:&stop
+	                                  rowCount:NULL
+	                                usingBlock:block];
+	
+	sqlite3_finalize(statement);
+	
+	if (!stop && mutation.isMutated)
+	{
+		@throw [self mutationDuringEnumerationException];
+	}
+	
+	return (stop || status == SQLITE_DONE);
+}
+
+- (BOOL)enumerateKeysMatchingQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries
+                          usingBlock:(void (NS_NOESCAPE^)(NSString *collection, NSString *key, BOOL *stop))block
+{
+	// This method is PUBLIC
+	
+	return [self _enumerateRowsMatchingQueries:queries
+	                               withObjects:NO
+	                                  metadata:NO
+	                                usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
+		if (block == NULL) // Query test : caller still wants BOOL result
+		{
+			*stop = YES;
+			return; // from block
+		}
+		
+		block(ck.collection, ck.key, stop);
+	}];
+}
+
+- (BOOL)enumerateKeysAndMetadataMatchingQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries
+                                     usingBlock:
+                    (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id metadata, BOOL *stop))block
+{
+	// This method is PUBLIC
+	
+	return [self _enumerateRowsMatchingQueries:queries
+	                               withObjects:NO
+	                                  metadata:(block != NULL)
+	                                usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
+		if (block == NULL) // Query test : caller still wants BOOL result
+		{
+			*stop = YES;
+			return; // from block
+		}
+		
+		block(ck.collection, ck.key, metadata, stop);
+	}];
+}
+
+- (BOOL)enumerateKeysAndObjectsMatchingQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries
+                                    usingBlock:
+                    (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, BOOL *stop))block
+{
+	// This method is PUBLIC
+	
+	return [self _enumerateRowsMatchingQueries:queries
+	                               withObjects:(block != NULL)
+	                                  metadata:NO
+	                                usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
+		if (block == NULL) // Query test : caller still wants BOOL result
+		{
+			*stop = YES;
+			return; // from block
+		}
+		
+		block(ck.collection, ck.key, object, stop);
+	}];
+}
+
+- (BOOL)enumerateRowsMatchingQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries
+                          usingBlock:
+        (void (NS_NOESCAPE^)(NSString *collection, NSString *key, id object, id metadata, BOOL *stop))block
+{
+	// This method is PUBLIC
+	
+	return [self _enumerateRowsMatchingQueries:queries
+	                               withObjects:(block != NULL)
+	                                  metadata:(block != NULL)
+	                                usingBlock:^(YapCollectionKey *ck, id object, id metadata, BOOL *stop)
+	{
+		if (block == NULL) // Query test : caller still wants BOOL result
+		{
+			*stop = YES;
+			return; // from block
+		}
+		
+		block(ck.collection, ck.key, object, metadata, stop);
+	}];
+}
+
+- (BOOL)getNumberOfRows:(NSUInteger *)countPtr matchingQueries:(NSDictionary<NSString *, YapDatabaseQuery *> *)queries
+{
+	// This method is PUBLIC
+	
+	NSMutableArray *parameters = [NSMutableArray array];
+	
+	NSString *joinClause = [self joinClauseForQueries:queries parameters:parameters];
+	if (joinClause == nil)
+	{
+		if (countPtr) *countPtr = 0;
+		return NO;
+	}
+	
+	NSString *fullQueryString =
+	  [NSString stringWithFormat:@"SELECT COUNT(*) AS NumberOfRows FROM \"database2\"%@;", joinClause];
+	
+	sqlite3 *db = connection->db;
+	sqlite3_stmt *statement = NULL;
+	
+	int status = sqlite3_prepare_v2(db, [fullQueryString UTF8String], -1, &statement, NULL);
+	if (status != SQLITE_OK)
+	{
+		YDBLogError(@"Error creating query:\n query: '%@'\n error: %d %s",
+		            fullQueryString, status, sqlite3_errmsg(db));
+		
+		if (countPtr) *countPtr = 0;
+		return NO;
+	}
+	
+	[self bindQueryParameters:parameters forStatement:statement withOffset:SQLITE_BIND_START];
+	
+	BOOL result = YES;
+	NSUInteger count = 0;
+	
+	status = sqlite3_step(statement);
+	if (status == SQLITE_ROW)
+	{
+		count = (NSUInteger)sqlite3_column_int64(statement, SQLITE_COLUMN_START);
+	}
+	else
+	{
+		YDBLogError(@"sqlite_step error: %d %s", status, sqlite3_errmsg(db));
+		result = NO;
+	}
+	
+	sqlite3_finalize(statement);
+	
+	if (countPtr) *countPtr = count;
+	return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Memory Tables
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////